@@ -61,6 +61,28 @@ IF (OONF_REMOVE_HELPTEXT)
     ADD_DEFINITIONS(-DREMOVE_HELPTEXT)
 ENDIF(OONF_REMOVE_HELPTEXT)
 
+IF (OONF_TIMER_WHEEL)
+    ADD_DEFINITIONS(-DOONF_TIMER_WHEEL)
+ENDIF(OONF_TIMER_WHEEL)
+
+IF (OONF_DUPSET_HASH)
+    ADD_DEFINITIONS(-DOONF_DUPSET_HASH)
+ENDIF(OONF_DUPSET_HASH)
+
+IF (OONF_CLASS_SLAB)
+    ADD_DEFINITIONS(-DOONF_CLASS_SLAB)
+ENDIF(OONF_CLASS_SLAB)
+
+IF (OONF_MPR_ENGINE)
+    ADD_DEFINITIONS(-DOONF_MPR_ENGINE)
+ENDIF(OONF_MPR_ENGINE)
+
+ADD_DEFINITIONS(-DOS_FD_EVENT_BATCH=${OONF_SOCKET_EVENT_BATCH})
+
+IF (OONF_SOCKET_EDGE_TRIGGERED)
+    ADD_DEFINITIONS(-DOONF_SOCKET_EDGE_TRIGGERED)
+ENDIF(OONF_SOCKET_EDGE_TRIGGERED)
+
 # OS-specific compiler settings
 IF(ANDROID OR WIN32)
     # Android and windows don't compile well with c99
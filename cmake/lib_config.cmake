@@ -26,6 +26,30 @@ set (OONF_REMOVE_HELPTEXT false CACHE BOOL
 set (OONF_SANITIZE false CACHE BOOL
      "Activate the address sanitizer")
 
+# use a hierarchical timer wheel instead of an AVL tree for the scheduler
+set (OONF_TIMER_WHEEL true CACHE BOOL
+     "Set if you want the timer scheduler to use a timer wheel instead of an AVL tree")
+
+# use an open addressing hash table instead of an AVL tree for duplicate sets
+set (OONF_DUPSET_HASH true CACHE BOOL
+     "Set if you want duplicate sets to use a hash table instead of an AVL tree")
+
+# allocate class objects from per-class pages instead of single malloc calls
+set (OONF_CLASS_SLAB true CACHE BOOL
+     "Set if you want memory classes to use a slab allocator instead of malloc()")
+
+# keep the MPR selection state between two calculations (bitset engine)
+set (OONF_MPR_ENGINE true CACHE BOOL
+     "Set if you want the MPR plugin to use the incremental bitset engine instead of the AVL based selection")
+
+# number of socket events the scheduler fetches with a single wait call
+set (OONF_SOCKET_EVENT_BATCH 64 CACHE STRING
+     "Maximum number of socket events handled per call of the event wait function")
+
+# register sockets that drain their queues edge-triggered (epoll EPOLLET)
+set (OONF_SOCKET_EDGE_TRIGGERED false CACHE BOOL
+     "Set if you want sockets which read until EAGAIN to use edge-triggered events")
+
 ######################################
 #### Install target configuration ####
 ######################################
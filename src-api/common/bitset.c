@@ -0,0 +1,112 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#include "common/common_types.h"
+#include "common/bitset.h"
+
+/**
+ * @param set pointer to bitset
+ * @param words length of bitset in words
+ * @return number of set bits
+ */
+uint32_t
+bitset_count(const uint64_t *set, size_t words) {
+  uint32_t count = 0;
+  size_t i;
+
+  for (i=0; i<words; i++) {
+    count += __builtin_popcountll(set[i]);
+  }
+  return count;
+}
+
+/**
+ * @param set pointer to bitset
+ * @param mask pointer to bitset with bits that should not be counted
+ * @param words length of both bitsets in words
+ * @return number of bits set in the first bitset but not in the mask
+ */
+uint32_t
+bitset_count_andnot(const uint64_t *set, const uint64_t *mask, size_t words) {
+  uint32_t count = 0;
+  size_t i;
+
+  for (i=0; i<words; i++) {
+    count += __builtin_popcountll(set[i] & ~mask[i]);
+  }
+  return count;
+}
+
+/**
+ * Set all bits of a bitset that are set in a second one
+ * @param dst pointer to target bitset
+ * @param src pointer to source bitset
+ * @param words length of both bitsets in words
+ */
+void
+bitset_or(uint64_t *dst, const uint64_t *src, size_t words) {
+  size_t i;
+
+  for (i=0; i<words; i++) {
+    dst[i] |= src[i];
+  }
+}
+
+/**
+ * @param set pointer to bitset
+ * @param words length of bitset in words
+ * @return index of the lowest set bit, -1 if no bit is set
+ */
+int32_t
+bitset_get_first(const uint64_t *set, size_t words) {
+  size_t i;
+
+  for (i=0; i<words; i++) {
+    if (set[i]) {
+      return (int32_t)(i * 64 + __builtin_ctzll(set[i]));
+    }
+  }
+  return -1;
+}
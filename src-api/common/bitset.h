@@ -0,0 +1,109 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#ifndef BITSET_H_
+#define BITSET_H_
+
+#include <string.h>
+
+#include "common/common_types.h"
+
+/*! number of 64 bit words necessary to store a number of bits */
+#define BITSET_WORDS(bits) (((size_t)(bits) + 63) / 64)
+
+/*
+ * A bitset is a plain array of 64 bit words, the caller keeps track
+ * of its length (in words). This allows to put multiple bitsets of the
+ * same length into a single allocation, e.g. for the rows of a matrix.
+ */
+
+EXPORT uint32_t bitset_count(const uint64_t *set, size_t words);
+EXPORT uint32_t bitset_count_andnot(
+    const uint64_t *set, const uint64_t *mask, size_t words);
+EXPORT void bitset_or(uint64_t *dst, const uint64_t *src, size_t words);
+EXPORT int32_t bitset_get_first(const uint64_t *set, size_t words);
+
+/**
+ * get a bit of the bitset
+ * @param set pointer to bitset
+ * @param bit index of bit
+ * @return content of the bit
+ */
+static INLINE bool
+bitset_get(const uint64_t *set, uint32_t bit) {
+  return (set[bit >> 6] & (1ull << (bit & 63))) != 0;
+}
+
+/**
+ * set a bit of the bitset
+ * @param set pointer to bitset
+ * @param bit index of bit
+ */
+static INLINE void
+bitset_set(uint64_t *set, uint32_t bit) {
+  set[bit >> 6] |= 1ull << (bit & 63);
+}
+
+/**
+ * reset a bit of the bitset
+ * @param set pointer to bitset
+ * @param bit index of bit
+ */
+static INLINE void
+bitset_reset(uint64_t *set, uint32_t bit) {
+  set[bit >> 6] &= ~(1ull << (bit & 63));
+}
+
+/**
+ * clear all bits of a bitset
+ * @param set pointer to bitset
+ * @param words length of bitset in words
+ */
+static INLINE void
+bitset_clear(uint64_t *set, size_t words) {
+  memset(set, 0, words * sizeof(*set));
+}
+
+#endif /* BITSET_H_ */
@@ -0,0 +1,288 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "common/common_types.h"
+#include "common/netaddr.h"
+#include "common/dupset_table.h"
+
+static uint32_t _hash(uint8_t msg_type, const struct netaddr *addr);
+static bool _is_key(const struct dupset_table_entry *entry,
+    uint8_t msg_type, const struct netaddr *addr);
+static int _resize(struct dupset_table *table, size_t size);
+
+/**
+ * Initialize a new duplicate table
+ * @param table pointer to duplicate table
+ */
+void
+dupset_table_init(struct dupset_table *table) {
+  memset(table, 0, sizeof(*table));
+}
+
+/**
+ * Remove all entries from a duplicate table and free its memory
+ * @param table pointer to duplicate table
+ */
+void
+dupset_table_free(struct dupset_table *table) {
+  free(table->_slots);
+  memset(table, 0, sizeof(*table));
+}
+
+/**
+ * Lookup an entry of a duplicate table
+ * @param table pointer to duplicate table
+ * @param msg_type message type of entry
+ * @param addr originator address of entry
+ * @return pointer to entry, NULL if not found
+ */
+struct dupset_table_entry *
+dupset_table_get(struct dupset_table *table,
+    uint8_t msg_type, const struct netaddr *addr) {
+  struct dupset_table_entry *entry;
+  uint32_t i;
+
+  if (table->_slots == NULL) {
+    return NULL;
+  }
+
+  i = _hash(msg_type, addr) & table->_mask;
+  while (table->_slots[i]._used) {
+    entry = &table->_slots[i];
+    if (_is_key(entry, msg_type, addr)) {
+      return entry;
+    }
+    i = (i + 1) & table->_mask;
+  }
+  return NULL;
+}
+
+/**
+ * Add a new entry to a duplicate table. The entry is initialized
+ * with an empty window and expiration time.
+ * @param table pointer to duplicate table
+ * @param msg_type message type of entry
+ * @param addr originator address of entry, must not be in the table
+ * @return pointer to new entry, NULL if out of memory
+ */
+struct dupset_table_entry *
+dupset_table_insert(struct dupset_table *table,
+    uint8_t msg_type, const struct netaddr *addr) {
+  struct dupset_table_entry *entry;
+  size_t size;
+  uint32_t i;
+
+  /* keep load factor below 3/4 */
+  size = dupset_table_get_size(table);
+  if ((table->count + 1) * 4 > size * 3) {
+    if (_resize(table, size == 0 ? DUPSET_TABLE_MIN_SIZE : size * 2)) {
+      return NULL;
+    }
+  }
+
+  i = _hash(msg_type, addr) & table->_mask;
+  while (table->_slots[i]._used) {
+    i = (i + 1) & table->_mask;
+  }
+
+  entry = &table->_slots[i];
+  memset(entry, 0, sizeof(*entry));
+  memcpy(&entry->addr, addr, sizeof(*addr));
+  entry->msg_type = msg_type;
+  entry->_used = true;
+
+  table->count++;
+  return entry;
+}
+
+/**
+ * Remove an entry from a duplicate table
+ * @param table pointer to duplicate table
+ * @param entry pointer to entry of the table
+ */
+void
+dupset_table_remove(struct dupset_table *table,
+    struct dupset_table_entry *entry) {
+  uint32_t hole, i, home;
+
+  hole = entry - table->_slots;
+  i = hole;
+
+  /* shift following entries of the probe sequence into the hole */
+  while (true) {
+    i = (i + 1) & table->_mask;
+    if (!table->_slots[i]._used) {
+      break;
+    }
+
+    home = _hash(table->_slots[i].msg_type, &table->_slots[i].addr)
+        & table->_mask;
+
+    /* entry can be moved if its home slot is not between hole and i */
+    if (((i - home) & table->_mask) >= ((i - hole) & table->_mask)) {
+      memcpy(&table->_slots[hole], &table->_slots[i],
+          sizeof(table->_slots[hole]));
+      hole = i;
+    }
+  }
+
+  table->_slots[hole]._used = false;
+  table->count--;
+}
+
+/**
+ * Remove all entries of a duplicate table which expire
+ * at or before a timestamp. Shrinks the table if it becomes
+ * mostly empty.
+ * @param table pointer to duplicate table
+ * @param now current timestamp
+ * @return number of removed entries
+ */
+size_t
+dupset_table_expire(struct dupset_table *table, uint64_t now) {
+  struct dupset_table_entry *entry;
+  size_t removed, size, i;
+
+  removed = 0;
+  size = dupset_table_get_size(table);
+  for (i=0; i<size;) {
+    entry = &table->_slots[i];
+    if (entry->_used && entry->expire <= now) {
+      /* removal might shift the next entry into this slot */
+      dupset_table_remove(table, entry);
+      removed++;
+    }
+    else {
+      i++;
+    }
+  }
+
+  if (table->count == 0) {
+    dupset_table_free(table);
+  }
+  else if (size > DUPSET_TABLE_MIN_SIZE && table->count * 8 < size) {
+    /* failing to shrink the table is not a problem */
+    _resize(table, size / 2);
+  }
+  return removed;
+}
+
+/**
+ * Calculate hash value of a duplicate table key (32 bit FNV-1a)
+ * @param msg_type message type
+ * @param addr originator address
+ * @return hash value
+ */
+static uint32_t
+_hash(uint8_t msg_type, const struct netaddr *addr) {
+  const uint8_t *ptr;
+  uint32_t hash;
+  size_t i;
+
+  ptr = (const uint8_t *)addr;
+
+  hash = 2166136261u;
+  for (i=0; i<sizeof(*addr); i++) {
+    hash ^= ptr[i];
+    hash *= 16777619u;
+  }
+  hash ^= msg_type;
+  hash *= 16777619u;
+  return hash;
+}
+
+/**
+ * @param entry pointer to duplicate table entry
+ * @param msg_type message type
+ * @param addr originator address
+ * @return true if the entry has the specified key
+ */
+static bool
+_is_key(const struct dupset_table_entry *entry,
+    uint8_t msg_type, const struct netaddr *addr) {
+  return entry->msg_type == msg_type
+      && memcmp(&entry->addr, addr, sizeof(*addr)) == 0;
+}
+
+/**
+ * Rehash all entries of a duplicate table into a new slot array
+ * @param table pointer to duplicate table
+ * @param size new number of slots, must be a power of two
+ * @return -1 if an error happened, 0 otherwise
+ */
+static int
+_resize(struct dupset_table *table, size_t size) {
+  struct dupset_table_entry *slots, *entry;
+  size_t old_size, i;
+  uint32_t mask, j;
+
+  slots = calloc(size, sizeof(*slots));
+  if (slots == NULL) {
+    return -1;
+  }
+
+  mask = size - 1;
+  old_size = dupset_table_get_size(table);
+  for (i=0; i<old_size; i++) {
+    entry = &table->_slots[i];
+    if (!entry->_used) {
+      continue;
+    }
+
+    j = _hash(entry->msg_type, &entry->addr) & mask;
+    while (slots[j]._used) {
+      j = (j + 1) & mask;
+    }
+    memcpy(&slots[j], entry, sizeof(*entry));
+  }
+
+  free(table->_slots);
+  table->_slots = slots;
+  table->_mask = mask;
+  return 0;
+}
@@ -0,0 +1,132 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#ifndef DUPSET_TABLE_H_
+#define DUPSET_TABLE_H_
+
+#include "common/common_types.h"
+#include "common/netaddr.h"
+
+/*! minimal number of slots of an allocated table */
+#define DUPSET_TABLE_MIN_SIZE 64
+
+/**
+ * Sliding window of sequence numbers received from one originator
+ * for one message type
+ */
+struct dupset_window {
+  /*! bit buffer for duplicate detection */
+  uint64_t history;
+
+  /*! newest received sequence number */
+  uint64_t current;
+
+  /*! number of too old consecutive sequence numbers without a newer one */
+  uint16_t too_old_count;
+};
+
+/**
+ * Compact entry of a duplicate table, stored inline in the slot array
+ */
+struct dupset_table_entry {
+  /*! sequence number window of this originator/message type */
+  struct dupset_window window;
+
+  /*! absolute time when the entry expires */
+  uint64_t expire;
+
+  /*! originator of the sequence numbers */
+  struct netaddr addr;
+
+  /*! message type of sequence number, mostly RFC5444 */
+  uint8_t msg_type;
+
+  /*! true if the slot is in use */
+  bool _used;
+};
+
+/**
+ * Open addressing hash table (linear probing) of duplicate detection
+ * entries, keyed by originator address and message type.
+ *
+ * Entries are stored directly in the slot array, there is no allocation
+ * per entry. Entries are removed with backward shift deletion, so the
+ * table does not need tombstones. All entries that are past their
+ * expiration time are removed in a single sweep over the table.
+ *
+ * Inserting an entry or sweeping the table might move entries, so
+ * pointers to entries are only valid until the next modification.
+ */
+struct dupset_table {
+  /*! array of slots, NULL if the table is empty */
+  struct dupset_table_entry *_slots;
+
+  /*! number of slots minus one */
+  uint32_t _mask;
+
+  /*! number of entries in the table */
+  uint32_t count;
+};
+
+EXPORT void dupset_table_init(struct dupset_table *);
+EXPORT void dupset_table_free(struct dupset_table *);
+EXPORT struct dupset_table_entry *dupset_table_get(struct dupset_table *,
+    uint8_t msg_type, const struct netaddr *addr);
+EXPORT struct dupset_table_entry *dupset_table_insert(struct dupset_table *,
+    uint8_t msg_type, const struct netaddr *addr);
+EXPORT void dupset_table_remove(struct dupset_table *,
+    struct dupset_table_entry *);
+EXPORT size_t dupset_table_expire(struct dupset_table *, uint64_t now);
+
+/**
+ * @param table pointer to duplicate table
+ * @return number of slots of the table
+ */
+static INLINE size_t
+dupset_table_get_size(const struct dupset_table *table) {
+  return table->_slots == NULL ? 0 : (size_t)table->_mask + 1;
+}
+
+#endif /* DUPSET_TABLE_H_ */
@@ -0,0 +1,127 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#ifndef HISTOGRAM_H_
+#define HISTOGRAM_H_
+
+#include "common/common_types.h"
+
+/*! number of buckets of a histogram */
+#define HISTOGRAM_BUCKETS 24
+
+/**
+ * Histogram with logarithmic (base 2) buckets. Bucket 0 counts
+ * the value 0, bucket n counts the values from 2^(n-1) to 2^n - 1.
+ * The last bucket counts all larger values too.
+ */
+struct histogram {
+  /*! number of values per bucket */
+  uint32_t buckets[HISTOGRAM_BUCKETS];
+
+  /*! number of values */
+  uint64_t count;
+
+  /*! sum of all values */
+  uint64_t sum;
+
+  /*! largest value */
+  uint64_t max;
+};
+
+EXPORT uint64_t histogram_get_percentile(const struct histogram *, uint32_t percent);
+
+/**
+ * @param value value of histogram
+ * @return index of the bucket for the value
+ */
+static INLINE uint32_t
+histogram_get_bucket(uint64_t value) {
+  uint32_t bucket;
+
+  if (value == 0) {
+    return 0;
+  }
+
+  bucket = 64 - __builtin_clzll(value);
+  return bucket < HISTOGRAM_BUCKETS ? bucket : HISTOGRAM_BUCKETS - 1;
+}
+
+/**
+ * @param bucket index of bucket
+ * @return largest value counted in the bucket
+ */
+static INLINE uint64_t
+histogram_get_bucket_limit(uint32_t bucket) {
+  if (bucket >= HISTOGRAM_BUCKETS - 1) {
+    return UINT64_MAX;
+  }
+  return (1ull << bucket) - 1;
+}
+
+/**
+ * Add a value to a histogram
+ * @param h pointer to histogram
+ * @param value new value
+ */
+static INLINE void
+histogram_add(struct histogram *h, uint64_t value) {
+  h->buckets[histogram_get_bucket(value)]++;
+  h->count++;
+  h->sum += value;
+  if (value > h->max) {
+    h->max = value;
+  }
+}
+
+/**
+ * @param h pointer to histogram
+ * @return average of all values, 0 if histogram is empty
+ */
+static INLINE uint64_t
+histogram_get_average(const struct histogram *h) {
+  return h->count == 0 ? 0 : h->sum / h->count;
+}
+
+#endif /* HISTOGRAM_H_ */
@@ -46,9 +46,30 @@
 #include "common/common_types.h"
 #include "common/netaddr.h"
 #include "common/netaddr_acl.h"
+#include "common/netaddr_trie.h"
 #include "common/string.h"
 
+/**
+ * compiled ACL entry, one for each distinct prefix of an ACL
+ */
+struct _netaddr_acl_entry {
+  /*! prefix of the entry */
+  struct netaddr prefix;
+
+  /*! true if the prefix is covered by a prefix of the accept array */
+  bool accept;
+
+  /*! true if the prefix is covered by a prefix of the reject array */
+  bool reject;
+
+  /*! node for the compiled ACL trie */
+  struct netaddr_trie_node _node;
+};
+
+static int _compile(struct netaddr_acl *);
 static bool _is_in_array(const struct netaddr *, size_t, const struct netaddr *);
+static int _add_entry(struct netaddr_acl *, size_t *count,
+    const struct netaddr *prefix, bool reject);
 
 /**
  * Initialize an ACL object. It will contain no addresses on both
@@ -66,6 +87,9 @@ netaddr_acl_add(struct netaddr_acl *acl) {
  */
 void
 netaddr_acl_remove(struct netaddr_acl *acl) {
+  netaddr_trie_clear(&acl->_trie);
+
+  free(acl->_entries);
   free(acl->accept);
   free(acl->reject);
 
@@ -147,6 +171,10 @@ netaddr_acl_from_strarray(struct netaddr_acl *acl,
       acl->accept_count++;
     }
   }
+
+  if (_compile(acl)) {
+    goto from_entry_error;
+  }
   return 0;
 
 from_entry_error:
@@ -165,10 +193,16 @@ netaddr_acl_copy(struct netaddr_acl *to, const struct netaddr_acl *from) {
   netaddr_acl_remove(to);
   memcpy(to, from, sizeof(*to));
 
+  /* the arrays are copied and the trie is compiled again */
+  memset(&to->_trie, 0, sizeof(to->_trie));
+  to->_entries = NULL;
+  to->accept = NULL;
+  to->reject = NULL;
+
   if (to->accept_count) {
     to->accept = calloc(to->accept_count, sizeof(struct netaddr));
     if (to->accept == NULL) {
-      return -1;
+      goto copy_error;
     }
     memcpy(to->accept, from->accept, to->accept_count * sizeof(struct netaddr));
   }
@@ -176,11 +210,19 @@ netaddr_acl_copy(struct netaddr_acl *to, const struct netaddr_acl *from) {
   if (to->reject_count) {
     to->reject = calloc(to->reject_count, sizeof(struct netaddr));
     if (to->reject == NULL) {
-      return -1;
+      goto copy_error;
     }
     memcpy(to->reject, from->reject, to->reject_count * sizeof(struct netaddr));
   }
+
+  if (_compile(to)) {
+    goto copy_error;
+  }
   return 0;
+
+copy_error:
+  netaddr_acl_remove(to);
+  return -1;
 }
 
 /**
@@ -191,22 +233,38 @@ netaddr_acl_copy(struct netaddr_acl *to, const struct netaddr_acl *from) {
  */
 bool
 netaddr_acl_check_accept(const struct netaddr_acl *acl, const struct netaddr *addr) {
-  if (acl->reject_first) {
+  struct _netaddr_acl_entry *entry;
+
+  if (netaddr_get_maxprefix(addr) == 0) {
+    /* AF_UNSPEC and other address types are not part of the trie */
+    if (acl->reject_first
+        && _is_in_array(acl->reject, acl->reject_count, addr)) {
+      return false;
+    }
+    if (_is_in_array(acl->accept, acl->accept_count, addr)) {
+      return true;
+    }
     if (_is_in_array(acl->reject, acl->reject_count, addr)) {
       return false;
     }
+    return acl->accept_default;
   }
 
-  if (_is_in_array(acl->accept, acl->accept_count, addr)) {
-    return true;
+  /* the longest match knows about all ACL prefixes containing the address */
+  entry = netaddr_trie_find_lpm_element(&acl->_trie, addr, entry, _node);
+  if (entry == NULL) {
+    return acl->accept_default;
   }
 
-  if (!acl->reject_first) {
-    if (_is_in_array(acl->reject, acl->reject_count, addr)) {
-      return false;
-    }
+  if (acl->reject_first && entry->reject) {
+    return false;
+  }
+  if (entry->accept) {
+    return true;
+  }
+  if (entry->reject) {
+    return false;
   }
-
   return acl->accept_default;
 }
 
@@ -239,6 +297,98 @@ netaddr_acl_handle_keywords(struct netaddr_acl *acl, const char *cmd) {
   return 0;
 }
 
+/**
+ * Compile the accept and reject arrays of an ACL into a single trie.
+ * Each entry stores if the accept or reject array contains a prefix
+ * that covers the entry, so a single longest prefix match is enough
+ * to check an address against both arrays. Prefixes without a
+ * maximum prefix length (e.g. AF_UNSPEC) are not put into the trie,
+ * netaddr_acl_check_accept() scans the arrays for them.
+ * @param acl pointer to ACL with initialized arrays
+ * @return -1 if out of memory, 0 otherwise
+ */
+static int
+_compile(struct netaddr_acl *acl) {
+  struct _netaddr_acl_entry *entry, *covered;
+  size_t i, count;
+
+  netaddr_trie_init(&acl->_trie, false);
+
+  if (acl->accept_count + acl->reject_count == 0) {
+    return 0;
+  }
+
+  acl->_entries = calloc(acl->accept_count + acl->reject_count,
+      sizeof(struct _netaddr_acl_entry));
+  if (acl->_entries == NULL) {
+    return -1;
+  }
+
+  count = 0;
+  for (i=0; i<acl->accept_count; i++) {
+    if (netaddr_get_maxprefix(&acl->accept[i]) == 0) {
+      continue;
+    }
+    if (_add_entry(acl, &count, &acl->accept[i], false)) {
+      return -1;
+    }
+  }
+  for (i=0; i<acl->reject_count; i++) {
+    if (netaddr_get_maxprefix(&acl->reject[i]) == 0) {
+      continue;
+    }
+    if (_add_entry(acl, &count, &acl->reject[i], true)) {
+      return -1;
+    }
+  }
+
+  /* propagate the flags to all longer prefixes */
+  for (i=0; i<count; i++) {
+    entry = &acl->_entries[i];
+    netaddr_trie_for_each_covered_element(&acl->_trie, &entry->prefix, covered, _node) {
+      covered->accept |= entry->accept;
+      covered->reject |= entry->reject;
+    }
+  }
+  return 0;
+}
+
+/**
+ * Add a prefix to the compiled trie of an ACL or set the flag
+ * of an existing entry with the same prefix.
+ * @param acl pointer to ACL
+ * @param count pointer to number of used entries
+ * @param prefix pointer to prefix
+ * @param reject true if prefix is part of the reject array,
+ *   false if it is part of the accept array
+ * @return -1 if out of memory, 0 otherwise
+ */
+static int
+_add_entry(struct netaddr_acl *acl, size_t *count,
+    const struct netaddr *prefix, bool reject) {
+  struct _netaddr_acl_entry *entry;
+
+  entry = netaddr_trie_find_element(&acl->_trie, prefix, entry, _node);
+  if (entry == NULL) {
+    entry = &acl->_entries[*count];
+    memcpy(&entry->prefix, prefix, sizeof(*prefix));
+    entry->_node.key = &entry->prefix;
+
+    if (netaddr_trie_insert(&acl->_trie, &entry->_node)) {
+      return -1;
+    }
+    (*count)++;
+  }
+
+  if (reject) {
+    entry->reject = true;
+  }
+  else {
+    entry->accept = true;
+  }
+  return 0;
+}
+
 /**
  * @param array pointer to array of addresses and networks
  * @param length length of array
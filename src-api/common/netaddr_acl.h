@@ -48,6 +48,7 @@
 
 #include "common/common_types.h"
 #include "common/netaddr.h"
+#include "common/netaddr_trie.h"
 #include "common/string.h"
 
 /*
@@ -93,6 +94,12 @@ struct netaddr_acl {
 
   /*! result of the check if neither of the arrays have a match */
   bool accept_default;
+
+  /*! compiled trie with one entry for each prefix of both arrays */
+  struct netaddr_trie _trie;
+
+  /*! array of compiled trie entries */
+  struct _netaddr_acl_entry *_entries;
 };
 
 EXPORT void netaddr_acl_add(struct netaddr_acl *);
@@ -0,0 +1,565 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#include <stdlib.h>
+
+#include "common/common_types.h"
+#include "common/list.h"
+#include "common/netaddr.h"
+#include "common/netaddr_trie.h"
+
+/**
+ * Vertex of a netaddr trie. It contains the nodes with its prefix,
+ * a vertex without nodes only exists to join two subtries.
+ */
+struct _netaddr_trie_vertex {
+  /*! prefix of the vertex, only the first prefix length bits are used */
+  struct netaddr prefix;
+
+  /*! parent vertex, NULL for a root vertex */
+  struct _netaddr_trie_vertex *parent;
+
+  /*! subtries with a 0 and a 1 bit behind the prefix */
+  struct _netaddr_trie_vertex *child[2];
+
+  /*! list of nodes with this prefix */
+  struct list_entity nodes;
+};
+
+static int _get_family_index(uint8_t af_family);
+static uint8_t _get_bit(const struct netaddr *addr, uint8_t bit);
+static uint8_t _get_common_bits(const struct netaddr *addr1,
+    const struct netaddr *addr2, uint8_t max_bits);
+static struct _netaddr_trie_vertex *_create_vertex(
+    const struct netaddr *prefix, uint8_t prefix_len);
+static struct _netaddr_trie_vertex **_get_slot(
+    struct netaddr_trie *trie, struct _netaddr_trie_vertex *vertex);
+static struct _netaddr_trie_vertex *_get_next_vertex(
+    struct _netaddr_trie_vertex *vertex, uint8_t min_len);
+static struct netaddr_trie_node *_get_first_node(
+    struct _netaddr_trie_vertex *vertex);
+
+/**
+ * Initialize a new netaddr trie
+ * @param trie pointer to netaddr trie
+ * @param allow_duplicates true if multiple nodes with the same
+ *   prefix are allowed
+ */
+void
+netaddr_trie_init(struct netaddr_trie *trie, bool allow_duplicates) {
+  memset(trie, 0, sizeof(*trie));
+  trie->allow_duplicates = allow_duplicates;
+}
+
+/**
+ * Remove all nodes from a netaddr trie and free its vertices
+ * @param trie pointer to netaddr trie
+ */
+void
+netaddr_trie_clear(struct netaddr_trie *trie) {
+  struct _netaddr_trie_vertex *vertex, *parent;
+  struct netaddr_trie_node *node, *n_it;
+  size_t i;
+
+  for (i=0; i<NETADDR_TRIE_FAMILIES; i++) {
+    vertex = trie->_root[i];
+
+    /* free vertices bottom up */
+    while (vertex) {
+      if (vertex->child[0]) {
+        vertex = vertex->child[0];
+        continue;
+      }
+      if (vertex->child[1]) {
+        vertex = vertex->child[1];
+        continue;
+      }
+
+      list_for_each_element_safe(&vertex->nodes, node, _list, n_it) {
+        list_remove(&node->_list);
+        node->_vertex = NULL;
+      }
+
+      parent = vertex->parent;
+      if (parent) {
+        parent->child[parent->child[0] == vertex ? 0 : 1] = NULL;
+      }
+      free(vertex);
+      vertex = parent;
+    }
+    trie->_root[i] = NULL;
+  }
+  trie->count = 0;
+}
+
+/**
+ * Add a node to a netaddr trie
+ * @param trie pointer to netaddr trie
+ * @param node pointer to node with initialized key,
+ *   must not be part of a trie
+ * @return -1 if the address family is not supported, the prefix
+ *   is already in a trie without duplicates or if out of memory,
+ *   0 otherwise
+ */
+int
+netaddr_trie_insert(struct netaddr_trie *trie, struct netaddr_trie_node *node) {
+  struct _netaddr_trie_vertex **slot, *parent, *vertex, *new_vertex, *glue;
+  uint8_t prefix_len, common;
+  int idx;
+
+  idx = _get_family_index(netaddr_get_address_family(node->key));
+  prefix_len = netaddr_get_prefix_length(node->key);
+  if (idx < 0 || prefix_len > netaddr_get_maxprefix(node->key)) {
+    return -1;
+  }
+
+  slot = &trie->_root[idx];
+  parent = NULL;
+  common = 0;
+
+  /* walk down along all vertices with a prefix that contains the key */
+  while (*slot) {
+    vertex = *slot;
+
+    common = _get_common_bits(&vertex->prefix, node->key,
+        vertex->prefix._prefix_len < prefix_len
+          ? vertex->prefix._prefix_len : prefix_len);
+    if (common < vertex->prefix._prefix_len) {
+      /* vertex is not part of the path to the key */
+      break;
+    }
+
+    if (vertex->prefix._prefix_len == prefix_len) {
+      /* found vertex with the same prefix */
+      if (!trie->allow_duplicates && !list_is_empty(&vertex->nodes)) {
+        return -1;
+      }
+      list_add_tail(&vertex->nodes, &node->_list);
+      node->_vertex = vertex;
+      trie->count++;
+      return 0;
+    }
+
+    parent = vertex;
+    slot = &vertex->child[_get_bit(node->key, vertex->prefix._prefix_len)];
+  }
+
+  new_vertex = _create_vertex(node->key, prefix_len);
+  if (new_vertex == NULL) {
+    return -1;
+  }
+
+  vertex = *slot;
+  if (vertex != NULL && common < prefix_len) {
+    /* key and vertex split up behind their common bits */
+    glue = _create_vertex(node->key, common);
+    if (glue == NULL) {
+      free(new_vertex);
+      return -1;
+    }
+
+    glue->parent = parent;
+    glue->child[_get_bit(node->key, common)] = new_vertex;
+    glue->child[_get_bit(&vertex->prefix, common)] = vertex;
+    new_vertex->parent = glue;
+    vertex->parent = glue;
+    *slot = glue;
+  }
+  else {
+    if (vertex != NULL) {
+      /* key contains the prefix of the vertex */
+      new_vertex->child[_get_bit(&vertex->prefix, prefix_len)] = vertex;
+      vertex->parent = new_vertex;
+    }
+    new_vertex->parent = parent;
+    *slot = new_vertex;
+  }
+
+  list_add_tail(&new_vertex->nodes, &node->_list);
+  node->_vertex = new_vertex;
+  trie->count++;
+  return 0;
+}
+
+/**
+ * Remove a node from a netaddr trie
+ * @param trie pointer to netaddr trie
+ * @param node pointer to node, must be part of the trie
+ */
+void
+netaddr_trie_remove(struct netaddr_trie *trie, struct netaddr_trie_node *node) {
+  struct _netaddr_trie_vertex *vertex, *parent, *child;
+
+  vertex = node->_vertex;
+  if (vertex == NULL) {
+    return;
+  }
+
+  list_remove(&node->_list);
+  node->_vertex = NULL;
+  trie->count--;
+
+  /* remove vertices that are not necessary anymore */
+  while (vertex != NULL && list_is_empty(&vertex->nodes)
+      && (vertex->child[0] == NULL || vertex->child[1] == NULL)) {
+    child = vertex->child[0] ? vertex->child[0] : vertex->child[1];
+    parent = vertex->parent;
+
+    *_get_slot(trie, vertex) = child;
+    if (child) {
+      child->parent = parent;
+    }
+    free(vertex);
+
+    /* parent lost a child if the vertex was a leaf */
+    vertex = child ? NULL : parent;
+  }
+}
+
+/**
+ * Look for the node with exactly the same prefix
+ * @param trie pointer to netaddr trie
+ * @param prefix pointer to prefix
+ * @return pointer to first node with the prefix, NULL if not found
+ */
+struct netaddr_trie_node *
+netaddr_trie_find(const struct netaddr_trie *trie, const struct netaddr *prefix) {
+  struct _netaddr_trie_vertex *vertex;
+  uint8_t prefix_len;
+  int idx;
+
+  idx = _get_family_index(netaddr_get_address_family(prefix));
+  if (idx < 0) {
+    return NULL;
+  }
+
+  prefix_len = netaddr_get_prefix_length(prefix);
+  vertex = trie->_root[idx];
+  while (vertex != NULL && vertex->prefix._prefix_len <= prefix_len
+      && _get_common_bits(&vertex->prefix, prefix, vertex->prefix._prefix_len)
+          == vertex->prefix._prefix_len) {
+    if (vertex->prefix._prefix_len == prefix_len) {
+      /* glue vertices have no nodes */
+      return list_is_empty(&vertex->nodes) ? NULL : _get_first_node(vertex);
+    }
+    vertex = vertex->child[_get_bit(prefix, vertex->prefix._prefix_len)];
+  }
+  return NULL;
+}
+
+/**
+ * Look for the node with the longest prefix that contains an address,
+ * using the same matching rules as netaddr_is_in_subnet()
+ * @param trie pointer to netaddr trie
+ * @param addr pointer to address, its prefix length is ignored
+ * @return pointer to first node with the longest matching prefix,
+ *   NULL if no prefix contains the address
+ */
+struct netaddr_trie_node *
+netaddr_trie_find_lpm(const struct netaddr_trie *trie, const struct netaddr *addr) {
+  struct _netaddr_trie_vertex *vertex, *best;
+  uint8_t max_len;
+  int idx;
+
+  idx = _get_family_index(netaddr_get_address_family(addr));
+  if (idx < 0) {
+    return NULL;
+  }
+
+  max_len = netaddr_get_maxprefix(addr);
+  best = NULL;
+  vertex = trie->_root[idx];
+  while (vertex != NULL
+      && _get_common_bits(&vertex->prefix, addr, vertex->prefix._prefix_len)
+          == vertex->prefix._prefix_len) {
+    if (!list_is_empty(&vertex->nodes)) {
+      best = vertex;
+    }
+    if (vertex->prefix._prefix_len >= max_len) {
+      break;
+    }
+    vertex = vertex->child[_get_bit(addr, vertex->prefix._prefix_len)];
+  }
+  return best ? _get_first_node(best) : NULL;
+}
+
+/**
+ * Look for the node with the shortest prefix that contains an address,
+ * using the same matching rules as netaddr_is_in_subnet()
+ * @param trie pointer to netaddr trie
+ * @param addr pointer to address, its prefix length is ignored
+ * @return pointer to first node with the shortest matching prefix,
+ *   NULL if no prefix contains the address
+ */
+struct netaddr_trie_node *
+netaddr_trie_find_spm(const struct netaddr_trie *trie, const struct netaddr *addr) {
+  struct _netaddr_trie_vertex *vertex;
+  uint8_t max_len;
+  int idx;
+
+  idx = _get_family_index(netaddr_get_address_family(addr));
+  if (idx < 0) {
+    return NULL;
+  }
+
+  max_len = netaddr_get_maxprefix(addr);
+  vertex = trie->_root[idx];
+  while (vertex != NULL
+      && _get_common_bits(&vertex->prefix, addr, vertex->prefix._prefix_len)
+          == vertex->prefix._prefix_len) {
+    if (!list_is_empty(&vertex->nodes)) {
+      /* first vertex with nodes on the path has the shortest prefix */
+      return _get_first_node(vertex);
+    }
+    if (vertex->prefix._prefix_len >= max_len) {
+      break;
+    }
+    vertex = vertex->child[_get_bit(addr, vertex->prefix._prefix_len)];
+  }
+  return NULL;
+}
+
+/**
+ * Get the first node with a prefix that is part of another prefix
+ * @param trie pointer to netaddr trie
+ * @param prefix pointer to covering prefix
+ * @return pointer to first node with a covered prefix, NULL if none
+ */
+struct netaddr_trie_node *
+netaddr_trie_first_covered(const struct netaddr_trie *trie,
+    const struct netaddr *prefix) {
+  struct _netaddr_trie_vertex *vertex;
+  uint8_t prefix_len;
+  int idx;
+
+  idx = _get_family_index(netaddr_get_address_family(prefix));
+  if (idx < 0) {
+    return NULL;
+  }
+
+  /* look for the shortest vertex inside the prefix */
+  prefix_len = netaddr_get_prefix_length(prefix);
+  vertex = trie->_root[idx];
+  while (vertex != NULL && vertex->prefix._prefix_len < prefix_len) {
+    if (_get_common_bits(&vertex->prefix, prefix, vertex->prefix._prefix_len)
+        < vertex->prefix._prefix_len) {
+      return NULL;
+    }
+    vertex = vertex->child[_get_bit(prefix, vertex->prefix._prefix_len)];
+  }
+
+  if (vertex == NULL
+      || _get_common_bits(&vertex->prefix, prefix, prefix_len) < prefix_len) {
+    return NULL;
+  }
+
+  if (list_is_empty(&vertex->nodes)) {
+    vertex = _get_next_vertex(vertex, prefix_len);
+  }
+  return vertex ? _get_first_node(vertex) : NULL;
+}
+
+/**
+ * Get the next node with a prefix that is part of another prefix
+ * @param node pointer to current node, must be part of a trie
+ * @param prefix pointer to covering prefix
+ * @return pointer to next node with a covered prefix, NULL if none
+ */
+struct netaddr_trie_node *
+netaddr_trie_next_covered(const struct netaddr_trie_node *node,
+    const struct netaddr *prefix) {
+  struct _netaddr_trie_vertex *vertex;
+
+  vertex = node->_vertex;
+  if (node->_list.next != &vertex->nodes) {
+    /* more nodes with the same prefix */
+    return container_of(node->_list.next, struct netaddr_trie_node, _list);
+  }
+
+  vertex = _get_next_vertex(vertex, netaddr_get_prefix_length(prefix));
+  return vertex ? _get_first_node(vertex) : NULL;
+}
+
+/**
+ * @param af_family address family
+ * @return index of root vertex for the family, -1 if not supported
+ */
+static int
+_get_family_index(uint8_t af_family) {
+  switch (af_family) {
+    case AF_UNSPEC:
+      return 0;
+    case AF_INET:
+      return 1;
+    case AF_INET6:
+      return 2;
+    case AF_MAC48:
+      return 3;
+    case AF_EUI64:
+      return 4;
+    default:
+      return -1;
+  }
+}
+
+/**
+ * @param addr pointer to address
+ * @param bit index of bit, 0 is the most significant bit
+ * @return value of the bit
+ */
+static uint8_t
+_get_bit(const struct netaddr *addr, uint8_t bit) {
+  return (addr->_addr[bit / 8] >> (7 - (bit % 8))) & 1;
+}
+
+/**
+ * @param addr1 pointer to first address
+ * @param addr2 pointer to second address
+ * @param max_bits maximum number of bits to compare
+ * @return number of identical leading bits, not more than max_bits
+ */
+static uint8_t
+_get_common_bits(const struct netaddr *addr1, const struct netaddr *addr2,
+    uint8_t max_bits) {
+  uint8_t bits, diff;
+  size_t i;
+
+  for (i=0, bits=0; bits < max_bits; i++, bits += 8) {
+    diff = addr1->_addr[i] ^ addr2->_addr[i];
+    if (diff != 0) {
+      while ((diff & 0x80) == 0) {
+        diff <<= 1;
+        bits++;
+      }
+      break;
+    }
+  }
+  return bits < max_bits ? bits : max_bits;
+}
+
+/**
+ * Allocate a new trie vertex
+ * @param prefix pointer to prefix of vertex
+ * @param prefix_len length of vertex prefix
+ * @return pointer to vertex, NULL if out of memory
+ */
+static struct _netaddr_trie_vertex *
+_create_vertex(const struct netaddr *prefix, uint8_t prefix_len) {
+  struct _netaddr_trie_vertex *vertex;
+
+  vertex = calloc(1, sizeof(*vertex));
+  if (vertex == NULL) {
+    return NULL;
+  }
+
+  memcpy(&vertex->prefix, prefix, sizeof(*prefix));
+  vertex->prefix._prefix_len = prefix_len;
+  list_init_head(&vertex->nodes);
+  return vertex;
+}
+
+/**
+ * @param trie pointer to netaddr trie
+ * @param vertex pointer to trie vertex
+ * @return pointer to the pointer that references the vertex
+ */
+static struct _netaddr_trie_vertex **
+_get_slot(struct netaddr_trie *trie, struct _netaddr_trie_vertex *vertex) {
+  struct _netaddr_trie_vertex *parent;
+
+  parent = vertex->parent;
+  if (parent == NULL) {
+    return &trie->_root[_get_family_index(vertex->prefix._type)];
+  }
+  return &parent->child[parent->child[0] == vertex ? 0 : 1];
+}
+
+/**
+ * Get the next vertex with nodes in pre-order, without leaving
+ * the subtrie of vertices with a minimal prefix length
+ * @param vertex pointer to current vertex
+ * @param min_len minimal prefix length of the subtrie
+ * @return pointer to next vertex with nodes, NULL if none
+ */
+static struct _netaddr_trie_vertex *
+_get_next_vertex(struct _netaddr_trie_vertex *vertex, uint8_t min_len) {
+  struct _netaddr_trie_vertex *parent;
+
+  do {
+    if (vertex->child[0]) {
+      vertex = vertex->child[0];
+    }
+    else if (vertex->child[1]) {
+      vertex = vertex->child[1];
+    }
+    else {
+      /* go up until there is an unvisited right subtrie */
+      while (true) {
+        parent = vertex->parent;
+        if (parent == NULL || parent->prefix._prefix_len < min_len) {
+          return NULL;
+        }
+        if (parent->child[0] == vertex && parent->child[1] != NULL) {
+          vertex = parent->child[1];
+          break;
+        }
+        vertex = parent;
+      }
+    }
+  } while (list_is_empty(&vertex->nodes));
+
+  return vertex;
+}
+
+/**
+ * @param vertex pointer to trie vertex with nodes
+ * @return first node of the vertex
+ */
+static struct netaddr_trie_node *
+_get_first_node(struct _netaddr_trie_vertex *vertex) {
+  struct netaddr_trie_node *node;
+
+  return list_first_element(&vertex->nodes, node, _list);
+}
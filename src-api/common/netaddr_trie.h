@@ -0,0 +1,193 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#ifndef NETADDR_TRIE_H_
+#define NETADDR_TRIE_H_
+
+#include "common/common_types.h"
+#include "common/container_of.h"
+#include "common/list.h"
+#include "common/netaddr.h"
+
+/*! number of address families (unspec, IPv4, IPv6, MAC48, EUI64) of a trie */
+#define NETADDR_TRIE_FAMILIES 5
+
+struct _netaddr_trie_vertex;
+
+/**
+ * This element is a member of a netaddr trie. It must be contained in all
+ * larger structs that should be put into a trie.
+ */
+struct netaddr_trie_node {
+  /*! pointer to the prefix of the node, must be set before inserting */
+  const struct netaddr *key;
+
+  /*! hook into the list of nodes with the same prefix */
+  struct list_entity _list;
+
+  /*! vertex of the trie that holds the prefix of the node */
+  struct _netaddr_trie_vertex *_vertex;
+};
+
+/**
+ * Path compressed binary trie of netaddr prefixes with one root for
+ * each address family. Inserting, removing and a longest prefix match
+ * take time proportional to the address length, independent of the
+ * number of prefixes in the trie.
+ *
+ * The trie allocates its branching vertices itself, so only
+ * inserting a node can fail. A zeroed trie is a valid empty trie
+ * without duplicate prefixes.
+ */
+struct netaddr_trie {
+  /*! root vertex for each address family */
+  struct _netaddr_trie_vertex *_root[NETADDR_TRIE_FAMILIES];
+
+  /*! number of nodes in the trie */
+  uint32_t count;
+
+  /*! true if multiple nodes with the same prefix are allowed */
+  bool allow_duplicates;
+};
+
+EXPORT void netaddr_trie_init(struct netaddr_trie *, bool allow_duplicates);
+EXPORT void netaddr_trie_clear(struct netaddr_trie *);
+EXPORT int netaddr_trie_insert(struct netaddr_trie *, struct netaddr_trie_node *);
+EXPORT void netaddr_trie_remove(struct netaddr_trie *, struct netaddr_trie_node *);
+
+EXPORT struct netaddr_trie_node *netaddr_trie_find(
+    const struct netaddr_trie *, const struct netaddr *prefix);
+EXPORT struct netaddr_trie_node *netaddr_trie_find_lpm(
+    const struct netaddr_trie *, const struct netaddr *addr);
+EXPORT struct netaddr_trie_node *netaddr_trie_find_spm(
+    const struct netaddr_trie *, const struct netaddr *addr);
+EXPORT struct netaddr_trie_node *netaddr_trie_first_covered(
+    const struct netaddr_trie *, const struct netaddr *prefix);
+EXPORT struct netaddr_trie_node *netaddr_trie_next_covered(
+    const struct netaddr_trie_node *, const struct netaddr *prefix);
+
+/**
+ * @param trie pointer to netaddr trie
+ * @return true if the trie is empty, false otherwise
+ */
+static INLINE bool
+netaddr_trie_is_empty(const struct netaddr_trie *trie) {
+  return trie->count == 0;
+}
+
+/**
+ * @param node pointer to netaddr trie node
+ * @return true if node is currently in a trie, false otherwise
+ */
+static INLINE bool
+netaddr_trie_is_node_added(const struct netaddr_trie_node *node) {
+  return node->_vertex != NULL;
+}
+
+/**
+ * Find the element with exactly the same prefix
+ * @param trie pointer to netaddr trie
+ * @param prefix pointer to prefix
+ * @param element pointer to a node element
+ *    (don't need to be initialized)
+ * @param node_member name of the netaddr_trie_node element inside the
+ *    larger struct
+ * @return pointer to the first element with this prefix
+ *    (automatically converted to type 'element'),
+ *    NULL if no element was found
+ */
+#define netaddr_trie_find_element(trie, prefix, element, node_member) \
+  container_of_if_notnull(netaddr_trie_find(trie, prefix), typeof(*(element)), node_member)
+
+/**
+ * Find the element with the longest prefix that contains an address
+ * @param trie pointer to netaddr trie
+ * @param addr pointer to address, its prefix length is ignored
+ * @param element pointer to a node element
+ *    (don't need to be initialized)
+ * @param node_member name of the netaddr_trie_node element inside the
+ *    larger struct
+ * @return pointer to the first element with the longest matching prefix
+ *    (automatically converted to type 'element'),
+ *    NULL if no element was found
+ */
+#define netaddr_trie_find_lpm_element(trie, addr, element, node_member) \
+  container_of_if_notnull(netaddr_trie_find_lpm(trie, addr), typeof(*(element)), node_member)
+
+/**
+ * Find the element with the shortest prefix that contains an address
+ * @param trie pointer to netaddr trie
+ * @param addr pointer to address, its prefix length is ignored
+ * @param element pointer to a node element
+ *    (don't need to be initialized)
+ * @param node_member name of the netaddr_trie_node element inside the
+ *    larger struct
+ * @return pointer to the first element with the shortest matching prefix
+ *    (automatically converted to type 'element'),
+ *    NULL if no element was found
+ */
+#define netaddr_trie_find_spm_element(trie, addr, element, node_member) \
+  container_of_if_notnull(netaddr_trie_find_spm(trie, addr), typeof(*(element)), node_member)
+
+/**
+ * Loop over all elements of a trie whose prefix is part of another
+ * prefix, shorter prefixes first. The loop must not remove elements
+ * from the trie.
+ * @param trie pointer to netaddr trie
+ * @param prefix pointer to covering prefix, a zero length prefix
+ *    iterates over all elements of its address family
+ * @param element pointer to a node element
+ *    (don't need to be initialized)
+ * @param node_member name of the netaddr_trie_node element inside the
+ *    larger struct
+ */
+#define netaddr_trie_for_each_covered_element(trie, prefix, element, node_member) \
+  for (element = container_of_if_notnull( \
+         netaddr_trie_first_covered(trie, prefix), typeof(*(element)), node_member); \
+       element != NULL; \
+       element = container_of_if_notnull( \
+         netaddr_trie_next_covered(&(element)->node_member, prefix), typeof(*(element)), node_member))
+
+#endif /* NETADDR_TRIE_H_ */
@@ -0,0 +1,211 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#include "common/common_types.h"
+#include "common/list.h"
+#include "common/radix_heap.h"
+
+static uint8_t _get_bucket(uint32_t last, uint32_t key);
+static void _add_to_bucket(struct radix_heap *heap,
+    struct radix_heap_node *node);
+
+/**
+ * Initialize a new radix heap
+ * @param heap pointer to radix heap
+ */
+void
+radix_heap_init(struct radix_heap *heap) {
+  size_t i;
+
+  for (i=0; i<RADIX_HEAP_BUCKETS; i++) {
+    list_init_head(&heap->_buckets[i]);
+  }
+  heap->_last = 0;
+  heap->count = 0;
+}
+
+/**
+ * Add a node to a radix heap
+ * @param heap pointer to radix heap
+ * @param node pointer to node, must not be part of a heap
+ * @param key key of node, must not be smaller than the key of
+ *   the last extracted node
+ */
+void
+radix_heap_insert(struct radix_heap *heap,
+    struct radix_heap_node *node, uint32_t key) {
+  node->key = key;
+  _add_to_bucket(heap, node);
+  heap->count++;
+}
+
+/**
+ * Change the key of a node in a radix heap to a smaller value
+ * @param heap pointer to radix heap
+ * @param node pointer to node of the heap
+ * @param key new key of node, must not be smaller than the key of
+ *   the last extracted node
+ */
+void
+radix_heap_decrease_key(struct radix_heap *heap,
+    struct radix_heap_node *node, uint32_t key) {
+  list_remove(&node->_list);
+
+  node->key = key;
+  _add_to_bucket(heap, node);
+}
+
+/**
+ * Remove a node from a radix heap
+ * @param heap pointer to radix heap
+ * @param node pointer to node of the heap
+ */
+void
+radix_heap_remove(struct radix_heap *heap, struct radix_heap_node *node) {
+  list_remove(&node->_list);
+
+  heap->count--;
+  if (heap->count == 0) {
+    /* empty heap can start with any key again */
+    heap->_last = 0;
+  }
+}
+
+/**
+ * Remove the node with the smallest key from a radix heap.
+ * Nodes with the same key are extracted in the order they were added.
+ * @param heap pointer to radix heap
+ * @return pointer to node with smallest key, NULL if heap is empty
+ */
+struct radix_heap_node *
+radix_heap_extract_min(struct radix_heap *heap) {
+  struct radix_heap_node *node, *it;
+  struct list_entity bucket;
+  uint32_t min;
+  size_t i;
+
+  if (heap->count == 0) {
+    return NULL;
+  }
+
+  if (list_is_empty(&heap->_buckets[0])) {
+    /* find first non-empty bucket */
+    for (i=1; list_is_empty(&heap->_buckets[i]); i++);
+
+    /* get smallest key of bucket */
+    min = UINT32_MAX;
+    list_for_each_element(&heap->_buckets[i], node, _list) {
+      if (node->key < min) {
+        min = node->key;
+      }
+    }
+
+    /* redistribute bucket, all nodes end up in lower buckets */
+    heap->_last = min;
+
+    list_init_head(&bucket);
+    list_merge(&bucket, &heap->_buckets[i]);
+
+    list_for_each_element_safe(&bucket, node, _list, it) {
+      list_remove(&node->_list);
+      _add_to_bucket(heap, node);
+    }
+  }
+
+  node = list_first_element(&heap->_buckets[0], node, _list);
+  radix_heap_remove(heap, node);
+  return node;
+}
+
+/**
+ * Calculate the bucket index of a key
+ * @param last key of last extracted node
+ * @param key key of node
+ * @return 0 if both keys are the same, position of the highest
+ *   differing bit (starting with 1) otherwise
+ */
+static uint8_t
+_get_bucket(uint32_t last, uint32_t key) {
+  uint32_t diff;
+  uint8_t bucket;
+
+  diff = last ^ key;
+  if (diff == 0) {
+    return 0;
+  }
+
+  bucket = 1;
+  if (diff & 0xffff0000) {
+    bucket += 16;
+    diff >>= 16;
+  }
+  if (diff & 0xff00) {
+    bucket += 8;
+    diff >>= 8;
+  }
+  if (diff & 0xf0) {
+    bucket += 4;
+    diff >>= 4;
+  }
+  if (diff & 0x0c) {
+    bucket += 2;
+    diff >>= 2;
+  }
+  if (diff & 0x02) {
+    bucket += 1;
+  }
+  return bucket;
+}
+
+/**
+ * Add a node to the bucket of its key
+ * @param heap pointer to radix heap
+ * @param node pointer to node
+ */
+static void
+_add_to_bucket(struct radix_heap *heap, struct radix_heap_node *node) {
+  list_add_tail(&heap->_buckets[_get_bucket(heap->_last, node->key)],
+      &node->_list);
+}
@@ -0,0 +1,128 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#ifndef RADIX_HEAP_H_
+#define RADIX_HEAP_H_
+
+#include "common/common_types.h"
+#include "common/container_of.h"
+#include "common/list.h"
+
+/*! number of buckets of a radix heap with 32 bit keys */
+#define RADIX_HEAP_BUCKETS 33
+
+/**
+ * This element is a member of a radix heap. It must be contained in all
+ * larger structs that should be put into a heap.
+ */
+struct radix_heap_node {
+  /*! hook into bucket list of the heap */
+  struct list_entity _list;
+
+  /*! key of the node */
+  uint32_t key;
+};
+
+/**
+ * Monotone priority queue with 32 bit keys.
+ *
+ * The key of a node added to the heap must not be smaller than the key
+ * of the last node extracted from the heap, which is always true for
+ * shortest path algorithms. Insert, decrease-key and remove run in
+ * constant time, extract-min is amortized O(log C) with C as the
+ * key range.
+ */
+struct radix_heap {
+  /*! buckets of nodes, sorted by the highest differing bit to the last key */
+  struct list_entity _buckets[RADIX_HEAP_BUCKETS];
+
+  /*! key of the last extracted node */
+  uint32_t _last;
+
+  /*! number of nodes in the heap */
+  uint32_t count;
+};
+
+EXPORT void radix_heap_init(struct radix_heap *);
+EXPORT void radix_heap_insert(struct radix_heap *,
+    struct radix_heap_node *, uint32_t key);
+EXPORT void radix_heap_decrease_key(struct radix_heap *,
+    struct radix_heap_node *, uint32_t key);
+EXPORT void radix_heap_remove(struct radix_heap *, struct radix_heap_node *);
+EXPORT struct radix_heap_node *radix_heap_extract_min(struct radix_heap *);
+
+/**
+ * @param heap pointer to radix heap
+ * @return true if the heap is empty, false otherwise
+ */
+static INLINE bool
+radix_heap_is_empty(const struct radix_heap *heap) {
+  return heap->count == 0;
+}
+
+/**
+ * @param node pointer to radix heap node
+ * @return true if node is currently in a heap, false otherwise
+ */
+static INLINE bool
+radix_heap_is_node_added(const struct radix_heap_node *node) {
+  return list_is_node_added(&node->_list);
+}
+
+/**
+ * Remove the node with the smallest key from the heap
+ * @param heap pointer to radix heap
+ * @param element pointer to a node element
+ *    (don't need to be initialized)
+ * @param node_member name of the radix_heap_node element inside the
+ *    larger struct
+ * @return pointer to the element with the smallest key
+ *    (automatically converted to type 'element'),
+ *    NULL if heap is empty
+ */
+#define radix_heap_extract_min_element(heap, element, node_member) \
+  container_of_if_notnull(radix_heap_extract_min(heap), typeof(*(element)), node_member)
+
+#endif /* RADIX_HEAP_H_ */
@@ -0,0 +1,235 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "common/common_types.h"
+#include "common/list.h"
+#include "common/slab.h"
+
+static size_t _roundup(size_t size);
+static struct slab_page *_alloc_page(struct slab *slab);
+static void _free_page(struct slab *slab, struct slab_page *page);
+
+/**
+ * Initialize a slab allocator. The allocator must not
+ * contain any pages.
+ * @param slab pointer to slab allocator
+ * @param object_size size of objects in bytes
+ */
+void
+slab_init(struct slab *slab, size_t object_size) {
+  size_t header;
+
+  memset(slab, 0, sizeof(*slab));
+  list_init_head(&slab->_partial);
+  list_init_head(&slab->_full);
+
+  slab->object_size = _roundup(object_size < sizeof(void *) ? sizeof(void *) : object_size);
+
+  /* use larger pages until enough objects fit into one */
+  header = _roundup(sizeof(struct slab_page));
+  slab->page_size = SLAB_MIN_PAGE_SIZE;
+  while ((slab->page_size - header) / slab->object_size < SLAB_MIN_OBJECTS
+      && slab->page_size < SLAB_MAX_PAGE_SIZE) {
+    slab->page_size *= 2;
+  }
+  while (slab->page_size - header < slab->object_size) {
+    slab->page_size *= 2;
+  }
+  slab->objects_per_page = (slab->page_size - header) / slab->object_size;
+}
+
+/**
+ * Allocate a zeroed object from a slab allocator
+ * @param slab pointer to slab allocator
+ * @return pointer to object, NULL if out of memory
+ */
+void *
+slab_alloc(struct slab *slab) {
+  struct slab_page *page;
+  void *ptr;
+
+  if (list_is_empty(&slab->_partial)) {
+    page = _alloc_page(slab);
+    if (page == NULL) {
+      return NULL;
+    }
+    list_add_head(&slab->_partial, &page->_node);
+  }
+  else {
+    page = list_first_element(&slab->_partial, page, _node);
+  }
+
+  if (page->_free != NULL) {
+    /* reuse a freed object */
+    ptr = page->_free;
+    memcpy(&page->_free, ptr, sizeof(page->_free));
+    slab->recycled++;
+  }
+  else {
+    /* carve a new object from the page */
+    ptr = ((char *)page) + _roundup(sizeof(*page))
+        + (size_t)page->carved * slab->object_size;
+    page->carved++;
+    slab->allocated++;
+  }
+
+  if (page->used == 0) {
+    slab->empty_pages--;
+  }
+  page->used++;
+  slab->used++;
+
+  if (page->used == slab->objects_per_page) {
+    list_remove(&page->_node);
+    list_add_tail(&slab->_full, &page->_node);
+  }
+
+  memset(ptr, 0, slab->object_size);
+  return ptr;
+}
+
+/**
+ * Return an object to its slab allocator
+ * @param slab pointer to slab allocator
+ * @param ptr pointer to object allocated by this slab allocator
+ */
+void
+slab_free(struct slab *slab, void *ptr) {
+  struct slab_page *page;
+
+  page = (struct slab_page *)((uintptr_t)ptr & ~((uintptr_t)slab->page_size - 1));
+
+  memcpy(ptr, &page->_free, sizeof(page->_free));
+  page->_free = ptr;
+
+  if (page->used == slab->objects_per_page) {
+    /* page has a free object again */
+    list_remove(&page->_node);
+    list_add_head(&slab->_partial, &page->_node);
+  }
+
+  page->used--;
+  slab->used--;
+
+  if (page->used > 0) {
+    return;
+  }
+
+  if (slab->empty_pages >= SLAB_KEEP_EMPTY_PAGES) {
+    list_remove(&page->_node);
+    _free_page(slab, page);
+  }
+  else {
+    /* keep page to prevent flapping at a page boundary, but use it last */
+    slab->empty_pages++;
+    list_remove(&page->_node);
+    list_add_tail(&slab->_partial, &page->_node);
+  }
+}
+
+/**
+ * Return all empty pages of a slab allocator to the system
+ * @param slab pointer to slab allocator
+ */
+void
+slab_release_empty(struct slab *slab) {
+  struct slab_page *page, *it;
+
+  list_for_each_element_safe(&slab->_partial, page, _node, it) {
+    if (page->used == 0) {
+      list_remove(&page->_node);
+      _free_page(slab, page);
+      slab->empty_pages--;
+    }
+  }
+}
+
+/**
+ * @param size memory size in byte
+ * @return rounded up size to sizeof(struct list_entity)
+ */
+static size_t
+_roundup(size_t size) {
+  size = size + sizeof(struct list_entity) - 1;
+  size = size & (~(sizeof(struct list_entity) - 1));
+
+  return size;
+}
+
+/**
+ * Allocate a new empty page, aligned to the page size
+ * @param slab pointer to slab allocator
+ * @return pointer to page, NULL if out of memory
+ */
+static struct slab_page *
+_alloc_page(struct slab *slab) {
+  struct slab_page *page;
+  void *ptr;
+
+  if (posix_memalign(&ptr, slab->page_size, slab->page_size)) {
+    return NULL;
+  }
+
+  page = ptr;
+  memset(page, 0, sizeof(*page));
+
+  slab->pages++;
+  slab->empty_pages++;
+  return page;
+}
+
+/**
+ * Free an empty page
+ * @param slab pointer to slab allocator
+ * @param page pointer to page, must not be in a page list
+ */
+static void
+_free_page(struct slab *slab, struct slab_page *page) {
+  free(page);
+  slab->pages--;
+}
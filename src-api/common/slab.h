@@ -0,0 +1,149 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#ifndef SLAB_H_
+#define SLAB_H_
+
+#include "common/common_types.h"
+#include "common/list.h"
+
+/**
+ * smallest page size of a slab allocator, small enough that
+ * the pages of rarely used classes do not waste memory
+ */
+#define SLAB_MIN_PAGE_SIZE 512
+
+/*! largest page size used to fit more objects into a page */
+#define SLAB_MAX_PAGE_SIZE 65536
+
+/*! number of objects a page should hold at least */
+#define SLAB_MIN_OBJECTS 8
+
+/*! number of empty pages kept by a slab allocator for reuse */
+#define SLAB_KEEP_EMPTY_PAGES 1
+
+/**
+ * Header of a page of a slab allocator. The page is aligned to its own
+ * size, so the header of an object can be calculated from its address.
+ */
+struct slab_page {
+  /*! hook into the page lists of the slab */
+  struct list_entity _node;
+
+  /*! singly linked list of freed objects of this page */
+  void *_free;
+
+  /*! number of objects in use */
+  uint32_t used;
+
+  /*! number of objects carved out of the page so far */
+  uint32_t carved;
+};
+
+/**
+ * Slab allocator for objects of a single size. Objects are carved
+ * from pages allocated on demand, fully empty pages are returned
+ * to the system allocator.
+ */
+struct slab {
+  /*! pages with at least one free object, empty pages at the end */
+  struct list_entity _partial;
+
+  /*! pages without free objects */
+  struct list_entity _full;
+
+  /*! size of an object in bytes */
+  size_t object_size;
+
+  /*! size of a page in bytes */
+  size_t page_size;
+
+  /*! number of objects per page */
+  uint32_t objects_per_page;
+
+  /*! number of allocated pages */
+  uint32_t pages;
+
+  /*! number of allocated pages without objects in use */
+  uint32_t empty_pages;
+
+  /*! number of objects in use */
+  uint32_t used;
+
+  /*! Stats, objects carved from fresh page memory */
+  uint32_t allocated;
+
+  /*! Stats, freed objects used again */
+  uint32_t recycled;
+};
+
+EXPORT void slab_init(struct slab *, size_t object_size);
+EXPORT void *slab_alloc(struct slab *);
+EXPORT void slab_free(struct slab *, void *);
+EXPORT void slab_release_empty(struct slab *);
+
+/**
+ * @param slab pointer to slab allocator
+ * @return number of unused objects in allocated pages
+ */
+static INLINE uint32_t
+slab_get_free(const struct slab *slab) {
+  return slab->pages * slab->objects_per_page - slab->used;
+}
+
+/**
+ * @param slab pointer to slab allocator
+ * @return percentage of allocated page memory not used by objects
+ */
+static INLINE uint32_t
+slab_get_fragmentation(const struct slab *slab) {
+  if (slab->pages == 0) {
+    return 0;
+  }
+  return 100 - (uint32_t)((uint64_t)slab->used * slab->object_size * 100
+      / ((uint64_t)slab->pages * slab->page_size));
+}
+
+#endif /* SLAB_H_ */
@@ -0,0 +1,405 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#include "common/common_types.h"
+#include "common/list.h"
+#include "common/timer_wheel.h"
+
+static uint8_t _get_level(uint64_t base, uint64_t key);
+static void _add_to_slot(struct timer_wheel *wheel,
+    struct timer_wheel_node *node);
+static void _advance(struct timer_wheel *wheel, uint64_t tick);
+static void _redistribute(struct timer_wheel *wheel, struct list_entity *slot);
+static struct timer_wheel_node *_get_min_node(struct list_entity *slot);
+static uint64_t _get_next_slot(struct timer_wheel *wheel);
+static uint64_t _find_next(struct timer_wheel *wheel);
+
+/**
+ * Initialize a new timer wheel
+ * @param wheel pointer to timer wheel
+ * @param tick current tick
+ */
+void
+timer_wheel_init(struct timer_wheel *wheel, uint64_t tick) {
+  size_t i, j;
+
+  for (i=0; i<TIMER_WHEEL_LEVELS; i++) {
+    for (j=0; j<TIMER_WHEEL_SLOTS; j++) {
+      list_init_head(&wheel->_slots[i][j]);
+    }
+  }
+  list_init_head(&wheel->_overflow);
+  list_init_head(&wheel->_expired);
+
+  wheel->_base = tick;
+  wheel->_next = 0;
+  wheel->_next_valid = false;
+  wheel->_seq = 0;
+  wheel->count = 0;
+}
+
+/**
+ * Add a node to a timer wheel
+ * @param wheel pointer to timer wheel
+ * @param node pointer to node, must not be part of a wheel
+ * @param key tick when the node expires
+ */
+void
+timer_wheel_insert(struct timer_wheel *wheel,
+    struct timer_wheel_node *node, uint64_t key) {
+  node->key = key;
+  node->_seq = wheel->_seq++;
+  if (key < wheel->_base) {
+    list_add_tail(&wheel->_expired, &node->_list);
+  }
+  else {
+    _add_to_slot(wheel, node);
+  }
+
+  if (wheel->count == 0) {
+    wheel->_next = key;
+    wheel->_next_valid = true;
+  }
+  else if (wheel->_next_valid && key < wheel->_next) {
+    wheel->_next = key;
+  }
+  wheel->count++;
+}
+
+/**
+ * Remove a node from a timer wheel
+ * @param wheel pointer to timer wheel
+ * @param node pointer to node of the wheel
+ */
+void
+timer_wheel_remove(struct timer_wheel *wheel, struct timer_wheel_node *node) {
+  list_remove(&node->_list);
+  wheel->count--;
+
+  if (node->key <= wheel->_next || wheel->count == 0) {
+    wheel->_next_valid = false;
+  }
+}
+
+/**
+ * Get the node which expires first, if it is not later than the current
+ * tick. The node stays in the wheel. Nodes with the same key are returned
+ * in the order they were added.
+ * @param wheel pointer to timer wheel
+ * @param tick current tick, must not be smaller than the tick of
+ *   the last call
+ * @return pointer to expired node, NULL if no node has expired
+ */
+struct timer_wheel_node *
+timer_wheel_get_expired(struct timer_wheel *wheel, uint64_t tick) {
+  struct timer_wheel_node *node;
+  uint64_t target;
+
+  if (wheel->count == 0 || (wheel->_next_valid && wheel->_next > tick)) {
+    /* nothing to do, but keep the wheel up to date */
+    _advance(wheel, tick);
+    return NULL;
+  }
+
+  if (!list_is_empty(&wheel->_expired)) {
+    return _get_min_node(&wheel->_expired);
+  }
+
+  while (true) {
+    /* check current slot, its key is the current tick */
+    if (!list_is_empty(&wheel->_slots[0][wheel->_base & (TIMER_WHEEL_SLOTS - 1)])) {
+      node = list_first_element(
+          &wheel->_slots[0][wheel->_base & (TIMER_WHEEL_SLOTS - 1)], node, _list);
+      return node;
+    }
+
+    /* get start of next non-empty slot */
+    target = _get_next_slot(wheel);
+    if (target > tick) {
+      _advance(wheel, tick);
+      return NULL;
+    }
+
+    /* move the nodes of the slot to level 0 */
+    _advance(wheel, target);
+  }
+}
+
+/**
+ * @param wheel pointer to timer wheel
+ * @return key of the node which expires first, UINT64_MAX if the
+ *   wheel is empty
+ */
+uint64_t
+timer_wheel_get_next(struct timer_wheel *wheel) {
+  if (wheel->count == 0) {
+    return UINT64_MAX;
+  }
+
+  if (!wheel->_next_valid) {
+    wheel->_next = _find_next(wheel);
+    wheel->_next_valid = true;
+  }
+  return wheel->_next;
+}
+
+/**
+ * Call a function for each node of the timer wheel. The callback
+ * is allowed to remove the node it was called for, but no other one.
+ * @param wheel pointer to timer wheel
+ * @param cb callback for each node
+ * @param ptr custom pointer for callback
+ */
+void
+timer_wheel_for_each(struct timer_wheel *wheel,
+    void (*cb)(struct timer_wheel_node *, void *), void *ptr) {
+  struct timer_wheel_node *node, *it;
+  size_t i, j;
+
+  list_for_each_element_safe(&wheel->_expired, node, _list, it) {
+    cb(node, ptr);
+  }
+  for (i=0; i<TIMER_WHEEL_LEVELS; i++) {
+    for (j=0; j<TIMER_WHEEL_SLOTS; j++) {
+      list_for_each_element_safe(&wheel->_slots[i][j], node, _list, it) {
+        cb(node, ptr);
+      }
+    }
+  }
+  list_for_each_element_safe(&wheel->_overflow, node, _list, it) {
+    cb(node, ptr);
+  }
+}
+
+/**
+ * Calculate the level of the wheel for a key
+ * @param base current tick of the wheel
+ * @param key key of node
+ * @return index of the highest byte which differs between both
+ *   ticks, 0 if they are the same
+ */
+static uint8_t
+_get_level(uint64_t base, uint64_t key) {
+  uint64_t diff;
+  uint8_t level;
+
+  diff = (base ^ key) >> TIMER_WHEEL_BITS;
+  for (level = 0; diff; level++) {
+    diff >>= TIMER_WHEEL_BITS;
+  }
+  return level;
+}
+
+/**
+ * Add a node to the slot of its key. Each slot is sorted by the
+ * sequence number of the nodes, so a node moved down from a higher
+ * level does not overtake nodes with the same key which were added
+ * before it.
+ * @param wheel pointer to timer wheel
+ * @param node pointer to node, key must not be smaller than
+ *   the current tick of the wheel
+ */
+static void
+_add_to_slot(struct timer_wheel *wheel, struct timer_wheel_node *node) {
+  struct timer_wheel_node *prev;
+  struct list_entity *head;
+  uint8_t level;
+
+  level = _get_level(wheel->_base, node->key);
+  if (level >= TIMER_WHEEL_LEVELS) {
+    head = &wheel->_overflow;
+  }
+  else {
+    head = &wheel->_slots[level]
+        [(node->key >> (level * TIMER_WHEEL_BITS)) & (TIMER_WHEEL_SLOTS - 1)];
+  }
+
+  /* new nodes have the highest sequence number, so this loop is usually empty */
+  list_for_each_element_reverse(head, prev, _list) {
+    if (prev->_seq < node->_seq) {
+      list_add_after(&prev->_list, &node->_list);
+      return;
+    }
+  }
+  list_add_head(head, &node->_list);
+}
+
+/**
+ * Move the current tick of the wheel forward and move the nodes
+ * of the reached slot to the lower levels.
+ * @param wheel pointer to timer wheel
+ * @param tick new tick of wheel, must not be larger than the key
+ *   of any node in the slots of the wheel
+ */
+static void
+_advance(struct timer_wheel *wheel, uint64_t tick) {
+  uint8_t level;
+  size_t slot;
+
+  if (tick <= wheel->_base) {
+    return;
+  }
+
+  /* all levels below this one are empty */
+  level = _get_level(wheel->_base, tick);
+  wheel->_base = tick;
+
+  if (level == 0) {
+    /* nothing to move */
+    return;
+  }
+  if (level >= TIMER_WHEEL_LEVELS) {
+    _redistribute(wheel, &wheel->_overflow);
+    return;
+  }
+
+  slot = (tick >> (level * TIMER_WHEEL_BITS)) & (TIMER_WHEEL_SLOTS - 1);
+  _redistribute(wheel, &wheel->_slots[level][slot]);
+}
+
+/**
+ * Add all nodes of a slot again to the wheel
+ * @param wheel pointer to timer wheel
+ * @param slot pointer to list head of slot
+ */
+static void
+_redistribute(struct timer_wheel *wheel, struct list_entity *slot) {
+  struct timer_wheel_node *node, *it;
+  struct list_entity list;
+
+  list_init_head(&list);
+  list_merge(&list, slot);
+
+  list_for_each_element_safe(&list, node, _list, it) {
+    list_remove(&node->_list);
+    _add_to_slot(wheel, node);
+  }
+}
+
+/**
+ * @param slot pointer to list head of slot
+ * @return first node with the smallest key of the slot,
+ *   NULL if slot is empty
+ */
+static struct timer_wheel_node *
+_get_min_node(struct list_entity *slot) {
+  struct timer_wheel_node *node, *min;
+
+  min = NULL;
+  list_for_each_element(slot, node, _list) {
+    if (min == NULL || node->key < min->key) {
+      min = node;
+    }
+  }
+  return min;
+}
+
+/**
+ * Get the first tick of the next non-empty slot after the current
+ * tick, all nodes of the wheel are at this tick or later.
+ * @param wheel pointer to timer wheel without expired nodes
+ * @return first tick of the next slot, UINT64_MAX if wheel is empty
+ */
+static uint64_t
+_get_next_slot(struct timer_wheel *wheel) {
+  struct timer_wheel_node *node;
+  uint64_t prefix;
+  size_t level, slot, shift;
+
+  for (level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+    shift = level * TIMER_WHEEL_BITS;
+    slot = (wheel->_base >> shift) & (TIMER_WHEEL_SLOTS - 1);
+
+    /* all bits above this level are the same for all nodes of the level */
+    prefix = (wheel->_base >> shift) >> TIMER_WHEEL_BITS << TIMER_WHEEL_BITS << shift;
+
+    for (slot++; slot < TIMER_WHEEL_SLOTS; slot++) {
+      if (!list_is_empty(&wheel->_slots[level][slot])) {
+        return prefix | ((uint64_t)slot << shift);
+      }
+    }
+  }
+
+  if (list_is_empty(&wheel->_overflow)) {
+    return UINT64_MAX;
+  }
+
+  node = _get_min_node(&wheel->_overflow);
+  return node->key;
+}
+
+/**
+ * @param wheel pointer to non-empty timer wheel
+ * @return smallest key of all nodes in the wheel
+ */
+static uint64_t
+_find_next(struct timer_wheel *wheel) {
+  struct timer_wheel_node *node;
+  size_t level, slot;
+
+  if (!list_is_empty(&wheel->_expired)) {
+    return _get_min_node(&wheel->_expired)->key;
+  }
+
+  for (level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+    slot = (wheel->_base >> (level * TIMER_WHEEL_BITS)) & (TIMER_WHEEL_SLOTS - 1);
+    for (; slot < TIMER_WHEEL_SLOTS; slot++) {
+      if (list_is_empty(&wheel->_slots[level][slot])) {
+        continue;
+      }
+
+      if (level == 0) {
+        /* all nodes of a level 0 slot have the same key */
+        node = list_first_element(&wheel->_slots[0][slot], node, _list);
+      }
+      else {
+        node = _get_min_node(&wheel->_slots[level][slot]);
+      }
+      return node->key;
+    }
+  }
+
+  return _get_min_node(&wheel->_overflow)->key;
+}
@@ -0,0 +1,158 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#ifndef TIMER_WHEEL_H_
+#define TIMER_WHEEL_H_
+
+#include "common/common_types.h"
+#include "common/container_of.h"
+#include "common/list.h"
+
+/*! number of bits of a tick handled by each level of the wheel */
+#define TIMER_WHEEL_BITS 8
+
+/*! number of slots of each level of the wheel */
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_BITS)
+
+/*! number of levels of the wheel, covers 2^32 ticks */
+#define TIMER_WHEEL_LEVELS 4
+
+/**
+ * This element is a member of a timer wheel. It must be contained in all
+ * larger structs that should be put into a wheel.
+ */
+struct timer_wheel_node {
+  /*! hook into slot list of the wheel */
+  struct list_entity _list;
+
+  /*! tick when the node expires */
+  uint64_t key;
+
+  /*! insertion order of the node, keeps nodes with the same key in order */
+  uint64_t _seq;
+};
+
+/**
+ * Hierarchical timing wheel with 64 bit ticks.
+ *
+ * A node is stored in the level of the highest byte its tick differs from
+ * the current tick of the wheel, in the slot selected by this byte. So all
+ * nodes in a lower level expire before all nodes of a higher level and the
+ * nodes of level 0 are sorted by their slot. Nodes beyond the range of the
+ * highest level are kept in an overflow list.
+ *
+ * Insert and remove run in constant time, each node is moved down at most
+ * once per level until it expires.
+ */
+struct timer_wheel {
+  /*! slots of all levels */
+  struct list_entity _slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+
+  /*! nodes too far in the future for the wheel */
+  struct list_entity _overflow;
+
+  /*! nodes added with a key before the current tick */
+  struct list_entity _expired;
+
+  /*! current tick of the wheel */
+  uint64_t _base;
+
+  /*! cached tick of the next expiring node */
+  uint64_t _next;
+
+  /*! true if _next is valid */
+  bool _next_valid;
+
+  /*! sequence number for the next inserted node */
+  uint64_t _seq;
+
+  /*! number of nodes in the wheel */
+  uint32_t count;
+};
+
+EXPORT void timer_wheel_init(struct timer_wheel *, uint64_t tick);
+EXPORT void timer_wheel_insert(struct timer_wheel *,
+    struct timer_wheel_node *, uint64_t key);
+EXPORT void timer_wheel_remove(struct timer_wheel *, struct timer_wheel_node *);
+EXPORT struct timer_wheel_node *timer_wheel_get_expired(
+    struct timer_wheel *, uint64_t tick);
+EXPORT uint64_t timer_wheel_get_next(struct timer_wheel *);
+EXPORT void timer_wheel_for_each(struct timer_wheel *,
+    void (*cb)(struct timer_wheel_node *, void *), void *ptr);
+
+/**
+ * @param wheel pointer to timer wheel
+ * @return true if the wheel is empty, false otherwise
+ */
+static INLINE bool
+timer_wheel_is_empty(const struct timer_wheel *wheel) {
+  return wheel->count == 0;
+}
+
+/**
+ * @param node pointer to timer wheel node
+ * @return true if node is currently in a wheel, false otherwise
+ */
+static INLINE bool
+timer_wheel_is_node_added(const struct timer_wheel_node *node) {
+  return list_is_node_added(&node->_list);
+}
+
+/**
+ * Get the first expired node of a timer wheel without removing it
+ * @param wheel pointer to timer wheel
+ * @param tick current tick
+ * @param element pointer to a node element
+ *    (don't need to be initialized)
+ * @param node_member name of the timer_wheel_node element inside the
+ *    larger struct
+ * @return pointer to the first element with a key not larger than tick
+ *    (automatically converted to type 'element'),
+ *    NULL if no element has expired
+ */
+#define timer_wheel_get_expired_element(wheel, tick, element, node_member) \
+  container_of_if_notnull(timer_wheel_get_expired(wheel, tick), typeof(*(element)), node_member)
+
+#endif /* TIMER_WHEEL_H_ */
@@ -0,0 +1,674 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "common/common_types.h"
+#include "common/netaddr.h"
+#include "common/trace_buffer.h"
+
+/*! length of the fixed part of a site record */
+#define SITE_HEADER_LENGTH 12
+
+/*! length of the fixed part of an event record */
+#define EVENT_HEADER_LENGTH 21
+
+static uint32_t _get_u32(const uint8_t *ptr);
+static uint32_t _align(size_t len);
+static size_t _get_arg_length(const struct trace_arg *arg);
+static uint32_t _reserve_event(struct trace_buffer *, uint32_t len);
+static bool _parse_event(const uint8_t *ptr, uint32_t len, struct trace_event *event);
+static size_t _format_arg(char *dst, size_t len,
+    const char *spec, size_t spec_len, char conversion, const struct trace_arg *arg);
+
+/**
+ * Initialize an empty trace buffer inside a block of memory
+ * @param tb pointer to trace buffer
+ * @param mem pointer to memory block
+ * @param size size of memory block
+ * @return -1 if memory block is too small, 0 otherwise
+ */
+int
+trace_buffer_init(struct trace_buffer *tb, void *mem, size_t size) {
+  struct trace_buffer_header *header;
+
+  if (size < TRACE_BUFFER_MIN_SIZE || size > UINT32_MAX) {
+    return -1;
+  }
+
+  memset(mem, 0, sizeof(*header));
+  header = mem;
+
+  memcpy(header->magic, TRACE_BUFFER_MAGIC, sizeof(TRACE_BUFFER_MAGIC));
+  header->version = TRACE_BUFFER_VERSION;
+
+  /* one eighth of the buffer is used for site definitions */
+  header->site_offset = _align(sizeof(*header));
+  header->site_size = _align(size / 8);
+  header->event_offset = header->site_offset + header->site_size;
+  header->event_size = (size - header->event_offset) & ~3u;
+
+  return trace_buffer_attach(tb, mem, size);
+}
+
+/**
+ * Attach a trace buffer to an initialized block of memory
+ * @param tb pointer to trace buffer
+ * @param mem pointer to memory block
+ * @param size size of memory block
+ * @return -1 if memory block does not contain a valid trace buffer,
+ *   0 otherwise
+ */
+int
+trace_buffer_attach(struct trace_buffer *tb, void *mem, size_t size) {
+  struct trace_buffer_header *header = mem;
+
+  if (size < sizeof(*header)
+      || memcmp(header->magic, TRACE_BUFFER_MAGIC, sizeof(TRACE_BUFFER_MAGIC)) != 0
+      || header->version != TRACE_BUFFER_VERSION) {
+    return -1;
+  }
+
+  /* check consistency of the layout */
+  if (header->site_offset < sizeof(*header)
+      || header->site_used > header->site_size
+      || (size_t)header->site_offset + header->site_size > header->event_offset
+      || (size_t)header->event_offset + header->event_size > size
+      || header->event_head > header->event_size
+      || header->event_tail > header->event_size
+      || header->event_wrap > header->event_size) {
+    return -1;
+  }
+
+  tb->header = header;
+  tb->_sites = (uint8_t *)mem + header->site_offset;
+  tb->_events = (uint8_t *)mem + header->event_offset;
+  return 0;
+}
+
+/**
+ * Add a new site definition to a trace buffer
+ * @param tb pointer to trace buffer
+ * @param file source code file of site
+ * @param line source code line of site
+ * @param severity name of severity of site
+ * @param source name of logging source of site
+ * @param format printf style format string of site
+ * @return id of the new site, 0 if site region is full
+ */
+uint32_t
+trace_buffer_add_site(struct trace_buffer *tb,
+    const char *file, int line, const char *severity,
+    const char *source, const char *format) {
+  const char *strings[4];
+  size_t len[4];
+  uint32_t record_len, id;
+  uint8_t *ptr;
+  int32_t line32;
+  size_t i;
+
+  strings[0] = file;
+  strings[1] = severity;
+  strings[2] = source;
+  strings[3] = format;
+
+  record_len = SITE_HEADER_LENGTH;
+  for (i=0; i<ARRAYSIZE(strings); i++) {
+    len[i] = strlen(strings[i]) + 1;
+    record_len += len[i];
+  }
+  record_len = _align(record_len);
+
+  if (record_len > tb->header->site_size - tb->header->site_used) {
+    tb->header->site_lost++;
+    return 0;
+  }
+
+  id = tb->header->site_count + 1;
+  line32 = line;
+
+  ptr = tb->_sites + tb->header->site_used;
+  memset(ptr, 0, record_len);
+  memcpy(&ptr[0], &record_len, 4);
+  memcpy(&ptr[4], &id, 4);
+  memcpy(&ptr[8], &line32, 4);
+
+  ptr += SITE_HEADER_LENGTH;
+  for (i=0; i<ARRAYSIZE(strings); i++) {
+    memcpy(ptr, strings[i], len[i]);
+    ptr += len[i];
+  }
+
+  /* publish site after it has been written completely */
+  tb->header->site_used += record_len;
+  tb->header->site_count = id;
+  return id;
+}
+
+/**
+ * Add a new event to the ring buffer of a trace buffer,
+ * overwriting the oldest events if necessary.
+ * @param tb pointer to trace buffer
+ * @param site_id id of the site generating the event
+ * @param time walltime of the event
+ * @param args array of event arguments
+ * @param count number of event arguments
+ */
+void
+trace_buffer_add_event(struct trace_buffer *tb, uint32_t site_id,
+    const struct timeval *time, const struct trace_arg *args, size_t count) {
+  uint32_t record_len, pos, u32;
+  uint64_t u64;
+  size_t i, len;
+  uint8_t *ptr;
+
+  if (count > TRACE_BUFFER_MAX_ARGS) {
+    count = TRACE_BUFFER_MAX_ARGS;
+  }
+
+  len = EVENT_HEADER_LENGTH;
+  for (i=0; i<count; i++) {
+    len += _get_arg_length(&args[i]);
+  }
+  record_len = _align(len);
+
+  pos = _reserve_event(tb, record_len);
+  ptr = tb->_events + pos;
+
+  memcpy(&ptr[0], &record_len, 4);
+  memcpy(&ptr[4], &site_id, 4);
+  u64 = time->tv_sec;
+  memcpy(&ptr[8], &u64, 8);
+  u32 = time->tv_usec;
+  memcpy(&ptr[16], &u32, 4);
+  ptr[20] = count;
+  ptr += EVENT_HEADER_LENGTH;
+
+  for (i=0; i<count; i++) {
+    *ptr++ = args[i].type;
+
+    switch (args[i].type) {
+      case TRACE_ARG_U32:
+      case TRACE_ARG_S32:
+        u32 = args[i].value.u64;
+        memcpy(ptr, &u32, 4);
+        ptr += 4;
+        break;
+      case TRACE_ARG_U64:
+      case TRACE_ARG_S64:
+        memcpy(ptr, &args[i].value.u64, 8);
+        ptr += 8;
+        break;
+      case TRACE_ARG_NETADDR:
+        memcpy(ptr, args[i].value.addr, sizeof(struct netaddr));
+        ptr += sizeof(struct netaddr);
+        break;
+      case TRACE_ARG_STRING:
+      default:
+        len = _get_arg_length(&args[i]) - 3;
+        *ptr++ = len;
+        memcpy(ptr, args[i].value.str, len);
+        ptr[len] = 0;
+        ptr += len + 1;
+        break;
+    }
+  }
+
+  /* publish event after it has been written completely */
+  tb->header->event_head = pos + record_len;
+  tb->header->event_count++;
+}
+
+/**
+ * Look up the definition of a trace site
+ * @param tb pointer to trace buffer
+ * @param site pointer to site definition, will be filled by this function
+ * @param id id of site
+ * @return true if site was found, false otherwise
+ */
+bool
+trace_buffer_get_site(const struct trace_buffer *tb,
+    struct trace_site *site, uint32_t id) {
+  const char **strings[4];
+  const uint8_t *ptr, *end;
+  uint32_t pos, len, site_id;
+  int32_t line32;
+  size_t i;
+
+  strings[0] = &site->file;
+  strings[1] = &site->severity;
+  strings[2] = &site->source;
+  strings[3] = &site->format;
+
+  pos = 0;
+  while (pos + SITE_HEADER_LENGTH <= tb->header->site_used) {
+    ptr = tb->_sites + pos;
+    len = _get_u32(ptr);
+    if (len < SITE_HEADER_LENGTH || len > tb->header->site_used - pos) {
+      /* corrupted site region */
+      return false;
+    }
+
+    site_id = _get_u32(ptr + 4);
+    if (site_id == id) {
+      end = ptr + len;
+      memcpy(&line32, ptr + 8, 4);
+
+      site->id = id;
+      site->line = line32;
+
+      ptr += SITE_HEADER_LENGTH;
+      for (i=0; i<ARRAYSIZE(strings); i++) {
+        *strings[i] = (const char *)ptr;
+        ptr = memchr(ptr, 0, end - ptr);
+        if (ptr == NULL) {
+          return false;
+        }
+        ptr++;
+      }
+      return true;
+    }
+    pos += len;
+  }
+  return false;
+}
+
+/**
+ * Initialize an iterator over the events of a trace buffer
+ * @param tb pointer to trace buffer
+ * @param iterator pointer to iterator
+ */
+void
+trace_buffer_iterator_init(const struct trace_buffer *tb,
+    struct trace_buffer_iterator *iterator) {
+  iterator->_pos = tb->header->event_tail;
+  iterator->_wrapped = tb->header->event_wrap != 0;
+  iterator->_end = iterator->_wrapped
+      ? tb->header->event_wrap : tb->header->event_head;
+}
+
+/**
+ * Get the next event of a trace buffer
+ * @param tb pointer to trace buffer
+ * @param iterator pointer to iterator
+ * @param event pointer to event, will be filled by this function
+ * @return true if an event was returned, false if there are no further
+ *   events or the ring buffer is corrupted
+ */
+bool
+trace_buffer_iterator_next(const struct trace_buffer *tb,
+    struct trace_buffer_iterator *iterator, struct trace_event *event) {
+  uint32_t len;
+
+  if (iterator->_pos >= iterator->_end && iterator->_wrapped) {
+    /* continue at the start of the ring buffer */
+    iterator->_wrapped = false;
+    iterator->_pos = 0;
+    iterator->_end = tb->header->event_head;
+  }
+
+  if (iterator->_pos + EVENT_HEADER_LENGTH > iterator->_end) {
+    return false;
+  }
+
+  len = _get_u32(tb->_events + iterator->_pos);
+  if (len < EVENT_HEADER_LENGTH || len > iterator->_end - iterator->_pos) {
+    return false;
+  }
+
+  if (!_parse_event(tb->_events + iterator->_pos, len, event)) {
+    return false;
+  }
+
+  iterator->_pos += len;
+  return true;
+}
+
+/**
+ * Generate the text of a trace event. The format string supports the
+ * printf conversions for integers and strings, length modifiers are
+ * ignored and replaced according to the argument type.
+ * Network addresses are printed with a string conversion.
+ * @param dst pointer to output buffer
+ * @param len length of output buffer
+ * @param format printf style format string
+ * @param args array of event arguments
+ * @param count number of event arguments
+ * @return length of generated text
+ */
+size_t
+trace_format(char *dst, size_t len, const char *format,
+    const struct trace_arg *args, size_t count) {
+  const char *spec;
+  size_t spec_len, out, arg;
+
+  if (len == 0) {
+    return 0;
+  }
+
+  out = 0;
+  arg = 0;
+  while (*format && out + 1 < len) {
+    if (*format != '%') {
+      dst[out++] = *format++;
+      continue;
+    }
+    if (format[1] == '%') {
+      dst[out++] = '%';
+      format += 2;
+      continue;
+    }
+
+    /* copy flags, width and precision */
+    spec = format++;
+    while (*format && strchr("-+ #0123456789.", *format) != NULL) {
+      format++;
+    }
+    spec_len = format - spec;
+
+    /* skip length modifiers */
+    while (*format && strchr("hlLqjzt", *format) != NULL) {
+      format++;
+    }
+    if (*format == 0) {
+      break;
+    }
+
+    if (arg < count) {
+      out += _format_arg(&dst[out], len - out, spec, spec_len, *format, &args[arg++]);
+    }
+    format++;
+  }
+
+  dst[out] = 0;
+  return out;
+}
+
+/**
+ * @param ptr pointer to (unaligned) 32 bit integer
+ * @return value of integer
+ */
+static uint32_t
+_get_u32(const uint8_t *ptr) {
+  uint32_t value;
+
+  memcpy(&value, ptr, 4);
+  return value;
+}
+
+/**
+ * @param len length of record
+ * @return record length aligned to four bytes
+ */
+static uint32_t
+_align(size_t len) {
+  return (len + 3) & ~(size_t)3;
+}
+
+/**
+ * @param arg pointer to event argument
+ * @return number of bytes necessary to store argument including type
+ */
+static size_t
+_get_arg_length(const struct trace_arg *arg) {
+  size_t len;
+
+  switch (arg->type) {
+    case TRACE_ARG_U32:
+    case TRACE_ARG_S32:
+      return 1 + 4;
+    case TRACE_ARG_U64:
+    case TRACE_ARG_S64:
+      return 1 + 8;
+    case TRACE_ARG_NETADDR:
+      return 1 + sizeof(struct netaddr);
+    case TRACE_ARG_STRING:
+    default:
+      len = arg->value.str == NULL ? 0 : strlen(arg->value.str);
+      if (len > TRACE_BUFFER_MAX_STRING) {
+        len = TRACE_BUFFER_MAX_STRING;
+      }
+      /* type, length, text and zero byte */
+      return 1 + 1 + len + 1;
+  }
+}
+
+/**
+ * Reserve space for a new event at the head of the ring buffer,
+ * drops the oldest events if necessary.
+ * @param tb pointer to trace buffer
+ * @param len length of event record
+ * @return offset of the reserved space
+ */
+static uint32_t
+_reserve_event(struct trace_buffer *tb, uint32_t len) {
+  struct trace_buffer_header *header = tb->header;
+
+  while (true) {
+    if (header->event_wrap == 0) {
+      /* events are stored between tail and head */
+      if (header->event_size - header->event_head >= len) {
+        return header->event_head;
+      }
+
+      /* continue at the start of the ring buffer */
+      header->event_wrap = header->event_head;
+      header->event_head = 0;
+    }
+
+    /* events are stored between tail and wrap point, then from start to head */
+    if (header->event_head + len <= header->event_tail) {
+      return header->event_head;
+    }
+
+    if (header->event_tail < header->event_wrap) {
+      /* drop oldest event */
+      header->event_tail += _get_u32(tb->_events + header->event_tail);
+      header->event_overwritten++;
+    }
+
+    if (header->event_tail >= header->event_wrap) {
+      /* all events behind the wrap point are gone */
+      header->event_tail = 0;
+      header->event_wrap = 0;
+    }
+  }
+}
+
+/**
+ * Parse an event record
+ * @param ptr pointer to event record
+ * @param len length of event record
+ * @param event pointer to event, will be filled by this function
+ * @return true if event record was valid, false otherwise
+ */
+static bool
+_parse_event(const uint8_t *ptr, uint32_t len, struct trace_event *event) {
+  const uint8_t *end;
+  uint64_t u64;
+  uint32_t u32;
+  size_t i, str_len;
+  struct trace_arg *arg;
+
+  end = ptr + len;
+
+  event->site_id = _get_u32(ptr + 4);
+  memcpy(&u64, ptr + 8, 8);
+  event->time.tv_sec = u64;
+  event->time.tv_usec = _get_u32(ptr + 16);
+  event->arg_count = ptr[20];
+  if (event->arg_count > TRACE_BUFFER_MAX_ARGS) {
+    return false;
+  }
+
+  ptr += EVENT_HEADER_LENGTH;
+  for (i=0; i<event->arg_count; i++) {
+    if (ptr >= end) {
+      return false;
+    }
+
+    arg = &event->args[i];
+    arg->type = *ptr++;
+    switch (arg->type) {
+      case TRACE_ARG_U32:
+      case TRACE_ARG_S32:
+        if (end - ptr < 4) {
+          return false;
+        }
+        u32 = _get_u32(ptr);
+        if (arg->type == TRACE_ARG_S32) {
+          arg->value.s64 = (int32_t)u32;
+        }
+        else {
+          arg->value.u64 = u32;
+        }
+        ptr += 4;
+        break;
+      case TRACE_ARG_U64:
+      case TRACE_ARG_S64:
+        if (end - ptr < 8) {
+          return false;
+        }
+        memcpy(&arg->value.u64, ptr, 8);
+        ptr += 8;
+        break;
+      case TRACE_ARG_NETADDR:
+        if ((size_t)(end - ptr) < sizeof(struct netaddr)) {
+          return false;
+        }
+        arg->value.addr = (const struct netaddr *)ptr;
+        ptr += sizeof(struct netaddr);
+        break;
+      case TRACE_ARG_STRING:
+        if (end - ptr < 1) {
+          return false;
+        }
+        str_len = *ptr++;
+        if ((size_t)(end - ptr) <= str_len || ptr[str_len] != 0) {
+          return false;
+        }
+        arg->value.str = (const char *)ptr;
+        ptr += str_len + 1;
+        break;
+      default:
+        return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Generate the text of a single event argument
+ * @param dst pointer to output buffer
+ * @param len length of output buffer
+ * @param spec pointer to conversion specification without length modifier
+ *   and conversion
+ * @param spec_len length of conversion specification
+ * @param conversion printf conversion character
+ * @param arg pointer to event argument
+ * @return number of characters written into output buffer
+ */
+static size_t
+_format_arg(char *dst, size_t len,
+    const char *spec, size_t spec_len, char conversion, const struct trace_arg *arg) {
+  struct netaddr_str nbuf;
+  char fmt[24];
+  bool is_signed;
+  int result;
+
+  if (spec_len > sizeof(fmt) - 4) {
+    spec_len = sizeof(fmt) - 4;
+  }
+  memcpy(fmt, spec, spec_len);
+
+  switch (arg->type) {
+    case TRACE_ARG_NETADDR:
+    case TRACE_ARG_STRING:
+      fmt[spec_len] = 's';
+      fmt[spec_len+1] = 0;
+      result = snprintf(dst, len, fmt, arg->type == TRACE_ARG_NETADDR
+          ? netaddr_to_string(&nbuf, arg->value.addr) : arg->value.str);
+      break;
+    case TRACE_ARG_U32:
+    case TRACE_ARG_S32:
+    case TRACE_ARG_U64:
+    case TRACE_ARG_S64:
+    default:
+      is_signed = arg->type == TRACE_ARG_S32 || arg->type == TRACE_ARG_S64;
+      if (strchr("diouxXc", conversion) == NULL) {
+        /* use decimal output for non-integer conversions */
+        conversion = is_signed ? 'd' : 'u';
+      }
+
+      if (conversion == 'c') {
+        fmt[spec_len] = 'c';
+        fmt[spec_len+1] = 0;
+        result = snprintf(dst, len, fmt, (int)arg->value.s64);
+      }
+      else {
+        fmt[spec_len] = 'l';
+        fmt[spec_len+1] = 'l';
+        fmt[spec_len+2] = conversion;
+        fmt[spec_len+3] = 0;
+        if (conversion == 'd' || conversion == 'i') {
+          result = snprintf(dst, len, fmt, (long long)arg->value.s64);
+        }
+        else {
+          result = snprintf(dst, len, fmt, (unsigned long long)arg->value.u64);
+        }
+      }
+      break;
+  }
+
+  if (result < 0) {
+    return 0;
+  }
+  if ((size_t)result >= len) {
+    /* output was truncated */
+    return len - 1;
+  }
+  return result;
+}
@@ -0,0 +1,255 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#ifndef TRACE_BUFFER_H_
+#define TRACE_BUFFER_H_
+
+#include <sys/time.h>
+
+#include "common/common_types.h"
+#include "common/netaddr.h"
+
+/*! magic string at the start of a trace buffer */
+#define TRACE_BUFFER_MAGIC "OONFTRC"
+
+/*! version of the trace buffer layout */
+#define TRACE_BUFFER_VERSION 1
+
+/*! smallest supported size of a trace buffer */
+#define TRACE_BUFFER_MIN_SIZE 65536
+
+/*! maximum number of arguments of a trace event */
+#define TRACE_BUFFER_MAX_ARGS 16
+
+/*! maximum length of a string argument of a trace event */
+#define TRACE_BUFFER_MAX_STRING 255
+
+/**
+ * Types of trace event arguments. The value is stored in front
+ * of each argument inside the trace buffer.
+ */
+enum trace_arg_type {
+  /*! unsigned 32 bit integer */
+  TRACE_ARG_U32 = 'u',
+
+  /*! signed 32 bit integer */
+  TRACE_ARG_S32 = 'i',
+
+  /*! unsigned 64 bit integer */
+  TRACE_ARG_U64 = 'U',
+
+  /*! signed 64 bit integer */
+  TRACE_ARG_S64 = 'I',
+
+  /*! network address */
+  TRACE_ARG_NETADDR = 'a',
+
+  /*! zero terminated string */
+  TRACE_ARG_STRING = 's',
+};
+
+/**
+ * One argument of a trace event
+ */
+struct trace_arg {
+  /*! type of argument */
+  enum trace_arg_type type;
+
+  /*! value of argument */
+  union {
+    /*! value of unsigned integers */
+    uint64_t u64;
+
+    /*! value of signed integers */
+    int64_t s64;
+
+    /*! pointer to network address */
+    const struct netaddr *addr;
+
+    /*! pointer to string */
+    const char *str;
+  } value;
+};
+
+/**
+ * Header at the start of a trace buffer, followed by the region
+ * with the trace site definitions and the event ring buffer.
+ * All values are stored in host byte order.
+ */
+struct trace_buffer_header {
+  /*! magic string to identify a trace buffer */
+  char magic[8];
+
+  /*! layout version */
+  uint32_t version;
+
+  /*! offset of the site region */
+  uint32_t site_offset;
+
+  /*! size of the site region */
+  uint32_t site_size;
+
+  /*! number of bytes used in the site region */
+  uint32_t site_used;
+
+  /*! number of defined sites */
+  uint32_t site_count;
+
+  /*! number of sites that did not fit into the site region */
+  uint32_t site_lost;
+
+  /*! offset of the event ring buffer */
+  uint32_t event_offset;
+
+  /*! size of the event ring buffer */
+  uint32_t event_size;
+
+  /*! offset behind the newest event */
+  uint32_t event_head;
+
+  /*! offset of the oldest event */
+  uint32_t event_tail;
+
+  /*! end of the events in front of the head, 0 if not wrapped */
+  uint32_t event_wrap;
+
+  /*! padding for 64 bit alignment */
+  uint32_t _reserved;
+
+  /*! number of events written */
+  uint64_t event_count;
+
+  /*! number of events overwritten by newer ones */
+  uint64_t event_overwritten;
+};
+
+/**
+ * Decoded definition of a trace site
+ */
+struct trace_site {
+  /*! id of the site */
+  uint32_t id;
+
+  /*! source code line of the site */
+  int line;
+
+  /*! source code file of the site */
+  const char *file;
+
+  /*! name of the severity of the site */
+  const char *severity;
+
+  /*! name of the logging source of the site */
+  const char *source;
+
+  /*! printf style format string of the site */
+  const char *format;
+};
+
+/**
+ * Decoded trace event
+ */
+struct trace_event {
+  /*! id of the site that generated the event */
+  uint32_t site_id;
+
+  /*! walltime of the event */
+  struct timeval time;
+
+  /*! number of arguments */
+  size_t arg_count;
+
+  /*! arguments, pointers reference the trace buffer */
+  struct trace_arg args[TRACE_BUFFER_MAX_ARGS];
+};
+
+/**
+ * A trace buffer on top of a block of (memory mapped) memory
+ */
+struct trace_buffer {
+  /*! pointer to header at the start of the memory block */
+  struct trace_buffer_header *header;
+
+  /*! pointer to site region */
+  uint8_t *_sites;
+
+  /*! pointer to event ring buffer */
+  uint8_t *_events;
+};
+
+/**
+ * Iterator over the events of a trace buffer, from the oldest
+ * to the newest one.
+ */
+struct trace_buffer_iterator {
+  /*! offset of the next event */
+  uint32_t _pos;
+
+  /*! end of the current segment of the ring buffer */
+  uint32_t _end;
+
+  /*! true if the segment behind the wrap point is still pending */
+  bool _wrapped;
+};
+
+EXPORT int trace_buffer_init(struct trace_buffer *, void *mem, size_t size);
+EXPORT int trace_buffer_attach(struct trace_buffer *, void *mem, size_t size);
+EXPORT uint32_t trace_buffer_add_site(struct trace_buffer *,
+    const char *file, int line, const char *severity,
+    const char *source, const char *format);
+EXPORT void trace_buffer_add_event(struct trace_buffer *, uint32_t site_id,
+    const struct timeval *time, const struct trace_arg *args, size_t count);
+EXPORT bool trace_buffer_get_site(const struct trace_buffer *,
+    struct trace_site *site, uint32_t id);
+
+EXPORT void trace_buffer_iterator_init(const struct trace_buffer *,
+    struct trace_buffer_iterator *);
+EXPORT bool trace_buffer_iterator_next(const struct trace_buffer *,
+    struct trace_buffer_iterator *, struct trace_event *);
+
+EXPORT size_t trace_format(char *dst, size_t len, const char *format,
+    const struct trace_arg *args, size_t count);
+
+#endif /* TRACE_BUFFER_H_ */
@@ -57,6 +57,50 @@
 #include "core/oonf_logging.h"
 #include "core/os_core.h"
 
+/**
+ * Header of a logging event in the asynchronous buffer,
+ * followed by the message text and the bytes for the hexdump
+ */
+struct _log_record {
+  /*! walltime of logging event */
+  struct timeval time;
+
+  /*! file where the logging event happened */
+  const char *file;
+
+  /*! line number where the logging event happened */
+  int line;
+
+  /*! length of record in buffer including header and padding */
+  uint32_t length;
+
+  /*! length of message text */
+  uint32_t text_len;
+
+  /*! length of hexdump data */
+  uint32_t hex_len;
+
+  /*! severity of logging event */
+  uint8_t severity;
+
+  /*! source of logging event */
+  uint8_t source;
+
+  /*! true if no header should be added to logging event */
+  bool no_header;
+};
+
+static void _dispatch(enum oonf_log_severity severity,
+    enum oonf_log_source source, bool no_header, const char *file, int line,
+    int p1, int p2);
+static int _append_header(enum oonf_log_severity severity,
+    enum oonf_log_source source, const char *file, int line);
+static const char *_format_walltime(struct oonf_walltime_str *buf,
+    const struct timeval *now);
+static bool _enqueue(enum oonf_log_severity severity,
+    enum oonf_log_source source, bool no_header, const char *file, int line,
+    const struct timeval *now, const void *hexptr, size_t hexlen);
+static struct _log_record *_reserve(size_t length);
 
 static struct list_entity _handler_list;
 static struct autobuf _logbuffer;
@@ -91,6 +135,15 @@ const char *LOG_SEVERITY_NAMES[LOG_SEVERITY_MAX+1] = {
 };
 
 static uint32_t _log_warnings[LOG_MAXIMUM_SOURCES];
+static uint32_t _log_dropped[LOG_MAXIMUM_SOURCES];
+
+/*
+ * buffer for asynchronous logging, records are appended until
+ * oonf_log_flush() writes all of them and resets the buffer
+ */
+static uint8_t *_async_buf;
+static size_t _async_size, _async_highwater, _async_used, _async_peak;
+static bool _async_flushing;
 
 /**
  * Initialize logging system
@@ -145,8 +198,9 @@ oonf_log_init(const struct oonf_appdata *data, enum oonf_log_severity def_severi
   /* clear global mask */
   memset(&log_global_mask, _default_mask, sizeof(log_global_mask));
 
-  /* clear warning counter */
+  /* clear warning and drop counter */
   memset(_log_warnings, 0, sizeof(_log_warnings));
+  memset(_log_dropped, 0, sizeof(_log_dropped));
   return 0;
 }
 
@@ -159,6 +213,9 @@ oonf_log_cleanup(void)
   struct oonf_log_handler_entry *h, *iterator;
   enum oonf_log_source src;
 
+  /* write buffered logging events and switch to synchronous logging */
+  oonf_log_set_async(0, 0);
+
   /* remove all handlers */
   list_for_each_element_safe(&_handler_list, h, _node, iterator) {
     oonf_log_removehandler(h);
@@ -262,6 +319,129 @@ oonf_log_get_warning_count(enum oonf_log_source source) {
   return _log_warnings[source];
 }
 
+/**
+ * @param source logging source
+ * @return number of logging events dropped by the asynchronous
+ *   logging buffer since start for this source
+ */
+uint32_t
+oonf_log_get_dropped_count(enum oonf_log_source source) {
+  return _log_dropped[source];
+}
+
+/**
+ * @return size of the asynchronous logging buffer in bytes,
+ *   0 if logging is synchronous
+ */
+size_t
+oonf_log_get_async_size(void) {
+  return _async_size;
+}
+
+/**
+ * @return maximum number of bytes used in the asynchronous logging buffer
+ *   since it has been configured
+ */
+size_t
+oonf_log_get_async_peak(void) {
+  return _async_peak;
+}
+
+/**
+ * Configure asynchronous logging. Logging events are stored in a
+ * buffer and written to the logging handlers by oonf_log_flush(), which
+ * the scheduler calls before it waits for new events.
+ *
+ * If the buffer is filled above the high-water mark, debug and info
+ * events are dropped to keep space for warnings. Warnings are never
+ * dropped, a full buffer is flushed synchronously instead.
+ * @param size size of the buffer in bytes, 0 for synchronous logging
+ * @param highwater fill level of the buffer in percent above which
+ *   debug and info events are dropped
+ * @return -1 if an error happened, 0 otherwise
+ */
+int
+oonf_log_set_async(size_t size, uint8_t highwater) {
+  uint8_t *buf = NULL;
+
+  if (highwater > 100) {
+    highwater = 100;
+  }
+
+  if (size == _async_size) {
+    _async_highwater = size * highwater / 100;
+    return 0;
+  }
+
+  if (size > 0) {
+    buf = malloc(size);
+    if (buf == NULL) {
+      return -1;
+    }
+  }
+
+  /* write all buffered events before changing the buffer */
+  oonf_log_flush();
+  free(_async_buf);
+
+  _async_buf = buf;
+  _async_size = size;
+  _async_highwater = size * highwater / 100;
+  _async_used = 0;
+  _async_peak = 0;
+  return 0;
+}
+
+/**
+ * Write all logging events in the asynchronous logging buffer
+ * to the logging handlers
+ */
+void
+oonf_log_flush(void) {
+  struct oonf_walltime_str tbuf;
+  struct _log_record rec;
+  const char *text;
+  size_t pos;
+  int p1, p2;
+
+  if (_async_flushing) {
+    return;
+  }
+  _async_flushing = true;
+
+  /* events logged by the handlers are written directly, the buffer cannot grow */
+  for (pos = 0; pos < _async_used; pos += rec.length) {
+    memcpy(&rec, &_async_buf[pos], sizeof(rec));
+    text = (const char *)(&_async_buf[pos + sizeof(rec)]);
+
+    abuf_clear(&_logbuffer);
+    p1 = p2 = 0;
+    if (!rec.no_header) {
+      p1 = abuf_puts(&_logbuffer, _format_walltime(&tbuf, &rec.time));
+      p2 = _append_header(rec.severity, rec.source, rec.file, rec.line);
+    }
+    abuf_memcpy(&_logbuffer, text, rec.text_len);
+
+    if (rec.hex_len) {
+      /* append \n at the end of the line if necessary */
+      if (rec.text_len == 0 || text[rec.text_len-1] != '\n') {
+        abuf_puts(&_logbuffer, "\n");
+      }
+      abuf_hexdump(&_logbuffer, "", text + rec.text_len, rec.hex_len);
+    }
+    else if (rec.text_len > 0 && text[rec.text_len-1] == '\n') {
+      /* remove \n at the end of the line if necessary */
+      abuf_getptr(&_logbuffer)[abuf_getlen(&_logbuffer)-1] = 0;
+    }
+
+    _dispatch(rec.severity, rec.source, rec.no_header,
+        rec.file, rec.line, p1, p2);
+  }
+
+  _async_used = 0;
+  _async_flushing = false;
+}
+
 /**
  * @return pointer to application data
  */
@@ -341,20 +521,12 @@ oonf_log_updatemask(void)
  */
 const char *
 oonf_log_get_walltime(struct oonf_walltime_str *buf) {
-struct timeval now;
-  struct tm *tm;
+  struct timeval now;
 
   if (os_core_gettimeofday(&now)) {
     return NULL;
   }
-
-  tm = localtime(&now.tv_sec);
-  if (tm == NULL) {
-    return NULL;
-  }
-  snprintf(buf->buf, sizeof(buf->buf), "%02d:%02d:%02d.%03ld",
-      tm->tm_hour % 24u, tm->tm_min % 60u, tm->tm_sec % 60u, (now.tv_usec / 1000) % 1000u);
-  return buf->buf;
+  return _format_walltime(buf, &now);
 }
 
 /**
@@ -375,9 +547,8 @@ void
 oonf_log(enum oonf_log_severity severity, enum oonf_log_source source, bool no_header,
     const char *file, int line, const void *hexptr, size_t hexlen, const char *format, ...)
 {
-  struct oonf_log_handler_entry *h, *iterator;
-  struct oonf_log_parameters param;
   struct oonf_walltime_str tbuf;
+  struct timeval now;
   char *last;
   va_list ap;
   int p1 = 0, p2 = 0;
@@ -390,13 +561,30 @@ oonf_log(enum oonf_log_severity severity, enum oonf_log_source source, bool no_h
 
   va_start(ap, format);
 
+  if (_async_size > 0 && !_async_flushing) {
+    /* store message text and hexdump data in the buffer */
+    abuf_clear(&_logbuffer);
+    abuf_vappendf(&_logbuffer, format, ap);
+    va_end(ap);
+
+    if (os_core_gettimeofday(&now)) {
+      memset(&now, 0, sizeof(now));
+    }
+    if (_enqueue(severity, source, no_header, file, line, &now, hexptr, hexlen)) {
+      return;
+    }
+
+    /* no space in the buffer, write it directly after the buffered events */
+    oonf_log_flush();
+    abuf_clear(&_logbuffer);
+    va_start(ap, format);
+  }
+
   /* generate log string */
   abuf_clear(&_logbuffer);
   if (!no_header) {
     p1 = abuf_puts(&_logbuffer, oonf_log_get_walltime(&tbuf));
-
-    p2 = abuf_appendf(&_logbuffer, " %s(%s) %s %d: ",
-        LOG_SEVERITY_NAMES[severity], LOG_SOURCE_NAMES[source], file, line);
+    p2 = _append_header(severity, source, file, line);
   }
   abuf_vappendf(&_logbuffer, format, ap);
 
@@ -416,27 +604,7 @@ oonf_log(enum oonf_log_severity severity, enum oonf_log_source source, bool no_h
     }
   }
 
-  param.severity = severity;
-  param.source = source;
-  param.no_header = no_header;
-  param.file = file;
-  param.line = line;
-  param.buffer = abuf_getptr(&_logbuffer);
-  param.timeLength = p1;
-  param.prefixLength = p2;
-
-  /* use stderr logger if nothing has been configured */
-  if (list_is_empty(&_handler_list)) {
-    oonf_log_stderr(NULL, &param);
-  }
-  else {
-    /* call all log handlers */
-    list_for_each_element_safe(&_handler_list, h, _node, iterator) {
-      if (oonf_log_mask_test(h->_processed_bitmask, source, severity)) {
-        h->handler(h, &param);
-      }
-    }
-  }
+  _dispatch(severity, source, no_header, file, line, p1, p2);
   va_end(ap);
 }
 
@@ -482,3 +650,166 @@ oonf_log_syslog(struct oonf_log_handler_entry *entry __attribute__ ((unused)),
 {
   os_core_syslog(param->severity, param->buffer + param->timeLength);
 }
+
+/**
+ * Call all logging handlers for the logging event in the logging buffer
+ * @param severity severity of the log event
+ * @param source source of the log event
+ * @param no_header true if time header should not be created
+ * @param file filename where the logging macro have been called
+ * @param line line number where the logging macro have been called
+ * @param p1 length of the timestamp in the logging buffer
+ * @param p2 length of the logging prefix in the logging buffer
+ */
+static void
+_dispatch(enum oonf_log_severity severity, enum oonf_log_source source,
+    bool no_header, const char *file, int line, int p1, int p2) {
+  struct oonf_log_handler_entry *h, *iterator;
+  struct oonf_log_parameters param;
+
+  param.severity = severity;
+  param.source = source;
+  param.no_header = no_header;
+  param.file = file;
+  param.line = line;
+  param.buffer = abuf_getptr(&_logbuffer);
+  param.timeLength = p1;
+  param.prefixLength = p2;
+
+  /* use stderr logger if nothing has been configured */
+  if (list_is_empty(&_handler_list)) {
+    oonf_log_stderr(NULL, &param);
+  }
+  else {
+    /* call all log handlers */
+    list_for_each_element_safe(&_handler_list, h, _node, iterator) {
+      if (oonf_log_mask_test(h->_processed_bitmask, source, severity)) {
+        h->handler(h, &param);
+      }
+    }
+  }
+}
+
+/**
+ * Append the prefix of a logging event to the logging buffer
+ * @param severity severity of the log event
+ * @param source source of the log event
+ * @param file filename where the logging macro have been called
+ * @param line line number where the logging macro have been called
+ * @return number of bytes appended
+ */
+static int
+_append_header(enum oonf_log_severity severity, enum oonf_log_source source,
+    const char *file, int line) {
+  return abuf_appendf(&_logbuffer, " %s(%s) %s %d: ",
+      LOG_SEVERITY_NAMES[severity], LOG_SOURCE_NAMES[source], file, line);
+}
+
+/**
+ * @param buf buffer to storage object for time string
+ * @param now walltime
+ * @return pointer to string containing the walltime
+ */
+static const char *
+_format_walltime(struct oonf_walltime_str *buf, const struct timeval *now) {
+  struct tm *tm;
+
+  tm = localtime(&now->tv_sec);
+  if (tm == NULL) {
+    return NULL;
+  }
+  snprintf(buf->buf, sizeof(buf->buf), "%02d:%02d:%02d.%03ld",
+      tm->tm_hour % 24u, tm->tm_min % 60u, tm->tm_sec % 60u, (now->tv_usec / 1000) % 1000u);
+  return buf->buf;
+}
+
+/**
+ * Copy the logging event in the logging buffer into the asynchronous buffer
+ * @param severity severity of the log event
+ * @param source source of the log event
+ * @param no_header true if time header should not be created
+ * @param file filename where the logging macro have been called
+ * @param line line number where the logging macro have been called
+ * @param now walltime of the logging event
+ * @param hexptr pointer to binary buffer that should be appended as a hexdump
+ * @param hexlen length of binary buffer to hexdump
+ * @return true if the event was stored or dropped, false if it must
+ *   be written directly
+ */
+static bool
+_enqueue(enum oonf_log_severity severity, enum oonf_log_source source,
+    bool no_header, const char *file, int line, const struct timeval *now,
+    const void *hexptr, size_t hexlen) {
+  struct _log_record *rec;
+  size_t text_len, length;
+
+  text_len = abuf_getlen(&_logbuffer);
+  if (hexptr == NULL) {
+    hexlen = 0;
+  }
+
+  /* keep records aligned */
+  length = sizeof(*rec) + text_len + hexlen;
+  length = (length + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
+
+  if (length > _async_size / 2) {
+    return false;
+  }
+
+  if (severity != LOG_SEVERITY_WARN && _async_used + length > _async_highwater) {
+    /* keep remaining space for warnings */
+    _log_dropped[source]++;
+    _log_dropped[LOG_ALL]++;
+    return true;
+  }
+
+  rec = _reserve(length);
+  if (rec == NULL) {
+    if (severity == LOG_SEVERITY_WARN) {
+      /* never drop warnings */
+      return false;
+    }
+
+    _log_dropped[source]++;
+    _log_dropped[LOG_ALL]++;
+    return true;
+  }
+
+  memcpy(&rec->time, now, sizeof(*now));
+  rec->file = file;
+  rec->line = line;
+  rec->length = length;
+  rec->text_len = text_len;
+  rec->hex_len = hexlen;
+  rec->severity = severity;
+  rec->source = source;
+  rec->no_header = no_header;
+
+  memcpy(rec + 1, abuf_getptr(&_logbuffer), text_len);
+  if (hexlen) {
+    memcpy(((uint8_t *)(rec + 1)) + text_len, hexptr, hexlen);
+  }
+
+  if (_async_used > _async_peak) {
+    _async_peak = _async_used;
+  }
+  return true;
+}
+
+/**
+ * Reserve memory at the end of the asynchronous logging buffer
+ * @param length number of bytes
+ * @return pointer to reserved memory, NULL if not enough space
+ */
+static struct _log_record *
+_reserve(size_t length) {
+  struct _log_record *rec;
+
+  if (_async_size - _async_used < length) {
+    return NULL;
+  }
+
+  rec = (struct _log_record *)(&_async_buf[_async_used]);
+  _async_used += length;
+  return rec;
+}
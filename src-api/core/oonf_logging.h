@@ -385,6 +385,12 @@ EXPORT size_t oonf_log_get_max_sourcetextlen(void);
 EXPORT size_t oonf_log_get_sourcecount(void);
 
 EXPORT uint32_t oonf_log_get_warning_count(enum oonf_log_source source);
+EXPORT uint32_t oonf_log_get_dropped_count(enum oonf_log_source source);
+EXPORT size_t oonf_log_get_async_size(void);
+EXPORT size_t oonf_log_get_async_peak(void);
+
+EXPORT int oonf_log_set_async(size_t size, uint8_t highwater);
+EXPORT void oonf_log_flush(void);
 
 EXPORT void oonf_log_addhandler(struct oonf_log_handler_entry *);
 EXPORT void oonf_log_removehandler(struct oonf_log_handler_entry *);
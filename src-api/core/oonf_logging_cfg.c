@@ -49,6 +49,7 @@
 #include <string.h>
 
 #include "common/common_types.h"
+#include "common/isonumber.h"
 #include "config/cfg_schema.h"
 #include "config/cfg_db.h"
 #include "config/cfg.h"
@@ -56,6 +57,7 @@
 #include "core/oonf_cfg.h"
 #include "core/oonf_logging.h"
 #include "core/oonf_logging_cfg.h"
+#include "core/oonf_trace.h"
 
 /*! configuration section for logging definition */
 #define LOG_SECTION     "log"
@@ -75,10 +77,26 @@
 /*! configuration entry for activating file logging */
 #define LOG_FILE_ENTRY   "file"
 
+/*! configuration entry for size of asynchronous logging buffer */
+#define LOG_ASYNC_BUFFER_ENTRY    "async_buffer"
+
+/*! configuration entry for high-water mark of asynchronous logging buffer */
+#define LOG_ASYNC_HIGHWATER_ENTRY "async_highwater"
+
+/*! configuration entry for logging sources written to the trace file */
+#define LOG_TRACE_ENTRY      "trace"
+
+/*! configuration entry for binary trace file */
+#define LOG_TRACE_FILE_ENTRY "trace_file"
+
+/*! configuration entry for size of binary trace file */
+#define LOG_TRACE_SIZE_ENTRY "trace_size"
+
 /* prototype for configuration change handler */
 static void _cb_logcfg_apply(void);
 static void _apply_log_setting(struct cfg_named_section *named,
     const char *entry_name, enum oonf_log_severity severity);
+static void _apply_trace_setting(struct cfg_named_section *named);
 
 /* define logging configuration template */
 static struct cfg_schema_entry _logging_entries[] = {
@@ -93,6 +111,25 @@ static struct cfg_schema_entry _logging_entries[] = {
   CFG_VALIDATE_BOOL(LOG_STDERR_ENTRY, "false", "Set to true to activate logging to stderr"),
   CFG_VALIDATE_BOOL(LOG_SYSLOG_ENTRY, "false", "Set to true to activate logging to syslog"),
   CFG_VALIDATE_STRING(LOG_FILE_ENTRY, "", "Set a filename to log to a file"),
+  CFG_VALIDATE_INT32_MINMAX(LOG_ASYNC_BUFFER_ENTRY, "0",
+      "Size of the buffer for asynchronous logging, logging events are written"
+      " when the scheduler is idle. Set to 0 for synchronous logging.",
+      0, true, 0, 16*1024*1024),
+  CFG_VALIDATE_INT32_MINMAX(LOG_ASYNC_HIGHWATER_ENTRY, "75",
+      "Fill level of the asynchronous logging buffer in percent above which"
+      " debug and info events are dropped, the rest is kept for warnings",
+      0, false, 0, 100),
+  CFG_VALIDATE_LOGSOURCE(LOG_TRACE_ENTRY, "",
+      "Set logging sources that write their trace events (all severities)"
+      " into the binary trace file",
+      .list = true),
+  CFG_VALIDATE_STRING(LOG_TRACE_FILE_ENTRY, "",
+      "Set a filename for the memory mapped binary trace file, use"
+      " oonf_trace_decoder to convert it into text"),
+  CFG_VALIDATE_INT32_MINMAX(LOG_TRACE_SIZE_ENTRY, "1048576",
+      "Size of the binary trace file, the oldest events are overwritten"
+      " when the file is full",
+      0, true, TRACE_BUFFER_MIN_SIZE, 256*1024*1024),
 };
 
 static struct cfg_schema_section _logging_section = {
@@ -128,6 +165,10 @@ oonf_logcfg_init(void) {
  */
 void
 oonf_logcfg_cleanup(void) {
+  /* write buffered logging events before closing the handlers */
+  oonf_log_flush();
+  oonf_trace_close();
+
   /* clean up former handlers */
   if (list_is_node_added(&_stderr_handler._node)) {
     oonf_log_removehandler(&_stderr_handler);
@@ -154,9 +195,10 @@ oonf_logcfg_cleanup(void) {
 int
 oonf_logcfg_apply(struct cfg_db *db) {
   struct cfg_named_section *named;
-  const char *ptr, *file_name;
-  int file_errno = 0;
+  const char *ptr, *file_name, *trace_name;
+  int file_errno = 0, trace_errno = 0;
   bool activate_syslog, activate_file, activate_stderr;
+  int64_t async_size, async_highwater, trace_size;
 
   /* clean up logging mask */
   oonf_log_mask_clear(_logging_cfg);
@@ -182,6 +224,36 @@ oonf_logcfg_apply(struct cfg_db *db) {
   ptr = cfg_db_get_entry_value(db, LOG_SECTION, NULL, LOG_STDERR_ENTRY)->value;
   activate_stderr = cfg_get_bool(ptr);
 
+  ptr = cfg_db_get_entry_value(db, LOG_SECTION, NULL, LOG_ASYNC_BUFFER_ENTRY)->value;
+  if (isonumber_to_s64(&async_size, ptr, 0, true)) {
+    async_size = 0;
+  }
+  ptr = cfg_db_get_entry_value(db, LOG_SECTION, NULL, LOG_ASYNC_HIGHWATER_ENTRY)->value;
+  if (isonumber_to_s64(&async_highwater, ptr, 0, false)) {
+    async_highwater = 75;
+  }
+
+  /* write buffered events to the old handlers before changing them */
+  if (oonf_log_set_async(async_size, async_highwater)) {
+    OONF_WARN(LOG_MAIN, "Not enough memory for asynchronous logging buffer");
+  }
+
+  /* binary trace file */
+  trace_name = cfg_db_get_entry_value(db, LOG_SECTION, NULL, LOG_TRACE_FILE_ENTRY)->value;
+  ptr = cfg_db_get_entry_value(db, LOG_SECTION, NULL, LOG_TRACE_SIZE_ENTRY)->value;
+  if (isonumber_to_s64(&trace_size, ptr, 0, true)) {
+    trace_size = TRACE_BUFFER_MIN_SIZE;
+  }
+
+  if (oonf_trace_open(trace_name, trace_size)) {
+    trace_errno = errno;
+  }
+
+  memset(trace_global_mask, 0, sizeof(trace_global_mask));
+  if (named != NULL && oonf_trace_is_active()) {
+    _apply_trace_setting(named);
+  }
+
   /* and finally modify the logging handlers */
   /* log.file */
   if (activate_file && !list_is_node_added(&_file_handler._node)) {
@@ -230,6 +302,10 @@ oonf_logcfg_apply(struct cfg_db *db) {
   /* reload logging mask */
   oonf_log_updatemask();
 
+  if (trace_errno) {
+    OONF_WARN(LOG_MAIN, "Cannot open trace file '%s': %s (%d)",
+        trace_name, strerror(trace_errno), trace_errno);
+  }
   if (file_errno) {
     OONF_WARN(LOG_MAIN, "Cannot open file '%s' for logging: %s (%d)",
         file_name, strerror(file_errno), file_errno);
@@ -314,6 +390,43 @@ _apply_log_setting(struct cfg_named_section *named,
   }
 }
 
+/**
+ * Apply the logging sources of the trace setting to the trace mask
+ * @param named pointer to configuration section
+ */
+static void
+_apply_trace_setting(struct cfg_named_section *named) {
+  struct cfg_entry *entry;
+  enum oonf_log_severity sev;
+  char *ptr;
+  size_t i;
+
+  entry = cfg_db_get_entry(named, LOG_TRACE_ENTRY);
+  if (entry == NULL) {
+    return;
+  }
+
+  strarray_for_each_element(&entry->val, ptr) {
+    for (i=0; i<oonf_log_get_sourcecount(); i++) {
+      if (strcasecmp(ptr, LOG_SOURCE_NAMES[i]) != 0) {
+        continue;
+      }
+
+      if (i == LOG_ALL) {
+        /* trace all logging sources */
+        memset(trace_global_mask,
+            LOG_SEVERITY_DEBUG | LOG_SEVERITY_INFO | LOG_SEVERITY_WARN,
+            sizeof(trace_global_mask));
+      }
+      else {
+        OONF_FOR_ALL_LOGSEVERITIES(sev) {
+          oonf_log_mask_set(trace_global_mask, i, sev);
+        }
+      }
+    }
+  }
+}
+
 /**
  * Wrapper for configuration delta handling
  */
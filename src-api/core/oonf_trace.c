@@ -0,0 +1,194 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "common/common_types.h"
+#include "common/string.h"
+#include "common/trace_buffer.h"
+#include "core/oonf_logging.h"
+#include "core/oonf_trace.h"
+#include "core/os_core.h"
+
+/*! maximum length of the text of a trace event for the logging handlers */
+#define TRACE_TEXT_LENGTH 1024
+
+/*! logging severities and sources that are written to the trace file */
+uint8_t trace_global_mask[LOG_MAXIMUM_SOURCES];
+
+/* memory mapped trace file */
+static struct trace_buffer _trace;
+static void *_trace_mem;
+static size_t _trace_size;
+static char _trace_file[256];
+
+/* incremented for each new trace file, invalidates site ids */
+static uint32_t _trace_generation;
+
+/**
+ * Open a new memory mapped trace file. Nothing happens if the
+ * requested file is already in use.
+ * @param file name of trace file, empty string to close the trace file
+ * @param size size of trace file in bytes
+ * @return -1 if an error happened (errno is set), 0 otherwise
+ */
+int
+oonf_trace_open(const char *file, size_t size) {
+  void *mem;
+  int fd;
+
+  if (_trace_mem != NULL && size == _trace_size
+      && strcmp(file, _trace_file) == 0) {
+    /* keep existing trace file */
+    return 0;
+  }
+
+  oonf_trace_close();
+  if (*file == 0) {
+    return 0;
+  }
+
+  if (size < TRACE_BUFFER_MIN_SIZE) {
+    errno = EINVAL;
+    return -1;
+  }
+
+  fd = open(file, O_RDWR | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+  if (fd < 0) {
+    return -1;
+  }
+
+  if (ftruncate(fd, size)) {
+    close(fd);
+    return -1;
+  }
+
+  mem = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+
+  if (mem == MAP_FAILED) {
+    return -1;
+  }
+
+  if (trace_buffer_init(&_trace, mem, size)) {
+    munmap(mem, size);
+    errno = EINVAL;
+    return -1;
+  }
+
+  _trace_mem = mem;
+  _trace_size = size;
+  strscpy(_trace_file, file, sizeof(_trace_file));
+  _trace_generation++;
+  return 0;
+}
+
+/**
+ * Stop tracing and close the trace file
+ */
+void
+oonf_trace_close(void) {
+  memset(trace_global_mask, 0, sizeof(trace_global_mask));
+
+  if (_trace_mem != NULL) {
+    munmap(_trace_mem, _trace_size);
+    _trace_mem = NULL;
+    _trace_size = 0;
+    _trace_file[0] = 0;
+  }
+}
+
+/**
+ * @return true if a trace file is open, false otherwise
+ */
+bool
+oonf_trace_is_active(void) {
+  return _trace_mem != NULL;
+}
+
+/**
+ * This function should not be called directly, use the macros
+ * OONF_TRACE_{DEBUG,INFO,WARN} !
+ *
+ * Writes a trace event into the trace file and/or generates its text
+ * for the logging handlers, depending on the trace and logging masks.
+ * @param site pointer to static call site definition
+ * @param source logging source of the event
+ * @param args array of trace arguments
+ * @param count number of trace arguments
+ */
+void
+oonf_trace(struct oonf_trace_site *site, enum oonf_log_source source,
+    const struct trace_arg *args, size_t count) {
+  char text[TRACE_TEXT_LENGTH];
+  struct timeval now;
+
+  if (_trace_mem != NULL
+      && oonf_log_mask_test(trace_global_mask, source, site->severity)) {
+    if (site->_generation != _trace_generation) {
+      /* define call site in the current trace file */
+      site->_id = trace_buffer_add_site(&_trace, site->file, site->line,
+          LOG_SEVERITY_NAMES[site->severity], LOG_SOURCE_NAMES[source], site->format);
+      site->_generation = _trace_generation;
+    }
+
+    if (site->_id != 0) {
+      if (os_core_gettimeofday(&now)) {
+        memset(&now, 0, sizeof(now));
+      }
+      trace_buffer_add_event(&_trace, site->_id, &now, args, count);
+    }
+  }
+
+  if (oonf_log_mask_test(log_global_mask, source, site->severity)) {
+    trace_format(text, sizeof(text), site->format, args, count);
+    oonf_log(site->severity, source, false, site->file, site->line, NULL, 0, "%s", text);
+  }
+}
@@ -0,0 +1,187 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#ifndef OONF_TRACE_H_
+#define OONF_TRACE_H_
+
+#include "common/common_types.h"
+#include "common/trace_buffer.h"
+#include "core/oonf_logging.h"
+
+/**
+ * Static definition of a trace call site, created by the
+ * OONF_TRACE_* macros. The logging source of a call site
+ * must not change.
+ */
+struct oonf_trace_site {
+  /*! source code file of call site */
+  const char *file;
+
+  /*! source code line of call site */
+  int line;
+
+  /*! severity of call site */
+  enum oonf_log_severity severity;
+
+  /*! printf style format string */
+  const char *format;
+
+  /*! id of call site in the current trace file, 0 if not defined */
+  uint32_t _id;
+
+  /*! generation of the trace file the id belongs to */
+  uint32_t _generation;
+};
+
+/*
+ * These macros generate the arguments of a trace event. They are
+ * stored raw in the trace file and only converted into text
+ * when the event is written to the normal logging handlers
+ * or decoded by the trace decoder.
+ *
+ * OONF_TRACE_INFO(LOG_NHDP, "Neighbor %s has metric %u",
+ *     OONF_TRACE_NETADDR(&neigh->originator), OONF_TRACE_U32(metric));
+ */
+
+/**
+ * @param v unsigned 32 bit trace argument
+ */
+#define OONF_TRACE_U32(v) { .type = TRACE_ARG_U32, .value.u64 = (uint32_t)(v) }
+
+/**
+ * @param v signed 32 bit trace argument
+ */
+#define OONF_TRACE_S32(v) { .type = TRACE_ARG_S32, .value.s64 = (int32_t)(v) }
+
+/**
+ * @param v unsigned 64 bit trace argument
+ */
+#define OONF_TRACE_U64(v) { .type = TRACE_ARG_U64, .value.u64 = (uint64_t)(v) }
+
+/**
+ * @param v signed 64 bit trace argument
+ */
+#define OONF_TRACE_S64(v) { .type = TRACE_ARG_S64, .value.s64 = (int64_t)(v) }
+
+/**
+ * @param p pointer to network address trace argument
+ */
+#define OONF_TRACE_NETADDR(p) { .type = TRACE_ARG_NETADDR, .value.addr = (p) }
+
+/**
+ * @param s string trace argument
+ */
+#define OONF_TRACE_STRING(s) { .type = TRACE_ARG_STRING, .value.str = (s) }
+
+/**
+ * Helper macro to define a trace macro
+ * @param sev logging severity
+ * @param src logging source
+ * @param fmt printf style format string
+ * @param args one or more trace arguments
+ */
+#define _OONF_TRACE(sev, src, fmt, args...) do { \
+  if (oonf_log_mask_test(log_global_mask, src, sev) \
+      || oonf_log_mask_test(trace_global_mask, src, sev)) { \
+    static struct oonf_trace_site _oonf_trace_site = { \
+      .file = &__FILE__[BASEPATH_LENGTH], .line = __LINE__, .severity = sev, .format = fmt }; \
+    const struct trace_arg _oonf_trace_args[] = { args }; \
+    oonf_trace(&_oonf_trace_site, src, _oonf_trace_args, ARRAYSIZE(_oonf_trace_args)); \
+  } } while(0)
+
+#ifdef OONF_LOG_DEBUG_INFO
+/**
+ * Add a DEBUG level trace event
+ * @param source logging source
+ * @param format printf style format string
+ * @param args one or more trace arguments
+ */
+#define OONF_TRACE_DEBUG(source, format, args...) _OONF_TRACE(LOG_SEVERITY_DEBUG, source, format, args)
+#else
+/**
+ * Add a DEBUG level trace event
+ * @param source logging source
+ * @param format printf style format string
+ * @param args one or more trace arguments
+ */
+#define OONF_TRACE_DEBUG(source, format, args...) do { } while(0)
+#endif
+
+#ifdef OONF_LOG_INFO
+/**
+ * Add a INFO level trace event
+ * @param source logging source
+ * @param format printf style format string
+ * @param args one or more trace arguments
+ */
+#define OONF_TRACE_INFO(source, format, args...) _OONF_TRACE(LOG_SEVERITY_INFO, source, format, args)
+#else
+/**
+ * Add a INFO level trace event
+ * @param source logging source
+ * @param format printf style format string
+ * @param args one or more trace arguments
+ */
+#define OONF_TRACE_INFO(source, format, args...) do { } while(0)
+#endif
+
+/**
+ * Add a WARN level trace event
+ * @param source logging source
+ * @param format printf style format string
+ * @param args one or more trace arguments
+ */
+#define OONF_TRACE_WARN(source, format, args...) _OONF_TRACE(LOG_SEVERITY_WARN, source, format, args)
+
+EXPORT extern uint8_t trace_global_mask[LOG_MAXIMUM_SOURCES];
+
+EXPORT int oonf_trace_open(const char *file, size_t size);
+EXPORT void oonf_trace_close(void);
+EXPORT bool oonf_trace_is_active(void);
+
+EXPORT void oonf_trace(struct oonf_trace_site *site, enum oonf_log_source source,
+    const struct trace_arg *args, size_t count);
+
+#endif /* OONF_TRACE_H_ */
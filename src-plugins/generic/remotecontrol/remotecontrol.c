@@ -49,6 +49,7 @@
 #include "common/autobuf.h"
 #include "common/avl.h"
 #include "common/avl_comp.h"
+#include "common/json.h"
 #include "common/list.h"
 #include "common/netaddr.h"
 #include "common/string.h"
@@ -68,6 +69,9 @@
 /* Definitions */
 #define LOG_REMOTECONTROL _oonf_remotecontrol_subsystem.logging
 
+/*! unsent output of a session that makes subscriptions coalesce events */
+enum { REMOTECONTROL_SUBSCRIPTION_BACKLOG = 4096 };
+
 /**
  * Remote control configuration
  */
@@ -93,6 +97,66 @@ struct _remotecontrol_session {
   struct os_route route;
 };
 
+/**
+ * Subscription of a telnet session to the events of a set of classes
+ */
+struct _remotecontrol_subscription {
+  /*! pointer to telnet data of the subscriber */
+  struct oonf_telnet_data *data;
+
+  /*! list of subscribed classes */
+  struct list_entity classes;
+
+  /*! list of pending deltas in the order they were created */
+  struct list_entity pending;
+
+  /*! tree of pending deltas, indexed by object pointer */
+  struct avl_tree pending_tree;
+};
+
+/**
+ * Class listener of a subscription
+ */
+struct _remotecontrol_subscribed_class {
+  /*! class extension to receive the events of the class */
+  struct oonf_class_extension ext;
+
+  /*! pointer to class that is subscribed */
+  struct oonf_class *class;
+
+  /*! back pointer to subscription */
+  struct _remotecontrol_subscription *subscription;
+
+  /*! hook into list of subscribed classes */
+  struct list_entity node;
+};
+
+/**
+ * Object event that has not been sent to the subscriber yet
+ */
+struct _remotecontrol_delta {
+  /*! pointer to object that triggered the event */
+  const void *object;
+
+  /*! name of the objects class */
+  const char *class_name;
+
+  /*! type of event, the result of all coalesced events */
+  enum oonf_class_event event;
+
+  /*! key of the object during its last event */
+  struct oonf_objectkey_str key;
+
+  /*! state of the object during its last event that was not a removal */
+  struct oonf_objectstate_str state;
+
+  /*! hook into list of pending deltas */
+  struct list_entity _list_node;
+
+  /*! node in tree of pending deltas */
+  struct avl_node _node;
+};
+
 /* prototypes */
 static int _init(void);
 static void _cleanup(void);
@@ -107,6 +171,19 @@ static enum oonf_telnet_result _start_logging(struct oonf_telnet_data *data,
     struct _remotecontrol_session *rc_session);
 static void _stop_logging(struct oonf_telnet_data *data);
 
+static enum oonf_telnet_result _cb_handle_subscribe(struct oonf_telnet_data *data);
+static int _add_subscribed_class(struct _remotecontrol_subscription *,
+    const char *name, size_t len);
+static void _stop_subscription(struct oonf_telnet_data *data);
+static void _cb_subscription_event(struct oonf_class_extension *ext,
+    void *ptr, enum oonf_class_event evt);
+static void _cb_drain_subscription(struct oonf_telnet_data *data);
+static void _print_state(struct json_session *,
+    const struct oonf_objectstate_str *);
+static void _remove_delta(struct _remotecontrol_subscription *,
+    struct _remotecontrol_delta *);
+static int _avl_comp_object(const void *k1, const void *k2);
+
 static void _cb_print_log(struct oonf_log_handler_entry *,
     struct oonf_log_parameters *);
 
@@ -132,6 +209,22 @@ static struct cfg_schema_section _remotecontrol_section = {
 
 static struct _remotecontrol_cfg _remotecontrol_config;
 
+/* memory classes for subscriptions */
+static struct oonf_class _subscription_class = {
+  .name = "remotecontrol subscription",
+  .size = sizeof(struct _remotecontrol_subscription),
+};
+
+static struct oonf_class _subscribed_class_class = {
+  .name = "remotecontrol subscribed class",
+  .size = sizeof(struct _remotecontrol_subscribed_class),
+};
+
+static struct oonf_class _delta_class = {
+  .name = "remotecontrol subscription delta",
+  .size = sizeof(struct _remotecontrol_delta),
+};
+
 /* plugin declaration */
 static const char *_dependencies[] = {
   OONF_CLASS_SUBSYSTEM,
@@ -162,6 +255,11 @@ static struct oonf_telnet_command _telnet_cmds[] = {
       "\"log add <severity> <source1> <source2> ...\": Add one or more sources of a defined severity for logging\n"
       "\"log remove <severity> <source1> <source2> ...\": Remove one or more sources of a defined severity for logging\n",
       .acl = &_remotecontrol_config.acl),
+  TELNET_CMD("subscribe", _cb_handle_subscribe,
+      "\"subscribe\":                          List all classes that can be subscribed\n"
+      "\"subscribe <class1>,<class2>,...\":    continuous output of added, changed and removed\n"
+      "                                      objects of the classes as JSON records\n",
+      .acl = &_remotecontrol_config.acl),
   TELNET_CMD("config", _cb_handle_config,
       "\"config commit\":                                   Commit changed configuration\n"
       "\"config revert\":                                   Revert to active configuration\n"
@@ -210,6 +308,9 @@ _init(void)
 
   netaddr_acl_add(&_remotecontrol_config.acl);
   list_init_head(&_remote_sessions);
+  oonf_class_add(&_subscription_class);
+  oonf_class_add(&_subscribed_class_class);
+  oonf_class_add(&_delta_class);
 
   for (i=0; i<ARRAYSIZE(_telnet_cmds); i++) {
     oonf_telnet_add(&_telnet_cmds[i]);
@@ -236,6 +337,9 @@ _cleanup(void)
     oonf_telnet_remove(&_telnet_cmds[i]);
   }
 
+  oonf_class_remove(&_delta_class);
+  oonf_class_remove(&_subscribed_class_class);
+  oonf_class_remove(&_subscription_class);
   netaddr_acl_remove(&_remotecontrol_config.acl);
 }
 
@@ -407,6 +511,313 @@ _cb_handle_log(struct oonf_telnet_data *data) {
   return TELNET_RESULT_ACTIVE;
 }
 
+/**
+ * Handle subscribe command
+ * @param data pointer to telnet data
+ * @return telnet result constant
+ */
+static enum oonf_telnet_result
+_cb_handle_subscribe(struct oonf_telnet_data *data) {
+  struct _remotecontrol_subscription *subscription;
+  struct _remotecontrol_subscribed_class *sub_class;
+  struct oonf_class *c;
+  const char *ptr, *next;
+
+  if (data->parameter == NULL || *data->parameter == 0) {
+    avl_for_each_element(oonf_class_get_tree(), c, _node) {
+      abuf_appendf(data->out, "%s\n", c->name);
+    }
+    return TELNET_RESULT_ACTIVE;
+  }
+
+  if (data->stop_handler) {
+    abuf_puts(data->out, "Error, you cannot stack continuous output commands\n");
+    return TELNET_RESULT_ACTIVE;
+  }
+
+  /* make sure the subscription is stopped when the plugin is unloaded */
+  if (_get_remotecontrol_session(data) == NULL) {
+    return TELNET_RESULT_INTERNAL_ERROR;
+  }
+
+  subscription = oonf_class_malloc(&_subscription_class);
+  if (subscription == NULL) {
+    return TELNET_RESULT_INTERNAL_ERROR;
+  }
+
+  subscription->data = data;
+  list_init_head(&subscription->classes);
+  list_init_head(&subscription->pending);
+  avl_init(&subscription->pending_tree, _avl_comp_object, false);
+
+  data->stop_handler = _stop_subscription;
+  data->stop_data[0] = subscription;
+
+  /* parse comma separated list of class names */
+  for (ptr = data->parameter; ptr != NULL; ptr = next) {
+    next = strchr(ptr, ',');
+    if (_add_subscribed_class(subscription, ptr,
+        next ? (size_t)(next - ptr) : strlen(ptr))) {
+      _stop_subscription(data);
+      return TELNET_RESULT_ACTIVE;
+    }
+    if (next) {
+      next++;
+    }
+  }
+
+  /* only hook into the classes after all names have been checked */
+  list_for_each_element(&subscription->classes, sub_class, node) {
+    oonf_class_extension_add(&sub_class->ext);
+  }
+
+  data->drain_handler = _cb_drain_subscription;
+  return TELNET_RESULT_CONTINOUS;
+}
+
+/**
+ * Add a class to a subscription
+ * @param subscription pointer to subscription
+ * @param name pointer to name of class (not zero terminated)
+ * @param len length of class name
+ * @return -1 if an error happened, 0 otherwise
+ */
+static int
+_add_subscribed_class(struct _remotecontrol_subscription *subscription,
+    const char *name, size_t len) {
+  struct _remotecontrol_subscribed_class *sub_class;
+  struct oonf_class *c;
+  char buffer[128];
+
+  if (len >= sizeof(buffer)) {
+    len = sizeof(buffer) - 1;
+  }
+  memcpy(buffer, name, len);
+  buffer[len] = 0;
+
+  c = avl_find_element(oonf_class_get_tree(), str_trim(buffer), c, _node);
+  if (c == NULL) {
+    abuf_appendf(subscription->data->out, "Error, unknown class: %s\n",
+        str_trim(buffer));
+    return -1;
+  }
+
+  sub_class = oonf_class_malloc(&_subscribed_class_class);
+  if (sub_class == NULL) {
+    abuf_puts(subscription->data->out, "Error, not enough memory\n");
+    return -1;
+  }
+
+  sub_class->class = c;
+  sub_class->subscription = subscription;
+  sub_class->ext.ext_name = "remotecontrol subscription";
+  sub_class->ext.class_name = c->name;
+  sub_class->ext.cb_event = _cb_subscription_event;
+
+  list_add_tail(&subscription->classes, &sub_class->node);
+  return 0;
+}
+
+/**
+ * Stop handler for subscriptions
+ * @param data pointer to telnet data
+ */
+static void
+_stop_subscription(struct oonf_telnet_data *data) {
+  struct _remotecontrol_subscription *subscription;
+  struct _remotecontrol_subscribed_class *sub_class, *sc_it;
+  struct _remotecontrol_delta *delta, *d_it;
+
+  subscription = data->stop_data[0];
+
+  list_for_each_element_safe(&subscription->classes, sub_class, node, sc_it) {
+    oonf_class_extension_remove(&sub_class->ext);
+    list_remove(&sub_class->node);
+    oonf_class_free(&_subscribed_class_class, sub_class);
+  }
+
+  list_for_each_element_safe(&subscription->pending, delta, _list_node, d_it) {
+    _remove_delta(subscription, delta);
+  }
+  oonf_class_free(&_subscription_class, subscription);
+
+  data->stop_handler = NULL;
+  data->drain_handler = NULL;
+  data->stop_data[0] = NULL;
+}
+
+/**
+ * Callback for events of a subscribed class. The event is merged
+ * into the pending delta of the object if the subscriber has not
+ * received it yet.
+ * @param ext class extension of subscribed class
+ * @param ptr pointer to object
+ * @param evt type of event
+ */
+static void
+_cb_subscription_event(struct oonf_class_extension *ext,
+    void *ptr, enum oonf_class_event evt) {
+  struct _remotecontrol_subscribed_class *sub_class;
+  struct _remotecontrol_subscription *subscription;
+  struct _remotecontrol_delta *delta;
+  struct oonf_objectkey_str key;
+
+  sub_class = container_of(ext, struct _remotecontrol_subscribed_class, ext);
+  subscription = sub_class->subscription;
+
+  sub_class->class->to_keystring(&key, sub_class->class, ptr);
+
+  delta = avl_find_element(&subscription->pending_tree, ptr, delta, _node);
+  if (delta != NULL) {
+    switch (delta->event) {
+      case OONF_OBJECT_ADDED:
+        if (evt == OONF_OBJECT_REMOVED) {
+          /* subscriber never learned about this object */
+          _remove_delta(subscription, delta);
+          return;
+        }
+        break;
+      case OONF_OBJECT_CHANGED:
+        delta->event = evt == OONF_OBJECT_REMOVED
+            ? OONF_OBJECT_REMOVED : OONF_OBJECT_CHANGED;
+        break;
+      case OONF_OBJECT_REMOVED:
+      default:
+        if (evt == OONF_OBJECT_ADDED && strcmp(delta->key.buf, key.buf) == 0) {
+          /* memory was reused for an object with the same key */
+          delta->event = OONF_OBJECT_CHANGED;
+          break;
+        }
+
+        /* keep the removal, but start a new delta for the object */
+        avl_remove(&subscription->pending_tree, &delta->_node);
+        delta = NULL;
+        break;
+    }
+  }
+
+  if (delta == NULL) {
+    delta = oonf_class_malloc(&_delta_class);
+    if (delta == NULL) {
+      return;
+    }
+
+    delta->object = ptr;
+    delta->class_name = sub_class->class->name;
+    delta->event = evt;
+    delta->state.buf[0] = 0;
+
+    delta->_node.key = ptr;
+    avl_insert(&subscription->pending_tree, &delta->_node);
+    list_add_tail(&subscription->pending, &delta->_list_node);
+  }
+  memcpy(&delta->key, &key, sizeof(key));
+
+  if (evt != OONF_OBJECT_REMOVED && sub_class->class->to_statestring != NULL) {
+    /* the object might be gone before the subscriber gets the delta */
+    sub_class->class->to_statestring(&delta->state, sub_class->class, ptr);
+  }
+
+  _cb_drain_subscription(subscription->data);
+}
+
+/**
+ * Write pending deltas of a subscription into the telnet output buffer
+ * until its unsent part reaches the backlog limit. Events of a slow subscriber are
+ * coalesced in the pending tree instead of filling up the buffer.
+ * @param data pointer to telnet data
+ */
+static void
+_cb_drain_subscription(struct oonf_telnet_data *data) {
+  struct _remotecontrol_subscription *subscription;
+  struct _remotecontrol_delta *delta;
+  struct json_session session;
+
+  subscription = data->stop_data[0];
+
+  while (!list_is_empty(&subscription->pending)
+      && oonf_telnet_get_unsent_length(data) < REMOTECONTROL_SUBSCRIPTION_BACKLOG) {
+    delta = list_first_element(&subscription->pending, delta, _list_node);
+
+    json_init_session(&session, data->out);
+    json_start_object(&session, NULL);
+    json_print(&session, "class", true, delta->class_name);
+    json_print(&session, "event", true, oonf_class_get_event_name(delta->event));
+    json_print(&session, "key", true, delta->key.buf);
+    if (delta->event != OONF_OBJECT_REMOVED && delta->state.buf[0] != 0) {
+      _print_state(&session, &delta->state);
+    }
+    json_end_object(&session);
+    abuf_puts(data->out, "\n");
+
+    _remove_delta(subscription, delta);
+  }
+
+  oonf_telnet_flush_session(data);
+}
+
+/**
+ * Print the state string of an object as a JSON object,
+ * numeric values are printed without quotes
+ * @param session json session
+ * @param state state string of object
+ */
+static void
+_print_state(struct json_session *session,
+    const struct oonf_objectstate_str *state) {
+  struct oonf_objectstate_str copy;
+  char *ptr, *next, *value, *end;
+
+  memcpy(&copy, state, sizeof(copy));
+
+  json_start_object(session, "state");
+  for (ptr = copy.buf; ptr != NULL && *ptr != 0; ptr = next) {
+    next = strchr(ptr, ' ');
+    if (next) {
+      *next++ = 0;
+    }
+
+    value = strchr(ptr, '=');
+    if (value == NULL) {
+      continue;
+    }
+    *value++ = 0;
+
+    strtoul(value, &end, 10);
+    json_print(session, ptr, *value == 0 || *end != 0, value);
+  }
+  json_end_object(session);
+}
+
+/**
+ * Remove a pending delta of a subscription
+ * @param subscription pointer to subscription
+ * @param delta pointer to delta
+ */
+static void
+_remove_delta(struct _remotecontrol_subscription *subscription,
+    struct _remotecontrol_delta *delta) {
+  if (avl_is_node_added(&delta->_node)) {
+    avl_remove(&subscription->pending_tree, &delta->_node);
+  }
+  list_remove(&delta->_list_node);
+  oonf_class_free(&_delta_class, delta);
+}
+
+/**
+ * AVL comparator for object pointers
+ * @param k1 pointer to first object
+ * @param k2 pointer to second object
+ * @return -1 if k1 < k2, 1 if k1 > k2, 0 otherwise
+ */
+static int
+_avl_comp_object(const void *k1, const void *k2) {
+  if ((uintptr_t)k1 < (uintptr_t)k2) {
+    return -1;
+  }
+  return (uintptr_t)k1 > (uintptr_t)k2 ? 1 : 0;
+}
+
 /**
  * Handle config command
  * @param data pointer to telnet data
@@ -47,6 +47,7 @@
 
 #include "common/common_types.h"
 #include "common/autobuf.h"
+#include "common/histogram.h"
 #include "common/netaddr.h"
 #include "common/netaddr_acl.h"
 #include "common/string.h"
@@ -55,6 +56,7 @@
 #include "core/oonf_logging.h"
 #include "core/oonf_subsystem.h"
 #include "subsystems/oonf_clock.h"
+#include "subsystems/oonf_packet_socket.h"
 #include "subsystems/oonf_telnet.h"
 #include "subsystems/oonf_viewer.h"
 
@@ -78,15 +80,26 @@ static void _initialize_timer_values(
     struct oonf_viewer_template *template, struct oonf_timer_class *tc);
 static void _initialize_socket_values(
     struct oonf_viewer_template *template, struct oonf_socket_entry *sock);
+static void _initialize_packet_values(
+    struct oonf_viewer_template *template, struct oonf_packet_socket *pkt);
 static void _initialize_logging_values(
     struct oonf_viewer_template *template, enum oonf_log_source source);
+static void _initialize_logbuffer_values(struct oonf_viewer_template *template);
+static void _initialize_latency_values(struct oonf_viewer_template *template,
+    const char *type, const char *name, const struct histogram *h);
+static void _print_latency_buckets(struct oonf_viewer_template *template,
+    const char *type, const char *name, const struct histogram *h);
 
 static int _cb_create_text_time(struct oonf_viewer_template *);
 static int _cb_create_text_version(struct oonf_viewer_template *);
 static int _cb_create_text_memory(struct oonf_viewer_template *);
 static int _cb_create_text_timer(struct oonf_viewer_template *);
 static int _cb_create_text_socket(struct oonf_viewer_template *);
+static int _cb_create_text_packet(struct oonf_viewer_template *);
 static int _cb_create_text_logging(struct oonf_viewer_template *);
+static int _cb_create_text_logbuffer(struct oonf_viewer_template *);
+static int _cb_create_text_latency(struct oonf_viewer_template *);
+static int _cb_create_text_latency_hist(struct oonf_viewer_template *);
 
 /*
  * list of template keys and corresponding buffers for values.
@@ -121,6 +134,15 @@ static int _cb_create_text_logging(struct oonf_viewer_template *);
 /*! template key for recycled memory blocks */
 #define KEY_MEMORY_RECYCLED             "memory_recycled"
 
+/*! template key for number of memory pages */
+#define KEY_MEMORY_PAGES                "memory_pages"
+
+/*! template key for size of memory pages */
+#define KEY_MEMORY_PAGESIZE             "memory_pagesize"
+
+/*! template key for percentage of unused page memory */
+#define KEY_MEMORY_FRAGMENTATION        "memory_fragmentation"
+
 /*! template key for timer usage */
 #define KEY_TIMER_USAGE                 "timer_usage"
 
@@ -142,12 +164,57 @@ static int _cb_create_text_logging(struct oonf_viewer_template *);
 /*! template key for socket long usage events */
 #define KEY_SOCKET_LONG                 "socket_long"
 
+/*! template key for packet socket events with incoming data */
+#define KEY_PACKET_EVENTS               "packet_events"
+
+/*! template key for received datagrams of packet socket */
+#define KEY_PACKET_RECV                 "packet_recv"
+
+/*! template key for events that filled all receive slots */
+#define KEY_PACKET_FULL_BATCH           "packet_full_batch"
+
+/*! template key for largest number of datagrams read in one event */
+#define KEY_PACKET_MAX_BATCH            "packet_max_batch"
+
 /*! template key for name of logging source */
 #define KEY_LOG_SOURCE                  "log_source"
 
 /*! template key for number of warnings per logging source */
 #define KEY_LOG_WARNINGS                "log_warnings"
 
+/*! template key for number of dropped asynchronous events per logging source */
+#define KEY_LOG_DROPPED                 "log_dropped"
+
+/*! template key for size of asynchronous logging buffer */
+#define KEY_LOGBUFFER_SIZE              "logbuffer_size"
+
+/*! template key for maximum fill level of asynchronous logging buffer */
+#define KEY_LOGBUFFER_PEAK              "logbuffer_peak"
+
+/*! template key for type of latency statistics (loop, wait, socket, timer) */
+#define KEY_LATENCY_TYPE                "latency_type"
+
+/*! template key for number of measured latency values */
+#define KEY_LATENCY_COUNT               "latency_count"
+
+/*! template key for average latency in microseconds */
+#define KEY_LATENCY_AVERAGE             "latency_avg_usec"
+
+/*! template key for estimated median latency in microseconds */
+#define KEY_LATENCY_P50                 "latency_p50_usec"
+
+/*! template key for estimated 99th percentile latency in microseconds */
+#define KEY_LATENCY_P99                 "latency_p99_usec"
+
+/*! template key for maximum latency in microseconds */
+#define KEY_LATENCY_MAX                 "latency_max_usec"
+
+/*! template key for upper limit of a latency histogram bucket in microseconds */
+#define KEY_LATENCY_BUCKET              "latency_bucket_usec"
+
+/*! template key for number of values in a latency histogram bucket */
+#define KEY_LATENCY_BUCKET_COUNT        "latency_bucket_count"
+
 /*
  * buffer space for values that will be assembled
  * into the output of the plugin
@@ -164,6 +231,9 @@ static struct isonumber_str             _value_memory_usage;
 static struct isonumber_str             _value_memory_freelist;
 static struct isonumber_str             _value_memory_alloc;
 static struct isonumber_str             _value_memory_recycled;
+static struct isonumber_str             _value_memory_pages;
+static struct isonumber_str             _value_memory_pagesize;
+static struct isonumber_str             _value_memory_fragmentation;
 
 static struct isonumber_str             _value_timer_usage;
 static struct isonumber_str             _value_timer_change;
@@ -174,8 +244,26 @@ static struct isonumber_str             _value_socket_recv;
 static struct isonumber_str             _value_socket_send;
 static struct isonumber_str             _value_socket_long;
 
+static struct isonumber_str             _value_packet_events;
+static struct isonumber_str             _value_packet_recv;
+static struct isonumber_str             _value_packet_full_batch;
+static struct isonumber_str             _value_packet_max_batch;
+
 static char                             _value_log_source[64];
 static struct isonumber_str             _value_log_warnings;
+static struct isonumber_str             _value_log_dropped;
+
+static struct isonumber_str             _value_logbuffer_size;
+static struct isonumber_str             _value_logbuffer_peak;
+
+static char                             _value_latency_type[16];
+static struct isonumber_str             _value_latency_count;
+static struct isonumber_str             _value_latency_average;
+static struct isonumber_str             _value_latency_p50;
+static struct isonumber_str             _value_latency_p99;
+static struct isonumber_str             _value_latency_max;
+static struct isonumber_str             _value_latency_bucket;
+static struct isonumber_str             _value_latency_bucket_count;
 
 /* definition of the template data entries for JSON and table output */
 static struct abuf_template_data_entry _tde_time_key[] = {
@@ -192,6 +280,9 @@ static struct abuf_template_data_entry _tde_memory_key[] = {
     { KEY_MEMORY_FREELIST, _value_memory_freelist.buf, false },
     { KEY_MEMORY_ALLOC, _value_memory_alloc.buf, false },
     { KEY_MEMORY_RECYCLED, _value_memory_recycled.buf, false },
+    { KEY_MEMORY_PAGES, _value_memory_pages.buf, false },
+    { KEY_MEMORY_PAGESIZE, _value_memory_pagesize.buf, false },
+    { KEY_MEMORY_FRAGMENTATION, _value_memory_fragmentation.buf, false },
 };
 static struct abuf_template_data_entry _tde_timer_key[] = {
     { KEY_STATISTICS_NAME, _value_stat_name, true },
@@ -206,9 +297,34 @@ static struct abuf_template_data_entry _tde_socket_key[] = {
     { KEY_SOCKET_SEND, _value_socket_send.buf, false },
     { KEY_SOCKET_LONG, _value_socket_long.buf, false },
 };
+static struct abuf_template_data_entry _tde_packet_key[] = {
+    { KEY_STATISTICS_NAME, _value_stat_name, true },
+    { KEY_PACKET_EVENTS, _value_packet_events.buf, false },
+    { KEY_PACKET_RECV, _value_packet_recv.buf, false },
+    { KEY_PACKET_FULL_BATCH, _value_packet_full_batch.buf, false },
+    { KEY_PACKET_MAX_BATCH, _value_packet_max_batch.buf, false },
+};
 static struct abuf_template_data_entry _tde_logging_key[] = {
     { KEY_LOG_SOURCE, _value_log_source, true },
     { KEY_LOG_WARNINGS, _value_log_warnings.buf, false },
+    { KEY_LOG_DROPPED, _value_log_dropped.buf, false },
+};
+static struct abuf_template_data_entry _tde_logbuffer_key[] = {
+    { KEY_LOGBUFFER_SIZE, _value_logbuffer_size.buf, false },
+    { KEY_LOGBUFFER_PEAK, _value_logbuffer_peak.buf, false },
+};
+static struct abuf_template_data_entry _tde_latency_key[] = {
+    { KEY_LATENCY_TYPE, _value_latency_type, true },
+    { KEY_STATISTICS_NAME, _value_stat_name, true },
+    { KEY_LATENCY_COUNT, _value_latency_count.buf, false },
+    { KEY_LATENCY_AVERAGE, _value_latency_average.buf, false },
+    { KEY_LATENCY_P50, _value_latency_p50.buf, false },
+    { KEY_LATENCY_P99, _value_latency_p99.buf, false },
+    { KEY_LATENCY_MAX, _value_latency_max.buf, false },
+};
+static struct abuf_template_data_entry _tde_latency_bucket_key[] = {
+    { KEY_LATENCY_BUCKET, _value_latency_bucket.buf, false },
+    { KEY_LATENCY_BUCKET_COUNT, _value_latency_bucket_count.buf, false },
 };
 
 static struct abuf_template_storage _template_storage;
@@ -229,9 +345,22 @@ static struct abuf_template_data _td_timer[] = {
 static struct abuf_template_data _td_socket[] = {
     { _tde_socket_key, ARRAYSIZE(_tde_socket_key) },
 };
+static struct abuf_template_data _td_packet[] = {
+    { _tde_packet_key, ARRAYSIZE(_tde_packet_key) },
+};
 static struct abuf_template_data _td_logging[] = {
     { _tde_logging_key, ARRAYSIZE(_tde_logging_key) },
 };
+static struct abuf_template_data _td_logbuffer[] = {
+    { _tde_logbuffer_key, ARRAYSIZE(_tde_logbuffer_key) },
+};
+static struct abuf_template_data _td_latency[] = {
+    { _tde_latency_key, ARRAYSIZE(_tde_latency_key) },
+};
+static struct abuf_template_data _td_latency_hist[] = {
+    { _tde_latency_key, 2 },
+    { _tde_latency_bucket_key, ARRAYSIZE(_tde_latency_bucket_key) },
+};
 
 /* OONF viewer templates (based on Template Data arrays) */
 static struct oonf_viewer_template _templates[] = {
@@ -265,12 +394,36 @@ static struct oonf_viewer_template _templates[] = {
         .json_name = "socket",
         .cb_function = _cb_create_text_socket,
     },
+    {
+        .data = _td_packet,
+        .data_size = ARRAYSIZE(_td_packet),
+        .json_name = "packet",
+        .cb_function = _cb_create_text_packet,
+    },
     {
         .data = _td_logging,
         .data_size = ARRAYSIZE(_td_logging),
         .json_name = "logging",
         .cb_function = _cb_create_text_logging,
     },
+    {
+        .data = _td_logbuffer,
+        .data_size = ARRAYSIZE(_td_logbuffer),
+        .json_name = "logbuffer",
+        .cb_function = _cb_create_text_logbuffer,
+    },
+    {
+        .data = _td_latency,
+        .data_size = ARRAYSIZE(_td_latency),
+        .json_name = "latency",
+        .cb_function = _cb_create_text_latency,
+    },
+    {
+        .data = _td_latency_hist,
+        .data_size = ARRAYSIZE(_td_latency_hist),
+        .json_name = "latency_hist",
+        .cb_function = _cb_create_text_latency_hist,
+    },
 };
 
 /* telnet command of this plugin */
@@ -376,6 +529,12 @@ _initialize_memory_values(struct oonf_viewer_template *template,
       oonf_class_get_allocations(cl), "", 0, false, template->create_raw);
   isonumber_from_u64(&_value_memory_recycled,
       oonf_class_get_recycled(cl), "", 0, false, template->create_raw);
+  isonumber_from_u64(&_value_memory_pages,
+      oonf_class_get_pages(cl), "", 0, false, template->create_raw);
+  isonumber_from_u64(&_value_memory_pagesize,
+      oonf_class_get_page_size(cl), "", 0, false, template->create_raw);
+  isonumber_from_u64(&_value_memory_fragmentation,
+      oonf_class_get_fragmentation(cl), "", 0, false, template->create_raw);
 }
 
 /**
@@ -412,6 +571,30 @@ _initialize_socket_values(struct oonf_viewer_template *template,
       oonf_socket_get_long(sock), "", 0, false, template->create_raw);
 }
 
+/**
+ * Initialize the value buffers for a packet socket
+ * @param template viewer template
+ * @param pkt packet socket
+ */
+static void
+_initialize_packet_values(struct oonf_viewer_template *template,
+    struct oonf_packet_socket *pkt) {
+  const struct oonf_packet_statistics *stats;
+
+  stats = oonf_packet_get_statistics(pkt);
+
+  strscpy(_value_stat_name, pkt->socket_name, sizeof(_value_stat_name));
+
+  isonumber_from_u64(&_value_packet_events,
+      stats->events, "", 0, false, template->create_raw);
+  isonumber_from_u64(&_value_packet_recv,
+      stats->packets, "", 0, false, template->create_raw);
+  isonumber_from_u64(&_value_packet_full_batch,
+      stats->full_batches, "", 0, false, template->create_raw);
+  isonumber_from_u64(&_value_packet_max_batch,
+      stats->max_batch, "", 0, false, template->create_raw);
+}
+
 /**
  * Initialize the value buffers for a logging source
  * @param template viewer template
@@ -423,6 +606,74 @@ static void _initialize_logging_values(
       sizeof(_value_log_source));
   isonumber_from_u64(&_value_log_warnings,
       oonf_log_get_warning_count(source), "", 0, false, template->create_raw);
+  isonumber_from_u64(&_value_log_dropped,
+      oonf_log_get_dropped_count(source), "", 0, false, template->create_raw);
+}
+
+/**
+ * Initialize the value buffers for the asynchronous logging buffer
+ * @param template viewer template
+ */
+static void
+_initialize_logbuffer_values(struct oonf_viewer_template *template) {
+  isonumber_from_u64(&_value_logbuffer_size,
+      oonf_log_get_async_size(), "", 0, false, template->create_raw);
+  isonumber_from_u64(&_value_logbuffer_peak,
+      oonf_log_get_async_peak(), "", 0, false, template->create_raw);
+}
+
+/**
+ * Initialize the value buffers for the summary of a latency histogram
+ * @param template viewer template
+ * @param type type of latency statistics
+ * @param name name of measured object
+ * @param h pointer to histogram
+ */
+static void
+_initialize_latency_values(struct oonf_viewer_template *template,
+    const char *type, const char *name, const struct histogram *h) {
+  strscpy(_value_latency_type, type, sizeof(_value_latency_type));
+  strscpy(_value_stat_name, name, sizeof(_value_stat_name));
+
+  isonumber_from_u64(&_value_latency_count,
+      h->count, "", 0, false, template->create_raw);
+  isonumber_from_u64(&_value_latency_average,
+      histogram_get_average(h), "", 0, false, template->create_raw);
+  isonumber_from_u64(&_value_latency_p50,
+      histogram_get_percentile(h, 50), "", 0, false, template->create_raw);
+  isonumber_from_u64(&_value_latency_p99,
+      histogram_get_percentile(h, 99), "", 0, false, template->create_raw);
+  isonumber_from_u64(&_value_latency_max,
+      h->max, "", 0, false, template->create_raw);
+}
+
+/**
+ * Generate one output line for each used bucket of a latency histogram
+ * @param template viewer template
+ * @param type type of latency statistics
+ * @param name name of measured object
+ * @param h pointer to histogram
+ */
+static void
+_print_latency_buckets(struct oonf_viewer_template *template,
+    const char *type, const char *name, const struct histogram *h) {
+  uint32_t i;
+
+  _initialize_latency_values(template, type, name, h);
+
+  for (i=0; i<HISTOGRAM_BUCKETS; i++) {
+    if (h->buckets[i] == 0) {
+      continue;
+    }
+
+    isonumber_from_u64(&_value_latency_bucket,
+        histogram_get_bucket_limit(i), "", 0, false, template->create_raw);
+    isonumber_from_u64(&_value_latency_bucket_count,
+        h->buckets[i], "", 0, false, template->create_raw);
+
+    /* generate template output */
+    oonf_viewer_output_print_line(template);
+  }
 }
 
 /**
@@ -512,6 +763,25 @@ _cb_create_text_socket(struct oonf_viewer_template *template) {
   return 0;
 }
 
+/**
+ * Callback to generate text/json description of packet sockets
+ * @param template viewer template
+ * @return -1 if an error happened, 0 otherwise
+ */
+static int
+_cb_create_text_packet(struct oonf_viewer_template *template) {
+  struct oonf_packet_socket *pkt;
+
+  list_for_each_element(oonf_packet_get_list(), pkt, node) {
+    _initialize_packet_values(template, pkt);
+
+    /* generate template output */
+    oonf_viewer_output_print_line(template);
+  }
+
+  return 0;
+}
+
 /**
  * Callback to generate text/json description for logging sources
  * @param template viewer template
@@ -530,3 +800,80 @@ _cb_create_text_logging(struct oonf_viewer_template *template) {
 
   return 0;
 }
+
+/**
+ * Callback to generate text/json description of the asynchronous
+ * logging buffer
+ * @param template viewer template
+ * @return -1 if an error happened, 0 otherwise
+ */
+static int
+_cb_create_text_logbuffer(struct oonf_viewer_template *template) {
+  /* initialize values */
+  _initialize_logbuffer_values(template);
+
+  /* generate template output */
+  oonf_viewer_output_print_line(template);
+  return 0;
+}
+
+/**
+ * Callback to generate text/json summary of the scheduler latencies
+ * @param template viewer template
+ * @return -1 if an error happened, 0 otherwise
+ */
+static int
+_cb_create_text_latency(struct oonf_viewer_template *template) {
+  struct oonf_socket_entry *sock;
+  struct oonf_timer_class *tc;
+
+  _initialize_latency_values(template, "loop", "scheduler",
+      oonf_socket_get_loop_histogram());
+  oonf_viewer_output_print_line(template);
+
+  _initialize_latency_values(template, "wait", "scheduler",
+      oonf_socket_get_wait_histogram());
+  oonf_viewer_output_print_line(template);
+
+  list_for_each_element(oonf_socket_get_list(), sock, _node) {
+    _initialize_latency_values(template, "socket", sock->name,
+        oonf_socket_get_runtime(sock));
+    oonf_viewer_output_print_line(template);
+  }
+
+  list_for_each_element(oonf_timer_get_list(), tc, _node) {
+    _initialize_latency_values(template, "timer", tc->name,
+        oonf_timer_get_runtime(tc));
+    oonf_viewer_output_print_line(template);
+  }
+
+  return 0;
+}
+
+/**
+ * Callback to generate text/json histograms of the scheduler latencies
+ * @param template viewer template
+ * @return -1 if an error happened, 0 otherwise
+ */
+static int
+_cb_create_text_latency_hist(struct oonf_viewer_template *template) {
+  struct oonf_socket_entry *sock;
+  struct oonf_timer_class *tc;
+
+  _print_latency_buckets(template, "loop", "scheduler",
+      oonf_socket_get_loop_histogram());
+  _print_latency_buckets(template, "wait", "scheduler",
+      oonf_socket_get_wait_histogram());
+
+  list_for_each_element(oonf_socket_get_list(), sock, _node) {
+    _print_latency_buckets(template, "socket", sock->name,
+        oonf_socket_get_runtime(sock));
+  }
+
+  list_for_each_element(oonf_timer_get_list(), tc, _node) {
+    _print_latency_buckets(template, "timer", tc->name,
+        oonf_timer_get_runtime(tc));
+  }
+
+  return 0;
+}
@@ -48,12 +48,15 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "common/common_types.h"
 #include "common/isonumber.h"
 #include "common/autobuf.h"
 #include "core/oonf_cfg.h"
 #include "core/oonf_logging.h"
+#include "core/oonf_trace.h"
 #include "core/oonf_subsystem.h"
 #include "subsystems/oonf_class.h"
 #include "subsystems/oonf_layer2.h"
@@ -71,6 +74,43 @@ enum {
   DAT_SAMPLING_COUNT = 32,
 };
 
+/**
+ * History of all links of a NHDP interface, stored as a structure of
+ * arrays. Each link owns one slot, the used slots are kept dense so
+ * the sampling timer can process all links in a single pass.
+ */
+struct ff_dat_if_history {
+  /*! NHDP links using the slots */
+  struct nhdp_link **links;
+
+  /*! number of RFC5444 packets received in each time interval */
+  uint32_t (*received)[DAT_SAMPLING_COUNT];
+
+  /*! sum of received and lost RFC5444 packets in each time interval */
+  uint32_t (*total)[DAT_SAMPLING_COUNT];
+
+  /*! link speed scaled to "minimum speed = 1" in each time interval */
+  uint32_t (*scaled_speed)[DAT_SAMPLING_COUNT];
+
+  /*! ascending sorted copy of scaled_speed for median calculation */
+  uint32_t (*sorted_speed)[DAT_SAMPLING_COUNT];
+
+  /*! number of scaled_speed entries with value zero (no data) */
+  uint8_t *zero_speeds;
+
+  /*! sum of received packets of all time intervals */
+  uint32_t *sum_received;
+
+  /*! sum of received and lost packets of all time intervals */
+  uint32_t *sum_total;
+
+  /*! number of used slots */
+  size_t count;
+
+  /*! number of allocated slots */
+  size_t capacity;
+};
+
 /**
  * Configuration settings of DATFF Metric
  */
@@ -92,21 +132,9 @@ struct ff_dat_if_config {
 
   /*! true if we registered the interface */
   bool registered;
-};
-
-/**
- * a single history memory cell, stores the metric
- * data for a single update interval
- */
-struct link_datff_bucket {
-  /*! number of RFC5444 packets received in time interval */
-  uint32_t received;
-
-  /*! sum of received and lost RFC5444 packets in time interval */
-  uint32_t total;
 
-  /*! link speed scaled to "minimum speed = 1" */
-  uint32_t scaled_speed;
+  /*! metric history of all links of the interface */
+  struct ff_dat_if_history history;
 };
 
 /**
@@ -119,9 +147,15 @@ struct link_datff_data {
   /*! back pointer to NHDP link */
   struct nhdp_link *nhdp_link;
 
-  /*! true if buckets contain data */
+  /*! true if history contains data */
   bool contains_data;
 
+  /*! true if the link owns a slot in the interface history */
+  bool has_slot;
+
+  /*! index of the links slot in the interface history */
+  uint32_t slot;
+
   /*! number of missed hellos based on timeouts since last received packet */
   uint32_t missed_hellos;
 
@@ -139,9 +173,6 @@ struct link_datff_data {
 
   /*! estimated number of neighbors of this link */
   uint32_t link_neigborhood;
-
-  /*! history ringbuffer */
-  struct link_datff_bucket buckets[DAT_SAMPLING_COUNT];
 };
 
 /* prototypes */
@@ -159,6 +190,13 @@ static void _cb_link_removed(void *);
 static void _cb_nhdpif_added(void *);
 static void _cb_nhdpif_removed(void *);
 
+static struct ff_dat_if_history *_get_link_history(struct nhdp_link *lnk);
+static int _add_history_slot(struct nhdp_link *lnk, struct link_datff_data *);
+static void _remove_history_slot(struct nhdp_link *lnk, struct link_datff_data *);
+static void _free_history(struct nhdp_interface *nhdp_if,
+    struct ff_dat_if_config *ifconfig);
+static void _set_scaled_speed(struct ff_dat_if_history *hist,
+    uint32_t slot, uint16_t idx, uint32_t speed);
 static void _cb_dat_sampling(struct oonf_timer_instance *);
 static void _calculate_link_neighborhood(struct nhdp_link *lnk,
     struct link_datff_data *ldata);
@@ -312,9 +350,6 @@ static struct nhdp_domain_metric _datff_handler = {
   .disable = _cb_disable_metric,
 };
 
-/* Temporary buffer to sort incoming link speed for median calculation */
-static int _rx_sort_array[DAT_SAMPLING_COUNT] = { 0 };
-
 /* ff_dat has multiple logging targets */
 enum oonf_log_source LOG_FF_DAT;
 enum oonf_log_source LOG_FF_DAT_RAW;
@@ -378,6 +413,12 @@ _cleanup(void) {
   oonf_rfc5444_remove_protocol_pktseqno(_protocol);
   _protocol = NULL;
 
+  /* extension removal does not trigger the remove callbacks */
+  avl_for_each_element(nhdp_interface_get_tree(), nhdp_if, _node) {
+    ifconfig = oonf_class_get_extension(&_nhdpif_extenstion, nhdp_if);
+    _free_history(nhdp_if, ifconfig);
+  }
+
   oonf_class_extension_remove(&_link_extenstion);
   oonf_class_extension_remove(&_nhdpif_extenstion);
 
@@ -429,17 +470,20 @@ static void
 _cb_link_added(void *ptr) {
   struct link_datff_data *data;
   struct nhdp_link *lnk;
-  size_t i;
 
   lnk = ptr;
   data = oonf_class_get_extension(&_link_extenstion, lnk);
 
+  if (data->has_slot) {
+    /* metric has been enabled again, reset link */
+    _cb_link_removed(lnk);
+  }
+
   memset(data, 0, sizeof(*data));
   // data->contains_data = false;
 
-  for (i = 0; i<ARRAYSIZE(data->buckets); i++) {
-    data->buckets[i].total = 1;
-    // data->buckets[i].scaled_speed = 0;
+  if (_add_history_slot(lnk, data)) {
+    OONF_WARN(LOG_FF_DAT, "Not enough memory for link history");
   }
 
   /* initialize 'hello lost' timer for link */
@@ -492,6 +536,10 @@ _cb_link_removed(void *ptr) {
   data = oonf_class_get_extension(&_link_extenstion, ptr);
 
   oonf_timer_stop(&data->hello_lost_timer);
+
+  if (data->has_slot) {
+    _remove_history_slot(ptr, data);
+  }
 }
 
 /**
@@ -521,55 +569,269 @@ _cb_nhdpif_removed(void *ptr) {
     oonf_timer_stop(&ifconfig->_sampling_timer);
     ifconfig->_sampling_timer.class = NULL;
   }
+
+  _free_history(ptr, ifconfig);
 }
 
 /**
- * Helper for sorting datarate array
- * @param p1 pointer to integer 1
- * @param p2 pointer to integer 2
- * @return <0, 0 >0 (standard comparator output)
+ * @param lnk NHDP link
+ * @return history of the links interface
+ */
+static struct ff_dat_if_history *
+_get_link_history(struct nhdp_link *lnk) {
+  struct ff_dat_if_config *ifconfig;
+
+  ifconfig = oonf_class_get_extension(&_nhdpif_extenstion, lnk->local_if);
+  return &ifconfig->history;
+}
+
+/**
+ * Free all arrays of an interface history
+ * @param hist interface history
+ */
+static void
+_free_history_arrays(struct ff_dat_if_history *hist) {
+  free(hist->links);
+  free(hist->received);
+  free(hist->total);
+  free(hist->scaled_speed);
+  free(hist->sorted_speed);
+  free(hist->zero_speeds);
+  free(hist->sum_received);
+  free(hist->sum_total);
+}
+
+/**
+ * Change the number of allocated slots of an interface history.
+ * The history is not changed if an allocation fails.
+ * @param hist interface history
+ * @param capacity new number of slots, must not be smaller
+ *   than the number of used slots
+ * @return -1 if an out of memory error happened, 0 otherwise
  */
 static int
-_int_comparator(const void *p1, const void *p2) {
-  const int *i1 = (int *)p1;
-  const int *i2 = (int *)p2;
+_resize_history(struct ff_dat_if_history *hist, size_t capacity) {
+  struct ff_dat_if_history resized;
 
-  if (*i1 > *i2) {
-    return 1;
-  }
-  else if (*i1 < *i2) {
+  memset(&resized, 0, sizeof(resized));
+
+#define ALLOC_HISTORY_ARRAY(array) \
+  resized.array = calloc(capacity, sizeof(*resized.array))
+
+  ALLOC_HISTORY_ARRAY(links);
+  ALLOC_HISTORY_ARRAY(received);
+  ALLOC_HISTORY_ARRAY(total);
+  ALLOC_HISTORY_ARRAY(scaled_speed);
+  ALLOC_HISTORY_ARRAY(sorted_speed);
+  ALLOC_HISTORY_ARRAY(zero_speeds);
+  ALLOC_HISTORY_ARRAY(sum_received);
+  ALLOC_HISTORY_ARRAY(sum_total);
+
+#undef ALLOC_HISTORY_ARRAY
+
+  if (!resized.links || !resized.received || !resized.total
+      || !resized.scaled_speed || !resized.sorted_speed || !resized.zero_speeds
+      || !resized.sum_received || !resized.sum_total) {
+    _free_history_arrays(&resized);
     return -1;
   }
+
+  if (hist->count > 0) {
+#define COPY_HISTORY_ARRAY(array) \
+  memcpy(resized.array, hist->array, hist->count * sizeof(*hist->array))
+
+    COPY_HISTORY_ARRAY(links);
+    COPY_HISTORY_ARRAY(received);
+    COPY_HISTORY_ARRAY(total);
+    COPY_HISTORY_ARRAY(scaled_speed);
+    COPY_HISTORY_ARRAY(sorted_speed);
+    COPY_HISTORY_ARRAY(zero_speeds);
+    COPY_HISTORY_ARRAY(sum_received);
+    COPY_HISTORY_ARRAY(sum_total);
+
+#undef COPY_HISTORY_ARRAY
+  }
+
+  /* swap in the new arrays */
+  _free_history_arrays(hist);
+  resized.count = hist->count;
+  resized.capacity = capacity;
+  memcpy(hist, &resized, sizeof(*hist));
   return 0;
 }
 
 /**
- * Get the median of all recorded link speeds by sorting
- * @param ldata linkdata
- * @return median linkspeed
+ * Allocate and initialize a history slot for a NHDP link
+ * @param lnk NHDP link
+ * @param ldata link data of NHDP link
+ * @return -1 if an out of memory error happened, 0 otherwise
  */
 static int
-_get_median_rx_linkspeed(struct link_datff_data *ldata) {
-  int zero_count;
-  size_t window;
-  size_t i;
+_add_history_slot(struct nhdp_link *lnk, struct link_datff_data *ldata) {
+  struct ff_dat_if_history *hist;
+  size_t slot, i;
+
+  hist = _get_link_history(lnk);
+  if (hist->count == hist->capacity
+      && _resize_history(hist, hist->capacity ? hist->capacity * 2 : 8)) {
+    return -1;
+  }
 
-  zero_count = 0;
-  for (i=0; i<ARRAYSIZE(ldata->buckets); i++) {
-    _rx_sort_array[i] = ldata->buckets[i].scaled_speed;
-    if (_rx_sort_array[i] == 0) {
-      zero_count++;
+  slot = hist->count++;
+  hist->links[slot] = lnk;
+
+  for (i=0; i<DAT_SAMPLING_COUNT; i++) {
+    hist->received[slot][i] = 0;
+    hist->total[slot][i] = 1;
+  }
+  memset(hist->scaled_speed[slot], 0, sizeof(hist->scaled_speed[slot]));
+  memset(hist->sorted_speed[slot], 0, sizeof(hist->sorted_speed[slot]));
+  hist->zero_speeds[slot] = DAT_SAMPLING_COUNT;
+  hist->sum_received[slot] = 0;
+  hist->sum_total[slot] = DAT_SAMPLING_COUNT;
+
+  ldata->slot = slot;
+  ldata->has_slot = true;
+  return 0;
+}
+
+/**
+ * Release the history slot of a NHDP link. The last slot is
+ * moved into the gap to keep the used slots dense.
+ * @param lnk NHDP link
+ * @param ldata link data of NHDP link
+ */
+static void
+_remove_history_slot(struct nhdp_link *lnk, struct link_datff_data *ldata) {
+  struct ff_dat_if_history *hist;
+  struct link_datff_data *moved;
+  size_t last;
+
+  hist = _get_link_history(lnk);
+  last = --hist->count;
+
+  if (ldata->slot != last) {
+    hist->links[ldata->slot] = hist->links[last];
+    memcpy(hist->received[ldata->slot], hist->received[last], sizeof(hist->received[0]));
+    memcpy(hist->total[ldata->slot], hist->total[last], sizeof(hist->total[0]));
+    memcpy(hist->scaled_speed[ldata->slot], hist->scaled_speed[last], sizeof(hist->scaled_speed[0]));
+    memcpy(hist->sorted_speed[ldata->slot], hist->sorted_speed[last], sizeof(hist->sorted_speed[0]));
+    hist->zero_speeds[ldata->slot] = hist->zero_speeds[last];
+    hist->sum_received[ldata->slot] = hist->sum_received[last];
+    hist->sum_total[ldata->slot] = hist->sum_total[last];
+
+    moved = oonf_class_get_extension(&_link_extenstion, hist->links[ldata->slot]);
+    moved->slot = ldata->slot;
+  }
+
+  ldata->has_slot = false;
+}
+
+/**
+ * Free the history of a NHDP interface and release the slots
+ * of all its links
+ * @param nhdp_if NHDP interface
+ * @param ifconfig ffdat configuration of interface
+ */
+static void
+_free_history(struct nhdp_interface *nhdp_if, struct ff_dat_if_config *ifconfig) {
+  struct ff_dat_if_history *hist;
+  struct link_datff_data *ldata;
+  struct nhdp_link *lnk;
+
+  list_for_each_element(&nhdp_if->_links, lnk, _if_node) {
+    ldata = oonf_class_get_extension(&_link_extenstion, lnk);
+    ldata->has_slot = false;
+  }
+
+  hist = &ifconfig->history;
+  _free_history_arrays(hist);
+  memset(hist, 0, sizeof(*hist));
+}
+
+/**
+ * Calculate the packet sums of the history of all links
+ * of an interface in one pass.
+ * @param hist interface history
+ */
+static void
+_sum_history(struct ff_dat_if_history *hist) {
+  uint32_t received, total;
+  size_t slot, i;
+
+  for (slot=0; slot<hist->count; slot++) {
+    received = 0;
+    total = 0;
+    for (i=0; i<DAT_SAMPLING_COUNT; i++) {
+      received += hist->received[slot][i];
+      total += hist->total[slot][i];
     }
+    hist->sum_received[slot] = received;
+    hist->sum_total[slot] = total;
   }
+}
+
+/**
+ * Store a new link speed in the history and keep the sorted
+ * copy of the link speeds up to date.
+ * @param hist interface history
+ * @param slot history slot of link
+ * @param idx index of time interval
+ * @param speed new scaled link speed
+ */
+static void
+_set_scaled_speed(struct ff_dat_if_history *hist,
+    uint32_t slot, uint16_t idx, uint32_t speed) {
+  uint32_t *sorted;
+  uint32_t old;
+  size_t i;
 
-  window = ARRAYSIZE(ldata->buckets) - zero_count;
+  old = hist->scaled_speed[slot][idx];
+  if (old == speed) {
+    return;
+  }
+  hist->scaled_speed[slot][idx] = speed;
+
+  if (old == 0) {
+    hist->zero_speeds[slot]--;
+  }
+  if (speed == 0) {
+    hist->zero_speeds[slot]++;
+  }
+
+  /* remove old value from sorted array */
+  sorted = hist->sorted_speed[slot];
+  i = 0;
+  while (sorted[i] != old) {
+    i++;
+  }
+  memmove(&sorted[i], &sorted[i+1], (DAT_SAMPLING_COUNT - 1 - i) * sizeof(*sorted));
+
+  /* insert new value */
+  for (i=DAT_SAMPLING_COUNT - 1; i > 0 && sorted[i-1] > speed; i--) {
+    sorted[i] = sorted[i-1];
+  }
+  sorted[i] = speed;
+}
+
+/**
+ * Get the median of all recorded link speeds
+ * @param hist interface history
+ * @param slot history slot of link
+ * @return median linkspeed
+ */
+static int
+_get_median_rx_linkspeed(struct ff_dat_if_history *hist, uint32_t slot) {
+  size_t zero_count;
+  size_t window;
+
+  zero_count = hist->zero_speeds[slot];
+  window = DAT_SAMPLING_COUNT - zero_count;
   if (window == 0) {
     return 1;
   }
 
-  qsort(_rx_sort_array, ARRAYSIZE(ldata->buckets), sizeof(int), _int_comparator);
-
-  return _rx_sort_array[zero_count + window/2];
+  return hist->sorted_speed[slot][zero_count + window/2];
 }
 
 /**
@@ -670,6 +932,7 @@ static void
 _cb_dat_sampling(struct oonf_timer_instance *ptr) {
   struct rfc7181_metric_field encoded_metric;
   struct ff_dat_if_config *ifconfig;
+  struct ff_dat_if_history *hist;
   struct link_datff_data *ldata;
   struct nhdp_interface *nhdp_if;
   struct nhdp_link *lnk;
@@ -677,53 +940,51 @@ _cb_dat_sampling(struct oonf_timer_instance *ptr) {
   uint64_t metric;
   uint32_t metric_value;
   uint32_t missing_intervals;
-  size_t i;
   int rx_bitrate;
   struct netaddr_str nbuf;
 
   ifconfig = container_of(ptr, struct ff_dat_if_config, _sampling_timer);
+  hist = &ifconfig->history;
 
   OONF_DEBUG(LOG_FF_DAT, "Calculate Metric from sampled data");
 
+  /* sum up the packet history of all links */
+  _sum_history(hist);
+
   nhdp_if = oonf_class_get_base(&_nhdpif_extenstion, ifconfig);
   list_for_each_element(&nhdp_if->_links, lnk, _if_node) {
     ldata = oonf_class_get_extension(&_link_extenstion, lnk);
-    if (!ldata->contains_data) {
+    if (!ldata->contains_data || !ldata->has_slot) {
       /* still no data for this link */
       continue;
     }
 
-    /* initialize counter */
-    total = 0;
-    received = 0;
-
     /* calculate metric */
-    for (i=0; i<ARRAYSIZE(ldata->buckets); i++) {
-      received += ldata->buckets[i].received;
-      total += ldata->buckets[i].total;
-    }
+    received = hist->sum_received[ldata->slot];
+    total = hist->sum_total[ldata->slot];
 
     if (ldata->missed_hellos > 0) {
       missing_intervals = (ldata->missed_hellos * ldata->hello_interval)
           / lnk->local_if->refresh_interval;
-      if (missing_intervals > ARRAYSIZE(ldata->buckets)) {
+      if (missing_intervals > DAT_SAMPLING_COUNT) {
         received = 0;
       }
       else {
-        received = (received * (ARRAYSIZE(ldata->buckets) - missing_intervals))
-            / ARRAYSIZE(ldata->buckets);
+        received = (received * (DAT_SAMPLING_COUNT - missing_intervals))
+            / DAT_SAMPLING_COUNT;
       }
     }
 
     /* update link speed */
-    ldata->buckets[ldata->activePtr].scaled_speed = _get_scaled_rx_linkspeed(ifconfig, lnk);
+    _set_scaled_speed(hist, ldata->slot, ldata->activePtr,
+        _get_scaled_rx_linkspeed(ifconfig, lnk));
 
-    OONF_DEBUG(LOG_FF_DAT, "Query incoming linkspeed for link %s: %"PRIu64,
-        netaddr_to_string(&nbuf, &lnk->if_addr),
-        (uint64_t)(ldata->buckets[ldata->activePtr].scaled_speed) * DATFF_LINKSPEED_MINIMUM);
+    OONF_TRACE_DEBUG(LOG_FF_DAT, "Query incoming linkspeed for link %s: %"PRIu64,
+        OONF_TRACE_NETADDR(&lnk->if_addr),
+        OONF_TRACE_U64((uint64_t)(hist->scaled_speed[ldata->slot][ldata->activePtr]) * DATFF_LINKSPEED_MINIMUM));
 
     /* get median scaled link speed and apply it to metric */
-    rx_bitrate = _get_median_rx_linkspeed(ldata);
+    rx_bitrate = _get_median_rx_linkspeed(hist, ldata->slot);
     if (rx_bitrate > DATFF_LINKSPEED_RANGE) {
       OONF_WARN(LOG_FF_DAT, "Metric overflow %s (%s): %d",
           netaddr_to_string(&nbuf, &lnk->if_addr),
@@ -746,9 +1007,9 @@ _cb_dat_sampling(struct oonf_timer_instance *ptr) {
     /* convert into something that can be transmitted over the network */
     if (metric > RFC7181_METRIC_MAX) {
       /* give the metric an upper bound */
-      OONF_INFO(LOG_FF_DAT, "Metric overflow %s (%s): %"PRIu64,
-          netaddr_to_string(&nbuf, &lnk->if_addr),
-          nhdp_interface_get_name(lnk->local_if), metric);
+      OONF_TRACE_INFO(LOG_FF_DAT, "Metric overflow %s (%s): %"PRIu64,
+          OONF_TRACE_NETADDR(&lnk->if_addr),
+          OONF_TRACE_STRING(nhdp_interface_get_name(lnk->local_if)), OONF_TRACE_U64(metric));
       metric_value = RFC7181_METRIC_MAX;
     }
     else if (metric < RFC7181_METRIC_MIN) {
@@ -772,19 +1033,20 @@ _cb_dat_sampling(struct oonf_timer_instance *ptr) {
     nhdp_domain_set_incoming_metric(
         &_datff_handler, lnk, metric_value);
 
-    OONF_DEBUG(LOG_FF_DAT, "New sampling rate for link %s (%s):"
+    OONF_TRACE_DEBUG(LOG_FF_DAT, "New sampling rate for link %s (%s):"
         " %d/%d = %u (speed=%"PRIu64 ")\n",
-        netaddr_to_string(&nbuf, &lnk->if_addr),
-        nhdp_interface_get_name(lnk->local_if),
-        received, total, metric_value, (uint64_t)(rx_bitrate) * DATFF_LINKSPEED_MINIMUM);
+        OONF_TRACE_NETADDR(&lnk->if_addr),
+        OONF_TRACE_STRING(nhdp_interface_get_name(lnk->local_if)),
+        OONF_TRACE_U32(received), OONF_TRACE_U32(total), OONF_TRACE_U32(metric_value),
+        OONF_TRACE_U64((uint64_t)(rx_bitrate) * DATFF_LINKSPEED_MINIMUM));
 
     /* update rolling buffer */
     ldata->activePtr++;
-    if (ldata->activePtr >= ARRAYSIZE(ldata->buckets)) {
+    if (ldata->activePtr >= DAT_SAMPLING_COUNT) {
       ldata->activePtr = 0;
     }
-    ldata->buckets[ldata->activePtr].received = 0;
-    ldata->buckets[ldata->activePtr].total = 0;
+    hist->received[ldata->slot][ldata->activePtr] = 0;
+    hist->total[ldata->slot][ldata->activePtr] = 0;
   }
 oonf_timer_set(&ifconfig->_sampling_timer, nhdp_if->refresh_interval);
 }
@@ -970,6 +1232,7 @@ _shall_process_packet(struct nhdp_interface *nhdpif, struct ff_dat_if_config *if
 static enum rfc5444_result
 _cb_process_packet(struct rfc5444_reader_tlvblock_context *context) {
   struct ff_dat_if_config *ifconfig;
+  struct ff_dat_if_history *hist;
   struct link_datff_data *ldata;
   struct nhdp_interface *interf;
   struct nhdp_laddr *laddr;
@@ -1018,12 +1281,17 @@ _cb_process_packet(struct rfc5444_reader_tlvblock_context *context) {
   /* get link and its dat data */
   lnk = laddr->link;
   ldata = oonf_class_get_extension(&_link_extenstion, lnk);
+  if (!ldata->has_slot) {
+    /* no memory for link history */
+    return RFC5444_OKAY;
+  }
 
+  hist = &ifconfig->history;
   if (!ldata->contains_data) {
     ldata->contains_data = true;
     ldata->activePtr = 0;
-    ldata->buckets[0].received = 1;
-    ldata->buckets[0].total = 1;
+    hist->received[ldata->slot][0] = 1;
+    hist->total[ldata->slot][0] = 1;
     ldata->last_seq_nr = context->pkt_seqno;
 
     return RFC5444_OKAY;
@@ -1036,8 +1304,8 @@ _cb_process_packet(struct rfc5444_reader_tlvblock_context *context) {
     total = ((uint32_t)(context->pkt_seqno) + 65536) - (uint32_t)(ldata->last_seq_nr);
   }
 
-  ldata->buckets[ldata->activePtr].received++;
-  ldata->buckets[ldata->activePtr].total += total;
+  hist->received[ldata->slot][ldata->activePtr]++;
+  hist->total[ldata->slot][ldata->activePtr] += total;
   ldata->last_seq_nr = context->pkt_seqno;
 
   _reset_missed_hello_timer(ldata);
@@ -1109,20 +1377,25 @@ _path_to_string(struct nhdp_metric_str *buf, uint32_t metric, uint8_t hopcount)
  */
 static const char *
 _int_link_to_string(struct nhdp_metric_str *buf, struct nhdp_link *lnk) {
+  struct ff_dat_if_history *hist;
   struct link_datff_data *ldata;
-  int64_t received = 0, total = 0;
+  int64_t received = 0, total = 0, speed = 1;
   size_t i;
 
   ldata = oonf_class_get_extension(&_link_extenstion, lnk);
 
-  for (i=0; i<ARRAYSIZE(ldata->buckets); i++) {
-    received += ldata->buckets[i].received;
-    total += ldata->buckets[i].total;
+  if (ldata->has_slot) {
+    hist = _get_link_history(lnk);
+    for (i=0; i<DAT_SAMPLING_COUNT; i++) {
+      received += hist->received[ldata->slot][i];
+      total += hist->total[ldata->slot][i];
+    }
+    speed = _get_median_rx_linkspeed(hist, ldata->slot);
   }
 
   snprintf(buf->buf, sizeof(*buf), "p_recv=%"PRId64",p_total=%"PRId64","
       "speed=%"PRId64",success=%"PRId64",missed_hello=%d,lastseq=%u,lneigh=%d",
-      received, total, (int64_t)_get_median_rx_linkspeed(ldata) * (int64_t)1024,
+      received, total, speed * (int64_t)1024,
       ldata->last_packet_success_rate, ldata->missed_hellos,
       ldata->last_seq_nr, ldata->link_neigborhood);
   return buf->buf;
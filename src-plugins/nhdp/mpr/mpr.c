@@ -66,6 +66,7 @@
 
 #include "neighbor-graph-flooding.h"
 #include "neighbor-graph-routing.h"
+#include "neighbor-graph-snapshot.h"
 #include "selection-rfc7181.h"
 
 /* FIXME remove unneeded includes */
@@ -76,6 +77,7 @@ static int _init(void);
 static void _cleanup(void);
 static void _cb_update_routing_mpr(struct nhdp_domain *);
 static void _cb_update_flooding_mpr(struct nhdp_domain *);
+static void _cb_nhdpif_removed(void *);
 
 #ifndef NDEBUG
 static void _validate_mpr_set(
@@ -106,6 +108,29 @@ static struct nhdp_domain_mpr _mpr_handler = {
   .update_flooding_mpr = _cb_update_flooding_mpr,
 };
 
+/* flooding MPR selection state of each interface */
+static struct oonf_class_extension _nhdpif_extension = {
+  .ext_name = "mpr flooding engine",
+  .class_name = NHDP_CLASS_INTERFACE,
+  .size = sizeof(struct mpr_rfc7181_engine),
+
+  .cb_remove = _cb_nhdpif_removed,
+};
+
+/* routing MPR selection state of each domain */
+static struct mpr_rfc7181_engine _routing_engines[NHDP_MAXIMUM_DOMAINS];
+
+#ifdef OONF_MPR_ENGINE
+/*! get the MPR engine of a routing domain or an interface */
+#define _get_engine(engine) (engine)
+#else
+/*! always use the AVL based MPR selection */
+#define _get_engine(engine) (NULL)
+#endif
+
+/* NHDP database snapshot shared by all routing and flooding MPR calculations */
+static struct mpr_neighbor_snapshot _snapshot;
+
 /* logging sources for NHDP subsystem */
 enum oonf_log_source LOG_MPR;
 
@@ -123,7 +148,11 @@ _early_cfg_init(void) {
  */
 static int
 _init(void) {
+  if (oonf_class_extension_add(&_nhdpif_extension)) {
+    return -1;
+  }
   if (nhdp_domain_mpr_add(&_mpr_handler)) {
+    oonf_class_extension_remove(&_nhdpif_extension);
     return -1;
   }
   return 0;
@@ -134,6 +163,17 @@ _init(void) {
  */
 static void
 _cleanup(void) {
+  struct nhdp_interface *nhdp_if;
+  size_t i;
+
+  avl_for_each_element(nhdp_interface_get_tree(), nhdp_if, _node) {
+    _cb_nhdpif_removed(nhdp_if);
+  }
+  for (i=0; i<ARRAYSIZE(_routing_engines); i++) {
+    mpr_rfc7181_engine_clear(&_routing_engines[i]);
+  }
+  mpr_snapshot_clear(&_snapshot);
+  oonf_class_extension_remove(&_nhdpif_extension);
 }
 
 /**
@@ -197,6 +237,11 @@ static void
 _cb_update_flooding_mpr(struct nhdp_domain *domain) {
   struct mpr_flooding_data flooding_data;
 
+  if (mpr_snapshot_update(&_snapshot)) {
+    /* keep the old flooding MPRs */
+    return;
+  }
+
   memset(&flooding_data, 0, sizeof(flooding_data));
   
   _clear_nhdp_flooding();
@@ -204,8 +249,9 @@ _cb_update_flooding_mpr(struct nhdp_domain *domain) {
     OONF_DEBUG(LOG_MPR, "*** Calculate flooding MPRs for interface %s ***",
         nhdp_interface_get_name(flooding_data.current_interface));
     
-    mpr_calculate_neighbor_graph_flooding(domain, &flooding_data);
-    mpr_calculate_mpr_rfc7181(domain, &flooding_data.neigh_graph);
+    mpr_calculate_neighbor_graph_flooding(domain, &flooding_data, &_snapshot);
+    mpr_calculate_mpr_rfc7181(domain, &flooding_data.neigh_graph, _get_engine(
+        oonf_class_get_extension(&_nhdpif_extension, flooding_data.current_interface)));
     mpr_print_sets(domain, &flooding_data.neigh_graph);
 #ifndef NDEBUG
     _validate_mpr_set(domain, &flooding_data.neigh_graph);
@@ -228,10 +274,15 @@ _cb_update_routing_mpr(struct nhdp_domain *domain) {
     return;
   }
   OONF_DEBUG(LOG_MPR, "*** Calculate routing MPRs for domain %u ***", domain->index);
+
+  if (mpr_snapshot_update(&_snapshot)) {
+    /* keep the old routing MPRs */
+    return;
+  }
     
   memset(&routing_graph, 0, sizeof(routing_graph));
-  mpr_calculate_neighbor_graph_routing(domain, &routing_graph);
-  mpr_calculate_mpr_rfc7181(domain, &routing_graph);
+  mpr_calculate_neighbor_graph_routing(domain, &routing_graph, &_snapshot);
+  mpr_calculate_mpr_rfc7181(domain, &routing_graph, _get_engine(&_routing_engines[domain->index]));
   mpr_print_sets(domain, &routing_graph);
 #ifndef NDEBUG
   _validate_mpr_set(domain, &routing_graph);
@@ -240,6 +291,15 @@ _cb_update_routing_mpr(struct nhdp_domain *domain) {
   mpr_clear_neighbor_graph(&routing_graph);
 }
 
+/**
+ * Callback triggered when a NHDP interface is removed
+ * @param ptr NHDP interface
+ */
+static void
+_cb_nhdpif_removed(void *ptr) {
+  mpr_rfc7181_engine_clear(oonf_class_get_extension(&_nhdpif_extension, ptr));
+}
+
 #ifndef NDEBUG
 
 /**
@@ -65,9 +65,10 @@
 
 /* FIXME remove unneeded includes */
 
-static uint32_t _calculate_d1_x(const struct nhdp_domain *domain, struct n1_node *x);
+static uint32_t _calculate_d1_x(const struct nhdp_domain *domain,
+    struct neighbor_graph *graph, struct n1_node *x);
 static uint32_t _calculate_d2_x_y(const struct nhdp_domain *domain,
-    struct n1_node *x, struct addr_node *y);
+    struct neighbor_graph *graph, struct n1_node *x, struct addr_node *y);
 static uint32_t _calculate_d_x_y(const struct nhdp_domain *domain,
     struct neighbor_graph *graph, struct n1_node *x, struct addr_node *y);
 #if 0
@@ -122,36 +123,57 @@ _is_allowed_link_tuple(const struct nhdp_domain *domain,
       && lnk->flooding_willingness > RFC7181_WILLINGNESS_NEVER;
 }
 
+/**
+ * Check if a link of the snapshot is "allowed" according to section 18.4
+ * @param domain NHDP domain
+ * @param current_interface NHDP interface
+ * @param snapshot neighbor graph snapshot
+ * @param idx index of link in snapshot
+ * @return true if link tuple is allowed, false otherwise
+ */
 static bool
-_is_allowed_2hop_tuple(const struct nhdp_domain *domain,
-    struct nhdp_interface *current_interface, struct nhdp_l2hop *two_hop) {
-  struct nhdp_l2hop_domaindata *twohopdata;
+_is_allowed_snapshot_link(const struct nhdp_domain *domain,
+    struct nhdp_interface *current_interface,
+    const struct mpr_neighbor_snapshot *snapshot, uint32_t idx) {
+  const struct mpr_snapshot_link *lnk;
 
-  twohopdata = nhdp_domain_get_l2hopdata(domain, two_hop);
-  return two_hop->link->local_if == current_interface
-      && twohopdata->metric.out <= RFC7181_METRIC_MAX;
+  lnk = &snapshot->links[idx];
+  return lnk->local_if == current_interface
+      && snapshot->link_out[domain->index][idx] <= RFC7181_METRIC_MAX
+      && lnk->status == NHDP_LINK_SYMMETRIC
+      && lnk->flooding_willingness > RFC7181_WILLINGNESS_NEVER;
 }
 
-static uint32_t
-_calculate_d1_x(const struct nhdp_domain *domain, struct n1_node *x) {
-  struct nhdp_link_domaindata *linkdata;
+/**
+ * Check if a 2-hop tuple of the snapshot is "allowed". The 2-hop tuple is
+ * always on the current interface, because its link is part of N1.
+ * @param domain NHDP domain
+ * @param snapshot neighbor graph snapshot
+ * @param idx index of 2-hop neighbor in snapshot
+ * @return true if 2-hop tuple is allowed, false otherwise
+ */
+static bool
+_is_allowed_2hop_tuple(const struct nhdp_domain *domain,
+    const struct mpr_neighbor_snapshot *snapshot, uint32_t idx) {
+  return snapshot->twohop_out[domain->index][idx] <= RFC7181_METRIC_MAX;
+}
 
-  linkdata = nhdp_domain_get_linkdata(domain, x->link);
-  return linkdata->metric.out;
+static uint32_t
+_calculate_d1_x(const struct nhdp_domain *domain,
+    struct neighbor_graph *graph, struct n1_node *x) {
+  return graph->snapshot->link_out[domain->index][x->snapshot_idx];
 }
 
 static uint32_t
 _calculate_d2_x_y(const struct nhdp_domain *domain,
-    struct n1_node *x, struct addr_node *y) {
-  struct nhdp_l2hop *tmp_l2hop;
-  struct nhdp_l2hop_domaindata *twohopdata;
+    struct neighbor_graph *graph, struct n1_node *x, struct addr_node *y) {
+  int32_t twohop;
 
   /* find the corresponding 2-hop entry, if it exists */
-  tmp_l2hop = avl_find_element(&x->link->_2hop,
-      &y->addr, tmp_l2hop, _link_node);
-  if (tmp_l2hop) {
-    twohopdata = nhdp_domain_get_l2hopdata(domain, tmp_l2hop);
-    return twohopdata->metric.out;
+  twohop = mpr_snapshot_find_twohop(graph->snapshot,
+      &graph->snapshot->links[x->snapshot_idx], &y->addr);
+  if (twohop >= 0) {
+    return graph->snapshot->twohop_out[domain->index][twohop];
   }
   return RFC7181_METRIC_INFINITE;
 }
@@ -168,8 +190,8 @@ _calculate_d_x_y(const struct nhdp_domain *domain,
   assert(graph->d_x_y_cache);
   cost = graph->d_x_y_cache[idx];
   if (!cost) {
-    cost1 = _calculate_d1_x(domain, x);
-    cost2 = _calculate_d2_x_y(domain, x, y);
+    cost1 = _calculate_d1_x(domain, graph, x);
+    cost2 = _calculate_d2_x_y(domain, graph, x, y);
     if (cost1 > RFC7181_METRIC_MAX || cost2 > RFC7181_METRIC_MAX) {
       cost = RFC7181_METRIC_INFINITE_PATH;
     }
@@ -203,19 +225,18 @@ _calculate_d_x_y(const struct nhdp_domain *domain,
 uint32_t
 _calculate_d1_x_of_n2_addr(const struct nhdp_domain *domain,
     struct neighbor_graph *graph, struct addr_node *addr) {
+  const struct mpr_neighbor_snapshot *snapshot;
   struct n1_node *node_n1;
-  struct nhdp_naddr *naddr;
-  struct nhdp_link_domaindata *linkdata;
+  uint32_t neigh_idx;
 
   // FIXME Implementation correct?!?!
 
+  snapshot = graph->snapshot;
   avl_for_each_element(&graph->set_n1, node_n1, _avl_node) {
     /* check if the address provided corresponds to this node */
-    naddr = avl_find_element(&node_n1->neigh->_neigh_addresses,
-        &addr->addr, naddr, _neigh_node);
-    if (naddr) {
-      linkdata = nhdp_domain_get_linkdata(domain, node_n1->link);
-      return linkdata->metric.out;
+    neigh_idx = snapshot->links[node_n1->snapshot_idx].neigh_idx;
+    if (mpr_snapshot_has_address(snapshot, &snapshot->neighbors[neigh_idx], &addr->addr)) {
+      return snapshot->link_out[domain->index][node_n1->snapshot_idx];
     }
   }
 
@@ -229,17 +250,25 @@ _calculate_d1_x_of_n2_addr(const struct nhdp_domain *domain,
  */
 static void
 _calculate_n1(const struct nhdp_domain *domain, struct mpr_flooding_data *data) {
+  const struct mpr_neighbor_snapshot *snapshot;
   struct nhdp_link *lnk;
+  struct n1_node *n1;
+  uint32_t i;
 
   OONF_DEBUG(LOG_MPR, "Calculate N1 (flooding) for interface %s",
       nhdp_interface_get_name(data->current_interface));
 
-  list_for_each_element(nhdp_db_get_link_list(), lnk, _global_node) {
+  snapshot = data->neigh_graph.snapshot;
+  for (i=0; i<snapshot->link_count; i++) {
     // Reset temporary selection state 
+    lnk = snapshot->links[i].lnk;
     lnk->neigh->selection_is_mpr = false;
     
-    if (_is_allowed_link_tuple(domain, data->current_interface, lnk)) {
-      mpr_add_n1_node_to_set(&data->neigh_graph.set_n1, lnk->neigh, lnk, 0);
+    if (_is_allowed_snapshot_link(domain, data->current_interface, snapshot, i)) {
+      n1 = mpr_add_n1_node_to_set(&data->neigh_graph.set_n1, lnk->neigh, lnk, 0);
+      if (n1 != NULL && n1->link == lnk) {
+        n1->snapshot_idx = i;
+      }
     }
   }
 }
@@ -259,17 +288,22 @@ _calculate_n1(const struct nhdp_domain *domain, struct mpr_flooding_data *data)
  */
 static void
 _calculate_n2(const struct nhdp_domain *domain, struct mpr_flooding_data *data) {
+  const struct mpr_neighbor_snapshot *snapshot;
+  const struct mpr_snapshot_link *lnk;
   struct n1_node *n1_neigh;
-  struct nhdp_l2hop *twohop;
+  uint32_t t;
 
   OONF_DEBUG(LOG_MPR, "Calculate N2 for flooding MPRs");
 
+  snapshot = data->neigh_graph.snapshot;
+
   /* iterate over all two-hop neighbor addresses of N1 members */
   avl_for_each_element(&data->neigh_graph.set_n1, n1_neigh, _avl_node) {
-    avl_for_each_element(&n1_neigh->link->_2hop, twohop, _link_node) {
-      if (_is_allowed_2hop_tuple(domain, data->current_interface, twohop)) {
+    lnk = &snapshot->links[n1_neigh->snapshot_idx];
+    for (t=lnk->twohop_start; t<lnk->twohop_start + lnk->twohop_count; t++) {
+      if (_is_allowed_2hop_tuple(domain, snapshot, t)) {
         mpr_add_addr_node_to_set(&data->neigh_graph.set_n2,
-            twohop->twohop_addr, 0);
+            snapshot->twohops[t], 0);
       }
     }
   }
@@ -287,11 +321,18 @@ _get_willingness_n1(const struct nhdp_domain *domain __attribute__((unused)),
   return node->link->flooding_willingness;
 }
 
+/**
+ * Calculate the neighbor graph for flooding MPRs of an interface
+ * @param domain NHDP flooding domain
+ * @param data flooding data
+ * @param snapshot NHDP database snapshot
+ */
 void
-mpr_calculate_neighbor_graph_flooding(const struct nhdp_domain *domain, struct mpr_flooding_data *data) {
+mpr_calculate_neighbor_graph_flooding(const struct nhdp_domain *domain,
+    struct mpr_flooding_data *data, const struct mpr_neighbor_snapshot *snapshot) {
   OONF_DEBUG(LOG_MPR, "Calculate neighbor graph for flooding MPRs");
 
-  mpr_init_neighbor_graph(&data->neigh_graph, &_api_interface);
+  mpr_init_neighbor_graph(&data->neigh_graph, &_api_interface, snapshot);
   _calculate_n1(domain, data);
   _calculate_n2(domain, data);
 }
@@ -57,7 +57,7 @@ struct mpr_flooding_data {
     struct neighbor_graph neigh_graph;
 };
 
-void mpr_calculate_neighbor_graph_flooding(
-    const struct nhdp_domain *domain, struct mpr_flooding_data *data);
+void mpr_calculate_neighbor_graph_flooding(const struct nhdp_domain *domain,
+    struct mpr_flooding_data *data, const struct mpr_neighbor_snapshot *snapshot);
 
 #endif
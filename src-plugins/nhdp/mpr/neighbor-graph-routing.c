@@ -72,7 +72,7 @@ static uint32_t _calculate_d1_x_of_n2_addr(const struct nhdp_domain *domain,
 static uint32_t _calculate_d_x_y(const struct nhdp_domain *domain,
     struct neighbor_graph *, struct n1_node *x, struct addr_node *y);
 static uint32_t _calculate_d2_x_y(const struct nhdp_domain *domain,
-    struct n1_node *x, struct addr_node *y);
+    struct neighbor_graph *, struct n1_node *x, struct addr_node *y);
 static uint32_t _get_willingness_n1(const struct nhdp_domain *domain,
     struct n1_node *node);
 
@@ -124,47 +124,64 @@ _is_allowed_link_tuple(const struct nhdp_domain *domain,
   return _is_allowed_neighbor_tuple(domain, lnk->neigh);
 }
 
+/**
+ * Check if a neighbor of the snapshot is "allowed" according to section 18.4
+ * @param domain NHDP domain
+ * @param snapshot neighbor graph snapshot
+ * @param idx index of neighbor in snapshot
+ * @return true if allowed, false otherwise
+ */
 static bool
-_is_allowed_2hop_tuple(const struct nhdp_domain *domain, struct nhdp_l2hop *two_hop) {
-  struct nhdp_l2hop_domaindata *neighdata;
-  neighdata = nhdp_domain_get_l2hopdata(domain, two_hop);
-  return neighdata->metric.in <= RFC7181_METRIC_MAX;
+_is_allowed_snapshot_neighbor(const struct nhdp_domain *domain,
+    const struct mpr_neighbor_snapshot *snapshot, uint32_t idx) {
+  return snapshot->neigh_in[domain->index][idx] <= RFC7181_METRIC_MAX
+      && snapshot->neighbors[idx].symmetric > 0
+      && snapshot->neigh_willingness[domain->index][idx] > RFC7181_WILLINGNESS_NEVER;
+}
+
+static bool
+_is_allowed_2hop_tuple(const struct nhdp_domain *domain,
+    const struct mpr_neighbor_snapshot *snapshot, uint32_t idx) {
+  return snapshot->twohop_in[domain->index][idx] <= RFC7181_METRIC_MAX;
 }
 
 /**
  * Calculate d1(x) according to section 18.2 (draft 19)
  * @param domain NHDP domain
+ * @param graph neighbor graph instance
  * @param x node x
  * @return metric distance
  */
 static uint32_t
-_calculate_d1_x(const struct nhdp_domain *domain, struct n1_node *x) {
-  struct nhdp_neighbor_domaindata *neighdata;
-
-  neighdata = nhdp_domain_get_neighbordata(domain, x->neigh);
-  return neighdata->metric.in;
+_calculate_d1_x(const struct nhdp_domain *domain,
+    struct neighbor_graph *graph, struct n1_node *x) {
+  return graph->snapshot->neigh_in[domain->index][x->snapshot_idx];
 }
 
 /**
  * Calculate d2(x,y) according to section 18.2 (draft 19)
  * @param domain NHDP domain
+ * @param graph neighbor graph instance
  * @param x node x
  * @param y node y
  * @return metric distance
  */
 static uint32_t
-_calculate_d2_x_y(const struct nhdp_domain *domain, struct n1_node *x, struct addr_node *y) {
-  struct nhdp_l2hop *l2hop;
-  struct nhdp_link *lnk;
-  struct nhdp_l2hop_domaindata *twohopdata;
+_calculate_d2_x_y(const struct nhdp_domain *domain,
+    struct neighbor_graph *graph, struct n1_node *x, struct addr_node *y) {
+  const struct mpr_neighbor_snapshot *snapshot;
+  const struct mpr_snapshot_neighbor *neigh;
+  uint32_t i;
+  int32_t twohop;
+
+  snapshot = graph->snapshot;
+  neigh = &snapshot->neighbors[x->snapshot_idx];
 
   /* find the corresponding 2-hop entry, if it exists */
-  list_for_each_element(&x->neigh->_links, lnk, _neigh_node) {
-    l2hop = avl_find_element(&lnk->_2hop,
-        &y->addr, l2hop, _link_node);
-    if (l2hop) {
-      twohopdata = nhdp_domain_get_l2hopdata(domain, l2hop);
-      return twohopdata->metric.in;
+  for (i=neigh->link_start; i<neigh->link_start + neigh->link_count; i++) {
+    twohop = mpr_snapshot_find_twohop(snapshot, &snapshot->links[i], &y->addr);
+    if (twohop >= 0) {
+      return snapshot->twohop_in[domain->index][twohop];
     }
   }
   return RFC7181_METRIC_INFINITE;
@@ -182,8 +199,8 @@ _calculate_d_x_y(const struct nhdp_domain *domain,
   assert(graph->d_x_y_cache);
   cost = graph->d_x_y_cache[idx];
   if (!cost) {
-    cost1 = _calculate_d1_x(domain, x);
-    cost2 = _calculate_d2_x_y(domain, x, y);
+    cost1 = _calculate_d1_x(domain, graph, x);
+    cost2 = _calculate_d2_x_y(domain, graph, x, y);
     if (cost1 > RFC7181_METRIC_MAX || cost2 > RFC7181_METRIC_MAX) {
       cost = RFC7181_METRIC_INFINITE_PATH;
     }
@@ -217,17 +234,16 @@ _calculate_d_x_y(const struct nhdp_domain *domain,
 static uint32_t
 _calculate_d1_of_y(const struct nhdp_domain *domain,
     struct neighbor_graph *graph, struct addr_node *y) {
+  const struct mpr_neighbor_snapshot *snapshot;
   struct n1_node *node_n1;
-  struct nhdp_laddr *laddr;
-  struct nhdp_neighbor_domaindata *neighdata;
+
+  snapshot = graph->snapshot;
 
   /* find the N1 neighbor corresponding to this address, if it exists */
   avl_for_each_element(&graph->set_n1, node_n1, _avl_node) {
-    laddr = avl_find_element(&node_n1->neigh->_neigh_addresses, y,
-        laddr, _neigh_node);
-    if (laddr != NULL) {
-      neighdata = nhdp_domain_get_neighbordata(domain, node_n1->neigh);
-      return neighdata->metric.in;
+    if (mpr_snapshot_has_address(snapshot,
+        &snapshot->neighbors[node_n1->snapshot_idx], &y->addr)) {
+      return snapshot->neigh_in[domain->index][node_n1->snapshot_idx];
     }
   }
   return RFC7181_METRIC_INFINITE;
@@ -257,7 +273,10 @@ _calculate_d1_x_of_n2_addr(const struct nhdp_domain *domain,
  */
 static void
 _calculate_n1(const struct nhdp_domain *domain, struct neighbor_graph *graph) {
+  const struct mpr_neighbor_snapshot *snapshot;
   struct nhdp_neighbor *neigh;
+  struct n1_node *n1;
+  uint32_t i;
 
 #ifdef OONF_LOG_DEBUG_INFO
   struct netaddr_str buf1;
@@ -265,60 +284,58 @@ _calculate_n1(const struct nhdp_domain *domain, struct neighbor_graph *graph) {
   
   OONF_DEBUG(LOG_MPR, "Calculate N1 for routing MPRs");
   
-  list_for_each_element(nhdp_db_get_neigh_list(), neigh, _global_node) {
+  snapshot = graph->snapshot;
+  for (i=0; i<snapshot->neighbor_count; i++) {
     // Reset temporary selection state 
+    neigh = snapshot->neighbors[i].neigh;
 
     neigh->selection_is_mpr = false;
-    if (_is_allowed_neighbor_tuple(domain, neigh)) {
+    if (_is_allowed_snapshot_neighbor(domain, snapshot, i)) {
       OONF_DEBUG(LOG_MPR, "Add neighbor %s in: %u", netaddr_to_string(&buf1, &neigh->originator),
-          nhdp_domain_get_neighbordata(domain, neigh)->metric.in);
-      mpr_add_n1_node_to_set(&graph->set_n1, neigh, NULL, 0);
+          snapshot->neigh_in[domain->index][i]);
+      n1 = mpr_add_n1_node_to_set(&graph->set_n1, neigh, NULL, 0);
+      if (n1 != NULL && n1->neigh == neigh) {
+        n1->snapshot_idx = i;
+      }
     }
   }
 }
 
 static void
 _calculate_n2(const struct nhdp_domain *domain, struct neighbor_graph *graph) {
+  const struct mpr_neighbor_snapshot *snapshot;
+  const struct mpr_snapshot_neighbor *neigh;
   struct n1_node *n1_neigh;
-  struct nhdp_link *lnk;
-  struct nhdp_l2hop *twohop;
+  uint32_t l, t;
   
 #ifdef OONF_LOG_DEBUG_INFO
-  struct nhdp_l2hop_domaindata *l2data;
-  struct nhdp_neighbor_domaindata *neighdata;
   struct netaddr_str nbuf1, nbuf2;
 #endif
   
   OONF_DEBUG(LOG_MPR, "Calculate N2 for routing MPRs");
 
-//    list_for_each_element(&nhdp_neigh_list, neigh, _global_node) {
-//      list_for_each_element(&neigh->_links, link, _if_node) {
-//        OONF_DEBUG(LOG_MPR, "Link status %u", link->neigh->symmetric);
-//      }
-//    }
+  snapshot = graph->snapshot;
 
   /* iterate over all two-hop neighbor addresses of N1 members */
-    avl_for_each_element(&graph->set_n1, n1_neigh, _avl_node) {
-      list_for_each_element(&n1_neigh->neigh->_links,
-          lnk, _neigh_node) {
-        avl_for_each_element(&lnk->_2hop, twohop, _link_node) {
-          // OONF_DEBUG(LOG_MPR, "Link status %u", lnk->neigh->symmetric);
-          if (_is_allowed_2hop_tuple(domain, twohop)) {
-
-#ifdef OONF_LOG_DEBUG_INFO
-            neighdata = nhdp_domain_get_neighbordata(domain, n1_neigh->neigh);
-            l2data = nhdp_domain_get_l2hopdata(domain, twohop);
-            OONF_DEBUG(LOG_MPR, "Add twohop addr %s (over %s) in: %u out: %u (path-in: %u path-out: %u)",
-                    netaddr_to_string(&nbuf1, &twohop->twohop_addr),
-                    netaddr_to_string(&nbuf2, &n1_neigh->addr),
-                    l2data->metric.in, l2data->metric.out,
-                    l2data->metric.in + neighdata->metric.in, l2data->metric.out + neighdata->metric.out);
-#endif
-            mpr_add_addr_node_to_set(&graph->set_n2, twohop->twohop_addr, 0);
-          }
+  avl_for_each_element(&graph->set_n1, n1_neigh, _avl_node) {
+    neigh = &snapshot->neighbors[n1_neigh->snapshot_idx];
+
+    for (l=neigh->link_start; l<neigh->link_start + neigh->link_count; l++) {
+      for (t=snapshot->links[l].twohop_start;
+          t<snapshot->links[l].twohop_start + snapshot->links[l].twohop_count; t++) {
+        if (_is_allowed_2hop_tuple(domain, snapshot, t)) {
+          OONF_DEBUG(LOG_MPR, "Add twohop addr %s (over %s) in: %u out: %u (path-in: %u)",
+              netaddr_to_string(&nbuf1, &snapshot->twohops[t]),
+              netaddr_to_string(&nbuf2, &n1_neigh->addr),
+              snapshot->twohop_in[domain->index][t],
+              snapshot->twohop_out[domain->index][t],
+              snapshot->twohop_in[domain->index][t]
+                + snapshot->neigh_in[domain->index][n1_neigh->snapshot_idx]);
+          mpr_add_addr_node_to_set(&graph->set_n2, snapshot->twohops[t], 0);
         }
       }
     }
+  }
 }
 
 /**
@@ -340,16 +357,22 @@ neighbor_graph_interface *_get_neighbor_graph_interface_routing(void) {
   return &_rt_api_interface;
 }
 
+/**
+ * Calculate the neighbor graph for routing MPRs of a domain
+ * @param domain NHDP domain
+ * @param graph neighbor graph instance
+ * @param snapshot NHDP database snapshot
+ */
 void
 mpr_calculate_neighbor_graph_routing(const struct nhdp_domain *domain,
-    struct neighbor_graph *graph) {
+    struct neighbor_graph *graph, const struct mpr_neighbor_snapshot *snapshot) {
   struct neighbor_graph_interface *methods;
 
   OONF_DEBUG(LOG_MPR, "Calculate neighbor graph for routing MPRs");
 
   methods = _get_neighbor_graph_interface_routing();
 
-  mpr_init_neighbor_graph(graph, methods);
+  mpr_init_neighbor_graph(graph, methods, snapshot);
   _calculate_n1(domain, graph);
   _calculate_n2(domain, graph);
 }
@@ -51,7 +51,7 @@
 #include "neighbor-graph.h"
 
 void mpr_calculate_neighbor_graph_routing(const struct nhdp_domain *domain,
-    struct neighbor_graph *graph);
+    struct neighbor_graph *graph, const struct mpr_neighbor_snapshot *snapshot);
 
 #endif
 
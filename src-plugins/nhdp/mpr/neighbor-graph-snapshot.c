@@ -0,0 +1,376 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "common/common_types.h"
+#include "common/avl.h"
+#include "common/list.h"
+#include "common/netaddr.h"
+#include "core/oonf_logging.h"
+
+#include "nhdp/nhdp.h"
+#include "nhdp/nhdp_db.h"
+#include "nhdp/nhdp_domain.h"
+
+#include "mpr/mpr_internal.h"
+#include "mpr/neighbor-graph-snapshot.h"
+
+static int _resize(void **array, size_t count, size_t elem_size);
+static int _resize_neighbors(struct mpr_neighbor_snapshot *, uint32_t count);
+static int _resize_links(struct mpr_neighbor_snapshot *, uint32_t count);
+static int _resize_twohops(struct mpr_neighbor_snapshot *, uint32_t count);
+static int _resize_addresses(struct mpr_neighbor_snapshot *, uint32_t count);
+static void _fill(struct mpr_neighbor_snapshot *snapshot);
+
+/**
+ * Make sure the snapshot represents the current NHDP database.
+ * The snapshot is only rebuilt if the NHDP MPR generation changed
+ * since the last call.
+ * @param snapshot neighbor graph snapshot
+ * @return -1 if an error happened, 0 otherwise
+ */
+int
+mpr_snapshot_update(struct mpr_neighbor_snapshot *snapshot) {
+  struct nhdp_neighbor *neigh;
+  struct nhdp_link *lnk;
+  uint32_t neigh_count, link_count, twohop_count, addr_count;
+
+  if (snapshot->valid
+      && snapshot->generation == nhdp_domain_get_mpr_generation()) {
+    snapshot->stat_reused++;
+    return 0;
+  }
+
+  snapshot->valid = false;
+
+  neigh_count = 0;
+  link_count = 0;
+  twohop_count = 0;
+  addr_count = 0;
+  list_for_each_element(nhdp_db_get_neigh_list(), neigh, _global_node) {
+    neigh_count++;
+    addr_count += neigh->_neigh_addresses.count;
+
+    list_for_each_element(&neigh->_links, lnk, _neigh_node) {
+      link_count++;
+      twohop_count += lnk->_2hop.count;
+    }
+  }
+
+  if (_resize_neighbors(snapshot, neigh_count)
+      || _resize_links(snapshot, link_count)
+      || _resize_twohops(snapshot, twohop_count)
+      || _resize_addresses(snapshot, addr_count)) {
+    OONF_WARN(LOG_MPR, "Not enough memory for neighbor graph snapshot");
+    return -1;
+  }
+
+  _fill(snapshot);
+
+  OONF_DEBUG(LOG_MPR, "Built neighbor graph snapshot: %u neighbors, %u links,"
+      " %u 2-hop addresses, %u neighbor addresses",
+      neigh_count, link_count, twohop_count, addr_count);
+
+  snapshot->generation = nhdp_domain_get_mpr_generation();
+  snapshot->valid = true;
+  snapshot->stat_built++;
+  return 0;
+}
+
+/**
+ * Free all memory of a neighbor graph snapshot
+ * @param snapshot neighbor graph snapshot
+ */
+void
+mpr_snapshot_clear(struct mpr_neighbor_snapshot *snapshot) {
+  size_t i;
+
+  free(snapshot->neighbors);
+  free(snapshot->links);
+  free(snapshot->twohops);
+  free(snapshot->addresses);
+
+  for (i=0; i<NHDP_MAXIMUM_DOMAINS; i++) {
+    free(snapshot->neigh_in[i]);
+    free(snapshot->neigh_willingness[i]);
+    free(snapshot->link_out[i]);
+    free(snapshot->twohop_in[i]);
+    free(snapshot->twohop_out[i]);
+  }
+
+  memset(snapshot, 0, sizeof(*snapshot));
+}
+
+/**
+ * Lookup a 2-hop neighbor address of a link
+ * @param snapshot neighbor graph snapshot
+ * @param lnk link of snapshot
+ * @param addr 2-hop neighbor address
+ * @return index of 2-hop neighbor in snapshot, -1 if not found
+ */
+int32_t
+mpr_snapshot_find_twohop(const struct mpr_neighbor_snapshot *snapshot,
+    const struct mpr_snapshot_link *lnk, const struct netaddr *addr) {
+  uint32_t left, right, middle;
+  int result;
+
+  left = lnk->twohop_start;
+  right = lnk->twohop_start + lnk->twohop_count;
+  while (left < right) {
+    middle = left + (right - left) / 2;
+    result = netaddr_cmp(&snapshot->twohops[middle], addr);
+    if (result == 0) {
+      return (int32_t)middle;
+    }
+    if (result < 0) {
+      left = middle + 1;
+    }
+    else {
+      right = middle;
+    }
+  }
+  return -1;
+}
+
+/**
+ * Check if an address belongs to a neighbor
+ * @param snapshot neighbor graph snapshot
+ * @param neigh neighbor of snapshot
+ * @param addr network address
+ * @return true if address is one of the neighbor addresses
+ */
+bool
+mpr_snapshot_has_address(const struct mpr_neighbor_snapshot *snapshot,
+    const struct mpr_snapshot_neighbor *neigh, const struct netaddr *addr) {
+  uint32_t left, right, middle;
+  int result;
+
+  left = neigh->addr_start;
+  right = neigh->addr_start + neigh->addr_count;
+  while (left < right) {
+    middle = left + (right - left) / 2;
+    result = netaddr_cmp(&snapshot->addresses[middle], addr);
+    if (result == 0) {
+      return true;
+    }
+    if (result < 0) {
+      left = middle + 1;
+    }
+    else {
+      right = middle;
+    }
+  }
+  return false;
+}
+
+/**
+ * Copy the NHDP database into the arrays of the snapshot
+ * @param snapshot neighbor graph snapshot
+ */
+static void
+_fill(struct mpr_neighbor_snapshot *snapshot) {
+  struct mpr_snapshot_neighbor *s_neigh;
+  struct mpr_snapshot_link *s_link;
+  struct nhdp_neighbor *neigh;
+  struct nhdp_link *lnk;
+  struct nhdp_l2hop *l2hop;
+  struct nhdp_naddr *naddr;
+  uint32_t n, l, t, a;
+  size_t i;
+
+  n = 0;
+  l = 0;
+  t = 0;
+  a = 0;
+  list_for_each_element(nhdp_db_get_neigh_list(), neigh, _global_node) {
+    s_neigh = &snapshot->neighbors[n];
+    s_neigh->neigh = neigh;
+    s_neigh->symmetric = neigh->symmetric;
+    s_neigh->link_start = l;
+    s_neigh->addr_start = a;
+
+    for (i=0; i<NHDP_MAXIMUM_DOMAINS; i++) {
+      snapshot->neigh_in[i][n] = neigh->_domaindata[i].metric.in;
+      snapshot->neigh_willingness[i][n] = neigh->_domaindata[i].willingness;
+    }
+
+    /* the tree is sorted, so the address range can be binary searched */
+    avl_for_each_element(&neigh->_neigh_addresses, naddr, _neigh_node) {
+      snapshot->addresses[a++] = naddr->neigh_addr;
+    }
+
+    list_for_each_element(&neigh->_links, lnk, _neigh_node) {
+      s_link = &snapshot->links[l];
+      s_link->lnk = lnk;
+      s_link->local_if = lnk->local_if;
+      s_link->neigh_idx = n;
+      s_link->status = lnk->status;
+      s_link->flooding_willingness = lnk->flooding_willingness;
+      s_link->twohop_start = t;
+
+      for (i=0; i<NHDP_MAXIMUM_DOMAINS; i++) {
+        snapshot->link_out[i][l] = lnk->_domaindata[i].metric.out;
+      }
+
+      avl_for_each_element(&lnk->_2hop, l2hop, _link_node) {
+        snapshot->twohops[t] = l2hop->twohop_addr;
+        for (i=0; i<NHDP_MAXIMUM_DOMAINS; i++) {
+          snapshot->twohop_in[i][t] = l2hop->_domaindata[i].metric.in;
+          snapshot->twohop_out[i][t] = l2hop->_domaindata[i].metric.out;
+        }
+        t++;
+      }
+
+      s_link->twohop_count = t - s_link->twohop_start;
+      l++;
+    }
+
+    s_neigh->link_count = l - s_neigh->link_start;
+    s_neigh->addr_count = a - s_neigh->addr_start;
+    n++;
+  }
+
+  snapshot->neighbor_count = n;
+  snapshot->link_count = l;
+  snapshot->twohop_count = t;
+  snapshot->addr_count = a;
+}
+
+/**
+ * Reallocate an array of the snapshot
+ * @param array pointer to array pointer
+ * @param count number of elements
+ * @param elem_size size of an element
+ * @return -1 if an error happened, 0 otherwise
+ */
+static int
+_resize(void **array, size_t count, size_t elem_size) {
+  void *ptr;
+
+  /* allocate at least one element, realloc(0) might return NULL */
+  ptr = realloc(*array, (count + 1) * elem_size);
+  if (!ptr) {
+    return -1;
+  }
+  *array = ptr;
+  return 0;
+}
+
+static int
+_resize_neighbors(struct mpr_neighbor_snapshot *snapshot, uint32_t count) {
+  size_t i;
+
+  if (snapshot->neighbors != NULL && count <= snapshot->_neighbor_size) {
+    return 0;
+  }
+
+  if (_resize((void **)&snapshot->neighbors, count, sizeof(*snapshot->neighbors))) {
+    return -1;
+  }
+  for (i=0; i<NHDP_MAXIMUM_DOMAINS; i++) {
+    if (_resize((void **)&snapshot->neigh_in[i], count, sizeof(uint32_t))
+        || _resize((void **)&snapshot->neigh_willingness[i], count, sizeof(uint8_t))) {
+      return -1;
+    }
+  }
+  snapshot->_neighbor_size = count;
+  return 0;
+}
+
+static int
+_resize_links(struct mpr_neighbor_snapshot *snapshot, uint32_t count) {
+  size_t i;
+
+  if (snapshot->links != NULL && count <= snapshot->_link_size) {
+    return 0;
+  }
+
+  if (_resize((void **)&snapshot->links, count, sizeof(*snapshot->links))) {
+    return -1;
+  }
+  for (i=0; i<NHDP_MAXIMUM_DOMAINS; i++) {
+    if (_resize((void **)&snapshot->link_out[i], count, sizeof(uint32_t))) {
+      return -1;
+    }
+  }
+  snapshot->_link_size = count;
+  return 0;
+}
+
+static int
+_resize_twohops(struct mpr_neighbor_snapshot *snapshot, uint32_t count) {
+  size_t i;
+
+  if (snapshot->twohops != NULL && count <= snapshot->_twohop_size) {
+    return 0;
+  }
+
+  if (_resize((void **)&snapshot->twohops, count, sizeof(*snapshot->twohops))) {
+    return -1;
+  }
+  for (i=0; i<NHDP_MAXIMUM_DOMAINS; i++) {
+    if (_resize((void **)&snapshot->twohop_in[i], count, sizeof(uint32_t))
+        || _resize((void **)&snapshot->twohop_out[i], count, sizeof(uint32_t))) {
+      return -1;
+    }
+  }
+  snapshot->_twohop_size = count;
+  return 0;
+}
+
+static int
+_resize_addresses(struct mpr_neighbor_snapshot *snapshot, uint32_t count) {
+  if (snapshot->addresses != NULL && count <= snapshot->_addr_size) {
+    return 0;
+  }
+
+  if (_resize((void **)&snapshot->addresses, count, sizeof(*snapshot->addresses))) {
+    return -1;
+  }
+  snapshot->_addr_size = count;
+  return 0;
+}
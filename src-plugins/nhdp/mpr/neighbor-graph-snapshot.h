@@ -0,0 +1,177 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#ifndef __NEIGHBOR_GRAPH_SNAPSHOT__
+#define __NEIGHBOR_GRAPH_SNAPSHOT__
+
+#include "common/common_types.h"
+#include "common/netaddr.h"
+#include "nhdp/nhdp.h"
+#include "nhdp/nhdp_db.h"
+#include "nhdp/nhdp_domain.h"
+
+/**
+ * Snapshot of a NHDP neighbor
+ */
+struct mpr_snapshot_neighbor {
+  /*! NHDP neighbor */
+  struct nhdp_neighbor *neigh;
+
+  /*! number of symmetric links of neighbor */
+  int symmetric;
+
+  /*! first link of neighbor in link array */
+  uint32_t link_start;
+
+  /*! number of links of neighbor */
+  uint32_t link_count;
+
+  /*! first neighbor address in address array */
+  uint32_t addr_start;
+
+  /*! number of neighbor addresses */
+  uint32_t addr_count;
+};
+
+/**
+ * Snapshot of a NHDP link
+ */
+struct mpr_snapshot_link {
+  /*! NHDP link */
+  struct nhdp_link *lnk;
+
+  /*! local interface of link */
+  struct nhdp_interface *local_if;
+
+  /*! index of neighbor of link in neighbor array */
+  uint32_t neigh_idx;
+
+  /*! first 2-hop neighbor of link in 2-hop array */
+  uint32_t twohop_start;
+
+  /*! number of 2-hop neighbors of link */
+  uint32_t twohop_count;
+
+  /*! status of link */
+  enum nhdp_link_status status;
+
+  /*! flooding willingness of link */
+  uint8_t flooding_willingness;
+};
+
+/**
+ * Shared, read-only copy of the parts of the NHDP database the MPR
+ * calculation needs. Neighbors, links, 2-hop addresses and neighbor
+ * addresses are stored in flat arrays, the links of a neighbor,
+ * the 2-hop addresses of a link and the addresses of a neighbor are
+ * consecutive ranges (the latter two sorted by address).
+ * Metrics and willingness are stored as one column per domain index,
+ * so all routing domains and the flooding MPRs of all interfaces can
+ * use the same snapshot.
+ */
+struct mpr_neighbor_snapshot {
+  /*! NHDP MPR generation the snapshot was built for */
+  uint32_t generation;
+
+  /*! true if snapshot contains valid data */
+  bool valid;
+
+  /*! array of neighbors */
+  struct mpr_snapshot_neighbor *neighbors;
+
+  /*! array of links */
+  struct mpr_snapshot_link *links;
+
+  /*! array of 2-hop neighbor addresses */
+  struct netaddr *twohops;
+
+  /*! array of neighbor addresses */
+  struct netaddr *addresses;
+
+  /*! number of neighbors */
+  uint32_t neighbor_count;
+
+  /*! number of links */
+  uint32_t link_count;
+
+  /*! number of 2-hop neighbor addresses */
+  uint32_t twohop_count;
+
+  /*! number of neighbor addresses */
+  uint32_t addr_count;
+
+  /*! incoming metric of neighbors, one column per domain */
+  uint32_t *neigh_in[NHDP_MAXIMUM_DOMAINS];
+
+  /*! routing willingness of neighbors, one column per domain */
+  uint8_t *neigh_willingness[NHDP_MAXIMUM_DOMAINS];
+
+  /*! outgoing metric of links, one column per domain */
+  uint32_t *link_out[NHDP_MAXIMUM_DOMAINS];
+
+  /*! incoming metric of 2-hop neighbors, one column per domain */
+  uint32_t *twohop_in[NHDP_MAXIMUM_DOMAINS];
+
+  /*! outgoing metric of 2-hop neighbors, one column per domain */
+  uint32_t *twohop_out[NHDP_MAXIMUM_DOMAINS];
+
+  /* allocated length of the arrays */
+  uint32_t _neighbor_size, _link_size, _twohop_size, _addr_size;
+
+  /*! number of times the snapshot was built */
+  uint32_t stat_built;
+
+  /*! number of times the snapshot was reused */
+  uint32_t stat_reused;
+};
+
+int mpr_snapshot_update(struct mpr_neighbor_snapshot *snapshot);
+void mpr_snapshot_clear(struct mpr_neighbor_snapshot *snapshot);
+int32_t mpr_snapshot_find_twohop(const struct mpr_neighbor_snapshot *snapshot,
+    const struct mpr_snapshot_link *lnk, const struct netaddr *addr);
+bool mpr_snapshot_has_address(const struct mpr_neighbor_snapshot *snapshot,
+    const struct mpr_snapshot_neighbor *neigh, const struct netaddr *addr);
+
+#endif
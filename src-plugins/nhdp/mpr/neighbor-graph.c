@@ -67,20 +67,24 @@
 
 /* FIXME remove unneeded includes */
 
-void
+struct n1_node *
 mpr_add_n1_node_to_set(struct avl_tree *set, struct nhdp_neighbor *neigh, struct nhdp_link *lnk, uint32_t offset) {
   struct n1_node *tmp_n1_neigh;
   tmp_n1_neigh = avl_find_element(set, &neigh->originator, tmp_n1_neigh, _avl_node);
   if (tmp_n1_neigh) {
-    return;
+    return tmp_n1_neigh;
   }
   tmp_n1_neigh = calloc(1, sizeof (struct n1_node));
+  if (!tmp_n1_neigh) {
+    return NULL;
+  }
   tmp_n1_neigh->addr = neigh->originator;
   tmp_n1_neigh->_avl_node.key = &tmp_n1_neigh->addr;
   tmp_n1_neigh->neigh = neigh;
   tmp_n1_neigh->link = lnk;
   tmp_n1_neigh->table_offset = offset;
   avl_insert(set, &tmp_n1_neigh->_avl_node);
+  return tmp_n1_neigh;
 }
 
 void
@@ -103,15 +107,18 @@ mpr_add_addr_node_to_set(struct avl_tree *set, const struct netaddr addr, uint32
  * Initialize the MPR data set
  * @param graph neighbor graph instance
  * @param methods callback for handling graph
+ * @param snapshot NHDP database snapshot
  */
 void
-mpr_init_neighbor_graph(struct neighbor_graph *graph, struct neighbor_graph_interface *methods) {
+mpr_init_neighbor_graph(struct neighbor_graph *graph, struct neighbor_graph_interface *methods,
+    const struct mpr_neighbor_snapshot *snapshot) {
   avl_init(&graph->set_n, avl_comp_netaddr, false);
   avl_init(&graph->set_n1, avl_comp_netaddr, false);
   avl_init(&graph->set_n2, avl_comp_netaddr, false);
   avl_init(&graph->set_mpr, avl_comp_netaddr, false);
   avl_init(&graph->set_mpr_candidates, avl_comp_netaddr, false);
   graph->methods = methods;
+  graph->snapshot = snapshot;
 }
 
 /**
@@ -51,6 +51,8 @@
 #include "nhdp/nhdp_db.h"
 #include "nhdp/nhdp_domain.h"
 
+#include "neighbor-graph-snapshot.h"
+
 struct neighbor_graph;
 struct addr_node;
 struct n1_node;
@@ -63,7 +65,7 @@ struct neighbor_graph_interface {
     uint32_t (*calculate_d_x_y)(const struct nhdp_domain *,
         struct neighbor_graph*, struct n1_node*, struct addr_node*);
     uint32_t (*calculate_d2_x_y)(const struct nhdp_domain *,
-        struct n1_node*, struct addr_node*);
+        struct neighbor_graph*, struct n1_node*, struct addr_node*);
     uint32_t (*get_willingness_n1)(const struct nhdp_domain *, struct n1_node*);
 };
 
@@ -76,6 +78,9 @@ struct neighbor_graph {
     struct neighbor_graph_interface *methods;
     
     uint32_t *d_x_y_cache;
+
+    /* shared NHDP database snapshot the graph was calculated from */
+    const struct mpr_neighbor_snapshot *snapshot;
 };
 
 /* FIXME Find a more consistent naming and/or approach to defining the set elements */
@@ -96,13 +101,17 @@ struct n1_node {
     struct avl_node _avl_node;
     
     uint32_t table_offset;
+
+    /* index of neighbor (routing) or link (flooding) in the snapshot */
+    uint32_t snapshot_idx;
 };
 
-void mpr_add_n1_node_to_set(struct avl_tree *set, struct nhdp_neighbor *neigh, struct nhdp_link *link, uint32_t offset);
+struct n1_node *mpr_add_n1_node_to_set(struct avl_tree *set, struct nhdp_neighbor *neigh, struct nhdp_link *link, uint32_t offset);
 
 void mpr_add_addr_node_to_set(struct avl_tree *set, const struct netaddr addr, uint32_t offset);
 
-void mpr_init_neighbor_graph(struct neighbor_graph *graph, struct neighbor_graph_interface *methods);
+void mpr_init_neighbor_graph(struct neighbor_graph *graph, struct neighbor_graph_interface *methods,
+    const struct mpr_neighbor_snapshot *snapshot);
 
 void mpr_clear_addr_set(struct avl_tree *set);
 
@@ -43,416 +43,725 @@
  * @file
  */
 
+#include <stdlib.h>
+#include <string.h>
+
 #include "nhdp/nhdp.h"
 #include "nhdp/nhdp_db.h"
 #include "nhdp/nhdp_domain.h"
 #include "nhdp/nhdp_interfaces.h"
 
 #include "common/common_types.h"
-#include "common/autobuf.h"
 #include "common/avl.h"
 #include "common/avl_comp.h"
+#include "common/bitset.h"
 #include "common/container_of.h"
-#include "config/cfg_schema.h"
 #include "core/oonf_logging.h"
 #include "subsystems/oonf_rfc5444.h"
-#include "subsystems/oonf_class.h"
 
 #include "mpr/mpr_internal.h"
-#include "mpr/neighbor-graph-flooding.h"
 #include "mpr/neighbor-graph.h"
 #include "mpr/mpr.h"
 #include "mpr/selection-rfc7181.h"
 
-/* FIXME remove unneeded includes */
-
-static void _calculate_n(const struct nhdp_domain *domain, struct neighbor_graph *graph);
-static unsigned int _calculate_r(const struct nhdp_domain *domain,
+static int _resize_engine(struct mpr_rfc7181_engine *engine,
+    uint32_t n1_count, uint32_t n2_count);
+static bool _is_same_graph(struct mpr_rfc7181_engine *engine,
+    struct n1_node **n1, uint32_t n1_count,
+    struct addr_node **n2, uint32_t n2_count);
+static int32_t _find_n2(struct mpr_rfc7181_engine *engine,
+    struct addr_node **n2, const struct netaddr *addr);
+static void _fill_row_from_link(struct mpr_rfc7181_engine *engine,
+    const struct nhdp_domain *domain, struct neighbor_graph *graph,
+    struct n1_node *x, struct addr_node **n2, uint32_t link_idx, uint32_t *row);
+static bool _update_input(struct mpr_rfc7181_engine *engine,
+    const struct nhdp_domain *domain, struct neighbor_graph *graph,
+    struct n1_node **n1, struct addr_node **n2, uint64_t *dirty, uint32_t *row);
+static void _update_columns(struct mpr_rfc7181_engine *engine, uint64_t *dirty);
+static void _select_mpr(struct mpr_rfc7181_engine *engine, uint64_t *covered);
+static uint32_t _calculate_r_avl(const struct nhdp_domain *domain,
     struct neighbor_graph *graph, struct n1_node *x_node);
+static void _calculate_mpr_avl(const struct nhdp_domain *domain,
+    struct neighbor_graph *graph);
+
+/**
+ * Free all memory of a MPR engine
+ * @param engine MPR engine
+ */
+void
+mpr_rfc7181_engine_clear(struct mpr_rfc7181_engine *engine) {
+  free(engine->n1_addr);
+  free(engine->n2_addr);
+  free(engine->willingness);
+  free(engine->d1_y);
+  free(engine->d_x_y);
+  free(engine->min_d_y);
+  free(engine->set_n);
+  free(engine->minimal);
+  free(engine->reachable);
+  free(engine->mpr);
+  free(engine->selected);
+
+  engine->n1_addr = NULL;
+  engine->n2_addr = NULL;
+  engine->willingness = NULL;
+  engine->d1_y = NULL;
+  engine->d_x_y = NULL;
+  engine->min_d_y = NULL;
+  engine->set_n = NULL;
+  engine->minimal = NULL;
+  engine->reachable = NULL;
+  engine->mpr = NULL;
+  engine->selected = NULL;
+
+  engine->n1_count = 0;
+  engine->n2_count = 0;
+  engine->valid = false;
+}
 
 /**
- * Calculate N
- * 
- * This is a subset of N2 containing those addresses, for which there is no
- * direct link that has a lower metric cost than the two-hop path (so
- * it should  be covered by an MPR node).
- * 
+ * Calculate MPR
  * @param domain NHDP domain
  * @param graph neighbor graph instance
+ * @param engine MPR engine with the state of the last calculation
+ *   of this graph, NULL to use the AVL based selection without
+ *   keeping a state
  */
-static void
-_calculate_n(const struct nhdp_domain *domain, struct neighbor_graph *graph) {
-  struct addr_node *y_node;
-  uint32_t d1_y;
-  struct n1_node *x_node;
-  bool add_to_n;
+void
+mpr_calculate_mpr_rfc7181(const struct nhdp_domain *domain, struct neighbor_graph *graph,
+    struct mpr_rfc7181_engine *engine) {
+  struct n1_node *n1, **n1_nodes;
+  struct addr_node *n2, **n2_nodes;
+  uint64_t *dirty = NULL, *covered = NULL;
+  uint32_t *row = NULL;
+  uint32_t n1_count, n2_count, i;
+  bool full, changed;
 
-  OONF_DEBUG(LOG_MPR, "Calculate N");
+  OONF_DEBUG(LOG_MPR, "Calculate MPR set");
 
-  avl_for_each_element(&graph->set_n2, y_node, _avl_node) {
-    add_to_n = false;
+  n1_count = graph->set_n1.count;
+  n2_count = graph->set_n2.count;
 
-    /* calculate the 1-hop cost to this node (which may be undefined) */
-    d1_y = graph->methods->calculate_d1_x_of_n2_addr(domain, graph, y_node);
+  graph->d_x_y_cache = calloc(n1_count * n2_count, sizeof(uint32_t));
+  n1_nodes = calloc(n1_count + 1, sizeof(*n1_nodes));
+  n2_nodes = calloc(n2_count + 1, sizeof(*n2_nodes));
+  if ((n1_count * n2_count > 0 && graph->d_x_y_cache == NULL)
+      || !n1_nodes || !n2_nodes) {
+    OONF_WARN(LOG_MPR, "Not enough memory for MPR calculation");
+    goto calculate_mpr_cleanup;
+  }
+
+  /* map N1 and N2 to dense indices */
+  i=0;
+  avl_for_each_element(&graph->set_n1, n1, _avl_node) {
+    n1->table_offset = i;
+    n1_nodes[i] = n1;
+    i++;
+  }
+
+  i=0;
+  avl_for_each_element(&graph->set_n2, n2, _avl_node) {
+    n2->table_offset = i * n1_count;
+    n2_nodes[i] = n2;
+    i++;
+  }
 
-    /* if this neighbor can not be reached directly, we need to add it to N */
-    if (d1_y == RFC7181_METRIC_INFINITE) {
-      add_to_n = true;
+  if (engine == NULL || (uint64_t)n1_count * n2_count > MPR_RFC7181_ENGINE_MAX_CELLS) {
+    if (engine != NULL) {
+      OONF_DEBUG(LOG_MPR, "Graph too large for MPR engine (N1: %u, N2: %u)",
+          n1_count, n2_count);
+      mpr_rfc7181_engine_clear(engine);
+      engine->stat_too_large++;
+    }
+    _calculate_mpr_avl(domain, graph);
+    goto calculate_mpr_cleanup;
+  }
+
+  row = calloc(n2_count + 1, sizeof(*row));
+  dirty = calloc(BITSET_WORDS(n2_count) + 1, sizeof(*dirty));
+  covered = calloc(BITSET_WORDS(n2_count) + 1, sizeof(*covered));
+  if (!row || !dirty || !covered) {
+    OONF_WARN(LOG_MPR, "Not enough memory for MPR calculation");
+    goto calculate_mpr_cleanup;
+  }
+
+  /* a different N1 or N2 invalidates the whole state */
+  full = !_is_same_graph(engine, n1_nodes, n1_count, n2_nodes, n2_count);
+  if (full) {
+    if (_resize_engine(engine, n1_count, n2_count)) {
+      OONF_WARN(LOG_MPR, "Not enough memory for MPR calculation");
+      mpr_rfc7181_engine_clear(engine);
+      goto calculate_mpr_cleanup;
+    }
+    for (i=0; i<n1_count; i++) {
+      engine->n1_addr[i] = n1_nodes[i]->addr;
+    }
+    for (i=0; i<n2_count; i++) {
+      engine->n2_addr[i] = n2_nodes[i]->addr;
+    }
+  }
+
+  /* read metrics and willingness, remember which columns changed */
+  changed = _update_input(engine, domain, graph, n1_nodes, n2_nodes, dirty, row);
+  if (full) {
+    memset(dirty, 0xff, BITSET_WORDS(n2_count) * sizeof(*dirty));
+  }
+  if (bitset_get_first(dirty, engine->n2_words) >= 0) {
+    _update_columns(engine, dirty);
+    changed = true;
+  }
+
+  if (full || changed || !engine->valid) {
+    OONF_DEBUG(LOG_MPR, "%s MPR selection (N1: %u, N2: %u)",
+        full ? "Full" : "Incremental", n1_count, n2_count);
+    if (full) {
+      engine->stat_full++;
     }
     else {
+      engine->stat_incremental++;
+    }
+    _select_mpr(engine, covered);
+    engine->valid = true;
+  }
+  else {
+    OONF_DEBUG(LOG_MPR, "Neighbor graph unchanged, keep MPR selection");
+    engine->stat_unchanged++;
+  }
 
-      /* check if an intermediate hop would reduce the path cost */
-      avl_for_each_element(&graph->set_n1, x_node, _avl_node) {
-        if (graph->methods->calculate_d_x_y(domain, graph, x_node, y_node) < d1_y) {
-          add_to_n = true;
-          break;
-        }
+  /* copy result into neighbor graph */
+  for (i=0; i<n2_count; i++) {
+    if (bitset_get(engine->set_n, i)) {
+      mpr_add_addr_node_to_set(&graph->set_n,
+          n2_nodes[i]->addr, n2_nodes[i]->table_offset);
+    }
+  }
+  for (i=0; i<n1_count; i++) {
+    if (bitset_get(engine->mpr, i)) {
+      n1 = mpr_add_n1_node_to_set(&graph->set_mpr, n1_nodes[i]->neigh,
+          n1_nodes[i]->link, n1_nodes[i]->table_offset);
+      if (n1 != NULL) {
+        n1->snapshot_idx = n1_nodes[i]->snapshot_idx;
       }
     }
-
-    if (add_to_n) {
-      mpr_add_addr_node_to_set(&graph->set_n, y_node->addr, y_node->table_offset);
+    if (bitset_get(engine->selected, i)) {
+      n1_nodes[i]->neigh->selection_is_mpr = true;
     }
   }
+
+  /* TODO Optional optimization step */
+
+calculate_mpr_cleanup:
+  free(n1_nodes);
+  free(n2_nodes);
+  free(row);
+  free(dirty);
+  free(covered);
 }
 
 /**
- * Calculate R(x,M)
- * 
- * For an element x in N1, the number of elements y in N for which
- * d(x,y) is defined and has minimal value among the d(z,y) for all 
- * z in N1, and no such minimal values have z in M.
- * 
- * TODO Clean up code
- * @param domain NHDP domain
- * @param graph neighbor graph instance
- * @param x_node node X
- * @return see RFC
+ * Reallocate the arrays of a MPR engine for a new size of N1 and N2
+ * @param engine MPR engine
+ * @param n1_count number of N1 nodes
+ * @param n2_count number of N2 nodes
+ * @return -1 if an error happened, 0 otherwise
  */
-static unsigned int
-_calculate_r(const struct nhdp_domain *domain, struct neighbor_graph *graph,
-    struct n1_node *x_node) {
-  struct addr_node *y_node;
-  struct n1_node *z_node;
-  uint32_t r, d_x_y, min_d_z_y;
-  bool already_covered;
-#ifdef OONF_LOG_DEBUG_INFO
-  struct netaddr_str nbuf1, nbuf2, nbuf3;
-#endif
-
-  OONF_DEBUG(LOG_MPR, "Calculate R of N1 member %s",
-      netaddr_to_string(&nbuf1, &x_node->addr));
-
-  /* if x is an MPR node already, we know the result must be 0 */
-  if (x_node->neigh->selection_is_mpr) {
-    OONF_DEBUG(LOG_MPR, "X is an MPR node already, return 0");
-    return 0;
+static int
+_resize_engine(struct mpr_rfc7181_engine *engine,
+    uint32_t n1_count, uint32_t n2_count) {
+  size_t i;
+
+  mpr_rfc7181_engine_clear(engine);
+
+  engine->n1_count = n1_count;
+  engine->n2_count = n2_count;
+  engine->n1_words = BITSET_WORDS(n1_count);
+  engine->n2_words = BITSET_WORDS(n2_count);
+
+  /* calloc(0) might return NULL, so allocate at least one element */
+  engine->n1_addr = calloc(n1_count + 1, sizeof(*engine->n1_addr));
+  engine->n2_addr = calloc(n2_count + 1, sizeof(*engine->n2_addr));
+  engine->willingness = calloc(n1_count + 1, sizeof(*engine->willingness));
+  engine->d1_y = calloc(n2_count + 1, sizeof(*engine->d1_y));
+  engine->d_x_y = calloc((size_t)n1_count * n2_count + 1, sizeof(*engine->d_x_y));
+  engine->min_d_y = calloc(n2_count + 1, sizeof(*engine->min_d_y));
+  engine->set_n = calloc(engine->n2_words + 1, sizeof(*engine->set_n));
+  engine->minimal = calloc(n1_count * engine->n2_words + 1, sizeof(*engine->minimal));
+  engine->reachable = calloc(n2_count * engine->n1_words + 1, sizeof(*engine->reachable));
+  engine->mpr = calloc(engine->n1_words + 1, sizeof(*engine->mpr));
+  engine->selected = calloc(engine->n1_words + 1, sizeof(*engine->selected));
+
+  if (!engine->n1_addr || !engine->n2_addr || !engine->willingness
+      || !engine->d1_y || !engine->d_x_y || !engine->min_d_y
+      || !engine->set_n || !engine->minimal || !engine->reachable
+      || !engine->mpr || !engine->selected) {
+    return -1;
   }
 
-  r = 0;
-
-  avl_for_each_element(&graph->set_n, y_node, _avl_node) {
-    OONF_DEBUG(LOG_MPR, "-> Check y_node = %s", 
-               netaddr_to_string(&nbuf1, &y_node->addr));
-    /* calculate the cost to reach y through x */
-    d_x_y = graph->methods->calculate_d_x_y(domain, graph, x_node, y_node);
-
-    /* calculate the minimum cost to reach y through any node from N1 */
-    min_d_z_y = mpr_calculate_minimal_d_z_y(domain, graph, y_node);
+  for (i=0; i<(size_t)n1_count * n2_count; i++) {
+    engine->d_x_y[i] = RFC7181_METRIC_INFINITE_PATH;
+  }
+  for (i=0; i<n2_count; i++) {
+    engine->d1_y[i] = RFC7181_METRIC_INFINITE;
+  }
+  return 0;
+}
 
-    OONF_DEBUG(LOG_MPR, "d_x_y(%s, %s) = %u, min_d_z_y(%s) = %u", netaddr_to_string(&nbuf1, &x_node->addr),
-               netaddr_to_string(&nbuf2, &y_node->addr), d_x_y,
-               netaddr_to_string(&nbuf3, &y_node->addr), min_d_z_y);
+/**
+ * @param engine MPR engine
+ * @param n1 array of N1 nodes
+ * @param n1_count number of N1 nodes
+ * @param n2 array of N2 nodes
+ * @param n2_count number of N2 nodes
+ * @return true if N1 and N2 are the same as in the last calculation
+ */
+static bool
+_is_same_graph(struct mpr_rfc7181_engine *engine,
+    struct n1_node **n1, uint32_t n1_count,
+    struct addr_node **n2, uint32_t n2_count) {
+  uint32_t i;
+
+  if (engine->n1_addr == NULL || engine->n2_addr == NULL
+      || engine->n1_count != n1_count || engine->n2_count != n2_count) {
+    return false;
+  }
 
-    if (d_x_y > min_d_z_y) {
-      continue;
+  for (i=0; i<engine->n1_count; i++) {
+    if (netaddr_cmp(&engine->n1_addr[i], &n1[i]->addr) != 0) {
+      return false;
     }
+  }
+  for (i=0; i<engine->n2_count; i++) {
+    if (netaddr_cmp(&engine->n2_addr[i], &n2[i]->addr) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
 
-    /* check if y is already covered by a minimum-cost node */
-    already_covered = false;
-
-    avl_for_each_element(&graph->set_n1, z_node, _avl_node) {
-      if (graph->methods->calculate_d_x_y(domain, graph, z_node, y_node) == min_d_z_y
-          && z_node->neigh->selection_is_mpr) {
-        OONF_DEBUG(LOG_MPR, "Nope, %s is already covered by %s",
-                   netaddr_to_string(&nbuf1, &y_node->addr),
-                   netaddr_to_string(&nbuf2, &z_node->addr));
-        already_covered = true;
-        break;
-      }
+/**
+ * Lookup a N2 node by address
+ * @param engine MPR engine
+ * @param n2 array of N2 nodes, sorted by address
+ * @param addr network address
+ * @return index of N2 node, -1 if not found
+ */
+static int32_t
+_find_n2(struct mpr_rfc7181_engine *engine,
+    struct addr_node **n2, const struct netaddr *addr) {
+  uint32_t left, right, middle;
+  int result;
+
+  left = 0;
+  right = engine->n2_count;
+  while (left < right) {
+    middle = left + (right - left) / 2;
+    result = netaddr_cmp(&n2[middle]->addr, addr);
+    if (result == 0) {
+      return (int32_t)middle;
     }
-    if (already_covered) {
-      continue;
+    if (result < 0) {
+      left = middle + 1;
+    }
+    else {
+      right = middle;
     }
-
-    r++;
   }
-
-  OONF_DEBUG(LOG_MPR, "Finished calculating R(x, M), result %u", r);
-
-  return r;
+  return -1;
 }
 
 /**
- * Add all elements x in N1 that have W(x) = WILL_ALWAYS to M.
+ * Calculate d(x,y) for all 2-hop tuples of a link
+ * @param engine MPR engine
  * @param domain NHDP domain
  * @param graph neighbor graph instance
+ * @param x N1 node
+ * @param n2 array of N2 nodes
+ * @param link_idx index of the link of the N1 node in the snapshot
+ * @param row array of d(x,y) values, indexed by N2 index
  */
 static void
-_process_will_always(const struct nhdp_domain *domain, struct neighbor_graph *graph) {
-  struct n1_node *current_n1_node;
-#ifdef OONF_LOG_DEBUG_INFO
-  struct netaddr_str buf1;
-#endif
-  
-  OONF_DEBUG(LOG_MPR, "Process WILL_ALWAYS");
-
-  avl_for_each_element(&graph->set_n1, current_n1_node, _avl_node) {
-    if (graph->methods->get_willingness_n1(domain, current_n1_node)
-        == RFC7181_WILLINGNESS_ALWAYS) {
-      OONF_DEBUG(LOG_MPR, "Add neighbor %s with WILL_ALWAYS to the MPR set",
-          netaddr_to_string(&buf1, &current_n1_node->addr));
-      mpr_add_n1_node_to_set(&graph->set_mpr,
-          current_n1_node->link->neigh,
-          current_n1_node->link, current_n1_node->table_offset);
+_fill_row_from_link(struct mpr_rfc7181_engine *engine,
+    const struct nhdp_domain *domain, struct neighbor_graph *graph,
+    struct n1_node *x, struct addr_node **n2, uint32_t link_idx, uint32_t *row) {
+  const struct mpr_snapshot_link *lnk;
+  uint32_t t;
+  int32_t y_idx;
+
+  lnk = &graph->snapshot->links[link_idx];
+  for (t=lnk->twohop_start; t<lnk->twohop_start + lnk->twohop_count; t++) {
+    y_idx = _find_n2(engine, n2, &graph->snapshot->twohops[t]);
+    if (y_idx >= 0) {
+      row[y_idx] = graph->methods->calculate_d_x_y(domain, graph, x, n2[y_idx]);
     }
   }
 }
 
 /**
- * For each element y in N for which there is only one element
- * x in N1 such that d2(x,y) is defined, add that element x to M.
+ * Read willingness, d(x,y) and d1(y) from the neighbor graph into
+ * the MPR engine. Only the existing 2-hop tuples and neighbor addresses
+ * are looked up, all other values are undefined.
+ * @param engine MPR engine
  * @param domain NHDP domain
  * @param graph neighbor graph instance
+ * @param n1 array of N1 nodes
+ * @param n2 array of N2 nodes
+ * @param dirty bitset over N2, will be set for all changed columns
+ * @param row temporary array for a row of d(x,y)
+ * @return true if the willingness of a N1 node changed
  */
-static void
-_process_unique_mprs(const struct nhdp_domain *domain, struct neighbor_graph *graph) {
-  struct n1_node *node_n1, *possible_mpr_node;
-  struct addr_node *node_n;
-  uint32_t possible_mprs;
-#ifdef OONF_LOG_DEBUG_INFO
-  struct netaddr_str buf1;
-#endif
-  
-  OONF_DEBUG(LOG_MPR, "Process unique MPRs");
-
-  avl_for_each_element(&graph->set_n, node_n, _avl_node) {
-    /* iterate over N1 to determine the number of possible MPRs */
-    possible_mprs = 0;
-    possible_mpr_node = NULL;
+static bool
+_update_input(struct mpr_rfc7181_engine *engine,
+    const struct nhdp_domain *domain, struct neighbor_graph *graph,
+    struct n1_node **n1, struct addr_node **n2, uint64_t *dirty, uint32_t *row) {
+  const struct mpr_neighbor_snapshot *snapshot;
+  const struct mpr_snapshot_neighbor *neigh;
+  uint32_t *d_row;
+  uint32_t x_idx, y_idx, value, i;
+  int32_t found;
+  bool changed;
+
+  snapshot = graph->snapshot;
+  changed = false;
+  for (x_idx=0; x_idx<engine->n1_count; x_idx++) {
+    value = graph->methods->get_willingness_n1(domain, n1[x_idx]);
+    if (value != engine->willingness[x_idx]) {
+      engine->willingness[x_idx] = value;
+      changed = true;
+    }
 
-    avl_for_each_element(&graph->set_n1, node_n1, _avl_node) {
-      if (graph->methods->calculate_d2_x_y(domain, node_n1, node_n)
-          <= RFC7181_METRIC_MAX) {
-        /* d2(x,y) is defined for this link, so this is a possible MPR node */
-        possible_mprs++; // TODO Break outer loop when this becomes > 1
-        possible_mpr_node = node_n1;
+    for (y_idx=0; y_idx<engine->n2_count; y_idx++) {
+      row[y_idx] = RFC7181_METRIC_INFINITE_PATH;
+    }
+
+    /* flooding graphs use a single link, routing graphs all links of the neighbor */
+    if (n1[x_idx]->link) {
+      _fill_row_from_link(engine, domain, graph, n1[x_idx], n2,
+          n1[x_idx]->snapshot_idx, row);
+    }
+    else {
+      neigh = &snapshot->neighbors[n1[x_idx]->snapshot_idx];
+      for (i=neigh->link_start; i<neigh->link_start + neigh->link_count; i++) {
+        _fill_row_from_link(engine, domain, graph, n1[x_idx], n2, i, row);
       }
     }
-    OONF_DEBUG(LOG_MPR, "Number of possible MPRs for N node %s is %u",
-        netaddr_to_string(&buf1, &node_n->addr),
-        possible_mprs);
-    assert(possible_mprs > 0);
-    if (possible_mprs == 1) {
-      /* There is only one possible MPR to cover this 2-hop neighbor, so this
-       * node must become an MPR. */
-      OONF_DEBUG(LOG_MPR, "Add required neighbor %s to the MPR set",
-          netaddr_to_string(&buf1, &possible_mpr_node->addr));
-      mpr_add_n1_node_to_set(&graph->set_mpr,
-          possible_mpr_node->neigh,
-          possible_mpr_node->link,
-          possible_mpr_node->table_offset);
-      possible_mpr_node->neigh->selection_is_mpr = true;
+
+    d_row = &engine->d_x_y[(size_t)x_idx * engine->n2_count];
+    for (y_idx=0; y_idx<engine->n2_count; y_idx++) {
+      if (d_row[y_idx] != row[y_idx]) {
+        d_row[y_idx] = row[y_idx];
+        bitset_set(dirty, y_idx);
+      }
     }
   }
+
+  /* d1(y) is defined for the addresses of N1 neighbors */
+  for (y_idx=0; y_idx<engine->n2_count; y_idx++) {
+    row[y_idx] = RFC7181_METRIC_INFINITE;
+  }
+  for (x_idx=0; x_idx<engine->n1_count; x_idx++) {
+    if (n1[x_idx]->link) {
+      neigh = &snapshot->neighbors[snapshot->links[n1[x_idx]->snapshot_idx].neigh_idx];
+    }
+    else {
+      neigh = &snapshot->neighbors[n1[x_idx]->snapshot_idx];
+    }
+
+    for (i=neigh->addr_start; i<neigh->addr_start + neigh->addr_count; i++) {
+      found = _find_n2(engine, n2, &snapshot->addresses[i]);
+      if (found >= 0) {
+        row[found] = graph->methods->calculate_d1_x_of_n2_addr(domain, graph, n2[found]);
+      }
+    }
+  }
+  for (y_idx=0; y_idx<engine->n2_count; y_idx++) {
+    if (engine->d1_y[y_idx] != row[y_idx]) {
+      engine->d1_y[y_idx] = row[y_idx];
+      bitset_set(dirty, y_idx);
+    }
+  }
+  return changed;
 }
 
 /**
- * Selects a subset of nodes from N1 which are maximum 
- * regarding a given property.
- * @param domain NHDP domain for MPR calculation
- * @param graph neighbor graph instance
- * @param get_property callback for querying neighbor graph data
+ * Recalculate N, minimal d(z,y) and the coverage bitsets
+ * for all changed N2 nodes
+ * @param engine MPR engine
+ * @param dirty bitset over N2 with the changed columns
  */
 static void
-_select_greatest_by_property(const struct nhdp_domain *domain,
-    struct neighbor_graph *graph,
-    uint32_t(*get_property)(const struct nhdp_domain *, struct neighbor_graph*, struct n1_node*)) {
-  struct avl_tree *n1_subset, tmp_candidate_subset;
-  struct n1_node *node_n1,
-      *greatest_prop_node;
-  uint32_t current_prop,
-      greatest_prop,
-      number_of_greatest;
-
-  OONF_DEBUG(LOG_MPR, "Select node with greatest property");
-
-  greatest_prop_node = NULL;
-  current_prop = greatest_prop = number_of_greatest = 0;
-
-  avl_init(&tmp_candidate_subset, avl_comp_netaddr, false);
-
-//  if (graph->set_mpr_candidates.count > 0) {
-//    /* We already have MPR candidates, so we need to select from these
-//     * (these may have resulted from a previous call to this function). */
-//    n1_subset = &graph->set_mpr_candidates;
-//  }
-//  else {
-    /* all N1 nodes are potential MPRs */
-    n1_subset = &graph->set_n1;
-//  }
+_update_columns(struct mpr_rfc7181_engine *engine, uint64_t *dirty) {
+  uint64_t *reachable;
+  uint32_t x_idx, y_idx, d, min_d;
+  bool in_n;
+
+  for (y_idx=0; y_idx<engine->n2_count; y_idx++) {
+    if (!bitset_get(dirty, y_idx)) {
+      continue;
+    }
+
+    /* calculate the minimum cost to reach y through any node from N1 */
+    min_d = RFC7181_METRIC_INFINITE_PATH;
+    for (x_idx=0; x_idx<engine->n1_count; x_idx++) {
+      d = engine->d_x_y[(size_t)x_idx * engine->n2_count + y_idx];
+      if (d < min_d) {
+        min_d = d;
+      }
+    }
+    engine->min_d_y[y_idx] = min_d;
 
     /*
-     * Workaround for performance issues; function requires a rewrite!
+     * y is part of N if it cannot be reached directly or if an
+     * intermediate hop would reduce the path cost
      */
-  avl_for_each_element(n1_subset, node_n1, _avl_node) {
-    current_prop = get_property(domain, graph, node_n1);
-    if (current_prop > 0) {
-      if (greatest_prop_node == NULL
-          || current_prop > greatest_prop) {
-        greatest_prop = current_prop;
-        greatest_prop_node = node_n1;
-        number_of_greatest = 1;
-
-        /* we have a unique candidate */
-        mpr_clear_n1_set(&tmp_candidate_subset);
-        mpr_add_n1_node_to_set(&tmp_candidate_subset, node_n1->neigh,
-            node_n1->link, node_n1->table_offset);
+    in_n = engine->d1_y[y_idx] == RFC7181_METRIC_INFINITE
+        || min_d < engine->d1_y[y_idx];
+    if (in_n) {
+      bitset_set(engine->set_n, y_idx);
+    }
+    else {
+      bitset_reset(engine->set_n, y_idx);
+    }
+
+    reachable = &engine->reachable[y_idx * engine->n1_words];
+    bitset_clear(reachable, engine->n1_words);
+
+    for (x_idx=0; x_idx<engine->n1_count; x_idx++) {
+      d = engine->d_x_y[(size_t)x_idx * engine->n2_count + y_idx];
+
+      /* d(x,y) is defined if d2(x,y) is defined, d1(x) is defined for all of N1 */
+      if (d < RFC7181_METRIC_INFINITE_PATH) {
+        bitset_set(reachable, x_idx);
+      }
+
+      if (in_n && d == min_d) {
+        bitset_set(&engine->minimal[x_idx * engine->n2_words], y_idx);
       }
-      else if (current_prop == greatest_prop) {
-        /* add node to candidate subset */
-        number_of_greatest++;
-        mpr_add_n1_node_to_set(&tmp_candidate_subset, node_n1->neigh,
-            node_n1->link, node_n1->table_offset);
+      else {
+        bitset_reset(&engine->minimal[x_idx * engine->n2_words], y_idx);
       }
     }
   }
+}
 
-  /* write updated candidate subset */
-  mpr_clear_n1_set(&graph->set_mpr_candidates);
+/**
+ * Select the MPR set according to RFC 7181 Appendix B
+ * @param engine MPR engine
+ * @param covered temporary bitset over N2
+ */
+static void
+_select_mpr(struct mpr_rfc7181_engine *engine, uint64_t *covered) {
+  uint64_t *reachable;
+  uint32_t x_idx, y_idx, r, greatest_r;
+  int32_t best;
+
+  bitset_clear(engine->mpr, engine->n1_words);
+  bitset_clear(engine->selected, engine->n1_words);
+  bitset_clear(covered, engine->n2_words);
+
+  /* Add all elements x in N1 that have W(x) = WILL_ALWAYS to M. */
+  for (x_idx=0; x_idx<engine->n1_count; x_idx++) {
+    if (engine->willingness[x_idx] == RFC7181_WILLINGNESS_ALWAYS) {
+      OONF_DEBUG(LOG_MPR, "Add N1 node %u with WILL_ALWAYS to the MPR set", x_idx);
+      bitset_set(engine->mpr, x_idx);
+    }
+  }
 
-  avl_for_each_element(&tmp_candidate_subset, node_n1, _avl_node) {
-    mpr_add_n1_node_to_set(&graph->set_mpr_candidates, node_n1->neigh,
-        node_n1->link, node_n1->table_offset);
+  /*
+   * For each element y in N for which there is only one element
+   * x in N1 such that d2(x,y) is defined (D(y) = 1), add that element x to M.
+   */
+  for (y_idx=0; y_idx<engine->n2_count; y_idx++) {
+    if (!bitset_get(engine->set_n, y_idx)) {
+      continue;
+    }
+
+    reachable = &engine->reachable[y_idx * engine->n1_words];
+    assert(bitset_count(reachable, engine->n1_words) > 0);
+    if (bitset_count(reachable, engine->n1_words) == 1) {
+      best = bitset_get_first(reachable, engine->n1_words);
+      OONF_DEBUG(LOG_MPR, "Add required N1 node %d to the MPR set", best);
+      bitset_set(engine->mpr, best);
+      bitset_set(engine->selected, best);
+    }
   }
 
-  /* free temporary candidate subset */
-  mpr_clear_n1_set(&tmp_candidate_subset);
-}
+  /* y is covered if a selected MPR has minimal d(x,y) */
+  for (x_idx=0; x_idx<engine->n1_count; x_idx++) {
+    if (bitset_get(engine->selected, x_idx)) {
+      bitset_or(covered, &engine->minimal[x_idx * engine->n2_words], engine->n2_words);
+    }
+  }
+
+  /*
+   * While there exists any element x in N1 with R(x, M) > 0, add the
+   * first element with the greatest R(x, M) to M.
+   */
+  while (true) {
+    best = -1;
+    greatest_r = 0;
+
+    for (x_idx=0; x_idx<engine->n1_count; x_idx++) {
+      if (bitset_get(engine->selected, x_idx)) {
+        /* if x is an MPR node already, R(x,M) is 0 */
+        continue;
+      }
 
-// FIXME Wrapper required for having the correct signature...
+      r = bitset_count_andnot(&engine->minimal[x_idx * engine->n2_words],
+          covered, engine->n2_words);
+      if (r > greatest_r) {
+        greatest_r = r;
+        best = x_idx;
+      }
+    }
+
+    if (best < 0) {
+      OONF_DEBUG(LOG_MPR, "No more candidates, we are done!");
+      return;
+    }
 
-//static uint32_t
-//_get_willingness_n1(const struct nhdp_domain *domain,
-//    struct neighbor_graph *graph, struct n1_node *node) {
-//  return graph->methods->get_willingness_n1(domain, node);
-//}
+    OONF_DEBUG(LOG_MPR, "Select N1 node %d with R(x,M) = %u", best, greatest_r);
+    bitset_set(engine->mpr, best);
+    bitset_set(engine->selected, best);
+    bitset_or(covered, &engine->minimal[best * engine->n2_words], engine->n2_words);
+  }
+}
 
 /**
- * While there exists any element x in N1 with R(x, M) > 0...
+ * Calculate R(x,M) without the MPR engine
+ *
+ * For an element x in N1, the number of elements y in N for which
+ * d(x,y) is defined and has minimal value among the d(z,y) for all
+ * z in N1, and no such minimal values have z in M.
  * @param domain NHDP domain
  * @param graph neighbor graph instance
+ * @param x_node node X
+ * @return R(x,M)
  */
-static void
-_process_remaining(const struct nhdp_domain *domain, struct neighbor_graph *graph) {
-  struct n1_node *node_n1;
-  bool done;
-
-#ifdef OONF_LOG_DEBUG_INFO
-  struct netaddr_str buf1;
-#endif
-  
-  OONF_DEBUG(LOG_MPR, "Process remaining");
-  
-  done = false;
-  while (!done) {
-    /* select node(s) by willingness */
-//    OONF_DEBUG(LOG_MPR, "Select by greatest willingness");
-//    _select_greatest_by_property(domain, graph,
-//        &_get_willingness_n1);
-
-    /* select node(s) by coverage */
-//    if (graph->set_mpr_candidates.count > 1) {
-      OONF_DEBUG(LOG_MPR, "Select by greatest coverage");
-//                 graph->set_mpr_candidates.count);
-      _select_greatest_by_property(domain, graph,
-          &_calculate_r);
-//    }
-
-    /* TODO More tie-breaking methods might be added here 
-     * Ideas from draft 19:
-     *  - D(X)
-     *  - Information freshness
-     *  - Duration of previous MPR selection...
-     */
+static uint32_t
+_calculate_r_avl(const struct nhdp_domain *domain, struct neighbor_graph *graph,
+    struct n1_node *x_node) {
+  struct addr_node *y_node;
+  struct n1_node *z_node;
+  uint32_t r, d_x_y, min_d_z_y;
+  bool already_covered;
 
-    if (graph->set_mpr_candidates.count == 0) {
-      /* no potential MPRs; we are done */
-      OONF_DEBUG(LOG_MPR, "No more candidates, we are done!");
-      done = true;
-    }
-    else if (graph->set_mpr_candidates.count == 1) {
-      /* a unique candidate was found */
-      node_n1 = avl_first_element(&graph->set_mpr_candidates,
-          node_n1, _avl_node);
-      OONF_DEBUG(LOG_MPR, "Unique candidate %s",
-                 netaddr_to_string(&buf1, &node_n1->addr));
-      mpr_add_n1_node_to_set(&graph->set_mpr, node_n1->neigh, node_n1->link, node_n1->table_offset);
-      node_n1->neigh->selection_is_mpr = true;
-      avl_remove(&graph->set_mpr_candidates, &node_n1->_avl_node);
-      free(node_n1);
-//      done = true;
+  /* if x is an MPR node already, we know the result must be 0 */
+  if (x_node->neigh->selection_is_mpr) {
+    return 0;
+  }
+
+  r = 0;
+  avl_for_each_element(&graph->set_n, y_node, _avl_node) {
+    /* calculate the cost to reach y through x */
+    d_x_y = graph->methods->calculate_d_x_y(domain, graph, x_node, y_node);
+
+    /* calculate the minimum cost to reach y through any node from N1 */
+    min_d_z_y = mpr_calculate_minimal_d_z_y(domain, graph, y_node);
+    if (d_x_y > min_d_z_y) {
+      continue;
     }
-    else {
-      /* Multiple candidates were found; arbitrarily add one of the 
-       * candidate nodes (first in list). */
-      node_n1 = avl_first_element(&graph->set_mpr_candidates,
-          node_n1, _avl_node);
-      OONF_DEBUG(LOG_MPR, "Multiple candidates, select %s",
-                 netaddr_to_string(&buf1, &node_n1->addr));
-      mpr_add_n1_node_to_set(&graph->set_mpr, node_n1->neigh, node_n1->link, node_n1->table_offset);
-      node_n1->neigh->selection_is_mpr = true;
-      avl_remove(&graph->set_mpr_candidates, &node_n1->_avl_node);
-      free(node_n1);
+
+    /* check if y is already covered by a minimum-cost node */
+    already_covered = false;
+    avl_for_each_element(&graph->set_n1, z_node, _avl_node) {
+      if (z_node->neigh->selection_is_mpr
+          && graph->methods->calculate_d_x_y(domain, graph, z_node, y_node) == min_d_z_y) {
+        already_covered = true;
+        break;
+      }
+    }
+    if (!already_covered) {
+      r++;
     }
   }
+  return r;
 }
 
 /**
- * Calculate MPR
+ * Select the MPR set according to RFC 7181 Appendix B directly on
+ * the AVL trees of the neighbor graph. This needs no memory beyond
+ * the d(x,y) cache of the graph, but takes O(N1^2 * N2) per round.
  * @param domain NHDP domain
- * @param graph neighbor graph instance
+ * @param graph neighbor graph instance with initialized table offsets
  */
-void
-mpr_calculate_mpr_rfc7181(const struct nhdp_domain *domain, struct neighbor_graph *graph) {
-  struct n1_node *n1;
-  struct addr_node *n2;
-  uint32_t n1_count, n2_count, i;
-  
-  OONF_DEBUG(LOG_MPR, "Calculate MPR set");
-  
-  n1_count = graph->set_n1.count;
-  n2_count = graph->set_n2.count;
+static void
+_calculate_mpr_avl(const struct nhdp_domain *domain, struct neighbor_graph *graph) {
+  struct n1_node *x_node, *best;
+  struct addr_node *y_node;
+  uint32_t d1_y, possible_mprs, r, greatest_r;
+  bool add_to_n;
 
-  graph->d_x_y_cache = calloc(n1_count * n2_count, sizeof(uint32_t));
-  
-  i=0;
-  avl_for_each_element(&graph->set_n1, n1, _avl_node) {
-    n1->table_offset = i;
-    i++;
+  /* calculate N */
+  avl_for_each_element(&graph->set_n2, y_node, _avl_node) {
+    /* if y cannot be reached directly, it must be added to N */
+    d1_y = graph->methods->calculate_d1_x_of_n2_addr(domain, graph, y_node);
+    add_to_n = d1_y == RFC7181_METRIC_INFINITE;
+
+    /* check if an intermediate hop would reduce the path cost */
+    avl_for_each_element(&graph->set_n1, x_node, _avl_node) {
+      if (add_to_n) {
+        break;
+      }
+      add_to_n = graph->methods->calculate_d_x_y(domain, graph, x_node, y_node) < d1_y;
+    }
+
+    if (add_to_n) {
+      mpr_add_addr_node_to_set(&graph->set_n, y_node->addr, y_node->table_offset);
+    }
   }
-  
-  i=0;
-  avl_for_each_element(&graph->set_n2, n2, _avl_node) {
-    n2->table_offset = i;
-    i += n1_count;
+
+  /* Add all elements x in N1 that have W(x) = WILL_ALWAYS to M. */
+  avl_for_each_element(&graph->set_n1, x_node, _avl_node) {
+    if (graph->methods->get_willingness_n1(domain, x_node) == RFC7181_WILLINGNESS_ALWAYS) {
+      mpr_add_n1_node_to_set(&graph->set_mpr, x_node->neigh,
+          x_node->link, x_node->table_offset);
+    }
+  }
+
+  /*
+   * For each element y in N for which there is only one element
+   * x in N1 such that d2(x,y) is defined, add that element x to M.
+   */
+  avl_for_each_element(&graph->set_n, y_node, _avl_node) {
+    possible_mprs = 0;
+    best = NULL;
+
+    avl_for_each_element(&graph->set_n1, x_node, _avl_node) {
+      if (graph->methods->calculate_d2_x_y(domain, graph, x_node, y_node)
+          <= RFC7181_METRIC_MAX) {
+        possible_mprs++;
+        best = x_node;
+      }
+    }
+    if (possible_mprs == 1) {
+      mpr_add_n1_node_to_set(&graph->set_mpr, best->neigh,
+          best->link, best->table_offset);
+      best->neigh->selection_is_mpr = true;
+    }
   }
 
-  _calculate_n(domain, graph);
-  
-  _process_will_always(domain, graph);
-  _process_unique_mprs(domain, graph);
-  _process_remaining(domain, graph);
+  /*
+   * While there exists any element x in N1 with R(x, M) > 0, add the
+   * first element with the greatest R(x, M) to M.
+   */
+  while (true) {
+    best = NULL;
+    greatest_r = 0;
+
+    avl_for_each_element(&graph->set_n1, x_node, _avl_node) {
+      r = _calculate_r_avl(domain, graph, x_node);
+      if (r > greatest_r) {
+        greatest_r = r;
+        best = x_node;
+      }
+    }
 
-  /* TODO Optional optimization step */
+    if (best == NULL) {
+      return;
+    }
+
+    mpr_add_n1_node_to_set(&graph->set_mpr, best->neigh,
+        best->link, best->table_offset);
+    best->neigh->selection_is_mpr = true;
+  }
 }
@@ -46,10 +46,96 @@
 #ifndef __SELECTION_RFC7181__
 #define __SELECTION_RFC7181__
 
+#include "common/netaddr.h"
 #include "nhdp/nhdp_domain.h"
 
 #include "neighbor-graph.h"
 
-void mpr_calculate_mpr_rfc7181(const struct nhdp_domain *, struct neighbor_graph *graph);
+#ifndef MPR_RFC7181_ENGINE_MAX_CELLS
+/**
+ * Maximum size of N1 x N2 handled by the MPR engine. The engine keeps
+ * a d(x,y) matrix of this many 32 bit values (256 kByte) and bitsets
+ * of about the same number of bits for each routing domain and each
+ * NHDP interface between two calculations. Larger neighbor graphs are
+ * calculated with the AVL based selection, which keeps no state.
+ */
+#define MPR_RFC7181_ENGINE_MAX_CELLS 65536
+#endif
+
+/**
+ * State of the MPR selection of one neighbor graph (a routing domain
+ * or the flooding MPRs of an interface). N1 and N2 are mapped to dense
+ * indices (the order of the AVL trees of the neighbor graph), coverage
+ * is stored as bitsets so R(x,M) and D(y) are popcount operations.
+ * The state is kept between two calculations, so only the columns
+ * of the matrices touched by a changed link or 2-hop tuple have to
+ * be recalculated and an unchanged graph does not need a new selection.
+ * A node joining or leaving N1 or N2 rebuilds the whole state.
+ */
+struct mpr_rfc7181_engine {
+  /*! number of nodes in N1 */
+  uint32_t n1_count;
+
+  /*! number of nodes in N2 */
+  uint32_t n2_count;
+
+  /*! length of a bitset over N1 in words */
+  size_t n1_words;
+
+  /*! length of a bitset over N2 in words */
+  size_t n2_words;
+
+  /*! addresses of the N1 nodes */
+  struct netaddr *n1_addr;
+
+  /*! addresses of the N2 nodes */
+  struct netaddr *n2_addr;
+
+  /*! willingness of each N1 node */
+  uint32_t *willingness;
+
+  /*! d1(y) of each N2 node */
+  uint32_t *d1_y;
+
+  /*! d(x,y), one row of n2_count values for each N1 node */
+  uint32_t *d_x_y;
+
+  /*! minimal d(z,y) over all z in N1 for each N2 node */
+  uint32_t *min_d_y;
+
+  /*! bitset over N2, all members of N */
+  uint64_t *set_n;
+
+  /*! one bitset over N2 for each N1 node, y in N with minimal d(x,y) */
+  uint64_t *minimal;
+
+  /*! one bitset over N1 for each N2 node, x with defined d2(x,y) */
+  uint64_t *reachable;
+
+  /*! bitset over N1, MPR set M of the last selection */
+  uint64_t *mpr;
+
+  /*! bitset over N1, nodes of M selected because of their coverage */
+  uint64_t *selected;
+
+  /*! true if the MPR set matches the stored graph */
+  bool valid;
+
+  /*! number of calculations that had to rebuild the whole state */
+  uint32_t stat_full;
+
+  /*! number of calculations that updated only changed columns */
+  uint32_t stat_incremental;
+
+  /*! number of calculations that reused the last selection */
+  uint32_t stat_unchanged;
+
+  /*! number of calculations of graphs too large for the engine */
+  uint32_t stat_too_large;
+};
+
+void mpr_calculate_mpr_rfc7181(const struct nhdp_domain *, struct neighbor_graph *graph,
+    struct mpr_rfc7181_engine *engine);
+void mpr_rfc7181_engine_clear(struct mpr_rfc7181_engine *engine);
 
 #endif
@@ -70,6 +70,13 @@ static void _cb_link_symtime(struct oonf_timer_instance *);
 static void _cb_l2hop_vtime(struct oonf_timer_instance *);
 static void _cb_naddr_vtime(struct oonf_timer_instance *);
 
+static const char *_cb_link_to_keystring(struct oonf_objectkey_str *,
+    struct oonf_class *, void *);
+static const char *_cb_link_to_statestring(struct oonf_objectstate_str *,
+    struct oonf_class *, void *);
+static const char *_cb_neigh_to_statestring(struct oonf_objectstate_str *,
+    struct oonf_class *, void *);
+
 /* Link status names */
 static const char *_LINK_PENDING   = "pending";
 static const char *_LINK_HEARD     = "heard";
@@ -80,11 +87,14 @@ static const char *_LINK_LOST      = "lost";
 static struct oonf_class _neigh_info = {
   .name = NHDP_CLASS_NEIGHBOR,
   .size = sizeof(struct nhdp_neighbor),
+  .to_statestring = _cb_neigh_to_statestring,
 };
 
 static struct oonf_class _link_info = {
   .name = NHDP_CLASS_LINK,
   .size = sizeof(struct nhdp_link),
+  .to_keystring = _cb_link_to_keystring,
+  .to_statestring = _cb_link_to_statestring,
 };
 
 static struct oonf_class _laddr_info = {
@@ -133,6 +143,9 @@ static struct avl_tree _naddr_tree;
 /* list of neighbors */
 static struct list_entity _neigh_list;
 
+/* number of neighbors in the global neighbor list */
+static uint32_t _neigh_count;
+
 /* tree of neighbors with originator addresses */
 static struct avl_tree _neigh_originator_tree;
 
@@ -142,6 +155,9 @@ static struct list_entity _link_list;
 /* id that will be increased every times the symmetric neighbor set changes */
 static uint32_t _neighbor_set_id = 0;
 
+/* generation of neighbors, links and their metrics, never 0 */
+static uint64_t _generation = 1;
+
 /**
  * Initialize NHDP databases
  */
@@ -214,6 +230,8 @@ nhdp_db_neighbor_add(void) {
 
   /* hook into global neighbor list */
   list_add_tail(&_neigh_list, &neigh->_global_node);
+  _neigh_count++;
+  _generation++;
 
   /* initialize originator node */
   neigh->_originator_node.key = &neigh->originator;
@@ -280,8 +298,13 @@ nhdp_db_neighbor_remove(struct nhdp_neighbor *neigh) {
     nhdp_domain_delayed_mpr_recalculation(NULL, neigh);
   }
 
+  /* remove from pending metric recalculations */
+  nhdp_domain_remove_neighbor(neigh);
+
   /* remove from global list and free memory */
   list_remove(&neigh->_global_node);
+  _neigh_count--;
+  _generation++;
   oonf_class_free(&_neigh_info, neigh);
 }
 
@@ -383,6 +406,7 @@ nhdp_db_neighbor_addr_add(struct nhdp_neighbor *neigh,
   /* add to trees */
   avl_insert(&_naddr_tree, &naddr->_global_node);
   avl_insert(&neigh->_neigh_addresses, &naddr->_neigh_node);
+  _generation++;
 
   /* trigger event */
   oonf_class_event(&_naddr_info, naddr, OONF_OBJECT_ADDED);
@@ -402,6 +426,7 @@ nhdp_db_neighbor_addr_remove(struct nhdp_naddr *naddr) {
   /* remove from trees */
   avl_remove(&_naddr_tree, &naddr->_global_node);
   avl_remove(&naddr->neigh->_neigh_addresses, &naddr->_neigh_node);
+  _generation++;
 
   /* stop timer */
   oonf_timer_stop(&naddr->_lost_vtime);
@@ -425,6 +450,7 @@ nhdp_db_neighbor_addr_move(struct nhdp_neighbor *neigh, struct nhdp_naddr *naddr
 
   /* set new backlink */
   naddr->neigh = neigh;
+  _generation++;
 }
 
 /**
@@ -468,6 +494,7 @@ nhdp_db_neighbor_set_originator(struct nhdp_neighbor *neigh,
 
   /* copy originator address into neighbor */
   memcpy(&neigh->originator, originator, sizeof(*originator));
+  _generation++;
 
   if (netaddr_get_address_family(originator) != AF_UNSPEC) {
     /* add to tree if new originator is valid */
@@ -527,6 +554,25 @@ nhdp_db_neighbor_get_set_id(void) {
   return _neighbor_set_id;
 }
 
+/**
+ * The generation changes each time a neighbor, link, address,
+ * link status or metric of the NHDP database changes, so viewers
+ * can reuse their output as long as the generation stays the same.
+ * @return current NHDP generation
+ */
+uint64_t
+nhdp_db_get_generation(void) {
+  return _generation;
+}
+
+/**
+ * Mark the NHDP database as changed
+ */
+void
+nhdp_db_increment_generation(void) {
+  _generation++;
+}
+
 /**
  * Insert a new link into a nhdp neighbors database
  * @param neigh neighbor which will get the new link
@@ -551,6 +597,7 @@ nhdp_db_link_add(struct nhdp_neighbor *neigh, struct nhdp_interface *local_if) {
 
   /* hook into global list */
   list_add_tail(&_link_list, &lnk->_global_node);
+  _generation++;
 
   /* init local trees */
   avl_init(&lnk->_addresses, avl_comp_netaddr, false);
@@ -600,6 +647,7 @@ nhdp_db_link_set_unsymmetric(struct nhdp_link *lnk) {
 
   /* link status was changed */
   lnk->last_status_change = oonf_clock_getNow();
+  _generation++;
 
   /* trigger event */
   oonf_class_event(&_link_info, lnk, OONF_OBJECT_CHANGED);
@@ -644,8 +692,12 @@ nhdp_db_link_remove(struct nhdp_link *lnk) {
   nhdp_interface_remove_link(lnk);
   list_remove(&lnk->_neigh_node);
 
+  /* remove link from neighbor metrics */
+  nhdp_domain_remove_link(lnk);
+
   /* remove from global list */
   list_remove(&lnk->_global_node);
+  _generation++;
 
   /* free memory */
   oonf_class_free(&_link_info, lnk);
@@ -679,6 +731,7 @@ nhdp_db_link_addr_add(struct nhdp_link *lnk, const struct netaddr *addr) {
   avl_insert(&lnk->_addresses, &laddr->_link_node);
   avl_insert(&lnk->neigh->_link_addresses, &laddr->_neigh_node);
   nhdp_interface_add_laddr(laddr);
+  _generation++;
 
   /* trigger event */
   oonf_class_event(&_laddr_info, laddr, OONF_OBJECT_ADDED);
@@ -699,6 +752,7 @@ nhdp_db_link_addr_remove(struct nhdp_laddr *laddr) {
   nhdp_interface_remove_laddr(laddr);
   avl_remove(&laddr->link->_addresses, &laddr->_link_node);
   avl_remove(&laddr->link->neigh->_link_addresses, &laddr->_neigh_node);
+  _generation++;
 
   /* free memory */
   oonf_class_free(&_laddr_info, laddr);
@@ -726,6 +780,7 @@ nhdp_db_link_addr_move(struct nhdp_link *lnk, struct nhdp_laddr *laddr) {
   }
   /* set new backlink */
   laddr->link = lnk;
+  _generation++;
 }
 
 /**
@@ -758,6 +813,7 @@ nhdp_db_link_2hop_add(struct nhdp_link *lnk, const struct netaddr *addr) {
 
   /* add to interface tree */
   nhdp_interface_add_l2hop(lnk->local_if, l2hop);
+  _generation++;
 
   /* initialize metrics */
   nhdp_domain_init_l2hop(l2hop);
@@ -782,6 +838,7 @@ nhdp_db_link_2hop_remove(struct nhdp_l2hop *l2hop) {
 
   /* remove from interface tree */
   nhdp_interface_remove_l2hop(l2hop);
+  _generation++;
 
   /* stop validity timer */
   oonf_timer_stop(&l2hop->_vtime);
@@ -855,7 +912,8 @@ nhdp_db_link_update_status(struct nhdp_link *lnk) {
   if (old_status != lnk->status) {
     /* link status was changed */
     lnk->last_status_change = oonf_clock_getNow();
-    nhdp_domain_recalculate_metrics(NULL, lnk->neigh);
+    _generation++;
+    nhdp_domain_delayed_metric_recalculation(NULL, lnk->neigh);
     nhdp_domain_delayed_mpr_recalculation(NULL, lnk->neigh);
 
     /* trigger change event */
@@ -890,6 +948,14 @@ nhdp_db_get_neigh_list(void) {
   return &_neigh_list;
 }
 
+/**
+ * @return number of nhdp neighbors
+ */
+uint32_t
+nhdp_db_get_neigh_count(void) {
+  return _neigh_count;
+}
+
 /**
  * get global list of nhdp links
  * @return link list
@@ -1084,3 +1150,86 @@ _cb_l2hop_vtime(struct oonf_timer_instance *ptr) {
   OONF_DEBUG(LOG_NHDP, "2Hop vtime fired: 0x%0zx", (size_t)ptr);
   nhdp_db_link_2hop_remove(l2hop);
 }
+
+/**
+ * Keystring creator for nhdp links
+ * @param buf pointer to target buffer
+ * @param class nhdp link class
+ * @param ptr pointer to nhdp link
+ * @return pointer to target buffer
+ */
+static const char *
+_cb_link_to_keystring(struct oonf_objectkey_str *buf,
+    struct oonf_class *class __attribute__((unused)), void *ptr) {
+  struct nhdp_link *lnk = ptr;
+  struct netaddr_str nbuf;
+
+  snprintf(buf->buf, sizeof(*buf), "%s::%s",
+      nhdp_interface_get_name(lnk->local_if),
+      netaddr_to_string(&nbuf, &lnk->if_addr));
+  return buf->buf;
+}
+
+/**
+ * Statestring creator for nhdp links
+ * @param buf pointer to target buffer
+ * @param class nhdp link class
+ * @param ptr pointer to nhdp link
+ * @return pointer to target buffer
+ */
+static const char *
+_cb_link_to_statestring(struct oonf_objectstate_str *buf,
+    struct oonf_class *class __attribute__((unused)), void *ptr) {
+  struct nhdp_link_domaindata *linkdata;
+  struct nhdp_domain *domain;
+  struct nhdp_link *lnk = ptr;
+  char name[32];
+
+  buf->buf[0] = 0;
+  oonf_class_append_state(buf, "status", "%s", nhdp_db_link_status_to_string(lnk));
+  oonf_class_append_state(buf, "flooding_willingness", "%u", lnk->flooding_willingness);
+
+  list_for_each_element(nhdp_domain_get_list(), domain, _node) {
+    linkdata = nhdp_domain_get_linkdata(domain, lnk);
+
+    snprintf(name, sizeof(name), "metric_in_%u", domain->ext);
+    oonf_class_append_state(buf, name, "%u", linkdata->metric.in);
+    snprintf(name, sizeof(name), "metric_out_%u", domain->ext);
+    oonf_class_append_state(buf, name, "%u", linkdata->metric.out);
+  }
+  return buf->buf;
+}
+
+/**
+ * Statestring creator for nhdp neighbors
+ * @param buf pointer to target buffer
+ * @param class nhdp neighbor class
+ * @param ptr pointer to nhdp neighbor
+ * @return pointer to target buffer
+ */
+static const char *
+_cb_neigh_to_statestring(struct oonf_objectstate_str *buf,
+    struct oonf_class *class __attribute__((unused)), void *ptr) {
+  struct nhdp_neighbor_domaindata *neighdata;
+  struct nhdp_neighbor *neigh = ptr;
+  struct nhdp_domain *domain;
+  struct netaddr_str nbuf;
+  char name[32];
+
+  buf->buf[0] = 0;
+  oonf_class_append_state(buf, "originator", "%s",
+      netaddr_to_string(&nbuf, &neigh->originator));
+  oonf_class_append_state(buf, "symmetric", "%d", neigh->symmetric);
+
+  list_for_each_element(nhdp_domain_get_list(), domain, _node) {
+    neighdata = nhdp_domain_get_neighbordata(domain, neigh);
+
+    snprintf(name, sizeof(name), "metric_in_%u", domain->ext);
+    oonf_class_append_state(buf, name, "%u", neighdata->metric.in);
+    snprintf(name, sizeof(name), "metric_out_%u", domain->ext);
+    oonf_class_append_state(buf, name, "%u", neighdata->metric.out);
+    snprintf(name, sizeof(name), "willingness_%u", domain->ext);
+    oonf_class_append_state(buf, name, "%u", neighdata->willingness);
+  }
+  return buf->buf;
+}
@@ -120,6 +120,9 @@ struct nhdp_link_domaindata {
 
   /*! time when this metric value was changed */
   uint64_t last_metric_change;
+
+  /*! metric used for last neighbor metric calculation */
+  struct nhdp_metric _last_used_metric;
 };
 
 /**
@@ -332,6 +335,12 @@ struct nhdp_neighbor {
   /*! optional member node for global tree of originators */
   struct avl_node _originator_node;
 
+  /*! bitmask of domain indices with outdated neighbor metrics */
+  uint8_t _metric_dirty;
+
+  /*! member entry for list of neighbors with outdated metrics */
+  struct list_entity _dirty_node;
+
   /*! Array of link metrics */
   struct nhdp_neighbor_domaindata _domaindata[NHDP_MAXIMUM_DOMAINS];
 };
@@ -386,6 +395,8 @@ EXPORT void nhdp_db_neighbor_set_originator(struct nhdp_neighbor *, const struct
 EXPORT void nhdp_db_neighbor_connect_dualstack(struct nhdp_neighbor *, struct nhdp_neighbor *);
 EXPORT void nhdp_db_neigbor_disconnect_dualstack(struct nhdp_neighbor *neigh);
 EXPORT uint32_t nhdp_db_neighbor_get_set_id(void);
+EXPORT uint64_t nhdp_db_get_generation(void);
+EXPORT void nhdp_db_increment_generation(void);
 
 EXPORT struct nhdp_link *nhdp_db_link_add(struct nhdp_neighbor *ipv4, struct nhdp_interface *ipv6);
 EXPORT void nhdp_db_link_remove(struct nhdp_link *);
@@ -405,6 +416,7 @@ EXPORT void nhdp_db_link_update_status(struct nhdp_link *);
 EXPORT const char *nhdp_db_link_status_to_string(struct nhdp_link *);
 
 EXPORT struct list_entity *nhdp_db_get_neigh_list(void);
+EXPORT uint32_t nhdp_db_get_neigh_count(void);
 EXPORT struct list_entity *nhdp_db_get_link_list(void);
 EXPORT struct avl_tree *nhdp_db_get_naddr_tree(void);
 EXPORT struct avl_tree *nhdp_db_get_neigh_originator_tree(void);
@@ -52,8 +52,10 @@
 #include "common/netaddr.h"
 #include "core/oonf_cfg.h"
 #include "core/oonf_logging.h"
+#include "core/oonf_trace.h"
 #include "subsystems/oonf_class.h"
 #include "subsystems/oonf_rfc5444.h"
+#include "subsystems/oonf_timer.h"
 
 #include "nhdp/nhdp.h"
 #include "nhdp/nhdp_db.h"
@@ -70,8 +72,14 @@ static void _remove_mpr(struct nhdp_domain *);
 static void _cb_update_everyone_routing_mpr(struct nhdp_domain *domain);
 static void _cb_update_everyone_flooding_mpr(struct nhdp_domain *domain);
 
+static void _mark_metric_dirty(struct nhdp_domain *domain,
+        struct nhdp_neighbor *neigh);
+static uint8_t _process_metric_changes(void);
+static void _cb_process_metric_changes(struct oonf_timer_instance *);
 static bool _recalculate_neighbor_metric(struct nhdp_domain *domain,
         struct nhdp_neighbor *neigh);
+static bool _link_metrics_changed(struct nhdp_domain *domain,
+        struct nhdp_neighbor *neigh);
 static bool _recalculate_routing_mpr_set(struct nhdp_domain *domain);
 static bool _recalculate_flooding_mpr_set(void);
 
@@ -116,6 +124,19 @@ static struct list_entity _domain_metric_postprocessor_list;
 
 static size_t _domain_counter = 0;
 
+/* neighbors with outdated metrics, processed in one batch */
+static struct list_entity _dirty_neighbors;
+static struct nhdp_domain_metric_stats _metric_stats;
+static uint8_t _pending_changed_domains;
+
+static struct oonf_timer_class _metric_batch_timer_class = {
+  .name = "NHDP metric recalculation",
+  .callback = _cb_process_metric_changes,
+};
+static struct oonf_timer_instance _metric_batch_timer = {
+  .class = &_metric_batch_timer_class,
+};
+
 /* tree of known routing metrics/mpr-algorithms */
 static struct avl_tree _domain_metrics;
 static struct avl_tree _domain_mprs;
@@ -129,6 +150,9 @@ static struct oonf_rfc5444_protocol *_protocol;
 /* remember if node is MPR or not */
 static bool _node_is_selected_as_mpr = false;
 
+/* changes for every MPR recalculation run and every MPR relevant change */
+static uint32_t _mpr_generation = 0;
+
 /**
  * Initialize nhdp metric core
  * @param p pointer to rfc5444 protocol
@@ -141,6 +165,9 @@ nhdp_domain_init(struct oonf_rfc5444_protocol *p) {
   list_init_head(&_domain_list);
   list_init_head(&_domain_listener_list);
   list_init_head(&_domain_metric_postprocessor_list);
+  list_init_head(&_dirty_neighbors);
+
+  oonf_timer_add(&_metric_batch_timer_class);
 
   avl_init(&_domain_metrics, avl_comp_strcasecmp, false);
   avl_init(&_domain_mprs, avl_comp_strcasecmp, false);
@@ -163,6 +190,9 @@ nhdp_domain_cleanup(void) {
   struct nhdp_domain_metric_postprocessor *processor, *p_it;
   int i;
 
+  oonf_timer_stop(&_metric_batch_timer);
+  oonf_timer_remove(&_metric_batch_timer_class);
+
   list_for_each_element_safe(&_domain_list, domain, _node, d_it) {
     /* free allocated TLVs */
     for (i=0; i<4; i++) {
@@ -374,6 +404,7 @@ nhdp_domain_init_link(struct nhdp_link *lnk) {
       data->metric.in = domain->metric->incoming_link_start;
       data->metric.out = domain->metric->outgoing_link_start;
     }
+    data->_last_used_metric = data->metric;
   }
 }
 
@@ -413,6 +444,8 @@ nhdp_domain_init_neighbor(struct nhdp_neighbor *neigh) {
   struct nhdp_neighbor_domaindata *data;
   int i;
 
+  neigh->_metric_dirty = 0;
+
   for (i=0; i<NHDP_MAXIMUM_DOMAINS; i++) {
     neigh->_domaindata[i].metric.in = RFC7181_METRIC_INFINITE;
     neigh->_domaindata[i].metric.out = RFC7181_METRIC_INFINITE;
@@ -437,6 +470,38 @@ nhdp_domain_init_neighbor(struct nhdp_neighbor *neigh) {
   }
 }
 
+/**
+ * Remove all metric references to a NHDP link before it is removed.
+ * Must be called after the link has been unhooked from its neighbor.
+ * @param lnk NHDP link
+ */
+void
+nhdp_domain_remove_link(struct nhdp_link *lnk) {
+  struct nhdp_domain *domain;
+
+  list_for_each_element(&_domain_list, domain, _node) {
+    if (nhdp_domain_get_neighbordata(domain, lnk->neigh)->best_out_link == lnk) {
+      /* do not keep a pointer to the link until the next batch */
+      if (_recalculate_neighbor_metric(domain, lnk->neigh)) {
+        _pending_changed_domains |= 1 << domain->index;
+      }
+      _mark_metric_dirty(domain, lnk->neigh);
+    }
+  }
+}
+
+/**
+ * Remove a NHDP neighbor from the pending metric recalculations
+ * @param neigh NHDP neighbor
+ */
+void
+nhdp_domain_remove_neighbor(struct nhdp_neighbor *neigh) {
+  if (list_is_node_added(&neigh->_dirty_node)) {
+    list_remove(&neigh->_dirty_node);
+  }
+  neigh->_metric_dirty = 0;
+}
+
 /**
  * Process an in linkmetric tlv for a nhdp link
  * @param domain pointer to NHDP domain
@@ -454,9 +519,15 @@ nhdp_domain_process_metric_linktlv(struct nhdp_domain *domain,
   metric = rfc7181_metric_decode(&metric_field);
 
   if (rfc7181_metric_has_flag(&metric_field, RFC7181_LINKMETRIC_INCOMING_LINK)) {
+    if (nhdp_domain_get_linkdata(domain, lnk)->metric.out != metric) {
+      _mark_metric_dirty(domain, lnk->neigh);
+    }
     nhdp_domain_get_linkdata(domain, lnk)->metric.out = metric;
   }
   if (rfc7181_metric_has_flag(&metric_field, RFC7181_LINKMETRIC_INCOMING_NEIGH)) {
+    if (nhdp_domain_get_neighbordata(domain, lnk->neigh)->metric.out != metric) {
+      _mark_metric_dirty(domain, lnk->neigh);
+    }
     nhdp_domain_get_neighbordata(domain, lnk->neigh)->metric.out = metric;
   }
 }
@@ -482,61 +553,96 @@ nhdp_domain_process_metric_2hoptlv(struct nhdp_domain *domain,
     data->metric.in = metric;
   }
   if (rfc7181_metric_has_flag(&metric_field, RFC7181_LINKMETRIC_OUTGOING_NEIGH)) {
+    if (data->metric.out != metric) {
+      _mark_metric_dirty(domain, l2hop->link->neigh);
+    }
     data->metric.out = metric;
   }
 }
 
 /**
- * This will trigger a metric recalculation
+ * Remember that the metrics of a neighbor must be recalculated
+ * and schedule the batch processing of all changes
  * @param domain NHDP domain of metric change, NULL for all domains
- * return true if metric changed, false otherwise
+ * @param neigh NHDP neighbor, NULL for all neighbors
  */
-static bool
-_recalculate_metrics(struct nhdp_domain *domain, struct nhdp_neighbor *neigh, bool trigger) {
-  struct nhdp_domain_listener *listener;
-  bool changed_metric;
-
-  changed_metric = false;
-
-  if (trigger) {
-    OONF_DEBUG(LOG_NHDP, "Recalculating metrics set for domain %d",
-        domain ? domain->index : -1);
-  }
+static void
+_mark_metric_dirty(struct nhdp_domain *domain, struct nhdp_neighbor *neigh) {
+  uint8_t mask;
 
-  if (!domain) {
-    list_for_each_element(&_domain_list, domain, _node) {
-      changed_metric |= _recalculate_metrics(domain, neigh, false);
-    }
-    domain = NULL;
-  }
-  else if (!neigh) {
+  if (!neigh) {
     list_for_each_element(nhdp_db_get_neigh_list(), neigh, _global_node) {
-      changed_metric |= _recalculate_neighbor_metric(domain, neigh);
+      _mark_metric_dirty(domain, neigh);
     }
+    return;
+  }
+
+  if (domain) {
+    mask = 1 << domain->index;
   }
   else {
-    changed_metric |= _recalculate_neighbor_metric(domain, neigh);
+    mask = (1 << NHDP_MAXIMUM_DOMAINS) - 1;
   }
 
-  if (trigger && changed_metric) {
-    list_for_each_element(&_domain_listener_list, listener, _node) {
-      /* trigger domain listeners */
-      if (listener->metric_update) {
-        listener->metric_update(domain);
-      }
-    }
+  neigh->_metric_dirty |= mask;
+  if (!list_is_node_added(&neigh->_dirty_node)) {
+    list_add_tail(&_dirty_neighbors, &neigh->_dirty_node);
   }
 
-  if (trigger) {
-    OONF_INFO(LOG_NHDP, "Metrics changed for domain %d: %s",
-        domain ? domain->index : -1, changed_metric ? "true" : "false");
+  if (!oonf_timer_is_active(&_metric_batch_timer)) {
+    /* process all changes of this event loop iteration at once */
+    oonf_timer_set(&_metric_batch_timer, 1);
   }
-  return changed_metric;
 }
 
+/**
+ * This will trigger a metric recalculation. The work is delayed until
+ * the end of the current event loop iteration, so multiple changes
+ * of the same neighbor are only processed once.
+ * @param domain NHDP domain of metric change, NULL for all domains
+ * @param neigh NHDP neighbor, NULL for all neighbors
+ */
+void
+nhdp_domain_delayed_metric_recalculation(struct nhdp_domain *domain,
+    struct nhdp_neighbor *neigh) {
+  _mark_metric_dirty(domain, neigh);
+}
+
+/**
+ * This will trigger a metric recalculation. All pending
+ * delayed recalculations are processed too.
+ * @param domain NHDP domain of metric change, NULL for all domains
+ * @param neigh NHDP neighbor, NULL for all neighbors
+ * @return true if metric changed, false otherwise
+ */
 bool
 nhdp_domain_recalculate_metrics(struct nhdp_domain *domain, struct nhdp_neighbor *neigh) {
-  return _recalculate_metrics(domain, neigh, true);
+  uint8_t changed_domains;
+
+  _mark_metric_dirty(domain, neigh);
+  changed_domains = _process_metric_changes();
+
+  if (domain) {
+    return (changed_domains & (1 << domain->index)) != 0;
+  }
+  return changed_domains != 0;
+}
+
+/**
+ * Recalculate the metrics of all neighbors with pending changes
+ * and inform the domain listeners once about each changed domain.
+ */
+void
+nhdp_domain_process_metric_changes(void) {
+  _process_metric_changes();
+}
+
+/**
+ * @return statistics of the batched neighbor metric recalculation
+ */
+const struct nhdp_domain_metric_stats *
+nhdp_domain_get_metric_stats(void) {
+  return &_metric_stats;
 }
 
 static void
@@ -554,6 +660,11 @@ void
 nhdp_domain_recalculate_mpr(void) {
   struct nhdp_domain *domain;
 
+  /* MPR selection needs the current neighbor metrics */
+  nhdp_domain_process_metric_changes();
+
+  _mpr_generation++;
+
   list_for_each_element(&_domain_list, domain, _node) {
     if (domain->_mpr_outdated) {
       if (_recalculate_routing_mpr_set(domain)) {
@@ -591,6 +702,19 @@ nhdp_domain_delayed_mpr_recalculation(struct nhdp_domain *domain,
   }
 
   domain->_mpr_outdated = true;
+  _mpr_generation++;
+}
+
+/**
+ * The MPR generation changes each time the input data of the MPR
+ * calculation might have changed and for each recalculation run,
+ * so MPR algorithms can share data derived from the NHDP database
+ * between domains as long as the generation stays the same.
+ * @return current MPR generation
+ */
+uint32_t
+nhdp_domain_get_mpr_generation(void) {
+  return _mpr_generation;
 }
 
 /**
@@ -937,6 +1061,7 @@ nhdp_domain_set_incoming_metric(struct nhdp_domain_metric *metric,
       if (linkdata->metric.in != new_metric) {
         changed = true;
         linkdata->last_metric_change = oonf_clock_getNow();
+        _mark_metric_dirty(domain, lnk->neigh);
       }
       linkdata->metric.in = new_metric;
     }
@@ -1031,9 +1156,6 @@ _recalculate_neighbor_metric(
   struct nhdp_l2hop_domaindata *l2hopdata;
   struct nhdp_neighbor_domaindata *neighdata;
   bool changed;
-#ifdef OONF_LOG_INFO
-  struct netaddr_str nbuf;
-#endif
 
   neighdata = nhdp_domain_get_neighbordata(domain, neigh);
   changed = false;
@@ -1046,9 +1168,9 @@ _recalculate_neighbor_metric(
   neighdata->best_out_link = NULL;
   neighdata->best_link_ifindex = 0;
 
-  OONF_INFO(LOG_NHDP, "Recalculate neighbor %s metrics (ext %u): old_outgoing=%u",
-      netaddr_to_string(&nbuf, &neigh->originator), domain->ext,
-      neighdata->best_out_link_metric);
+  OONF_TRACE_INFO(LOG_NHDP, "Recalculate neighbor %s metrics (ext %u): old_outgoing=%u",
+      OONF_TRACE_NETADDR(&neigh->originator), OONF_TRACE_U32(domain->ext),
+      OONF_TRACE_U32(neighdata->best_out_link_metric));
 
   /* get best metric */
   list_for_each_element(&neigh->_links, lnk, _neigh_node) {
@@ -1058,17 +1180,17 @@ _recalculate_neighbor_metric(
 
     linkdata = nhdp_domain_get_linkdata(domain, lnk);
     if (linkdata->metric.out < neighdata->metric.out) {
-      OONF_DEBUG(LOG_NHDP, "Link on if %s has better outgoing metric: %u",
-              lnk->local_if->os_if_listener.data->name,
-              linkdata->metric.out);
+      OONF_TRACE_DEBUG(LOG_NHDP, "Link on if %s has better outgoing metric: %u",
+              OONF_TRACE_STRING(lnk->local_if->os_if_listener.data->name),
+              OONF_TRACE_U32(linkdata->metric.out));
 
       neighdata->metric.out = linkdata->metric.out;
       neighdata->best_out_link = lnk;
     }
     if (linkdata->metric.in < neighdata->metric.in) {
-      OONF_DEBUG(LOG_NHDP, "Link on if %s has better incoming metric: %u",
-              lnk->local_if->os_if_listener.data->name,
-              linkdata->metric.in);
+      OONF_TRACE_DEBUG(LOG_NHDP, "Link on if %s has better incoming metric: %u",
+              OONF_TRACE_STRING(lnk->local_if->os_if_listener.data->name),
+              OONF_TRACE_U32(linkdata->metric.in));
       neighdata->metric.in = linkdata->metric.in;
     }
 
@@ -1084,10 +1206,10 @@ _recalculate_neighbor_metric(
   if (neighdata->best_out_link != NULL) {
     linkdata = nhdp_domain_get_linkdata(domain, neighdata->best_out_link);
 
-    OONF_INFO(LOG_NHDP, "Best link: if=%s, link=%s, in=%u, out=%u",
-        nhdp_interface_get_if_listener(neighdata->best_out_link->local_if)->data->name,
-        netaddr_to_string(&nbuf, &neighdata->best_out_link->if_addr),
-        linkdata->metric.in, linkdata->metric.out);
+    OONF_TRACE_INFO(LOG_NHDP, "Best link: if=%s, link=%s, in=%u, out=%u",
+        OONF_TRACE_STRING(nhdp_interface_get_if_listener(neighdata->best_out_link->local_if)->data->name),
+        OONF_TRACE_NETADDR(&neighdata->best_out_link->if_addr),
+        OONF_TRACE_U32(linkdata->metric.in), OONF_TRACE_U32(linkdata->metric.out));
     neighdata->best_link_ifindex =
         nhdp_interface_get_if_listener(neighdata->best_out_link->local_if)->data->index;
 
@@ -1098,6 +1220,30 @@ _recalculate_neighbor_metric(
   return changed;
 }
 
+/**
+ * Check if the incoming or outgoing metric of a link of a neighbor
+ * changed since the last recalculation
+ * @param domain NHDP domain
+ * @param neigh NHDP neighbor
+ * @return true if a link metric changed
+ */
+static bool
+_link_metrics_changed(struct nhdp_domain *domain, struct nhdp_neighbor *neigh) {
+  struct nhdp_link_domaindata *linkdata;
+  struct nhdp_link *lnk;
+  bool changed;
+
+  changed = false;
+  list_for_each_element(&neigh->_links, lnk, _neigh_node) {
+    linkdata = nhdp_domain_get_linkdata(domain, lnk);
+
+    changed |= linkdata->metric.in != linkdata->_last_used_metric.in
+        || linkdata->metric.out != linkdata->_last_used_metric.out;
+    linkdata->_last_used_metric = linkdata->metric;
+  }
+  return changed;
+}
+
 /**
  * Add a new domain to the NHDP system
  * @param ext TLV extension type used for new domain
@@ -1317,6 +1463,85 @@ _remove_mpr(struct nhdp_domain *domain) {
   domain->mpr->_refcount++;
 }
 
+/**
+ * Recalculate the metrics of all neighbors with pending changes
+ * and inform the domain listeners once about each changed domain.
+ * @return bitmask of the domain indices with changed metrics
+ */
+static uint8_t
+_process_metric_changes(void) {
+  struct nhdp_domain_listener *listener;
+  struct nhdp_neighbor *neigh, *n_it;
+  struct nhdp_domain *domain;
+  uint32_t recalculated, total;
+  uint8_t changed_domains;
+  bool metrics_changed;
+
+  oonf_timer_stop(&_metric_batch_timer);
+  if (list_is_empty(&_dirty_neighbors) && !_pending_changed_domains) {
+    return 0;
+  }
+
+  changed_domains = _pending_changed_domains;
+  _pending_changed_domains = 0;
+  recalculated = 0;
+  metrics_changed = false;
+
+  list_for_each_element_safe(&_dirty_neighbors, neigh, _dirty_node, n_it) {
+    list_for_each_element(&_domain_list, domain, _node) {
+      if (neigh->_metric_dirty & (1 << domain->index)) {
+        recalculated++;
+        if (_recalculate_neighbor_metric(domain, neigh)) {
+          changed_domains |= 1 << domain->index;
+        }
+        metrics_changed |= _link_metrics_changed(domain, neigh);
+      }
+    }
+
+    neigh->_metric_dirty = 0;
+    list_remove(&neigh->_dirty_node);
+  }
+
+  total = nhdp_db_get_neigh_count() * _domain_counter;
+
+  _metric_stats.batches++;
+  _metric_stats.recalculated += recalculated;
+  _metric_stats.skipped += total - recalculated;
+
+  OONF_DEBUG(LOG_NHDP, "Recalculated %u of %u neighbor metrics",
+      recalculated, total);
+
+  if (changed_domains != 0 || metrics_changed) {
+    /* a changed link metric might not change the neighbor metric */
+    nhdp_db_increment_generation();
+  }
+
+  list_for_each_element(&_domain_list, domain, _node) {
+    if ((changed_domains & (1 << domain->index)) == 0) {
+      continue;
+    }
+
+    OONF_INFO(LOG_NHDP, "Metrics changed for domain %d", domain->index);
+    list_for_each_element(&_domain_listener_list, listener, _node) {
+      /* trigger domain listeners */
+      if (listener->metric_update) {
+        listener->metric_update(domain);
+      }
+    }
+  }
+
+  return changed_domains;
+}
+
+/**
+ * Timer callback to process the batched metric changes
+ * @param ptr timer instance that fired
+ */
+static void
+_cb_process_metric_changes(struct oonf_timer_instance *ptr __attribute__((unused))) {
+  nhdp_domain_process_metric_changes();
+}
+
 static void
 _cb_update_everyone_routing_mpr(struct nhdp_domain *domain) {
   struct nhdp_neighbor *neigh;
@@ -228,6 +228,20 @@ struct nhdp_domain {
   struct list_entity _node;
 };
 
+/**
+ * Statistics of the batched neighbor metric recalculation
+ */
+struct nhdp_domain_metric_stats {
+  /*! number of processed batches */
+  uint32_t batches;
+
+  /*! number of neighbor metrics recalculated (per domain) */
+  uint32_t recalculated;
+
+  /*! number of neighbor metrics skipped because nothing changed (per domain) */
+  uint32_t skipped;
+};
+
 /**
  * listener for NHDP domain updates
  */
@@ -292,6 +306,8 @@ EXPORT struct nhdp_domain *nhdp_domain_get_by_ext(uint8_t);
 EXPORT void nhdp_domain_init_link(struct nhdp_link *);
 EXPORT void nhdp_domain_init_l2hop(struct nhdp_l2hop *);
 EXPORT void nhdp_domain_init_neighbor(struct nhdp_neighbor *);
+EXPORT void nhdp_domain_remove_neighbor(struct nhdp_neighbor *);
+EXPORT void nhdp_domain_remove_link(struct nhdp_link *);
 
 EXPORT void nhdp_domain_process_metric_linktlv(struct nhdp_domain *,
     struct nhdp_link *lnk, const uint8_t *value);
@@ -316,13 +332,18 @@ EXPORT size_t nhdp_domain_encode_willingness_tlvvalue(
 
 EXPORT bool nhdp_domain_set_incoming_metric(
     struct nhdp_domain_metric *metric, struct nhdp_link *lnk, uint32_t metric_in);
+EXPORT void nhdp_domain_delayed_metric_recalculation(
+    struct nhdp_domain *domain, struct nhdp_neighbor *neigh);
 EXPORT bool nhdp_domain_recalculate_metrics(
     struct nhdp_domain *domain, struct nhdp_neighbor *neigh);
+EXPORT void nhdp_domain_process_metric_changes(void);
+EXPORT const struct nhdp_domain_metric_stats *nhdp_domain_get_metric_stats(void);
 
 EXPORT bool nhdp_domain_node_is_mpr(void);
 EXPORT void nhdp_domain_delayed_mpr_recalculation(
     struct nhdp_domain *domain, struct nhdp_neighbor *neigh);
 EXPORT void nhdp_domain_recalculate_mpr(void);
+EXPORT uint32_t nhdp_domain_get_mpr_generation(void);
 
 EXPORT struct list_entity *nhdp_domain_get_list(void);
 EXPORT struct list_entity *nhdp_domain_get_listener_list(void);
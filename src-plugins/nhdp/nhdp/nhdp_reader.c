@@ -711,11 +711,13 @@ _process_domainspecific_linkdata(struct netaddr *addr __attribute__((unused))) {
   struct rfc5444_reader_tlvblock_entry *tlv;
   struct nhdp_domain *domain;
   struct nhdp_neighbor_domaindata *neighdata;
+  struct nhdp_link_domaindata *linkdata;
+  uint32_t domains_with_metric;
 #ifdef OONF_LOG_DEBUG_INFO
   struct netaddr_str buf;
 #endif
   /*
-   * clear routing mpr, willingness and metric values
+   * clear routing mpr and willingness values
    * that should be present in HELLO
    */
   list_for_each_element(nhdp_domain_get_list(), domain, _node) {
@@ -723,22 +725,25 @@ _process_domainspecific_linkdata(struct netaddr *addr __attribute__((unused))) {
 
     neighdata->local_is_mpr = false;
     neighdata->willingness = 0;
-    nhdp_domain_get_linkdata(domain, _current.link)->metric.out =
-        RFC7181_METRIC_INFINITE;
-    neighdata->metric.out = RFC7181_METRIC_INFINITE;
   }
 
   /* process MPR settings of link */
   nhdp_domain_process_mpr_tlv(_current.mprtypes, _current.mprtypes_size,
       _current.link, _nhdp_address_pass2_tlvs[IDX_ADDRTLV2_MPR].tlv);
 
-  /* update out metric with other sides in metric */
+  /*
+   * update out metric with other sides in metric, the metric
+   * processing only marks the neighbor for recalculation if
+   * the metric changed
+   */
+  domains_with_metric = 0;
   tlv = _nhdp_address_pass2_tlvs[IDX_ADDRTLV2_LINKMETRIC].tlv;
   while (tlv) {
     /* get metric handler */
     domain = nhdp_domain_get_by_ext(tlv->type_ext);
     if (domain != NULL && !domain->metric->no_default_handling) {
       nhdp_domain_process_metric_linktlv(domain, _current.link, tlv->single_value);
+      domains_with_metric |= 1 << domain->index;
 
       /* extract tlv value */
       OONF_DEBUG(LOG_NHDP_R, "Pass 2: address %s, LQ (ext %u): %02x%02x",
@@ -748,6 +753,16 @@ _process_domainspecific_linkdata(struct netaddr *addr __attribute__((unused))) {
 
     tlv = tlv->next_entry;
   }
+
+  /* clear metric values that should have been present in HELLO */
+  list_for_each_element(nhdp_domain_get_list(), domain, _node) {
+    linkdata = nhdp_domain_get_linkdata(domain, _current.link);
+    if ((domains_with_metric & (1 << domain->index)) == 0
+        && linkdata->metric.out != RFC7181_METRIC_INFINITE) {
+      linkdata->metric.out = RFC7181_METRIC_INFINITE;
+      nhdp_domain_delayed_metric_recalculation(domain, _current.neighbor);
+    }
+  }
 }
 
 /**
@@ -761,26 +776,20 @@ _process_domainspecific_2hopdata(struct nhdp_l2hop *l2hop,
   struct rfc5444_reader_tlvblock_entry *tlv;
   struct nhdp_domain *domain;
   struct nhdp_l2hop_domaindata *data;
+  uint32_t domains_with_metric;
 #ifdef OONF_LOG_DEBUG_INFO
   struct netaddr_str buf;
 #endif
 
-  /* clear metric values that should be present in HELLO */
-  list_for_each_element(nhdp_domain_get_list(), domain, _node) {
-    if (!domain->metric->no_default_handling) {
-      data = nhdp_domain_get_l2hopdata(domain, l2hop);
-      data->metric.in = RFC7181_METRIC_INFINITE;
-      data->metric.out = RFC7181_METRIC_INFINITE;
-    }
-  }
-
   /* update 2-hop metric (no direction reversal!) */
+  domains_with_metric = 0;
   tlv = _nhdp_address_pass2_tlvs[IDX_ADDRTLV2_LINKMETRIC].tlv;
   while (tlv) {
     /* get metric handler */
     domain = nhdp_domain_get_by_ext(tlv->type_ext);
     if (domain != NULL && !domain->metric->no_default_handling) {
       nhdp_domain_process_metric_2hoptlv(domain, l2hop, tlv->single_value);
+      domains_with_metric |= 1 << domain->index;
 
       OONF_DEBUG(LOG_NHDP_R, "Pass 2: address %s, LQ (ext %u): %02x%02x",
           netaddr_to_string(&buf, addr), tlv->type_ext,
@@ -790,6 +799,19 @@ _process_domainspecific_2hopdata(struct nhdp_l2hop *l2hop,
 
     tlv = tlv->next_entry;
   }
+
+  /* clear metric values that should have been present in HELLO */
+  list_for_each_element(nhdp_domain_get_list(), domain, _node) {
+    if (!domain->metric->no_default_handling
+        && (domains_with_metric & (1 << domain->index)) == 0) {
+      data = nhdp_domain_get_l2hopdata(domain, l2hop);
+      data->metric.in = RFC7181_METRIC_INFINITE;
+      if (data->metric.out != RFC7181_METRIC_INFINITE) {
+        data->metric.out = RFC7181_METRIC_INFINITE;
+        nhdp_domain_delayed_metric_recalculation(domain, l2hop->link->neigh);
+      }
+    }
+  }
 }
 
 /**
@@ -976,8 +998,10 @@ _cb_msg_pass2_end(struct rfc5444_reader_tlvblock_context *context, bool dropped)
   /* update link status */
   nhdp_db_link_update_status(_current.link);
 
-  /* update link metrics and MPR */
-  nhdp_domain_recalculate_metrics(NULL, _current.neighbor);
+  /*
+   * update MPR, the metric TLVs and link status changes
+   * already marked the neighbor metrics for recalculation
+   */
   nhdp_domain_delayed_mpr_recalculation(NULL, _current.neighbor);
 
   return RFC5444_OKAY;
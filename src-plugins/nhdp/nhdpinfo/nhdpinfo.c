@@ -90,6 +90,7 @@ static int _cb_create_text_link_address(struct oonf_viewer_template *);
 static int _cb_create_text_link_twohop(struct oonf_viewer_template *);
 static int _cb_create_text_neighbor(struct oonf_viewer_template *);
 static int _cb_create_text_neighbor_address(struct oonf_viewer_template *);
+static int _cb_create_text_metric_stats(struct oonf_viewer_template *);
 
 /*
  * list of template keys and corresponding buffers for values.
@@ -229,6 +230,15 @@ static int _cb_create_text_neighbor_address(struct oonf_viewer_template *);
 /*! template key for routing willingness */
 #define KEY_DOMAIN_MPR_WILL         "domain_mpr_willingness"
 
+/*! template key for number of batched metric recalculations */
+#define KEY_METRIC_BATCHES          "metric_batches"
+
+/*! template key for number of recalculated neighbor metrics */
+#define KEY_METRIC_RECALCULATED     "metric_recalculated"
+
+/*! template key for number of skipped neighbor metrics */
+#define KEY_METRIC_SKIPPED          "metric_skipped"
+
 /*
  * buffer space for values that will be assembled
  * into the output of the plugin
@@ -283,6 +293,10 @@ static char                       _value_domain_mpr_local[TEMPLATE_JSON_BOOL_LEN
 static char                       _value_domain_mpr_remote[TEMPLATE_JSON_BOOL_LENGTH];
 static char                       _value_domain_mpr_will[3];
 
+static char                       _value_metric_batches[11];
+static char                       _value_metric_recalculated[11];
+static char                       _value_metric_skipped[11];
+
 
 /* definition of the template data entries for JSON and table output */
 static struct abuf_template_data_entry _tde_if_key[] = {
@@ -375,6 +389,12 @@ static struct abuf_template_data_entry _tde_neigh_addr[] = {
     { KEY_NEIGHBOR_ADDRESS_VTIME, _value_neighbor_address_lost_vtime.buf, false },
 };
 
+static struct abuf_template_data_entry _tde_metric_stats[] = {
+    { KEY_METRIC_BATCHES, _value_metric_batches, false },
+    { KEY_METRIC_RECALCULATED, _value_metric_recalculated, false },
+    { KEY_METRIC_SKIPPED, _value_metric_skipped, false },
+};
+
 static struct abuf_template_storage _template_storage;
 
 /* Template Data objects (contain one or more Template Data Entries) */
@@ -414,6 +434,9 @@ static struct abuf_template_data _td_neigh_addr[] = {
     { _tde_neigh_key, ARRAYSIZE(_tde_neigh_key) },
     { _tde_neigh_addr, ARRAYSIZE(_tde_neigh_addr) },
 };
+static struct abuf_template_data _td_metric_stats[] = {
+    { _tde_metric_stats, ARRAYSIZE(_tde_metric_stats) },
+};
 
 /* OONF viewer templates (based on Template Data arrays) */
 static struct oonf_viewer_template _templates[] = {
@@ -458,6 +481,12 @@ static struct oonf_viewer_template _templates[] = {
         .data_size = ARRAYSIZE(_td_neigh_addr),
         .json_name = "neighbor_addr",
         .cb_function = _cb_create_text_neighbor_address,
+    },
+    {
+        .data = _td_metric_stats,
+        .data_size = ARRAYSIZE(_td_metric_stats),
+        .json_name = "metric_stats",
+        .cb_function = _cb_create_text_metric_stats,
     }
 };
 
@@ -933,3 +962,23 @@ _cb_create_text_neighbor_address(struct oonf_viewer_template *template) {
   }
   return 0;
 }
+
+/**
+ * Displays the statistics of the batched neighbor metric recalculation.
+ * @param template oonf viewer template
+ * @return -1 if an error happened, 0 otherwise
+ */
+static int
+_cb_create_text_metric_stats(struct oonf_viewer_template *template) {
+  const struct nhdp_domain_metric_stats *stats;
+
+  stats = nhdp_domain_get_metric_stats();
+
+  snprintf(_value_metric_batches, sizeof(_value_metric_batches), "%u", stats->batches);
+  snprintf(_value_metric_recalculated, sizeof(_value_metric_recalculated), "%u", stats->recalculated);
+  snprintf(_value_metric_skipped, sizeof(_value_metric_skipped), "%u", stats->skipped);
+
+  /* generate template output */
+  oonf_viewer_output_print_line(template);
+  return 0;
+}
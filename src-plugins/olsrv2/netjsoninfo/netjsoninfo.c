@@ -49,8 +49,10 @@
 
 #include "core/oonf_logging.h"
 #include "core/oonf_subsystem.h"
+#include "subsystems/oonf_class.h"
 #include "subsystems/oonf_clock.h"
 #include "subsystems/oonf_telnet.h"
+#include "subsystems/oonf_viewer.h"
 
 #include "nhdp/nhdp.h"
 #include "nhdp/nhdp_db.h"
@@ -121,22 +123,73 @@ enum netjson_edge_type {
   NETJSON_EDGE_ATTACHED,
 };
 
+/*! netjson objects that are generated in chunks */
+enum _netjson_object {
+  /*! no object in progress */
+  _NETJSON_OBJECT_NONE,
+
+  /*! NetworkGraph objects of all domains */
+  _NETJSON_OBJECT_GRAPH,
+
+  /*! NetworkRoutes objects of all domains */
+  _NETJSON_OBJECT_ROUTE,
+};
+
+/*! state of a netjsoninfo output of a telnet session */
+struct _netjson_output {
+  /*! json session writing into the telnet output buffer */
+  struct json_session session;
+
+  /*! copy of the telnet parameter */
+  char *parameter;
+
+  /*! next netjson object name in the parameter */
+  const char *next;
+
+  /*! true if the output is a single filtered netjson object */
+  bool filter;
+
+  /*! domain id of the filter, NULL if not used */
+  const char *filter_id;
+
+  /*! true if the parameter contained an unknown sub-command */
+  bool error;
+
+  /*! netjson object in progress */
+  enum _netjson_object object;
+
+  /*! index of the domain of the object in progress */
+  int domain_index;
+
+  /*! address family of the object in progress */
+  int af_type;
+
+  /*! position inside the object in progress */
+  struct oonf_viewer_cursor cursor;
+
+  /*! length of the output buffer at the start of the current chunk */
+  size_t chunk_start;
+};
+
 /* prototypes */
 static int _init(void);
 static void _cleanup(void);
 
-static void _print_graph(struct json_session *session,
+static bool _chunk_full(struct _netjson_output *output);
+static bool _print_graph(struct _netjson_output *output,
     struct nhdp_domain *domain, int af_type);
-static void _create_graph_json(
-    struct json_session *session, const char *filter);
-static void _print_routing_tree(struct json_session *session,
+static bool _print_routing_tree(struct _netjson_output *output,
     struct nhdp_domain *domain, int af_type);
-static void _create_route_json(
-    struct json_session *session, const char *filter);
 static void _create_domain_json(
     struct json_session *session);
 static void _create_error_json(struct json_session *session,
     const char *message, const char *parameter);
+static struct nhdp_domain *_get_domain(int index);
+static bool _handle_netjson_object(struct _netjson_output *output);
+static enum oonf_telnet_result _cb_netjsoninfo_chunk(
+    struct oonf_telnet_data *con);
+static void _cb_netjsoninfo_cleanup(struct oonf_telnet_data *con);
+static uint64_t _cb_netjsoninfo_generation(struct oonf_telnet_data *con);
 static enum oonf_telnet_result _cb_netjsoninfo(
     struct oonf_telnet_data *con);
 static void _print_json_string(
@@ -157,14 +210,23 @@ static struct oonf_telnet_command _telnet_commands[] = {
         "The filter prefix use an id (which can be queried by 'domain') to output"
         " a single domain of route/graph without the NetworkCollection object"
         " around it. The domain_id's are ipv4_<domain_number> and ipv6_<domain_number>.\n"
-        "> netjsoninfo filter route ipv4_0\n"),
+        "> netjsoninfo filter route ipv4_0\n",
+        .cb_get_generation = _cb_netjsoninfo_generation),
+};
+
+/* memory class for chunked netjson output */
+static struct oonf_class _output_class = {
+  .name = "netjsoninfo output",
+  .size = sizeof(struct _netjson_output),
 };
 
 /* plugin declaration */
 static const char *_dependencies[] = {
+  OONF_CLASS_SUBSYSTEM,
   OONF_NHDP_SUBSYSTEM,
   OONF_OLSRV2_SUBSYSTEM,
   OONF_TELNET_SUBSYSTEM,
+  OONF_VIEWER_SUBSYSTEM,
 };
 static struct oonf_subsystem olsrv2_netjsoninfo = {
   .name = OONF_NETJSONINFO_SUBSYSTEM,
@@ -183,6 +245,7 @@ DECLARE_OONF_PLUGIN(olsrv2_netjsoninfo);
  */
 static int
 _init(void) {
+  oonf_class_add(&_output_class);
   oonf_telnet_add(&_telnet_commands[0]);
   return 0;
 }
@@ -193,6 +256,7 @@ _init(void) {
 static void
 _cleanup(void) {
   oonf_telnet_remove(&_telnet_commands[0]);
+  oonf_class_remove(&_output_class);
 }
 
 /**
@@ -607,14 +671,29 @@ _print_graph_edge(struct json_session *session,
 }
 
 /**
- * Print the JSON graph object
- * @param session json session
+ * Check if the current chunk of a netjsoninfo output is full
+ * @param output netjsoninfo output state
+ * @return true if the output should continue with the next chunk
+ */
+static bool
+_chunk_full(struct _netjson_output *output) {
+  return abuf_getlen(output->session.out) >= output->chunk_start + OONF_VIEWER_CHUNK_SIZE;
+}
+
+/**
+ * Print the JSON graph object, continuing at the position of the
+ * output cursor
+ * @param output netjsoninfo output state
  * @param domain NHDP domain
  * @param af_type address family type
+ * @return true if the graph will be continued in the next chunk,
+ *   false if it is complete
  */
-static void
-_print_graph(struct json_session *session,
+static bool
+_print_graph(struct _netjson_output *output,
     struct nhdp_domain *domain, int af_type) {
+  struct json_session *session;
+  struct oonf_viewer_cursor *cursor;
   struct os_route_key routekey;
   const struct netaddr *originator, *dualstack;
   struct nhdp_neighbor *neigh;
@@ -630,9 +709,12 @@ _print_graph(struct json_session *session,
 
   bool outgoing;
 
+  session = &output->session;
+  cursor = &output->cursor;
+
   originator = olsrv2_originator_get(af_type);
-  if (netaddr_is_unspec(originator)) {
-    return;
+  if (cursor->phase == 0 && netaddr_is_unspec(originator)) {
+    return false;
   }
 
   /* get "other" originator */
@@ -641,192 +723,264 @@ _print_graph(struct json_session *session,
   /* get dualstack originator */
   dualstack = olsrv2_originator_get(AF_INET6);
 
-  json_start_object(session, NULL);
+  rt_tree = olsrv2_routing_get_tree(domain);
 
-  _print_json_string(session, "type", "NetworkGraph");
-  _print_json_string(session, "protocol", "olsrv2");
-  _print_json_string(session, "version", oonf_log_get_libdata()->version);
-  _print_json_string(session, "revision", oonf_log_get_libdata()->git_commit);
+  /* local node id for links */
+  _get_node_id_me(&node_id1, af_type);
 
-  _print_json_string(session, "router_id", _get_node_id_me(&node_id1, af_type));
+  switch (cursor->phase) {
+    case 0:
+      json_start_object(session, NULL);
 
-  _print_json_string(session, "metric", domain->metric->name);
-  _print_json_string(session, "topology_id",
-      _create_domain_id(&dbuf, domain, af_type));
+      _print_json_string(session, "type", "NetworkGraph");
+      _print_json_string(session, "protocol", "olsrv2");
+      _print_json_string(session, "version", oonf_log_get_libdata()->version);
+      _print_json_string(session, "revision", oonf_log_get_libdata()->git_commit);
 
-  json_start_object(session, "properties");
-  _print_json_netaddr(session, "router_addr", originator);
-  if (dualstack) {
-    _print_json_string(session, "dualstack_id",
-        _get_node_id_me(&node_id1, other_af));
-    _print_json_string(session, "dualstack_topology",
-        _create_domain_id(&dbuf, domain, other_af));
-    _print_json_netaddr(session, "dualstack_addr", dualstack);
-  }
-  json_end_object(session);
+      _print_json_string(session, "router_id", _get_node_id_me(&node_id2, af_type));
 
-  json_start_array(session, "nodes");
+      _print_json_string(session, "metric", domain->metric->name);
+      _print_json_string(session, "topology_id",
+          _create_domain_id(&dbuf, domain, af_type));
 
-  /* local node */
-  _print_graph_node_me(session, af_type);
+      json_start_object(session, "properties");
+      _print_json_netaddr(session, "router_addr", originator);
+      if (dualstack) {
+        _print_json_string(session, "dualstack_id",
+            _get_node_id_me(&node_id2, other_af));
+        _print_json_string(session, "dualstack_topology",
+            _create_domain_id(&dbuf, domain, other_af));
+        _print_json_netaddr(session, "dualstack_addr", dualstack);
+      }
+      json_end_object(session);
 
-  /* locally attached networks */
-  avl_for_each_element(olsrv2_lan_get_tree(), lan, _node) {
-    if (netaddr_get_address_family(&lan->prefix.dst) == af_type
-        && olsrv2_lan_get_domaindata(domain, lan)->active) {
-      _print_graph_node_lan(session, lan);
-    }
-  }
+      json_start_array(session, "nodes");
 
-  /* originators of all other nodes */
-  avl_for_each_element(olsrv2_tc_get_tree(), node, _originator_node) {
-    if (netaddr_get_address_family(&node->target.prefix.dst) == af_type) {
-      if (netaddr_cmp(&node->target.prefix.dst, originator) == 0) {
-        continue;
-      }
+      /* local node */
+      _print_graph_node_me(session, af_type);
 
-      _print_graph_node_tc(session, node);
+      oonf_viewer_cursor_next_phase(cursor);
+      /* fall through */
+    case 1:
+      /* locally attached networks */
+      oonf_viewer_for_each_element(cursor, 0, olsrv2_lan_get_tree(), lan, _node) {
+        oonf_viewer_cursor_enter(cursor, 0, &lan->prefix, sizeof(lan->prefix));
+
+        if (netaddr_get_address_family(&lan->prefix.dst) == af_type
+            && olsrv2_lan_get_domaindata(domain, lan)->active) {
+          _print_graph_node_lan(session, lan);
+        }
 
-      /* attached networks */
-      avl_for_each_element(&node->_attached_networks, attached, _src_node) {
-        _print_graph_node_attached(session, attached);
+        oonf_viewer_cursor_leave(cursor, 0);
+        if (_chunk_full(output)) {
+          return true;
+        }
       }
-    }
-  }
-  json_end_array(session);
 
-  json_start_array(session, "links");
+      oonf_viewer_cursor_next_phase(cursor);
+      /* fall through */
+    case 2:
+      /* originators of all other nodes */
+      oonf_viewer_for_each_element(cursor, 0, olsrv2_tc_get_tree(), node, _originator_node) {
+        oonf_viewer_cursor_enter(cursor, 0,
+            &node->target.prefix.dst, sizeof(node->target.prefix.dst));
+
+        if (netaddr_get_address_family(&node->target.prefix.dst) == af_type
+            && netaddr_cmp(&node->target.prefix.dst, originator) != 0) {
+          if (!oonf_viewer_cursor_is_started(cursor, 1)) {
+            _print_graph_node_tc(session, node);
+          }
 
-  rt_tree = olsrv2_routing_get_tree(domain);
+          /* attached networks */
+          oonf_viewer_for_each_element(cursor, 1,
+              &node->_attached_networks, attached, _src_node) {
+            oonf_viewer_cursor_enter(cursor, 1,
+                &attached->dst->target.prefix, sizeof(attached->dst->target.prefix));
 
-  /* print local links to neighbors */
-  _get_node_id_me(&node_id1, af_type);
+            _print_graph_node_attached(session, attached);
 
-  avl_for_each_element(nhdp_db_get_neigh_originator_tree(), neigh, _originator_node) {
-    if (netaddr_get_address_family(&neigh->originator) == af_type
-        && neigh->symmetric > 0) {
-      os_routing_init_sourcespec_prefix(&routekey, &neigh->originator);
+            oonf_viewer_cursor_leave(cursor, 1);
+            if (_chunk_full(output)) {
+              return true;
+            }
+          }
+        }
 
-      rt_entry = avl_find_element(rt_tree, &routekey, rt_entry, _node);
-      outgoing = rt_entry != NULL
-          && netaddr_cmp(&rt_entry->last_originator, originator) == 0;
+        oonf_viewer_cursor_leave(cursor, 0);
+        if (_chunk_full(output)) {
+          return true;
+        }
+      }
+      json_end_array(session);
 
-      _get_nhdp_neighbor_id(&node_id2, neigh);
+      json_start_array(session, "links");
 
-      _print_graph_edge(session, domain,
-          &node_id1, &node_id2, originator, &neigh->originator,
-          nhdp_domain_get_neighbordata(domain, neigh)->metric.out,
-          nhdp_domain_get_neighbordata(domain, neigh)->metric.in,
-          0, outgoing, NETJSON_EDGE_LOCAL, neigh);
+      oonf_viewer_cursor_next_phase(cursor);
+      /* fall through */
+    case 3:
+      /* print local links to neighbors */
+      oonf_viewer_for_each_element(cursor, 0,
+          nhdp_db_get_neigh_originator_tree(), neigh, _originator_node) {
+        oonf_viewer_cursor_enter(cursor, 0, &neigh->originator, sizeof(neigh->originator));
 
-      _print_graph_edge(session, domain,
-          &node_id2, &node_id1, &neigh->originator, originator,
-          nhdp_domain_get_neighbordata(domain, neigh)->metric.in,
-          nhdp_domain_get_neighbordata(domain, neigh)->metric.out,
-          0, false, NETJSON_EDGE_ROUTERS, NULL);
-    }
-  }
+        if (netaddr_get_address_family(&neigh->originator) == af_type
+            && neigh->symmetric > 0) {
+          os_routing_init_sourcespec_prefix(&routekey, &neigh->originator);
 
-  /* print local endpoints */
-  avl_for_each_element(olsrv2_lan_get_tree(), lan, _node) {
-    if (netaddr_get_address_family(&lan->prefix.dst) == af_type
-        && olsrv2_lan_get_domaindata(domain, lan)->active) {
-      rt_entry = avl_find_element(rt_tree, &lan->prefix, rt_entry, _node);
-      outgoing = rt_entry == NULL;
+          rt_entry = avl_find_element(rt_tree, &routekey, rt_entry, _node);
+          outgoing = rt_entry != NULL
+              && netaddr_cmp(&rt_entry->last_originator, originator) == 0;
 
-      _get_tc_lan_id(&node_id2, lan);
+          _get_nhdp_neighbor_id(&node_id2, neigh);
 
-      _print_graph_edge(session, domain,
-          &node_id1, &node_id2, originator, &lan->prefix.dst,
-          olsrv2_lan_get_domaindata(domain, lan)->outgoing_metric, 0,
-          olsrv2_lan_get_domaindata(domain, lan)->distance,
-          outgoing, NETJSON_EDGE_LAN, NULL);
-    }
-  }
+          _print_graph_edge(session, domain,
+              &node_id1, &node_id2, originator, &neigh->originator,
+              nhdp_domain_get_neighbordata(domain, neigh)->metric.out,
+              nhdp_domain_get_neighbordata(domain, neigh)->metric.in,
+              0, outgoing, NETJSON_EDGE_LOCAL, neigh);
 
-  /* print remote node links to neighbors */
-  avl_for_each_element(olsrv2_tc_get_tree(), node, _originator_node) {
-    if (netaddr_get_address_family(&node->target.prefix.dst) == af_type) {
-      _get_tc_node_id(&node_id1, node);
+          _print_graph_edge(session, domain,
+              &node_id2, &node_id1, &neigh->originator, originator,
+              nhdp_domain_get_neighbordata(domain, neigh)->metric.in,
+              nhdp_domain_get_neighbordata(domain, neigh)->metric.out,
+              0, false, NETJSON_EDGE_ROUTERS, NULL);
+        }
 
-      avl_for_each_element(&node->_edges, edge, _node) {
-        if (!edge->virtual) {
-          if (netaddr_cmp(&edge->dst->target.prefix.dst, originator) == 0) {
-            /* we already have this information from NHDP */
-            continue;
-          }
+        oonf_viewer_cursor_leave(cursor, 0);
+        if (_chunk_full(output)) {
+          return true;
+        }
+      }
 
-          rt_entry = avl_find_element(rt_tree, &edge->dst->target.prefix, rt_entry, _node);
-          outgoing = rt_entry != NULL
-              && netaddr_cmp(&rt_entry->last_originator, &node->target.prefix.dst) == 0;
+      oonf_viewer_cursor_next_phase(cursor);
+      /* fall through */
+    case 4:
+      /* print local endpoints */
+      oonf_viewer_for_each_element(cursor, 0, olsrv2_lan_get_tree(), lan, _node) {
+        oonf_viewer_cursor_enter(cursor, 0, &lan->prefix, sizeof(lan->prefix));
 
-          _get_tc_node_id(&node_id2, edge->dst);
+        if (netaddr_get_address_family(&lan->prefix.dst) == af_type
+            && olsrv2_lan_get_domaindata(domain, lan)->active) {
+          rt_entry = avl_find_element(rt_tree, &lan->prefix, rt_entry, _node);
+          outgoing = rt_entry == NULL;
+
+          _get_tc_lan_id(&node_id2, lan);
 
           _print_graph_edge(session, domain,
-              &node_id1, &node_id2, &node->target.prefix.dst, &edge->dst->target.prefix.dst,
-              edge->cost[domain->index], edge->inverse->cost[domain->index],
-              0, outgoing, NETJSON_EDGE_ROUTERS, NULL);
+              &node_id1, &node_id2, originator, &lan->prefix.dst,
+              olsrv2_lan_get_domaindata(domain, lan)->outgoing_metric, 0,
+              olsrv2_lan_get_domaindata(domain, lan)->distance,
+              outgoing, NETJSON_EDGE_LAN, NULL);
+        }
+
+        oonf_viewer_cursor_leave(cursor, 0);
+        if (_chunk_full(output)) {
+          return true;
         }
       }
-    }
-  }
 
-  /* print remote nodes neighbors */
-  avl_for_each_element(olsrv2_tc_get_tree(), node, _originator_node) {
-    if (netaddr_get_address_family(&node->target.prefix.dst) == af_type) {
-      _get_tc_node_id(&node_id1, node);
+      oonf_viewer_cursor_next_phase(cursor);
+      /* fall through */
+    case 5:
+      /* print remote node links to neighbors */
+      oonf_viewer_for_each_element(cursor, 0, olsrv2_tc_get_tree(), node, _originator_node) {
+        oonf_viewer_cursor_enter(cursor, 0,
+            &node->target.prefix.dst, sizeof(node->target.prefix.dst));
+
+        if (netaddr_get_address_family(&node->target.prefix.dst) == af_type) {
+          _get_tc_node_id(&node_id1, node);
+
+          oonf_viewer_for_each_element(cursor, 1, &node->_edges, edge, _node) {
+            oonf_viewer_cursor_enter(cursor, 1,
+                &edge->dst->target.prefix.dst, sizeof(edge->dst->target.prefix.dst));
+
+            /* we already have the links to the local node from NHDP */
+            if (!edge->virtual
+                && netaddr_cmp(&edge->dst->target.prefix.dst, originator) != 0) {
+              rt_entry = avl_find_element(rt_tree, &edge->dst->target.prefix, rt_entry, _node);
+              outgoing = rt_entry != NULL
+                  && netaddr_cmp(&rt_entry->last_originator, &node->target.prefix.dst) == 0;
+
+              _get_tc_node_id(&node_id2, edge->dst);
+
+              _print_graph_edge(session, domain,
+                  &node_id1, &node_id2, &node->target.prefix.dst, &edge->dst->target.prefix.dst,
+                  edge->cost[domain->index], edge->inverse->cost[domain->index],
+                  0, outgoing, NETJSON_EDGE_ROUTERS, NULL);
+            }
+
+            oonf_viewer_cursor_leave(cursor, 1);
+            if (_chunk_full(output)) {
+              return true;
+            }
+          }
+        }
 
-      avl_for_each_element(&node->_attached_networks, attached, _src_node) {
-        rt_entry = avl_find_element(rt_tree, &attached->dst->target.prefix, rt_entry, _node);
-         outgoing = rt_entry != NULL
-             && netaddr_cmp(&rt_entry->originator, &node->target.prefix.dst) == 0;
+        oonf_viewer_cursor_leave(cursor, 0);
+      }
 
-         _get_tc_endpoint_id(&node_id2, attached);
+      oonf_viewer_cursor_next_phase(cursor);
+      /* fall through */
+    case 6:
+      /* print remote nodes neighbors */
+      oonf_viewer_for_each_element(cursor, 0, olsrv2_tc_get_tree(), node, _originator_node) {
+        oonf_viewer_cursor_enter(cursor, 0,
+            &node->target.prefix.dst, sizeof(node->target.prefix.dst));
+
+        if (netaddr_get_address_family(&node->target.prefix.dst) == af_type) {
+          _get_tc_node_id(&node_id1, node);
+
+          oonf_viewer_for_each_element(cursor, 1,
+              &node->_attached_networks, attached, _src_node) {
+            oonf_viewer_cursor_enter(cursor, 1,
+                &attached->dst->target.prefix, sizeof(attached->dst->target.prefix));
+
+            rt_entry = avl_find_element(rt_tree, &attached->dst->target.prefix, rt_entry, _node);
+            outgoing = rt_entry != NULL
+                && netaddr_cmp(&rt_entry->originator, &node->target.prefix.dst) == 0;
+
+            _get_tc_endpoint_id(&node_id2, attached);
+
+            _print_graph_edge(session, domain,
+                &node_id1, &node_id2, &node->target.prefix.dst, &attached->dst->target.prefix.dst,
+                attached->cost[domain->index], 0,
+                attached->distance[domain->index], outgoing, NETJSON_EDGE_ATTACHED, NULL);
+
+            oonf_viewer_cursor_leave(cursor, 1);
+            if (_chunk_full(output)) {
+              return true;
+            }
+          }
+        }
 
-        _print_graph_edge(session, domain,
-            &node_id1, &node_id2, &node->target.prefix.dst, &attached->dst->target.prefix.dst,
-            attached->cost[domain->index], 0,
-            attached->distance[domain->index], outgoing, NETJSON_EDGE_ATTACHED, NULL);
+        oonf_viewer_cursor_leave(cursor, 0);
       }
-    }
-  }
-  json_end_array(session);
-
-  json_end_object(session);
-}
+      json_end_array(session);
 
-/**
- * Print all JSON graph objects
- * @param session json session
- * @param filter domain filter
- */
-static void
-_create_graph_json(struct json_session *session,
-    const char *filter) {
-  struct nhdp_domain *domain;
-  struct domain_id_str dbuf;
+      json_end_object(session);
 
-  list_for_each_element(nhdp_domain_get_list(), domain, _node) {
-    if (filter == NULL
-        || strcmp(_create_domain_id(&dbuf, domain, AF_INET), filter) == 0) {
-      _print_graph(session, domain, AF_INET);
-    }
-    if (filter == NULL
-        || strcmp(_create_domain_id(&dbuf, domain, AF_INET6), filter) == 0) {
-      _print_graph(session, domain, AF_INET6);
-    }
+      oonf_viewer_cursor_next_phase(cursor);
+      /* fall through */
+    default:
+      break;
   }
+  return false;
 }
 
 /**
- * Print the JSON routing tree
- * @param session json session
+ * Print the JSON routing tree, continuing at the position of the
+ * output cursor
+ * @param output netjsoninfo output state
  * @param domain NHDP domain
  * @param af_type address family
+ * @return true if the routing tree will be continued in the next
+ *   chunk, false if it is complete
  */
-static void
-_print_routing_tree(struct json_session *session,
+static bool
+_print_routing_tree(struct _netjson_output *output,
     struct nhdp_domain *domain, int af_type) {
+  struct json_session *session;
+  struct oonf_viewer_cursor *cursor;
   struct olsrv2_routing_entry *rtentry;
   const struct netaddr *originator;
   char ibuf[IF_NAMESIZE];
@@ -834,92 +988,92 @@ _print_routing_tree(struct json_session *session,
   struct domain_id_str dbuf;
   struct _node_id_str idbuf;
 
+  session = &output->session;
+  cursor = &output->cursor;
+
   originator = olsrv2_originator_get(af_type);
-  if (netaddr_get_address_family(originator) != af_type) {
-    return;
+  if (cursor->phase == 0 && netaddr_get_address_family(originator) != af_type) {
+    return false;
   }
 
-  json_start_object(session, NULL);
+  switch (cursor->phase) {
+    case 0:
+      json_start_object(session, NULL);
 
-  _print_json_string(session, "type", "NetworkRoutes");
-  _print_json_string(session, "protocol", "olsrv2");
-  _print_json_string(session, "version", oonf_log_get_libdata()->version);
-  _print_json_string(session, "revision", oonf_log_get_libdata()->git_commit);
+      _print_json_string(session, "type", "NetworkRoutes");
+      _print_json_string(session, "protocol", "olsrv2");
+      _print_json_string(session, "version", oonf_log_get_libdata()->version);
+      _print_json_string(session, "revision", oonf_log_get_libdata()->git_commit);
 
-  _get_node_id_me(&idbuf, af_type);
-  _print_json_string(session, "router_id", idbuf.buf);
-  _print_json_string(session, "metric", domain->metric->name);
-  _print_json_string(session, "topology_id",
-      _create_domain_id(&dbuf, domain, af_type));
+      _get_node_id_me(&idbuf, af_type);
+      _print_json_string(session, "router_id", idbuf.buf);
+      _print_json_string(session, "metric", domain->metric->name);
+      _print_json_string(session, "topology_id",
+          _create_domain_id(&dbuf, domain, af_type));
 
-  json_start_object(session, "properties");
-  _print_json_netaddr(session, "router_addr", originator);
-  json_end_object(session);
+      json_start_object(session, "properties");
+      _print_json_netaddr(session, "router_addr", originator);
+      json_end_object(session);
 
-  json_start_array(session, JSON_NAME_ROUTE);
+      json_start_array(session, JSON_NAME_ROUTE);
 
-  avl_for_each_element(olsrv2_routing_get_tree(domain), rtentry, _node) {
-    if (rtentry->route.p.family == af_type) {
-      json_start_object(session, NULL);
+      oonf_viewer_cursor_next_phase(cursor);
+      /* fall through */
+    case 1:
+      oonf_viewer_for_each_element(cursor, 0, olsrv2_routing_get_tree(domain), rtentry, _node) {
+        oonf_viewer_cursor_enter(cursor, 0, &rtentry->route.p.key, sizeof(rtentry->route.p.key));
 
-      _print_json_netaddr(session, "destination", &rtentry->route.p.key.dst);
+        if (rtentry->route.p.family == af_type) {
+          json_start_object(session, NULL);
 
-      if (netaddr_get_prefix_length(&rtentry->route.p.key.src) > 0) {
-        _print_json_netaddr(session, "source", &rtentry->route.p.key.src);
-      }
+          _print_json_netaddr(session, "destination", &rtentry->route.p.key.dst);
 
-      _get_node_id(&idbuf, &rtentry->next_originator, NULL);
-      _print_json_netaddr(session, "next", &rtentry->route.p.gw);
+          if (netaddr_get_prefix_length(&rtentry->route.p.key.src) > 0) {
+            _print_json_netaddr(session, "source", &rtentry->route.p.key.src);
+          }
 
-      _print_json_string(session, "device", if_indextoname(rtentry->route.p.if_index, ibuf));
-      _print_json_number(session, "cost", rtentry->path_cost);
-      _print_json_string(session, "cost_text",
-          nhdp_domain_get_path_metric_value(
-              &mbuf, domain, rtentry->path_cost, rtentry->path_hops));
+          _get_node_id(&idbuf, &rtentry->next_originator, NULL);
+          _print_json_netaddr(session, "next", &rtentry->route.p.gw);
 
-      json_start_object(session, "properties");
-      if (!netaddr_is_unspec(&rtentry->originator)) {
-        _get_node_id(&idbuf, &rtentry->originator, NULL);
-        _print_json_string(session, "destination_id", idbuf.buf);
-      }
-      _print_json_string(session, "next_router_id", idbuf.buf);
-      _print_json_netaddr(session, "next_router_addr", &rtentry->next_originator);
+          _print_json_string(session, "device", if_indextoname(rtentry->route.p.if_index, ibuf));
+          _print_json_number(session, "cost", rtentry->path_cost);
+          _print_json_string(session, "cost_text",
+              nhdp_domain_get_path_metric_value(
+                  &mbuf, domain, rtentry->path_cost, rtentry->path_hops));
 
-      _print_json_number(session, "hops", rtentry->path_hops);
+          json_start_object(session, "properties");
+          if (!netaddr_is_unspec(&rtentry->originator)) {
+            _get_node_id(&idbuf, &rtentry->originator, NULL);
+            _print_json_string(session, "destination_id", idbuf.buf);
+          }
+          _print_json_string(session, "next_router_id", idbuf.buf);
+          _print_json_netaddr(session, "next_router_addr", &rtentry->next_originator);
 
-      _get_node_id(&idbuf, &rtentry->last_originator, NULL);
-      _print_json_string(session, "last_router_id", idbuf.buf);
-      _print_json_netaddr(session, "last_router_addr", &rtentry->last_originator);
-      json_end_object(session);
+          _print_json_number(session, "hops", rtentry->path_hops);
 
-      json_end_object(session);
-    }
-  }
+          _get_node_id(&idbuf, &rtentry->last_originator, NULL);
+          _print_json_string(session, "last_router_id", idbuf.buf);
+          _print_json_netaddr(session, "last_router_addr", &rtentry->last_originator);
+          json_end_object(session);
 
-  json_end_array(session);
-  json_end_object(session);
-}
+          json_end_object(session);
+        }
 
-/**
- * Print all JSON routes
- * @param session json session
- * @param filter filter value to select domain
- */
-static void
-_create_route_json(struct json_session *session, const char *filter) {
-  struct nhdp_domain *domain;
-  struct domain_id_str dbuf;
+        oonf_viewer_cursor_leave(cursor, 0);
+        if (_chunk_full(output)) {
+          return true;
+        }
+      }
 
-  list_for_each_element(nhdp_domain_get_list(), domain, _node) {
-    if (filter == NULL
-        || strcmp(_create_domain_id(&dbuf, domain, AF_INET), filter) == 0) {
-      _print_routing_tree(session, domain, AF_INET);
-    }
-    if (filter == NULL
-        || strcmp(_create_domain_id(&dbuf, domain, AF_INET6), filter) == 0) {
-      _print_routing_tree(session, domain, AF_INET6);
-    }
+      json_end_array(session);
+      json_end_object(session);
+
+      oonf_viewer_cursor_next_phase(cursor);
+      /* fall through */
+    default:
+      break;
   }
+  return false;
 }
 
 static void
@@ -990,63 +1144,162 @@ _create_error_json(struct json_session *session,
   json_end_object(session);
 }
 
-static const char *
-_handle_netjson_object(struct json_session *session,
-    const char *parameter, bool filter, bool *error) {
+/**
+ * Get the NHDP domain with a certain index
+ * @param index domain index
+ * @return NHDP domain, NULL if not found
+ */
+static struct nhdp_domain *
+_get_domain(int index) {
+  struct nhdp_domain *domain;
+
+  list_for_each_element(nhdp_domain_get_list(), domain, _node) {
+    if (domain->index == index) {
+      return domain;
+    }
+  }
+  return NULL;
+}
+
+/**
+ * Parse the next netjson object of the telnet parameter. Graph and
+ * route objects are printed in chunks later, domain objects and
+ * errors directly.
+ * @param output netjsoninfo output state
+ * @return true if a netjson object was found, false if the end of
+ *   the parameter is reached
+ */
+static bool
+_handle_netjson_object(struct _netjson_output *output) {
   const char *ptr;
 
-  if ((ptr = str_hasnextword(parameter, JSON_NAME_GRAPH))) {
-    _create_graph_json(session, filter ? ptr : NULL);
+  if (output->next == NULL || *output->next == 0) {
+    return false;
   }
-  else if ((ptr = str_hasnextword(parameter, JSON_NAME_ROUTE))) {
-    _create_route_json(session, filter ? ptr : NULL);
+
+  output->object = _NETJSON_OBJECT_NONE;
+  if ((ptr = str_hasnextword(output->next, JSON_NAME_GRAPH))) {
+    output->object = _NETJSON_OBJECT_GRAPH;
+  }
+  else if ((ptr = str_hasnextword(output->next, JSON_NAME_ROUTE))) {
+    output->object = _NETJSON_OBJECT_ROUTE;
+  }
+  else if (!output->filter
+      && (ptr = str_hasnextword(output->next, JSON_NAME_DOMAIN))) {
+    _create_domain_json(&output->session);
   }
-  else if (!filter
-      && (ptr = str_hasnextword(parameter, JSON_NAME_DOMAIN))) {
-    _create_domain_json(session);
+  else {
+    ptr = str_skipnextword(output->next);
+    output->error = true;
+  }
+
+  output->domain_index = 0;
+  output->af_type = AF_INET;
+  memset(&output->cursor, 0, sizeof(output->cursor));
+
+  if (output->filter) {
+    /* a filter is followed by the domain id, not by more objects */
+    output->filter_id = ptr;
+    output->next = NULL;
   }
   else {
-    ptr = str_skipnextword(parameter);
-    *error = true;
+    output->next = ptr;
   }
-  return ptr;
+  return true;
 }
 
-static void
-_handle_filter(struct json_session *session, const char *parameter) {
-  bool error = false;
+/**
+ * Telnet callback to generate the next chunk of a netjsoninfo output
+ * @param con telnet connection
+ * @return continous if more output will follow, active otherwise
+ */
+static enum oonf_telnet_result
+_cb_netjsoninfo_chunk(struct oonf_telnet_data *con) {
+  struct _netjson_output *output;
+  struct nhdp_domain *domain;
+  struct domain_id_str dbuf;
+  bool more;
+
+  output = con->chunk_data;
+  output->chunk_start = abuf_getlen(con->out);
+
+  while (output->object != _NETJSON_OBJECT_NONE || _handle_netjson_object(output)) {
+    if (output->object == _NETJSON_OBJECT_NONE) {
+      continue;
+    }
+
+    domain = _get_domain(output->domain_index);
+    if (domain == NULL) {
+      /* all domains done */
+      output->object = _NETJSON_OBJECT_NONE;
+      continue;
+    }
+
+    if (output->filter_id == NULL
+        || strcmp(_create_domain_id(&dbuf, domain, output->af_type), output->filter_id) == 0) {
+      if (output->object == _NETJSON_OBJECT_GRAPH) {
+        more = _print_graph(output, domain, output->af_type);
+      }
+      else {
+        more = _print_routing_tree(output, domain, output->af_type);
+      }
+      if (more) {
+        return TELNET_RESULT_CONTINOUS;
+      }
+    }
+
+    /* continue with next address family or domain */
+    memset(&output->cursor, 0, sizeof(output->cursor));
+    if (output->af_type == AF_INET) {
+      output->af_type = AF_INET6;
+    }
+    else {
+      output->af_type = AF_INET;
+      output->domain_index++;
+    }
+  }
 
-  _handle_netjson_object(session, parameter, true, &error);
-  if (error) {
-    _create_error_json(session,
+  if (output->error) {
+    _create_error_json(&output->session,
         "Could not parse sub-command for netjsoninfo",
-        parameter);
+        output->parameter);
   }
+
+  if (!output->filter) {
+    json_end_array(&output->session);
+    json_end_object(&output->session);
+  }
+  return TELNET_RESULT_ACTIVE;
 }
 
+/**
+ * Telnet callback to free the state of a netjsoninfo output
+ * @param con telnet connection
+ */
 static void
-_handle_collection(struct json_session *session, const char *parameter) {
-  const char *next;
-  bool error;
+_cb_netjsoninfo_cleanup(struct oonf_telnet_data *con) {
+  struct _netjson_output *output;
 
-  json_start_object(session, NULL);
-  _print_json_string(session, "type", "NetworkCollection");
-  json_start_array(session, "collection");
+  output = con->chunk_data;
 
-  error = 0;
-  next = parameter;
-  while (next && *next) {
-    next = _handle_netjson_object(session, next, false, &error);
-  }
+  free(output->parameter);
+  oonf_class_free(&_output_class, output);
+}
 
-  if (error) {
-    _create_error_json(session,
-        "Could not parse sub-command for netjsoninfo",
-        parameter);
+/**
+ * Callback for the output cache of the netjsoninfo telnet command
+ * @param con telnet connection
+ * @return generation of the topology, routing and NHDP database,
+ *   0 if the output must not be cached
+ */
+static uint64_t
+_cb_netjsoninfo_generation(struct oonf_telnet_data *con) {
+  if (con->parameter == NULL || *con->parameter == 0) {
+    return 0;
   }
 
-  json_end_array(session);
-  json_end_object(session);
+  /* both counters only increase, so their sum changes with each of them */
+  return olsrv2_routing_get_generation() + nhdp_db_get_generation();
 }
 
 /**
@@ -1056,29 +1309,43 @@ _handle_collection(struct json_session *session, const char *parameter) {
  */
 static enum oonf_telnet_result
 _cb_netjsoninfo(struct oonf_telnet_data *con) {
-  struct json_session session;
-  struct autobuf out;
-  const char *ptr, *next;
+  struct _netjson_output *output;
+  const char *ptr;
+
+  if (con->parameter == NULL || *con->parameter == 0) {
+    return TELNET_RESULT_ACTIVE;
+  }
 
-  if (abuf_init(&out)) {
+  output = oonf_class_malloc(&_output_class);
+  if (output == NULL) {
     return TELNET_RESULT_INTERNAL_ERROR;
   }
 
-  json_init_session(&session, &out);
+  /* the parameter string is only valid during this call */
+  output->parameter = strdup(con->parameter);
+  if (output->parameter == NULL) {
+    oonf_class_free(&_output_class, output);
+    return TELNET_RESULT_INTERNAL_ERROR;
+  }
 
-  next = con->parameter;
-  if (next && *next) {
-    if ((ptr = str_hasnextword(next, JSON_NAME_FILTER))) {
-      _handle_filter(&session, ptr);
-    }
-    else {
-      _handle_collection(&session, next);
-    }
+  json_init_session(&output->session, con->out);
+
+  if ((ptr = str_hasnextword(output->parameter, JSON_NAME_FILTER))) {
+    output->filter = true;
+    output->next = ptr;
+  }
+  else {
+    json_start_object(&output->session, NULL);
+    _print_json_string(&output->session, "type", "NetworkCollection");
+    json_start_array(&output->session, "collection");
+
+    output->next = output->parameter;
   }
 
-  /* copy output into telnet buffer */
-  abuf_memcpy(con->out, abuf_getptr(&out), abuf_getlen(&out));
-  abuf_free(&out);
+  /* telnet generates the output when its output buffer is empty */
+  con->chunk_handler = _cb_netjsoninfo_chunk;
+  con->chunk_cleanup = _cb_netjsoninfo_cleanup;
+  con->chunk_data = output;
   return TELNET_RESULT_ACTIVE;
 }
 
@@ -64,6 +64,7 @@
 #include "olsrv2/olsrv2_lan.h"
 #include "olsrv2/olsrv2_originator.h"
 #include "olsrv2/olsrv2_reader.h"
+#include "olsrv2/olsrv2_routing.h"
 #include "olsrv2/olsrv2_tc.h"
 #include "olsrv2/olsrv2_writer.h"
 
@@ -120,6 +121,12 @@ struct _config {
 
   /*! IP filter for valid originator */
   struct netaddr_acl originator_acl;
+
+  /*! true if dijkstra should repair the last shortest path tree */
+  bool incremental_dijkstra;
+
+  /*! maximum percentage of nodes repaired by incremental dijkstra */
+  int32_t incremental_limit;
 };
 
 /**
@@ -211,6 +218,13 @@ static struct cfg_schema_entry _olsrv2_entries[] = {
     "Filter for router originator addresses (ipv4 and ipv6)"
     " from the interface addresses. Olsrv2 will prefer routable addresses"
     " over linklocal addresses and addresses from loopback over other interfaces."),
+
+  CFG_MAP_BOOL(_config, incremental_dijkstra, "incremental_dijkstra", "false",
+    "Repair the shortest path tree of the last Dijkstra run"
+    " instead of recalculating it from scratch after topology changes"),
+  CFG_MAP_INT32_MINMAX(_config, incremental_limit, "incremental_dijkstra_limit", "25",
+    "Maximum percentage of topology nodes an incremental Dijkstra can repair"
+    " before a full Dijkstra run is used", 0, false, 1, 100),
 };
 
 static struct cfg_schema_section _olsrv2_section = {
@@ -882,7 +896,13 @@ _update_originator(int af_family) {
  * @return always 0
  */
 static int
-_cb_if_event(struct os_interface_listener *if_listener __attribute__((unused))) {
+_cb_if_event(struct os_interface_listener *if_listener) {
+  if ((if_listener->changes
+      & (OS_INTERFACE_CHANGE_ADDRESS | OS_INTERFACE_CHANGE_FLAGS)) == 0) {
+    /* originator only depends on addresses and loopback flag */
+    return 0;
+  }
+
   _update_originator(AF_INET);
   _update_originator(AF_INET6);
   return 0;
@@ -904,6 +924,10 @@ _cb_cfg_olsrv2_changed(void) {
     oonf_timer_set(&_tc_timer, _olsrv2_config.tc_interval);
   }
 
+  /* set dijkstra mode */
+  olsrv2_routing_set_incremental(_olsrv2_config.incremental_dijkstra,
+      _olsrv2_config.incremental_limit);
+
   /* check if we have to change the originators */
   _update_originator(AF_INET);
   _update_originator(AF_INET6);
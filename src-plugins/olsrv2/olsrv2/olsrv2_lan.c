@@ -136,6 +136,7 @@ olsrv2_lan_add(struct nhdp_domain *domain,
   lan_data->distance = distance;
   lan_data->active = true;
   olsrv2_routing_domain_changed(domain, true);
+  olsrv2_routing_increment_generation();
 
   tmp_dist = 0;
   entry->same_distance = true;
@@ -176,6 +177,7 @@ olsrv2_lan_remove(struct nhdp_domain *domain,
   lan_data = olsrv2_lan_get_domaindata(domain, entry);
   lan_data->active = false;
   olsrv2_routing_domain_changed(domain, true);
+  olsrv2_routing_increment_generation();
 
   for (i=0; i<NHDP_MAXIMUM_DOMAINS; i++) {
     if (entry->_domaindata[i].active) {
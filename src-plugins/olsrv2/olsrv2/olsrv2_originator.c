@@ -56,6 +56,7 @@
 #include "nhdp/nhdp.h"
 
 #include "olsrv2/olsrv2_originator.h"
+#include "olsrv2/olsrv2_routing.h"
 #include "olsrv2/olsrv2.h"
 
 /* prototypes */
@@ -221,6 +222,7 @@ _set_originator(int af_type, struct netaddr *setting, const struct netaddr *new_
   }
 
   memcpy(setting, new_originator, sizeof(*setting));
+  olsrv2_routing_increment_generation();
 
   /* remove new_originator originator from set */
   entry = olsrv2_originator_get_entry(new_originator);
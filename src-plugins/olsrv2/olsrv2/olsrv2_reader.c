@@ -319,6 +319,9 @@ _cb_messagetlvs(struct rfc5444_reader_tlvblock_context *context) {
   }
 
   /* overwrite old ansn */
+  if (_current.node->ansn != ansn) {
+    olsrv2_routing_increment_generation();
+  }
   _current.node->ansn = ansn;
 
   /* reset validity time and interval time */
@@ -345,7 +348,9 @@ _cb_addresstlvs(struct rfc5444_reader_tlvblock_context *context __attribute__((u
   struct olsrv2_tc_attachment *end;
   uint32_t cost_in[NHDP_MAXIMUM_DOMAINS];
   uint32_t cost_out[NHDP_MAXIMUM_DOMAINS];
+  uint32_t old_cost[NHDP_MAXIMUM_DOMAINS];
   struct rfc7181_metric_field metric_value;
+  bool cost_changed;
   size_t i;
   struct os_route_key ssprefix;
 
@@ -360,7 +365,9 @@ _cb_addresstlvs(struct rfc5444_reader_tlvblock_context *context __attribute__((u
   for (i=0; i<NHDP_MAXIMUM_DOMAINS; i++) {
     cost_in[i] = RFC7181_METRIC_INFINITE;
     cost_out[i] = RFC7181_METRIC_INFINITE;
+    old_cost[i] = RFC7181_METRIC_INFINITE;
   }
+  cost_changed = false;
 
   OONF_DEBUG(LOG_OLSRV2_R, "Found address in tc: %s",
       netaddr_to_string(&buf, &context->addr));
@@ -393,6 +400,12 @@ _cb_addresstlvs(struct rfc5444_reader_tlvblock_context *context __attribute__((u
   if ((tlv = _olsrv2_address_tlvs[IDX_ADDRTLV_NBR_ADDR_TYPE].tlv)) {
     /* parse originator neighbor */
     if ((tlv->single_value[0] & RFC7181_NBR_ADDR_TYPE_ORIGINATOR) != 0) {
+      /* remember the costs, refreshing an existing edge resets them */
+      edge = avl_find_element(&_current.node->_edges, &context->addr, edge, _node);
+      if (edge) {
+        memcpy(old_cost, edge->cost, sizeof(old_cost));
+      }
+
       edge = olsrv2_tc_edge_add(_current.node, &context->addr);
       if (edge) {
         OONF_DEBUG(LOG_OLSRV2_R, "Address is originator");
@@ -400,22 +413,31 @@ _cb_addresstlvs(struct rfc5444_reader_tlvblock_context *context __attribute__((u
 
         for (i=0; i<NHDP_MAXIMUM_DOMAINS; i++) {
           if (cost_out[i] <= RFC7181_METRIC_MAX) {
-            _current.changed[i] |= (edge->cost[i] != cost_out[i]);
             edge->cost[i] = cost_out[i];
           }
           else if (_current.complete_tc) {
-            _current.changed[i] |= (edge->cost[i] != RFC7181_METRIC_INFINITE);
             edge->cost[i] = RFC7181_METRIC_INFINITE;
           }
+          _current.changed[i] |= (old_cost[i] != edge->cost[i]);
           if (edge->inverse->virtual && cost_in[i] <= RFC7181_METRIC_MAX) {
+            cost_changed |= (edge->inverse->cost[i] != cost_in[i]);
             _current.changed[i] |= (edge->inverse->cost[i] != cost_in[i]);
             edge->inverse->cost[i] = cost_in[i];
           }
           else if (edge->inverse->virtual && _current.complete_tc) {
+            cost_changed |= (edge->inverse->cost[i] != RFC7181_METRIC_INFINITE);
             _current.changed[i] |= (edge->inverse->cost[i] != RFC7181_METRIC_INFINITE);
             edge->inverse->cost[i] = RFC7181_METRIC_INFINITE;
           }
         }
+
+        if (cost_changed || memcmp(old_cost, edge->cost, sizeof(old_cost)) != 0) {
+          olsrv2_routing_increment_generation();
+
+          /* only changed edges have to be checked by the incremental dijkstra */
+          olsrv2_routing_dijkstra_node_changed(_current.node);
+          olsrv2_routing_dijkstra_node_changed(edge->dst);
+        }
       }
     }
     /* parse routable neighbor (which is not an originator) */
@@ -426,14 +448,20 @@ _cb_addresstlvs(struct rfc5444_reader_tlvblock_context *context __attribute__((u
         end->ansn = _current.node->ansn;
         for (i=0; i< NHDP_MAXIMUM_DOMAINS; i++) {
           if (cost_out[i] <= RFC7181_METRIC_MAX) {
+            cost_changed |= (end->cost[i] != cost_out[i]);
             _current.changed[i] |= (end->cost[i] != cost_out[i]);
             end->cost[i] = cost_out[i];
           }
           else if (_current.complete_tc) {
+            cost_changed |= (end->cost[i] != RFC7181_METRIC_INFINITE);
             _current.changed[i] |= (end->cost[i] != RFC7181_METRIC_INFINITE);
             end->cost[i] = RFC7181_METRIC_INFINITE;
           }
         }
+
+        if (cost_changed) {
+          olsrv2_routing_increment_generation();
+        }
       }
     }
   }
@@ -450,6 +478,8 @@ _handle_gateways(struct rfc5444_reader_tlvblock_entry *tlv,
     const struct netaddr *addr) {
   struct olsrv2_tc_attachment *end;
   struct nhdp_domain *domain;
+  uint32_t old_cost[NHDP_MAXIMUM_DOMAINS];
+  uint8_t old_distance[NHDP_MAXIMUM_DOMAINS];
   size_t i;
 
   /* check length */
@@ -490,6 +520,10 @@ _handle_gateways(struct rfc5444_reader_tlvblock_entry *tlv,
 
   end->ansn = _current.node->ansn;
 
+  /* remember metrics to detect changes */
+  memcpy(old_cost, end->cost, sizeof(old_cost));
+  memcpy(old_distance, end->distance, sizeof(old_distance));
+
   if (_current.complete_tc) {
     /* clear unused metrics */
     for (i=0; i<NHDP_MAXIMUM_DOMAINS; i++) {
@@ -517,6 +551,11 @@ _handle_gateways(struct rfc5444_reader_tlvblock_entry *tlv,
     OONF_DEBUG(LOG_OLSRV2_R, "Address is Attached Network (domain %u): dist=%u",
         domain->ext, end->distance[domain->index]);
   }
+
+  if (memcmp(old_cost, end->cost, sizeof(old_cost)) != 0
+      || memcmp(old_distance, end->distance, sizeof(old_distance)) != 0) {
+    olsrv2_routing_increment_generation();
+  }
 }
 
 /**
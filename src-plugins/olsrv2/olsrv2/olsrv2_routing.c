@@ -50,7 +50,9 @@
 #include "common/common_types.h"
 #include "common/list.h"
 #include "common/netaddr.h"
+#include "common/radix_heap.h"
 #include "core/oonf_logging.h"
+#include "core/oonf_trace.h"
 #include "core/os_core.h"
 #include "subsystems/oonf_class.h"
 #include "subsystems/oonf_rfc5444.h"
@@ -69,8 +71,10 @@
 #include "olsrv2/olsrv2.h"
 
 /* Prototypes */
+static void _calculate_domain(struct nhdp_domain *domain);
 static void _run_dijkstra(struct nhdp_domain *domain, int af_family,
     bool use_non_ss, bool use_ss);
+static bool _run_incremental_dijkstra(struct nhdp_domain *domain);
 static struct olsrv2_routing_entry *_add_entry(
     struct nhdp_domain *, struct os_route_key *prefix);
 static void _remove_entry(struct olsrv2_routing_entry *);
@@ -81,9 +85,14 @@ static void _insert_into_working_tree(struct olsrv2_tc_target *target,
     const struct netaddr *last_originator);
 static void _prepare_routes(struct nhdp_domain *);
 static void _prepare_nodes(void);
+static bool _load_spt(struct nhdp_domain *domain, uint32_t *total);
+static void _store_spt(struct nhdp_domain *domain);
+static bool _is_spt_invalid(struct nhdp_domain *, struct olsrv2_tc_node *);
+static void _invalidate_spt(void);
 static bool _check_ssnode_split(struct nhdp_domain *domain, int af_family);
 static void _add_one_hop_nodes(struct nhdp_domain *domain, int family, bool, bool);
-static void _handle_working_queue(struct nhdp_domain *, bool, bool);
+static void _handle_working_queue(struct nhdp_domain *, bool, bool, bool);
+static void _handle_spt_routes(struct nhdp_domain *);
 static void _handle_nhdp_routes(struct nhdp_domain *);
 static void _add_route_to_kernel_queue(struct olsrv2_routing_entry *rtentry);
 static void _process_dijkstra_result(struct nhdp_domain *);
@@ -92,16 +101,25 @@ static void _process_kernel_queue(void);
 static void _cb_mpr_update(struct nhdp_domain *);
 static void _cb_metric_update(struct nhdp_domain *);
 static void _cb_trigger_dijkstra(struct oonf_timer_instance *);
+static void _cb_neighbor_change(void *ptr);
+static void _cb_neighbor_remove(void *ptr);
 
 static void _cb_route_finished(struct os_route *route, int error);
 
+static const char *_cb_entry_to_keystring(struct oonf_objectkey_str *,
+    struct oonf_class *, void *);
+static const char *_cb_entry_to_statestring(struct oonf_objectstate_str *,
+    struct oonf_class *, void *);
+
 /* Domain parameter of dijkstra algorithm */
 static struct olsrv2_routing_domain _domain_parameter[NHDP_MAXIMUM_DOMAINS];
 
 /* memory class for routing entries */
 static struct oonf_class _rtset_entry = {
-  .name = "Olsrv2 Routing Set Entry",
+  .name = OLSRV2_CLASS_ROUTING_ENTRY,
   .size = sizeof(struct olsrv2_routing_entry),
+  .to_keystring = _cb_entry_to_keystring,
+  .to_statestring = _cb_entry_to_statestring,
 };
 
 /* rate limitation for dijkstra algorithm */
@@ -122,19 +140,39 @@ static struct nhdp_domain_listener _nhdp_listener = {
   .metric_update = _cb_metric_update,
 };
 
+/* track removal of first hops stored in the shortest path trees */
+static struct oonf_class_extension _nhdp_neighbor_extension = {
+  .ext_name = "olsrv2_routing spt tracking",
+  .class_name = NHDP_CLASS_NEIGHBOR,
+  .cb_change = _cb_neighbor_change,
+  .cb_remove = _cb_neighbor_remove,
+};
+
 /* status variables for domain changes */
 static uint16_t _ansn;
 static bool _domain_changed[NHDP_MAXIMUM_DOMAINS];
 static bool _update_ansn;
 
+/* generation of topology and routing database, never 0 */
+static uint64_t _generation = 1;
+
 
 /* global datastructures for routing */
 static struct avl_tree _routing_tree[NHDP_MAXIMUM_DOMAINS];
 static struct list_entity _routing_filter_list;
 
-static struct avl_tree _dijkstra_working_tree;
+static struct radix_heap _dijkstra_working_heap;
 static struct list_entity _kernel_queue;
 
+/* state of incremental dijkstra */
+static bool _incremental_spf = false;
+static uint32_t _incremental_limit;
+static bool _spt_valid[NHDP_MAXIMUM_DOMAINS];
+static struct list_entity _spt_dirty_list;
+static uint32_t _touched_count;
+
+static struct olsrv2_routing_statistics _statistics[NHDP_MAXIMUM_DOMAINS];
+
 static bool _initiate_shutdown = false;
 static bool _freeze_routes = false;
 
@@ -154,15 +192,19 @@ olsrv2_routing_init(void) {
   memset(_domain_changed, 0, sizeof(_domain_changed));
   _update_ansn = false;
 
+  memset(_spt_valid, 0, sizeof(_spt_valid));
+  memset(_statistics, 0, sizeof(_statistics));
+  list_init_head(&_spt_dirty_list);
 
   oonf_class_add(&_rtset_entry);
   oonf_timer_add(&_dijkstra_timer_info);
+  oonf_class_extension_add(&_nhdp_neighbor_extension);
 
   for (i=0; i<NHDP_MAXIMUM_DOMAINS; i++) {
     avl_init(&_routing_tree[i], os_routing_avl_cmp_route_key, false);
   }
   list_init_head(&_routing_filter_list);
-  avl_init(&_dijkstra_working_tree, avl_comp_uint32, true);
+  radix_heap_init(&_dijkstra_working_heap);
   list_init_head(&_kernel_queue);
 
   return 0;
@@ -208,7 +250,9 @@ olsrv2_routing_cleanup(void) {
   int i;
 
   nhdp_domain_listener_remove(&_nhdp_listener);
+  oonf_class_extension_remove(&_nhdp_neighbor_extension);
   oonf_timer_stop(&_rate_limit_timer);
+  _invalidate_spt();
 
   for (i=0; i<NHDP_MAXIMUM_DOMAINS; i++) {
     avl_for_each_element_safe(&_routing_tree[i], entry, _node, e_it) {
@@ -233,6 +277,25 @@ olsrv2_routing_get_ansn(void) {
   return _ansn;
 }
 
+/**
+ * The generation changes each time the content of the topology
+ * database or the routing tables changes, so viewers can reuse their
+ * output as long as the generation stays the same.
+ * @return current topology and routing generation
+ */
+uint64_t
+olsrv2_routing_get_generation(void) {
+  return _generation;
+}
+
+/**
+ * Mark the topology or routing database as changed
+ */
+void
+olsrv2_routing_increment_generation(void) {
+  _generation++;
+}
+
 /**
  * Force the answer set number to increase
  * @param increment amount of increase
@@ -275,6 +338,24 @@ olsrv2_routing_freeze_routes(bool freeze) {
   }
 }
 
+/**
+ * Configure the incremental dijkstra calculation
+ * @param incremental true to repair the shortest path tree of the
+ *   last dijkstra run instead of recalculating it from scratch
+ * @param limit maximum percentage of tc nodes that can be repaired
+ *   before a full dijkstra run is used
+ */
+void
+olsrv2_routing_set_incremental(bool incremental, uint32_t limit) {
+  _incremental_limit = limit;
+  if (_incremental_spf == incremental) {
+    return;
+  }
+
+  _incremental_spf = incremental;
+  _invalidate_spt();
+}
+
 /**
  * @param domain nhdp domain
  * @return routing domain parameters
@@ -311,13 +392,15 @@ olsrv2_routing_domain_changed(struct nhdp_domain *domain, bool autoupdate_ansn)
 void
 olsrv2_routing_force_update(bool skip_wait) {
   struct nhdp_domain *domain;
-  bool splitv4, splitv6;
 
   if (_initiate_shutdown || _freeze_routes) {
     /* no dijkstra anymore when in shutdown */
     return;
   }
 
+  /* dijkstra needs the current neighbor metrics */
+  nhdp_domain_process_metric_changes();
+
   /* handle dijkstra rate limitation timer */
   if (oonf_timer_is_active(&_rate_limit_timer)) {
     if (!skip_wait) {
@@ -346,33 +429,7 @@ olsrv2_routing_force_update(bool skip_wait) {
     }
     _domain_changed[domain->index] = false;
 
-    /* initialize dijkstra specific fields */
-    _prepare_routes(domain);
-    _prepare_nodes();
-
-    /* run IPv4 dijkstra (might be two times because of source-specific data) */
-    splitv4 = _check_ssnode_split(domain, AF_INET);
-    _run_dijkstra(domain, AF_INET, true, !splitv4);
-
-    /* run IPv6 dijkstra (might be two times because of source-specific data) */
-    splitv6 = _check_ssnode_split(domain, AF_INET6);
-    _run_dijkstra(domain, AF_INET6, true, !splitv6);
-
-    /* handle source-specific sub-topology if necessary */
-    if (splitv4 || splitv6) {
-      /* re-initialize dijkstra specific node fields */
-      _prepare_nodes();
-
-      if (splitv4) {
-        _run_dijkstra(domain, AF_INET, false, true);
-      }
-      if (splitv6) {
-        _run_dijkstra(domain, AF_INET6, false, true);
-      }
-    }
-
-    /* check if direct one-hop routes are quicker */
-    _handle_nhdp_routes(domain);
+    _calculate_domain(domain);
 
     /* update kernel routes */
     _process_dijkstra_result(domain);
@@ -392,10 +449,50 @@ olsrv2_routing_force_update(bool skip_wait) {
 void
 olsrv2_routing_dijkstra_node_init(struct olsrv2_dijkstra_node *dijkstra,
     const struct netaddr *originator) {
-  dijkstra->_node.key = &dijkstra->path_cost;
   dijkstra->originator = originator;
 }
 
+/**
+ * Remember that the edges of a tc node changed, so the incremental
+ * dijkstra has to check its neighbors.
+ * Should normally not be called by other parts of OLSRv2.
+ * @param node tc node
+ */
+void
+olsrv2_routing_dijkstra_node_changed(struct olsrv2_tc_node *node) {
+  int i;
+
+  if (!_incremental_spf) {
+    return;
+  }
+
+  for (i=0; i<NHDP_MAXIMUM_DOMAINS; i++) {
+    if (_spt_valid[i]) {
+      node->_spt_dirty |= (1 << i);
+    }
+  }
+
+  if (node->_spt_dirty != 0 && !list_is_node_added(&node->_spt_dirty_node)) {
+    list_add_tail(&_spt_dirty_list, &node->_spt_dirty_node);
+  }
+}
+
+/**
+ * Remove all references to a tc node before it is freed.
+ * Should normally not be called by other parts of OLSRv2.
+ * @param node tc node
+ */
+void
+olsrv2_routing_dijkstra_node_remove(struct olsrv2_tc_node *node) {
+  if (list_is_node_added(&node->_spt_dirty_node)) {
+    list_remove(&node->_spt_dirty_node);
+  }
+  node->_spt_dirty = 0;
+
+  /* other nodes might use this one as their parent */
+  memset(_spt_valid, 0, sizeof(_spt_valid));
+}
+
 /**
  * Set the domain parameters of olsrv2
  * @param domain pointer to NHDP domain
@@ -451,6 +548,16 @@ olsrv2_routing_get_tree(struct nhdp_domain *domain) {
   return &_routing_tree[domain->index];
 }
 
+/**
+ * Get statistics of the dijkstra calculation
+ * @param domain nhdp domain
+ * @return dijkstra statistics of domain
+ */
+const struct olsrv2_routing_statistics *
+olsrv2_routing_get_statistics(struct nhdp_domain *domain) {
+  return &_statistics[domain->index];
+}
+
 /**
  * Get list of olsrv2 routing filters
  * @return filter list
@@ -500,6 +607,67 @@ _cb_metric_update(struct nhdp_domain *domain) {
   olsrv2_routing_trigger_update();
 }
 
+/**
+ * Calculate the shortest path tree and the routing entries of a domain
+ * @param domain nhdp domain
+ */
+static void
+_calculate_domain(struct nhdp_domain *domain) {
+  bool splitv4, splitv6;
+
+  /* initialize dijkstra specific fields */
+  _prepare_routes(domain);
+  _touched_count = 0;
+
+  splitv4 = _check_ssnode_split(domain, AF_INET);
+  splitv6 = _check_ssnode_split(domain, AF_INET6);
+
+  if (splitv4 || splitv6 || !_run_incremental_dijkstra(domain)) {
+    _prepare_nodes();
+
+    /* run IPv4 dijkstra (might be two times because of source-specific data) */
+    _run_dijkstra(domain, AF_INET, true, !splitv4);
+
+    /* run IPv6 dijkstra (might be two times because of source-specific data) */
+    _run_dijkstra(domain, AF_INET6, true, !splitv6);
+
+    /* handle source-specific sub-topology if necessary */
+    if (splitv4 || splitv6) {
+      /* the shortest path tree is split, it cannot be repaired */
+      _spt_valid[domain->index] = false;
+
+      /* re-initialize dijkstra specific node fields */
+      _prepare_nodes();
+
+      if (splitv4) {
+        _run_dijkstra(domain, AF_INET, false, true);
+      }
+      if (splitv6) {
+        _run_dijkstra(domain, AF_INET6, false, true);
+      }
+    }
+    else if (_incremental_spf) {
+      /* remember shortest path tree for the next run */
+      _store_spt(domain);
+    }
+
+    _statistics[domain->index].full_runs++;
+    _statistics[domain->index].last_incremental = false;
+    _statistics[domain->index].last_total = olsrv2_tc_get_tree()->count;
+  }
+
+  _statistics[domain->index].last_touched = _touched_count;
+  _statistics[domain->index].total_touched += _touched_count;
+
+  OONF_INFO(LOG_OLSRV2_ROUTING, "%s dijkstra on domain %u touched %u of %u nodes",
+      _statistics[domain->index].last_incremental ? "Incremental" : "Full",
+      domain->index, _statistics[domain->index].last_touched,
+      _statistics[domain->index].last_total);
+
+  /* check if direct one-hop routes are quicker */
+  _handle_nhdp_routes(domain);
+}
+
 /**
  * Run Dijkstra for a set domain, address family and
  * (non-)source-specific nodes
@@ -519,11 +687,146 @@ _run_dijkstra(struct nhdp_domain *domain, int af_family,
   _add_one_hop_nodes(domain, af_family, use_non_ss, use_ss);
 
   /* run dijkstra */
-  while (!avl_is_empty(&_dijkstra_working_tree)) {
-    _handle_working_queue(domain, use_non_ss, use_ss);
+  while (!radix_heap_is_empty(&_dijkstra_working_heap)) {
+    _handle_working_queue(domain, use_non_ss, use_ss, true);
   }
 }
 
+/**
+ * Repair the shortest path tree of the last dijkstra run of a domain.
+ * Only nodes whose path became invalid or might have become shorter
+ * are processed again.
+ * @param domain nhdp domain
+ * @return true if dijkstra was calculated incrementally, false
+ *   if a full dijkstra run is necessary
+ */
+static bool
+_run_incremental_dijkstra(struct nhdp_domain *domain) {
+  struct olsrv2_tc_node *node, *src, *n_it;
+  struct olsrv2_tc_edge *edge;
+  struct nhdp_neighbor *neigh;
+  struct nhdp_neighbor_domaindata *neigh_metric;
+  uint32_t affected, total;
+
+  if (!_incremental_spf || !_spt_valid[domain->index]) {
+    return false;
+  }
+
+  /* initialize dijkstra data with the last shortest path tree */
+  if (!_load_spt(domain, &total)) {
+    return false;
+  }
+
+  /* find all nodes that lost their path */
+  affected = 0;
+  avl_for_each_element(olsrv2_tc_get_tree(), node, _originator_node) {
+    if (_is_spt_invalid(domain, node)) {
+      affected++;
+    }
+  }
+
+  if (affected * 100 > _incremental_limit * total) {
+    OONF_INFO(LOG_OLSRV2_ROUTING, "Incremental dijkstra on domain %u"
+        " would repair %u of %u nodes, do full run",
+        domain->index, affected, total);
+    return false;
+  }
+
+  OONF_DEBUG(LOG_OLSRV2_ROUTING, "Repair %u of %u nodes of domain %u",
+      affected, total, domain->index);
+
+  /* reset all invalid nodes */
+  avl_for_each_element(olsrv2_tc_get_tree(), node, _originator_node) {
+    if (node->target._dijkstra.invalid) {
+      node->target._dijkstra.first_hop = NULL;
+      node->target._dijkstra.path_cost = RFC7181_METRIC_INFINITE_PATH;
+      node->target._dijkstra.path_hops = 255;
+    }
+  }
+
+  /* add best remaining path of invalid nodes to working queue */
+  avl_for_each_element(olsrv2_tc_get_tree(), node, _originator_node) {
+    if (!node->target._dijkstra.invalid) {
+      continue;
+    }
+
+    avl_for_each_element(&node->_edges, edge, _node) {
+      /* inverse edge is the incoming edge of the node */
+      src = edge->dst;
+      if (edge->inverse->virtual
+          || src->target._dijkstra.invalid
+          || src->target._dijkstra.first_hop == NULL) {
+        continue;
+      }
+
+      _insert_into_working_tree(&node->target,
+          src->target._dijkstra.first_hop,
+          edge->inverse->cost[domain->index],
+          src->target._dijkstra.path_cost, src->target._dijkstra.path_hops,
+          0, false, &src->target.prefix.dst);
+    }
+  }
+
+  /* check for better paths through changed one-hop links */
+  list_for_each_element(nhdp_db_get_neigh_list(), neigh, _global_node) {
+    if (neigh->symmetric == 0
+        || (node = olsrv2_tc_node_get(&neigh->originator)) == NULL) {
+      continue;
+    }
+
+    neigh_metric = nhdp_domain_get_neighbordata(domain, neigh);
+    if (neigh_metric->metric.in > RFC7181_METRIC_MAX
+        || neigh_metric->metric.out > RFC7181_METRIC_MAX) {
+      continue;
+    }
+
+    _insert_into_working_tree(&node->target, neigh,
+        neigh_metric->metric.out, 0, 0, 0, true,
+        olsrv2_originator_get(netaddr_get_address_family(&neigh->originator)));
+  }
+
+  /* check for better paths through changed tc edges */
+  list_for_each_element_safe(&_spt_dirty_list, src, _spt_dirty_node, n_it) {
+    if ((src->_spt_dirty & (1 << domain->index)) == 0) {
+      continue;
+    }
+
+    src->_spt_dirty &= ~(1 << domain->index);
+    if (src->_spt_dirty == 0) {
+      list_remove(&src->_spt_dirty_node);
+    }
+
+    if (src->target._dijkstra.invalid
+        || src->target._dijkstra.first_hop == NULL) {
+      /* node will be processed by the working queue */
+      continue;
+    }
+
+    avl_for_each_element(&src->_edges, edge, _node) {
+      if (!edge->virtual) {
+        _insert_into_working_tree(&edge->dst->target,
+            src->target._dijkstra.first_hop, edge->cost[domain->index],
+            src->target._dijkstra.path_cost, src->target._dijkstra.path_hops,
+            0, false, &src->target.prefix.dst);
+      }
+    }
+  }
+
+  /* repair shortest path tree */
+  while (!radix_heap_is_empty(&_dijkstra_working_heap)) {
+    _handle_working_queue(domain, true, true, false);
+  }
+
+  /* remember repaired tree and generate routing entries */
+  _store_spt(domain);
+  _handle_spt_routes(domain);
+
+  _statistics[domain->index].incremental_runs++;
+  _statistics[domain->index].last_incremental = true;
+  _statistics[domain->index].last_total = total;
+  return true;
+}
+
 /**
  * Add a new routing entry to the database
  * @param domain pointer to nhdp domain
@@ -561,6 +864,9 @@ _add_entry(struct nhdp_domain *domain, struct os_route_key *prefix) {
   rtentry->route.p.type = OS_ROUTE_UNICAST;
 
   avl_insert(&_routing_tree[domain->index], &rtentry->_node);
+  _generation++;
+
+  oonf_class_event(&_rtset_entry, rtentry, OONF_OBJECT_ADDED);
   return rtentry;
 }
 
@@ -574,9 +880,12 @@ _remove_entry(struct olsrv2_routing_entry *entry) {
   entry->route.cb_finished = NULL;
   os_routing_interrupt(&entry->route);
 
+  oonf_class_event(&_rtset_entry, entry, OONF_OBJECT_REMOVED);
+
   /* remove entry from database */
   avl_remove(&_routing_tree[entry->domain->index], &entry->_node);
   oonf_class_free(&_rtset_entry, entry);
+  _generation++;
 }
 
 /**
@@ -597,6 +906,7 @@ _insert_into_working_tree(struct olsrv2_tc_target *target,
     uint8_t distance, bool single_hop,
     const struct netaddr *last_originator) {
   struct olsrv2_dijkstra_node *node;
+  int cmp;
 #ifdef OONF_LOG_DEBUG_INFO
   struct netaddr_str nbuf1, nbuf2;
 #endif
@@ -618,18 +928,26 @@ _insert_into_working_tree(struct olsrv2_tc_target *target,
   path_cost += link_cost;
   path_hops += 1;
 
-  if (avl_is_node_added(&node->_node)) {
-    /* node already in dijkstra working queue */
+  if (node->path_cost < path_cost) {
+    /* current path is shorter than new one */
+    return;
+  }
 
-    if (node->path_cost <= path_cost) {
-      /* current path is shorter than new one */
+  if (node->path_cost == path_cost) {
+    /*
+     * equal cost paths are decided by the lower originator of the
+     * predecessor, so full and incremental dijkstra build the same tree
+     */
+    cmp = netaddr_cmp(last_originator, node->last_originator);
+    if (cmp > 0) {
+      return;
+    }
+    if (cmp == 0 && node->first_hop == neigh && node->path_hops == path_hops) {
+      /* same path as before */
       return;
     }
-
-    /* we found a better path, remove node from working queue */
-    avl_remove(&_dijkstra_working_tree, &node->_node);
   }
-  
+
   OONF_DEBUG(LOG_OLSRV2_ROUTING, "Add dst %s [%s] with pathcost %u to dijstra tree (0x%zx)",
           netaddr_to_string(&nbuf1, &target->prefix.dst),
           netaddr_to_string(&nbuf2, &target->prefix.src), path_cost,
@@ -642,7 +960,18 @@ _insert_into_working_tree(struct olsrv2_tc_target *target,
   node->single_hop = single_hop;
   node->last_originator = last_originator;
 
-  avl_insert(&_dijkstra_working_tree, &node->_node);
+  if (target->type != OLSRV2_NODE_TARGET) {
+    /* attached networks and addresses belong to the last originator */
+    node->originator = last_originator;
+  }
+
+  if (radix_heap_is_node_added(&node->_node)) {
+    /* we found a better path, move node within working queue */
+    radix_heap_decrease_key(&_dijkstra_working_heap, &node->_node, path_cost);
+  }
+  else {
+    radix_heap_insert(&_dijkstra_working_heap, &node->_node, path_cost);
+  }
   return;
 }
 
@@ -764,6 +1093,13 @@ _prepare_routes(struct nhdp_domain *domain) {
   avl_for_each_element(&_routing_tree[domain->index], rtentry, _node) {
     rtentry->set = false;
     memcpy(&rtentry->_old, &rtentry->route.p, sizeof(rtentry->_old));
+
+    rtentry->_old_path_cost = rtentry->path_cost;
+    rtentry->_old_path_hops = rtentry->path_hops;
+    memcpy(&rtentry->_old_originator, &rtentry->originator,
+        sizeof(rtentry->_old_originator));
+    memcpy(&rtentry->_old_last_originator, &rtentry->last_originator,
+        sizeof(rtentry->_old_last_originator));
   }
 }
 
@@ -794,6 +1130,165 @@ _prepare_nodes(void) {
   }
 }
 
+/**
+ * Initialize internal fields for dijkstra calculation with the
+ * stored shortest path tree of a domain
+ * @param domain nhdp domain
+ * @param total pointer to counter for the number of tc nodes
+ * @return false if the stored tree cannot be used anymore
+ */
+static bool
+_load_spt(struct nhdp_domain *domain, uint32_t *total) {
+  struct olsrv2_dijkstra_spt *spt;
+  struct olsrv2_tc_endpoint *end;
+  struct olsrv2_tc_node *node;
+  int family;
+  bool local;
+
+  *total = 0;
+  avl_for_each_element(olsrv2_tc_get_tree(), node, _originator_node) {
+    spt = &node->_spt[domain->index];
+    family = netaddr_get_address_family(&node->target.prefix.dst);
+
+    local = olsrv2_originator_is_local(&node->target.prefix.dst);
+    if (local != spt->local) {
+      /* originator set changed */
+      return false;
+    }
+
+    node->target._dijkstra.local = local;
+    node->target._dijkstra.first_hop = spt->first_hop;
+    node->target._dijkstra.path_cost = spt->path_cost;
+    node->target._dijkstra.path_hops = spt->path_hops;
+    node->target._dijkstra.distance = 0;
+    node->target._dijkstra.single_hop = spt->parent == NULL;
+    node->target._dijkstra.last_originator = spt->parent == NULL
+        ? olsrv2_originator_get(family) : &spt->parent->target.prefix.dst;
+    node->target._dijkstra.done = false;
+    node->target._dijkstra.invalid = false;
+    node->target._dijkstra.checked = false;
+
+    (*total)++;
+  }
+
+  avl_for_each_element(olsrv2_tc_get_endpoint_tree(), end, _node) {
+    end->target._dijkstra.first_hop = NULL;
+    end->target._dijkstra.path_cost = RFC7181_METRIC_INFINITE_PATH;
+    end->target._dijkstra.path_hops = 255;
+    end->target._dijkstra.done = false;
+  }
+  return true;
+}
+
+/**
+ * Store the shortest path tree of the last dijkstra run
+ * @param domain nhdp domain
+ */
+static void
+_store_spt(struct nhdp_domain *domain) {
+  struct olsrv2_dijkstra_spt *spt;
+  struct olsrv2_tc_node *node, *n_it;
+
+  avl_for_each_element(olsrv2_tc_get_tree(), node, _originator_node) {
+    spt = &node->_spt[domain->index];
+
+    spt->first_hop = node->target._dijkstra.first_hop;
+    spt->path_cost = node->target._dijkstra.path_cost;
+    spt->path_hops = node->target._dijkstra.path_hops;
+    spt->local = node->target._dijkstra.local;
+
+    if (spt->first_hop == NULL || node->target._dijkstra.single_hop) {
+      spt->parent = NULL;
+    }
+    else {
+      /* last originator is the originator of the parent tc node */
+      spt->parent = container_of(node->target._dijkstra.last_originator,
+          struct olsrv2_tc_node, target.prefix.dst);
+    }
+  }
+
+  /* all edge changes have been processed for this domain */
+  list_for_each_element_safe(&_spt_dirty_list, node, _spt_dirty_node, n_it) {
+    node->_spt_dirty &= ~(1 << domain->index);
+    if (node->_spt_dirty == 0) {
+      list_remove(&node->_spt_dirty_node);
+    }
+  }
+
+  _spt_valid[domain->index] = true;
+}
+
+/**
+ * Check if the path of a tc node in the stored shortest path tree
+ * is still valid. A path is invalid if one of its edges vanished
+ * or changed its cost.
+ * @param domain nhdp domain
+ * @param node tc node
+ * @return true if node path is invalid
+ */
+static bool
+_is_spt_invalid(struct nhdp_domain *domain, struct olsrv2_tc_node *node) {
+  struct nhdp_neighbor_domaindata *neigh_metric;
+  struct olsrv2_dijkstra_spt *spt;
+  struct olsrv2_tc_edge *edge;
+  struct nhdp_neighbor *neigh;
+  struct olsrv2_tc_node *parent;
+
+  if (node->target._dijkstra.checked) {
+    return node->target._dijkstra.invalid;
+  }
+  node->target._dijkstra.checked = true;
+
+  spt = &node->_spt[domain->index];
+  if (spt->first_hop == NULL) {
+    /* node was not reachable, nothing to repair */
+    return false;
+  }
+
+  parent = spt->parent;
+  if (parent == NULL) {
+    /* one-hop node, check link to neighbor */
+    neigh = spt->first_hop;
+    neigh_metric = nhdp_domain_get_neighbordata(domain, neigh);
+
+    node->target._dijkstra.invalid = neigh->symmetric == 0
+        || neigh_metric->metric.in > RFC7181_METRIC_MAX
+        || neigh_metric->metric.out > RFC7181_METRIC_MAX
+        || neigh_metric->metric.out != spt->path_cost;
+  }
+  else if (_is_spt_invalid(domain, parent)) {
+    /* path to parent is broken */
+    node->target._dijkstra.invalid = true;
+  }
+  else {
+    /* check edge from parent to node */
+    edge = avl_find_element(&parent->_edges,
+        &node->target.prefix.dst, edge, _node);
+
+    node->target._dijkstra.invalid = edge == NULL
+        || edge->virtual
+        || edge->cost[domain->index] > RFC7181_METRIC_MAX
+        || parent->_spt[domain->index].path_cost
+            + edge->cost[domain->index] != spt->path_cost;
+  }
+  return node->target._dijkstra.invalid;
+}
+
+/**
+ * Invalidate the stored shortest path trees of all domains
+ */
+static void
+_invalidate_spt(void) {
+  struct olsrv2_tc_node *node, *n_it;
+
+  memset(_spt_valid, 0, sizeof(_spt_valid));
+
+  list_for_each_element_safe(&_spt_dirty_list, node, _spt_dirty_node, n_it) {
+    node->_spt_dirty = 0;
+    list_remove(&node->_spt_dirty_node);
+  }
+}
+
 /**
  * calculates if source- and non-source-specific targets must be done
  * in separate dijkstra runs
@@ -888,10 +1383,12 @@ _add_one_hop_nodes(struct nhdp_domain *domain, int af_family,
  * @param domain nhdp domain
  * @param use_non_ss include non-source-specific nodes into working list
  * @param use_ss include source-specific nodes into working list
+ * @param update_routes true to fill routing entries and process
+ *   attached networks, false to only calculate the tree of tc nodes
  */
 static void
 _handle_working_queue(struct nhdp_domain *domain,
-    bool use_non_ss, bool use_ss) {
+    bool use_non_ss, bool use_ss, bool update_routes) {
   struct olsrv2_tc_target *target;
   struct nhdp_neighbor *first_hop;
   struct olsrv2_tc_node *tc_node;
@@ -903,20 +1400,20 @@ _handle_working_queue(struct nhdp_domain *domain,
   struct netaddr_str nbuf1, nbuf2;
 #endif
 
-  /* get tc target */
-  target = avl_first_element(&_dijkstra_working_tree, target, _dijkstra._node);
+  /* get tc target and remove it from working queue */
+  target = radix_heap_extract_min_element(
+      &_dijkstra_working_heap, target, _dijkstra._node);
 
-  /* remove current node from working tree */
   OONF_DEBUG(LOG_OLSRV2_ROUTING, "Remove node %s [%s] from dijkstra tree",
       netaddr_to_string(&nbuf1, &target->prefix.dst),
       netaddr_to_string(&nbuf2, &target->prefix.src));
-  avl_remove(&_dijkstra_working_tree, &target->_dijkstra._node);
 
   /* mark current node as done */
   target->_dijkstra.done = true;
+  _touched_count++;
 
   /* fill routing entry with dijkstra result */
-  if (use_non_ss) {
+  if (use_non_ss && update_routes) {
     _update_routing_entry(domain, &target->prefix,
         target->_dijkstra.originator,
         target->_dijkstra.first_hop,
@@ -949,6 +1446,10 @@ _handle_working_queue(struct nhdp_domain *domain,
       }
     }
 
+    if (!update_routes) {
+      return;
+    }
+
     /* iterate over attached networks and addresses */
     avl_for_each_element(&tc_node->_attached_networks, tc_attached, _src_node) {
       if (tc_attached->cost[domain->index] <= RFC7181_METRIC_MAX) {
@@ -959,7 +1460,7 @@ _handle_working_queue(struct nhdp_domain *domain,
           /* filter out (non-)source-specific targets if necessary */
           continue;
         }
-        if (tc_endpoint->_attached_networks.count > 1) {
+        if (tc_endpoint->shared) {
           /* add attached network or address to working tree */
           _insert_into_working_tree(&tc_attached->dst->target, first_hop,
               tc_attached->cost[domain->index],
@@ -984,6 +1485,66 @@ _handle_working_queue(struct nhdp_domain *domain,
   }
 }
 
+/**
+ * Fill routing entries from the (repaired) shortest path tree
+ * of the incremental dijkstra
+ * @param domain nhdp domain
+ */
+static void
+_handle_spt_routes(struct nhdp_domain *domain) {
+  struct olsrv2_tc_attachment *tc_attached;
+  struct olsrv2_tc_endpoint *tc_endpoint;
+  struct olsrv2_dijkstra_node *dijkstra;
+  struct olsrv2_tc_node *tc_node;
+  uint32_t path_cost;
+
+  avl_for_each_element(olsrv2_tc_get_tree(), tc_node, _originator_node) {
+    dijkstra = &tc_node->target._dijkstra;
+    if (dijkstra->first_hop == NULL) {
+      /* node is not reachable */
+      continue;
+    }
+
+    _update_routing_entry(domain, &tc_node->target.prefix,
+        dijkstra->originator, dijkstra->first_hop, dijkstra->distance,
+        dijkstra->path_cost, dijkstra->path_hops,
+        dijkstra->single_hop, dijkstra->last_originator);
+
+    /* calculate best path to attached networks and addresses */
+    avl_for_each_element(&tc_node->_attached_networks, tc_attached, _src_node) {
+      if (tc_attached->cost[domain->index] > RFC7181_METRIC_MAX) {
+        continue;
+      }
+
+      tc_endpoint = tc_attached->dst;
+      path_cost = dijkstra->path_cost + tc_attached->cost[domain->index];
+      if (tc_endpoint->target._dijkstra.path_cost <= path_cost) {
+        continue;
+      }
+
+      tc_endpoint->target._dijkstra.originator = &tc_node->target.prefix.dst;
+      tc_endpoint->target._dijkstra.path_cost = path_cost;
+      tc_endpoint->target._dijkstra.path_hops = dijkstra->path_hops + 1;
+      tc_endpoint->target._dijkstra.first_hop = dijkstra->first_hop;
+      tc_endpoint->target._dijkstra.distance = tc_attached->distance[domain->index];
+      tc_endpoint->target._dijkstra.single_hop = false;
+      tc_endpoint->target._dijkstra.last_originator = &tc_node->target.prefix.dst;
+    }
+  }
+
+  avl_for_each_element(olsrv2_tc_get_endpoint_tree(), tc_endpoint, _node) {
+    dijkstra = &tc_endpoint->target._dijkstra;
+    if (dijkstra->first_hop == NULL) {
+      continue;
+    }
+
+    _update_routing_entry(domain, &tc_endpoint->target.prefix,
+        dijkstra->originator, dijkstra->first_hop, dijkstra->distance,
+        dijkstra->path_cost, dijkstra->path_hops,
+        false, dijkstra->last_originator);
+  }
+}
+
 /**
  * Add routes learned from nhdp to dijkstra results
  * @param domain nhdp domain
@@ -1150,6 +1711,14 @@ _process_dijkstra_result(struct nhdp_domain *domain) {
           "Ignore route change: %s -> %s",
           os_routing_to_string(&rbuf1, &rtentry->_old),
           os_routing_to_string(&rbuf2, &rtentry->route.p));
+
+      /* kernel route is the same, but the path towards it might not be */
+      if (rtentry->path_cost != rtentry->_old_path_cost
+          || rtentry->path_hops != rtentry->_old_path_hops
+          || netaddr_cmp(&rtentry->originator, &rtentry->_old_originator) != 0
+          || netaddr_cmp(&rtentry->last_originator, &rtentry->_old_last_originator) != 0) {
+        _generation++;
+      }
       continue;
     }
     _add_route_to_kernel_queue(rtentry);
@@ -1174,6 +1743,16 @@ _process_kernel_queue(void) {
 
     /* mark route as in kernel processing */
     rtentry->in_processing = true;
+    _generation++;
+
+    OONF_TRACE_DEBUG(LOG_OLSRV2_ROUTING, "%s route %s (src %s) via %s on if %u: metric=%d table=%u",
+        OONF_TRACE_STRING(rtentry->set ? "Set" : "Remove"),
+        OONF_TRACE_NETADDR(&rtentry->route.p.key.dst),
+        OONF_TRACE_NETADDR(&rtentry->route.p.key.src),
+        OONF_TRACE_NETADDR(&rtentry->route.p.gw),
+        OONF_TRACE_U32(rtentry->route.p.if_index),
+        OONF_TRACE_S32(rtentry->route.p.metric),
+        OONF_TRACE_U32(rtentry->route.p.table));
 
     if (rtentry->set) {
       /* add to kernel */
@@ -1181,6 +1760,7 @@ _process_kernel_queue(void) {
         OONF_WARN(LOG_OLSRV2_ROUTING, "Could not set route %s",
             os_routing_to_string(&rbuf, &rtentry->route.p));
       }
+      oonf_class_event(&_rtset_entry, rtentry, OONF_OBJECT_CHANGED);
     }
     else  {
       /* remove from kernel */
@@ -1246,6 +1826,7 @@ _cb_route_finished(struct os_route *route, int error) {
     }
     else {
       rtentry->set = true;
+      _generation++;
     }
     return;
   }
@@ -1260,3 +1841,86 @@ _cb_route_finished(struct os_route *route, int error) {
     _remove_entry(rtentry);
   }
 }
+
+/**
+ * Callback for changed NHDP neighbors
+ * @param ptr nhdp neighbor
+ */
+static void
+_cb_neighbor_change(void *ptr) {
+  struct nhdp_neighbor *neigh;
+
+  neigh = ptr;
+  if (memcmp(&neigh->originator, &neigh->_old_originator,
+      sizeof(neigh->originator)) != 0) {
+    /* first hop of stored shortest path trees changed */
+    _invalidate_spt();
+  }
+  _generation++;
+}
+
+/**
+ * Callback for removed NHDP neighbors
+ * @param ptr nhdp neighbor
+ */
+static void
+_cb_neighbor_remove(void *ptr __attribute__((unused))) {
+  /* stored shortest path trees might reference neighbor */
+  _invalidate_spt();
+  _generation++;
+}
+
+/**
+ * Keystring creator for routing set entries
+ * @param buf pointer to target buffer
+ * @param class routing entry class
+ * @param ptr pointer to routing entry
+ * @return pointer to target buffer
+ */
+static const char *
+_cb_entry_to_keystring(struct oonf_objectkey_str *buf,
+    struct oonf_class *class __attribute__((unused)), void *ptr) {
+  struct olsrv2_routing_entry *rtentry = ptr;
+  struct netaddr_str nbuf1, nbuf2;
+
+  if (netaddr_get_prefix_length(&rtentry->route.p.key.src) > 0) {
+    snprintf(buf->buf, sizeof(*buf), "%u::%s::%s",
+        rtentry->domain->ext,
+        netaddr_to_string(&nbuf1, &rtentry->route.p.key.dst),
+        netaddr_to_string(&nbuf2, &rtentry->route.p.key.src));
+  }
+  else {
+    snprintf(buf->buf, sizeof(*buf), "%u::%s",
+        rtentry->domain->ext,
+        netaddr_to_string(&nbuf1, &rtentry->route.p.key.dst));
+  }
+  return buf->buf;
+}
+
+/**
+ * Statestring creator for routing entries
+ * @param buf pointer to target buffer
+ * @param class routing entry class
+ * @param ptr pointer to routing entry
+ * @return pointer to target buffer
+ */
+static const char *
+_cb_entry_to_statestring(struct oonf_objectstate_str *buf,
+    struct oonf_class *class __attribute__((unused)), void *ptr) {
+  struct olsrv2_routing_entry *rtentry = ptr;
+  struct netaddr_str nbuf;
+
+  buf->buf[0] = 0;
+  oonf_class_append_state(buf, "next_hop", "%s",
+      netaddr_to_string(&nbuf, &rtentry->route.p.gw));
+  oonf_class_append_state(buf, "if_index", "%u", rtentry->route.p.if_index);
+  oonf_class_append_state(buf, "cost", "%u", rtentry->path_cost);
+  oonf_class_append_state(buf, "hopcount", "%u", rtentry->path_hops);
+  oonf_class_append_state(buf, "originator", "%s",
+      netaddr_to_string(&nbuf, &rtentry->originator));
+  oonf_class_append_state(buf, "next_originator", "%s",
+      netaddr_to_string(&nbuf, &rtentry->next_originator));
+  oonf_class_append_state(buf, "last_originator", "%s",
+      netaddr_to_string(&nbuf, &rtentry->last_originator));
+  return buf->buf;
+}
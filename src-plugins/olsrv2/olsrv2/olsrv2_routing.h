@@ -50,6 +50,7 @@
 #include "common/common_types.h"
 #include "common/list.h"
 #include "common/netaddr.h"
+#include "common/radix_heap.h"
 
 #include "subsystems/os_routing.h"
 
@@ -57,15 +58,20 @@
 #include "nhdp/nhdp_db.h"
 #include "nhdp/nhdp_domain.h"
 
+/*! memory class for routing set entries */
+#define OLSRV2_CLASS_ROUTING_ENTRY "Olsrv2 Routing Set Entry"
+
 /*! minimum time between two dijkstra calculations in milliseconds */
 enum { OLSRv2_DIJKSTRA_RATE_LIMITATION = 1000 };
 
+struct olsrv2_tc_node;
+
 /**
  * representation of a node in the dijkstra tree
  */
 struct olsrv2_dijkstra_node {
-  /*! hook into the working list of the dijkstra */
-  struct avl_node _node;
+  /*! hook into the working queue of the dijkstra */
+  struct radix_heap_node _node;
 
   /*! total path cost */
   uint32_t path_cost;
@@ -96,6 +102,56 @@ struct olsrv2_dijkstra_node {
 
   /*! true if node already has been processed */
   bool done;
+
+  /*! true if the stored shortest path tree path of the node became invalid */
+  bool invalid;
+
+  /*! true if the invalid flag has been calculated for the current run */
+  bool checked;
+};
+
+/**
+ * shortest path tree data of a tc node that is kept between
+ * two dijkstra runs to allow incremental recalculation
+ */
+struct olsrv2_dijkstra_spt {
+  /*! predecessor in the shortest path tree, NULL for one-hop nodes */
+  struct olsrv2_tc_node *parent;
+
+  /*! first hop towards the node, NULL if node was unreachable */
+  struct nhdp_neighbor *first_hop;
+
+  /*! total path cost */
+  uint32_t path_cost;
+
+  /*! path hops to the target */
+  uint8_t path_hops;
+
+  /*! true if node was a local originator */
+  bool local;
+};
+
+/**
+ * statistics of the dijkstra calculation of a domain
+ */
+struct olsrv2_routing_statistics {
+  /*! number of full dijkstra runs */
+  uint32_t full_runs;
+
+  /*! number of incremental dijkstra runs */
+  uint32_t incremental_runs;
+
+  /*! number of nodes processed by the last dijkstra run */
+  uint32_t last_touched;
+
+  /*! number of tc nodes in the topology during the last dijkstra run */
+  uint32_t last_total;
+
+  /*! true if the last dijkstra run was incremental */
+  bool last_incremental;
+
+  /*! sum of processed nodes of all dijkstra runs */
+  uint64_t total_touched;
 };
 
 /**
@@ -135,6 +191,18 @@ struct olsrv2_routing_entry {
   /*! old values of route before current dijstra run */
   struct os_route_parameter _old;
 
+  /*! path cost before current dijkstra run */
+  uint32_t _old_path_cost;
+
+  /*! path hops before current dijkstra run */
+  uint8_t _old_path_hops;
+
+  /*! originator before current dijkstra run */
+  struct netaddr _old_originator;
+
+  /*! last originator before current dijkstra run */
+  struct netaddr _old_last_originator;
+
   /*! hook into working queues */
   struct list_entity _working_node;
 
@@ -185,8 +253,12 @@ void olsrv2_routing_cleanup(void);
 
 void olsrv2_routing_dijkstra_node_init(
     struct olsrv2_dijkstra_node *, const struct netaddr *originator);
+void olsrv2_routing_dijkstra_node_changed(struct olsrv2_tc_node *);
+void olsrv2_routing_dijkstra_node_remove(struct olsrv2_tc_node *);
+void olsrv2_routing_increment_generation(void);
 
 EXPORT uint16_t olsrv2_routing_get_ansn(void);
+EXPORT uint64_t olsrv2_routing_get_generation(void);
 EXPORT void olsrv2_routing_force_ansn_increment(uint16_t increment);
 
 EXPORT void olsrv2_routing_set_domain_parameter(struct nhdp_domain *domain,
@@ -198,11 +270,14 @@ EXPORT void olsrv2_routing_force_update(bool skip_wait);
 EXPORT void olsrv2_routing_trigger_update(void);
 
 EXPORT void olsrv2_routing_freeze_routes(bool freeze);
+EXPORT void olsrv2_routing_set_incremental(bool incremental, uint32_t limit);
 
 EXPORT const struct olsrv2_routing_domain *
     olsrv2_routing_get_parameters(struct nhdp_domain *);
 
 EXPORT struct avl_tree *olsrv2_routing_get_tree(struct nhdp_domain *domain);
+EXPORT const struct olsrv2_routing_statistics *
+    olsrv2_routing_get_statistics(struct nhdp_domain *domain);
 EXPORT struct list_entity *olsrv2_routing_get_filter_list(void);
 
 /**
@@ -47,6 +47,7 @@
 #include "common/avl_comp.h"
 #include "common/common_types.h"
 #include "common/netaddr.h"
+#include "common/string.h"
 #include "subsystems/oonf_class.h"
 #include "subsystems/oonf_rfc5444.h"
 #include "subsystems/oonf_timer.h"
@@ -64,15 +65,25 @@ static bool _remove_edge(struct olsrv2_tc_edge *edge, bool cleanup);
 static void _cb_neighbor_change(void *ptr);
 static void _cb_neighbor_remove(void *ptr);
 
+static const char *_cb_node_to_keystring(struct oonf_objectkey_str *,
+    struct oonf_class *, void *);
+static const char *_cb_node_to_statestring(struct oonf_objectstate_str *,
+    struct oonf_class *, void *);
+static const char *_cb_edge_to_keystring(struct oonf_objectkey_str *,
+    struct oonf_class *, void *);
+
 /* classes for topology data */
 static struct oonf_class _tc_node_class = {
   .name = OLSRV2_CLASS_TC_NODE,
   .size = sizeof(struct olsrv2_tc_node),
+  .to_keystring = _cb_node_to_keystring,
+  .to_statestring = _cb_node_to_statestring,
 };
 
 static struct oonf_class _tc_edge_class = {
   .name = OLSRV2_CLASS_TC_EDGE,
   .size = sizeof(struct olsrv2_tc_edge),
+  .to_keystring = _cb_edge_to_keystring,
 };
 
 static struct oonf_class _tc_attached_class = {
@@ -190,6 +201,7 @@ olsrv2_tc_node_add(struct netaddr *originator,
 
     /* hook into global tree */
     avl_insert(&_tc_tree, &node->_originator_node);
+    olsrv2_routing_increment_generation();
 
     /* fire event */
     oonf_class_event(&_tc_node_class, node, OONF_OBJECT_ADDED);
@@ -197,6 +209,7 @@ olsrv2_tc_node_add(struct netaddr *originator,
   else if (!oonf_timer_is_active(&node->_validity_time)) {
     /* node was virtual */
     node->ansn = ansn;
+    olsrv2_routing_increment_generation();
 
     /* fire event */
     oonf_class_event(&_tc_node_class, node, OONF_OBJECT_ADDED);
@@ -233,12 +246,14 @@ olsrv2_tc_node_remove(struct olsrv2_tc_node *node) {
 
   /* remove from global tree and free memory if node is not needed anymore*/
   if (node->_edges.count == 0 && !node->direct_neighbor) {
+    olsrv2_routing_dijkstra_node_remove(node);
     avl_remove(&_tc_tree, &node->_originator_node);
     oonf_class_free(&_tc_node_class, node);
   }
 
   /* all domains might have changed */
   olsrv2_routing_domain_changed(NULL, true);
+  olsrv2_routing_increment_generation();
 }
 
 /**
@@ -255,7 +270,14 @@ olsrv2_tc_edge_add(struct olsrv2_tc_node *src, struct netaddr *addr) {
 
   edge = avl_find_element(&src->_edges, addr, edge, _node);
   if (edge != NULL) {
-    edge->virtual = false;
+    if (edge->virtual) {
+      /* edge was only known from the other side */
+      edge->virtual = false;
+      olsrv2_routing_increment_generation();
+
+      olsrv2_routing_dijkstra_node_changed(src);
+      olsrv2_routing_dijkstra_node_changed(edge->dst);
+    }
 
     /* cleanup metric data from other side of the edge */
     for (i=0; i<NHDP_MAXIMUM_DOMAINS; i++) {
@@ -317,6 +339,10 @@ olsrv2_tc_edge_add(struct olsrv2_tc_node *src, struct netaddr *addr) {
   inverse->_node.key = &src->target.prefix.dst;
   avl_insert(&dst->_edges, &inverse->_node);
 
+  olsrv2_routing_dijkstra_node_changed(src);
+  olsrv2_routing_dijkstra_node_changed(dst);
+  olsrv2_routing_increment_generation();
+
   /* fire event */
   oonf_class_event(&_tc_edge_class, edge, OONF_OBJECT_ADDED);
   return edge;
@@ -331,6 +357,7 @@ bool
 olsrv2_tc_edge_remove(struct olsrv2_tc_edge *edge) {
   /* all domains might have changed */
   olsrv2_routing_domain_changed(NULL, true);
+  olsrv2_routing_increment_generation();
 
   return _remove_edge(edge, true);
 }
@@ -395,6 +422,8 @@ olsrv2_tc_endpoint_add(struct olsrv2_tc_node *node,
   /* hook into endpoint */
   net->_endpoint_node.key = &node->target.prefix;
   avl_insert(&end->_attached_networks, &net->_endpoint_node);
+  end->shared = end->_attached_networks.count > 1;
+  olsrv2_routing_increment_generation();
 
   /* initialize dijkstra data */
   olsrv2_routing_dijkstra_node_init(&end->target._dijkstra,
@@ -418,6 +447,7 @@ olsrv2_tc_endpoint_remove(
 
   /* remove from endpoint */
   avl_remove(&net->dst->_attached_networks, &net->_endpoint_node);
+  net->dst->shared = net->dst->_attached_networks.count > 1;
 
   if (net->dst->_attached_networks.count == 0) {
     oonf_class_event(&_tc_endpoint_class, net->dst, OONF_OBJECT_REMOVED);
@@ -432,6 +462,7 @@ olsrv2_tc_endpoint_remove(
 
   /* all domains might have changed */
   olsrv2_routing_domain_changed(NULL, true);
+  olsrv2_routing_increment_generation();
 }
 
 /**
@@ -495,6 +526,9 @@ _remove_edge(struct olsrv2_tc_edge *edge, bool cleanup) {
   /* fire event */
   oonf_class_event(&_tc_edge_class, edge, OONF_OBJECT_REMOVED);
 
+  olsrv2_routing_dijkstra_node_changed(edge->src);
+  olsrv2_routing_dijkstra_node_changed(edge->dst);
+
   if (!edge->inverse->virtual) {
     /* make this edge virtual */
     edge->virtual = true;
@@ -579,3 +613,59 @@ _cb_neighbor_remove(void *ptr) {
     olsrv2_tc_node_remove(tc_node);
   }
 }
+
+/**
+ * Keystring creator for tc nodes
+ * @param buf pointer to target buffer
+ * @param class tc node class
+ * @param ptr pointer to tc node
+ * @return pointer to target buffer
+ */
+static const char *
+_cb_node_to_keystring(struct oonf_objectkey_str *buf,
+    struct oonf_class *class __attribute__((unused)), void *ptr) {
+  struct olsrv2_tc_node *node = ptr;
+  struct netaddr_str nbuf;
+
+  strscpy(buf->buf, netaddr_to_string(&nbuf, &node->target.prefix.dst),
+      sizeof(*buf));
+  return buf->buf;
+}
+
+/**
+ * Statestring creator for tc nodes
+ * @param buf pointer to target buffer
+ * @param class tc node class
+ * @param ptr pointer to tc node
+ * @return pointer to target buffer
+ */
+static const char *
+_cb_node_to_statestring(struct oonf_objectstate_str *buf,
+    struct oonf_class *class __attribute__((unused)), void *ptr) {
+  struct olsrv2_tc_node *node = ptr;
+
+  buf->buf[0] = 0;
+  oonf_class_append_state(buf, "ansn", "%u", node->ansn);
+  oonf_class_append_state(buf, "interval", "%"PRIu64, node->interval_time);
+  oonf_class_append_state(buf, "direct_neighbor", "%d", node->direct_neighbor);
+  return buf->buf;
+}
+
+/**
+ * Keystring creator for tc edges
+ * @param buf pointer to target buffer
+ * @param class tc edge class
+ * @param ptr pointer to tc edge
+ * @return pointer to target buffer
+ */
+static const char *
+_cb_edge_to_keystring(struct oonf_objectkey_str *buf,
+    struct oonf_class *class __attribute__((unused)), void *ptr) {
+  struct olsrv2_tc_edge *edge = ptr;
+  struct netaddr_str nbuf1, nbuf2;
+
+  snprintf(buf->buf, sizeof(*buf), "%s->%s",
+      netaddr_to_string(&nbuf1, &edge->src->target.prefix.dst),
+      netaddr_to_string(&nbuf2, &edge->dst->target.prefix.dst));
+  return buf->buf;
+}
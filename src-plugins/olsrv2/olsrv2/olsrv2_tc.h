@@ -48,6 +48,7 @@
 
 #include "common/avl.h"
 #include "common/common_types.h"
+#include "common/list.h"
 #include "common/netaddr.h"
 
 #include "subsystems/oonf_timer.h"
@@ -135,6 +136,15 @@ struct olsrv2_tc_node {
   /*! tree of olsrv2_tc_attached_networks */
   struct avl_tree _attached_networks;
 
+  /*! shortest path tree data of last dijkstra run per domain */
+  struct olsrv2_dijkstra_spt _spt[NHDP_MAXIMUM_DOMAINS];
+
+  /*! bitmask of domains that have not processed an edge change yet */
+  uint8_t _spt_dirty;
+
+  /*! hook into list of changed nodes for incremental dijkstra */
+  struct list_entity _spt_dirty_node;
+
   /*! node for tree of tc_nodes */
   struct avl_node _originator_node;
 };
@@ -208,6 +218,9 @@ struct olsrv2_tc_endpoint {
   /*! tree of attached networks */
   struct avl_tree _attached_networks;
 
+  /*! true if more than one tc node announces the endpoint */
+  bool shared;
+
   /*! node for global tree of endpoints */
   struct avl_node _node;
 };
@@ -43,6 +43,7 @@
  * @file
  */
 
+#include "common/autobuf.h"
 #include "common/avl.h"
 #include "common/common_types.h"
 #include "common/list.h"
@@ -86,6 +87,9 @@ enum olsrv2_addrtlv_idx {
 
 /* Prototypes */
 static void _send_tc(int af_type);
+static bool _update_tc_signature(int af_type);
+static bool _is_advertised_neighbor(struct nhdp_neighbor *neigh);
+static uint8_t _get_nbr_addrtype(struct nhdp_neighbor *neigh, struct nhdp_naddr *naddr);
 #if 0
 static bool _cb_tc_interface_selector(struct rfc5444_writer *,
     struct rfc5444_writer_target *rfc5444_target, void *ptr);
@@ -129,6 +133,10 @@ static struct oonf_rfc5444_protocol *_protocol;
 static bool _cleanedup = false;
 static size_t _mprtypes_size;
 
+/* binary signature of the TC content used for the last IPv4/IPv6 TC */
+static struct autobuf _tc_signature[2];
+static struct autobuf _tc_new_signature;
+
 /**
  * initialize olsrv2 writer
  * @param protocol rfc5444 protocol
@@ -145,9 +153,20 @@ olsrv2_writer_init(struct oonf_rfc5444_protocol *protocol) {
     return -1;
   }
 
+  if (abuf_init(&_tc_signature[0]) || abuf_init(&_tc_signature[1])
+      || abuf_init(&_tc_new_signature)) {
+    OONF_WARN(LOG_OLSRV2, "Could not allocate TC signature buffers");
+    abuf_free(&_tc_signature[0]);
+    abuf_free(&_tc_signature[1]);
+    abuf_free(&_tc_new_signature);
+    rfc5444_writer_unregister_message(&_protocol->writer, _olsrv2_message);
+    return -1;
+  }
+
   _olsrv2_message->addMessageHeader = _cb_addMessageHeader;
   _olsrv2_message->finishMessageHeader = _cb_finishMessageHeader;
   _olsrv2_message->forward_target_selector = nhdp_forwarding_selector;
+  _olsrv2_message->use_addr_cache = true;
 
   if (rfc5444_writer_register_msgcontentprovider(
       &_protocol->writer, &_olsrv2_msgcontent_provider,
@@ -155,6 +174,9 @@ olsrv2_writer_init(struct oonf_rfc5444_protocol *protocol) {
 
     OONF_WARN(LOG_OLSRV2, "Count not register OLSRV2 msg contentprovider");
     rfc5444_writer_unregister_message(&_protocol->writer, _olsrv2_message);
+    abuf_free(&_tc_signature[0]);
+    abuf_free(&_tc_signature[1]);
+    abuf_free(&_tc_new_signature);
     return -1;
   }
 
@@ -173,6 +195,10 @@ olsrv2_writer_cleanup(void) {
       &_protocol->writer, &_olsrv2_msgcontent_provider,
       _olsrv2_addrtlvs, ARRAYSIZE(_olsrv2_addrtlvs));
   rfc5444_writer_unregister_message(&_protocol->writer, _olsrv2_message);
+
+  abuf_free(&_tc_signature[0]);
+  abuf_free(&_tc_signature[1]);
+  abuf_free(&_tc_new_signature);
 }
 
 /**
@@ -216,12 +242,160 @@ _send_tc(int af_type) {
 
   originator = olsrv2_originator_get(af_type);
   if (netaddr_get_address_family(originator) == af_type) {
+    if (_update_tc_signature(af_type)) {
+      /* TC content changed, address blocks must be encoded again */
+      rfc5444_writer_invalidate_addrcache(_olsrv2_message, af_type == AF_INET ? 4 : 16);
+    }
+
     OONF_INFO(LOG_OLSRV2_W, "Emit IPv%d TC message.", af_type == AF_INET ? 4 : 6);
     oonf_rfc5444_send_all(_protocol, RFC7181_MSGTYPE_TC,
         af_type == AF_INET ? 4 : 16, nhdp_flooding_selector);
   }
 }
 
+/**
+ * Generate a binary signature of all data that is used for the
+ * address blocks of a TC and compare it to the signature of the
+ * last TC of the same address family.
+ * @param af_type address family type
+ * @return true if the content of the address blocks changed
+ */
+static bool
+_update_tc_signature(int af_type) {
+  struct autobuf *signature, tmp;
+  struct nhdp_neighbor_domaindata *neigh_domain;
+  struct olsrv2_lan_domaindata *lan_data;
+  struct nhdp_neighbor *neigh;
+  struct nhdp_naddr *naddr;
+  struct nhdp_domain *domain;
+  struct olsrv2_lan_entry *lan;
+  uint8_t nbr_addrtype_value;
+
+  signature = &_tc_signature[af_type == AF_INET ? 0 : 1];
+  abuf_clear(&_tc_new_signature);
+
+  abuf_append_uint16(&_tc_new_signature, olsrv2_routing_get_ansn());
+  list_for_each_element(nhdp_domain_get_list(), domain, _node) {
+    abuf_append_uint8(&_tc_new_signature, domain->ext);
+  }
+
+  list_for_each_element(nhdp_db_get_neigh_list(), neigh, _global_node) {
+    if (!_is_advertised_neighbor(neigh)) {
+      continue;
+    }
+
+    avl_for_each_element(&neigh->_neigh_addresses, naddr, _neigh_node) {
+      if (netaddr_get_address_family(&naddr->neigh_addr) != af_type) {
+        continue;
+      }
+
+      nbr_addrtype_value = _get_nbr_addrtype(neigh, naddr);
+      if (nbr_addrtype_value == 0) {
+        continue;
+      }
+
+      abuf_memcpy(&_tc_new_signature, &naddr->neigh_addr, sizeof(naddr->neigh_addr));
+      abuf_append_uint8(&_tc_new_signature, nbr_addrtype_value);
+
+      list_for_each_element(nhdp_domain_get_list(), domain, _node) {
+        neigh_domain = nhdp_domain_get_neighbordata(domain, neigh);
+
+        abuf_append_uint8(&_tc_new_signature, neigh_domain->local_is_mpr ? 1 : 0);
+        abuf_append_uint32(&_tc_new_signature, neigh_domain->metric.in);
+        abuf_append_uint32(&_tc_new_signature, neigh_domain->metric.out);
+      }
+    }
+  }
+
+  avl_for_each_element(olsrv2_lan_get_tree(), lan, _node) {
+    if (netaddr_get_address_family(&lan->prefix.dst) != af_type) {
+      continue;
+    }
+
+    abuf_memcpy(&_tc_new_signature, &lan->prefix, sizeof(lan->prefix));
+    abuf_append_uint8(&_tc_new_signature, lan->same_distance ? 1 : 0);
+
+    list_for_each_element(nhdp_domain_get_list(), domain, _node) {
+      lan_data = olsrv2_lan_get_domaindata(domain, lan);
+
+      abuf_append_uint32(&_tc_new_signature, lan_data->outgoing_metric);
+      abuf_append_uint8(&_tc_new_signature, lan_data->distance);
+    }
+  }
+
+  if (abuf_has_failed(&_tc_new_signature)) {
+    /* out of memory, never reuse the old TC content */
+    abuf_clear(signature);
+    return true;
+  }
+
+  if (abuf_getlen(signature) > 0
+      && abuf_getlen(signature) == abuf_getlen(&_tc_new_signature)
+      && memcmp(abuf_getptr(signature), abuf_getptr(&_tc_new_signature),
+          abuf_getlen(signature)) == 0) {
+    OONF_DEBUG(LOG_OLSRV2_W, "IPv%d TC content unchanged",
+        af_type == AF_INET ? 4 : 6);
+    return false;
+  }
+
+  /* remember new signature */
+  memcpy(&tmp, signature, sizeof(tmp));
+  memcpy(signature, &_tc_new_signature, sizeof(tmp));
+  memcpy(&_tc_new_signature, &tmp, sizeof(tmp));
+  return true;
+}
+
+/**
+ * @param neigh nhdp neighbor
+ * @return true if neighbor is symmetric and has selected
+ *   the local node as MPR in at least one domain
+ */
+static bool
+_is_advertised_neighbor(struct nhdp_neighbor *neigh) {
+  struct nhdp_domain *domain;
+
+  if (!neigh->symmetric) {
+    /* do not announce non-symmetric neighbors */
+    return false;
+  }
+
+  /* see if we have been selected as a MPR by this neighbor */
+  list_for_each_element(nhdp_domain_get_list(), domain, _node) {
+    if (nhdp_domain_get_neighbordata(domain, neigh)->local_is_mpr) {
+      /* found one */
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @param neigh nhdp neighbor
+ * @param naddr address of nhdp neighbor
+ * @return value of the NBR_ADDR_TYPE tlv, 0 if the address
+ *   should not be mentioned in the TC
+ */
+static uint8_t
+_get_nbr_addrtype(struct nhdp_neighbor *neigh, struct nhdp_naddr *naddr) {
+  uint8_t nbr_addrtype_value;
+
+  if (!olsrv2_is_nhdp_routable(&naddr->neigh_addr)
+      && netaddr_cmp(&neigh->originator, &naddr->neigh_addr) != 0) {
+    /* do not propagate unroutable addresses in TCs */
+    return 0;
+  }
+
+  nbr_addrtype_value = 0;
+
+  if (olsrv2_is_routable(&naddr->neigh_addr)) {
+    nbr_addrtype_value |= RFC7181_NBR_ADDR_TYPE_ROUTABLE;
+  }
+  if (netaddr_cmp(&neigh->originator, &naddr->neigh_addr) == 0) {
+    nbr_addrtype_value |= RFC7181_NBR_ADDR_TYPE_ORIGINATOR;
+  }
+  return nbr_addrtype_value;
+}
+
 /**
  * Callback for rfc5444 writer to add message header for tc
  * @param writer RFC5444 writer instance
@@ -382,7 +556,6 @@ _cb_addAddresses(struct rfc5444_writer *writer) {
   struct nhdp_domain *domain;
   struct olsrv2_lan_entry *lan;
   struct olsrv2_lan_domaindata *lan_data;
-  bool any_advertised;
   uint8_t nbr_addrtype_value;
   uint32_t metric_out;
   struct rfc7181_metric_field metric_out_encoded;
@@ -398,23 +571,7 @@ _cb_addAddresses(struct rfc5444_writer *writer) {
 
   /* iterate over neighbors */
   list_for_each_element(nhdp_db_get_neigh_list(), neigh, _global_node) {
-    any_advertised = false;
-
-    if (!neigh->symmetric) {
-      /* do not announce non-symmetric neighbors */
-      continue;
-    }
-
-    /* see if we have been selected as a MPR by this neighbor */
-    list_for_each_element(nhdp_domain_get_list(), domain, _node) {
-      if (nhdp_domain_get_neighbordata(domain, neigh)->local_is_mpr) {
-        /* found one */
-        any_advertised = true;
-        break;
-      }
-    }
-
-    if (!any_advertised) {
+    if (!_is_advertised_neighbor(neigh)) {
       /* we are not a MPR for this neighbor, so we don't advertise the neighbor */
       continue;
     }
@@ -426,21 +583,7 @@ _cb_addAddresses(struct rfc5444_writer *writer) {
         continue;
       }
 
-      if (!olsrv2_is_nhdp_routable(&naddr->neigh_addr)
-          && netaddr_cmp(&neigh->originator, &naddr->neigh_addr) != 0) {
-        /* do not propagate unroutable addresses in TCs */
-        continue;
-      }
-
-      nbr_addrtype_value = 0;
-
-      if (olsrv2_is_routable(&naddr->neigh_addr)) {
-        nbr_addrtype_value |= RFC7181_NBR_ADDR_TYPE_ROUTABLE;
-      }
-      if (netaddr_cmp(&neigh->originator, &naddr->neigh_addr) == 0) {
-        nbr_addrtype_value |= RFC7181_NBR_ADDR_TYPE_ORIGINATOR;
-      }
-
+      nbr_addrtype_value = _get_nbr_addrtype(neigh, naddr);
       if (nbr_addrtype_value == 0) {
         /* skip this address */
         OONF_DEBUG(LOG_OLSRV2_W, "Address %s is neither routable"
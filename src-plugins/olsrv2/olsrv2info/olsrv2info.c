@@ -52,6 +52,7 @@
 #include "subsystems/oonf_clock.h"
 #include "subsystems/oonf_telnet.h"
 #include "subsystems/oonf_viewer.h"
+#include "subsystems/os_routing.h"
 
 #include "nhdp/nhdp.h"
 #include "nhdp/nhdp_domain.h"
@@ -72,6 +73,7 @@ static void _cleanup(void);
 
 static enum oonf_telnet_result _cb_olsrv2info(struct oonf_telnet_data *con);
 static enum oonf_telnet_result _cb_olsrv2info_help(struct oonf_telnet_data *con);
+static uint64_t _cb_olsrv2info_generation(struct oonf_telnet_data *con);
 
 static void _initialize_originator_values(int af_type);
 static void _initialize_old_originator_values(struct olsrv2_originator_set_entry *);
@@ -83,6 +85,8 @@ static void _initialize_node_values(struct olsrv2_tc_node *);
 static void _initialize_attached_network_values(struct olsrv2_tc_attachment *edge);
 static void _initialize_edge_values(struct olsrv2_tc_edge *edge);
 static void _initialize_route_values(struct olsrv2_routing_entry *route);
+static void _initialize_dijkstra_values(struct nhdp_domain *domain);
+static void _initialize_route_install_values(struct oonf_viewer_template *);
 
 static int _cb_create_text_originator(struct oonf_viewer_template *);
 static int _cb_create_text_old_originator(struct oonf_viewer_template *);
@@ -91,6 +95,10 @@ static int _cb_create_text_node(struct oonf_viewer_template *);
 static int _cb_create_text_attached_network(struct oonf_viewer_template *);
 static int _cb_create_text_edge(struct oonf_viewer_template *);
 static int _cb_create_text_route(struct oonf_viewer_template *);
+static int _cb_create_text_dijkstra(struct oonf_viewer_template *);
+static int _cb_create_text_route_install(struct oonf_viewer_template *);
+
+static uint64_t _cb_get_generation(void);
 
 /*
  * list of template keys and corresponding buffers for values.
@@ -197,6 +205,39 @@ static int _cb_create_text_route(struct oonf_viewer_template *);
 /*! template key for the last hop before the route destination */
 #define KEY_ROUTE_LASTHOP           "route_lasthop"
 
+/*! template key for number of full dijkstra runs */
+#define KEY_DIJKSTRA_FULL           "dijkstra_full"
+
+/*! template key for number of incremental dijkstra runs */
+#define KEY_DIJKSTRA_INCREMENTAL    "dijkstra_incremental"
+
+/*! template key for true if last dijkstra run was incremental */
+#define KEY_DIJKSTRA_LAST_INCREMENTAL "dijkstra_last_incremental"
+
+/*! template key for number of nodes processed by last dijkstra run */
+#define KEY_DIJKSTRA_LAST_TOUCHED   "dijkstra_last_touched"
+
+/*! template key for number of topology nodes during last dijkstra run */
+#define KEY_DIJKSTRA_LAST_TOTAL     "dijkstra_last_total"
+
+/*! template key for number of nodes processed by all dijkstra runs */
+#define KEY_DIJKSTRA_TOUCHED        "dijkstra_touched"
+
+/*! template key for number of route changes sent to the kernel */
+#define KEY_ROUTE_INSTALL_SENT      "route_install_sent"
+
+/*! template key for number of route changes rejected by the kernel */
+#define KEY_ROUTE_INSTALL_FAILED    "route_install_failed"
+
+/*! template key for number of routing commands of last batch */
+#define KEY_ROUTE_INSTALL_LAST      "route_install_last"
+
+/*! template key for time the kernel needed for the last batch */
+#define KEY_ROUTE_INSTALL_LAST_TIME "route_install_last_time"
+
+/*! template key for average number of routing commands per second */
+#define KEY_ROUTE_INSTALL_RATE      "route_install_rate"
+
 /*
  * buffer space for values that will be assembled
  * into the output of the plugin
@@ -240,6 +281,19 @@ static char                       _value_route_if[IF_NAMESIZE];
 static char                       _value_route_ifindex[12];
 static struct netaddr_str         _value_route_lasthop;
 
+static char                       _value_dijkstra_full[12];
+static char                       _value_dijkstra_incremental[12];
+static char                       _value_dijkstra_last_incremental[TEMPLATE_JSON_BOOL_LENGTH];
+static char                       _value_dijkstra_last_touched[12];
+static char                       _value_dijkstra_last_total[12];
+static char                       _value_dijkstra_touched[21];
+
+static char                       _value_route_install_sent[12];
+static char                       _value_route_install_failed[12];
+static char                       _value_route_install_last[12];
+static struct isonumber_str       _value_route_install_last_time;
+static char                       _value_route_install_rate[21];
+
 /* definition of the template data entries for JSON and table output */
 static struct abuf_template_data_entry _tde_originator[] = {
     { KEY_ORIGINATOR, _value_originator.buf, true },
@@ -309,6 +363,23 @@ static struct abuf_template_data_entry _tde_route[] = {
     { KEY_ROUTE_LASTHOP, _value_route_lasthop.buf, true },
 };
 
+static struct abuf_template_data_entry _tde_dijkstra[] = {
+    { KEY_DIJKSTRA_FULL, _value_dijkstra_full, false },
+    { KEY_DIJKSTRA_INCREMENTAL, _value_dijkstra_incremental, false },
+    { KEY_DIJKSTRA_LAST_INCREMENTAL, _value_dijkstra_last_incremental, true },
+    { KEY_DIJKSTRA_LAST_TOUCHED, _value_dijkstra_last_touched, false },
+    { KEY_DIJKSTRA_LAST_TOTAL, _value_dijkstra_last_total, false },
+    { KEY_DIJKSTRA_TOUCHED, _value_dijkstra_touched, false },
+};
+
+static struct abuf_template_data_entry _tde_route_install[] = {
+    { KEY_ROUTE_INSTALL_SENT, _value_route_install_sent, false },
+    { KEY_ROUTE_INSTALL_FAILED, _value_route_install_failed, false },
+    { KEY_ROUTE_INSTALL_LAST, _value_route_install_last, false },
+    { KEY_ROUTE_INSTALL_LAST_TIME, _value_route_install_last_time.buf, false },
+    { KEY_ROUTE_INSTALL_RATE, _value_route_install_rate, false },
+};
+
 static struct abuf_template_storage _template_storage;
 
 /* Template Data objects (contain one or more Template Data Entries) */
@@ -346,6 +417,13 @@ static struct abuf_template_data _td_route[] = {
     { _tde_domain_metric_out, ARRAYSIZE(_tde_domain_metric_out) },
     { _tde_domain_path_hops, ARRAYSIZE(_tde_domain_path_hops) },
 };
+static struct abuf_template_data _td_dijkstra[] = {
+    { _tde_domain, ARRAYSIZE(_tde_domain) },
+    { _tde_dijkstra, ARRAYSIZE(_tde_dijkstra) },
+};
+static struct abuf_template_data _td_route_install[] = {
+    { _tde_route_install, ARRAYSIZE(_tde_route_install) },
+};
 
 /* OONF viewer templates (based on Template Data arrays) */
 static struct oonf_viewer_template _templates[] = {
@@ -366,37 +444,54 @@ static struct oonf_viewer_template _templates[] = {
         .data_size = ARRAYSIZE(_td_lan),
         .json_name = "lan",
         .cb_function = _cb_create_text_lan,
+        .cb_get_generation = _cb_get_generation,
     },
     {
         .data = _td_node,
         .data_size = ARRAYSIZE(_td_node),
         .json_name = "node",
-        .cb_function = _cb_create_text_node,
+        .cb_chunk_function = _cb_create_text_node,
     },
     {
         .data = _td_attached_net,
         .data_size = ARRAYSIZE(_td_attached_net),
         .json_name = "attached_network",
-        .cb_function = _cb_create_text_attached_network,
+        .cb_chunk_function = _cb_create_text_attached_network,
+        .cb_get_generation = _cb_get_generation,
     },
     {
         .data = _td_edge,
         .data_size = ARRAYSIZE(_td_edge),
         .json_name = "edge",
-        .cb_function = _cb_create_text_edge,
+        .cb_chunk_function = _cb_create_text_edge,
+        .cb_get_generation = _cb_get_generation,
     },
     {
         .data = _td_route,
         .data_size = ARRAYSIZE(_td_route),
         .json_name = "route",
-        .cb_function = _cb_create_text_route,
+        .cb_chunk_function = _cb_create_text_route,
+        .cb_get_generation = _cb_get_generation,
+    },
+    {
+        .data = _td_dijkstra,
+        .data_size = ARRAYSIZE(_td_dijkstra),
+        .json_name = "dijkstra",
+        .cb_function = _cb_create_text_dijkstra,
+    },
+    {
+        .data = _td_route_install,
+        .data_size = ARRAYSIZE(_td_route_install),
+        .json_name = "route_install",
+        .cb_function = _cb_create_text_route_install,
     }
 };
 
 /* telnet command of this plugin */
 static struct oonf_telnet_command _telnet_commands[] = {
     TELNET_CMD(OONF_OLSRV2INFO_SUBSYSTEM, _cb_olsrv2info,
-        "", .help_handler = _cb_olsrv2info_help),
+        "", .help_handler = _cb_olsrv2info_help,
+        .cb_get_generation = _cb_olsrv2info_generation),
 };
 
 /* plugin declaration */
@@ -440,8 +535,18 @@ _cleanup(void) {
  */
 static enum oonf_telnet_result
 _cb_olsrv2info(struct oonf_telnet_data *con) {
-  return oonf_viewer_telnet_handler(con->out, &_template_storage,
-      OONF_OLSRV2INFO_SUBSYSTEM, con->parameter,
+  return oonf_viewer_telnet_chunked_handler(con, &_template_storage,
+      OONF_OLSRV2INFO_SUBSYSTEM, _templates, ARRAYSIZE(_templates));
+}
+
+/**
+ * Callback for the output cache of the telnet command of this plugin
+ * @param con pointer to telnet session data
+ * @return generation of the requested output, 0 if not cacheable
+ */
+static uint64_t
+_cb_olsrv2info_generation(struct oonf_telnet_data *con) {
+  return oonf_viewer_telnet_get_generation(con->parameter,
       _templates, ARRAYSIZE(_templates));
 }
 
@@ -620,6 +725,59 @@ _initialize_route_values(struct olsrv2_routing_entry *route) {
   netaddr_to_string(&_value_route_lasthop, &route->last_originator);
 }
 
+/**
+ * Initialize the value buffers for the dijkstra statistics of a domain
+ * @param domain NHDP domain
+ */
+static void
+_initialize_dijkstra_values(struct nhdp_domain *domain) {
+  const struct olsrv2_routing_statistics *stats;
+
+  stats = olsrv2_routing_get_statistics(domain);
+
+  snprintf(_value_dijkstra_full, sizeof(_value_dijkstra_full),
+      "%u", stats->full_runs);
+  snprintf(_value_dijkstra_incremental, sizeof(_value_dijkstra_incremental),
+      "%u", stats->incremental_runs);
+  strscpy(_value_dijkstra_last_incremental,
+      json_getbool(stats->last_incremental),
+      sizeof(_value_dijkstra_last_incremental));
+  snprintf(_value_dijkstra_last_touched, sizeof(_value_dijkstra_last_touched),
+      "%u", stats->last_touched);
+  snprintf(_value_dijkstra_last_total, sizeof(_value_dijkstra_last_total),
+      "%u", stats->last_total);
+  snprintf(_value_dijkstra_touched, sizeof(_value_dijkstra_touched),
+      "%"PRIu64, stats->total_touched);
+}
+
+/**
+ * Initialize the value buffers for the kernel route statistics
+ * @param template oonf viewer template
+ */
+static void
+_initialize_route_install_values(struct oonf_viewer_template *template) {
+  const struct os_route_statistics *stats;
+  uint64_t rate;
+
+  stats = os_routing_get_statistics();
+
+  snprintf(_value_route_install_sent, sizeof(_value_route_install_sent),
+      "%u", stats->sent);
+  snprintf(_value_route_install_failed, sizeof(_value_route_install_failed),
+      "%u", stats->failed);
+  snprintf(_value_route_install_last, sizeof(_value_route_install_last),
+      "%u", stats->last_batch);
+  isonumber_from_u64(&_value_route_install_last_time,
+      stats->last_batch_time, "", 3, false, template->create_raw);
+
+  rate = 0;
+  if (stats->total_batch_time > 0) {
+    rate = stats->total_batched * 1000ull / stats->total_batch_time;
+  }
+  snprintf(_value_route_install_rate, sizeof(_value_route_install_rate),
+      "%"PRIu64, rate);
+}
+
 /**
  * Displays the known data about each NHDP interface.
  * @param template oonf viewer template
@@ -687,16 +845,26 @@ _cb_create_text_lan(struct oonf_viewer_template *template) {
 /**
  * Display all known OLSRv2 nodes
  * @param template oonf viewer template
- * @return -1 if an error happened, 0 otherwise
+ * @return -1 if an error happened, 0 if output is complete,
+ *   1 if more output will follow
  */
 static int
 _cb_create_text_node(struct oonf_viewer_template *template) {
   struct olsrv2_tc_node *node;
 
-  avl_for_each_element(olsrv2_tc_get_tree(), node, _originator_node) {
+  oonf_viewer_for_each_element(&template->cursor, 0,
+      olsrv2_tc_get_tree(), node, _originator_node) {
+    oonf_viewer_cursor_enter(&template->cursor, 0,
+        &node->target.prefix.dst, sizeof(node->target.prefix.dst));
+
     _initialize_node_values(node);
 
     oonf_viewer_output_print_line(template);
+
+    oonf_viewer_cursor_leave(&template->cursor, 0);
+    if (oonf_viewer_output_chunk_full(template)) {
+      return 1;
+    }
   }
   return 0;
 }
@@ -704,7 +872,8 @@ _cb_create_text_node(struct oonf_viewer_template *template) {
 /**
  * Display all known OLSRv2 attached networks
  * @param template oonf viewer template
- * @return -1 if an error happened, 0 otherwise
+ * @return -1 if an error happened, 0 if output is complete,
+ *   1 if more output will follow
  */
 static int
 _cb_create_text_attached_network(struct oonf_viewer_template *template) {
@@ -712,14 +881,22 @@ _cb_create_text_attached_network(struct oonf_viewer_template *template) {
   struct olsrv2_tc_attachment *attached;
   struct nhdp_domain *domain;
 
-  avl_for_each_element(olsrv2_tc_get_tree(), node, _originator_node) {
+  oonf_viewer_for_each_element(&template->cursor, 0,
+      olsrv2_tc_get_tree(), node, _originator_node) {
+    oonf_viewer_cursor_enter(&template->cursor, 0,
+        &node->target.prefix.dst, sizeof(node->target.prefix.dst));
+
     _initialize_node_values(node);
 
     if (olsrv2_tc_is_node_virtual(node)) {
       continue;
     }
 
-    avl_for_each_element(&node->_attached_networks, attached, _src_node) {
+    oonf_viewer_for_each_element(&template->cursor, 1,
+        &node->_attached_networks, attached, _src_node) {
+      oonf_viewer_cursor_enter(&template->cursor, 1,
+          &attached->dst->target.prefix, sizeof(attached->dst->target.prefix));
+
       _initialize_attached_network_values(attached);
 
       list_for_each_element(nhdp_domain_get_list(), domain, _node) {
@@ -731,7 +908,13 @@ _cb_create_text_attached_network(struct oonf_viewer_template *template) {
 
         oonf_viewer_output_print_line(template);
       }
+
+      oonf_viewer_cursor_leave(&template->cursor, 1);
+      if (oonf_viewer_output_chunk_full(template)) {
+        return 1;
+      }
     }
+    oonf_viewer_cursor_leave(&template->cursor, 0);
   }
   return 0;
 }
@@ -739,7 +922,8 @@ _cb_create_text_attached_network(struct oonf_viewer_template *template) {
 /**
  * Display all known OLSRv2 edges
  * @param template oonf viewer template
- * @return -1 if an error happened, 0 otherwise
+ * @return -1 if an error happened, 0 if output is complete,
+ *   1 if more output will follow
  */
 static int
 _cb_create_text_edge(struct oonf_viewer_template *template) {
@@ -748,16 +932,23 @@ _cb_create_text_edge(struct oonf_viewer_template *template) {
   struct nhdp_domain *domain;
   uint32_t metric;
 
-  avl_for_each_element(olsrv2_tc_get_tree(), node, _originator_node) {
+  oonf_viewer_for_each_element(&template->cursor, 0,
+      olsrv2_tc_get_tree(), node, _originator_node) {
+    oonf_viewer_cursor_enter(&template->cursor, 0,
+        &node->target.prefix.dst, sizeof(node->target.prefix.dst));
+
     _initialize_node_values(node);
 
     if (olsrv2_tc_is_node_virtual(node)) {
       continue;
     }
-    avl_for_each_element(&node->_edges, edge, _node) {
+    oonf_viewer_for_each_element(&template->cursor, 1,
+        &node->_edges, edge, _node) {
       if (edge->virtual) {
         continue;
       }
+      oonf_viewer_cursor_enter(&template->cursor, 1,
+          &edge->dst->target.prefix.dst, sizeof(edge->dst->target.prefix.dst));
 
       _initialize_edge_values(edge);
 
@@ -770,7 +961,13 @@ _cb_create_text_edge(struct oonf_viewer_template *template) {
           oonf_viewer_output_print_line(template);
         }
       }
+
+      oonf_viewer_cursor_leave(&template->cursor, 1);
+      if (oonf_viewer_output_chunk_full(template)) {
+        return 1;
+      }
     }
+    oonf_viewer_cursor_leave(&template->cursor, 0);
   }
   return 0;
 }
@@ -778,7 +975,8 @@ _cb_create_text_edge(struct oonf_viewer_template *template) {
 /**
  * Display all current entries of the OLSRv2 routing table
  * @param template oonf viewer template
- * @return -1 if an error happened, 0 otherwise
+ * @return -1 if an error happened, 0 if output is complete,
+ *   1 if more output will follow
  */
 static int
 _cb_create_text_route(struct oonf_viewer_template *template) {
@@ -786,17 +984,69 @@ _cb_create_text_route(struct oonf_viewer_template *template) {
   struct nhdp_domain *domain;
 
   list_for_each_element(nhdp_domain_get_list(), domain, _node) {
+    /* one cursor phase for each domain */
+    if (domain->index < template->cursor.phase) {
+      continue;
+    }
+
     _initialize_domain_values(domain);
 
-    avl_for_each_element(olsrv2_routing_get_tree(domain),
-        route, _node) {
+    oonf_viewer_for_each_element(&template->cursor, 0,
+        olsrv2_routing_get_tree(domain), route, _node) {
+      oonf_viewer_cursor_enter(&template->cursor, 0,
+          &route->route.p.key, sizeof(route->route.p.key));
+
       _initialize_domain_path_metric_values(
           domain, route->path_cost, route->path_hops);
       _initialize_domain_path_hops(route->path_hops);
       _initialize_route_values(route);
 
       oonf_viewer_output_print_line(template);
+
+      oonf_viewer_cursor_leave(&template->cursor, 0);
+      if (oonf_viewer_output_chunk_full(template)) {
+        return 1;
+      }
     }
+    oonf_viewer_cursor_next_phase(&template->cursor);
   }
   return 0;
 }
+
+/**
+ * Display the statistics of the dijkstra calculation of all domains
+ * @param template oonf viewer template
+ * @return -1 if an error happened, 0 otherwise
+ */
+static int
+_cb_create_text_dijkstra(struct oonf_viewer_template *template) {
+  struct nhdp_domain *domain;
+
+  list_for_each_element(nhdp_domain_get_list(), domain, _node) {
+    _initialize_domain_values(domain);
+    _initialize_dijkstra_values(domain);
+
+    oonf_viewer_output_print_line(template);
+  }
+  return 0;
+}
+
+/**
+ * Display the statistics of the kernel route installation
+ * @param template oonf viewer template
+ * @return -1 if an error happened, 0 otherwise
+ */
+static int
+_cb_create_text_route_install(struct oonf_viewer_template *template) {
+  _initialize_route_install_values(template);
+  oonf_viewer_output_print_line(template);
+  return 0;
+}
+
+/**
+ * @return generation of the topology and routing database
+ */
+static uint64_t
+_cb_get_generation(void) {
+  return olsrv2_routing_get_generation();
+}
@@ -44,7 +44,10 @@
  */
 
 #include <assert.h>
+#include <stdarg.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "common/avl.h"
 #include "common/avl_comp.h"
@@ -132,7 +135,11 @@ oonf_class_add(struct oonf_class *ci)
   }
 
   /* Init list heads */
+#ifdef OONF_CLASS_SLAB
+  slab_init(&ci->_slab, ci->total_size);
+#else
   list_init_head(&ci->_free_list);
+#endif
   list_init_head(&ci->_extensions);
 
   OONF_DEBUG(LOG_CLASS, "Class %s added: %" PRINTF_SIZE_T_SPECIFIER " bytes\n",
@@ -170,6 +177,22 @@ oonf_class_remove(struct oonf_class *ci)
 void *
 oonf_class_malloc(struct oonf_class *ci)
 {
+#ifdef OONF_CLASS_SLAB
+  void *ptr;
+
+  ptr = slab_alloc(&ci->_slab);
+  if (ptr == NULL) {
+    OONF_WARN(LOG_CLASS, "Out of memory for: %s", ci->name);
+    return NULL;
+  }
+
+  /* Stats keeping */
+  ci->_current_usage++;
+
+  OONF_DEBUG(LOG_CLASS, "MEMORY: alloc %s, %" PRINTF_SIZE_T_SPECIFIER " bytes\n",
+             ci->name, ci->total_size);
+  return ptr;
+#else
   struct list_entity *entity;
   void *ptr;
 
@@ -215,6 +238,7 @@ oonf_class_malloc(struct oonf_class *ci)
   OONF_DEBUG(LOG_CLASS, "MEMORY: alloc %s, %" PRINTF_SIZE_T_SPECIFIER " bytes%s\n",
              ci->name, ci->total_size, reuse ? ", reuse" : "");
   return ptr;
+#endif
 }
 
 /**
@@ -225,6 +249,15 @@ oonf_class_malloc(struct oonf_class *ci)
 void
 oonf_class_free(struct oonf_class *ci, void *ptr)
 {
+#ifdef OONF_CLASS_SLAB
+  slab_free(&ci->_slab, ptr);
+
+  /* Stats keeping */
+  ci->_current_usage--;
+
+  OONF_DEBUG(LOG_CLASS, "MEMORY: free %s, %"PRINTF_SIZE_T_SPECIFIER" bytes\n",
+             ci->name, ci->size);
+#else
   struct list_entity *item;
 #ifdef OONF_LOG_DEBUG_INFO
   bool reuse = false;
@@ -256,6 +289,7 @@ oonf_class_free(struct oonf_class *ci, void *ptr)
 
   OONF_DEBUG(LOG_CLASS, "MEMORY: free %s, %"PRINTF_SIZE_T_SPECIFIER" bytes%s\n",
              ci->name, ci->size, reuse ? ", reuse" : "");
+#endif
 }
 
 /**
@@ -280,7 +314,7 @@ oonf_class_extension_add(struct oonf_class_extension *ext) {
     return -1;
   }
 
-  if (c->_allocated != 0 && ext->size > 0) {
+  if (oonf_class_get_allocations(c) != 0 && ext->size > 0) {
     OONF_WARN(LOG_CLASS, "Class %s is already in use and cannot be extended",
         c->name);
     return -1;
@@ -298,6 +332,9 @@ oonf_class_extension_add(struct oonf_class_extension *ext) {
 
     /* calculate new size */
     c->total_size = _roundup(c->total_size + ext->size);
+#ifdef OONF_CLASS_SLAB
+    slab_init(&c->_slab, c->total_size);
+#endif
 
     OONF_DEBUG(LOG_CLASS, "Class %s extended: %" PRINTF_SIZE_T_SPECIFIER " bytes,"
         " '%s' has offset %" PRINTF_SIZE_T_SPECIFIER " and length %" PRINTF_SIZE_T_SPECIFIER "\n",
@@ -347,6 +384,10 @@ oonf_class_event(struct oonf_class *c, void *ptr, enum oonf_class_event evt) {
       OONF_DEBUG(LOG_CLASS, "Fire listener %s", ext->ext_name);
       ext->cb_change(ptr);
     }
+
+    if (ext->cb_event != NULL) {
+      ext->cb_event(ext, ptr, evt);
+    }
   }
   OONF_DEBUG(LOG_CLASS, "Fire event finished");
 }
@@ -370,6 +411,36 @@ oonf_class_get_event_name(enum oonf_class_event event) {
   return OONF_CLASS_EVENT_NAME[event];
 }
 
+/**
+ * Append a name=value pair to the state string of an object,
+ * truncated if the buffer is full
+ * @param buf pointer to state buffer
+ * @param name name of value, must not contain spaces
+ * @param format printf style format of value, must not create spaces
+ * @param ... arguments for format
+ */
+void
+oonf_class_append_state(struct oonf_objectstate_str *buf,
+    const char *name, const char *format, ...) {
+  va_list ap;
+  size_t len;
+  int result;
+
+  len = strlen(buf->buf);
+  result = snprintf(&buf->buf[len], sizeof(*buf) - len, "%s%s=",
+      len > 0 ? " " : "", name);
+  if (result < 0 || (size_t)result >= sizeof(*buf) - len) {
+    /* do not keep a name without value */
+    buf->buf[len] = 0;
+    return;
+  }
+  len += result;
+
+  va_start(ap, format);
+  vsnprintf(&buf->buf[len], sizeof(*buf) - len, format, ap);
+  va_end(ap);
+}
+
 /**
  * @param size memory size in byte
  * @return rounded up size to sizeof(struct list_entity)
@@ -384,10 +455,14 @@ _roundup(size_t size) {
 
 /**
  * Free all objects in the free_list of a memory cookie
+ * (or all empty pages of the slab allocator)
  * @param ci pointer to memory cookie
  */
 static void
 _free_freelist(struct oonf_class *ci) {
+#ifdef OONF_CLASS_SLAB
+  slab_release_empty(&ci->_slab);
+#else
   while (!list_is_empty(&ci->_free_list)) {
     struct list_entity *item;
     item = ci->_free_list.next;
@@ -396,6 +471,7 @@ _free_freelist(struct oonf_class *ci) {
     free(item);
   }
   ci->_free_list_size = 0;
+#endif
 }
 
 /**
@@ -49,6 +49,7 @@
 #include "common/common_types.h"
 #include "common/list.h"
 #include "common/avl.h"
+#include "common/slab.h"
 
 /*! subsystem identifier */
 #define OONF_CLASS_SUBSYSTEM "class"
@@ -75,6 +76,15 @@ struct oonf_objectkey_str {
   char buf[128];
 };
 
+/**
+ * Buffer for text representation of the state of an object,
+ * a space separated list of name=value pairs
+ */
+struct oonf_objectstate_str {
+  /*! maximum length buffer for text */
+  char buf[384];
+};
+
 /**
  * This structure represents a class of memory object, each with the same size.
  */
@@ -101,14 +111,31 @@ struct oonf_class {
   const char *(*to_keystring)(
       struct oonf_objectkey_str *buf, struct oonf_class *cl, void *ptr);
 
+  /**
+   * Callback to convert the current state of an object into a
+   * space separated list of name=value pairs, NULL if the class
+   * has no state string
+   * @param buf output buffer for text
+   * @param cl oonf class
+   * @param ptr pointer to object
+   * @return pointer to buffer
+   */
+  const char *(*to_statestring)(
+      struct oonf_objectstate_str *buf, struct oonf_class *cl, void *ptr);
+
   /*! Size of class including extensions in bytes */
   size_t total_size;
 
   /*! List node for classes */
   struct avl_node _node;
 
+#ifdef OONF_CLASS_SLAB
+  /*! allocator for memory blocks of this class */
+  struct slab _slab;
+#else
   /*! List head for recyclable blocks */
   struct list_entity _free_list;
+#endif
 
   /*! extensions of this class */
   struct list_entity _extensions;
@@ -164,6 +191,16 @@ struct oonf_class_extension {
    */
   void (*cb_remove)(void *ptr);
 
+  /**
+   * Callback to notify about any event of a class object, called
+   * after the event specific callback
+   * @param ext pointer to this class extension
+   * @param ptr pointer to object
+   * @param evt type of event
+   */
+  void (*cb_event)(struct oonf_class_extension *ext,
+      void *ptr, enum oonf_class_event evt);
+
   /*! node for hooking the consumer into the provider */
   struct list_entity _node;
 };
@@ -183,6 +220,9 @@ EXPORT void oonf_class_event(struct oonf_class *, void *, enum oonf_class_event)
 
 EXPORT struct avl_tree *oonf_class_get_tree(void);
 EXPORT const char *oonf_class_get_event_name(enum oonf_class_event);
+EXPORT void oonf_class_append_state(struct oonf_objectstate_str *buf,
+    const char *name, const char *format, ...)
+    __attribute__ ((format(printf, 3, 4)));
 
 /**
  * @param ci pointer to class
@@ -199,7 +239,11 @@ oonf_class_get_usage(struct oonf_class *ci) {
  */
 static INLINE uint32_t
 oonf_class_get_free(struct oonf_class *ci) {
+#ifdef OONF_CLASS_SLAB
+  return slab_get_free(&ci->_slab);
+#else
   return ci->_free_list_size;
+#endif
 }
 
 /**
@@ -208,7 +252,11 @@ oonf_class_get_free(struct oonf_class *ci) {
  */
 static INLINE uint32_t
 oonf_class_get_allocations(struct oonf_class *ci) {
+#ifdef OONF_CLASS_SLAB
+  return ci->_slab.allocated;
+#else
   return ci->_allocated;
+#endif
 }
 
 /**
@@ -217,7 +265,51 @@ oonf_class_get_allocations(struct oonf_class *ci) {
  */
 static INLINE uint32_t
 oonf_class_get_recycled(struct oonf_class *ci) {
+#ifdef OONF_CLASS_SLAB
+  return ci->_slab.recycled;
+#else
   return ci->_recycled;
+#endif
+}
+
+/**
+ * @param ci pointer to class
+ * @return number of memory pages allocated for class, 0 without slab allocator
+ */
+static INLINE uint32_t
+oonf_class_get_pages(struct oonf_class *ci __attribute__((unused))) {
+#ifdef OONF_CLASS_SLAB
+  return ci->_slab.pages;
+#else
+  return 0;
+#endif
+}
+
+/**
+ * @param ci pointer to class
+ * @return size of memory pages of class in bytes, 0 without slab allocator
+ */
+static INLINE size_t
+oonf_class_get_page_size(struct oonf_class *ci __attribute__((unused))) {
+#ifdef OONF_CLASS_SLAB
+  return ci->_slab.page_size;
+#else
+  return 0;
+#endif
+}
+
+/**
+ * @param ci pointer to class
+ * @return percentage of page memory not used by objects,
+ *   0 without slab allocator
+ */
+static INLINE uint32_t
+oonf_class_get_fragmentation(struct oonf_class *ci __attribute__((unused))) {
+#ifdef OONF_CLASS_SLAB
+  return slab_get_fragmentation(&ci->_slab);
+#else
+  return 0;
+#endif
 }
 
 /**
@@ -70,6 +70,12 @@ static int _init(void);
 /* absolute monotonic clock measured in milliseconds compared to start time */
 static uint64_t now_times;
 
+/* absolute monotonic clock measured in microseconds compared to start time */
+static uint64_t now_usec;
+
+/* last timestamp of oonf_clock_update() or oonf_clock_measureUsec() in microseconds */
+static uint64_t measured_usec;
+
 /* arbitrary timestamp that represents the time oonf_clock_init() was called */
 static uint64_t start_time;
 
@@ -98,6 +104,8 @@ _init(void) {
   }
 
   now_times = 0;
+  now_usec = 0;
+  measured_usec = 0;
 
   return 0;
 }
@@ -110,12 +118,23 @@ int
 oonf_clock_update(void)
 {
   uint64_t now;
+
+  if (os_clock_gettime64_ns(&now) == 0) {
+    /* one clock read for both resolutions */
+    now_times = now / 1000000ull - start_time;
+    now_usec = now / 1000ull - start_time * USEC_PER_MSEC;
+    measured_usec = now_usec;
+    return 0;
+  }
+
   if (os_clock_gettime64(&now)) {
     OONF_WARN(LOG_CLOCK, "OS clock is not working: %s (%d)\n", strerror(errno), errno);
     return -1;
   }
 
   now_times = now - start_time;
+  now_usec = now_times * USEC_PER_MSEC;
+  measured_usec = now_usec;
   return 0;
 }
 
@@ -128,6 +147,41 @@ oonf_clock_getNow(void) {
   return now_times;
 }
 
+/**
+ * Calculates the current time in microseconds, updated together
+ * with the internal OONF time by oonf_clock_update()
+ * @return current time in microseconds
+ */
+uint64_t
+oonf_clock_getNowUsec(void) {
+  return now_usec;
+}
+
+/**
+ * Read the clock for runtime measurements without changing the
+ * internal OONF time.
+ * @return current time in microseconds, the last measured time
+ *   if the clock cannot be read
+ */
+uint64_t
+oonf_clock_measureUsec(void) {
+  uint64_t now;
+
+  if (os_clock_gettime64_ns(&now) == 0) {
+    measured_usec = now / 1000ull - start_time * USEC_PER_MSEC;
+  }
+  return measured_usec;
+}
+
+/**
+ * @return time of the last call to oonf_clock_update() or
+ *   oonf_clock_measureUsec() in microseconds, without reading the clock
+ */
+uint64_t
+oonf_clock_getMeasuredUsec(void) {
+  return measured_usec;
+}
+
 /**
  * Format an internal time value into a string.
  * Displays hours:minutes:seconds.millisecond.
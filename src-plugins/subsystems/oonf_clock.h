@@ -164,6 +164,9 @@ enum {
 EXPORT int oonf_clock_update(void) __attribute__((warn_unused_result));
 
 EXPORT uint64_t oonf_clock_getNow(void);
+EXPORT uint64_t oonf_clock_getNowUsec(void);
+EXPORT uint64_t oonf_clock_measureUsec(void);
+EXPORT uint64_t oonf_clock_getMeasuredUsec(void);
 
 EXPORT const char *oonf_clock_toClockString(struct isonumber_str *, uint64_t);
 
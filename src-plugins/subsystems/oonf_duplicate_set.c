@@ -50,6 +50,7 @@
 #include "rfc5444/rfc5444.h"
 #include "core/oonf_subsystem.h"
 #include "subsystems/oonf_class.h"
+#include "subsystems/oonf_clock.h"
 #include "subsystems/oonf_timer.h"
 
 #include "subsystems/oonf_duplicate_set.h"
@@ -61,13 +62,30 @@
 static int _init(void);
 static void _cleanup(void);
 
+static enum oonf_duplicate_result _entry_add(struct oonf_duplicate_set *,
+    uint8_t msg_type, struct netaddr *, uint64_t seqno, uint64_t vtime);
+static enum oonf_duplicate_result _entry_test(struct oonf_duplicate_set *,
+    uint8_t msg_type, struct netaddr *, uint64_t seqno);
 static enum oonf_duplicate_result _test(struct oonf_duplicate_set *,
-    struct oonf_duplicate_entry *, uint64_t seqno, bool set);
+    struct dupset_window *, uint64_t seqno, bool set);
+static void _init_window(struct dupset_window *, uint64_t seqno);
+
+#ifdef OONF_DUPSET_HASH
+static void _cb_sweep(struct oonf_timer_instance *);
+#else
 static int _avl_cmp_dupkey(const void *, const void*);
 
 static void _cb_vtime(struct oonf_timer_instance *);
 static void _remove_duplicate_entry(struct oonf_duplicate_entry *entry);
+#endif
 
+#ifdef OONF_DUPSET_HASH
+static struct oonf_timer_class _sweep_info = {
+  .name = "Sweep of hashed duplicate set",
+  .callback = _cb_sweep,
+  .periodic = true,
+};
+#else
 static struct oonf_timer_class _vtime_info = {
   .name = "Valdity time for duplicate set",
   .callback = _cb_vtime,
@@ -77,6 +95,7 @@ static struct oonf_class _dupset_class = {
   .name = "Duplicate set",
   .size = sizeof(struct oonf_duplicate_entry),
 };
+#endif
 
 /* dupset result names */
 static const char *OONF_DUPSET_RESULT_STR[] = {
@@ -91,6 +110,7 @@ static const char *OONF_DUPSET_RESULT_STR[] = {
 /* subsystem definition */
 static const char *_dependencies[] = {
   OONF_CLASS_SUBSYSTEM,
+  OONF_CLOCK_SUBSYSTEM,
   OONF_TIMER_SUBSYSTEM,
 };
 
@@ -116,8 +136,12 @@ static const int64_t _mask_values[] = {
  */
 static int
 _init(void) {
+#ifdef OONF_DUPSET_HASH
+  oonf_timer_add(&_sweep_info);
+#else
   oonf_class_add(&_dupset_class);
   oonf_timer_add(&_vtime_info);
+#endif
   return 0;
 }
 
@@ -126,8 +150,12 @@ _init(void) {
  */
 static void
 _cleanup(void) {
+#ifdef OONF_DUPSET_HASH
+  oonf_timer_remove(&_sweep_info);
+#else
   oonf_timer_remove(&_vtime_info);
   oonf_class_remove(&_dupset_class);
+#endif
 }
 
 /**
@@ -138,7 +166,12 @@ _cleanup(void) {
 void
 oonf_duplicate_set_add(struct oonf_duplicate_set *set, enum oonf_dupset_type type) {
   memset(set, 0, sizeof(*set));
+#ifdef OONF_DUPSET_HASH
+  dupset_table_init(&set->_table);
+  set->_sweep.class = &_sweep_info;
+#else
   avl_init(&set->_tree, _avl_cmp_dupkey, false);
+#endif
 
   if (type != OONF_DUPSET_64BIT) {
     set->_mask   = _mask_values[type];
@@ -153,11 +186,16 @@ oonf_duplicate_set_add(struct oonf_duplicate_set *set, enum oonf_dupset_type typ
  */
 void
 oonf_duplicate_set_remove(struct oonf_duplicate_set *set) {
+#ifdef OONF_DUPSET_HASH
+  oonf_timer_stop(&set->_sweep);
+  dupset_table_free(&set->_table);
+#else
   struct oonf_duplicate_entry *entry, *it;
 
   avl_for_each_element_safe(&set->_tree, entry, _node, it) {
     _remove_duplicate_entry(entry);
   }
+#endif
 }
 
 /**
@@ -176,14 +214,133 @@ oonf_duplicate_set_remove(struct oonf_duplicate_set *set) {
 enum oonf_duplicate_result
 oonf_duplicate_entry_add(struct oonf_duplicate_set *set, uint8_t msg_type,
     struct netaddr *originator, uint64_t seqno, uint64_t vtime) {
-  struct oonf_duplicate_entry *entry;
-  struct oonf_duplicate_entry_key key;
   enum oonf_duplicate_result result;
 
 #ifdef OONF_LOG_DEBUG_INFO
   struct netaddr_str nbuf;
 #endif
 
+  result = _entry_add(set, msg_type, originator, seqno, vtime);
+
+  OONF_DEBUG(LOG_DUPLICATE_SET, "Test/Add msgtype %u, originator %s, seqno %"PRIu64": %s",
+      msg_type, netaddr_to_string(&nbuf, originator), seqno,
+      OONF_DUPSET_RESULT_STR[result]);
+  return result;
+}
+
+/**
+ * Test a originator/sequence number pair against a duplicate set
+ * @param set duplicate set
+ * @param msg_type message type with incoming sequence number
+ * @param originator originator of sequence number
+ * @param seqno sequence number
+ * @return OONF_DUPSET_TOO_OLD if sequence number is more than 32 behind
+ *   the current one, OONF_DUPSET_DUPLICATE if the number is in the set,
+ *   OONF_DUPSET_NEW if the number was added to the set and OONF_DUPSET_NEWEST
+ *   if the sequence number is newer than the newest in the set
+ */
+enum oonf_duplicate_result
+oonf_duplicate_test(struct oonf_duplicate_set *set, uint8_t msg_type,
+    struct netaddr *originator, uint64_t seqno) {
+  enum oonf_duplicate_result result;
+
+#ifdef OONF_LOG_DEBUG_INFO
+  struct netaddr_str nbuf;
+#endif
+
+  result = _entry_test(set, msg_type, originator, seqno);
+
+  OONF_DEBUG(LOG_DUPLICATE_SET, "Test msgtype %u, originator %s, seqno %"PRIu64": %s",
+      msg_type, netaddr_to_string(&nbuf, originator), seqno,
+      OONF_DUPSET_RESULT_STR[result]);
+
+  return result;
+}
+
+#ifdef OONF_DUPSET_HASH
+/**
+ * Test a originator/seqno pair against a hashed duplicate set and add
+ * it to the set if necessary
+ * @param set duplicate set
+ * @param msg_type message type with incoming sequence number
+ * @param originator originator of sequence number
+ * @param seqno sequence number
+ * @param vtime validity time of sequence number
+ * @return result of duplicate check
+ */
+static enum oonf_duplicate_result
+_entry_add(struct oonf_duplicate_set *set, uint8_t msg_type,
+    struct netaddr *originator, uint64_t seqno, uint64_t vtime) {
+  struct dupset_table_entry *entry;
+  enum oonf_duplicate_result result;
+
+  entry = dupset_table_get(&set->_table, msg_type, originator);
+  if (entry != NULL && entry->expire > oonf_clock_getNow()) {
+    result = _test(set, &entry->window, seqno, true);
+  }
+  else {
+    if (entry == NULL) {
+      entry = dupset_table_insert(&set->_table, msg_type, originator);
+      if (entry == NULL) {
+        return OONF_DUPSET_TOO_OLD;
+      }
+
+      if (!oonf_timer_is_active(&set->_sweep)) {
+        oonf_timer_start_ext(&set->_sweep,
+            OONF_DUPSET_SWEEP_INTERVAL, OONF_DUPSET_SWEEP_INTERVAL);
+      }
+    }
+
+    /* new or timed out entry, not yet removed by the sweep */
+    _init_window(&entry->window, seqno);
+    result = OONF_DUPSET_FIRST;
+  }
+
+  if (oonf_duplicate_is_new(result)) {
+    /* reset validity time */
+    entry->expire = oonf_clock_get_absolute(vtime);
+  }
+  return result;
+}
+
+/**
+ * Test a originator/sequence number pair against a hashed duplicate set
+ * @param set duplicate set
+ * @param msg_type message type with incoming sequence number
+ * @param originator originator of sequence number
+ * @param seqno sequence number
+ * @return result of duplicate check
+ */
+static enum oonf_duplicate_result
+_entry_test(struct oonf_duplicate_set *set, uint8_t msg_type,
+    struct netaddr *originator, uint64_t seqno) {
+  struct dupset_table_entry *entry;
+
+  entry = dupset_table_get(&set->_table, msg_type, originator);
+  if (entry == NULL || entry->expire <= oonf_clock_getNow()) {
+    return OONF_DUPSET_FIRST;
+  }
+  return _test(set, &entry->window, seqno, false);
+}
+
+#else
+/**
+ * Test a originator/seqno pair against a duplicate set tree and add
+ * it to the set if necessary
+ * @param set duplicate set
+ * @param msg_type message type with incoming sequence number
+ * @param originator originator of sequence number
+ * @param seqno sequence number
+ * @param vtime validity time of sequence number
+ * @return result of duplicate check
+ */
+static enum oonf_duplicate_result
+_entry_add(struct oonf_duplicate_set *set, uint8_t msg_type,
+    struct netaddr *originator, uint64_t seqno, uint64_t vtime) {
+  struct oonf_duplicate_entry *entry;
+  struct oonf_duplicate_entry_key key;
+  enum oonf_duplicate_result result;
+
   /* generate combined key */
   memcpy(&key.addr, originator, sizeof(*originator));
   key.msg_type = msg_type;
@@ -196,8 +353,7 @@ oonf_duplicate_entry_add(struct oonf_duplicate_set *set, uint8_t msg_type,
     }
 
     /* initialize history and current sequence number */
-    entry->current = seqno;
-    entry->history = 1;
+    _init_window(&entry->window, seqno);
 
     /* initialize backpointer */
     entry->set = set;
@@ -215,11 +371,8 @@ oonf_duplicate_entry_add(struct oonf_duplicate_set *set, uint8_t msg_type,
     result = OONF_DUPSET_FIRST;
   }
   else {
-    result = _test(set, entry, seqno, true);
+    result = _test(set, &entry->window, seqno, true);
   }
-  OONF_DEBUG(LOG_DUPLICATE_SET, "Test/Add msgtype %u, originator %s, seqno %"PRIu64": %s",
-      msg_type, netaddr_to_string(&nbuf, originator), seqno,
-      OONF_DUPSET_RESULT_STR[result]);
 
   if (oonf_duplicate_is_new(result)) {
     /* reset validity timer */
@@ -229,26 +382,18 @@ oonf_duplicate_entry_add(struct oonf_duplicate_set *set, uint8_t msg_type,
 }
 
 /**
- * Test a originator/sequence number pair against a duplicate set
+ * Test a originator/sequence number pair against a duplicate set tree
  * @param set duplicate set
  * @param msg_type message type with incoming sequence number
  * @param originator originator of sequence number
  * @param seqno sequence number
- * @return OONF_DUPSET_TOO_OLD if sequence number is more than 32 behind
- *   the current one, OONF_DUPSET_DUPLICATE if the number is in the set,
- *   OONF_DUPSET_NEW if the number was added to the set and OONF_DUPSET_NEWEST
- *   if the sequence number is newer than the newest in the set
+ * @return result of duplicate check
  */
-enum oonf_duplicate_result
-oonf_duplicate_test(struct oonf_duplicate_set *set, uint8_t msg_type,
+static enum oonf_duplicate_result
+_entry_test(struct oonf_duplicate_set *set, uint8_t msg_type,
     struct netaddr *originator, uint64_t seqno) {
   struct oonf_duplicate_entry *entry;
   struct oonf_duplicate_entry_key key;
-  enum oonf_duplicate_result result;
-
-#ifdef OONF_LOG_DEBUG_INFO
-  struct netaddr_str nbuf;
-#endif
 
   /* generate combined key */
   memcpy(&key.addr, originator, sizeof(*originator));
@@ -256,18 +401,11 @@ oonf_duplicate_test(struct oonf_duplicate_set *set, uint8_t msg_type,
 
   entry = avl_find_element(&set->_tree, &key, entry, _node);
   if (!entry) {
-    result = OONF_DUPSET_FIRST;
+    return OONF_DUPSET_FIRST;
   }
-  else {
-    result = _test(set, entry, seqno, false);
-  }
-
-  OONF_DEBUG(LOG_DUPLICATE_SET, "Test msgtype %u, originator %s, seqno %"PRIu64": %s",
-      msg_type, netaddr_to_string(&nbuf, originator), seqno,
-      OONF_DUPSET_RESULT_STR[result]);
-
-  return result;
+  return _test(set, &entry->window, seqno, false);
 }
+#endif
 
 static int64_t
 _seqno_difference(struct oonf_duplicate_set *set, uint64_t seqno1, uint64_t seqno2) {
@@ -287,8 +425,9 @@ _seqno_difference(struct oonf_duplicate_set *set, uint64_t seqno1, uint64_t seqn
   return reldiff;
 }
 /**
- * Test a sequence number against a duplicate set entry
- * @param entry duplicate set entry
+ * Test a sequence number against the window of a duplicate set entry
+ * @param dupset duplicate set
+ * @param window sequence number window of entry
  * @param seqno sequence number
  * @param set true to add the sequence number to the entry, false
  *   to leave the entry unchanged.
@@ -300,26 +439,26 @@ _seqno_difference(struct oonf_duplicate_set *set, uint64_t seqno1, uint64_t seqn
  */
 enum oonf_duplicate_result
 _test(struct oonf_duplicate_set *dupset,
-    struct oonf_duplicate_entry *entry,
+    struct dupset_window *window,
     uint64_t seqno, bool set) {
   int64_t diff;
 
-  if (seqno == entry->current) {
+  if (seqno == window->current) {
     return OONF_DUPSET_CURRENT;
   }
 
   /* eliminate rollover */
-  diff = _seqno_difference(dupset, seqno, entry->current);
+  diff = _seqno_difference(dupset, seqno, window->current);
   if (diff < -31) {
-    entry->too_old_count++;
-    if (entry->too_old_count > OONF_DUPSET_MAXIMUM_TOO_OLD) {
+    window->too_old_count++;
+    if (window->too_old_count > OONF_DUPSET_MAXIMUM_TOO_OLD) {
       /*
        * we got a long continuous series of too old messages,
        * most likely the did reset and changed its sequence number
        */
-      entry->history = 1;
-      entry->too_old_count = 0;
-      entry->current = seqno;
+      window->history = 1;
+      window->too_old_count = 0;
+      window->current = seqno;
 
       return OONF_DUPSET_NEWEST;
     }
@@ -327,36 +466,48 @@ _test(struct oonf_duplicate_set *dupset,
   }
 
   /* reset counter of too old messages */
-  entry->too_old_count = 0;
+  window->too_old_count = 0;
 
   if (diff <= 0) {
     uint32_t bitmask = 1 << ((uint32_t) (-diff));
 
-    if ((entry->history & bitmask) != 0) {
+    if ((window->history & bitmask) != 0) {
       return OONF_DUPSET_DUPLICATE;
     }
 
     if (set) {
-      entry->history |= bitmask;
+      window->history |= bitmask;
     }
     return OONF_DUPSET_NEW;
   }
 
   if (set) {
     /* new sequence number is larger than last one */
-    entry->current = seqno;
+    window->current = seqno;
 
     if (diff >= 32) {
-      entry->history = 1;
+      window->history = 1;
     }
     else {
-      entry->history <<= diff;
-      entry->history |= 1;
+      window->history <<= diff;
+      window->history |= 1;
     }
   }
   return OONF_DUPSET_NEWEST;
 }
 
+/**
+ * Initialize the window of a new duplicate set entry
+ * @param window sequence number window
+ * @param seqno first sequence number
+ */
+static void
+_init_window(struct dupset_window *window, uint64_t seqno) {
+  window->current = seqno;
+  window->history = 1;
+  window->too_old_count = 0;
+}
+
 /**
  * Get text representation of duplicate check result
  * @param result duplicate check result
@@ -367,6 +518,35 @@ oonf_duplicate_get_result_str(enum oonf_duplicate_result result) {
   return OONF_DUPSET_RESULT_STR[result];
 }
 
+#ifdef OONF_DUPSET_HASH
+/**
+ * Callback fired to remove all timed out entries of a duplicate set
+ * @param ptr timer instance that fired
+ */
+static void
+_cb_sweep(struct oonf_timer_instance *ptr) {
+  struct oonf_duplicate_set *set;
+
+#ifdef OONF_LOG_DEBUG_INFO
+  size_t removed;
+#endif
+
+  set = container_of(ptr, struct oonf_duplicate_set, _sweep);
+
+#ifdef OONF_LOG_DEBUG_INFO
+  removed = dupset_table_expire(&set->_table, oonf_clock_getNow());
+  OONF_DEBUG(LOG_DUPLICATE_SET, "Duplicate set sweep removed %"PRINTF_SIZE_T_SPECIFIER
+      " entries, %u left", removed, set->_table.count);
+#else
+  dupset_table_expire(&set->_table, oonf_clock_getNow());
+#endif
+
+  if (set->_table.count == 0) {
+    oonf_timer_stop(&set->_sweep);
+  }
+}
+
+#else
 /**
  * Comparator for duplicate entry keys
  * @param p1 key1
@@ -416,3 +596,4 @@ _remove_duplicate_entry(struct oonf_duplicate_entry *entry) {
 
   oonf_class_free(&_dupset_class, entry);
 }
+#endif
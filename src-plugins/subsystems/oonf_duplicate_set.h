@@ -48,6 +48,7 @@
 
 #include "common/avl.h"
 #include "common/common_types.h"
+#include "common/dupset_table.h"
 #include "common/netaddr.h"
 #include "subsystems/oonf_timer.h"
 
@@ -62,7 +63,10 @@ enum {
    * number of consecutive 'too old' sequence numbers before
    * algorithm resets
    */
-  OONF_DUPSET_MAXIMUM_TOO_OLD = 8
+  OONF_DUPSET_MAXIMUM_TOO_OLD = 8,
+
+  /*! interval between two sweeps over the hashed duplicate set */
+  OONF_DUPSET_SWEEP_INTERVAL = 1000,
 };
 
 /**
@@ -92,8 +96,16 @@ enum oonf_duplicate_result {
  * session data for detecting duplicate sequence numbers for addresses
  */
 struct oonf_duplicate_set {
+#ifdef OONF_DUPSET_HASH
+  /*! hash table of duplicate entries */
+  struct dupset_table _table;
+
+  /*! timer for removing outdated entries of the table */
+  struct oonf_timer_instance _sweep;
+#else
   /*! tree of duplicate entries */
   struct avl_tree _tree;
+#endif
 
   /*! mask for detecting overflow */
   int64_t _mask;
@@ -117,20 +129,15 @@ struct oonf_duplicate_entry_key {
 };
 
 /**
- * State of duplicate detection for one unique key
+ * State of duplicate detection for one unique key, used if
+ * the duplicate set is stored in an AVL tree
  */
 struct oonf_duplicate_entry {
   /*! unique key for duplicate detection */
   struct oonf_duplicate_entry_key key;
 
-  /*! bit buffer for duplicate detection */
-  uint64_t history;
-
-  /*! newest received sequence number */
-  uint64_t current;
-
-  /*! number of too old consecutive sequence numbers without a newer one */
-  uint16_t too_old_count;
+  /*! window of received sequence numbers */
+  struct dupset_window window;
 
   /*! back pointer to duplicate set */
   struct oonf_duplicate_set *set;
@@ -96,8 +96,10 @@ static const char HTTP_POST[] = "POST";
 
 static const char HTTP_CONTENT_LENGTH[] = "Content-Length";
 static const char HTTP_CONTENT_TYPE[] = "Content-Type";
+static const char HTTP_IF_NONE_MATCH[] = "If-None-Match";
 
 static const char HTTP_RESPONSE_200[] = "OK";
+static const char HTTP_RESPONSE_304[] = "Not Modified";
 static const char HTTP_RESPONSE_400[] = "Bad Request";
 static const char HTTP_RESPONSE_401[] = "Unauthorized";
 static const char HTTP_RESPONSE_403[] = "Forbidden";
@@ -130,12 +132,14 @@ static struct oonf_http_handler *_get_site_handler(const char *uri);
 static const char *_get_headertype_string(enum oonf_http_result type);
 static void _create_http_header(struct oonf_stream_session *session,
     enum oonf_http_result code, const char *content_type,
-    size_t content_length);
+    const char *etag, size_t content_length);
+static bool _is_not_modified(struct oonf_http_session *session);
 static int _parse_http_header(char *header_data, size_t header_len,
     struct oonf_http_session *header);
 static size_t _parse_query_string(char *s,
     char **name, char **value, size_t count);
 static void  _decode_uri(char *src);
+static const char *_get_telnet_etag(struct oonf_http_session *session);
 static enum oonf_http_result _cb_telnet_handler(
       struct autobuf *out, struct oonf_http_session *);
 static enum oonf_http_result _cb_file_handler(
@@ -180,6 +184,9 @@ static struct oonf_stream_managed _http_managed_socket = {
 
 static struct _http_config _config;
 
+/* random prefix for entity tags, changes with each restart */
+static uint32_t _etag_salt;
+
 /* integrated telnet/file handler */
 static struct oonf_http_handler _telnet_handler = {
   .site = HTTP_TO_TELNET,
@@ -215,10 +222,14 @@ DECLARE_OONF_PLUGIN(_oonf_http_subsystem);
 
 /**
  * Initialize http subsystem
- * @return always returns 0
+ * @return -1 if an error happened, 0 otherwise
  */
 static int
 _init(void) {
+  if (os_core_get_random(&_etag_salt, sizeof(_etag_salt))) {
+    return -1;
+  }
+
   oonf_stream_add_managed(&_http_managed_socket);
   avl_init(&_http_site_tree, avl_comp_strcasecmp, false);
 
@@ -401,7 +412,7 @@ _cb_receive_data(struct oonf_stream_session *session) {
   if (handler->content) {
     /* static content */
     abuf_memcpy(&session->out, handler->content, handler->content_size);
-    _create_http_header(session, HTTP_200_OK, NULL, abuf_getlen(&session->out));
+    _create_http_header(session, HTTP_200_OK, NULL, NULL, abuf_getlen(&session->out));
   }
   else {
     /* custom handler */
@@ -426,6 +437,11 @@ _cb_receive_data(struct oonf_stream_session *session) {
       abuf_setlen(&session->out, len);
       result = HTTP_500_INTERNAL_SERVER_ERROR;
     }
+    else if (result == HTTP_200_OK && _is_not_modified(&header)) {
+      /* client already has this content */
+      abuf_setlen(&session->out, len);
+      result = HTTP_304_NOT_MODIFIED;
+    }
 
     if (result == HTTP_START_FILE_TRANSFER) {
       os_fd_init(&session->copy_fd, header.transfer_fd);
@@ -433,7 +449,11 @@ _cb_receive_data(struct oonf_stream_session *session) {
       session->copy_bytes_sent = 0;
 
       _create_http_header(session, HTTP_200_OK,
-          header.content_type, header.transfer_length);
+          header.content_type, NULL, header.transfer_length);
+    }
+    else if (result == HTTP_304_NOT_MODIFIED) {
+      _create_http_header(session, HTTP_304_NOT_MODIFIED,
+          header.content_type, header.etag, 0);
     }
     else if (result != HTTP_200_OK) {
       /* create error message */
@@ -441,7 +461,7 @@ _cb_receive_data(struct oonf_stream_session *session) {
     }
     else {
       _create_http_header(session, HTTP_200_OK,
-          header.content_type, abuf_getlen(&session->out));
+          header.content_type, header.etag, abuf_getlen(&session->out));
     }
   }
   return STREAM_SESSION_SEND_AND_QUIT;
@@ -510,7 +530,28 @@ _create_http_error(struct oonf_stream_session *session,
       "<body><h1>HTTP error %d: %s</h1></body></html>",
       oonf_log_get_appdata()->app_name, oonf_log_get_libdata()->version,
       error, _get_headertype_string(error));
-  _create_http_header(session, error, NULL, abuf_getlen(&session->out));
+  _create_http_header(session, error, NULL, NULL, abuf_getlen(&session->out));
+}
+
+/**
+ * Check if the client already has the current version of the content
+ * @param session pointer to http session
+ * @return true if the entity tag of the content matches the
+ *   If-None-Match header of the request
+ */
+static bool
+_is_not_modified(struct oonf_http_session *session) {
+  const char *match;
+
+  if (session->etag == NULL) {
+    return false;
+  }
+
+  match = oonf_http_lookup_header(session, HTTP_IF_NONE_MATCH);
+  if (match == NULL) {
+    return false;
+  }
+  return strcmp(match, "*") == 0 || strstr(match, session->etag) != NULL;
 }
 
 /**
@@ -564,6 +605,8 @@ _get_headertype_string(enum oonf_http_result type) {
   switch (type) {
     case HTTP_200_OK:
       return HTTP_RESPONSE_200;
+    case HTTP_304_NOT_MODIFIED:
+      return HTTP_RESPONSE_304;
     case HTTP_400_BAD_REQ:
       return HTTP_RESPONSE_400;
     case HTTP_401_UNAUTHORIZED:
@@ -591,12 +634,14 @@ _get_headertype_string(enum oonf_http_result type) {
  * @param session pointer to tcp session
  * @param code http result code
  * @param content_type explicit content type or NULL for
+ * @param etag entity tag of content, NULL if not used
  * @param content_length length of content, 0 for no content length
  *   plain html
  */
 static void
 _create_http_header(struct oonf_stream_session *session,
-    enum oonf_http_result code, const char *content_type, size_t content_length) {
+    enum oonf_http_result code, const char *content_type,
+    const char *etag, size_t content_length) {
   struct autobuf buf;
   struct timeval currtime;
 
@@ -629,13 +674,17 @@ _create_http_header(struct oonf_stream_session *session,
     abuf_appendf(&buf, "Content-length: %zu\r\n", content_length);
   }
 
+  if (etag != NULL) {
+    abuf_appendf(&buf, "ETag: %s\r\n", etag);
+  }
+
   if (code == HTTP_401_UNAUTHORIZED) {
     abuf_appendf(&buf, "WWW-Authenticate: Basic realm=\"%s\"\r\n", "RealmName");
   }
 
   /*
    * Cache-control
-   * No caching dynamic pages
+   * No caching dynamic pages without revalidation
    */
   abuf_puts(&buf, "Cache-Control: no-cache\r\n");
 
@@ -883,6 +932,45 @@ _decode_uri(char *src) {
   *dst = 0;
 }
 
+/**
+ * Calculate the entity tag of a http to telnet bridge request
+ * @param session http session
+ * @return entity tag, NULL if the output of a command is not cacheable
+ */
+static const char *
+_get_telnet_etag(struct oonf_http_session *session) {
+  static char etag[40];
+  char buffer[1024];
+  char *ptr1, *ptr2, *ptr3;
+  uint64_t generation, sum;
+
+  strscpy(buffer, &session->decoded_request_uri[sizeof(HTTP_TO_TELNET)-1], sizeof(buffer));
+
+  sum = 0;
+  for (ptr1 = buffer; ptr1 != NULL; ptr1 = ptr2) {
+    ptr2 = strchr(ptr1, '/');
+    if (ptr2) {
+      *ptr2++ = 0;
+    }
+
+    ptr3 = strchr(ptr1, ' ');
+    if (ptr3) {
+      *ptr3++ = 0;
+    }
+
+    generation = oonf_telnet_get_generation(ptr1, ptr3 ? ptr3 : "", session->remote);
+    if (generation == 0) {
+      return NULL;
+    }
+
+    /* generations only increase, so the sum changes with each of them */
+    sum += generation;
+  }
+
+  snprintf(etag, sizeof(etag), "\"%08x-%" PRIx64 "\"", _etag_salt, sum);
+  return etag;
+}
+
 /**
  * Http to Telnet bridge
  * @param out output stream
@@ -897,6 +985,13 @@ _cb_telnet_handler(struct autobuf *out, struct oonf_http_session *session) {
   char *ptr1, *ptr2, *ptr3;
 
   session->content_type = HTTP_CONTENTTYPE_TEXT;
+
+  session->etag = _get_telnet_etag(session);
+  if (_is_not_modified(session)) {
+    /* skip generating the output */
+    return HTTP_304_NOT_MODIFIED;
+  }
+
   strscpy(buffer, &session->decoded_request_uri[sizeof(HTTP_TO_TELNET)-1], sizeof(buffer));
 
   ptr1 = buffer;
@@ -81,6 +81,7 @@ enum {
  */
 enum oonf_http_result {
   HTTP_200_OK = 200,
+  HTTP_304_NOT_MODIFIED = 304,
   HTTP_400_BAD_REQ = 400,
   HTTP_401_UNAUTHORIZED = 401,
   HTTP_403_FORBIDDEN = STREAM_REQUEST_FORBIDDEN,
@@ -135,6 +136,13 @@ struct oonf_http_session {
   /*! content type for answer, NULL means plain/html */
   const char *content_type;
 
+  /**
+   * entity tag of the answer, NULL if not used. The answer is
+   * replaced by a 'not modified' response if the client already
+   * has the same entity tag.
+   */
+  const char *etag;
+
   /*! file descriptor to file that is being downloaded in this session */
   int transfer_fd;
 
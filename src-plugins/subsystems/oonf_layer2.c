@@ -48,6 +48,7 @@
 #include "common/common_types.h"
 #include "common/json.h"
 #include "common/netaddr.h"
+#include "common/netaddr_trie.h"
 #include "config/cfg_schema.h"
 #include "core/oonf_subsystem.h"
 #include "subsystems/oonf_class.h"
@@ -65,6 +66,9 @@ static void _cleanup(void);
 static void _net_remove(struct oonf_layer2_net *l2net);
 static void _neigh_remove(struct oonf_layer2_neigh *l2neigh);
 
+static const char *_cb_neigh_to_keystring(struct oonf_objectkey_str *,
+    struct oonf_class *, void *);
+
 /* subsystem definition */
 static const char *_dependencies[] = {
   OONF_CLASS_SUBSYSTEM,
@@ -133,6 +137,7 @@ static struct oonf_class _l2network_class = {
 static struct oonf_class _l2neighbor_class = {
   .name = LAYER2_CLASS_NEIGHBOR,
   .size = sizeof(struct oonf_layer2_neigh),
+  .to_keystring = _cb_neigh_to_keystring,
 };
 static struct oonf_class _l2dst_class = {
   .name = LAYER2_CLASS_DESTINATION,
@@ -151,6 +156,9 @@ static struct avl_tree _oonf_layer2_net_tree;
 
 static struct avl_tree _oonf_originator_tree;
 
+/* all layer2 neighbor ip addresses for prefix lookups */
+static struct netaddr_trie _neighbor_ip_trie;
+
 /**
  * Subsystem constructor
  * @return always returns 0
@@ -165,6 +173,7 @@ _init(void) {
 
   avl_init(&_oonf_layer2_net_tree, avl_comp_strcasecmp, false);
   avl_init(&_oonf_originator_tree, avl_comp_strcasecmp, false);
+  netaddr_trie_init(&_neighbor_ip_trie, true);
   return 0;
 }
 
@@ -467,12 +476,18 @@ oonf_layer2_net_relabel(struct oonf_layer2_net *l2net,
  * @param l2net layer-2 network object
  * @param ip ip address or prefix
  * @return layer2 ip address object, NULL if out of memory
+ *   or if ip is not an IPv4 or IPv6 address
  */
 struct oonf_layer2_peer_address *
 oonf_layer2_net_add_ip(struct oonf_layer2_net *l2net,
     const struct oonf_layer2_origin *origin, const struct netaddr *ip) {
   struct oonf_layer2_peer_address *l2addr;
 
+  if (netaddr_get_address_family(ip) != AF_INET
+      && netaddr_get_address_family(ip) != AF_INET6) {
+    return NULL;
+  }
+
   l2addr = oonf_layer2_net_get_ip(l2net, ip);
   if (!l2addr) {
     l2addr = oonf_class_malloc(&_l2net_addr_class);
@@ -515,32 +530,16 @@ oonf_layer2_net_remove_ip(
 
 /**
  * Look for the best matching prefix in all layer2 neighbor addresses
- * that contains a specific address
+ * that contains a specific address. The shortest matching prefix
+ * is returned.
  * @param addr ip address to look for
  * @return layer2 neighbor address object, NULL if no match was found
  */
 struct oonf_layer2_neighbor_address *
 oonf_layer2_net_get_best_neighbor_match(const struct netaddr *addr) {
-  struct oonf_layer2_neighbor_address *best_match, *l2addr;
-  struct oonf_layer2_neigh *l2neigh;
-  struct oonf_layer2_net *l2net;
-  int prefix_length;
-
-  prefix_length = 256;
-  best_match = NULL;
+  struct oonf_layer2_neighbor_address *l2addr;
 
-  avl_for_each_element(&_oonf_layer2_net_tree, l2net, _node) {
-    avl_for_each_element(&l2net->neighbors, l2neigh, _node) {
-      avl_for_each_element(&l2neigh->remote_neighbor_ips, l2addr, _node) {
-        if (netaddr_is_in_subnet(&l2addr->ip, addr)
-            && netaddr_get_prefix_length(&l2addr->ip) < prefix_length) {
-          best_match = l2addr;
-          prefix_length = netaddr_get_prefix_length(&l2addr->ip);
-        }
-      }
-    }
-  }
-  return best_match;
+  return netaddr_trie_find_spm_element(&_neighbor_ip_trie, addr, l2addr, _trie_node);
 }
 
 /**
@@ -713,12 +712,18 @@ oonf_layer2_neigh_relabel(struct oonf_layer2_neigh *l2neigh,
  * @param l2net layer-2 network object
  * @param ip ip address or prefix
  * @return layer2 ip address object, NULL if out of memory
+ *   or if ip is not an IPv4 or IPv6 address
  */
 struct oonf_layer2_neighbor_address *
 oonf_layer2_neigh_add_ip(struct oonf_layer2_neigh *l2neigh,
     const struct oonf_layer2_origin *origin, const struct netaddr *ip) {
   struct oonf_layer2_neighbor_address *l2addr;
 
+  if (netaddr_get_address_family(ip) != AF_INET
+      && netaddr_get_address_family(ip) != AF_INET6) {
+    return NULL;
+  }
+
   l2addr = oonf_layer2_neigh_get_ip(l2neigh, ip);
   if (!l2addr) {
     l2addr = oonf_class_malloc(&_l2neigh_addr_class);
@@ -732,6 +737,13 @@ oonf_layer2_neigh_add_ip(struct oonf_layer2_neigh *l2neigh,
     /* set back reference */
     l2addr->l2neigh = l2neigh;
 
+    /* add to global trie for prefix lookups */
+    l2addr->_trie_node.key = &l2addr->ip;
+    if (netaddr_trie_insert(&_neighbor_ip_trie, &l2addr->_trie_node)) {
+      oonf_class_free(&_l2neigh_addr_class, l2addr);
+      return NULL;
+    }
+
     /* add to tree */
     l2addr->_node.key = &l2addr->ip;
     avl_insert(&l2neigh->remote_neighbor_ips, &l2addr->_node);
@@ -755,6 +767,7 @@ oonf_layer2_neigh_remove_ip(
   }
 
   avl_remove(&ip->l2neigh->remote_neighbor_ips, &ip->_node);
+  netaddr_trie_remove(&_neighbor_ip_trie, &ip->_trie_node);
   oonf_class_free(&_l2neigh_addr_class, ip);
   return 0;
 }
@@ -977,3 +990,21 @@ _neigh_remove(struct oonf_layer2_neigh *l2neigh) {
   avl_remove(&l2neigh->network->neighbors, &l2neigh->_node);
   oonf_class_free(&_l2neighbor_class, l2neigh);
 }
+
+/**
+ * Keystring creator for layer-2 neighbors
+ * @param buf pointer to target buffer
+ * @param class layer-2 neighbor class
+ * @param ptr pointer to layer-2 neighbor
+ * @return pointer to target buffer
+ */
+static const char *
+_cb_neigh_to_keystring(struct oonf_objectkey_str *buf,
+    struct oonf_class *class __attribute__((unused)), void *ptr) {
+  struct oonf_layer2_neigh *l2neigh = ptr;
+  struct netaddr_str nbuf;
+
+  snprintf(buf->buf, sizeof(*buf), "%s::%s",
+      l2neigh->network->name, netaddr_to_string(&nbuf, &l2neigh->addr));
+  return buf->buf;
+}
@@ -48,6 +48,7 @@
 
 #include "common/avl.h"
 #include "common/common_types.h"
+#include "common/netaddr_trie.h"
 #include "core/oonf_subsystem.h"
 #include "subsystems/os_interface.h"
 
@@ -355,6 +356,9 @@ struct oonf_layer2_neighbor_address {
 
   /*! node for tree of ip addresses */
   struct avl_node _node;
+
+  /*! node for global trie of neighbor ip addresses */
+  struct netaddr_trie_node _trie_node;
 };
 
 /**
@@ -44,6 +44,7 @@
  */
 
 #include <errno.h>
+#include <stdlib.h>
 
 #include "common/common_types.h"
 #include "common/list.h"
@@ -81,6 +82,8 @@ static int _apply_managed_socket(struct oonf_packet_managed *managed,
 static void _cb_packet_event_unicast(struct oonf_socket_entry *);
 static void _cb_packet_event_multicast(struct oonf_socket_entry *);
 static void _cb_packet_event(struct oonf_socket_entry *, bool mc);
+static void _handle_incoming(struct oonf_packet_socket *pktsocket,
+    struct os_fd_recv_slot *slot, bool multicast);
 static int _cb_interface_listener(struct os_interface_listener *l);
 
 /* subsystem definition */
@@ -176,10 +179,12 @@ static void
 _packet_add(struct oonf_packet_socket *pktsocket,
     union netaddr_socket *local, struct os_interface *interf) {
   struct netaddr_str nbuf;
+  uint32_t slots;
 
   pktsocket->os_if = interf;
   pktsocket->scheduler_entry.name = pktsocket->socket_name;
   pktsocket->scheduler_entry.process = _cb_packet_event_unicast;
+  pktsocket->scheduler_entry.drain = true;
 
   abuf_init(&pktsocket->out);
   list_add_tail(&_packet_sockets, &pktsocket->node);
@@ -196,6 +201,26 @@ _packet_add(struct oonf_packet_socket *pktsocket,
     pktsocket->config.input_buffer_length = sizeof(_input_buffer);
   }
 
+  /* allocate additional input buffers for batch receive */
+  memset(&pktsocket->stats, 0, sizeof(pktsocket->stats));
+  pktsocket->_batch_slots = 1;
+  if (pktsocket->config.batch_size > 1) {
+    slots = pktsocket->config.batch_size;
+    if (slots > OONF_PACKET_MAX_BATCH) {
+      slots = OONF_PACKET_MAX_BATCH;
+    }
+
+    pktsocket->_batch_buffer = calloc(slots - 1,
+        pktsocket->config.input_buffer_length);
+    if (pktsocket->_batch_buffer) {
+      pktsocket->_batch_slots = slots;
+    }
+    else {
+      OONF_WARN(LOG_PACKET, "Not enough memory for %u receive buffers of %s,"
+          " read one packet per event", slots, pktsocket->socket_name);
+    }
+  }
+
   oonf_socket_add(&pktsocket->scheduler_entry);
   oonf_socket_set_read(&pktsocket->scheduler_entry, true);
 }
@@ -215,6 +240,11 @@ oonf_packet_remove(struct oonf_packet_socket *pktsocket,
     os_fd_close(&pktsocket->scheduler_entry.fd);
     abuf_free(&pktsocket->out);
 
+    free(pktsocket->_batch_buffer);
+    pktsocket->_batch_buffer = NULL;
+    pktsocket->_batch_slots = 0;
+    pktsocket->_generation++;
+
     list_remove(&pktsocket->node);
   }
 }
@@ -455,6 +485,14 @@ oonf_packet_free_managed_config(struct oonf_packet_managed_config *config) {
   netaddr_acl_remove(&config->bindto);
 }
 
+/**
+ * @return list of all registered packet sockets
+ */
+struct list_entity *
+oonf_packet_get_list(void) {
+  return &_packet_sockets;
+}
+
 /**
  * Handle rate limitation of errno==1 warnings
  * @param pktsocket packet socket the error happened
@@ -692,6 +730,13 @@ _apply_managed_socket(struct oonf_packet_managed *managed,
     int protocol, struct os_interface *data) {
   union netaddr_socket sock;
   struct netaddr_str buf;
+  uint32_t batch_size;
+
+  /* number of datagrams read per socket event */
+  batch_size = managed->config.batch_size;
+  if (managed->_managed_config.batch_size > 0) {
+    batch_size = managed->_managed_config.batch_size;
+  }
 
   /* create binding socket */
   if (netaddr_socket_init(&sock, bindto, port,
@@ -704,7 +749,8 @@ _apply_managed_socket(struct oonf_packet_managed *managed,
   if (list_is_node_added(&packet->node)) {
     if (data == packet->os_if
         && memcmp(&sock, &packet->local_socket, sizeof(sock)) == 0
-        && protocol == packet->protocol) {
+        && protocol == packet->protocol
+        && batch_size == packet->config.batch_size) {
       /* nothing changed */
       return 1;
     }
@@ -730,6 +776,7 @@ _apply_managed_socket(struct oonf_packet_managed *managed,
   if (packet->config.user == NULL) {
     packet->config.user = managed;
   }
+  packet->config.batch_size = batch_size;
 
   /* create new socket */
   if (protocol) {
@@ -785,12 +832,15 @@ _cb_packet_event_multicast(struct oonf_socket_entry *entry) {
 static void
 _cb_packet_event(struct oonf_socket_entry *entry,
     bool multicast __attribute__((unused))) {
+  struct os_fd_recv_slot slots[OONF_PACKET_MAX_BATCH];
   struct oonf_packet_socket *pktsocket;
   union netaddr_socket sock;
   uint16_t length;
   char *pkt;
   ssize_t result;
   struct netaddr_str netbuf;
+  uint32_t generation;
+  uint32_t i;
 
 #ifdef OONF_LOG_DEBUG_INFO
   const char *interf = "";
@@ -805,43 +855,56 @@ _cb_packet_event(struct oonf_socket_entry *entry,
 #endif
 
   if (oonf_socket_is_read(entry)) {
-    uint8_t *buf;
-
-    /* clear recvfrom memory */
-    memset(&sock, 0, sizeof(sock));
-
-    /* handle incoming data */
-    buf = pktsocket->config.input_buffer;
-
-    result = os_fd_recvfrom(&entry->fd,
-        buf, pktsocket->config.input_buffer_length-1, &sock,
-        pktsocket->os_if);
-    if (result > 0 && pktsocket->config.receive_data != NULL) {
-      /* handle raw socket */
-      if (pktsocket->protocol) {
-        buf = os_fd_skip_rawsocket_prefix(buf, &result, pktsocket->local_socket.std.sa_family);
-        if (!buf) {
-          OONF_WARN(LOG_PACKET, "Error while skipping IP header for socket %s:",
-              netaddr_socket_to_string(&netbuf, &pktsocket->local_socket));
-          return;
+    /*
+     * an edge-triggered socket has to be drained, a batch that was not
+     * filled completely means the receive queue was empty (EAGAIN)
+     */
+    do {
+      /* prepare ring of input buffers, keep one byte for null termination */
+      for (i=0; i<pktsocket->_batch_slots; i++) {
+        memset(&slots[i].source, 0, sizeof(slots[i].source));
+        slots[i].length = pktsocket->config.input_buffer_length - 1;
+        if (i == 0) {
+          slots[i].buf = pktsocket->config.input_buffer;
+        }
+        else {
+          slots[i].buf = pktsocket->_batch_buffer
+              + (i-1) * pktsocket->config.input_buffer_length;
         }
       }
-      /* null terminate it */
-      buf[result] = 0;
-
-      /* received valid packet */
-      OONF_DEBUG(LOG_PACKET, "Received %"PRINTF_SSIZE_T_SPECIFIER" bytes from %s %s (%s)",
-          result, netaddr_socket_to_string(&netbuf, &sock),
-          interf, multicast ? "multicast" : "unicast");
-      pktsocket->config.receive_data(pktsocket, &sock, buf, result);
-    }
-    else if (result < 0 && (errno != EINTR && errno != EAGAIN && errno != EWOULDBLOCK)) {
-      OONF_WARN(LOG_PACKET, "Cannot read packet from socket %s: %s (%d)",
-          netaddr_socket_to_string(&netbuf, &pktsocket->local_socket), strerror(errno), errno);
-    }
+
+      /* handle incoming data */
+      result = os_fd_recvfrom_batch(&entry->fd,
+          slots, pktsocket->_batch_slots, pktsocket->os_if);
+      if (result > 0) {
+        pktsocket->stats.events++;
+        pktsocket->stats.packets += result;
+        if ((uint32_t)result == pktsocket->_batch_slots) {
+          pktsocket->stats.full_batches++;
+        }
+        if ((uint32_t)result > pktsocket->stats.max_batch) {
+          pktsocket->stats.max_batch = result;
+        }
+
+        generation = pktsocket->_generation;
+        for (i=0; i<(uint32_t)result; i++) {
+          _handle_incoming(pktsocket, &slots[i], multicast);
+
+          if (generation != pktsocket->_generation) {
+            /* socket was removed or reconfigured by the receive callback */
+            return;
+          }
+        }
+      }
+      else if (result < 0 && (errno != EINTR && errno != EAGAIN && errno != EWOULDBLOCK)) {
+        OONF_WARN(LOG_PACKET, "Cannot read packet from socket %s: %s (%d)",
+            netaddr_socket_to_string(&netbuf, &pktsocket->local_socket), strerror(errno), errno);
+      }
+    } while (oonf_socket_is_edge_triggered(entry)
+        && result == (ssize_t)pktsocket->_batch_slots);
   }
 
-  if (oonf_socket_is_write(entry) && abuf_getlen(&pktsocket->out) > 0) {
+  while (oonf_socket_is_write(entry) && abuf_getlen(&pktsocket->out) > 0) {
     /* handle outgoing data */
     pkt = abuf_getptr(&pktsocket->out);
 
@@ -873,6 +936,11 @@ _cb_packet_event(struct oonf_socket_entry *entry,
     }
     /* remove data from outgoing buffer (both for success and for final error */
     abuf_pull(&pktsocket->out, sizeof(sock) + 2 + length);
+
+    if (!oonf_socket_is_edge_triggered(entry)) {
+      /* a level-triggered socket gets another event for the next packet */
+      break;
+    }
   }
 
   if (abuf_getlen(&pktsocket->out) == 0) {
@@ -881,6 +949,47 @@ _cb_packet_event(struct oonf_socket_entry *entry,
   }
 }
 
+/**
+ * Hand a received datagram to the user of the packet socket
+ * @param pktsocket packet socket
+ * @param slot receive slot with datagram
+ * @param multicast true if the multicast socket received the datagram,
+ *   false otherwise
+ */
+static void
+_handle_incoming(struct oonf_packet_socket *pktsocket,
+    struct os_fd_recv_slot *slot, bool multicast __attribute__((unused))) {
+  struct netaddr_str netbuf;
+  ssize_t length;
+  uint8_t *buf;
+
+  if (slot->received <= 0 || pktsocket->config.receive_data == NULL) {
+    return;
+  }
+
+  buf = slot->buf;
+  length = slot->received;
+
+  /* handle raw socket */
+  if (pktsocket->protocol) {
+    buf = os_fd_skip_rawsocket_prefix(buf, &length, pktsocket->local_socket.std.sa_family);
+    if (!buf) {
+      OONF_WARN(LOG_PACKET, "Error while skipping IP header for socket %s:",
+          netaddr_socket_to_string(&netbuf, &pktsocket->local_socket));
+      return;
+    }
+  }
+  /* null terminate it */
+  buf[length] = 0;
+
+  /* received valid packet */
+  OONF_DEBUG(LOG_PACKET, "Received %"PRINTF_SSIZE_T_SPECIFIER" bytes from %s %s (%s)",
+      length, netaddr_socket_to_string(&netbuf, &slot->source),
+      pktsocket->os_if ? pktsocket->os_if->name : "",
+      multicast ? "multicast" : "unicast");
+  pktsocket->config.receive_data(pktsocket, &slot->source, buf, length);
+}
+
 /**
  * Callbacks for events on the interface
  * @param l OS interface listener
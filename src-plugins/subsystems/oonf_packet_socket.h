@@ -66,8 +66,14 @@ struct oonf_packet_socket;
 enum {
   OONF_PACKET_ERRNO1_SUPPRESSION_THRESHOLD = 10,
   OONF_PACKET_ERRNO1_SUPPRESSION_INTERVAL  = 60000,
+
+  /*! maximum number of datagrams read during a single socket event */
+  OONF_PACKET_MAX_BATCH = 64,
 };
 
+/*! default number of datagrams read during a single socket event */
+#define OONF_PACKET_DEFAULT_BATCH_TXT "8"
+
 /**
  * Configuraten of a packet socket
  */
@@ -78,6 +84,11 @@ struct oonf_packet_config {
   /*! length of input buffer */
   size_t input_buffer_length;
 
+  /**
+   * maximum number of datagrams read during a single socket event,
+   * 0 or 1 to read a single datagram
+   */
+  uint32_t batch_size;
   /**
    * Callback triggered when an UDP packet has been received
    * @param psock packet socket
@@ -95,6 +106,23 @@ struct oonf_packet_config {
   void *user;
 };
 
+/**
+ * Receive statistics of a packet socket
+ */
+struct oonf_packet_statistics {
+  /*! number of socket events with incoming data */
+  uint64_t events;
+
+  /*! number of received datagrams */
+  uint64_t packets;
+
+  /*! number of events which filled all batch slots */
+  uint64_t full_batches;
+
+  /*! largest number of datagrams read during a single event */
+  uint32_t max_batch;
+};
+
 /**
  * Definition of a packet socket
  */
@@ -131,6 +159,18 @@ struct oonf_packet_socket {
 
   /*! number of suppressed errno==1 warnings */
   uint32_t _errno1_count;
+
+  /*! receive statistics */
+  struct oonf_packet_statistics stats;
+
+  /*! additional input buffers for batch receive */
+  uint8_t *_batch_buffer;
+
+  /*! number of usable batch receive slots */
+  uint32_t _batch_slots;
+
+  /*! incremented every time the socket is removed, to detect reconfiguration in callbacks */
+  uint32_t _generation;
 };
 
 /**
@@ -176,6 +216,9 @@ struct oonf_packet_managed_config {
 
   /*! IP dscp value for outgoing traffic */
   int32_t dscp;
+
+  /*! maximum number of datagrams read during a single socket event */
+  int32_t batch_size;
 };
 
 /**
@@ -243,6 +286,8 @@ EXPORT void oonf_packet_copy_managed_config(
 EXPORT void oonf_packet_free_managed_config(
     struct oonf_packet_managed_config *config);
 
+EXPORT struct list_entity *oonf_packet_get_list(void);
+
 /**
  * @param sock pointer to packet socket
  * @return true if the socket is active to send data, false otherwise
@@ -252,4 +297,13 @@ oonf_packet_is_active(struct oonf_packet_socket *sock) {
   return list_is_node_added(&sock->node);
 }
 
+/**
+ * @param sock pointer to packet socket
+ * @return receive statistics of packet socket
+ */
+static INLINE const struct oonf_packet_statistics *
+oonf_packet_get_statistics(struct oonf_packet_socket *sock) {
+  return &sock->stats;
+}
+
 #endif /* OONF_PACKET_SOCKET_H_ */
@@ -53,6 +53,7 @@
 #include "rfc5444/rfc5444_reader.h"
 #include "rfc5444/rfc5444_writer.h"
 #include "core/oonf_logging.h"
+#include "core/oonf_trace.h"
 #include "core/oonf_subsystem.h"
 #include "core/os_core.h"
 #include "subsystems/oonf_class.h"
@@ -208,6 +209,8 @@ static struct cfg_schema_entry _interface_entries[] = {
     "TTL value of outgoing multicast traffic", 0, false, 1, 255),
   CFG_MAP_CLOCK(_rfc5444_if_config, aggregation_interval, "aggregation_interval", "0.100",
     "Interval in seconds for message aggregation"),
+  CFG_MAP_INT32_MINMAX(_rfc5444_if_config, sock.batch_size, "recv_batch", OONF_PACKET_DEFAULT_BATCH_TXT,
+    "Maximum number of packets read from the socket in a single event", 0, false, 1, OONF_PACKET_MAX_BATCH),
 
 };
 
@@ -227,6 +230,7 @@ static const struct rfc5444_reader _reader_template = {
   .malloc_tlvblock_entry = _alloc_tlvblock_entry,
   .free_addrblock_entry = _free_addrblock_entry,
   .free_tlvblock_entry = _free_tlvblock_entry,
+  .use_arena = true,
 };
 static const struct rfc5444_writer _writer_template = {
   .malloc_address_entry = _alloc_address_entry,
@@ -1130,6 +1134,9 @@ _cb_receive_data(struct oonf_packet_socket *sock,
 
   result = rfc5444_reader_handle_packet(
       &protocol->reader, ptr, length);
+  OONF_TRACE_DEBUG(LOG_RFC5444, "Parsed packet from %s on %s: %"PRINTF_SIZE_T_SPECIFIER" bytes, result %d",
+      OONF_TRACE_NETADDR(&source_ip), OONF_TRACE_STRING(interf->name),
+      OONF_TRACE_U64(length), OONF_TRACE_S32(result));
   if (result < 0) {
     OONF_WARN(LOG_RFC5444, "Error while parsing incoming packet from %s: %s (%d)",
         netaddr_socket_to_string(&buf, from), rfc5444_strerror(result), result);
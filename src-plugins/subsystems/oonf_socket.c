@@ -57,7 +57,6 @@
 #include "core/oonf_subsystem.h"
 #include "subsystems/oonf_timer.h"
 #include "subsystems/os_fd.h"
-#include "subsystems/os_clock.h"
 #include "subsystems/oonf_socket.h"
 
 /* Definitions */
@@ -69,6 +68,7 @@ static void _cleanup(void);
 static void _initiate_shutdown(void);
 
 static bool _shall_end_scheduler(void);
+static void _charge_batch(uint64_t runtime);
 static int _handle_scheduling(void);
 
 /* time until the scheduler should run */
@@ -80,6 +80,13 @@ static struct list_entity _socket_head;
 /* socket event scheduler */
 struct os_fd_select _socket_events;
 
+/* runtime of the scheduler between two waits and time spent waiting */
+static struct histogram _stat_loop;
+static struct histogram _stat_wait;
+
+/* sockets processed in the current event batch */
+static struct list_entity _batch_head;
+
 /* subsystem definition */
 static const char *_dependencies[] = {
   OONF_TIMER_SUBSYSTEM,
@@ -107,6 +114,7 @@ _init(void) {
   }
 
   list_init_head(&_socket_head);
+  list_init_head(&_batch_head);
   os_fd_event_add(&_socket_events);
 
   _scheduler_time_limit = ~0ull;
@@ -152,7 +160,13 @@ oonf_socket_add(struct oonf_socket_entry *entry)
   assert (entry->name[0]);
 
   list_add_before(&_socket_head, &entry->_node);
+  list_init_node(&entry->_batch_node);
   os_fd_event_socket_add(&_socket_events, &entry->fd);
+#ifdef OONF_SOCKET_EDGE_TRIGGERED
+  if (entry->drain) {
+    os_fd_event_socket_edge_triggered(&_socket_events, &entry->fd, true);
+  }
+#endif
 }
 
 /**
@@ -169,6 +183,9 @@ oonf_socket_remove(struct oonf_socket_entry *entry)
     list_remove(&entry->_node);
     os_fd_event_socket_remove(&_socket_events, &entry->fd);
   }
+  if (list_is_node_added(&entry->_batch_node)) {
+    list_remove(&entry->_batch_node);
+  }
 }
 
 /**
@@ -179,6 +196,24 @@ oonf_socket_get_list(void) {
   return &_socket_head;
 }
 
+/**
+ * @return histogram of the runtime of the scheduler between two waits
+ *   for events in microseconds
+ */
+const struct histogram *
+oonf_socket_get_loop_histogram(void) {
+  return &_stat_loop;
+}
+
+/**
+ * @return histogram of the time the scheduler waited for events
+ *   in microseconds
+ */
+const struct histogram *
+oonf_socket_get_wait_histogram(void) {
+  return &_stat_wait;
+}
+
 /**
  * @param entry socket entry
  * @param event_read true to enable read events, false to disable
@@ -215,15 +250,16 @@ _handle_scheduling(void)
   struct oonf_socket_entry *sock_entry = NULL;
   struct os_fd *sock;
   uint64_t next_event;
-  uint64_t start_time, end_time;
+  uint64_t start_time, loop_start;
   int i, n;
 
-  while (true) {
-    /* Update time since this is much used by the parsing functions */
-    if (oonf_clock_update()) {
-      return -1;
-    }
+  /* Update time since this is much used by the parsing functions */
+  if (oonf_clock_update()) {
+    return -1;
+  }
+  loop_start = oonf_clock_getNowUsec();
 
+  while (true) {
     if (oonf_clock_getNow() >= _scheduler_time_limit) {
       return -1;
     }
@@ -243,6 +279,17 @@ _handle_scheduling(void)
       os_fd_event_set_deadline(&_socket_events, next_event);
     }
 
+    /* write asynchronous logging events while nothing else is to do */
+    oonf_log_flush();
+
+    /*
+     * the last runtime measurement of the socket and timer callbacks
+     * is the start of the wait, so this needs no extra clock read
+     * (the log flush is counted as waiting time)
+     */
+    start_time = oonf_clock_getMeasuredUsec();
+    histogram_add(&_stat_loop, start_time - loop_start);
+
     do {
       if (_shall_end_scheduler()) {
         return 0;
@@ -251,18 +298,24 @@ _handle_scheduling(void)
       n = os_fd_event_wait(&_socket_events);
     } while (n == -1 && errno == EINTR);
 
-    if (n == 0) {               /* timeout! */
-      return 0;
-    }
     if (n < 0) {              /* Did something go wrong? */
       OONF_WARN(LOG_SOCKET, "select error: %s (%d)", strerror(errno), errno);
       return -1;
     }
 
-    /* Update time since this is much used by the parsing functions */
+    /*
+     * Update time since this is much used by the parsing functions,
+     * all callbacks of this batch of events share the timestamp.
+     */
     if (oonf_clock_update()) {
       return -1;
     }
+    loop_start = oonf_clock_getNowUsec();
+    histogram_add(&_stat_wait, loop_start - start_time);
+
+    if (n == 0) {               /* timeout! */
+      return 0;
+    }
 
     OONF_DEBUG(LOG_SOCKET, "Got %d events", n);
 
@@ -289,18 +342,44 @@ _handle_scheduling(void)
         if (os_fd_event_is_write(sock)) {
           sock_entry->_stat_send++;
         }
-        os_clock_gettime64(&start_time);
-        sock_entry->process(sock_entry);
-        os_clock_gettime64(&end_time);
 
-        if (end_time - start_time > OONF_TIMER_SLICE) {
-          OONF_WARN(LOG_SOCKET, "Socket '%s' (%d) scheduling took %"PRIu64" ms",
-              sock_entry->name,
-              os_fd_get_fd(&sock_entry->fd), end_time - start_time);
-          sock_entry->_stat_long++;
-        }
+        /* oonf_socket_remove() takes the entry out of the batch again */
+        list_add_tail(&_batch_head, &sock_entry->_batch_node);
+        sock_entry->process(sock_entry);
       }
     }
+
+    if (!list_is_empty(&_batch_head)) {
+      /* one clock read for the whole batch */
+      _charge_batch(oonf_clock_measureUsec() - loop_start);
+    }
   }
   return 0;
 }
+
+/**
+ * Charge the runtime of a batch of socket callbacks to all sockets
+ * processed in the batch. A socket alone in its batch gets its exact
+ * runtime, otherwise the runtime of the batch is an upper limit of
+ * the runtime of its callback.
+ * @param runtime runtime of the batch in microseconds
+ */
+static void
+_charge_batch(uint64_t runtime) {
+  struct oonf_socket_entry *sock_entry, *iterator;
+  bool long_batch;
+
+  long_batch = runtime > OONF_TIMER_SLICE * USEC_PER_MSEC;
+
+  list_for_each_element_safe(&_batch_head, sock_entry, _batch_node, iterator) {
+    list_remove(&sock_entry->_batch_node);
+    histogram_add(&sock_entry->_stat_runtime, runtime);
+
+    if (long_batch) {
+      OONF_WARN(LOG_SOCKET, "Socket '%s' (%d) scheduling took %"PRIu64" ms",
+          sock_entry->name,
+          os_fd_get_fd(&sock_entry->fd), runtime / USEC_PER_MSEC);
+      sock_entry->_stat_long++;
+    }
+  }
+}
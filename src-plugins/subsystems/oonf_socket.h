@@ -49,6 +49,7 @@
 #include "common/common_types.h"
 #include "common/list.h"
 #include "common/avl.h"
+#include "common/histogram.h"
 #include "common/netaddr_acl.h"
 #include "subsystems/os_fd.h"
 
@@ -71,6 +72,12 @@ struct oonf_socket_entry {
    */
   void (*process) (struct oonf_socket_entry *entry);
 
+  /*!
+   * true if the process callback reads (and writes) until the socket
+   * reports EAGAIN, which allows the scheduler to use edge-triggered events
+   */
+  bool drain;
+
   /*! usage counter, will be increased every times the socket receives data */
   uint32_t _stat_recv;
 
@@ -83,8 +90,17 @@ struct oonf_socket_entry {
    */
   uint32_t _stat_long;
 
+  /*!
+   * histogram of the callback runtime in microseconds, measured for
+   * the whole batch of events the callback was processed in
+   */
+  struct histogram _stat_runtime;
+
   /*! list of socket handlers */
   struct list_entity _node;
+
+  /*! list of sockets processed in the current event batch */
+  struct list_entity _batch_node;
 };
 
 EXPORT void oonf_socket_add(struct oonf_socket_entry *);
@@ -94,6 +110,8 @@ EXPORT void oonf_socket_set_read(
 EXPORT void oonf_socket_set_write(
     struct oonf_socket_entry *entry, bool event_write);
 EXPORT struct list_entity *oonf_socket_get_list(void);
+EXPORT const struct histogram *oonf_socket_get_loop_histogram(void);
+EXPORT const struct histogram *oonf_socket_get_wait_histogram(void);
 
 /**
  * @param entry socket entry
@@ -113,6 +131,16 @@ oonf_socket_is_write(struct oonf_socket_entry *entry) {
   return os_fd_event_is_write(&entry->fd);
 }
 
+/**
+ * @param entry socket entry
+ * @return true if socket only reports new events and must be
+ *   drained by the process callback, false otherwise
+ */
+static INLINE bool
+oonf_socket_is_edge_triggered(struct oonf_socket_entry *entry) {
+  return os_fd_event_is_edge_triggered(&entry->fd);
+}
+
 /**
  * Registers a direct send (without select) to a socket
  * @param entry socket entry
@@ -149,5 +177,14 @@ oonf_socket_get_long(struct oonf_socket_entry *sock) {
   return sock->_stat_long;
 }
 
+/**
+ * @param sock pointer to socket entry
+ * @return histogram of the callback runtime in microseconds
+ */
+static INLINE const struct histogram *
+oonf_socket_get_runtime(struct oonf_socket_entry *sock) {
+  return &sock->_stat_runtime;
+}
+
 
 #endif /* OONF_SOCKET_H_ */
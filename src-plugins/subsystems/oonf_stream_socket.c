@@ -75,6 +75,8 @@ static struct oonf_stream_session *_create_session(
     struct oonf_stream_socket *stream_socket, struct os_fd *sock,
     const struct netaddr *remote_addr,
     const union netaddr_socket *remote_socket);
+static void _consume_output(struct oonf_stream_session *session, size_t len);
+static void _compact_output(struct oonf_stream_session *session);
 static void _cb_parse_connection(struct oonf_socket_entry *entry);
 
 static void _cb_timeout_handler(struct oonf_timer_instance *);
@@ -646,6 +648,7 @@ _create_session(struct oonf_stream_socket *stream_socket,
   os_fd_copy(&session->scheduler_entry.fd, sock);
   session->scheduler_entry.name = session->socket_name;
   session->scheduler_entry.process = _cb_parse_connection;
+  session->scheduler_entry.drain = true;
   session->send_first = stream_socket->config.send_first;
   session->stream_socket = stream_socket;
 
@@ -711,6 +714,41 @@ _cb_timeout_handler(struct oonf_timer_instance *ptr) {
   oonf_stream_close(session);
 }
 
+/**
+ * Mark bytes of the output buffer as sent. The buffer is cleared
+ * when everything has been sent and only compacted when the sent
+ * part is larger than the rest, which keeps the cost of sending
+ * a large buffer in many partial writes linear.
+ * @param session stream session
+ * @param len number of bytes sent
+ */
+static void
+_consume_output(struct oonf_stream_session *session, size_t len) {
+  session->_out_offset += len;
+
+  if (session->_out_offset >= abuf_getlen(&session->out)) {
+    abuf_clear(&session->out);
+    session->_out_offset = 0;
+  }
+  else if (session->_out_offset > abuf_getlen(&session->out) / 2) {
+    abuf_pull(&session->out, session->_out_offset);
+    session->_out_offset = 0;
+  }
+}
+
+/**
+ * Remove the already sent part of the output buffer, so a callback
+ * can modify the buffer (e.g. clear it) without knowing the offset.
+ * @param session stream session
+ */
+static void
+_compact_output(struct oonf_stream_session *session) {
+  if (session->_out_offset > 0) {
+    abuf_pull(&session->out, session->_out_offset);
+    session->_out_offset = 0;
+  }
+}
+
 /**
  * Handle events for TCP session from network scheduler
  * @param entry socket entry to be parsed
@@ -762,43 +800,50 @@ _cb_parse_connection(struct oonf_socket_entry *entry) {
 
   /* read data if necessary */
   if (session->state == STREAM_SESSION_ACTIVE && oonf_socket_is_read(entry)) {
-    len = os_fd_recvfrom(&entry->fd, buffer, sizeof(buffer), NULL, 0);
-    if (len > 0) {
-      OONF_DEBUG(LOG_STREAM, "  recv returned %d\n", len);
-      if (abuf_memcpy(&session->in, buffer, len)) {
-        /* out of memory */
-        OONF_WARN(LOG_STREAM, "Out of memory for comport session input buffer");
-        session->state = STREAM_SESSION_CLEANUP;
-      } else if (abuf_getlen(&session->in) > s_sock->config.maximum_input_buffer) {
-        /* input buffer overflow */
-        if (s_sock->config.create_error) {
-          s_sock->config.create_error(session, STREAM_REQUEST_TOO_LARGE);
+    /* an edge-triggered session reads until recv() reports EAGAIN */
+    do {
+      len = os_fd_recvfrom(&entry->fd, buffer, sizeof(buffer), NULL, 0);
+      if (len > 0) {
+        OONF_DEBUG(LOG_STREAM, "  recv returned %d\n", len);
+        if (abuf_memcpy(&session->in, buffer, len)) {
+          /* out of memory */
+          OONF_WARN(LOG_STREAM, "Out of memory for comport session input buffer");
+          session->state = STREAM_SESSION_CLEANUP;
+        } else if (abuf_getlen(&session->in) > s_sock->config.maximum_input_buffer) {
+          /* input buffer overflow */
+          if (s_sock->config.create_error) {
+            _compact_output(session);
+            s_sock->config.create_error(session, STREAM_REQUEST_TOO_LARGE);
+          }
+          session->state = STREAM_SESSION_SEND_AND_QUIT;
+        } else {
+          /* got new input block, reset timeout */
+          oonf_stream_set_timeout(session, s_sock->config.session_timeout);
         }
+      } else if (len < 0 && errno != EINTR && errno != EAGAIN && errno
+          != EWOULDBLOCK) {
+        /* error during read */
+        OONF_WARN(LOG_STREAM, "Error while reading from communication stream with %s: %s (%d)\n",
+            netaddr_to_string(&buf, &session->remote_address), strerror(errno), errno);
+        session->state = STREAM_SESSION_CLEANUP;
+      } else if (len == 0) {
+        /* external s_sock closed */
         session->state = STREAM_SESSION_SEND_AND_QUIT;
-      } else {
-        /* got new input block, reset timeout */
-        oonf_stream_set_timeout(session, s_sock->config.session_timeout);
-      }
-    } else if (len < 0 && errno != EINTR && errno != EAGAIN && errno
-        != EWOULDBLOCK) {
-      /* error during read */
-      OONF_WARN(LOG_STREAM, "Error while reading from communication stream with %s: %s (%d)\n",
-          netaddr_to_string(&buf, &session->remote_address), strerror(errno), errno);
-      session->state = STREAM_SESSION_CLEANUP;
-    } else if (len == 0) {
-      /* external s_sock closed */
-      session->state = STREAM_SESSION_SEND_AND_QUIT;
 
-      /* still call callback once more */
-      session->state = s_sock->config.receive_data(session);
+        /* still call callback once more */
+        _compact_output(session);
+        session->state = s_sock->config.receive_data(session);
 
-      /* switch off read events */
-      oonf_socket_set_read(entry, false);
-    }
+        /* switch off read events */
+        oonf_socket_set_read(entry, false);
+      }
+    } while (len > 0 && session->state == STREAM_SESSION_ACTIVE
+        && oonf_socket_is_edge_triggered(entry));
   }
 
   if (session->state == STREAM_SESSION_ACTIVE && s_sock->config.receive_data != NULL
       && (abuf_getlen(&session->in) > 0 || session->send_first)) {
+    _compact_output(session);
     session->state = s_sock->config.receive_data(session);
     session->send_first = false;
   }
@@ -806,11 +851,13 @@ _cb_parse_connection(struct oonf_socket_entry *entry) {
   /* send data if necessary */
   if (session->state != STREAM_SESSION_CLEANUP && abuf_getlen(&session->out) > 0) {
     if (oonf_socket_is_write(entry)) {
-      len = os_fd_sendto(&entry->fd, abuf_getptr(&session->out), abuf_getlen(&session->out), NULL, false);
+      len = os_fd_sendto(&entry->fd,
+          abuf_getptr(&session->out) + session->_out_offset,
+          abuf_getlen(&session->out) - session->_out_offset, NULL, false);
 
       if (len > 0) {
         OONF_DEBUG(LOG_STREAM, "  send returned %d\n", len);
-        abuf_pull(&session->out, len);
+        _consume_output(session, len);
         oonf_stream_set_timeout(session, s_sock->config.session_timeout);
       } else if (len < 0 && errno != EINTR && errno != EAGAIN && errno
           != EWOULDBLOCK) {
@@ -848,6 +895,11 @@ _cb_parse_connection(struct oonf_socket_entry *entry) {
       && abuf_getlen(&session->out) == 0
       && s_sock->config.buffer_underrun != NULL) {
     session->state = s_sock->config.buffer_underrun(session);
+
+    if (abuf_getlen(&session->out) > 0) {
+      /* callback generated new data */
+      oonf_socket_set_write(&session->scheduler_entry, true);
+    }
   }
 
   if (abuf_getlen(&session->out) == 0 &&
@@ -859,6 +911,10 @@ _cb_parse_connection(struct oonf_socket_entry *entry) {
       session->state = STREAM_SESSION_CLEANUP;
     }
   }
+  else if (oonf_socket_is_edge_triggered(entry)) {
+    /* re-arm edge-triggered socket, it would not report the free buffer again */
+    oonf_socket_set_write(&session->scheduler_entry, true);
+  }
 
   session->busy = false;
   s_sock->busy = false;
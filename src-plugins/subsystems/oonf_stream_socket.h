@@ -107,6 +107,14 @@ struct oonf_stream_session {
    */
   struct autobuf out;
 
+  /**
+   * number of bytes at the start of the output buffer that have
+   * already been sent. The buffer is only compacted when this
+   * offset grows larger than the unsent rest, so large outputs
+   * are not moved in memory after each partial write.
+   */
+  size_t _out_offset;
+
   /**
    * file input descriptor for file upload
    *
@@ -336,4 +344,14 @@ EXPORT void oonf_stream_copy_managed_config(struct oonf_stream_managed_config *d
     struct oonf_stream_managed_config *src);
 EXPORT void oonf_stream_free_managed_config(struct oonf_stream_managed_config *config);
 
+/**
+ * @param session stream session
+ * @return number of bytes in the output buffer that have not
+ *   been sent to the peer yet
+ */
+static INLINE size_t
+oonf_stream_get_unsent_length(struct oonf_stream_session *session) {
+  return abuf_getlen(&session->out) - session->_out_offset;
+}
+
 #endif /* OONF_STREAM_SOCKET_H_ */
@@ -62,10 +62,54 @@
 /* Definitions */
 #define LOG_TELNET _oonf_telnet_subsystem.logging
 
+/*! maximum length of command and parameter of a cached command output */
+#define TELNET_CACHE_KEY_LENGTH 256
+
+/*! number of bytes of a cached output copied into the output buffer at once */
+#define TELNET_CACHE_CHUNK_SIZE 16384
+
 struct _telnet_config {
   struct oonf_stream_managed_config osmc;
   int32_t allowed_sessions;
   uint64_t timeout;
+  int32_t cache_size;
+};
+
+/**
+ * Cached output of a telnet command
+ */
+struct _telnet_cache_entry {
+  /*! command and parameter the output was generated for */
+  char *key;
+
+  /*! telnet command that generated the output */
+  struct oonf_telnet_command *cmd;
+
+  /*! generation of the data the output is based on */
+  uint64_t generation;
+
+  /*! command output */
+  struct autobuf output;
+
+  /*! node for tree of cached outputs */
+  struct avl_node _node;
+
+  /*! node for list of cached outputs, least recently used first */
+  struct list_entity _lru_node;
+
+  /*! number of sessions currently sending the output */
+  uint32_t _readers;
+};
+
+/**
+ * State of a session sending a cached output in chunks
+ */
+struct _telnet_cache_reader {
+  /*! cache entry with the output */
+  struct _telnet_cache_entry *entry;
+
+  /*! number of bytes already copied into the output buffer */
+  size_t offset;
 };
 
 /* static function prototypes */
@@ -75,6 +119,8 @@ static void _cleanup(void);
 static int _avl_comp_strcmdword(const void *txt1, const void *txt2);
 
 static void _call_stop_handler(struct oonf_telnet_data *data);
+static void _call_chunk_cleanup(struct oonf_telnet_data *data);
+static enum oonf_telnet_result _call_chunk_handler(struct oonf_telnet_data *data);
 static void _cb_config_changed(void);
 static int _cb_telnet_init(struct oonf_stream_session *);
 static void _cb_telnet_cleanup(struct oonf_stream_session *);
@@ -82,10 +128,31 @@ static void _cb_telnet_create_error(struct oonf_stream_session *,
     enum oonf_stream_errors);
 static enum oonf_stream_session_state _cb_telnet_receive_data(
     struct oonf_stream_session *);
+static enum oonf_stream_session_state _cb_telnet_buffer_underrun(
+    struct oonf_stream_session *);
+static enum oonf_stream_session_state _telnet_process_input(
+    struct oonf_stream_session *, bool processedCommand);
 static enum oonf_telnet_result _telnet_handle_command(
     struct oonf_telnet_data *);
+static enum oonf_telnet_result _telnet_handle_command_complete(
+    struct oonf_telnet_data *);
 static struct oonf_telnet_command *_check_telnet_command_acl(
     struct oonf_telnet_data *data, struct oonf_telnet_command *cmd);
+static struct oonf_telnet_command *_get_telnet_command(
+    struct oonf_telnet_data *data);
+
+static int _avl_comp_strcmp(const void *txt1, const void *txt2);
+static bool _get_cache_key(char *key, size_t size, struct oonf_telnet_data *data);
+static bool _cache_get_output(struct oonf_telnet_data *data, uint64_t generation);
+static void _cache_start(struct oonf_telnet_data *data,
+    struct oonf_telnet_command *cmd, uint64_t generation, size_t start);
+static void _cache_record(struct oonf_telnet_data *data, size_t start);
+static void _cache_finish(struct oonf_telnet_data *data);
+static void _cache_free(struct _telnet_cache_entry *entry);
+static void _cache_remove(struct _telnet_cache_entry *entry);
+static void _cache_shrink(size_t max_size);
+static enum oonf_telnet_result _cb_cache_next_chunk(struct oonf_telnet_data *data);
+static void _cb_cache_chunk_cleanup(struct oonf_telnet_data *data);
 
 static void _cb_telnet_repeat_timer(struct oonf_timer_instance *data);
 static enum oonf_telnet_result _cb_telnet_quit(struct oonf_telnet_data *data);
@@ -106,6 +173,9 @@ static struct cfg_schema_entry _telnet_entries[] = {
       "allowed_sessions", "3", "Maximum number of allowed simultaneous sessions",0, false, 3, 1024),
   CFG_MAP_CLOCK(_telnet_config, timeout,
       "timeout", "120000", "Time until a telnet session is closed when idle"),
+  CFG_MAP_INT32_MINMAX(_telnet_config, cache_size,
+      "cache_size", "16777216", "Maximum number of bytes used to cache the output"
+      " of telnet commands, 0 disables the cache", 0, true, 0, INT32_MAX),
 };
 
 static struct cfg_schema_section _telnet_section = {
@@ -152,6 +222,15 @@ static struct oonf_class _telnet_memcookie = {
   .name = "telnet session",
   .size = sizeof(struct oonf_telnet_session),
 };
+static struct oonf_class _telnet_cache_class = {
+  .name = "telnet output cache",
+  .size = sizeof(struct _telnet_cache_entry),
+};
+static struct oonf_class _telnet_cache_reader_class = {
+  .name = "telnet cached output reader",
+  .size = sizeof(struct _telnet_cache_reader),
+};
+
 static struct oonf_timer_class _telnet_repeat_timerinfo = {
   .name = "txt repeat timer",
   .callback = _cb_telnet_repeat_timer,
@@ -166,12 +245,19 @@ static struct oonf_stream_managed _telnet_managed = {
     .init_session = _cb_telnet_init,
     .cleanup_session = _cb_telnet_cleanup,
     .receive_data = _cb_telnet_receive_data,
+    .buffer_underrun = _cb_telnet_buffer_underrun,
     .create_error = _cb_telnet_create_error,
   },
 };
 
 static struct avl_tree _telnet_cmd_tree;
 
+/* cache of command outputs */
+static struct avl_tree _telnet_cache_tree;
+static struct list_entity _telnet_cache_lru;
+static size_t _telnet_cache_used = 0;
+static size_t _telnet_cache_size = 16*1024*1024;
+
 /**
  * Initialize telnet subsystem
  * @return always returns 0
@@ -181,8 +267,13 @@ _init(void) {
   size_t i;
 
   oonf_class_add(&_telnet_memcookie);
+  oonf_class_add(&_telnet_cache_class);
+  oonf_class_add(&_telnet_cache_reader_class);
   oonf_timer_add(&_telnet_repeat_timerinfo );
 
+  avl_init(&_telnet_cache_tree, _avl_comp_strcmp, false);
+  list_init_head(&_telnet_cache_lru);
+
   oonf_stream_add_managed(&_telnet_managed);
 
   /* initialize telnet commands */
@@ -199,6 +290,10 @@ _init(void) {
 static void
 _cleanup(void) {
   oonf_stream_remove_managed(&_telnet_managed, true);
+  _cache_shrink(0);
+
+  oonf_class_remove(&_telnet_cache_reader_class);
+  oonf_class_remove(&_telnet_cache_class);
   oonf_class_remove(&_telnet_memcookie);
 }
 
@@ -222,6 +317,14 @@ oonf_telnet_add(struct oonf_telnet_command *command) {
  */
 void
 oonf_telnet_remove(struct oonf_telnet_command *command) {
+  struct _telnet_cache_entry *entry, *it;
+
+  /* forget all cached output of the command */
+  avl_for_each_element_safe(&_telnet_cache_tree, entry, _node, it) {
+    if (entry->cmd == command) {
+      _cache_remove(entry);
+    }
+  }
   avl_remove(&_telnet_cmd_tree, &command->_node);
 }
 
@@ -263,7 +366,7 @@ oonf_telnet_execute(const char *cmd, const char *para,
 
   list_init_head(&session.data.cleanup_list);
 
-  result = _telnet_handle_command(&session.data);
+  result = _telnet_handle_command_complete(&session.data);
   _call_stop_handler(&session.data);
 
   /* call all cleanup handlers */
@@ -278,6 +381,34 @@ oonf_telnet_execute(const char *cmd, const char *para,
   return abuf_has_failed(session.data.out) ? TELNET_RESULT_INTERNAL_ERROR : result;
 }
 
+/**
+ * Get the generation of the data the output of a telnet command
+ * is based on. The output does not change as long as the generation
+ * stays the same.
+ * @param cmd pointer to name of command
+ * @param para pointer to parameter string
+ * @param remote pointer to address which triggers the execution
+ * @return generation of the command output, 0 if the output
+ *   is not cacheable or the command is unknown
+ */
+uint64_t
+oonf_telnet_get_generation(const char *cmd, const char *para,
+    struct netaddr *remote) {
+  struct oonf_telnet_command *command;
+  struct oonf_telnet_data data;
+
+  memset(&data, 0, sizeof(data));
+  data.command = cmd;
+  data.parameter = para;
+  data.remote = remote;
+
+  command = _get_telnet_command(&data);
+  if (command == NULL || command->cb_get_generation == NULL) {
+    return 0;
+  }
+  return command->cb_get_generation(&data);
+}
+
 /**
  * AVL tree comparator for first word in case insensitive strings.
  * @param ptr1 pointer to string 1
@@ -288,19 +419,17 @@ static int
 _avl_comp_strcmdword(const void *ptr1, const void *ptr2) {
   const char *txt1 = ptr1;
   const char *txt2 = ptr2;
-  int diff;
 
-  do {
-    diff = (int)(*txt1) - (int)(*txt2);
-    if (diff != 0 || *txt1 == ' ' || *txt2 == ' ') {
-      break;
-    }
-  } while (*txt1++ != 0 && *txt2++ != 0);
+  while (*txt1 == *txt2 && *txt1 != 0 && *txt1 != ' ') {
+    txt1++;
+    txt2++;
+  }
 
-  if ((*txt1==' ' && *txt2==0) || (*txt1==0 && *txt2==' ')) {
-    diff = 0;
+  /* a space terminates the command word like the end of the string */
+  if ((*txt1 == ' ' || *txt1 == 0) && (*txt2 == ' ' || *txt2 == 0)) {
+    return 0;
   }
-  return diff;
+  return (int)(*txt1) - (int)(*txt2);
 }
 
 /**
@@ -340,6 +469,7 @@ _cb_telnet_cleanup(struct oonf_stream_session *session) {
 
   /* stop continuous commands */
   oonf_telnet_stop(&telnet_session->data, false);
+  _call_chunk_cleanup(&telnet_session->data);
 
   /* call all cleanup handlers */
   list_for_each_element_safe(&telnet_session->data.cleanup_list, handler, node, it) {
@@ -388,12 +518,62 @@ _call_stop_handler(struct oonf_telnet_data *data) {
      */
     stop_handler = data->stop_handler;
     data->stop_handler = NULL;
+    data->drain_handler = NULL;
 
     /* call stop handler */
     stop_handler(data);
   }
 }
 
+/**
+ * Release the state of a chunked command output
+ * @param data pointer to telnet data
+ */
+static void
+_call_chunk_cleanup(struct oonf_telnet_data *data) {
+  void (*chunk_cleanup)(struct oonf_telnet_data *);
+
+  chunk_cleanup = data->chunk_cleanup;
+
+  data->chunk_handler = NULL;
+  data->chunk_cleanup = NULL;
+
+  if (chunk_cleanup) {
+    chunk_cleanup(data);
+  }
+  data->chunk_data = NULL;
+
+  /* drop incomplete output */
+  if (data->_cache_entry) {
+    _cache_free(data->_cache_entry);
+    data->_cache_entry = NULL;
+  }
+}
+
+/**
+ * Generate the next part of a chunked command output
+ * @param data pointer to telnet data
+ * @return result of chunk handler
+ */
+static enum oonf_telnet_result
+_call_chunk_handler(struct oonf_telnet_data *data) {
+  enum oonf_telnet_result result;
+  size_t len;
+
+  len = abuf_getlen(data->out);
+  result = data->chunk_handler(data);
+
+  if (data->_cache_entry != NULL && !abuf_has_failed(data->out)) {
+    if (result == TELNET_RESULT_CONTINOUS || result == TELNET_RESULT_ACTIVE) {
+      _cache_record(data, len);
+    }
+    if (result == TELNET_RESULT_ACTIVE) {
+      _cache_finish(data);
+    }
+  }
+  return result;
+}
+
 /**
  * Handler for receiving data from telnet session
  * @param session pointer to TCP session
@@ -401,9 +581,67 @@ _call_stop_handler(struct oonf_telnet_data *data) {
  */
 static enum oonf_stream_session_state
 _cb_telnet_receive_data(struct oonf_stream_session *session) {
+  return _telnet_process_input(session, false);
+}
+
+/**
+ * Handler for an empty output buffer of a telnet session, generates
+ * the next part of a chunked command output or lets a continuous
+ * command refill the buffer
+ * @param session pointer to TCP session
+ * @return TCP session state
+ */
+static enum oonf_stream_session_state
+_cb_telnet_buffer_underrun(struct oonf_stream_session *session) {
+  struct oonf_telnet_session *telnet_session;
+  enum oonf_telnet_result cmd_result;
+
+  /* get telnet session pointer */
+  telnet_session = (struct oonf_telnet_session *)session;
+
+  if (telnet_session->data.chunk_handler == NULL) {
+    if (telnet_session->data.drain_handler != NULL) {
+      /* let continuous output refill the buffer */
+      telnet_session->data.drain_handler(&telnet_session->data);
+    }
+    return STREAM_SESSION_ACTIVE;
+  }
+
+  cmd_result = _call_chunk_handler(&telnet_session->data);
+  if (abuf_has_failed(telnet_session->data.out)) {
+    cmd_result = TELNET_RESULT_INTERNAL_ERROR;
+  }
+  if (cmd_result == TELNET_RESULT_CONTINOUS) {
+    return STREAM_SESSION_ACTIVE;
+  }
+
+  _call_chunk_cleanup(&telnet_session->data);
+
+  if (cmd_result != TELNET_RESULT_ACTIVE) {
+    abuf_puts(&session->out, "Error while generating command output.\n");
+  }
+
+  /* put an empty line behind the command */
+  if (telnet_session->data.show_echo) {
+    abuf_puts(&session->out, "\n");
+  }
+
+  /* continue with the input that arrived in the meantime */
+  return _telnet_process_input(session, true);
+}
+
+/**
+ * Process the command lines in the input buffer of a telnet session
+ * @param session pointer to TCP session
+ * @param processedCommand true if a prompt should be printed even
+ *   if no new command is processed
+ * @return TCP session state
+ */
+static enum oonf_stream_session_state
+_telnet_process_input(struct oonf_stream_session *session,
+    bool processedCommand) {
   struct oonf_telnet_session *telnet_session;
   enum oonf_telnet_result cmd_result;
-  bool processedCommand = false;
   bool chainCommands = false;
   char *eol;
   int len;
@@ -411,8 +649,9 @@ _cb_telnet_receive_data(struct oonf_stream_session *session) {
   /* get telnet session pointer */
   telnet_session = (struct oonf_telnet_session *)session;
 
-  /* loop over input */
-  while (abuf_getlen(&session->in) > 0) {
+  /* loop over input, wait until chunked output is complete */
+  while (abuf_getlen(&session->in) > 0
+      && telnet_session->data.chunk_handler == NULL) {
     char *para = NULL, *cmd = NULL, *next = NULL;
 
     /* search for end of line */
@@ -470,10 +709,19 @@ _cb_telnet_receive_data(struct oonf_stream_session *session) {
           telnet_session->data.parameter = para;
         }
 
-        cmd_result = _telnet_handle_command(&telnet_session->data);
+        if (chainCommands || session->state != STREAM_SESSION_ACTIVE) {
+          /* session ends after this line, no time for chunked output */
+          cmd_result = _telnet_handle_command_complete(&telnet_session->data);
+        }
+        else {
+          cmd_result = _telnet_handle_command(&telnet_session->data);
+        }
         if (abuf_has_failed(telnet_session->data.out)) {
           cmd_result = TELNET_RESULT_INTERNAL_ERROR;
         }
+        if (cmd_result != TELNET_RESULT_ACTIVE) {
+          _call_chunk_cleanup(&telnet_session->data);
+        }
 
         switch (cmd_result) {
           case TELNET_RESULT_ACTIVE:
@@ -496,7 +744,8 @@ _cb_telnet_receive_data(struct oonf_stream_session *session) {
             break;
         }
         /* put an empty line behind each command */
-        if (!chainCommands && telnet_session->data.show_echo) {
+        if (!chainCommands && telnet_session->data.show_echo
+            && telnet_session->data.chunk_handler == NULL) {
           abuf_puts(&session->out, "\n");
         }
       }
@@ -519,7 +768,8 @@ _cb_telnet_receive_data(struct oonf_stream_session *session) {
 
   /* print prompt */
   if (processedCommand && session->state == STREAM_SESSION_ACTIVE
-      && telnet_session->data.show_echo) {
+      && telnet_session->data.show_echo
+      && telnet_session->data.chunk_handler == NULL) {
     abuf_puts(&session->out, "> ");
   }
 
@@ -534,13 +784,13 @@ _cb_telnet_receive_data(struct oonf_stream_session *session) {
 static enum oonf_telnet_result
 _telnet_handle_command(struct oonf_telnet_data *data) {
   struct oonf_telnet_command *cmd;
+  enum oonf_telnet_result result;
+  uint64_t generation;
+  size_t len;
 #ifdef OONF_LOG_INFO
   struct netaddr_str buf;
 #endif
-  cmd = avl_find_element(&_telnet_cmd_tree, data->command, cmd, _node);
-  if (cmd) {
-    cmd = _check_telnet_command_acl(data, cmd);
-  }
+  cmd = _get_telnet_command(data);
   if (cmd == NULL) {
     return _TELNET_RESULT_UNKNOWN_COMMAND;
   }
@@ -548,7 +798,47 @@ _telnet_handle_command(struct oonf_telnet_data *data) {
   OONF_INFO(LOG_TELNET, "Executing command from %s: %s %s",
       netaddr_to_string(&buf, data->remote), data->command,
       data->parameter == NULL ? "" : data->parameter);
-  return cmd->handler(data);
+
+  generation = 0;
+  if (cmd->cb_get_generation != NULL && _telnet_cache_size > 0) {
+    generation = cmd->cb_get_generation(data);
+  }
+  if (generation != 0 && _cache_get_output(data, generation)) {
+    return TELNET_RESULT_ACTIVE;
+  }
+
+  len = abuf_getlen(data->out);
+  result = cmd->handler(data);
+
+  if (generation != 0 && result == TELNET_RESULT_ACTIVE
+      && !abuf_has_failed(data->out)) {
+    /* remember output for the next call with the same generation */
+    _cache_start(data, cmd, generation, len);
+    if (data->chunk_handler == NULL) {
+      _cache_finish(data);
+    }
+  }
+  return result;
+}
+
+/**
+ * Helper function to call telnet command handler and generate
+ * all chunks of its output at once
+ * @param data pointer to telnet data
+ * @return telnet command result
+ */
+static enum oonf_telnet_result
+_telnet_handle_command_complete(struct oonf_telnet_data *data) {
+  enum oonf_telnet_result result;
+
+  result = _telnet_handle_command(data);
+  if (result == TELNET_RESULT_ACTIVE && data->chunk_handler != NULL) {
+    do {
+      result = _call_chunk_handler(data);
+    } while (result == TELNET_RESULT_CONTINOUS);
+  }
+  _call_chunk_cleanup(data);
+  return result;
 }
 
 /**
@@ -577,6 +867,298 @@ _check_telnet_command_acl(struct oonf_telnet_data *data,
   return cmd;
 }
 
+/**
+ * Lookup the telnet command of a telnet data object
+ * @param data pointer to telnet data
+ * @return telnet command object or NULL if not found or forbidden
+ */
+static struct oonf_telnet_command *
+_get_telnet_command(struct oonf_telnet_data *data) {
+  struct oonf_telnet_command *cmd;
+
+  cmd = avl_find_element(&_telnet_cmd_tree, data->command, cmd, _node);
+  if (cmd) {
+    cmd = _check_telnet_command_acl(data, cmd);
+  }
+  return cmd;
+}
+
+/**
+ * AVL tree comparator for case sensitive strings.
+ * @param txt1 pointer to string 1
+ * @param txt2 pointer to string 2
+ * @return +1 if k1>k2, -1 if k1<k2, 0 if k1==k2
+ */
+static int
+_avl_comp_strcmp(const void *txt1, const void *txt2) {
+  return strcmp(txt1, txt2);
+}
+
+/**
+ * Generate the key of a cached command output
+ * @param key buffer for key
+ * @param size size of buffer
+ * @param data pointer to telnet data
+ * @return true if key was generated, false if buffer was too small
+ */
+static bool
+_get_cache_key(char *key, size_t size, struct oonf_telnet_data *data) {
+  int len;
+
+  len = snprintf(key, size, "%s %s", data->command,
+      data->parameter == NULL ? "" : data->parameter);
+  return len > 0 && (size_t)len < size;
+}
+
+/**
+ * Copy a cached command output into the output buffer. Large outputs
+ * are sent in chunks like a chunked command output.
+ * @param data pointer to telnet data
+ * @param generation current generation of the command output
+ * @return true if output was copied, false if no up-to-date
+ *   output was cached
+ */
+static bool
+_cache_get_output(struct oonf_telnet_data *data, uint64_t generation) {
+  struct _telnet_cache_reader *reader;
+  struct _telnet_cache_entry *entry;
+  char key[TELNET_CACHE_KEY_LENGTH];
+
+  if (!_get_cache_key(key, sizeof(key), data)) {
+    return false;
+  }
+
+  entry = avl_find_element(&_telnet_cache_tree, key, entry, _node);
+  if (entry == NULL) {
+    return false;
+  }
+  if (entry->generation != generation) {
+    _cache_remove(entry);
+    return false;
+  }
+
+  OONF_DEBUG(LOG_TELNET, "Use cached output for '%s'", key);
+
+  /* move to end of least recently used list */
+  list_remove(&entry->_lru_node);
+  list_add_tail(&_telnet_cache_lru, &entry->_lru_node);
+
+  if (abuf_getlen(&entry->output) <= TELNET_CACHE_CHUNK_SIZE) {
+    abuf_memcpy(data->out, abuf_getptr(&entry->output), abuf_getlen(&entry->output));
+    return true;
+  }
+
+  reader = oonf_class_malloc(&_telnet_cache_reader_class);
+  if (reader == NULL) {
+    return false;
+  }
+
+  /* keep the output even if the entry leaves the cache in the meantime */
+  reader->entry = entry;
+  entry->_readers++;
+
+  data->chunk_handler = _cb_cache_next_chunk;
+  data->chunk_cleanup = _cb_cache_chunk_cleanup;
+  data->chunk_data = reader;
+
+  _cb_cache_next_chunk(data);
+  return true;
+}
+
+/**
+ * Start recording the output of a command
+ * @param data pointer to telnet data
+ * @param cmd telnet command
+ * @param generation generation of the command output
+ * @param start length of output buffer before command was called
+ */
+static void
+_cache_start(struct oonf_telnet_data *data,
+    struct oonf_telnet_command *cmd, uint64_t generation, size_t start) {
+  struct _telnet_cache_entry *entry;
+  char key[TELNET_CACHE_KEY_LENGTH];
+
+  if (!_get_cache_key(key, sizeof(key), data)) {
+    return;
+  }
+
+  entry = oonf_class_malloc(&_telnet_cache_class);
+  if (entry == NULL) {
+    return;
+  }
+
+  entry->key = strdup(key);
+  if (entry->key == NULL || abuf_init(&entry->output)) {
+    free(entry->key);
+    oonf_class_free(&_telnet_cache_class, entry);
+    return;
+  }
+
+  entry->cmd = cmd;
+  entry->generation = generation;
+  data->_cache_entry = entry;
+
+  _cache_record(data, start);
+}
+
+/**
+ * Record the part of the command output that has been generated
+ * since the last call
+ * @param data pointer to telnet data
+ * @param start length of output buffer before the output was generated
+ */
+static void
+_cache_record(struct oonf_telnet_data *data, size_t start) {
+  struct _telnet_cache_entry *entry;
+
+  entry = data->_cache_entry;
+  if (entry == NULL) {
+    return;
+  }
+
+  if (abuf_getlen(&entry->output) + abuf_getlen(data->out) - start
+      > _telnet_cache_size) {
+    /* output will not fit into the cache */
+    _cache_free(entry);
+    data->_cache_entry = NULL;
+    return;
+  }
+
+  abuf_memcpy(&entry->output, abuf_getptr(data->out) + start,
+      abuf_getlen(data->out) - start);
+  if (abuf_has_failed(&entry->output)) {
+    _cache_free(entry);
+    data->_cache_entry = NULL;
+  }
+}
+
+/**
+ * Store the recorded command output in the cache
+ * @param data pointer to telnet data
+ */
+static void
+_cache_finish(struct oonf_telnet_data *data) {
+  struct _telnet_cache_entry *entry, *old;
+
+  entry = data->_cache_entry;
+  if (entry == NULL) {
+    return;
+  }
+  data->_cache_entry = NULL;
+
+  if (abuf_getlen(&entry->output) > _telnet_cache_size) {
+    /* cache has been shrunk in the meantime */
+    _cache_free(entry);
+    return;
+  }
+
+  /* replace outdated output */
+  old = avl_find_element(&_telnet_cache_tree, entry->key, old, _node);
+  if (old) {
+    _cache_remove(old);
+  }
+
+  /* make room for new output */
+  _cache_shrink(_telnet_cache_size - abuf_getlen(&entry->output));
+
+  entry->_node.key = entry->key;
+  avl_insert(&_telnet_cache_tree, &entry->_node);
+  list_add_tail(&_telnet_cache_lru, &entry->_lru_node);
+  _telnet_cache_used += abuf_getlen(&entry->output);
+
+  OONF_DEBUG(LOG_TELNET, "Cached %" PRINTF_SIZE_T_SPECIFIER " bytes of output for '%s'",
+      abuf_getlen(&entry->output), entry->key);
+}
+
+/**
+ * Free the memory of a cache entry that is not part of the cache
+ * @param entry pointer to cache entry
+ */
+static void
+_cache_free(struct _telnet_cache_entry *entry) {
+  abuf_free(&entry->output);
+  free(entry->key);
+  oonf_class_free(&_telnet_cache_class, entry);
+}
+
+/**
+ * Remove an entry from the cache
+ * @param entry pointer to cache entry
+ */
+static void
+_cache_remove(struct _telnet_cache_entry *entry) {
+  _telnet_cache_used -= abuf_getlen(&entry->output);
+
+  avl_remove(&_telnet_cache_tree, &entry->_node);
+  list_remove(&entry->_lru_node);
+
+  if (entry->_readers == 0) {
+    _cache_free(entry);
+  }
+}
+
+/**
+ * Remove the least recently used entries from the cache until
+ * it is small enough
+ * @param max_size maximum number of bytes the cache can use
+ */
+static void
+_cache_shrink(size_t max_size) {
+  struct _telnet_cache_entry *entry, *it;
+
+  list_for_each_element_safe(&_telnet_cache_lru, entry, _lru_node, it) {
+    if (_telnet_cache_used <= max_size) {
+      return;
+    }
+    _cache_remove(entry);
+  }
+}
+
+/**
+ * Copy the next chunk of a cached output into the output buffer
+ * @param data pointer to telnet data
+ * @return telnet command result
+ */
+static enum oonf_telnet_result
+_cb_cache_next_chunk(struct oonf_telnet_data *data) {
+  struct _telnet_cache_reader *reader;
+  size_t len;
+
+  reader = data->chunk_data;
+
+  len = abuf_getlen(&reader->entry->output) - reader->offset;
+  if (len > TELNET_CACHE_CHUNK_SIZE) {
+    len = TELNET_CACHE_CHUNK_SIZE;
+  }
+
+  abuf_memcpy(data->out, abuf_getptr(&reader->entry->output) + reader->offset, len);
+  reader->offset += len;
+
+  if (reader->offset < abuf_getlen(&reader->entry->output)) {
+    return TELNET_RESULT_CONTINOUS;
+  }
+  return TELNET_RESULT_ACTIVE;
+}
+
+/**
+ * Release a cached output after it has been sent
+ * @param data pointer to telnet data
+ */
+static void
+_cb_cache_chunk_cleanup(struct oonf_telnet_data *data) {
+  struct _telnet_cache_reader *reader;
+
+  reader = data->chunk_data;
+
+  reader->entry->_readers--;
+  if (reader->entry->_readers == 0
+      && !list_is_node_added(&reader->entry->_lru_node)) {
+    /* entry has been removed from the cache while it was sent */
+    _cache_free(reader->entry);
+  }
+  oonf_class_free(&_telnet_cache_reader_class, reader);
+}
+
 /**
  * Telnet command 'quit'
  * @param data pointer to telnet data
@@ -688,7 +1270,7 @@ _cb_telnet_repeat_timer(struct oonf_timer_instance *ptr) {
   telnet_data->command = telnet_data->stop_data[1];
   telnet_data->parameter = telnet_data->stop_data[2];
 
-  if (_telnet_handle_command(telnet_data) != TELNET_RESULT_ACTIVE) {
+  if (_telnet_handle_command_complete(telnet_data) != TELNET_RESULT_ACTIVE) {
     _call_stop_handler(telnet_data);
   }
 
@@ -744,7 +1326,7 @@ _cb_telnet_repeat(struct oonf_telnet_data *data) {
   data->command = data->stop_data[1];
   data->parameter = data->stop_data[2];
 
-  if (_telnet_handle_command(data) != TELNET_RESULT_ACTIVE) {
+  if (_telnet_handle_command_complete(data) != TELNET_RESULT_ACTIVE) {
     _call_stop_handler(data);
   }
 
@@ -771,6 +1353,9 @@ _cb_config_changed(void) {
   _telnet_managed.config.allowed_sessions = config.allowed_sessions;
   _telnet_managed.config.session_timeout = config.timeout;
 
+  _telnet_cache_size = config.cache_size;
+  _cache_shrink(_telnet_cache_size);
+
   if (oonf_stream_apply_managed(&_telnet_managed, &config.osmc)) {
     /* error while updating sockets */
     goto apply_config_failed;
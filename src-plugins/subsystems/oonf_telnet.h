@@ -134,6 +134,36 @@ struct oonf_telnet_data {
   /*! custom timer for stop handler */
   struct oonf_timer_instance stop_timer;
 
+  /**
+   * Callback triggered when the output buffer of a continuous
+   * command has been sent to the client completely
+   * @param data this telnet data object
+   */
+  void (*drain_handler)(struct oonf_telnet_data *data);
+
+  /**
+   * Callback triggered to generate the next part of a large command
+   * output after the previous part has been sent to the client
+   * @param data this telnet data object
+   * @return TELNET_RESULT_CONTINOUS if more output will follow,
+   *   TELNET_RESULT_ACTIVE if the output is complete, any other
+   *   result to abort the command
+   */
+  enum oonf_telnet_result (*chunk_handler)(struct oonf_telnet_data *data);
+
+  /**
+   * Callback triggered to release the state of the chunk handler,
+   * either after the output is complete or when the session ends
+   * @param data this telnet data object
+   */
+  void (*chunk_cleanup)(struct oonf_telnet_data *data);
+
+  /*! custom data for chunk handler */
+  void *chunk_data;
+
+  /*! internal cache entry that records the output of the current command */
+  void *_cache_entry;
+
   /*! list of cleanup handlers */
   struct list_entity cleanup_list;
 };
@@ -189,6 +219,15 @@ struct oonf_telnet_command {
    */
   enum oonf_telnet_result (*help_handler)(struct oonf_telnet_data *con);
 
+  /**
+   * callback triggered to get the generation of the data the command
+   * output is based on. The output of the command is cached and reused
+   * until the generation changes. NULL if the output must not be cached.
+   * @param con telnet data
+   * @return current generation, 0 if this output must not be cached
+   */
+  uint64_t (*cb_get_generation)(struct oonf_telnet_data *con);
+
   /*! node for tree of telnet commands */
   struct avl_node _node;
 };
@@ -201,6 +240,8 @@ EXPORT void oonf_telnet_stop(struct oonf_telnet_data *data, bool print_prompt);
 EXPORT enum oonf_telnet_result oonf_telnet_execute(
     const char *cmd, const char *para,
     struct autobuf *out, struct netaddr *remote);
+EXPORT uint64_t oonf_telnet_get_generation(const char *cmd, const char *para,
+    struct netaddr *remote);
 
 /**
  * Add a cleanup handler to a telnet session
@@ -239,4 +280,21 @@ oonf_telnet_flush_session(struct oonf_telnet_data *data) {
   }
 }
 
+/**
+ * @param data pointer to telnet data
+ * @return number of bytes in the output buffer that have not
+ *   been sent to the peer yet
+ */
+static INLINE size_t
+oonf_telnet_get_unsent_length(struct oonf_telnet_data *data) {
+  struct oonf_telnet_session *session;
+
+  session = container_of(data, struct oonf_telnet_session, data);
+  if (data->out != &session->session.out) {
+    /* command output is not written into a stream session */
+    return abuf_getlen(data->out);
+  }
+  return oonf_stream_get_unsent_length(&session->session);
+}
+
 #endif /* OONF_TELNET_H_ */
@@ -50,11 +50,11 @@
 
 #include "common/avl.h"
 #include "common/common_types.h"
+#include "common/timer_wheel.h"
 #include "core/oonf_logging.h"
 #include "core/oonf_subsystem.h"
 #include "core/os_core.h"
 #include "subsystems/oonf_clock.h"
-#include "subsystems/os_clock.h"
 
 #include "subsystems/oonf_timer.h"
 
@@ -66,10 +66,21 @@ static int _init(void);
 static void _cleanup(void);
 
 static void _calc_clock(struct oonf_timer_instance *timer, uint64_t rel_time);
+static void _add_timer(struct oonf_timer_instance *timer);
+static void _remove_timer(struct oonf_timer_instance *timer);
+static struct oonf_timer_instance *_get_expired_timer(uint64_t now);
+
+#ifdef OONF_TIMER_WHEEL
+static void _cb_stop_class_timer(struct timer_wheel_node *node, void *ptr);
+
+/* wheel of all timers */
+static struct timer_wheel _timer_wheel;
+#else
 static int _avlcomp_timer(const void *p1, const void *p2);
 
 /* tree of all timers */
 static struct avl_tree _timer_tree;
+#endif
 
 /* true if scheduler is active */
 static bool _scheduling_now;
@@ -100,7 +111,11 @@ _init(void)
 {
   OONF_INFO(LOG_TIMER, "Initializing timer scheduler.\n");
 
+#ifdef OONF_TIMER_WHEEL
+  timer_wheel_init(&_timer_wheel, oonf_clock_getNow() / OONF_TIMER_SLICE);
+#else
   avl_init(&_timer_tree, _avlcomp_timer, true);
+#endif
   _scheduling_now = false;
 
   list_init_head(&_timer_info_list);
@@ -140,18 +155,24 @@ oonf_timer_add(struct oonf_timer_class *ti) {
  */
 void
 oonf_timer_remove(struct oonf_timer_class *info) {
+#ifndef OONF_TIMER_WHEEL
   struct oonf_timer_instance *timer, *iterator;
+#endif
 
   if (!list_is_node_added(&info->_node)) {
 	  /* only free node if its hooked to the timer core */
 	return;
   }
 
+#ifdef OONF_TIMER_WHEEL
+  timer_wheel_for_each(&_timer_wheel, _cb_stop_class_timer, info);
+#else
   avl_for_each_element_safe(&_timer_tree, timer, _node, iterator) {
     if (timer->class == info) {
       oonf_timer_stop(timer);
     }
   }
+#endif
 
   list_remove(&info->_node);
 }
@@ -173,11 +194,10 @@ oonf_timer_start_ext(struct oonf_timer_instance *timer, uint64_t first, uint64_t
   assert(timer->jitter_pct <= 100);
 
   if (timer->_clock) {
-    avl_remove(&_timer_tree, &timer->_node);
+    _remove_timer(timer);
     timer->class->_stat_changes++;
   }
   else {
-    timer->_node.key = timer;
     timer->class->_stat_usage++;
   }
 
@@ -197,8 +217,8 @@ oonf_timer_start_ext(struct oonf_timer_instance *timer, uint64_t first, uint64_t
   /* Singleshot or periodical timer ? */
   timer->_period = timer->class->periodic ? interval : 0;
 
-  /* insert into tree */
-  avl_insert(&_timer_tree, &timer->_node);
+  /* insert into scheduler */
+  _add_timer(timer);
 
   OONF_DEBUG(LOG_TIMER, "TIMER: start timer '%s' firing in %s (%"PRIu64")\n",
       timer->class->name,
@@ -218,8 +238,8 @@ oonf_timer_stop(struct oonf_timer_instance *timer)
 
   OONF_DEBUG(LOG_TIMER, "TIMER: stop %s\n", timer->class->name);
 
-  /* remove timer from tree */
-  avl_remove(&_timer_tree, &timer->_node);
+  /* remove timer from scheduler */
+  _remove_timer(timer);
   timer->_clock = 0;
   timer->_random = 0;
   timer->class->_stat_usage--;
@@ -264,13 +284,10 @@ oonf_timer_walk(void)
 
   _scheduling_now = true;
 
-  while (!avl_is_empty(&_timer_tree)) {
-    timer = avl_first_element(&_timer_tree, timer, _node);
-
-    if (timer->_clock > oonf_clock_getNow()) {
-      break;
-    }
+  /* the end of the last measurement of the scheduler is the start of the first callback */
+  start_time = oonf_clock_getMeasuredUsec();
 
+  while ((timer = _get_expired_timer(oonf_clock_getNow())) != NULL) {
     OONF_DEBUG(LOG_TIMER, "TIMER: fire '%s' at clocktick %" PRIu64 "\n",
                   timer->class->name, timer->_clock);
 
@@ -290,15 +307,21 @@ oonf_timer_walk(void)
     }
 
     /* This timer is expired, call into the provided callback function */
-    os_clock_gettime64(&start_time);
     timer->class->callback(timer);
-    os_clock_gettime64(&end_time);
 
-    if (end_time - start_time > OONF_TIMER_SLICE) {
+    /*
+     * the end of this callback is the start of the next one,
+     * the internal OONF time stays the same for the whole walk
+     */
+    end_time = oonf_clock_measureUsec();
+    histogram_add(&info->_stat_runtime, end_time - start_time);
+
+    if (end_time - start_time > OONF_TIMER_SLICE * USEC_PER_MSEC) {
       OONF_WARN(LOG_TIMER, "Timer %s scheduling took %"PRIu64" ms",
-          timer->class->name, end_time - start_time);
+          timer->class->name, (end_time - start_time) / USEC_PER_MSEC);
       info->_stat_long++;
     }
+    start_time = end_time;
 
     /*
      * Only act on actually running timers, the callback might have
@@ -325,6 +348,12 @@ oonf_timer_walk(void)
  */
 uint64_t
 oonf_timer_getNextEvent(void) {
+#ifdef OONF_TIMER_WHEEL
+  if (timer_wheel_is_empty(&_timer_wheel)) {
+    return UINT64_MAX;
+  }
+  return timer_wheel_get_next(&_timer_wheel) * OONF_TIMER_SLICE;
+#else
   struct oonf_timer_instance *first;
 
   if (avl_is_empty(&_timer_tree)) {
@@ -333,6 +362,7 @@ oonf_timer_getNextEvent(void) {
 
   first = avl_first_element(&_timer_tree, first, _node);
   return first->_clock;
+#endif
 }
 
 /**
@@ -375,6 +405,94 @@ _calc_clock(struct oonf_timer_instance *timer, uint64_t rel_time)
   timer->_clock -= (timer->_clock % OONF_TIMER_SLICE);
 }
 
+#ifdef OONF_TIMER_WHEEL
+/**
+ * Add a timer to the timer wheel
+ * @param timer timer instance with initialized clock
+ */
+static void
+_add_timer(struct oonf_timer_instance *timer) {
+  /* clock is always a multiple of the timeslice */
+  timer_wheel_insert(&_timer_wheel, &timer->_wheel_node,
+      timer->_clock / OONF_TIMER_SLICE);
+}
+
+/**
+ * Remove a timer from the timer wheel
+ * @param timer active timer instance
+ */
+static void
+_remove_timer(struct oonf_timer_instance *timer) {
+  timer_wheel_remove(&_timer_wheel, &timer->_wheel_node);
+}
+
+/**
+ * @param now current time
+ * @return first timer which should have fired until now,
+ *   NULL if no timer is due
+ */
+static struct oonf_timer_instance *
+_get_expired_timer(uint64_t now) {
+  struct oonf_timer_instance *timer;
+
+  return timer_wheel_get_expired_element(
+      &_timer_wheel, now / OONF_TIMER_SLICE, timer, _wheel_node);
+}
+
+/**
+ * Callback for timer wheel iteration to stop all timers of a class
+ * @param node timer wheel node
+ * @param ptr timer class
+ */
+static void
+_cb_stop_class_timer(struct timer_wheel_node *node, void *ptr) {
+  struct oonf_timer_instance *timer;
+
+  timer = container_of(node, struct oonf_timer_instance, _wheel_node);
+  if (timer->class == ptr) {
+    oonf_timer_stop(timer);
+  }
+}
+#else
+/**
+ * Add a timer to the timer tree
+ * @param timer timer instance with initialized clock
+ */
+static void
+_add_timer(struct oonf_timer_instance *timer) {
+  timer->_node.key = timer;
+  avl_insert(&_timer_tree, &timer->_node);
+}
+
+/**
+ * Remove a timer from the timer tree
+ * @param timer active timer instance
+ */
+static void
+_remove_timer(struct oonf_timer_instance *timer) {
+  avl_remove(&_timer_tree, &timer->_node);
+}
+
+/**
+ * @param now current time
+ * @return first timer which should have fired until now,
+ *   NULL if no timer is due
+ */
+static struct oonf_timer_instance *
+_get_expired_timer(uint64_t now) {
+  struct oonf_timer_instance *timer;
+
+  if (avl_is_empty(&_timer_tree)) {
+    return NULL;
+  }
+
+  timer = avl_first_element(&_timer_tree, timer, _node);
+  if (timer->_clock > now) {
+    return NULL;
+  }
+  return timer;
+}
+
 /**
  * Custom AVL comparator for two timer entries.
  * @param p1 first timer entry
@@ -396,3 +514,4 @@ _avlcomp_timer(const void *p1, const void *p2) {
   }
   return 0;
 }
+#endif
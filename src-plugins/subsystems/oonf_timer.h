@@ -49,6 +49,8 @@
 #include "common/common_types.h"
 #include "common/list.h"
 #include "common/avl.h"
+#include "common/histogram.h"
+#include "common/timer_wheel.h"
 
 #include "subsystems/oonf_clock.h"
 
@@ -92,6 +94,9 @@ struct oonf_timer_class {
   /*! number of times the timer took more than a timeslice */
   uint32_t _stat_long;
 
+  /*! histogram of the callback runtime in microseconds */
+  struct histogram _stat_runtime;
+
   /*! pointer to timer currently in callback */
   struct oonf_timer_instance *_timer_in_callback;
 
@@ -106,6 +111,9 @@ struct oonf_timer_instance {
   /*! node of timer class tree of instances */
   struct avl_node _node;
 
+  /*! node of timer wheel of scheduler */
+  struct timer_wheel_node _wheel_node;
+
   /*! backpointer to timer class */
   struct oonf_timer_class *class;
 
@@ -222,4 +230,13 @@ oonf_timer_get_long(struct oonf_timer_class *tc) {
   return tc->_stat_long;
 }
 
+/**
+ * @param tc timer class
+ * @return histogram of the callback runtime in microseconds
+ */
+static INLINE const struct histogram *
+oonf_timer_get_runtime(struct oonf_timer_class *tc) {
+  return &tc->_stat_runtime;
+}
+
 #endif /* OONF_TIMER_H_ */
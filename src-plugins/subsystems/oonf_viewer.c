@@ -46,18 +46,41 @@
 #include "common/common_types.h"
 #include "common/autobuf.h"
 #include "common/json.h"
+#include "common/string.h"
 #include "common/template.h"
 #include "core/oonf_subsystem.h"
+#include "subsystems/oonf_class.h"
 #include "subsystems/oonf_telnet.h" /* compile-time dependency */
 #include "subsystems/oonf_viewer.h"
 
 /* Definitions */
 #define LOG_VIEWER _oonf_viewer_subsystem.logging
 
+/**
+ * State of a chunked viewer output of a telnet session
+ */
+struct _chunked_output {
+  /*! private copy of the viewer template */
+  struct oonf_viewer_template template;
+
+  /*! template storage for text output */
+  struct abuf_template_storage storage;
+
+  /*! copy of the custom text format, NULL if not used */
+  char *format;
+};
+
 /* static function prototypes */
 static int _init(void);
 static void _cleanup(void);
 
+static const char *_parse_format(const char *param,
+    bool *head, bool *json, bool *raw, bool *data);
+static void _reset_cursor(struct oonf_viewer_cursor *cursor, unsigned level);
+static int _call_chunk_function(struct oonf_viewer_template *template);
+static enum oonf_telnet_result _cb_telnet_next_chunk(struct oonf_telnet_data *con);
+static void _cb_telnet_chunk_cleanup(struct oonf_telnet_data *con);
+
 /* Template call help text for telnet */
 static const char _telnet_help[] =
     "\n"
@@ -73,9 +96,22 @@ static const char _telnet_help[] =
     "You can also add a custom template (text with keys inside)"
     " as the last parameter instead.\n";
 
+/* memory class for chunked telnet output */
+static struct oonf_class _chunked_class = {
+  .name = "viewer chunked output",
+  .size = sizeof(struct _chunked_output),
+};
+
 /* subsystem definition */
+static const char *_dependencies[] = {
+  OONF_CLASS_SUBSYSTEM,
+  OONF_TELNET_SUBSYSTEM,
+};
+
 static struct oonf_subsystem _oonf_viewer_subsystem = {
   .name = OONF_VIEWER_SUBSYSTEM,
+  .dependencies = _dependencies,
+  .dependencies_count = ARRAYSIZE(_dependencies),
   .init = _init,
   .cleanup = _cleanup,
 };
@@ -87,6 +123,7 @@ DECLARE_OONF_PLUGIN(_oonf_viewer_subsystem);
  */
 static int
 _init(void) {
+  oonf_class_add(&_chunked_class);
   return 0;
 }
 
@@ -95,6 +132,7 @@ _init(void) {
  */
 static void
 _cleanup(void) {
+  oonf_class_remove(&_chunked_class);
 }
 
 /**
@@ -172,6 +210,97 @@ oonf_viewer_output_finish(struct oonf_viewer_template *template) {
   }
 }
 
+/**
+ * Check if the current chunk of a chunked viewer is full
+ * @param template pointer to viewer template
+ * @return true if the viewer should return and continue later
+ */
+bool
+oonf_viewer_output_chunk_full(struct oonf_viewer_template *template) {
+  return abuf_getlen(template->out) >= template->_chunk_start + OONF_VIEWER_CHUNK_SIZE;
+}
+
+/**
+ * Get the element of an AVL tree a chunked viewer should continue
+ * with. If the element stored in the cursor has been removed, the
+ * iteration continues with the next larger key and all deeper
+ * levels of the cursor start from the beginning.
+ * @param cursor pointer to viewer cursor
+ * @param level nesting level of the tree
+ * @param tree pointer to avl tree
+ * @return pointer to tree node, NULL if there are no more elements
+ */
+struct avl_node *
+oonf_viewer_cursor_resume(struct oonf_viewer_cursor *cursor,
+    unsigned level, struct avl_tree *tree) {
+  struct avl_node *node;
+
+  if (avl_is_empty(tree)) {
+    return NULL;
+  }
+  if (cursor->level[level].state == OONF_VIEWER_CURSOR_START) {
+    return container_of(tree->list_head.next, struct avl_node, list);
+  }
+
+  node = avl_find_greaterequal(tree, cursor->level[level].key);
+  if (node == NULL) {
+    return NULL;
+  }
+
+  if (tree->comp(node->key, cursor->level[level].key) != 0) {
+    /* element is gone, restart the nested trees of the next one */
+    _reset_cursor(cursor, level + 1);
+  }
+  else if (cursor->level[level].state == OONF_VIEWER_CURSOR_DONE) {
+    /* element has already been printed */
+    node = avl_is_last(tree, node)
+        ? NULL : container_of(node->list.next, struct avl_node, list);
+  }
+  return node;
+}
+
+/**
+ * Remember the element a chunked viewer is working on
+ * @param cursor pointer to viewer cursor
+ * @param level nesting level of the tree
+ * @param key pointer to key of the element
+ * @param key_size length of the key in bytes
+ */
+void
+oonf_viewer_cursor_enter(struct oonf_viewer_cursor *cursor,
+    unsigned level, const void *key, size_t key_size) {
+  if (cursor->level[level].state == OONF_VIEWER_CURSOR_CURRENT
+      && memcmp(cursor->level[level].key, key, key_size) == 0) {
+    /* resumed element, keep position in nested trees */
+    return;
+  }
+
+  memcpy(cursor->level[level].key, key, key_size);
+  cursor->level[level].state = OONF_VIEWER_CURSOR_CURRENT;
+  _reset_cursor(cursor, level + 1);
+}
+
+/**
+ * Mark the current element of a chunked viewer as printed
+ * @param cursor pointer to viewer cursor
+ * @param level nesting level of the tree
+ */
+void
+oonf_viewer_cursor_leave(struct oonf_viewer_cursor *cursor, unsigned level) {
+  cursor->level[level].state = OONF_VIEWER_CURSOR_DONE;
+  _reset_cursor(cursor, level + 1);
+}
+
+/**
+ * Switch a chunked viewer to its next tree
+ * @param cursor pointer to viewer cursor
+ */
+void
+oonf_viewer_cursor_next_phase(struct oonf_viewer_cursor *cursor) {
+  cursor->phase++;
+  _reset_cursor(cursor, 0);
+}
+
 /**
  * Print telnet help text for array of templates
  * @param out output buffer
@@ -240,36 +369,9 @@ oonf_viewer_call_subcommands(struct autobuf *out,
   const char *next = NULL, *ptr = NULL;
   int result = 0;
   size_t i;
-  bool head = false;
-  bool json = false;
-  bool raw = false;
-  bool data = false;
+  bool head, json, raw, data;
 
-  if ((next = str_hasnextword(param, OONF_VIEWER_HEAD_FORMAT))) {
-    head = true;
-  }
-  else if ((next = str_hasnextword(param, OONF_VIEWER_JSON_FORMAT))) {
-    json = true;
-  }
-  else if ((next = str_hasnextword(param, OONF_VIEWER_RAW_FORMAT))) {
-    raw = true;
-  }
-  else if ((next = str_hasnextword(param, OONF_VIEWER_JSON_RAW_FORMAT))) {
-    json = true;
-    raw = true;
-  }
-  else if ((next = str_hasnextword(param, OONF_VIEWER_DATA_FORMAT))) {
-    json = true;
-    data = true;
-  }
-  else if ((next = str_hasnextword(param, OONF_VIEWER_DATA_RAW_FORMAT))) {
-    json = true;
-    raw = true;
-    data = true;
-  }
-  else {
-    next = param;
-  }
+  next = _parse_format(param, &head, &json, &raw, &data);
 
   for (i=0; i<count; i++) {
     if ((ptr = str_hasnextword(next, templates[i].json_name))) {
@@ -283,9 +385,16 @@ oonf_viewer_call_subcommands(struct autobuf *out,
         abuf_add_template(out, templates[i]._storage, true);
         abuf_puts(out, "\n");
       }
-      else {
+      else if (templates[i].cb_function) {
         result = templates[i].cb_function(&templates[i]);
       }
+      else {
+        /* generate all chunks at once */
+        memset(&templates[i].cursor, 0, sizeof(templates[i].cursor));
+        do {
+          result = _call_chunk_function(&templates[i]);
+        } while (result > 0);
+      }
 
       oonf_viewer_output_finish(&templates[i]);
 
@@ -329,6 +438,104 @@ oonf_viewer_telnet_handler(struct autobuf *out,
   return TELNET_RESULT_ACTIVE;
 }
 
+/**
+ * Get the generation of the output of a viewer telnet command
+ * @param param telnet parameter(s)
+ * @param templates template viewer array
+ * @param count number of template viewer entries
+ * @return generation of the data of the selected template,
+ *   0 if the output must not be cached
+ */
+uint64_t
+oonf_viewer_telnet_get_generation(const char *param,
+    struct oonf_viewer_template *templates, size_t count) {
+  const char *next;
+  bool head, json, raw, data;
+  size_t i;
+
+  if (param == NULL || *param == 0) {
+    return 0;
+  }
+
+  next = _parse_format(param, &head, &json, &raw, &data);
+  for (i=0; i<count; i++) {
+    if (str_hasnextword(next, templates[i].json_name)) {
+      if (head || templates[i].cb_get_generation == NULL) {
+        return 0;
+      }
+      return templates[i].cb_get_generation();
+    }
+  }
+  return 0;
+}
+
+/**
+ * Handles a telnet command for a viewer including error handling.
+ * Templates with a chunk function generate their output step by step
+ * each time the telnet session has sent the previous chunk.
+ * @param con telnet data
+ * @param storage template storage object, used for non-chunked output
+ * @param cmd telnet command
+ * @param templates template viewer array
+ * @param count number of template viewer entries
+ * @return telnet return code
+ */
+enum oonf_telnet_result
+oonf_viewer_telnet_chunked_handler(struct oonf_telnet_data *con,
+    struct abuf_template_storage *storage, const char *cmd,
+    struct oonf_viewer_template *templates, size_t count) {
+  struct _chunked_output *chunked;
+  const char *next, *ptr = NULL;
+  bool head, json, raw, data;
+  size_t i;
+
+  if (con->parameter == NULL || *con->parameter == 0) {
+    return oonf_viewer_telnet_handler(con->out, storage, cmd,
+        con->parameter, templates, count);
+  }
+
+  next = _parse_format(con->parameter, &head, &json, &raw, &data);
+  for (i=0; i<count; i++) {
+    if ((ptr = str_hasnextword(next, templates[i].json_name))) {
+      break;
+    }
+  }
+
+  if (i == count || head || templates[i].cb_chunk_function == NULL) {
+    return oonf_viewer_telnet_handler(con->out, storage, cmd,
+        con->parameter, templates, count);
+  }
+
+  chunked = oonf_class_malloc(&_chunked_class);
+  if (chunked == NULL) {
+    return TELNET_RESULT_INTERNAL_ERROR;
+  }
+
+  /* the parameter string is only valid during this call */
+  if (ptr != NULL && *ptr != 0) {
+    chunked->format = strdup(ptr);
+    if (chunked->format == NULL) {
+      oonf_class_free(&_chunked_class, chunked);
+      return TELNET_RESULT_INTERNAL_ERROR;
+    }
+  }
+
+  memcpy(&chunked->template, &templates[i], sizeof(chunked->template));
+  memset(&chunked->template.cursor, 0, sizeof(chunked->template.cursor));
+  chunked->template.create_json = json;
+  chunked->template.create_raw = raw;
+  chunked->template.create_only_data = data;
+
+  oonf_viewer_output_prepare(&chunked->template, &chunked->storage,
+      con->out, chunked->format);
+
+  /* telnet calls the chunk handler when the output buffer is empty */
+  con->chunk_handler = _cb_telnet_next_chunk;
+  con->chunk_cleanup = _cb_telnet_chunk_cleanup;
+  con->chunk_data = chunked;
+  return TELNET_RESULT_ACTIVE;
+}
+
 /**
  * Handles a telnet help command for a viewer including error handling
  * @param out output buffer
@@ -353,3 +560,112 @@ oonf_viewer_telnet_help(struct autobuf *out,
 
   return TELNET_RESULT_ACTIVE;
 }
+
+/**
+ * Parse the output format keyword at the start of a viewer parameter
+ * @param param viewer parameter
+ * @param head set to true if only a headline should be printed
+ * @param json set to true for JSON output
+ * @param raw set to true for raw numbers
+ * @param data set to true for JSON output without enclosing object
+ * @return pointer to remaining parameter after the format keyword
+ */
+static const char *
+_parse_format(const char *param, bool *head, bool *json, bool *raw, bool *data) {
+  const char *next;
+
+  *head = false;
+  *json = false;
+  *raw = false;
+  *data = false;
+
+  if ((next = str_hasnextword(param, OONF_VIEWER_HEAD_FORMAT))) {
+    *head = true;
+  }
+  else if ((next = str_hasnextword(param, OONF_VIEWER_JSON_FORMAT))) {
+    *json = true;
+  }
+  else if ((next = str_hasnextword(param, OONF_VIEWER_RAW_FORMAT))) {
+    *raw = true;
+  }
+  else if ((next = str_hasnextword(param, OONF_VIEWER_JSON_RAW_FORMAT))) {
+    *json = true;
+    *raw = true;
+  }
+  else if ((next = str_hasnextword(param, OONF_VIEWER_DATA_FORMAT))) {
+    *json = true;
+    *data = true;
+  }
+  else if ((next = str_hasnextword(param, OONF_VIEWER_DATA_RAW_FORMAT))) {
+    *json = true;
+    *raw = true;
+    *data = true;
+  }
+  else {
+    next = param;
+  }
+  return next;
+}
+
+/**
+ * Reset a viewer cursor to the start of the trees of a level
+ * and all deeper levels
+ * @param cursor pointer to viewer cursor
+ * @param level first level to reset
+ */
+static void
+_reset_cursor(struct oonf_viewer_cursor *cursor, unsigned level) {
+  for (; level < OONF_VIEWER_CURSOR_DEPTH; level++) {
+    cursor->level[level].state = OONF_VIEWER_CURSOR_START;
+  }
+}
+
+/**
+ * Generate the next chunk of a viewer template
+ * @param template pointer to viewer template
+ * @return -1 if an error happened, 0 if the output is complete,
+ *   1 if more output will follow
+ */
+static int
+_call_chunk_function(struct oonf_viewer_template *template) {
+  template->_chunk_start = abuf_getlen(template->out);
+  return template->cb_chunk_function(template);
+}
+
+/**
+ * Telnet callback to generate the next chunk of a viewer output
+ * @param con telnet data
+ * @return telnet result
+ */
+static enum oonf_telnet_result
+_cb_telnet_next_chunk(struct oonf_telnet_data *con) {
+  struct _chunked_output *chunked;
+  int result;
+
+  chunked = con->chunk_data;
+
+  result = _call_chunk_function(&chunked->template);
+  if (result > 0) {
+    return TELNET_RESULT_CONTINOUS;
+  }
+  if (result < 0) {
+    return TELNET_RESULT_INTERNAL_ERROR;
+  }
+
+  oonf_viewer_output_finish(&chunked->template);
+  return TELNET_RESULT_ACTIVE;
+}
+
+/**
+ * Telnet callback to free the state of a chunked viewer output
+ * @param con telnet data
+ */
+static void
+_cb_telnet_chunk_cleanup(struct oonf_telnet_data *con) {
+  struct _chunked_output *chunked;
+
+  chunked = con->chunk_data;
+
+  free(chunked->format);
+  oonf_class_free(&_chunked_class, chunked);
+}
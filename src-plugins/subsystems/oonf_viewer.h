@@ -48,6 +48,7 @@
 
 #include "common/common_types.h"
 #include "common/autobuf.h"
+#include "common/avl.h"
 #include "common/json.h"
 #include "common/template.h"
 
@@ -78,6 +79,49 @@
  */
 #define OONF_VIEWER_DATA_RAW_FORMAT "dataraw"
 
+/*! number of bytes a chunked viewer should generate per call */
+#define OONF_VIEWER_CHUNK_SIZE 16384
+
+/*! maximum number of nested trees a viewer cursor can resume */
+#define OONF_VIEWER_CURSOR_DEPTH 2
+
+/*! maximum size of a tree key that can be stored in a viewer cursor */
+#define OONF_VIEWER_CURSOR_KEYSIZE 64
+
+/**
+ * State of one level of a viewer cursor
+ */
+enum oonf_viewer_cursor_state {
+  /*! iteration starts with the first element of the tree */
+  OONF_VIEWER_CURSOR_START,
+
+  /*! iteration resumes with the element of the stored key */
+  OONF_VIEWER_CURSOR_CURRENT,
+
+  /*! iteration resumes after the element of the stored key */
+  OONF_VIEWER_CURSOR_DONE,
+};
+
+/**
+ * Position of a chunked viewer in its (nested) AVL trees. The cursor
+ * keeps a copy of the key of the current element of each level, so
+ * the iteration can resume even if the element was removed from
+ * the tree between two chunks.
+ */
+struct oonf_viewer_cursor {
+  /*! counter for viewers that print more than one tree after each other */
+  int phase;
+
+  /*! position for each level of nested trees */
+  struct {
+    /*! copy of the key of the current element */
+    uint64_t key[OONF_VIEWER_CURSOR_KEYSIZE / sizeof(uint64_t)];
+
+    /*! state of this cursor level */
+    enum oonf_viewer_cursor_state state;
+  } level[OONF_VIEWER_CURSOR_DEPTH];
+};
+
 /**
  * This struct defines a template engine command that can output both
  * table and JSON.
@@ -117,6 +161,31 @@ struct oonf_viewer_template {
    */
   int (*cb_function)(struct oonf_viewer_template *);
 
+  /**
+   * Callback triggered to generate the next chunk of the content of the
+   * template, can be used instead of cb_function for large outputs.
+   * The callback should remember its position with the cursor and
+   * return when oonf_viewer_output_chunk_full() reports a full chunk.
+   * @param this viewer template
+   * @return -1 if an error happened, 0 if the output is complete,
+   *   1 if more output will follow
+   */
+  int (*cb_chunk_function)(struct oonf_viewer_template *);
+
+  /**
+   * Callback triggered to get the generation of the data shown by the
+   * template, the output is cached until the generation changes.
+   * NULL if the output of the template must not be cached.
+   * @return current generation, 0 if the output must not be cached
+   */
+  uint64_t (*cb_get_generation)(void);
+
+  /*! iteration state of chunked output */
+  struct oonf_viewer_cursor cursor;
+
+  /*! length of the output buffer at the start of the current chunk */
+  size_t _chunk_start;
+
   /*! internal variable for template engine storage array */
   struct abuf_template_storage *_storage;
 
@@ -128,6 +197,15 @@ EXPORT void oonf_viewer_output_prepare(struct oonf_viewer_template *template,
     struct abuf_template_storage *storage, struct autobuf *out, const char *format);
 EXPORT void oonf_viewer_output_print_line(struct oonf_viewer_template *template);
 EXPORT void oonf_viewer_output_finish(struct oonf_viewer_template *template);
+EXPORT bool oonf_viewer_output_chunk_full(struct oonf_viewer_template *template);
+
+EXPORT struct avl_node *oonf_viewer_cursor_resume(
+    struct oonf_viewer_cursor *cursor, unsigned level, struct avl_tree *tree);
+EXPORT void oonf_viewer_cursor_enter(struct oonf_viewer_cursor *cursor,
+    unsigned level, const void *key, size_t key_size);
+EXPORT void oonf_viewer_cursor_leave(struct oonf_viewer_cursor *cursor,
+    unsigned level);
+EXPORT void oonf_viewer_cursor_next_phase(struct oonf_viewer_cursor *cursor);
 
 EXPORT void oonf_viewer_print_help(struct autobuf *out,
     const char *parameter, struct oonf_viewer_template *template, size_t count);
@@ -137,8 +215,42 @@ EXPORT int oonf_viewer_call_subcommands(struct autobuf *out,
 EXPORT enum oonf_telnet_result oonf_viewer_telnet_handler(struct autobuf *out,
     struct abuf_template_storage *storage, const char *cmd, const char *param,
     struct oonf_viewer_template *templates, size_t count);
+EXPORT uint64_t oonf_viewer_telnet_get_generation(const char *param,
+    struct oonf_viewer_template *templates, size_t count);
+EXPORT enum oonf_telnet_result oonf_viewer_telnet_chunked_handler(
+    struct oonf_telnet_data *con, struct abuf_template_storage *storage,
+    const char *cmd, struct oonf_viewer_template *templates, size_t count);
 EXPORT enum oonf_telnet_result oonf_viewer_telnet_help(struct autobuf *out,
     const char *cmd, const char *parameter,
     struct oonf_viewer_template *template, size_t count);
 
+/**
+ * @param cursor pointer to viewer cursor
+ * @param level nesting level of the tree
+ * @return true if the iteration of this level has already started
+ *   in a previous chunk
+ */
+static INLINE bool
+oonf_viewer_cursor_is_started(const struct oonf_viewer_cursor *cursor,
+    unsigned level) {
+  return cursor->level[level].state != OONF_VIEWER_CURSOR_START;
+}
+
+/**
+ * Loop over the elements of an AVL tree, starting at the position
+ * stored in the cursor of a chunked viewer
+ * @param cursor pointer to viewer cursor
+ * @param level nesting level of the tree
+ * @param tree pointer to avl tree
+ * @param element pointer to a node element
+ *    (don't need to be initialized)
+ * @param node_member name of the avl_node element inside the
+ *    larger struct
+ */
+#define oonf_viewer_for_each_element(cursor, level, tree, element, node_member) \
+  for (element = container_of_if_notnull( \
+           oonf_viewer_cursor_resume(cursor, level, tree), typeof(*(element)), node_member); \
+       element != NULL; \
+       element = avl_next_element_safe(tree, element, node_member))
+
 #endif /* OONF_VIEWER_H_ */
@@ -64,6 +64,23 @@
 struct os_fd;
 struct os_fd_select;
 
+/**
+ * One datagram slot for receiving multiple packets with a single call
+ */
+struct os_fd_recv_slot {
+  /*! buffer for incoming data */
+  void *buf;
+
+  /*! length of buffer */
+  size_t length;
+
+  /*! source of the received packet */
+  union netaddr_socket source;
+
+  /*! number of bytes received into this slot */
+  ssize_t received;
+};
+
 /* pre-declare inlines */
 static INLINE int os_fd_init(struct os_fd *, int fd);
 static INLINE int os_fd_copy(struct os_fd *dst, struct os_fd *from);
@@ -83,6 +100,9 @@ static INLINE int os_fd_event_is_read(struct os_fd *);
 static INLINE int os_fd_event_socket_write(struct os_fd_select *,
     struct os_fd *, bool want_write);
 static INLINE int os_fd_event_is_write(struct os_fd *);
+static INLINE int os_fd_event_socket_edge_triggered(struct os_fd_select *,
+    struct os_fd *, bool edge);
+static INLINE bool os_fd_event_is_edge_triggered(struct os_fd *);
 static INLINE int os_fd_event_socket_remove(struct os_fd_select *, struct os_fd *);
 static INLINE int os_fd_event_set_deadline(struct os_fd_select *, uint64_t deadline);
 static INLINE uint64_t os_fd_event_get_deadline(struct os_fd_select *);
@@ -98,6 +118,8 @@ static INLINE ssize_t os_fd_sendto(struct os_fd *, const void *buf, size_t lengt
     const union netaddr_socket *dst, bool dont_route);
 static INLINE ssize_t os_fd_recvfrom(struct os_fd *, void *buf, size_t length,
     union netaddr_socket *source, const struct os_interface *);
+static INLINE int os_fd_recvfrom_batch(struct os_fd *, struct os_fd_recv_slot *slots,
+    int count, const struct os_interface *);
 static INLINE const char *os_fd_get_loopback_name(void);
 static INLINE ssize_t os_fd_sendfile(struct os_fd *, struct os_fd *,
     size_t offset, size_t count);
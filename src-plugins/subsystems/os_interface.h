@@ -98,6 +98,27 @@ struct os_interface_ip_change {
   void (*cb_finished)(struct os_interface_ip_change *addr, int error);
 };
 
+/**
+ * Types of interface changes, collected until the
+ * interface listeners are informed
+ */
+enum os_interface_change {
+  /*! interface flags (up, promisc, ...) changed */
+  OS_INTERFACE_CHANGE_FLAGS   = 1<<0,
+
+  /*! interface index or base interface index changed */
+  OS_INTERFACE_CHANGE_INDEX   = 1<<1,
+
+  /*! MAC address of interface changed */
+  OS_INTERFACE_CHANGE_MAC     = 1<<2,
+
+  /*! IP address or peer address was added or removed */
+  OS_INTERFACE_CHANGE_ADDRESS = 1<<3,
+
+  /*! all interface data might have changed */
+  OS_INTERFACE_CHANGE_ALL     = (1<<4) - 1,
+};
+
 struct os_interface_flags {
   /*! true if the interface exists and is up */
   bool up;
@@ -192,6 +213,9 @@ struct os_interface {
   /*! timer for lazy interface change handling */
   struct oonf_timer_instance _change_timer;
 
+  /*! number of operation system events since the last listener update */
+  uint32_t _folded_events;
+
   /*! remember if we already initialized the link data */
   bool _link_initialized;
 
@@ -234,6 +258,12 @@ struct os_interface_listener {
   /*! pointer to interface data */
   struct os_interface *data;
 
+  /*! bitmask of os_interface_change types since the last callback */
+  uint32_t changes;
+
+  /*! number of operation system events merged into the changes */
+  uint32_t folded_events;
+
   /*! true if this listener still needs to process a change */
   bool _dirty;
 
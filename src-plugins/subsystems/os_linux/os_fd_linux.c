@@ -43,6 +43,9 @@
  * @file
  */
 
+/*! activate GNU sources for recvmmsg() */
+#define _GNU_SOURCE
+
 #include <net/if.h>
 #include <netinet/in.h>
 #include <sys/ioctl.h>
@@ -58,6 +61,9 @@
 /* Defintions */
 #define LOG_OS_SOCKET _oonf_os_fd_subsystem.logging
 
+/*! maximum number of datagrams read by a single recvmmsg() call */
+#define OS_FD_RECV_BATCH_MAX 64
+
 /* prototypes */
 static int _init(void);
 static void _cleanup(void);
@@ -139,8 +145,12 @@ os_fd_linux_event_socket_modify(struct os_fd_select *sel,
   event.events = sock->wanted_events;
   event.data.ptr = sock;
 
+  if (event.events != 0 && os_fd_event_is_edge_triggered(sock)) {
+    event.events |= EPOLLET;
+  }
+
   OONF_DEBUG(LOG_OS_SOCKET, "Modify socket %d to events 0x%x",
-      sock->fd, sock->wanted_events);
+      sock->fd, event.events);
   return epoll_ctl(sel->_epoll_fd, EPOLL_CTL_MOD, sock->fd, &event);
 }
 
@@ -167,3 +177,42 @@ os_fd_linux_skip_rawsocket_prefix(uint8_t *ptr, ssize_t *len, int af_type) {
   *len -= header_size;
   return ptr + header_size;
 }
+
+/**
+ * Receive multiple datagrams from an UDP socket with a single recvmmsg call
+ * @param sockfd filedescriptor of UDP socket
+ * @param slots array of buffers for incoming data
+ * @param count number of slots in the array
+ * @return number of filled slots, -1 if an error happened
+ */
+int
+os_fd_linux_recvfrom_batch(struct os_fd *sockfd,
+    struct os_fd_recv_slot *slots, int count) {
+  struct mmsghdr msgs[OS_FD_RECV_BATCH_MAX];
+  struct iovec iov[OS_FD_RECV_BATCH_MAX];
+  int i, result;
+
+  if (count > OS_FD_RECV_BATCH_MAX) {
+    count = OS_FD_RECV_BATCH_MAX;
+  }
+
+  memset(msgs, 0, sizeof(*msgs) * count);
+  for (i=0; i<count; i++) {
+    iov[i].iov_base = slots[i].buf;
+    iov[i].iov_len = slots[i].length;
+
+    msgs[i].msg_hdr.msg_name = &slots[i].source;
+    msgs[i].msg_hdr.msg_namelen = sizeof(slots[i].source);
+    msgs[i].msg_hdr.msg_iov = &iov[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+  }
+
+  result = recvmmsg(sockfd->fd, msgs, count, MSG_DONTWAIT, NULL);
+  for (i=0; i<result; i++) {
+    slots[i].received = msgs[i].msg_len;
+  }
+
+  OONF_DEBUG(LOG_OS_SOCKET, "recvmmsg(%d, %d): %d",
+      sockfd->fd, count, result);
+  return result;
+}
@@ -63,8 +63,14 @@
 /*! name of the loopback interface */
 #define IF_LOOPBACK_NAME "lo"
 
+/*! maximum number of events returned by a single epoll_wait() call */
+#ifndef OS_FD_EVENT_BATCH
+#define OS_FD_EVENT_BATCH 64
+#endif
+
 enum os_fd_flags {
   OS_FD_ACTIVE = 1,
+  OS_FD_EDGE_TRIGGERED = 2,
 };
 
 /*! linux specific socket definition */
@@ -84,7 +90,7 @@ struct os_fd {
 
 /*! linux specific socket select definition */
 struct os_fd_select {
-  struct epoll_event _events[16];
+  struct epoll_event _events[OS_FD_EVENT_BATCH];
   int _event_count;
 
   int _epoll_fd;
@@ -97,6 +103,8 @@ EXPORT int os_fd_linux_event_wait(struct os_fd_select *);
 EXPORT int os_fd_linux_event_socket_modify(struct os_fd_select *sel,
     struct os_fd *sock);
 EXPORT uint8_t *os_fd_linux_skip_rawsocket_prefix(uint8_t *ptr, ssize_t *len, int af_type);
+EXPORT int os_fd_linux_recvfrom_batch(struct os_fd *sockfd,
+    struct os_fd_recv_slot *slots, int count);
 
 /**
  * Redirect to linux specific event wait call
@@ -367,6 +375,38 @@ os_fd_event_socket_read(struct os_fd_select *sel,
   return os_fd_linux_event_socket_modify(sel, sock);
 }
 
+/**
+ * Switch a socket in a socket event handler between level- and
+ * edge-triggered mode. An edge-triggered socket only reports new
+ * events, so its user has to read (and write) until the call
+ * fails with EAGAIN.
+ * @param sel socket event handler
+ * @param sock socket representation
+ * @param edge true if socket should be edge-triggered,
+ *   false for level-triggered
+ * @return -1 if an error happened, 0 otherwise
+ */
+static INLINE int
+os_fd_event_socket_edge_triggered(struct os_fd_select *sel,
+    struct os_fd *sock, bool edge) {
+  if (edge) {
+    sock->_flags |= OS_FD_EDGE_TRIGGERED;
+  }
+  else {
+    sock->_flags &= ~OS_FD_EDGE_TRIGGERED;
+  }
+  return os_fd_linux_event_socket_modify(sel, sock);
+}
+
+/**
+ * @param sock socket representation
+ * @return true if socket is edge-triggered, false otherwise
+ */
+static INLINE bool
+os_fd_event_is_edge_triggered(struct os_fd *sock) {
+  return (sock->_flags & OS_FD_EDGE_TRIGGERED) != 0;
+}
+
 /**
  * Check if a socket triggered a read event
  * @param sock socket representation
@@ -533,6 +573,27 @@ os_fd_recvfrom(struct os_fd *sockfd, void *buf, size_t length, union netaddr_soc
   }
 }
 
+/**
+ * Receive multiple datagrams from an UDP socket with a single call.
+ * @param sockfd filedescriptor of UDP socket
+ * @param slots array of buffers for incoming data
+ * @param count number of slots in the array
+ * @param interf limit received data to certain interface
+ *   (only used if socket cannot be bound to interface)
+ * @return number of filled slots, -1 if an error happened
+ */
+static INLINE int
+os_fd_recvfrom_batch(struct os_fd *sockfd, struct os_fd_recv_slot *slots,
+    int count, const struct os_interface *interf) {
+  if (count <= 1) {
+    /* no need for recvmmsg() overhead */
+    slots[0].received = os_fd_recvfrom(sockfd,
+        slots[0].buf, slots[0].length, &slots[0].source, interf);
+    return slots[0].received < 0 ? -1 : 1;
+  }
+  return os_fd_linux_recvfrom_batch(sockfd, slots, count);
+}
+
 /**
  * Binds a socket to a certain interface
  * @param sock filedescriptor of socket
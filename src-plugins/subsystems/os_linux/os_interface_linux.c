@@ -339,7 +339,8 @@ os_interface_linux_add(struct os_interface_listener *if_listener) {
 
   /* trigger interface change listener if necessary */
   if_listener->_dirty = true;
-  oonf_timer_start(&data->_change_timer, 200);
+  if_listener->changes = OS_INTERFACE_CHANGE_ALL;
+  oonf_timer_start(&data->_change_timer, OS_INTERFACE_CHANGE_TRIGGER_INTERVAL);
 
   return data;
 }
@@ -390,6 +391,7 @@ os_interface_linux_get_tree(void) {
 void
 os_interface_linux_trigger_handler(struct os_interface_listener *if_listener) {
   if_listener->_dirty = true;
+  if_listener->changes = OS_INTERFACE_CHANGE_ALL;
   if (!oonf_timer_is_active(&if_listener->data->_change_timer)) {
     oonf_timer_start(&if_listener->data->_change_timer,
         OS_INTERFACE_CHANGE_TRIGGER_INTERVAL);
@@ -932,21 +934,26 @@ _query_interface_addresses(void) {
 }
 
 /**
- * Trigger all change listeners of a network interface
+ * Trigger all change listeners of a network interface. All events
+ * until the change timer fires are merged into one listener update.
  * @param os_if network interface
+ * @param changes bitmask of os_interface_change types
  */
 static void
-_trigger_if_change(struct os_interface *os_if) {
+_trigger_if_change(struct os_interface *os_if, uint32_t changes) {
   struct os_interface_listener *if_listener;
 
+  os_if->_folded_events++;
+  list_for_each_element(&os_if->_listeners, if_listener, _node) {
+    /* each interface should be informed */
+    if_listener->_dirty = true;
+    if_listener->changes |= changes;
+    if_listener->folded_events++;
+  }
+
   if (!oonf_timer_is_active(&os_if->_change_timer)) {
     /* inform listeners the interface changed */
-    oonf_timer_start(&os_if->_change_timer, 200);
-
-    list_for_each_element(&os_if->_listeners, if_listener, _node) {
-      /* each interface should be informed */
-      if_listener->_dirty = true;
-    }
+    oonf_timer_start(&os_if->_change_timer, OS_INTERFACE_CHANGE_TRIGGER_INTERVAL);
   }
 }
 
@@ -954,15 +961,16 @@ _trigger_if_change(struct os_interface *os_if) {
  * Trigger all change listeners of a network interface.
  * Trigger also all change listeners of the wildcard interface "any"
  * @param os_if network interface
+ * @param changes bitmask of os_interface_change types
  */
 static void
-_trigger_if_change_including_any(struct os_interface *os_if) {
-  _trigger_if_change(os_if);
+_trigger_if_change_including_any(struct os_interface *os_if, uint32_t changes) {
+  _trigger_if_change(os_if, changes);
 
   os_if = avl_find_element(
       &_interface_data_tree, OS_INTERFACE_ANY, os_if, _node);
   if (os_if) {
-    _trigger_if_change(os_if);
+    _trigger_if_change(os_if, changes);
   }
 }
 
@@ -978,6 +986,10 @@ _link_parse_nlmsg(const char *ifname, struct nlmsghdr *msg) {
   int ifi_len;
   struct netaddr addr;
   struct os_interface *ifdata;
+  struct os_interface_flags old_flags;
+  unsigned old_index, old_base_index;
+  struct netaddr old_mac;
+  uint32_t changes;
   int iflink;
   bool old_up;
 #if defined(OONF_LOG_DEBUG_INFO)
@@ -993,6 +1005,11 @@ _link_parse_nlmsg(const char *ifname, struct nlmsghdr *msg) {
     return;
   }
 
+  memcpy(&old_flags, &ifdata->flags, sizeof(old_flags));
+  memcpy(&old_mac, &ifdata->mac, sizeof(old_mac));
+  old_index = ifdata->index;
+  old_base_index = ifdata->base_index;
+
   old_up = ifdata->flags.up;
   ifdata->flags.up = (ifi_msg->ifi_flags & IFF_UP) != 0;
   ifdata->flags.promisc = (ifi_msg->ifi_flags & IFF_PROMISC) != 0;
@@ -1038,12 +1055,30 @@ _link_parse_nlmsg(const char *ifname, struct nlmsghdr *msg) {
     }
   }
 
+  changes = 0;
+  if (memcmp(&old_flags, &ifdata->flags, sizeof(old_flags)) != 0
+      || msg->nlmsg_type == RTM_DELLINK) {
+    changes |= OS_INTERFACE_CHANGE_FLAGS;
+  }
+  if (old_index != ifdata->index || old_base_index != ifdata->base_index) {
+    changes |= OS_INTERFACE_CHANGE_INDEX;
+  }
+  if (netaddr_cmp(&old_mac, &ifdata->mac) != 0) {
+    changes |= OS_INTERFACE_CHANGE_MAC;
+  }
+
   if (!ifdata->_link_initialized) {
     ifdata->_link_initialized = true;
+    changes = OS_INTERFACE_CHANGE_ALL;
     OONF_INFO(LOG_OS_INTERFACE, "Interface %s link data initialized",
         ifdata->name);
   }
-  _trigger_if_change_including_any(ifdata);
+
+  if (!changes) {
+    OONF_DEBUG(LOG_OS_INTERFACE, "Link data of %s did not change", ifdata->name);
+    return;
+  }
+  _trigger_if_change_including_any(ifdata, changes);
 }
 
 /**
@@ -1109,23 +1144,27 @@ _update_address_shortcuts(struct os_interface *os_if) {
  * @param os_if network interface
  * @param prefixed_addr full IP address with prefix length
  * @param peer true if this is a peer address, false otherwise
+ * @return true if the address was not known before, false otherwise
  */
-static void
+static bool
 _add_address(struct os_interface *os_if, struct netaddr *prefixed_addr, bool peer) {
   struct os_interface_ip *ip;
   struct avl_tree *tree;
+  bool added;
 #if defined(OONF_LOG_INFO)
   struct netaddr_str nbuf;
 #endif
 
   tree = peer ? &os_if->peers : &os_if->addresses;
 
+  added = false;
   ip = avl_find_element(tree, prefixed_addr, ip, _node);
   if (!ip) {
     ip = oonf_class_malloc(&_interface_ip_class);
     if (!ip) {
-      return;
+      return false;
     }
+    added = true;
 
     /* establish key and add to tree */
     memcpy(&ip->prefixed_addr, prefixed_addr, sizeof(*prefixed_addr));
@@ -1144,6 +1183,7 @@ _add_address(struct os_interface *os_if, struct netaddr *prefixed_addr, bool pee
   memcpy(&ip->address, prefixed_addr, sizeof(*prefixed_addr));
   netaddr_set_prefix_length(&ip->address, netaddr_get_maxprefix(&ip->address));
   netaddr_truncate(&ip->prefix, prefixed_addr);
+  return added;
 }
 
 /**
@@ -1151,8 +1191,9 @@ _add_address(struct os_interface *os_if, struct netaddr *prefixed_addr, bool pee
  * @param os_if network interface
  * @param prefixed_addr full IP address with prefix length
  * @param peer true if this is a peer address, false otherwise
+ * @return true if the address was removed, false if it was not known
  */
-static void
+static bool
 _remove_address(struct os_interface *os_if, struct netaddr *prefixed_addr, bool peer) {
   struct os_interface_ip *ip;
   struct avl_tree *tree;
@@ -1163,7 +1204,7 @@ _remove_address(struct os_interface *os_if, struct netaddr *prefixed_addr, bool
   tree = peer ? &os_if->peers : &os_if->addresses;
   ip = avl_find_element(tree, prefixed_addr, ip, _node);
   if (!ip) {
-    return;
+    return false;
   }
 
   OONF_INFO(LOG_OS_INTERFACE, "Remove address from %s%s: %s",
@@ -1172,6 +1213,7 @@ _remove_address(struct os_interface *os_if, struct netaddr *prefixed_addr, bool
 
   avl_remove(tree, &ip->_node);
   oonf_class_free(&_interface_ip_class, ip);
+  return true;
 }
 
 /**
@@ -1186,7 +1228,7 @@ _address_parse_nlmsg(const char *ifname, struct nlmsghdr *msg) {
   int ifa_len;
   struct os_interface *ifdata;
   struct netaddr ifa_local, ifa_address;
-  bool update;
+  bool update, changed;
 
   ifa_msg = NLMSG_DATA(msg);
   ifa_attr = IFA_RTA(ifa_msg);
@@ -1201,6 +1243,7 @@ _address_parse_nlmsg(const char *ifname, struct nlmsghdr *msg) {
       ifname, ifa_msg->ifa_index, ifa_len);
 
   update = false;
+  changed = false;
   netaddr_invalidate(&ifa_local);
   netaddr_invalidate(&ifa_address);
 
@@ -1230,10 +1273,10 @@ _address_parse_nlmsg(const char *ifname, struct nlmsghdr *msg) {
 
   if (!netaddr_is_unspec(&ifa_local)) {
     if (msg->nlmsg_type == RTM_NEWADDR) {
-      _add_address(ifdata, &ifa_local, false);
+      changed |= _add_address(ifdata, &ifa_local, false);
     }
     else {
-      _remove_address(ifdata, &ifa_local, false);
+      changed |= _remove_address(ifdata, &ifa_local, false);
     }
 
     _update_address_shortcuts(ifdata);
@@ -1242,10 +1285,10 @@ _address_parse_nlmsg(const char *ifname, struct nlmsghdr *msg) {
 
   if (netaddr_cmp(&ifa_local, &ifa_address)) {
     if (msg->nlmsg_type == RTM_NEWADDR) {
-      _add_address(ifdata, &ifa_address, true);
+      changed |= _add_address(ifdata, &ifa_address, true);
     }
     else {
-      _remove_address(ifdata, &ifa_address, true);
+      changed |= _remove_address(ifdata, &ifa_address, true);
     }
 
     update = true;
@@ -1254,10 +1297,13 @@ _address_parse_nlmsg(const char *ifname, struct nlmsghdr *msg) {
   if (update) {
     if (!ifdata->_addr_initialized) {
       ifdata->_addr_initialized = true;
+      changed = true;
       OONF_INFO(LOG_OS_INTERFACE, "Interface %s address data initialized",
           ifdata->name);
     }
-    _trigger_if_change_including_any(ifdata);
+    if (changed) {
+      _trigger_if_change_including_any(ifdata, OS_INTERFACE_CHANGE_ADDRESS);
+    }
   }
 }
 
@@ -1455,8 +1501,9 @@ _cb_delayed_interface_changed(struct oonf_timer_instance *timer) {
     return;
   }
 
-  OONF_INFO(LOG_OS_INTERFACE, "Interface %s (%u) changed",
-      data->name, data->index);
+  OONF_INFO(LOG_OS_INTERFACE, "Interface %s (%u) changed (%u events folded)",
+      data->name, data->index, data->_folded_events);
+  data->_folded_events = 0;
 
   error = false;
   list_for_each_element_safe(&data->_listeners, interf, _node, interf_it) {
@@ -1464,6 +1511,9 @@ _cb_delayed_interface_changed(struct oonf_timer_instance *timer) {
       continue;
     }
 
+    OONF_DEBUG(LOG_OS_INTERFACE, "Inform listener of %s about changes 0x%x (%u events folded)",
+        data->name, interf->changes, interf->folded_events);
+
     if (interf->if_changed && interf->if_changed(interf)) {
       /* interface change handler had a problem and wants to re-trigger */
       error = true;
@@ -1471,6 +1521,8 @@ _cb_delayed_interface_changed(struct oonf_timer_instance *timer) {
     else {
       /* everything fine, job done */
       interf->_dirty = false;
+      interf->changes = 0;
+      interf->folded_events = 0;
     }
   }
 
@@ -54,7 +54,9 @@
 #include "common/common_types.h"
 #include "common/avl.h"
 #include "common/avl_comp.h"
+#include "config/cfg_schema.h"
 #include "core/oonf_subsystem.h"
+#include "subsystems/os_clock.h"
 #include "subsystems/os_system.h"
 
 #include "subsystems/os_routing.h"
@@ -74,6 +76,14 @@ struct route_type_translation {
   uint8_t os_linux;
 };
 
+/**
+ * Configuration of linux routing subsystem
+ */
+struct _routing_config {
+  /*! maximum number of netlink buffers in transit to the kernel */
+  int32_t netlink_window;
+};
+
 /* prototypes */
 static int _init(void);
 static void _cleanup(void);
@@ -87,9 +97,29 @@ static void _cb_rtnetlink_event_message(struct nlmsghdr *);
 static void _cb_rtnetlink_error(uint32_t seq, int err);
 static void _cb_rtnetlink_done(uint32_t seq);
 static void _cb_rtnetlink_timeout(void);
+static void _batch_finished(uint32_t count);
+
+static void _cb_cfg_changed(void);
+
+/* configuration options */
+static struct cfg_schema_entry _routing_entries[] = {
+  CFG_MAP_INT32_MINMAX(_routing_config, netlink_window, "netlink_window",
+      OS_SYSTEM_NETLINK_WINDOW_TXT,
+      "Maximum number of netlink buffers (one memory page each) in transit"
+      " to the kernel", 0, false, 1, OS_SYSTEM_NETLINK_MAX_WINDOW),
+};
+
+static struct cfg_schema_section _routing_section = {
+  .type = OONF_OS_ROUTING_SUBSYSTEM,
+  .mode = CFG_SSMODE_UNNAMED,
+  .cb_delta_handler = _cb_cfg_changed,
+  .entries = _routing_entries,
+  .entry_count = ARRAYSIZE(_routing_entries),
+};
 
 /* subsystem definition */
 static const char *_dependencies[] = {
+  OONF_OS_CLOCK_SUBSYSTEM,
   OONF_OS_SYSTEM_SUBSYSTEM,
 };
 
@@ -99,6 +129,7 @@ static struct oonf_subsystem _oonf_os_routing_subsystem = {
   .dependencies_count = ARRAYSIZE(_dependencies),
   .init = _init,
   .cleanup = _cleanup,
+  .cfg_section = &_routing_section,
 };
 DECLARE_OONF_PLUGIN(_oonf_os_routing_subsystem);
 
@@ -157,6 +188,18 @@ static const struct os_route_parameter OS_ROUTE_WILDCARD = {
 /* kernel version check */
 static bool _is_kernel_3_11_0_or_better;
 
+/* statistics of routing commands */
+static struct os_route_statistics _statistics;
+
+/* number of routing commands of the current batch in transit */
+static uint32_t _batch_pending;
+
+/* number of routing commands of current batch */
+static uint32_t _batch_count;
+
+/* timestamp when the current batch was started */
+static uint64_t _batch_start;
+
 /**
  * Initialize routing subsystem
  * @return -1 if an error happened, 0 otherwise
@@ -287,8 +330,18 @@ os_routing_linux_set(struct os_route *route, bool set, bool del_similar) {
   /* cannot fail */
   seq = os_system_linux_netlink_send(&_rtnetlink_socket, msg);
 
+  if (_batch_pending == 0) {
+    /* start a new batch of routing commands */
+    os_clock_gettime64(&_batch_start);
+    _batch_count = 0;
+  }
+  _batch_pending++;
+  _batch_count++;
+  _statistics.sent++;
+
   if (route->cb_finished) {
     route->_internal.nl_seq = seq;
+    route->_internal.dump = false;
     route->_internal._node.key = &route->_internal.nl_seq;
 
     assert (!avl_is_node_added(&route->_internal._node));
@@ -330,6 +383,7 @@ os_routing_linux_query(struct os_route *route) {
   }
 
   route->_internal.nl_seq = seq;
+  route->_internal.dump = true;
   route->_internal._node.key = &route->_internal.nl_seq;
   avl_insert(&_rtnetlink_feedback, &route->_internal._node);
   return 0;
@@ -385,6 +439,14 @@ os_routing_linux_init_wildcard_route(struct os_route *route) {
   memcpy(&route->p, &OS_ROUTE_WILDCARD, sizeof(route->p));
 }
 
+/**
+ * @return statistics about the routing commands sent to the kernel
+ */
+const struct os_route_statistics *
+os_routing_linux_get_statistics(void) {
+  return &_statistics;
+}
+
 /**
  * Stop processing of a routing command and set error code
  * for callback
@@ -711,6 +773,12 @@ _cb_rtnetlink_error(uint32_t seq, int err) {
 #endif
 
   route = avl_find_element(&_rtnetlink_feedback, &seq, route, _internal._node);
+  if (route == NULL || !route->_internal.dump) {
+    /* only route changes are part of a batch */
+    _statistics.failed++;
+    _batch_finished(1);
+  }
+
   if (route) {
     OONF_DEBUG(LOG_OS_ROUTING, "Route seqno %u failed: %s (%d) %s",
         seq, strerror(err), err,
@@ -733,6 +801,10 @@ _cb_rtnetlink_timeout(void) {
 
   OONF_WARN(LOG_OS_ROUTING, "Netlink timeout for routing");
 
+  /* all routing commands in transit are lost */
+  _statistics.failed += _batch_pending;
+  _batch_pending = 0;
+
   avl_for_each_element_safe(&_rtnetlink_feedback, route, _internal._node, rt_it) {
     _routing_finished(route, -1);
   }
@@ -752,9 +824,65 @@ _cb_rtnetlink_done(uint32_t seq) {
   OONF_DEBUG(LOG_OS_ROUTING, "Got done: %u", seq);
 
   route = avl_find_element(&_rtnetlink_feedback, &seq, route, _internal._node);
+  if (route == NULL || !route->_internal.dump) {
+    /* only route changes are part of a batch */
+    _batch_finished(1);
+  }
+
   if (route) {
     OONF_DEBUG(LOG_OS_ROUTING, "Route %s with seqno %u done",
         os_routing_to_string(&rbuf, &route->p), seq);
     _routing_finished(route, 0);
   }
 }
+
+/**
+ * Account routing commands finished by the kernel and update
+ * the throughput statistics if the current batch is complete
+ * @param count number of finished routing commands
+ */
+static void
+_batch_finished(uint32_t count) {
+  uint64_t now;
+
+  if (_batch_pending == 0) {
+    /* command of a batch lost by timeout */
+    return;
+  }
+
+  _batch_pending = count > _batch_pending ? 0 : _batch_pending - count;
+  if (_batch_pending > 0) {
+    return;
+  }
+
+  os_clock_gettime64(&now);
+
+  _statistics.last_batch = _batch_count;
+  _statistics.last_batch_time = now - _batch_start;
+  _statistics.total_batched += _batch_count;
+  _statistics.total_batch_time += now - _batch_start;
+
+  OONF_INFO(LOG_OS_ROUTING, "Kernel processed %u routing commands in %"PRIu64" ms",
+      _statistics.last_batch, _statistics.last_batch_time);
+}
+
+/**
+ * Configuration of linux routing subsystem changed
+ */
+static void
+_cb_cfg_changed(void) {
+  struct _routing_config config;
+  int result;
+
+  memset(&config, 0, sizeof(config));
+  result = cfg_schema_tobin(&config, _routing_section.post,
+      _routing_entries, ARRAYSIZE(_routing_entries));
+  if (result) {
+    OONF_WARN(LOG_OS_ROUTING,
+        "Could not convert "OONF_OS_ROUTING_SUBSYSTEM" to binary (%d)",
+        -(result+1));
+    return;
+  }
+
+  os_system_linux_netlink_set_window(&_rtnetlink_socket, config.netlink_window);
+}
@@ -62,6 +62,9 @@ struct os_route_internal {
 
   /*! netlink sequence number of command sent to the kernel */
   uint32_t nl_seq;
+
+  /*! true if the command is a dump request instead of a route change */
+  bool dump;
 };
 
 /**
@@ -86,6 +89,8 @@ EXPORT const char *os_routing_linux_to_string(
 
 EXPORT void os_routing_linux_init_wildcard_route(struct os_route *);
 
+EXPORT const struct os_route_statistics *os_routing_linux_get_statistics(void);
+
 /**
  * Check if kernel supports source-specific routing
  * @param af_family address family
@@ -169,6 +174,14 @@ os_routing_init_wildcard_route(struct os_route *route) {
   return os_routing_linux_init_wildcard_route(route);
 }
 
+/**
+ * @return statistics about the routing commands sent to the kernel
+ */
+static INLINE const struct os_route_statistics *
+os_routing_get_statistics(void) {
+  return os_routing_linux_get_statistics();
+}
+
 /**
  * Print OS route to string buffer
  * @param buf pointer to string buffer
@@ -88,6 +88,10 @@ static void _netlink_handler(struct oonf_socket_entry *entry);
 static void _enqueue_netlink_buffer(struct os_system_netlink *nl);
 static void _handle_nl_err(struct os_system_netlink *, struct nlmsghdr *);
 static void _flush_netlink_buffer(struct os_system_netlink *nl);
+static void _netlink_job_finished(struct os_system_netlink *nl, uint32_t seq);
+static void _free_netlink_buffers(struct list_entity *list);
+static uint32_t _get_window(struct os_system_netlink *nl);
+static void _update_max_datagram(struct os_system_netlink *nl);
 
 /* static buffers for receiving/sending a netlink message */
 static struct sockaddr_nl _netlink_nladdr = {
@@ -110,10 +114,8 @@ static struct nlmsghdr _netlink_hdr_done = {
   .nlmsg_type = NLMSG_DONE
 };
 
-static struct iovec _netlink_send_iov[] = {
-    { NULL, 0 },
-    { &_netlink_hdr_done, sizeof(_netlink_hdr_done) },
-};
+/* one iovec for each buffer of the window plus the final done header */
+static struct iovec _netlink_send_iov[OS_SYSTEM_NETLINK_MAX_WINDOW + 1];
 
 static struct msghdr _netlink_send_msg = {
   &_netlink_nladdr,
@@ -277,7 +279,7 @@ os_system_linux_linux_get_ioctl_fd(int af_type) {
 int
 os_system_linux_netlink_add(struct os_system_netlink *nl, int protocol) {
   struct sockaddr_nl addr;
-  int recvbuf;
+  int recvbuf, sendbuf;
   int fd;
 
   fd = socket(PF_NETLINK, SOCK_RAW, protocol);
@@ -320,6 +322,16 @@ os_system_linux_netlink_add(struct os_system_netlink *nl, int protocol) {
         " netlink socket '%s': %s (%d)\n", nl->name, strerror(errno), errno);
   }
 #endif
+#if defined(SO_SNDBUF)
+  /* allow sending a full window of buffers with a single call */
+  sendbuf = 2 * OS_SYSTEM_NETLINK_MAX_WINDOW * getpagesize();
+  if (setsockopt(nl->socket.fd.fd, SOL_SOCKET, SO_SNDBUF,
+      &sendbuf, sizeof(sendbuf))) {
+    OONF_WARN(nl->used_by->logging, "Cannot setup send buffer size for"
+        " netlink socket '%s': %s (%d)\n", nl->name, strerror(errno), errno);
+  }
+#endif
+  _update_max_datagram(nl);
 
   if (bind(nl->socket.fd.fd, (struct sockaddr *)&addr, sizeof(addr))<0) {
     OONF_WARN(nl->used_by->logging, "Could not bind netlink socket %s: %s (%d)",
@@ -329,12 +341,16 @@ os_system_linux_netlink_add(struct os_system_netlink *nl, int protocol) {
 
   nl->socket.name = "os_system_netlink";
   nl->socket.process = _netlink_handler;
+  nl->socket.drain = true;
   oonf_socket_add(&nl->socket);
   oonf_socket_set_read(&nl->socket, true);
 
   nl->timeout.class = &_netlink_timer;
 
   list_init_head(&nl->buffered);
+  list_init_head(&nl->in_transit);
+  nl->buffers_in_transit = 0;
+  nl->msg_in_transit = 0;
   return 0;
 
 os_add_netlink_fail:
@@ -352,8 +368,12 @@ os_add_netlink_fail:
  */
 void
 os_system_linux_netlink_remove(struct os_system_netlink *nl) {
+  oonf_timer_stop(&nl->timeout);
   oonf_socket_remove(&nl->socket);
 
+  _free_netlink_buffers(&nl->buffered);
+  _free_netlink_buffers(&nl->in_transit);
+
   os_fd_close(&nl->socket.fd);
   free (nl->in);
   abuf_free(&nl->out);
@@ -390,6 +410,8 @@ _enqueue_netlink_buffer(struct os_system_netlink *nl) {
 int
 os_system_linux_netlink_send(struct os_system_netlink *nl,
     struct nlmsghdr *nl_hdr) {
+  struct os_system_netlink_buffer *buffer;
+
   _seq_used = (_seq_used + 1) & INT32_MAX;
   OONF_DEBUG(nl->used_by->logging, "Prepare to send netlink '%s' message %u (%u bytes)",
       nl->name, _seq_used, nl_hdr->nlmsg_len);
@@ -400,6 +422,14 @@ os_system_linux_netlink_send(struct os_system_netlink *nl,
   if (nl_hdr->nlmsg_len + abuf_getlen(&nl->out) > (size_t)getpagesize()) {
     _enqueue_netlink_buffer(nl);
   }
+
+  /* remember sequence numbers in buffer for the kernel feedback */
+  buffer = (struct os_system_netlink_buffer *)abuf_getptr(&nl->out);
+  if (nl->out_messages == 0) {
+    buffer->first_seq = _seq_used;
+  }
+  buffer->last_seq = _seq_used;
+
   abuf_memcpy(&nl->out, nl_hdr, nl_hdr->nlmsg_len);
 
   OONF_DEBUG_HEX(nl->used_by->logging, nl_hdr, nl_hdr->nlmsg_len,
@@ -412,6 +442,21 @@ os_system_linux_netlink_send(struct os_system_netlink *nl,
   return _seq_used;
 }
 
+/**
+ * Set the maximum number of buffers in transit to the kernel
+ * @param nl pointer to netlink handler
+ * @param window number of buffers, 0 for default value
+ */
+void
+os_system_linux_netlink_set_window(struct os_system_netlink *nl, uint32_t window) {
+  nl->window = window;
+
+  if (!list_is_empty(&nl->buffered)
+      && nl->buffers_in_transit < _get_window(nl)) {
+    oonf_socket_set_write(&nl->socket, true);
+  }
+}
+
 /**
  * Join a list of multicast groups for a netlink socket
  * @param nl pointer to netlink handler
@@ -510,20 +555,36 @@ _cb_handle_netlink_timeout(struct oonf_timer_instance *ptr) {
   if (nl->cb_timeout) {
     nl->cb_timeout();
   }
+
+  /* the kernel will not answer these anymore */
+  _free_netlink_buffers(&nl->in_transit);
+  nl->buffers_in_transit = 0;
   nl->msg_in_transit = 0;
+  nl->stats.timeouts++;
+
+  if (!list_is_empty(&nl->buffered) || nl->out_messages > 0) {
+    oonf_socket_set_write(&nl->socket, true);
+  }
 }
 
 /**
- * Send all netlink messages in the outgoing queue to the kernel
+ * Send netlink messages in the outgoing queue to the kernel,
+ * as many buffers as the window allows with a single call
  * @param nl pointer to netlink handler
  */
 static void
 _flush_netlink_buffer(struct os_system_netlink *nl) {
-  struct os_system_netlink_buffer *buffer;
+  struct os_system_netlink_buffer *buffer, *buf_it;
+  struct nlmsghdr *nh;
+  size_t count, len, i;
+  uint32_t window;
   ssize_t ret;
   int err;
 
-  if (nl->msg_in_transit > 0) {
+  window = _get_window(nl);
+  if (nl->buffers_in_transit >= window) {
+    /* wait for the kernel to answer */
+    oonf_socket_set_write(&nl->socket, false);
     return;
   }
 
@@ -536,69 +597,223 @@ _flush_netlink_buffer(struct os_system_netlink *nl) {
       return;
     }
   }
+  else if (nl->buffers_in_transit + 1 < window
+      && abuf_getlen(&nl->out) > sizeof(struct os_system_netlink_buffer)) {
+    /* there is space in the window for the partial buffer too */
+    _enqueue_netlink_buffer(nl);
+  }
+
+  /* collect buffers for outgoing message, the first one is always sent */
+  count = 0;
+  len = sizeof(_netlink_hdr_done);
+  list_for_each_element(&nl->buffered, buffer, _node) {
+    if (nl->buffers_in_transit + count >= window
+        || (count > 0 && nl->max_datagram > 0
+            && len + buffer->total > nl->max_datagram)) {
+      break;
+    }
+    _netlink_send_iov[count].iov_base = (char *)(buffer) + sizeof(*buffer);
+    _netlink_send_iov[count].iov_len = buffer->total;
+    len += buffer->total;
+    count++;
+  }
 
-  /* get first buffer */
-  buffer = list_first_element(&nl->buffered, buffer, _node);
+  while (true) {
+    _netlink_send_iov[count].iov_base = &_netlink_hdr_done;
+    _netlink_send_iov[count].iov_len = sizeof(_netlink_hdr_done);
+    _netlink_send_msg.msg_iovlen = count + 1;
 
-  /* send outgoing message */
-  _netlink_send_iov[0].iov_base = (char *)(buffer) + sizeof(*buffer);
-  _netlink_send_iov[0].iov_len = buffer->total;
+    nl->stats.sendmsg_calls++;
 
-  if ((ret = sendmsg(os_fd_get_fd(&nl->socket.fd),
-        &_netlink_send_msg, MSG_DONTWAIT)) <= 0) {
+    /* send outgoing message */
+    ret = sendmsg(os_fd_get_fd(&nl->socket.fd), &_netlink_send_msg, MSG_DONTWAIT);
     err = errno;
+    if (ret > 0 || err != EMSGSIZE || count == 1) {
+      break;
+    }
+
+    /* kernel did not accept the datagram, send the first half of the buffers */
+    count = (count + 1) / 2;
+
+    nl->max_datagram = sizeof(_netlink_hdr_done);
+    for (i = 0; i < count; i++) {
+      nl->max_datagram += _netlink_send_iov[i].iov_len;
+    }
+    nl->stats.split_batches++;
+
+    OONF_INFO(nl->used_by->logging, "netlink %s: datagram too large,"
+        " limit datagrams to %"PRINTF_SIZE_T_SPECIFIER" bytes",
+        nl->name, nl->max_datagram);
+  }
+
+  if (ret <= 0) {
 #if EAGAIN == EWOULDBLOCK
     if (err != EAGAIN) {
 #else
     if (err != EAGAIN && err != EWOULDBLOCK) {
 #endif
       OONF_WARN(nl->used_by->logging,
-          "Cannot send data (%"PRINTF_SIZE_T_SPECIFIER" bytes)"
+          "Cannot send data (%"PRINTF_SIZE_T_SPECIFIER" buffers)"
           " to netlink socket %s: %s (%d)",
-          abuf_getlen(&nl->out), nl->name, strerror(err), err);
+          count, nl->name, strerror(err), err);
 
-      /* remove netlink message from internal queue */
-      nl->cb_error(nl->in->nlmsg_seq, err);
-      return;
+      /* remove netlink messages from internal queue */
+      list_for_each_element_safe(&nl->buffered, buffer, _node, buf_it) {
+        if (count == 0) {
+          break;
+        }
+        count--;
+
+        list_remove(&buffer->_node);
+
+        len = buffer->total;
+        for (nh = (struct nlmsghdr *)((char *)(buffer) + sizeof(*buffer));
+            NLMSG_OK(nh, len); nh = NLMSG_NEXT(nh, len)) {
+          nl->stats.send_errors++;
+          if (nl->cb_error) {
+            nl->cb_error(nh->nlmsg_seq, err);
+          }
+        }
+        free(buffer);
+      }
     }
   }
   else {
-    nl->msg_in_transit += buffer->messages;
+    /* move buffers to the list of buffers in transit */
+    list_for_each_element_safe(&nl->buffered, buffer, _node, buf_it) {
+      if (count == 0) {
+        break;
+      }
+      count--;
 
-    OONF_DEBUG(nl->used_by->logging,
-        "netlink %s: Sent %u bytes (%u messages in transit)",
-        nl->name, buffer->total, nl->msg_in_transit);
+      list_remove(&buffer->_node);
+      list_add_tail(&nl->in_transit, &buffer->_node);
 
-    list_remove(&buffer->_node);
-    free(buffer);
+      buffer->finished = 0;
+      nl->buffers_in_transit++;
+      nl->msg_in_transit += buffer->messages;
+
+      nl->stats.buffers_sent++;
+      nl->stats.messages_sent += buffer->messages;
+    }
+
+    if (nl->buffers_in_transit > nl->stats.max_in_transit) {
+      nl->stats.max_in_transit = nl->buffers_in_transit;
+    }
+
+    OONF_DEBUG(nl->used_by->logging,
+        "netlink %s: Sent %"PRINTF_SSIZE_T_SPECIFIER" bytes"
+        " (%u buffers, %d messages in transit)",
+        nl->name, ret, nl->buffers_in_transit, nl->msg_in_transit);
   }
 
-  oonf_socket_set_write(&nl->socket, !list_is_empty(&nl->buffered));
+  oonf_socket_set_write(&nl->socket, !list_is_empty(&nl->buffered)
+      && nl->buffers_in_transit < window);
 
   /* start feedback timer */
-  oonf_timer_set(&nl->timeout, OS_SYSTEM_NETLINK_TIMEOUT);
+  if (nl->msg_in_transit > 0) {
+    oonf_timer_set(&nl->timeout, OS_SYSTEM_NETLINK_TIMEOUT);
+  }
 }
 
 /**
- * Cleanup netlink handler because all outstanding jobs
- * are finished
+ * Mark a netlink message as processed by the kernel and release
+ * its buffer if all messages of the buffer have been processed
  * @param nl pointer to os_system_netlink handler
+ * @param seq sequence number of processed message
  */
 static void
-_netlink_job_finished(struct os_system_netlink *nl) {
-  if (nl->msg_in_transit > 0) {
-    nl->msg_in_transit--;
+_netlink_job_finished(struct os_system_netlink *nl, uint32_t seq) {
+  struct os_system_netlink_buffer *buffer;
+  bool found;
+
+  list_for_each_element(&nl->in_transit, buffer, _node) {
+    if (buffer->first_seq <= buffer->last_seq) {
+      found = seq >= buffer->first_seq && seq <= buffer->last_seq;
+    }
+    else {
+      /* sequence number wrapped around inside the buffer */
+      found = seq >= buffer->first_seq || seq <= buffer->last_seq;
+    }
+
+    if (found) {
+      nl->stats.messages_finished++;
+      if (nl->msg_in_transit > 0) {
+        nl->msg_in_transit--;
+      }
+
+      buffer->finished++;
+      if (buffer->finished >= buffer->messages) {
+        list_remove(&buffer->_node);
+        free(buffer);
+        nl->buffers_in_transit--;
+      }
+      break;
+    }
   }
+
   if (nl->msg_in_transit == 0) {
     oonf_timer_stop(&nl->timeout);
+  }
 
-    if (!list_is_empty(&nl->buffered)
-        || nl->out_messages > 0) {
-      oonf_socket_set_write(&nl->socket, true);
-    }
+  if ((!list_is_empty(&nl->buffered) || nl->out_messages > 0)
+      && nl->buffers_in_transit < _get_window(nl)) {
+    oonf_socket_set_write(&nl->socket, true);
   }
-  OONF_DEBUG(nl->used_by->logging, "netlink '%s' finished: %d still in transit",
-      nl->name, nl->msg_in_transit);
+  OONF_DEBUG(nl->used_by->logging, "netlink '%s' finished seq %u: %d still in transit",
+      nl->name, seq, nl->msg_in_transit);
+}
+
+/**
+ * Free all netlink buffers of a list
+ * @param list pointer to list of buffers
+ */
+static void
+_free_netlink_buffers(struct list_entity *list) {
+  struct os_system_netlink_buffer *buffer, *buf_it;
+
+  list_for_each_element_safe(list, buffer, _node, buf_it) {
+    list_remove(&buffer->_node);
+    free(buffer);
+  }
+}
+
+/**
+ * @param nl pointer to netlink handler
+ * @return maximum number of buffers in transit for the handler
+ */
+static uint32_t
+_get_window(struct os_system_netlink *nl) {
+  if (nl->window == 0) {
+    return OS_SYSTEM_NETLINK_WINDOW;
+  }
+  if (nl->window > OS_SYSTEM_NETLINK_MAX_WINDOW) {
+    return OS_SYSTEM_NETLINK_MAX_WINDOW;
+  }
+  return nl->window;
+}
+
+/**
+ * Read the effective send buffer size of a netlink socket. The kernel
+ * silently caps the requested size, datagrams larger than the result
+ * would be rejected.
+ * @param nl pointer to netlink handler
+ */
+static void
+_update_max_datagram(struct os_system_netlink *nl) {
+#if defined(SO_SNDBUF)
+  socklen_t len;
+  int sendbuf;
+
+  len = sizeof(sendbuf);
+  if (getsockopt(os_fd_get_fd(&nl->socket.fd), SOL_SOCKET, SO_SNDBUF,
+      &sendbuf, &len) == 0 && sendbuf > 0) {
+    /* the kernel reports twice the usable size for its bookkeeping */
+    nl->max_datagram = (size_t)sendbuf / 2;
+    return;
+  }
+#endif
+  nl->max_datagram = 0;
 }
 
 /**
@@ -624,9 +839,11 @@ _netlink_handler(struct oonf_socket_entry *entry) {
     return;
   }
 
+netlink_rcv_next:
   /* handle incoming messages */
   _netlink_rcv_msg.msg_flags = 0;
   flags = MSG_PEEK;
+  current_seq = 0;
 
 netlink_rcv_retry:
   _netlink_rcv_iov.iov_base = nl->in;
@@ -694,11 +911,15 @@ netlink_rcv_retry:
       current_seq = nh->nlmsg_seq;
     }
 
-    if (current_seq != nh->nlmsg_seq && trigger_is_done) {
-      if (nl->cb_done) {
-        nl->cb_done(current_seq);
+    if (current_seq != nh->nlmsg_seq) {
+      if (trigger_is_done) {
+        if (nl->cb_done) {
+          nl->cb_done(current_seq);
+        }
+        _netlink_job_finished(nl, current_seq);
+        trigger_is_done = false;
       }
-      trigger_is_done = false;
+      current_seq = nh->nlmsg_seq;
     }
 
     switch (nh->nlmsg_type) {
@@ -725,17 +946,22 @@ netlink_rcv_retry:
   }
 
   if (trigger_is_done) {
-    oonf_timer_stop(&nl->timeout);
     if (nl->cb_done) {
       nl->cb_done(current_seq);
     }
-    _netlink_job_finished(nl);
+    _netlink_job_finished(nl, current_seq);
   }
 
   /* reset timeout if necessary */
   if (oonf_timer_is_active(&nl->timeout)) {
     oonf_timer_set(&nl->timeout, OS_SYSTEM_NETLINK_TIMEOUT);
   }
+
+  if (oonf_socket_is_edge_triggered(entry)
+      && list_is_node_added(&entry->_node)) {
+    /* edge-triggered socket, read until recvmsg() reports EAGAIN */
+    goto netlink_rcv_next;
+  }
 }
 
 /**
@@ -764,5 +990,5 @@ _handle_nl_err(struct os_system_netlink *nl, struct nlmsghdr *nh) {
     }
   }
 
-  _netlink_job_finished(nl);
+  _netlink_job_finished(nl, err->msg.nlmsg_seq);
 }
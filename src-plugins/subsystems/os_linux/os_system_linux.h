@@ -57,6 +57,15 @@
 /*! default timeout for netlink messages */
 #define OS_SYSTEM_NETLINK_TIMEOUT 1000
 
+/*! default number of netlink buffers in transit to the kernel */
+#define OS_SYSTEM_NETLINK_WINDOW 8
+
+/*! text representation of OS_SYSTEM_NETLINK_WINDOW */
+#define OS_SYSTEM_NETLINK_WINDOW_TXT "8"
+
+/*! maximum number of netlink buffers in transit to the kernel */
+#define OS_SYSTEM_NETLINK_MAX_WINDOW 32
+
 /**
  * A buffer for transmitting netlink commands to the operation system
  */
@@ -69,6 +78,44 @@ struct os_system_netlink_buffer {
 
   /*! total number of messages in buffer */
   uint32_t messages;
+
+  /*! number of messages already answered by the kernel */
+  uint32_t finished;
+
+  /*! sequence number of first message in buffer */
+  uint32_t first_seq;
+
+  /*! sequence number of last message in buffer */
+  uint32_t last_seq;
+};
+
+/**
+ * Statistics of a netlink handler
+ */
+struct os_system_netlink_statistics {
+  /*! number of messages sent to the kernel */
+  uint32_t messages_sent;
+
+  /*! number of messages answered by the kernel */
+  uint32_t messages_finished;
+
+  /*! number of buffers sent to the kernel */
+  uint32_t buffers_sent;
+
+  /*! number of sendmsg calls */
+  uint32_t sendmsg_calls;
+
+  /*! number of messages that could not be sent */
+  uint32_t send_errors;
+
+  /*! number of timeouts while waiting for the kernel */
+  uint32_t timeouts;
+
+  /*! maximum number of buffers in transit */
+  uint32_t max_in_transit;
+
+  /*! number of sendmsg calls split because the datagram was too large */
+  uint32_t split_batches;
 };
 
 /**
@@ -90,6 +137,24 @@ struct os_system_netlink {
   /*! link of data buffers to transmit */
   struct list_entity buffered;
 
+  /*! list of data buffers sent to the kernel and not answered yet */
+  struct list_entity in_transit;
+
+  /*! number of buffers in transit to the kernel */
+  uint32_t buffers_in_transit;
+
+  /**
+   * maximum number of buffers in transit to the kernel,
+   * 0 for OS_SYSTEM_NETLINK_WINDOW
+   */
+  uint32_t window;
+
+  /**
+   * maximum number of bytes sent to the kernel with a single
+   * call, 0 if unknown
+   */
+  size_t max_datagram;
+
   /*! subsystem that uses this netlink handler */
   struct oonf_subsystem *used_by;
 
@@ -128,6 +193,9 @@ struct os_system_netlink {
 
   /*! netlink timeout handler */
   struct oonf_timer_instance timeout;
+
+  /*! statistics of netlink handler */
+  struct os_system_netlink_statistics stats;
 };
 
 EXPORT bool os_system_linux_is_ipv6_supported(void);
@@ -138,6 +206,8 @@ EXPORT int os_system_linux_netlink_add(struct os_system_netlink *,
 EXPORT void os_system_linux_netlink_remove(struct os_system_netlink *);
 EXPORT int os_system_linux_netlink_send(struct os_system_netlink *fd,
     struct nlmsghdr *nl_hdr);
+EXPORT void os_system_linux_netlink_set_window(
+    struct os_system_netlink *nl, uint32_t window);
 EXPORT int os_system_linux_netlink_add_mc(struct os_system_netlink *,
     const uint32_t *groups, size_t groupcount);
 EXPORT int os_system_linux_netlink_drop_mc(struct os_system_netlink *,
@@ -154,6 +154,29 @@ struct os_route_parameter {
   unsigned int if_index;
 };
 
+/**
+ * Statistics about the routing commands sent to the kernel
+ */
+struct os_route_statistics {
+  /*! number of route changes sent to the kernel */
+  uint32_t sent;
+
+  /*! number of route changes rejected by the kernel */
+  uint32_t failed;
+
+  /*! number of routing commands of the last finished batch */
+  uint32_t last_batch;
+
+  /*! time in milliseconds the kernel needed for the last batch */
+  uint64_t last_batch_time;
+
+  /*! number of routing commands of all finished batches */
+  uint64_t total_batched;
+
+  /*! time in milliseconds the kernel needed for all finished batches */
+  uint64_t total_batch_time;
+};
+
 /* include os-specific headers */
 #if defined(__linux__)
 #include "subsystems/os_linux/os_routing_linux.h"
@@ -219,6 +242,8 @@ static INLINE const char *os_routing_to_string(
 
 static INLINE void os_routing_init_wildcard_route(struct os_route *);
 
+static INLINE const struct os_route_statistics *os_routing_get_statistics(void);
+
 static INLINE void os_routing_init_half_os_route_key(
     struct netaddr *any, struct netaddr *specific,
     const struct netaddr *source);
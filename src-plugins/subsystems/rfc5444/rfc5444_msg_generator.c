@@ -87,9 +87,19 @@ static void _finalize_message_fragment(struct rfc5444_writer *writer,
     rfc5444_writer_targetselector useIf, void *param);
 static int _compress_address(struct _rfc5444_internal_addr_compress_session *acs,
     struct rfc5444_writer *writer, struct list_entity *addr_list, int same_prefixlen);
+static void _sort_addresses(struct rfc5444_writer_message *msg);
+static int _get_addrtlv_cost(struct rfc5444_writer_addrtlv *tlv);
+static void _open_addrblocks(struct _rfc5444_internal_addr_compress_session *acs,
+    struct rfc5444_writer *writer, struct rfc5444_writer_address *addr,
+    int first_headlen, int new_cost, bool has_last_addr);
 static void _write_addresses(struct rfc5444_writer *writer, struct rfc5444_writer_message *msg,
     struct list_entity *fragment_addrs);
 static void _write_msgheader(struct rfc5444_writer *writer, struct rfc5444_writer_message *msg);
+static struct rfc5444_writer_addrcache *_get_addrcache(
+    struct rfc5444_writer *writer, struct rfc5444_writer_message *msg);
+static bool _use_addrcache(struct rfc5444_writer *writer,
+    struct rfc5444_writer_message *msg, size_t max_msg_size);
+static void _store_addrcache(struct rfc5444_writer *writer, struct rfc5444_writer_message *msg);
 static uint8_t *_write_addresstlvs(struct rfc5444_writer *writer, struct rfc5444_writer_message *msg,
     struct rfc5444_writer_address *first, struct rfc5444_writer_address *last, uint8_t *ptr);
 
@@ -243,6 +253,16 @@ rfc5444_writer_create_message(struct rfc5444_writer *writer, uint8_t msgid,
     }
   }
 
+  /* reuse address section of the last message if nothing changed */
+  if (_use_addrcache(writer, msg, max_msg_size)) {
+    list_init_head(&current_list);
+    _finalize_message_fragment(writer, msg, &current_list, true, useIf, param);
+#if WRITER_STATE_MACHINE == true
+    writer->_state = RFC5444_WRITER_NONE;
+#endif
+    return RFC5444_OKAY;
+  }
+
 #if WRITER_STATE_MACHINE == true
   writer->_state = RFC5444_WRITER_ADD_ADDRESSES;
 #endif
@@ -253,6 +273,10 @@ rfc5444_writer_create_message(struct rfc5444_writer *writer, uint8_t msgid,
     }
   }
 
+  if (writer->sorted_addr_compression) {
+    _sort_addresses(msg);
+  }
+
   /* join mandatory and normal address list */
   list_merge(&msg->_addr_head, &msg->_non_mandatory_addr_head);
 
@@ -854,12 +878,12 @@ static int
 _compress_address(struct _rfc5444_internal_addr_compress_session *acs,
     struct rfc5444_writer *writer, struct list_entity *addr_list,
     int same_prefixlen) {
-  struct rfc5444_writer_address *addr, *last_addr;
+  struct rfc5444_writer_address *addr, *last_addr, *group_ptr;
   struct rfc5444_writer_addrtlv *tlv, *last_tlv;
   struct rfc5444_writer_tlvtype *tlvtype;
   uint32_t i, common_head;
   const uint8_t *addrptr, *last_addrptr;
-  int cost, new_cost, continue_cost;
+  int cost, new_cost, continue_cost, tlv_cost, tlv_continue_cost, group_tlv_cost;
   uint8_t addrlen;
   bool special_prefixlen;
   bool closed;
@@ -939,6 +963,16 @@ _compress_address(struct _rfc5444_internal_addr_compress_session *acs,
     }
   }
 
+  group_ptr = NULL;
+  group_tlv_cost = 0;
+  tlv_cost = 0;
+  if (writer->sorted_addr_compression) {
+    /* cost of the tlvs of a new address block */
+    avl_for_each_element(&addr->_addrtlv_tree, tlv, addrtlv_node) {
+      tlv_cost += _get_addrtlv_cost(tlv);
+    }
+  }
+
   /* calculate new costs for next address including tlvs */
   for (i = 0; i < addrlen; i++) {
     new_cost = 0;
@@ -949,6 +983,22 @@ _compress_address(struct _rfc5444_internal_addr_compress_session *acs,
     if (common_head < i) {
       closed = true;
     }
+
+    if (closed && i > 0 && writer->sorted_addr_compression) {
+      /* all longer heads have to start a new address block with the same costs */
+      new_cost = 2 + 1 + writer->msg_addr_len + 2 + tlv_cost;
+      if (special_prefixlen) {
+        new_cost++;
+      }
+      _open_addrblocks(acs, writer, addr, i, new_cost, last_addr != NULL);
+      break;
+    }
+
+    if (!closed && addr->index - acs[i].ptr->index > 254) {
+      /* an address block cannot contain more than 255 addresses */
+      closed = true;
+    }
+
     /* cost of new address header */
     new_cost = 2 + (i > 0 ? 1 : 0) + writer->msg_addr_len;
     if (special_prefixlen) {
@@ -972,52 +1022,49 @@ _compress_address(struct _rfc5444_internal_addr_compress_session *acs,
     /* mandatory TLV block */
     new_cost += 2;
 
-    /* calculate costs for breaking/continuing tlv sequences */
-    avl_for_each_element(&addr->_addrtlv_tree, tlv, addrtlv_node) {
-      tlvtype = tlv->tlvtype;
-
-      /* type + flags */
-      cost = 2;
-
-      if (tlvtype->exttype > 0) {
-        cost++;
-      }
-
-      /* TODO: dynamic index fields? */
-      cost += 2;
-
-      if (tlv->length > 255) {
-        /* 2 byte length field */
-        cost++;
-      }
-      if (tlv->length > 0) {
-        /* 1 or 2 byte length field */
-        cost++;
-      }
-
-      /* value */
-      cost += tlv->length;
-
-      /* add to cost for a new TLV block */
-      new_cost += cost;
+    if (writer->sorted_addr_compression && !closed && acs[i].ptr == group_ptr) {
+      /*
+       * address block started at the same address as for a shorter
+       * head, so the tlv sequences are the same too
+       */
+      new_cost += tlv_cost;
+      continue_cost += group_tlv_cost;
+    }
+    else {
+      tlv_continue_cost = 0;
+
+      /* calculate costs for breaking/continuing tlv sequences */
+      avl_for_each_element(&addr->_addrtlv_tree, tlv, addrtlv_node) {
+        tlvtype = tlv->tlvtype;
+        cost = _get_addrtlv_cost(tlv);
+
+        /* add to cost for a new TLV block */
+        new_cost += cost;
+
+        /* check if we are forced to do a new tlv block anyways */
+        if (closed || !tlv->_same_length) {
+          /*
+           * this TLV does not continue, either because address block is ending or because
+           * value length changed
+           */
+          tlv_continue_cost += cost;
+          continue;
+        }
 
-      /* check if we are forced to do a new tlv block anyways */
-      if (closed || !tlv->_same_length) {
-        /* 
-         * this TLV does not continue, either because address block is ending or because
-         * value length changed
-         */
-        continue_cost += cost;
-        continue;
+        if (tlvtype->_tlvblock_multi[i]) {
+          /* we are already within a TLV with multiple values, so add another one */
+          tlv_continue_cost += tlv->length;
+        }
+        else if (!tlv->_same_value) {
+          /* ups, value changed. Change cost estimate to multivalue TLV */
+          tlv_continue_cost += tlv->length * tlvtype->_tlvblock_count[i];
+        }
       }
+      continue_cost += tlv_continue_cost;
 
-      if (tlvtype->_tlvblock_multi[i]) {
-        /* we are already within a TLV with multiple values, so add another one */
-        continue_cost += tlv->length;
-      }
-      else if (!tlv->_same_value) {
-        /* ups, value changed. Change cost estimate to multivalue TLV */
-        continue_cost += tlv->length * tlvtype->_tlvblock_count[i];
+      if (!closed) {
+        group_ptr = acs[i].ptr;
+        group_tlv_cost = tlv_continue_cost;
       }
     }
 #ifdef DEBUG_OUTPUT
@@ -1071,6 +1118,102 @@ _compress_address(struct _rfc5444_internal_addr_compress_session *acs,
   return same_prefixlen;
 }
 
+/**
+ * Sort the mandatory and the non-mandatory addresses of a message
+ * by their binary representation, so addresses with a common head
+ * are next to each other.
+ * @param msg pointer to message object
+ */
+static void
+_sort_addresses(struct rfc5444_writer_message *msg) {
+  struct rfc5444_writer_address *addr;
+
+  list_init_head(&msg->_addr_head);
+  list_init_head(&msg->_non_mandatory_addr_head);
+
+  /* the address tree is already sorted */
+  avl_for_each_element(&msg->_addr_tree, addr, _addr_tree_node) {
+    if (addr->_mandatory_addr) {
+      list_add_tail(&msg->_addr_head, &addr->_addr_list_node);
+    }
+    else {
+      list_add_tail(&msg->_non_mandatory_addr_head, &addr->_addr_list_node);
+    }
+  }
+}
+
+/**
+ * @param tlv pointer to address tlv
+ * @return estimated number of bytes for a new tlv with this value
+ */
+static int
+_get_addrtlv_cost(struct rfc5444_writer_addrtlv *tlv) {
+  int cost;
+
+  /* type + flags */
+  cost = 2;
+
+  if (tlv->tlvtype->exttype > 0) {
+    cost++;
+  }
+
+  /* TODO: dynamic index fields? */
+  cost += 2;
+
+  if (tlv->length > 255) {
+    /* 2 byte length field */
+    cost++;
+  }
+  if (tlv->length > 0) {
+    /* 1 or 2 byte length field */
+    cost++;
+  }
+
+  /* value */
+  return cost + tlv->length;
+}
+
+/**
+ * Start a new address block for all head lengths starting with
+ * a minimum value. This is the same result _compress_address()
+ * calculates for each of these head lengths on its own.
+ * @param acs pointer to address compression session
+ * @param writer pointer to rfc5444 writer
+ * @param addr first address of the new address blocks
+ * @param first_headlen smallest head length (larger than zero)
+ * @param new_cost cost of the new address block including tlvs
+ * @param has_last_addr true if address is not the first one of the fragment
+ */
+static void
+_open_addrblocks(struct _rfc5444_internal_addr_compress_session *acs,
+    struct rfc5444_writer *writer, struct rfc5444_writer_address *addr,
+    int first_headlen, int new_cost, bool has_last_addr) {
+  struct rfc5444_writer_addrtlv *tlv;
+  struct rfc5444_writer_tlvtype *tlvtype;
+  int i, total;
+
+  total = acs[writer->msg_addr_len-1].total;
+  for (i = first_headlen; i < writer->msg_addr_len; i++) {
+    acs[i].ptr = addr;
+    acs[i].multiplen = false;
+    acs[i].total = total;
+    acs[i].current = new_cost;
+
+    if (has_last_addr) {
+      acs[i].closed = true;
+    }
+  }
+
+  avl_for_each_element(&addr->_addrtlv_tree, tlv, addrtlv_node) {
+    tlvtype = tlv->tlvtype;
+
+    for (i = first_headlen; i < writer->msg_addr_len; i++) {
+      tlvtype->_tlvblock_count[i] = 1;
+      tlvtype->_tlvblock_multi[i] = false;
+    }
+  }
+}
+
 static uint8_t *
 _write_addresstlv(struct rfc5444_writer_tlvtype *tlvtype,
     struct rfc5444_writer_address *addr_first,
@@ -1368,6 +1511,87 @@ _write_addresses(struct rfc5444_writer *writer, struct rfc5444_writer_message *m
   msg->_bin_addr_size = ptr - start;
 }
 
+/**
+ * @param writer pointer to writer context
+ * @param msg pointer to message object
+ * @return address section cache for the current address length,
+ *   NULL if the message does not use a cache
+ */
+static struct rfc5444_writer_addrcache *
+_get_addrcache(struct rfc5444_writer *writer, struct rfc5444_writer_message *msg) {
+  if (!msg->use_addr_cache || msg->target_specific
+      || writer->msg_addr_len == 0 || writer->msg_addr_len > RFC5444_MAX_ADDRLEN) {
+    return NULL;
+  }
+  return &msg->_addr_cache[writer->msg_addr_len - 1];
+}
+
+/**
+ * Copy the cached address section into the message buffer if
+ * it is valid and fits into the message.
+ * @param writer pointer to writer context
+ * @param msg pointer to message object
+ * @param max_msg_size maximum size of the message
+ * @return true if the cached address section has been used,
+ *   false if the addresses have to be generated
+ */
+static bool
+_use_addrcache(struct rfc5444_writer *writer,
+    struct rfc5444_writer_message *msg, size_t max_msg_size) {
+  struct rfc5444_writer_addrcache *cache;
+  size_t offset;
+
+  cache = _get_addrcache(writer, msg);
+  if (cache == NULL || !cache->valid) {
+    return false;
+  }
+
+  offset = writer->_msg.header + writer->_msg.added + writer->_msg.allocated;
+  if (offset + cache->size > max_msg_size) {
+    /* message would need fragmentation */
+    return false;
+  }
+
+  if (cache->size > 0) {
+    memcpy(&writer->_msg.buffer[offset], cache->data, cache->size);
+  }
+  msg->_bin_addr_size = cache->size;
+  msg->addr_cache_hits++;
+  return true;
+}
+
+/**
+ * Remember the address section of an unfragmented message
+ * @param writer pointer to writer context
+ * @param msg pointer to message object
+ */
+static void
+_store_addrcache(struct rfc5444_writer *writer, struct rfc5444_writer_message *msg) {
+  struct rfc5444_writer_addrcache *cache;
+  uint8_t *data;
+
+  cache = _get_addrcache(writer, msg);
+  if (cache == NULL || cache->valid) {
+    return;
+  }
+
+  if (msg->_bin_addr_size > cache->allocated) {
+    data = realloc(cache->data, msg->_bin_addr_size);
+    if (data == NULL) {
+      return;
+    }
+    cache->data = data;
+    cache->allocated = msg->_bin_addr_size;
+  }
+
+  if (msg->_bin_addr_size > 0) {
+    memcpy(cache->data, &writer->_msg.buffer[writer->_msg.header
+        + writer->_msg.added + writer->_msg.allocated], msg->_bin_addr_size);
+  }
+  cache->size = msg->_bin_addr_size;
+  cache->valid = true;
+}
+
 /**
  * Write header of message including mandatory tlvblock length field.
  * @param writer pointer to writer context
@@ -1481,6 +1705,10 @@ _finalize_message_fragment(struct rfc5444_writer *writer, struct rfc5444_writer_
     _write_addresses(writer, msg, fragment_addrs);
   }
 
+  if (not_fragmented) {
+    _store_addrcache(writer, msg);
+  }
+
 #if WRITER_STATE_MACHINE == true
   writer->_state = RFC5444_WRITER_FINISH_HEADER;
 #endif
@@ -64,6 +64,9 @@
 #define RFC5444_CONSUMER_DROP_ONLY(value, def) (value)
 #endif
 
+/*! alignment of arena allocations */
+#define RFC5444_ARENA_ALIGN 8
+
 static int _consumer_avl_comp(const void *k1, const void *k2);
 static uint16_t _calc_tlvconsumer_intorder(struct rfc5444_reader_tlvblock_consumer_entry *entry);
 static uint16_t _calc_tlvblock_intorder(struct rfc5444_reader_tlvblock_entry *entry);
@@ -71,13 +74,25 @@ static int _compare_tlvtypes(struct rfc5444_reader_tlvblock_entry *tlv,
     struct rfc5444_reader_tlvblock_consumer_entry *entry);
 static uint8_t _rfc5444_get_u8(const uint8_t **ptr, const uint8_t *end, enum rfc5444_result *result);
 static uint16_t _rfc5444_get_u16(const uint8_t **ptr, const uint8_t *end, enum rfc5444_result *result);
-static void _free_tlvblock(struct rfc5444_reader *parser, struct avl_tree *entries);
+static void _init_tlvblock(struct rfc5444_reader *parser,
+    struct rfc5444_reader_tlvblock *block);
+static struct rfc5444_reader_tlvblock_entry *_get_first_tlv(
+    struct rfc5444_reader_tlvblock *block);
+static struct rfc5444_reader_tlvblock_entry *_get_next_tlv(
+    struct rfc5444_reader_tlvblock *block, struct rfc5444_reader_tlvblock_entry *tlv);
+static struct rfc5444_reader_tlvblock_entry *_skip_unused_tlvs(
+    struct rfc5444_reader_tlvblock_consumer *consumer,
+    struct rfc5444_reader_tlvblock *block, struct rfc5444_reader_tlvblock_entry *tlv);
+static void _free_tlvblock(struct rfc5444_reader *parser, struct rfc5444_reader_tlvblock *block);
 static int _parse_tlv(struct rfc5444_reader_tlvblock_entry *entry, const uint8_t **ptr,
     const uint8_t *eob, uint8_t addr_count);
+static enum rfc5444_result _add_flat_tlv(struct rfc5444_reader *parser,
+    struct rfc5444_reader_tlvblock *block, struct rfc5444_reader_tlvblock_entry *entry);
 static int _parse_tlvblock(struct rfc5444_reader *parser,
-    struct avl_tree *tlvblock, const uint8_t **ptr, const uint8_t *eob, uint8_t addr_count);
+    struct rfc5444_reader_tlvblock *tlvblock, const uint8_t **ptr, const uint8_t *eob, uint8_t addr_count);
 static int _schedule_tlvblock(struct rfc5444_reader_tlvblock_consumer *consumer,
-    struct rfc5444_reader_tlvblock_context *context, struct avl_tree *entries, uint8_t idx);
+    struct rfc5444_reader_tlvblock_context *context,
+    struct rfc5444_reader_tlvblock *entries, uint8_t idx);
 static int _parse_addrblock(struct rfc5444_reader_addrblock_entry *addr_entry,
     struct rfc5444_reader_tlvblock_context *tlv_context, const uint8_t **ptr, const uint8_t *eob);
 static int _handle_message(struct rfc5444_reader *parser,
@@ -87,10 +102,19 @@ static struct rfc5444_reader_tlvblock_consumer *_add_consumer(
     struct rfc5444_reader_tlvblock_consumer_entry *entries, int entrycount);
 static void _free_consumer(struct avl_tree *consumer_tree,
     struct rfc5444_reader_tlvblock_consumer *consumer);
+static int _build_dispatch(struct rfc5444_reader *parser);
 static struct rfc5444_reader_addrblock_entry *_malloc_addrblock_entry(void);
 static struct rfc5444_reader_tlvblock_entry *_malloc_tlvblock_entry(void);
 static void _free_addrblock_entry(struct rfc5444_reader_addrblock_entry *entry);
 static void _free_tlvblock_entry(struct rfc5444_reader_tlvblock_entry *entry);
+static struct rfc5444_reader_addrblock_entry *_alloc_addrblock(struct rfc5444_reader *parser);
+static void _release_addrblock(struct rfc5444_reader *parser,
+    struct rfc5444_reader_addrblock_entry *addr);
+
+static void _arena_init(struct rfc5444_reader_arena *arena);
+static void _arena_reset(struct rfc5444_reader_arena *arena);
+static void _arena_free(struct rfc5444_reader_arena *arena);
+static void *_arena_alloc(struct rfc5444_reader_arena *arena, size_t size);
 
 static uint8_t rfc5444_get_pktversion(uint8_t v);
 
@@ -112,6 +136,14 @@ rfc5444_reader_init(struct rfc5444_reader *context) {
     context->free_addrblock_entry = _free_addrblock_entry;
   if (context->free_tlvblock_entry == NULL)
     context->free_tlvblock_entry = _free_tlvblock_entry;
+
+  if (context->use_arena) {
+    _arena_init(&context->arena);
+  }
+
+  context->_dispatch = NULL;
+  memset(context->_dispatch_start, 0, sizeof(context->_dispatch_start));
+  context->_dispatch_dirty = false;
 }
 
 /**
@@ -121,6 +153,11 @@ rfc5444_reader_init(struct rfc5444_reader *context) {
  */
 void
 rfc5444_reader_cleanup(struct rfc5444_reader *context) {
+  if (context->use_arena) {
+    _arena_free(&context->arena);
+  }
+  free(context->_dispatch);
+  context->_dispatch = NULL;
   memset(&context->packet_consumer, 0, sizeof(context->packet_consumer));
   memset(&context->message_consumer, 0, sizeof(context->message_consumer));
 }
@@ -136,7 +173,7 @@ enum rfc5444_result
 rfc5444_reader_handle_packet(struct rfc5444_reader *parser,
     const uint8_t *buffer, size_t length) {
   struct rfc5444_reader_tlvblock_context context;
-  struct avl_tree entries;
+  struct rfc5444_reader_tlvblock entries;
   struct rfc5444_reader_tlvblock_consumer *consumer, *last_started;
   const uint8_t *ptr, *eob;
   bool has_tlv;
@@ -183,8 +220,18 @@ rfc5444_reader_handle_packet(struct rfc5444_reader *parser,
     return result;
   }
 
-  /* initialize avl_tree */
-  avl_init(&entries, avl_comp_uint32, true);
+  /* compile message consumers if they changed since the last packet */
+  if (parser->_dispatch_dirty && _build_dispatch(parser)) {
+    return RFC5444_OUT_OF_MEMORY;
+  }
+
+  /* all memory of the last packet can be reused */
+  if (parser->use_arena) {
+    _arena_reset(&parser->arena);
+  }
+
+  /* initialize tlvblock */
+  _init_tlvblock(parser, &entries);
   last_started = NULL;
 
   /* check for packet tlv */
@@ -291,6 +338,7 @@ rfc5444_reader_add_message_consumer(struct rfc5444_reader *parser,
     struct rfc5444_reader_tlvblock_consumer *consumer,
     struct rfc5444_reader_tlvblock_consumer_entry *entries, size_t entrycount) {
   _add_consumer(consumer, &parser->message_consumer, entries, entrycount);
+  parser->_dispatch_dirty = true;
 }
 
 /**
@@ -314,6 +362,7 @@ void
 rfc5444_reader_remove_message_consumer(struct rfc5444_reader *parser,
     struct rfc5444_reader_tlvblock_consumer *consumer) {
   _free_consumer(&parser->message_consumer, consumer);
+  parser->_dispatch_dirty = true;
 }
 
 /**
@@ -424,15 +473,92 @@ _rfc5444_get_u16(const uint8_t **ptr, const uint8_t *end, enum rfc5444_result *e
       | (uint16_t)_rfc5444_get_u8(ptr, end, error);
 }
 
+/**
+ * Initialize an empty tlvblock for the mode of the parser
+ * @param parser pointer to parser context
+ * @param block pointer to tlvblock
+ */
+static void
+_init_tlvblock(struct rfc5444_reader *parser, struct rfc5444_reader_tlvblock *block) {
+  avl_init(&block->_tree, avl_comp_uint16, true);
+  block->_array = NULL;
+  block->_count = 0;
+  block->_flat = parser->use_arena;
+}
+
+/**
+ * @param block pointer to tlvblock
+ * @return first (lowest type) entry of tlvblock, NULL if empty
+ */
+static struct rfc5444_reader_tlvblock_entry *
+_get_first_tlv(struct rfc5444_reader_tlvblock *block) {
+  struct rfc5444_reader_tlvblock_entry *tlv;
+
+  if (block->_flat) {
+    return block->_count > 0 ? &block->_array[0] : NULL;
+  }
+  if (avl_is_empty(&block->_tree)) {
+    return NULL;
+  }
+  return avl_first_element(&block->_tree, tlv, node);
+}
+
+/**
+ * @param block pointer to tlvblock
+ * @param tlv current entry of tlvblock
+ * @return next entry of tlvblock, NULL if tlv was the last one
+ */
+static struct rfc5444_reader_tlvblock_entry *
+_get_next_tlv(struct rfc5444_reader_tlvblock *block,
+    struct rfc5444_reader_tlvblock_entry *tlv) {
+  if (block->_flat) {
+    tlv++;
+    return tlv < &block->_array[block->_count] ? tlv : NULL;
+  }
+  if (avl_is_last(&block->_tree, &tlv->node)) {
+    return NULL;
+  }
+  return avl_next_element(tlv, node);
+}
+
+/**
+ * Skip all TLVs a consumer without tlv_callback is not interested in
+ * @param consumer tlvblock consumer
+ * @param block pointer to tlvblock
+ * @param tlv current entry of tlvblock, might be NULL
+ * @return first TLV (starting with tlv) the consumer has an entry for,
+ *   NULL if there is no such TLV left
+ */
+static struct rfc5444_reader_tlvblock_entry *
+_skip_unused_tlvs(struct rfc5444_reader_tlvblock_consumer *consumer,
+    struct rfc5444_reader_tlvblock *block, struct rfc5444_reader_tlvblock_entry *tlv) {
+  if (consumer->tlv_callback != NULL) {
+    return tlv;
+  }
+
+  while (tlv != NULL && !bitmap256_get(&consumer->_tlv_types, tlv->type)) {
+    tlv = _get_next_tlv(block, tlv);
+  }
+  return tlv;
+}
+
 /**
  * free a list of linked tlv_block entries
- * @param entries avl_tree of tlv_block entries
+ * @param parser pointer to parser context
+ * @param block tlvblock to free
  */
 static void
-_free_tlvblock(struct rfc5444_reader *parser, struct avl_tree *entries) {
+_free_tlvblock(struct rfc5444_reader *parser, struct rfc5444_reader_tlvblock *block) {
   struct rfc5444_reader_tlvblock_entry *tlv, *ptr;
 
-  avl_remove_all_elements(entries, tlv, node, ptr) {
+  if (block->_flat) {
+    /* memory belongs to the arena */
+    block->_array = NULL;
+    block->_count = 0;
+    return;
+  }
+
+  avl_remove_all_elements(&block->_tree, tlv, node, ptr) {
     parser->free_tlvblock_entry(tlv);
   }
 }
@@ -551,9 +677,62 @@ _parse_tlv(struct rfc5444_reader_tlvblock_entry *entry,
   return RFC5444_OKAY;
 }
 
+/**
+ * Insert a parsed TLV into the sorted array of an arena tlvblock.
+ * TLVs of the same type keep the order of the packet.
+ * @param parser pointer to parser context
+ * @param block pointer to tlvblock
+ * @param entry parsed TLV
+ * @return RFC5444_OKAY or RFC5444_OUT_OF_MEMORY
+ */
+static enum rfc5444_result
+_add_flat_tlv(struct rfc5444_reader *parser,
+    struct rfc5444_reader_tlvblock *block, struct rfc5444_reader_tlvblock_entry *entry) {
+  struct rfc5444_reader_arena_chunk *chunk;
+  struct rfc5444_reader_tlvblock_entry *array;
+  uint8_t *top;
+  size_t i;
+
+  chunk = parser->arena._current;
+  top = chunk != NULL ? (uint8_t *)(chunk + 1) + chunk->used : NULL;
+
+  if (block->_count > 0 && (uint8_t *)&block->_array[block->_count] == top
+      && chunk->used + sizeof(*entry) <= chunk->size) {
+    /* array is at the end of the current chunk, just grow it */
+    chunk->used += sizeof(*entry);
+    parser->arena.used += sizeof(*entry);
+    if (parser->arena.used > parser->arena.high_water) {
+      parser->arena.high_water = parser->arena.used;
+    }
+  }
+  else {
+    /* move array to a new position with enough space */
+    array = _arena_alloc(&parser->arena, sizeof(*entry) * (block->_count + 1));
+    if (array == NULL) {
+      return RFC5444_OUT_OF_MEMORY;
+    }
+    if (block->_count > 0) {
+      memcpy(array, block->_array, sizeof(*entry) * block->_count);
+    }
+    block->_array = array;
+  }
+
+  /* find position of new entry, the writer normally sorts the TLVs already */
+  for (i = block->_count; i > 0 && block->_array[i-1]._order > entry->_order; i--);
+
+  if (i < block->_count) {
+    memmove(&block->_array[i+1], &block->_array[i],
+        sizeof(*entry) * (block->_count - i));
+  }
+  memcpy(&block->_array[i], entry, sizeof(*entry));
+  block->_count++;
+  return RFC5444_OKAY;
+}
+
 /**
  * parse a TLV block into a list of linked tlvblock_entries.
- * @param tlvblock pointer to avl_tree to store generates tlvblock entries
+ * @param parser pointer to parser context
+ * @param tlvblock pointer to tlvblock to store generates tlvblock entries
  * @param ptr pointer to pointer to begin of datastream, will be
  *   incremented to the first byte after the block if no error happened.
  *   Will be set to eob if an error happened.
@@ -562,7 +741,7 @@ _parse_tlv(struct rfc5444_reader_tlvblock_entry *entry,
  *   packet tlv * @return -1 if an error happened, 0 otherwise
  */
 static enum rfc5444_result
-_parse_tlvblock(struct rfc5444_reader *parser, struct avl_tree *tlvblock,
+_parse_tlvblock(struct rfc5444_reader *parser, struct rfc5444_reader_tlvblock *tlvblock,
     const uint8_t **ptr, const uint8_t *eob, uint8_t addr_count) {
   enum rfc5444_result result = RFC5444_OKAY;
   struct rfc5444_reader_tlvblock_entry *tlv1 = NULL;
@@ -591,6 +770,15 @@ _parse_tlvblock(struct rfc5444_reader *parser, struct avl_tree *tlvblock,
       goto cleanup_parse_tlvblock;
     }
 
+    if (tlvblock->_flat) {
+      /* copy TLV block entry into sorted array */
+      result = _add_flat_tlv(parser, tlvblock, &entry);
+      if (result != RFC5444_OKAY) {
+        goto cleanup_parse_tlvblock;
+      }
+      continue;
+    }
+
     /* get memory to store TLV block entry */
     tlv1 = parser->malloc_tlvblock_entry();
     if (tlv1 == NULL) {
@@ -604,7 +792,7 @@ _parse_tlvblock(struct rfc5444_reader *parser, struct avl_tree *tlvblock,
 
     /* put into sorted list */
     tlv1->node.key = &tlv1->_order;
-    avl_insert(tlvblock, &tlv1->node);
+    avl_insert(&tlvblock->_tree, &tlv1->node);
   }
 cleanup_parse_tlvblock:
   if (result != RFC5444_OKAY) {
@@ -618,7 +806,7 @@ cleanup_parse_tlvblock:
  * Call callbacks for parsed TLV blocks
  * @param consumer pointer to first consumer for this message type
  * @param context pointer to context for tlv block
- * @param entries pointer avl_tree of tlv block entries
+ * @param entries pointer to tlv block
  * @param idx of current address inside the addressblock, 0 for message tlv block
  * @return RFC5444_TLV_DROP_ADDRESS if the current address should
  *   be dropped for later consumers, RFC5444_TLV_DROP_CONTEXT if
@@ -627,7 +815,7 @@ cleanup_parse_tlvblock:
  */
 static enum rfc5444_result
 _schedule_tlvblock(struct rfc5444_reader_tlvblock_consumer *consumer, struct rfc5444_reader_tlvblock_context *context,
-    struct avl_tree *entries, uint8_t idx) {
+    struct rfc5444_reader_tlvblock *entries, uint8_t idx) {
   struct rfc5444_reader_tlvblock_entry *tlv = NULL, *nexttlv = NULL;
   struct rfc5444_reader_tlvblock_consumer_entry *cons_entry;
   bool constraints_failed;
@@ -636,12 +824,7 @@ _schedule_tlvblock(struct rfc5444_reader_tlvblock_consumer *consumer, struct rfc
   constraints_failed = false;
 
   /* initialize tlv pointers, there must be TLVs */
-  if (avl_is_empty(entries)) {
-    tlv = NULL;
-  }
-  else {
-    tlv = avl_first_element(entries, tlv, node);
-  }
+  tlv = _skip_unused_tlvs(consumer, entries, _get_first_tlv(entries));
 
   /* initialize consumer pointer */
   if (list_is_empty(&consumer->_consumer_list)) {
@@ -739,12 +922,7 @@ _schedule_tlvblock(struct rfc5444_reader_tlvblock_consumer *consumer, struct rfc
     }
     if (tlv != NULL && _compare_tlvtypes(tlv, cons_entry) <= 0) {
       /* advance tlv pointer */
-      if (avl_is_last(entries, &tlv->node)) {
-        tlv = NULL;
-      }
-      else {
-        tlv = avl_next_element(tlv, node);
-      }
+      tlv = _skip_unused_tlvs(consumer, entries, _get_next_tlv(entries, tlv));
     }
     if (_compare_tlvtypes(tlv, cons_entry) > 0) {
       constraints_failed |= cons_entry->mandatory && !match;
@@ -919,13 +1097,13 @@ _parse_addrblock(struct rfc5444_reader_addrblock_entry *addr_entry,
  * Call start and tlvblock callbacks for message tlv consumer
  * @param consumer pointer to tlvblock consumer object
  * @param tlv_context current tlv context
- * @param tlv_entries pointer to tlventry avltree
+ * @param tlv_entries pointer to message tlvblock
  * @return RFC5444_OKAY if no error happend, RFC5444_DROP_ if a
  *   context (message or packet) should be dropped
  */
 static enum rfc5444_result
 schedule_msgtlv_consumer(struct rfc5444_reader_tlvblock_consumer *consumer,
-    struct rfc5444_reader_tlvblock_context *tlv_context, struct avl_tree *tlv_entries) {
+    struct rfc5444_reader_tlvblock_context *tlv_context, struct rfc5444_reader_tlvblock *tlv_entries) {
   enum rfc5444_result result = RFC5444_OKAY;
   tlv_context->type = RFC5444_CONTEXT_MESSAGE;
 
@@ -1045,23 +1223,25 @@ schedule_msgaddr_consumer(struct rfc5444_reader_tlvblock_consumer *consumer,
 /**
  * Call end callbacks for message tlvblock consumer.
  * @param tlv_context context of current tlvblock
- * @param first begin of range of consumers which should be called
- * @param last end of range of consumers which should be called
+ * @param consumers array of consumers for the message type
+ * @param first index of first consumer which should be called
+ * @param last index of last consumer which should be called
  * @param result current 'drop context' level
  * @return new 'drop context level'
  */
 static enum rfc5444_result
 schedule_end_message_cbs(struct rfc5444_reader_tlvblock_context *tlv_context,
-    struct rfc5444_reader_tlvblock_consumer *first, struct rfc5444_reader_tlvblock_consumer *last,
+    struct rfc5444_reader_tlvblock_consumer **consumers, size_t first, size_t last,
     enum rfc5444_result result) {
   struct rfc5444_reader_tlvblock_consumer *consumer;
   enum rfc5444_result r;
+  size_t i;
 
   tlv_context->type = RFC5444_CONTEXT_MESSAGE;
 
-  avl_for_element_range_reverse(first, last, consumer, _node) {
-    if (consumer->end_callback && !consumer->addrblock_consumer
-        && (consumer->default_msg_consumer || consumer->msg_id == tlv_context->msg_type)) {
+  for (i = last + 1; i > first; i--) {
+    consumer = consumers[i-1];
+    if (consumer->end_callback && !consumer->addrblock_consumer) {
       tlv_context->consumer = consumer;
       r = consumer->end_callback(tlv_context, result != RFC5444_OKAY);
       if (r > result) {
@@ -1086,8 +1266,10 @@ static enum rfc5444_result
 _handle_message(struct rfc5444_reader *parser,
     struct rfc5444_reader_tlvblock_context *tlv_context,
     const uint8_t **ptr, const uint8_t *eob) {
-  struct avl_tree tlv_entries;
-  struct rfc5444_reader_tlvblock_consumer *consumer, *same_order[2];
+  struct rfc5444_reader_tlvblock tlv_entries;
+  struct rfc5444_reader_tlvblock_consumer *consumer, **consumers;
+  size_t i, consumer_count, same_order[2];
+  bool has_same_order;
   struct list_entity addr_head;
   struct rfc5444_reader_addrblock_entry *addr, *safe;
   const uint8_t *start, *end = NULL;
@@ -1098,8 +1280,9 @@ _handle_message(struct rfc5444_reader *parser,
 
   /* initialize variables */
   result = RFC5444_OKAY;
-  same_order[0] = same_order[1] = NULL;
-  avl_init(&tlv_entries, avl_comp_uint16, true);
+  same_order[0] = same_order[1] = 0;
+  has_same_order = false;
+  _init_tlvblock(parser, &tlv_entries);
   list_init_head(&addr_head);
   tlv_context->_do_not_forward = false;
 
@@ -1164,25 +1347,25 @@ _handle_message(struct rfc5444_reader *parser,
   /* parse rest of message */
   while (*ptr < end) {
     /* get memory for storing the address block entry */
-    addr = parser->malloc_addrblock_entry();
+    addr = _alloc_addrblock(parser);
     if (addr == NULL) {
       result = RFC5444_OUT_OF_MEMORY;
       goto cleanup_parse_message;
     }
 
-    /* initialize avl_tree */
-    avl_init(&addr->tlvblock, avl_comp_uint16, true);
+    /* initialize tlvblock */
+    _init_tlvblock(parser, &addr->tlvblock);
 
     /* parse address block... */
     if ((result = _parse_addrblock(addr, tlv_context, ptr, end)) != RFC5444_OKAY) {
-      parser->free_addrblock_entry(addr);
+      _release_addrblock(parser, addr);
       goto cleanup_parse_message;
     }
 
     /* ... and corresponding tlvblock */
     result = _parse_tlvblock(parser, &addr->tlvblock, ptr, end, addr->num_addr);
     if (result != RFC5444_OKAY) {
-      parser->free_addrblock_entry(addr);
+      _release_addrblock(parser, addr);
       goto cleanup_parse_message;
     }
 
@@ -1196,26 +1379,32 @@ _handle_message(struct rfc5444_reader *parser,
   tlv_context->msg_buffer = start;
   tlv_context->msg_size = size;
 
+  /* get precompiled list of message/address consumers for this message type */
+  consumers = NULL;
+  consumer_count = 0;
+  if (parser->_dispatch) {
+    consumers = &parser->_dispatch[parser->_dispatch_start[tlv_context->msg_type]];
+    consumer_count = parser->_dispatch_start[tlv_context->msg_type + 1]
+        - parser->_dispatch_start[tlv_context->msg_type];
+  }
+
   /* loop through list of message/address consumers */
-  avl_for_each_element(&parser->message_consumer, consumer, _node) {
-    if (!consumer->default_msg_consumer && consumer->msg_id != tlv_context->msg_type) {
-      /* wrong type of message, continue... */
-      continue;
-    }
+  for (i=0; i<consumer_count; i++) {
+    consumer = consumers[i];
 
     /* remember range of consumers with same order to call end_message() callbacks */
-    if (same_order[0] != NULL && consumer->order > same_order[1]->order) {
+    if (has_same_order && consumer->order > consumers[same_order[1]]->order) {
 #if DISALLOW_CONSUMER_CONTEXT_DROP == false
       result =
 #endif
       schedule_end_message_cbs(tlv_context,
-          same_order[0], same_order[1], result);
+          consumers, same_order[0], same_order[1], result);
 #if DISALLOW_CONSUMER_CONTEXT_DROP == false
       if (result != RFC5444_OKAY) {
         goto cleanup_parse_message;
       }
 #endif
-      same_order[0] = NULL;
+      has_same_order = false;
     }
 
     if (consumer->addrblock_consumer) {
@@ -1229,10 +1418,11 @@ _handle_message(struct rfc5444_reader *parser,
       result =
 #endif
       schedule_msgtlv_consumer(consumer, tlv_context, &tlv_entries);
-      if (same_order[0] == NULL) {
-        same_order[0] = consumer;
+      if (!has_same_order) {
+        same_order[0] = i;
+        has_same_order = true;
       }
-      same_order[1] = consumer;
+      same_order[1] = i;
     }
 
 #if DISALLOW_CONSUMER_CONTEXT_DROP == false
@@ -1243,12 +1433,12 @@ _handle_message(struct rfc5444_reader *parser,
   }
 
   /* handle last end_message() callback range */
-  if (same_order[0] != NULL) {
+  if (has_same_order) {
 #if DISALLOW_CONSUMER_CONTEXT_DROP == false
     result =
 #endif
     schedule_end_message_cbs(tlv_context,
-        same_order[0], same_order[1], result);
+        consumers, same_order[0], same_order[1], result);
 #if DISALLOW_CONSUMER_CONTEXT_DROP == false
     if (result != RFC5444_OKAY) {
       goto cleanup_parse_message;
@@ -1278,7 +1468,7 @@ cleanup_parse_message:
   /* free address tlvblocks */
   list_for_each_element_safe(&addr_head, addr, list_node, safe) {
     _free_tlvblock(parser, &addr->tlvblock);
-    parser->free_addrblock_entry(addr);
+    _release_addrblock(parser, addr);
   }
 
   /* free message tlvblock */
@@ -1311,10 +1501,12 @@ _add_consumer(struct rfc5444_reader_tlvblock_consumer *consumer, struct avl_tree
   bool set;
 
   list_init_head(&consumer->_consumer_list);
+  memset(&consumer->_tlv_types, 0, sizeof(consumer->_tlv_types));
 
   /* generate sorted list of entries */
   for (i=0; i<entrycount; i++) {
     o = _calc_tlvconsumer_intorder(&entries[i]);
+    bitmap256_set(&consumer->_tlv_types, entries[i].type);
 
     if (i == 0) {
       list_add_tail(&consumer->_consumer_list, &entries[i]._node);
@@ -1356,6 +1548,53 @@ _free_consumer(struct avl_tree *consumer_tree,
   if (avl_is_node_added(&consumer->_node)) {
     avl_remove(consumer_tree, &consumer->_node);
   }
+  memset(&consumer->_tlv_types, 0, sizeof(consumer->_tlv_types));
+}
+
+/**
+ * Compile the tree of message consumers into one array of consumers
+ * for each message type, keeping the order of the tree.
+ * @param parser pointer to parser context
+ * @return -1 if out of memory, 0 otherwise
+ */
+static int
+_build_dispatch(struct rfc5444_reader *parser) {
+  struct rfc5444_reader_tlvblock_consumer *consumer, **dispatch;
+  size_t count;
+  uint32_t idx;
+  int type;
+
+  /* calculate size of table */
+  count = 0;
+  avl_for_each_element(&parser->message_consumer, consumer, _node) {
+    count += consumer->default_msg_consumer ? 256 : 1;
+  }
+
+  dispatch = NULL;
+  if (count > 0) {
+    dispatch = calloc(count, sizeof(*dispatch));
+    if (dispatch == NULL) {
+      return -1;
+    }
+  }
+
+  /* fill in consumers for each message type */
+  idx = 0;
+  for (type=0; type<256; type++) {
+    parser->_dispatch_start[type] = idx;
+
+    avl_for_each_element(&parser->message_consumer, consumer, _node) {
+      if (consumer->default_msg_consumer || consumer->msg_id == type) {
+        dispatch[idx++] = consumer;
+      }
+    }
+  }
+  parser->_dispatch_start[256] = idx;
+
+  free(parser->_dispatch);
+  parser->_dispatch = dispatch;
+  parser->_dispatch_dirty = false;
+  return 0;
 }
 
 /**
@@ -1394,6 +1633,145 @@ _free_tlvblock_entry(struct rfc5444_reader_tlvblock_entry *entry) {
   free(entry);
 }
 
+/**
+ * Get a cleared addressblock entry, either from the arena or
+ * from the allocation callback of the parser
+ * @param parser pointer to parser context
+ * @return pointer to addressblock entry, NULL if out of memory
+ */
+static struct rfc5444_reader_addrblock_entry *
+_alloc_addrblock(struct rfc5444_reader *parser) {
+  struct rfc5444_reader_addrblock_entry *addr;
+
+  if (!parser->use_arena) {
+    return parser->malloc_addrblock_entry();
+  }
+
+  addr = _arena_alloc(&parser->arena, sizeof(*addr));
+  if (addr) {
+    memset(addr, 0, sizeof(*addr));
+  }
+  return addr;
+}
+
+/**
+ * Release an addressblock entry, arena memory is only released
+ * when the next packet is parsed.
+ * @param parser pointer to parser context
+ * @param addr addressblock entry
+ */
+static void
+_release_addrblock(struct rfc5444_reader *parser,
+    struct rfc5444_reader_addrblock_entry *addr) {
+  if (!parser->use_arena) {
+    parser->free_addrblock_entry(addr);
+  }
+}
+
+/**
+ * Initialize an empty reader arena
+ * @param arena pointer to arena
+ */
+static void
+_arena_init(struct rfc5444_reader_arena *arena) {
+  list_init_head(&arena->_chunks);
+  arena->_current = NULL;
+  arena->used = 0;
+  arena->high_water = 0;
+
+  if (arena->chunk_size == 0) {
+    arena->chunk_size = RFC5444_READER_ARENA_CHUNK;
+  }
+}
+
+/**
+ * Release all allocations of an arena but keep the memory chunks
+ * for the next packet.
+ * @param arena pointer to arena
+ */
+static void
+_arena_reset(struct rfc5444_reader_arena *arena) {
+  if (list_is_empty(&arena->_chunks)) {
+    return;
+  }
+
+  arena->_current = list_first_element(&arena->_chunks, arena->_current, _node);
+  arena->_current->used = 0;
+  arena->used = 0;
+}
+
+/**
+ * Free all memory chunks of an arena
+ * @param arena pointer to arena
+ */
+static void
+_arena_free(struct rfc5444_reader_arena *arena) {
+  struct rfc5444_reader_arena_chunk *chunk, *safe;
+
+  list_for_each_element_safe(&arena->_chunks, chunk, _node, safe) {
+    list_remove(&chunk->_node);
+    free(chunk);
+  }
+  arena->_current = NULL;
+  arena->used = 0;
+}
+
+/**
+ * Allocate a block of memory from the arena. The memory is not cleared.
+ * @param arena pointer to arena
+ * @param size number of bytes
+ * @return pointer to memory, NULL if out of memory
+ */
+static void *
+_arena_alloc(struct rfc5444_reader_arena *arena, size_t size) {
+  struct rfc5444_reader_arena_chunk *chunk;
+  size_t offset, len;
+
+  chunk = arena->_current;
+  offset = 0;
+  while (chunk != NULL) {
+    offset = (chunk->used + RFC5444_ARENA_ALIGN - 1) & ~((size_t)RFC5444_ARENA_ALIGN - 1);
+    if (offset + size <= chunk->size) {
+      break;
+    }
+
+    /* continue with next (already allocated) chunk */
+    if (list_is_last(&arena->_chunks, &chunk->_node)) {
+      chunk = NULL;
+    }
+    else {
+      chunk = list_next_element(chunk, _node);
+      chunk->used = 0;
+    }
+  }
+
+  if (chunk == NULL) {
+    /* get a new chunk */
+    len = arena->chunk_size;
+    if (len < size) {
+      len = size;
+    }
+
+    chunk = malloc(sizeof(*chunk) + len);
+    if (chunk == NULL) {
+      return NULL;
+    }
+    chunk->size = len;
+    chunk->used = 0;
+    list_add_tail(&arena->_chunks, &chunk->_node);
+    offset = 0;
+  }
+
+  arena->_current = chunk;
+  arena->used += offset + size - chunk->used;
+  if (arena->used > arena->high_water) {
+    arena->high_water = arena->used;
+  }
+
+  chunk->used = offset + size;
+  return (uint8_t *)(chunk + 1) + offset;
+}
+
 /**
  * @param v first byte of packet header
  * @return packet header version
@@ -49,9 +49,13 @@
 #include "common/common_types.h"
 #include "common/avl.h"
 #include "common/bitmap256.h"
+#include "common/list.h"
 #include "common/netaddr.h"
 #include "rfc5444_context.h"
 
+/*! default size of a memory chunk of the reader arena */
+#define RFC5444_READER_ARENA_CHUNK 16384
+
 /**
  * type of context for a rfc5444_reader_tlvblock_context
  */
@@ -114,6 +118,25 @@ struct rfc5444_reader_tlvblock_entry {
   struct bitmap256 int_drop_tlv;
 };
 
+/**
+ * Parsed TLV block, sorted by type and extension type.
+ * Depending on the reader mode the TLVs are either linked into an
+ * avl tree or stored in a flat array inside the reader arena.
+ */
+struct rfc5444_reader_tlvblock {
+  /*! tree of tlvblock entries (malloc mode) */
+  struct avl_tree _tree;
+
+  /*! sorted array of tlvblock entries (arena mode) */
+  struct rfc5444_reader_tlvblock_entry *_array;
+
+  /*! number of entries in array */
+  size_t _count;
+
+  /*! true if the block uses the flat array */
+  bool _flat;
+};
+
 /**
  * common context for packet, message and address TLV block
  */
@@ -215,7 +238,7 @@ struct rfc5444_reader_addrblock_entry {
   struct list_entity list_node;
 
   /*! corresponding tlv block */
-  struct avl_tree tlvblock;
+  struct rfc5444_reader_tlvblock tlvblock;
 
   /*! number of addresses */
   uint8_t num_addr;
@@ -326,6 +349,9 @@ struct rfc5444_reader_tlvblock_consumer {
   /*! List of sorted consumer entries */
   struct list_entity _consumer_list;
 
+  /*! bitmap of all TLV types referenced by the consumer entries */
+  struct bitmap256 _tlv_types;
+
   /* consumer for TLVblock context start and end*/
   /**
    * Callback triggered at the start of this context
@@ -369,6 +395,41 @@ struct rfc5444_reader_tlvblock_consumer {
       struct rfc5444_reader_tlvblock_context *context);
 };
 
+/**
+ * single memory chunk of a reader arena
+ */
+struct rfc5444_reader_arena_chunk {
+  /*! hook into list of arena chunks */
+  struct list_entity _node;
+
+  /*! usable bytes after the chunk header */
+  size_t size;
+
+  /*! bytes allocated in this chunk */
+  size_t used;
+};
+
+/**
+ * Bump allocator for the address blocks and TLVs of a single packet.
+ * All memory is released at once when the next packet is parsed.
+ */
+struct rfc5444_reader_arena {
+  /*! size of a newly allocated chunk, 0 for default */
+  size_t chunk_size;
+
+  /*! number of bytes allocated for the current packet */
+  size_t used;
+
+  /*! highest number of bytes allocated for a single packet */
+  size_t high_water;
+
+  /*! list of allocated chunks */
+  struct list_entity _chunks;
+
+  /*! chunk used for the next allocation */
+  struct rfc5444_reader_arena_chunk *_current;
+};
+
 /**
  * representation of the internal state of a rfc5444 parser
  */
@@ -379,6 +440,18 @@ struct rfc5444_reader {
   /*! sorted tree of message/addr consumers */
   struct avl_tree message_consumer;
 
+  /**
+   * message/addr consumers compiled from the message_consumer tree,
+   * grouped by message type and sorted like the tree
+   */
+  struct rfc5444_reader_tlvblock_consumer **_dispatch;
+
+  /*! index of the first consumer of each message type in _dispatch */
+  uint32_t _dispatch_start[257];
+
+  /*! true if _dispatch must be rebuilt before the next packet */
+  bool _dispatch_dirty;
+
   /**
    * Callback triggered when a message should be forwarded
    * @param context message context
@@ -411,6 +484,16 @@ struct rfc5444_reader {
    * @param entry addressblock entry to free
    */
   void (*free_addrblock_entry)(struct rfc5444_reader_addrblock_entry *entry);
+
+  /**
+   * true to parse each packet into a per-packet arena instead of
+   * calling the malloc/free callbacks, must be set before
+   * rfc5444_reader_init() is called.
+   */
+  bool use_arena;
+
+  /*! per-packet memory arena, only used if use_arena is true */
+  struct rfc5444_reader_arena arena;
 };
 
 EXPORT void rfc5444_reader_init(struct rfc5444_reader *);
@@ -60,6 +60,7 @@ static void _register_addrtlvtype(struct rfc5444_writer *writer,
     struct rfc5444_writer_tlvtype *type);
 static void *_copy_addrtlv_value(struct rfc5444_writer *writer, const void *value, size_t length);
 static void _lazy_free_message(struct rfc5444_writer *writer, struct rfc5444_writer_message *msg);
+static void _free_addrcaches(struct rfc5444_writer_message *msg);
 static struct rfc5444_writer_message *_get_message(struct rfc5444_writer *writer, uint8_t msgid);
 static struct rfc5444_writer_address *_malloc_address_entry(void);
 static struct rfc5444_writer_addrtlv *_malloc_addrtlv_entry(void);
@@ -319,8 +320,12 @@ rfc5444_writer_unregister_addrtlvtype(struct rfc5444_writer *writer, struct rfc5
 
   if (tlvtype->_creator) {
     /* message specific address tlv, see if we need to remove the message itself */
+    rfc5444_writer_invalidate_addrcache(tlvtype->_creator, 0);
     _lazy_free_message(writer, tlvtype->_creator);
   }
+  else {
+    _rfc5444_writer_invalidate_all_addrcaches(writer);
+  }
 }
 
 /**
@@ -356,6 +361,9 @@ rfc5444_writer_register_msgcontentprovider(struct rfc5444_writer *writer,
   cpr->_provider_node.key = &cpr->priority;
 
   avl_insert(&msg->_provider_tree, &cpr->_provider_node);
+
+  /* new provider might add addresses */
+  rfc5444_writer_invalidate_addrcache(msg, 0);
   return 0;
 }
 
@@ -384,6 +392,7 @@ rfc5444_writer_unregister_content_provider(
     rfc5444_writer_unregister_addrtlvtype(writer, &addrtlvs[i]);
   }
   avl_remove(&cpr->creator->_provider_tree, &cpr->_provider_node);
+  rfc5444_writer_invalidate_addrcache(cpr->creator, 0);
   _lazy_free_message(writer, cpr->creator);
 }
 
@@ -445,12 +454,36 @@ rfc5444_writer_unregister_message(struct rfc5444_writer *writer,
 
   /* free addresses */
   _rfc5444_writer_free_addresses(writer, msg);
+  _free_addrcaches(msg);
 
   /* mark message as unregistered */
   msg->_registered = false;
   _lazy_free_message(writer, msg);
 }
 
+/**
+ * Drop the cached address section of a message. This must be
+ * called by the message creator each time the addresses or address
+ * tlvs generated by the addAddresses callbacks change.
+ * @param msg pointer to message object
+ * @param addr_len address length of the cache to drop,
+ *    0 to drop the caches of all address lengths
+ */
+void
+rfc5444_writer_invalidate_addrcache(
+    struct rfc5444_writer_message *msg, uint8_t addr_len) {
+  int i;
+
+  if (addr_len > 0 && addr_len <= RFC5444_MAX_ADDRLEN) {
+    msg->_addr_cache[addr_len - 1].valid = false;
+    return;
+  }
+
+  for (i=0; i<RFC5444_MAX_ADDRLEN; i++) {
+    msg->_addr_cache[i].valid = false;
+  }
+}
+
 /**
  * Registers a new post-processor
  * @param writer rfc5444 writer
@@ -631,6 +664,14 @@ static void
 _register_addrtlvtype(struct rfc5444_writer *writer,
     struct rfc5444_writer_message *msg,
     struct rfc5444_writer_tlvtype *tlvtype) {
+  /* a new tlvtype changes the binary address section */
+  if (msg) {
+    rfc5444_writer_invalidate_addrcache(msg, 0);
+  }
+  else {
+    _rfc5444_writer_invalidate_all_addrcaches(writer);
+  }
+
   /* initialize addrtlv fields */
   tlvtype->_creator = msg;
   tlvtype->_full_type = _get_fulltype(tlvtype->type, tlvtype->exttype);
@@ -694,6 +735,33 @@ _rfc5444_writer_free_addresses(struct rfc5444_writer *writer, struct rfc5444_wri
   writer->_addrtlv_used = 0;
 }
 
+/**
+ * Drop the cached address sections of all messages
+ * @param writer pointer to writer context
+ */
+void
+_rfc5444_writer_invalidate_all_addrcaches(struct rfc5444_writer *writer) {
+  struct rfc5444_writer_message *msg;
+
+  avl_for_each_element(&writer->_msgcreators, msg, _msgcreator_node) {
+    rfc5444_writer_invalidate_addrcache(msg, 0);
+  }
+}
+
+/**
+ * Free the memory of all cached address sections of a message
+ * @param msg pointer to message object
+ */
+static void
+_free_addrcaches(struct rfc5444_writer_message *msg) {
+  int i;
+
+  for (i=0; i<RFC5444_MAX_ADDRLEN; i++) {
+    free(msg->_addr_cache[i].data);
+    memset(&msg->_addr_cache[i], 0, sizeof(msg->_addr_cache[i]));
+  }
+}
+
 /**
  * Free message object if not in use anymore
  * @param writer pointer to writer context
@@ -706,6 +774,7 @@ _lazy_free_message(struct rfc5444_writer *writer, struct rfc5444_writer_message
       && list_is_empty(&msg->_msgspecific_tlvtype_head)
       && avl_is_empty(&msg->_provider_tree)) {
     avl_remove(&writer->_msgcreators, &msg->_msgcreator_node);
+    _free_addrcaches(msg);
     free(msg);
   }
 }
@@ -305,6 +305,24 @@ struct rfc5444_writer_target {
   size_t _bin_msgs_size;
 };
 
+/**
+ * Binary copy of the address section (address blocks including
+ * their tlvs) of the last unfragmented message of one address length
+ */
+struct rfc5444_writer_addrcache {
+  /*! encoded address section */
+  uint8_t *data;
+
+  /*! number of bytes in the encoded address section */
+  size_t size;
+
+  /*! number of bytes allocated for data */
+  size_t allocated;
+
+  /*! true if data can be used for the next message */
+  bool valid;
+};
+
 /**
  * This struct is allocated for each message type that can
  * be generated by the writer.
@@ -402,6 +420,21 @@ struct rfc5444_writer_message {
   /*! number of bytes necessary for addressblocks including tlvs */
   size_t _bin_addr_size;
 
+  /**
+   * true to reuse the address section of the last unfragmented
+   * message instead of calling the addAddresses callbacks.
+   * The message creator must call rfc5444_writer_invalidate_addrcache()
+   * each time the addresses or address tlvs would change.
+   * Not used for target specific messages.
+   */
+  bool use_addr_cache;
+
+  /*! cached address sections, indexed by address length - 1 */
+  struct rfc5444_writer_addrcache _addr_cache[RFC5444_MAX_ADDRLEN];
+
+  /*! number of messages generated from the address cache */
+  uint32_t addr_cache_hits;
+
   /*! custom user data */
   void *user;
 };
@@ -537,6 +570,13 @@ struct rfc5444_writer {
   /*! length of addrtlv buffer */
   size_t addrtlv_size;
 
+  /**
+   * true to sort the addresses of a message before compressing them
+   * and to skip the cost evaluation of head lengths that cannot
+   * continue the last address block
+   */
+  bool sorted_addr_compression;
+
   /**
    * Callback to notify an instance that a message was put into a
    * target buffer
@@ -676,6 +716,9 @@ EXPORT struct rfc5444_writer_message *rfc5444_writer_register_message(
 EXPORT void rfc5444_writer_unregister_message(struct rfc5444_writer *writer,
     struct rfc5444_writer_message *msg);
 
+EXPORT void rfc5444_writer_invalidate_addrcache(
+    struct rfc5444_writer_message *msg, uint8_t addr_len);
+
 EXPORT void rfc5444_writer_register_pkthandler(struct rfc5444_writer *writer,
     struct rfc5444_writer_pkthandler *pkt);
 EXPORT void rfc5444_writer_unregister_pkthandler(struct rfc5444_writer *writer,
@@ -714,6 +757,7 @@ EXPORT void rfc5444_writer_cleanup(struct rfc5444_writer *writer);
 
 /* internal functions that are not exported to the user */
 void _rfc5444_writer_free_addresses(struct rfc5444_writer *writer, struct rfc5444_writer_message *msg);
+void _rfc5444_writer_invalidate_all_addrcaches(struct rfc5444_writer *writer);
 void _rfc5444_writer_begin_packet(struct rfc5444_writer *writer, struct rfc5444_writer_target *target);
 
 /**
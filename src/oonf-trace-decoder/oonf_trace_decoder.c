@@ -0,0 +1,174 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "common/common_types.h"
+#include "common/trace_buffer.h"
+
+/*! maximum length of the text of a decoded event */
+#define EVENT_TEXT_LENGTH 4096
+
+static void _print_event(const struct trace_buffer *tb, const struct trace_event *event);
+static void _print_statistics(const struct trace_buffer *tb);
+
+/**
+ * Decodes a binary trace file into the text format of the
+ * logging system
+ * @param argc argument counter
+ * @param argv argument vector
+ * @return shell exit code
+ */
+int
+main(int argc, char **argv) {
+  struct trace_buffer_iterator iterator;
+  struct trace_buffer tb;
+  struct trace_event event;
+  struct stat st;
+  const char *file;
+  bool statistics;
+  void *mem;
+  int fd;
+
+  statistics = argc == 3 && strcmp(argv[1], "-s") == 0;
+  if (argc != 2 && !statistics) {
+    fprintf(stderr, "Usage: %s [-s] <tracefile>\n"
+        "  -s: only print statistics of trace file\n", argv[0]);
+    return 1;
+  }
+  file = argv[argc-1];
+
+  fd = open(file, O_RDONLY);
+  if (fd < 0 || fstat(fd, &st)) {
+    fprintf(stderr, "Cannot open trace file '%s': %s (%d)\n",
+        file, strerror(errno), errno);
+    return 1;
+  }
+
+  /* take a private snapshot of the file, it might still be written */
+  mem = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mem == MAP_FAILED) {
+    fprintf(stderr, "Cannot map trace file '%s': %s (%d)\n",
+        file, strerror(errno), errno);
+    return 1;
+  }
+
+  if (trace_buffer_attach(&tb, mem, st.st_size)) {
+    fprintf(stderr, "File '%s' is not a valid trace file\n", file);
+    munmap(mem, st.st_size);
+    return 1;
+  }
+
+  if (statistics) {
+    _print_statistics(&tb);
+  }
+  else {
+    trace_buffer_iterator_init(&tb, &iterator);
+    while (trace_buffer_iterator_next(&tb, &iterator, &event)) {
+      _print_event(&tb, &event);
+    }
+  }
+
+  munmap(mem, st.st_size);
+  return 0;
+}
+
+/**
+ * Print a trace event with the header of a logging event
+ * @param tb pointer to trace buffer
+ * @param event pointer to trace event
+ */
+static void
+_print_event(const struct trace_buffer *tb, const struct trace_event *event) {
+  struct trace_site site;
+  char text[EVENT_TEXT_LENGTH];
+  struct tm *tm;
+  time_t sec;
+
+  if (!trace_buffer_get_site(tb, &site, event->site_id)) {
+    printf("unknown trace site %u\n", event->site_id);
+    return;
+  }
+
+  trace_format(text, sizeof(text), site.format, event->args, event->arg_count);
+
+  sec = event->time.tv_sec;
+  tm = localtime(&sec);
+  if (tm != NULL) {
+    printf("%02d:%02d:%02d.%03ld", tm->tm_hour, tm->tm_min, tm->tm_sec,
+        (long)(event->time.tv_usec / 1000) % 1000);
+  }
+
+  /* remove \n at the end of the line like the logging core */
+  if (*text && text[strlen(text)-1] == '\n') {
+    text[strlen(text)-1] = 0;
+  }
+  printf(" %s(%s) %s %d: %s\n", site.severity, site.source, site.file, site.line, text);
+}
+
+/**
+ * Print statistics of a trace file
+ * @param tb pointer to trace buffer
+ */
+static void
+_print_statistics(const struct trace_buffer *tb) {
+  const struct trace_buffer_header *header = tb->header;
+
+  printf("Sites:              %u\n", header->site_count);
+  printf("Site space:         %u/%u\n", header->site_used, header->site_size);
+  printf("Lost sites:         %u\n", header->site_lost);
+  printf("Event buffer:       %u\n", header->event_size);
+  printf("Events written:     %"PRIu64"\n", header->event_count);
+  printf("Events overwritten: %"PRIu64"\n", header->event_overwritten);
+}
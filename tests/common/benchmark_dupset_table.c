@@ -0,0 +1,381 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ *
+ * Benchmark for the duplicate set backends, compares the AVL tree with
+ * one allocated entry and one validity timer per originator against the
+ * open addressing hash table with inline entries and a periodic sweep.
+ *
+ * Every originator floods one message per second, each message is
+ * received over multiple neighbors, similar to TC forwarding in a dense
+ * mesh. Validity timers are modeled with a timer wheel like the default
+ * scheduler of the timer subsystem.
+ *
+ * Usage: benchmark_dupset_table [<originators> [<seconds> [<copies>]]]
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "common/avl.h"
+#include "common/avl_comp.h"
+#include "common/container_of.h"
+#include "common/dupset_table.h"
+#include "common/netaddr.h"
+#include "common/timer_wheel.h"
+
+/* timeslice of the scheduler in milliseconds */
+#define SLICE 100
+
+/* validity time of a duplicate entry in milliseconds */
+#define VTIME 30000
+
+/* interval between two sweeps of the hashed set in milliseconds */
+#define SWEEP_INTERVAL 1000
+
+/* percentage of originators which stop sending after half of the time */
+#define LOST_PCT 10
+
+/* message type used for all sequence numbers */
+#define MSG_TYPE 1
+
+struct bench_key {
+  struct netaddr addr;
+  uint8_t msg_type;
+};
+
+struct bench_entry {
+  struct bench_key key;
+  struct dupset_window window;
+
+  struct avl_node _node;
+  struct timer_wheel_node _vtime;
+};
+
+struct bench_result {
+  uint64_t flood, expire;
+  uint32_t new, duplicate, removed;
+};
+
+static struct netaddr *_originators;
+static uint32_t *_order;
+static uint32_t _originator_count, _seconds, _copies;
+
+static bool _test(struct dupset_window *, uint64_t seqno);
+static int _avl_cmp_key(const void *, const void *);
+static void _run_avl(struct bench_result *);
+static void _run_hash(struct bench_result *);
+static bool _is_sending(uint32_t originator, uint32_t second);
+static uint64_t _get_usec(void);
+
+/**
+ * Simplified duplicate check, seqno must be newer or within the window
+ * @param window sequence number window
+ * @param seqno sequence number
+ * @return true if sequence number is new, false if duplicate
+ */
+static bool
+_test(struct dupset_window *window, uint64_t seqno) {
+  uint64_t bit;
+
+  if (seqno > window->current) {
+    window->history = (window->history << (seqno - window->current)) | 1;
+    window->current = seqno;
+    return true;
+  }
+
+  bit = 1ull << (window->current - seqno);
+  if (window->history & bit) {
+    return false;
+  }
+  window->history |= bit;
+  return true;
+}
+
+/**
+ * Comparator for benchmark keys, same as the duplicate set subsystem
+ * @param p1 key1
+ * @param p2 key2
+ * @return <0 if p1<p2, 0 if p1==p2, >0 if p1>p2
+ */
+static int
+_avl_cmp_key(const void *p1, const void *p2) {
+  const struct bench_key *k1 = p1, *k2 = p2;
+
+  if (k1->msg_type != k2->msg_type) {
+    return (int)(k1->msg_type) - (int)(k2->msg_type);
+  }
+  return avl_comp_netaddr(&k1->addr, &k2->addr);
+}
+
+/**
+ * Run benchmark with an AVL tree and one timer per entry
+ * @param result pointer to result
+ */
+static void
+_run_avl(struct bench_result *result) {
+  static struct timer_wheel wheel;
+  struct avl_tree tree;
+  struct bench_entry *entry, *it;
+  struct bench_key key;
+  uint64_t now, start;
+  uint32_t s, c, i, o;
+
+  memset(result, 0, sizeof(*result));
+  avl_init(&tree, _avl_cmp_key, false);
+
+  now = 0;
+  timer_wheel_init(&wheel, now / SLICE);
+
+  for (s=0; s<_seconds; s++) {
+    start = _get_usec();
+    for (c=0; c<_copies; c++) {
+      for (i=0; i<_originator_count; i++) {
+        o = _order[(i + c * 7919) % _originator_count];
+        if (!_is_sending(o, s)) {
+          continue;
+        }
+
+        memcpy(&key.addr, &_originators[o], sizeof(key.addr));
+        key.msg_type = MSG_TYPE;
+
+        entry = avl_find_element(&tree, &key, entry, _node);
+        if (!entry) {
+          entry = calloc(1, sizeof(*entry));
+          memcpy(&entry->key, &key, sizeof(key));
+          entry->window.current = s;
+          entry->window.history = 1;
+          entry->_node.key = &entry->key;
+          avl_insert(&tree, &entry->_node);
+        }
+        else if (!_test(&entry->window, s)) {
+          result->duplicate++;
+          continue;
+        }
+
+        result->new++;
+        if (timer_wheel_is_node_added(&entry->_vtime)) {
+          timer_wheel_remove(&wheel, &entry->_vtime);
+        }
+        timer_wheel_insert(&wheel, &entry->_vtime, (now + VTIME) / SLICE);
+      }
+    }
+    result->flood += _get_usec() - start;
+
+    /* run all timer slices of this second */
+    start = _get_usec();
+    for (i=0; i<SWEEP_INTERVAL/SLICE; i++) {
+      now += SLICE;
+      while ((entry = timer_wheel_get_expired_element(
+          &wheel, now / SLICE, entry, _vtime)) != NULL) {
+        timer_wheel_remove(&wheel, &entry->_vtime);
+        avl_remove(&tree, &entry->_node);
+        free(entry);
+        result->removed++;
+      }
+    }
+    result->expire += _get_usec() - start;
+  }
+
+  avl_for_each_element_safe(&tree, entry, _node, it) {
+    avl_remove(&tree, &entry->_node);
+    free(entry);
+  }
+}
+
+/**
+ * Run benchmark with an open addressing hash table and a periodic sweep
+ * @param result pointer to result
+ */
+static void
+_run_hash(struct bench_result *result) {
+  struct dupset_table table;
+  struct dupset_table_entry *entry;
+  uint64_t now, start;
+  uint32_t s, c, i, o;
+
+  memset(result, 0, sizeof(*result));
+  dupset_table_init(&table);
+
+  now = 0;
+  for (s=0; s<_seconds; s++) {
+    start = _get_usec();
+    for (c=0; c<_copies; c++) {
+      for (i=0; i<_originator_count; i++) {
+        o = _order[(i + c * 7919) % _originator_count];
+        if (!_is_sending(o, s)) {
+          continue;
+        }
+
+        entry = dupset_table_get(&table, MSG_TYPE, &_originators[o]);
+        if (!entry) {
+          entry = dupset_table_insert(&table, MSG_TYPE, &_originators[o]);
+          entry->window.current = s;
+          entry->window.history = 1;
+        }
+        else if (!_test(&entry->window, s)) {
+          result->duplicate++;
+          continue;
+        }
+
+        result->new++;
+        entry->expire = (now + VTIME) / SLICE * SLICE;
+      }
+    }
+    result->flood += _get_usec() - start;
+
+    /* one sweep per second */
+    start = _get_usec();
+    now += SWEEP_INTERVAL;
+    result->removed += dupset_table_expire(&table, now);
+    result->expire += _get_usec() - start;
+  }
+
+  dupset_table_free(&table);
+}
+
+/**
+ * @param originator index of originator
+ * @param second current second of the benchmark
+ * @return true if originator is sending messages
+ */
+static bool
+_is_sending(uint32_t originator, uint32_t second) {
+  return second < _seconds / 2 || originator % 100 >= LOST_PCT;
+}
+
+/**
+ * @return monotonic time in microseconds
+ */
+static uint64_t
+_get_usec(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000ull + (uint64_t)ts.tv_nsec / 1000ull;
+}
+
+int
+main(int argc, char **argv) {
+  struct bench_result avl, hash;
+  uint8_t addr[16];
+  uint32_t i, j, tmp;
+
+  _originator_count = 5000;
+  _seconds = 120;
+  _copies = 4;
+
+  if (argc > 1) {
+    _originator_count = (uint32_t)strtoul(argv[1], NULL, 10);
+  }
+  if (argc > 2) {
+    _seconds = (uint32_t)strtoul(argv[2], NULL, 10);
+  }
+  if (argc > 3) {
+    _copies = (uint32_t)strtoul(argv[3], NULL, 10);
+  }
+  if (_originator_count == 0 || _seconds == 0 || _copies == 0) {
+    fprintf(stderr, "Usage: %s [<originators> [<seconds> [<copies>]]]\n", argv[0]);
+    return 1;
+  }
+
+  _originators = calloc(_originator_count, sizeof(*_originators));
+  _order = calloc(_originator_count, sizeof(*_order));
+  if (!_originators || !_order) {
+    fprintf(stderr, "Out of memory\n");
+    return 1;
+  }
+
+  /* unique IPv6 originators in a /64, sent in random order */
+  memset(addr, 0, sizeof(addr));
+  addr[0] = 0x20;
+  addr[1] = 0x01;
+  addr[2] = 0x0d;
+  addr[3] = 0xb8;
+
+  srand(42);
+  for (i=0; i<_originator_count; i++) {
+    addr[12] = (uint8_t)(i >> 24);
+    addr[13] = (uint8_t)(i >> 16);
+    addr[14] = (uint8_t)(i >> 8);
+    addr[15] = (uint8_t)i;
+    addr[8] = (uint8_t)rand();
+    netaddr_from_binary(&_originators[i], addr, 16, AF_INET6);
+
+    _order[i] = i;
+  }
+  for (i=_originator_count-1; i>0; i--) {
+    j = (uint32_t)rand() % (i+1);
+    tmp = _order[i];
+    _order[i] = _order[j];
+    _order[j] = tmp;
+  }
+
+  _run_avl(&avl);
+  _run_hash(&hash);
+
+  if (avl.new != hash.new || avl.duplicate != hash.duplicate
+      || avl.removed != hash.removed) {
+    fprintf(stderr, "Result mismatch: new %u/%u duplicate %u/%u removed %u/%u\n",
+        avl.new, hash.new, avl.duplicate, hash.duplicate, avl.removed, hash.removed);
+    return 1;
+  }
+
+  printf("%u originators, %u seconds, %u copies per message\n",
+      _originator_count, _seconds, _copies);
+  printf("%u new, %u duplicates, %u timed out\n",
+      avl.new, avl.duplicate, avl.removed);
+  printf("%8s %12s %12s %14s\n", "backend", "flood (us)", "expire (us)", "per msg (ns)");
+  printf("%8s %12llu %12llu %14.1f\n", "avl", (unsigned long long)avl.flood,
+      (unsigned long long)avl.expire,
+      1000.0 * (avl.flood + avl.expire) / (avl.new + avl.duplicate));
+  printf("%8s %12llu %12llu %14.1f\n", "hash", (unsigned long long)hash.flood,
+      (unsigned long long)hash.expire,
+      1000.0 * (hash.flood + hash.expire) / (hash.new + hash.duplicate));
+
+  free(_originators);
+  free(_order);
+  return 0;
+}
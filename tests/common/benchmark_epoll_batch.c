@@ -0,0 +1,280 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ *
+ * Synthetic benchmark for the socket scheduler event loop with many
+ * active sockets. It compares the old scheduler behaviour (16 events
+ * per epoll_wait() call, one read per event and a clock read after
+ * each callback) with a larger event array and with edge-triggered
+ * sockets that are drained until EAGAIN, both reading the clock once
+ * per batch of events.
+ *
+ * Usage: benchmark_epoll_batch [<sockets> [<rounds> [<packets> [<batch>]]]]
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+
+#include "common/common_types.h"
+
+/* size of the event array of the old scheduler */
+#define LEGACY_BATCH 16
+
+/* size of a test datagram */
+#define PACKET_SIZE 64
+
+struct bench_mode {
+  const char *name;
+  int batch;
+  bool edge;
+  bool clock_per_callback;
+};
+
+struct bench_result {
+  uint64_t runtime;
+  uint64_t waits;
+  uint64_t reads;
+  uint64_t clock_reads;
+  uint64_t packets;
+};
+
+static uint32_t _socket_count;
+static uint32_t _rounds;
+static uint32_t _packets;
+static int _batch;
+
+/* receiving (even index) and sending (odd index) end of each pair */
+static int *_fds;
+
+static struct epoll_event *_events;
+
+/**
+ * @return monotonic time in microseconds
+ */
+static uint64_t
+_get_usec(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000ull + (uint64_t)ts.tv_nsec / 1000ull;
+}
+
+/**
+ * Read datagrams from a socket
+ * @param fd file descriptor
+ * @param drain true to read until EAGAIN, false for a single read
+ * @param result benchmark result for statistics
+ */
+static void
+_read_socket(int fd, bool drain, struct bench_result *result) {
+  char buffer[PACKET_SIZE];
+  ssize_t len;
+
+  do {
+    len = recv(fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+    result->reads++;
+    if (len > 0) {
+      result->packets++;
+    }
+  } while (drain && len > 0);
+}
+
+/**
+ * Run the event loop in one mode
+ * @param mode scheduler mode
+ * @param result benchmark result
+ * @return -1 if an error happened, 0 otherwise
+ */
+static int
+_run(const struct bench_mode *mode, struct bench_result *result) {
+  struct epoll_event event;
+  char buffer[PACKET_SIZE];
+  uint64_t expected, start;
+  uint32_t r, s, p;
+  int epoll_fd, i, n;
+
+  memset(result, 0, sizeof(*result));
+  memset(buffer, 0, sizeof(buffer));
+
+  epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  if (epoll_fd < 0) {
+    return -1;
+  }
+
+  for (s=0; s<_socket_count; s++) {
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN | (mode->edge ? EPOLLET : 0);
+    event.data.fd = _fds[s*2];
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, _fds[s*2], &event)) {
+      close(epoll_fd);
+      return -1;
+    }
+  }
+
+  expected = 0;
+  for (r=0; r<_rounds; r++) {
+    for (p=0; p<_packets; p++) {
+      for (s=0; s<_socket_count; s++) {
+        if (send(_fds[s*2+1], buffer, sizeof(buffer), MSG_DONTWAIT) > 0) {
+          expected++;
+        }
+      }
+    }
+
+    start = _get_usec();
+    while (result->packets < expected) {
+      n = epoll_wait(epoll_fd, _events, mode->batch, 0);
+      result->waits++;
+      if (n < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        close(epoll_fd);
+        return -1;
+      }
+
+      /* timestamp for the whole batch */
+      _get_usec();
+      result->clock_reads++;
+
+      for (i=0; i<n; i++) {
+        _read_socket(_events[i].data.fd, mode->edge, result);
+
+        if (mode->clock_per_callback) {
+          _get_usec();
+          result->clock_reads++;
+        }
+      }
+    }
+    result->runtime += _get_usec() - start;
+  }
+
+  close(epoll_fd);
+  return 0;
+}
+
+int
+main(int argc, char **argv) {
+  struct bench_mode modes[3];
+  struct bench_result result;
+  uint32_t s;
+  size_t m;
+
+  _socket_count = 256;
+  _rounds = 200;
+  _packets = 4;
+  _batch = 256;
+
+  if (argc > 1) {
+    _socket_count = (uint32_t)strtoul(argv[1], NULL, 10);
+  }
+  if (argc > 2) {
+    _rounds = (uint32_t)strtoul(argv[2], NULL, 10);
+  }
+  if (argc > 3) {
+    _packets = (uint32_t)strtoul(argv[3], NULL, 10);
+  }
+  if (argc > 4) {
+    _batch = (int)strtol(argv[4], NULL, 10);
+  }
+  if (_socket_count == 0 || _rounds == 0 || _packets == 0 || _batch < LEGACY_BATCH) {
+    fprintf(stderr, "Usage: %s [<sockets> [<rounds> [<packets> [<batch>]]]]\n", argv[0]);
+    return 1;
+  }
+
+  _fds = calloc(_socket_count * 2, sizeof(*_fds));
+  _events = calloc(_batch, sizeof(*_events));
+  if (!_fds || !_events) {
+    fprintf(stderr, "Out of memory\n");
+    return 1;
+  }
+
+  for (s=0; s<_socket_count; s++) {
+    if (socketpair(AF_UNIX, SOCK_DGRAM, 0, &_fds[s*2])) {
+      fprintf(stderr, "Cannot create socket pair %u: %s (%d)\n", s, strerror(errno), errno);
+      return 1;
+    }
+  }
+
+  modes[0].name = "level";
+  modes[0].batch = LEGACY_BATCH;
+  modes[0].edge = false;
+  modes[0].clock_per_callback = true;
+
+  modes[1].name = "level";
+  modes[1].batch = _batch;
+  modes[1].edge = false;
+  modes[1].clock_per_callback = false;
+
+  modes[2].name = "edge";
+  modes[2].batch = _batch;
+  modes[2].edge = true;
+  modes[2].clock_per_callback = false;
+
+  printf("%u sockets, %u rounds with %u packets per socket\n",
+      _socket_count, _rounds, _packets);
+  printf("%6s %6s %12s %10s %10s %12s\n",
+      "mode", "batch", "runtime (us)", "waits", "reads", "clock reads");
+  for (m=0; m<ARRAYSIZE(modes); m++) {
+    if (_run(&modes[m], &result)) {
+      fprintf(stderr, "Benchmark '%s' failed: %s (%d)\n", modes[m].name, strerror(errno), errno);
+      return 1;
+    }
+    printf("%6s %6d %12llu %10llu %10llu %12llu\n", modes[m].name, modes[m].batch,
+        (unsigned long long)result.runtime, (unsigned long long)result.waits,
+        (unsigned long long)result.reads, (unsigned long long)result.clock_reads);
+  }
+
+  for (s=0; s<_socket_count*2; s++) {
+    close(_fds[s]);
+  }
+  free(_fds);
+  free(_events);
+  return 0;
+}
@@ -0,0 +1,287 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ *
+ * Benchmark for longest prefix matches, compares a linear scan with
+ * netaddr_is_in_subnet() (like the old layer2 neighbor and ACL lookups)
+ * against the netaddr trie on random IPv4 and IPv6 prefixes.
+ *
+ * Usage: benchmark_netaddr_trie [<minimum prefixes> [<maximum prefixes> [<lookups>]]]
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "common/netaddr.h"
+#include "common/netaddr_trie.h"
+
+struct bench_prefix {
+  struct netaddr prefix;
+  struct netaddr_trie_node node;
+};
+
+static struct bench_prefix *_prefixes;
+static struct netaddr *_lookups;
+static uint32_t _prefix_count, _lookup_count;
+
+static void _create_prefixes(uint32_t count);
+static void _create_lookups(uint32_t count);
+static void _random_addr(struct netaddr *addr, bool ipv6);
+static uint64_t _run_scan(void);
+static uint64_t _run_trie(struct netaddr_trie *trie);
+static uint64_t _get_usec(void);
+
+/**
+ * Create random prefixes, every fourth one is IPv6
+ * @param count number of prefixes
+ */
+static void
+_create_prefixes(uint32_t count) {
+  uint32_t i;
+
+  _prefix_count = count;
+  _prefixes = calloc(count, sizeof(*_prefixes));
+  if (!_prefixes) {
+    fprintf(stderr, "Out of memory\n");
+    exit(1);
+  }
+
+  for (i=0; i<count; i++) {
+    _random_addr(&_prefixes[i].prefix, (i % 4) == 3);
+    if (netaddr_get_address_family(&_prefixes[i].prefix) == AF_INET) {
+      _prefixes[i].prefix._prefix_len = (uint8_t)(16 + rand() % 17);
+    }
+    else {
+      _prefixes[i].prefix._prefix_len = (uint8_t)(32 + rand() % 97);
+    }
+    _prefixes[i].node.key = &_prefixes[i].prefix;
+  }
+}
+
+/**
+ * Create random lookup addresses, half of them inside a known prefix
+ * @param count number of lookups
+ */
+static void
+_create_lookups(uint32_t count) {
+  struct netaddr *prefix;
+  uint32_t i;
+  uint8_t bits, byte;
+
+  _lookup_count = count;
+  _lookups = calloc(count, sizeof(*_lookups));
+  if (!_lookups) {
+    fprintf(stderr, "Out of memory\n");
+    exit(1);
+  }
+
+  for (i=0; i<count; i++) {
+    prefix = &_prefixes[(uint32_t)rand() % _prefix_count].prefix;
+    _random_addr(&_lookups[i], netaddr_get_address_family(prefix) == AF_INET6);
+
+    if (i % 2) {
+      /* copy the network part of a prefix */
+      bits = netaddr_get_prefix_length(prefix);
+      memcpy(_lookups[i]._addr, prefix->_addr, bits / 8);
+      if (bits % 8) {
+        byte = (uint8_t)(0xff << (8 - bits % 8));
+        _lookups[i]._addr[bits / 8] = (prefix->_addr[bits / 8] & byte)
+            | (_lookups[i]._addr[bits / 8] & ~byte);
+      }
+    }
+  }
+}
+
+/**
+ * Create a random host address from a small address range
+ * @param addr pointer to target address
+ * @param ipv6 true for an IPv6 address, false for IPv4
+ */
+static void
+_random_addr(struct netaddr *addr, bool ipv6) {
+  size_t i;
+
+  memset(addr, 0, sizeof(*addr));
+  addr->_type = ipv6 ? AF_INET6 : AF_INET;
+  addr->_prefix_len = netaddr_get_af_maxprefix(addr->_type);
+
+  for (i=0; i<addr->_prefix_len / 8u; i++) {
+    addr->_addr[i] = (uint8_t)rand();
+  }
+
+  /* keep all addresses in a /8 (IPv4) or /16 (IPv6) */
+  addr->_addr[0] = ipv6 ? 0x20 : 10;
+  if (ipv6) {
+    addr->_addr[1] = 0x01;
+  }
+}
+
+/**
+ * Look up all addresses with a linear scan over the prefixes
+ * @return sum of the prefix lengths of all matches
+ */
+static uint64_t
+_run_scan(void) {
+  struct bench_prefix *best;
+  uint64_t sum;
+  uint32_t i, j;
+
+  sum = 0;
+  for (i=0; i<_lookup_count; i++) {
+    best = NULL;
+    for (j=0; j<_prefix_count; j++) {
+      if (netaddr_is_in_subnet(&_prefixes[j].prefix, &_lookups[i])
+          && (best == NULL || netaddr_get_prefix_length(&best->prefix)
+              < netaddr_get_prefix_length(&_prefixes[j].prefix))) {
+        best = &_prefixes[j];
+      }
+    }
+    if (best) {
+      sum += netaddr_get_prefix_length(&best->prefix);
+    }
+  }
+  return sum;
+}
+
+/**
+ * Look up all addresses in a netaddr trie
+ * @param trie pointer to trie with all prefixes
+ * @return sum of the prefix lengths of all matches
+ */
+static uint64_t
+_run_trie(struct netaddr_trie *trie) {
+  struct bench_prefix *best;
+  uint64_t sum;
+  uint32_t i;
+
+  sum = 0;
+  for (i=0; i<_lookup_count; i++) {
+    best = netaddr_trie_find_lpm_element(trie, &_lookups[i], best, node);
+    if (best) {
+      sum += netaddr_get_prefix_length(&best->prefix);
+    }
+  }
+  return sum;
+}
+
+/**
+ * @return monotonic time in microseconds
+ */
+static uint64_t
+_get_usec(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000ull + (uint64_t)ts.tv_nsec / 1000ull;
+}
+
+int
+main(int argc, char **argv) {
+  uint32_t min_prefixes = 16, max_prefixes = 4096, lookups = 100000;
+  uint32_t count, i;
+  uint64_t start, scan_time, trie_time, build_time, scan_sum, trie_sum;
+  struct netaddr_trie trie;
+
+  if (argc > 1) {
+    min_prefixes = (uint32_t)strtoul(argv[1], NULL, 10);
+  }
+  if (argc > 2) {
+    max_prefixes = (uint32_t)strtoul(argv[2], NULL, 10);
+  }
+  if (argc > 3) {
+    lookups = (uint32_t)strtoul(argv[3], NULL, 10);
+  }
+  if (min_prefixes < 1 || max_prefixes < min_prefixes || lookups == 0) {
+    fprintf(stderr, "Usage: %s [<minimum prefixes> [<maximum prefixes> [<lookups>]]]\n", argv[0]);
+    return 1;
+  }
+
+  srand(42);
+
+  printf("%8s %12s %12s %12s %8s\n", "prefixes", "build (us)", "scan (us)", "trie (us)", "speedup");
+  for (count = min_prefixes; count <= max_prefixes; count *= 2) {
+    _create_prefixes(count);
+    _create_lookups(lookups);
+
+    start = _get_usec();
+    netaddr_trie_init(&trie, true);
+    for (i=0; i<count; i++) {
+      if (netaddr_trie_insert(&trie, &_prefixes[i].node)) {
+        fprintf(stderr, "Could not insert prefix %u\n", i);
+        return 1;
+      }
+    }
+    build_time = _get_usec() - start;
+
+    start = _get_usec();
+    scan_sum = _run_scan();
+    scan_time = _get_usec() - start;
+
+    start = _get_usec();
+    trie_sum = _run_trie(&trie);
+    trie_time = _get_usec() - start;
+
+    if (scan_sum != trie_sum) {
+      fprintf(stderr, "Match mismatch for %u prefixes: %llu != %llu\n", count,
+          (unsigned long long)scan_sum, (unsigned long long)trie_sum);
+      return 1;
+    }
+
+    printf("%8u %12llu %12llu %12llu %7.2fx\n", count,
+        (unsigned long long)build_time,
+        (unsigned long long)scan_time,
+        (unsigned long long)trie_time,
+        trie_time ? (double)scan_time / (double)trie_time : 0.0);
+
+    netaddr_trie_clear(&trie);
+    free(_prefixes);
+    free(_lookups);
+
+    if (count < max_prefixes && count * 2 > max_prefixes) {
+      count = max_prefixes / 2;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,307 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ *
+ * Benchmark for the dijkstra working queue, compares the AVL tree
+ * (with duplicate keys) against the radix heap on random graphs
+ * similar to an OLSRv2 topology database.
+ *
+ * Usage: benchmark_radix_heap [<minimum nodes> [<maximum nodes> [<rounds>]]]
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "common/avl.h"
+#include "common/avl_comp.h"
+#include "common/radix_heap.h"
+
+/* average number of edges per node */
+#define EDGES_PER_NODE 8
+
+/* linkcost range of a generated edge */
+#define COST_MIN   1024
+#define COST_RANGE 8192
+
+struct bench_node {
+  /* edges of node */
+  uint32_t first_edge, edge_count;
+
+  /* path cost and state of dijkstra */
+  uint32_t cost;
+  bool done;
+
+  /* working queue hooks */
+  struct avl_node avl;
+  struct radix_heap_node heap;
+};
+
+struct bench_edge {
+  uint32_t dst;
+  uint32_t cost;
+};
+
+static struct bench_node *_nodes;
+static struct bench_edge *_edges;
+static uint32_t _node_count;
+
+static void _create_graph(uint32_t count);
+static void _reset_graph(void);
+static uint64_t _run_avl(void);
+static uint64_t _run_radix(void);
+static uint64_t _get_usec(void);
+
+/**
+ * Create a random graph with a fixed number of edges for each node
+ * @param count number of nodes
+ */
+static void
+_create_graph(uint32_t count) {
+  uint32_t i, j;
+
+  _node_count = count;
+  _nodes = calloc(count, sizeof(*_nodes));
+  _edges = calloc(count * EDGES_PER_NODE, sizeof(*_edges));
+  if (!_nodes || !_edges) {
+    fprintf(stderr, "Out of memory\n");
+    exit(1);
+  }
+
+  for (i=0; i<count; i++) {
+    _nodes[i].first_edge = i * EDGES_PER_NODE;
+    _nodes[i].edge_count = EDGES_PER_NODE;
+
+    for (j=0; j<EDGES_PER_NODE; j++) {
+      /* mostly local links, some long range links */
+      if (j < EDGES_PER_NODE - 2) {
+        _edges[i * EDGES_PER_NODE + j].dst =
+            (i + count + (uint32_t)(rand() % 33) - 16) % count;
+      }
+      else {
+        _edges[i * EDGES_PER_NODE + j].dst = (uint32_t)rand() % count;
+      }
+      _edges[i * EDGES_PER_NODE + j].cost = COST_MIN + (uint32_t)(rand() % COST_RANGE);
+    }
+  }
+}
+
+/**
+ * Reset dijkstra state of all nodes
+ */
+static void
+_reset_graph(void) {
+  uint32_t i;
+
+  for (i=0; i<_node_count; i++) {
+    _nodes[i].cost = UINT32_MAX;
+    _nodes[i].done = false;
+    _nodes[i].avl.key = &_nodes[i].cost;
+    _nodes[i].avl.list.next = NULL;
+    _nodes[i].avl.list.prev = NULL;
+    list_init_node(&_nodes[i].heap._list);
+  }
+}
+
+/**
+ * Run dijkstra with an AVL tree as working queue
+ * @return sum of all path costs
+ */
+static uint64_t
+_run_avl(void) {
+  struct avl_tree tree;
+  struct bench_node *node, *dst;
+  struct bench_edge *edge;
+  uint64_t sum;
+  uint32_t i, cost;
+
+  avl_init(&tree, avl_comp_uint32, true);
+
+  _nodes[0].cost = 0;
+  avl_insert(&tree, &_nodes[0].avl);
+
+  sum = 0;
+  while (!avl_is_empty(&tree)) {
+    node = avl_first_element(&tree, node, avl);
+    avl_remove(&tree, &node->avl);
+
+    node->done = true;
+    sum += node->cost;
+
+    for (i=0; i<node->edge_count; i++) {
+      edge = &_edges[node->first_edge + i];
+      dst = &_nodes[edge->dst];
+      cost = node->cost + edge->cost;
+
+      if (dst->done || cost >= dst->cost) {
+        continue;
+      }
+
+      if (avl_is_node_added(&dst->avl)) {
+        avl_remove(&tree, &dst->avl);
+      }
+      dst->cost = cost;
+      avl_insert(&tree, &dst->avl);
+    }
+  }
+  return sum;
+}
+
+/**
+ * Run dijkstra with a radix heap as working queue
+ * @return sum of all path costs
+ */
+static uint64_t
+_run_radix(void) {
+  struct radix_heap heap;
+  struct bench_node *node, *dst;
+  struct bench_edge *edge;
+  uint64_t sum;
+  uint32_t i, cost;
+
+  radix_heap_init(&heap);
+
+  _nodes[0].cost = 0;
+  radix_heap_insert(&heap, &_nodes[0].heap, 0);
+
+  sum = 0;
+  while ((node = radix_heap_extract_min_element(&heap, node, heap)) != NULL) {
+    node->done = true;
+    sum += node->cost;
+
+    for (i=0; i<node->edge_count; i++) {
+      edge = &_edges[node->first_edge + i];
+      dst = &_nodes[edge->dst];
+      cost = node->cost + edge->cost;
+
+      if (dst->done || cost >= dst->cost) {
+        continue;
+      }
+
+      dst->cost = cost;
+      if (radix_heap_is_node_added(&dst->heap)) {
+        radix_heap_decrease_key(&heap, &dst->heap, cost);
+      }
+      else {
+        radix_heap_insert(&heap, &dst->heap, cost);
+      }
+    }
+  }
+  return sum;
+}
+
+/**
+ * @return monotonic time in microseconds
+ */
+static uint64_t
+_get_usec(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000ull + (uint64_t)ts.tv_nsec / 1000ull;
+}
+
+int
+main(int argc, char **argv) {
+  uint32_t min_nodes = 1000, max_nodes = 10000, rounds = 20;
+  uint32_t count, r;
+  uint64_t start, avl_time, radix_time, avl_sum, radix_sum;
+
+  if (argc > 1) {
+    min_nodes = (uint32_t)strtoul(argv[1], NULL, 10);
+  }
+  if (argc > 2) {
+    max_nodes = (uint32_t)strtoul(argv[2], NULL, 10);
+  }
+  if (argc > 3) {
+    rounds = (uint32_t)strtoul(argv[3], NULL, 10);
+  }
+  if (min_nodes < 2 || max_nodes < min_nodes || rounds == 0) {
+    fprintf(stderr, "Usage: %s [<minimum nodes> [<maximum nodes> [<rounds>]]]\n", argv[0]);
+    return 1;
+  }
+
+  srand(42);
+
+  printf("%8s %12s %12s %8s\n", "nodes", "avl (us)", "radix (us)", "speedup");
+  for (count = min_nodes; count <= max_nodes; count *= 2) {
+    _create_graph(count);
+
+    avl_time = 0;
+    radix_time = 0;
+    avl_sum = 0;
+    radix_sum = 0;
+
+    for (r=0; r<rounds; r++) {
+      _reset_graph();
+      start = _get_usec();
+      avl_sum = _run_avl();
+      avl_time += _get_usec() - start;
+
+      _reset_graph();
+      start = _get_usec();
+      radix_sum = _run_radix();
+      radix_time += _get_usec() - start;
+    }
+
+    if (avl_sum != radix_sum) {
+      fprintf(stderr, "Path cost mismatch for %u nodes: %llu != %llu\n", count,
+          (unsigned long long)avl_sum, (unsigned long long)radix_sum);
+      return 1;
+    }
+
+    printf("%8u %12llu %12llu %7.2fx\n", count,
+        (unsigned long long)(avl_time / rounds),
+        (unsigned long long)(radix_time / rounds),
+        radix_time ? (double)avl_time / (double)radix_time : 0.0);
+
+    free(_nodes);
+    free(_edges);
+
+    if (count < max_nodes && count * 2 > max_nodes) {
+      count = max_nodes / 2;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,296 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ *
+ * Benchmark for the memory class allocators, compares malloc() with
+ * the free list of oonf_class (keeping 10% of the used objects) against
+ * the slab allocator for allocation churn of a large population of
+ * objects, similar to NHDP links and two-hop neighbors flapping.
+ *
+ * Usage: benchmark_slab [<objects> [<rounds> [<size>]]]
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "common/list.h"
+#include "common/slab.h"
+
+/* percentage of live objects freed and reallocated per round */
+#define CHURN_PCT 20
+
+/* percentage of objects removed for good in the second half */
+#define SHRINK_PCT 75
+
+/* minimal number of objects in the free list */
+#define MIN_FREE_COUNT 32
+
+struct freelist_allocator {
+  struct list_entity free_list;
+  uint32_t free_list_size;
+  uint32_t usage;
+  size_t size;
+};
+
+struct bench_result {
+  uint64_t churn;
+  uint32_t fragmentation;
+};
+
+static void **_objects;
+static uint32_t *_random;
+static uint32_t _object_count, _rounds;
+static size_t _object_size;
+
+static void *_freelist_alloc(struct freelist_allocator *);
+static void _freelist_free(struct freelist_allocator *, void *);
+static void _run_malloc(struct bench_result *);
+static void _run_slab(struct bench_result *);
+static uint64_t _get_usec(void);
+
+/**
+ * Allocate an object like oonf_class_malloc() without slab allocator
+ * @param fl pointer to allocator
+ * @return pointer to zeroed object
+ */
+static void *
+_freelist_alloc(struct freelist_allocator *fl) {
+  struct list_entity *entity;
+
+  fl->usage++;
+  if (list_is_empty(&fl->free_list)) {
+    return calloc(1, fl->size);
+  }
+
+  entity = fl->free_list.next;
+  list_remove(entity);
+  memset(entity, 0, fl->size);
+  fl->free_list_size--;
+  return entity;
+}
+
+/**
+ * Free an object like oonf_class_free() without slab allocator
+ * @param fl pointer to allocator
+ * @param ptr pointer to object
+ */
+static void
+_freelist_free(struct freelist_allocator *fl, void *ptr) {
+  if (fl->free_list_size < MIN_FREE_COUNT
+      || fl->free_list_size < fl->usage / 10) {
+    list_add_tail(&fl->free_list, ptr);
+    fl->free_list_size++;
+  }
+  else {
+    free(ptr);
+  }
+  fl->usage--;
+}
+
+/**
+ * Run benchmark with malloc() and a free list
+ * @param result pointer to result
+ */
+static void
+_run_malloc(struct bench_result *result) {
+  struct freelist_allocator fl;
+  struct list_entity *entity;
+  uint64_t start;
+  uint32_t i, r, rnd, live;
+
+  memset(&fl, 0, sizeof(fl));
+  list_init_head(&fl.free_list);
+  fl.size = _object_size;
+
+  for (i=0; i<_object_count; i++) {
+    _objects[i] = _freelist_alloc(&fl);
+  }
+
+  start = _get_usec();
+  for (r=0; r<_rounds; r++) {
+    live = r < _rounds / 2 ? _object_count : _object_count * (100 - SHRINK_PCT) / 100;
+    if (r == _rounds / 2) {
+      for (i=live; i<_object_count; i++) {
+        _freelist_free(&fl, _objects[i]);
+      }
+    }
+
+    for (i=0; i<live; i++) {
+      rnd = _random[(i + r) % _object_count];
+      if (rnd % 100 < CHURN_PCT) {
+        _freelist_free(&fl, _objects[i]);
+      }
+    }
+    for (i=0; i<live; i++) {
+      rnd = _random[(i + r) % _object_count];
+      if (rnd % 100 < CHURN_PCT) {
+        _objects[i] = _freelist_alloc(&fl);
+      }
+    }
+  }
+  result->churn = _get_usec() - start;
+  result->fragmentation = 0;
+
+  live = _object_count * (100 - SHRINK_PCT) / 100;
+  for (i=0; i<live; i++) {
+    free(_objects[i]);
+  }
+  while (!list_is_empty(&fl.free_list)) {
+    entity = fl.free_list.next;
+    list_remove(entity);
+    free(entity);
+  }
+}
+
+/**
+ * Run benchmark with a slab allocator
+ * @param result pointer to result
+ */
+static void
+_run_slab(struct bench_result *result) {
+  struct slab slab;
+  uint64_t start;
+  uint32_t i, r, rnd, live;
+
+  slab_init(&slab, _object_size);
+
+  for (i=0; i<_object_count; i++) {
+    _objects[i] = slab_alloc(&slab);
+  }
+
+  start = _get_usec();
+  for (r=0; r<_rounds; r++) {
+    live = r < _rounds / 2 ? _object_count : _object_count * (100 - SHRINK_PCT) / 100;
+    if (r == _rounds / 2) {
+      for (i=live; i<_object_count; i++) {
+        slab_free(&slab, _objects[i]);
+      }
+    }
+
+    for (i=0; i<live; i++) {
+      rnd = _random[(i + r) % _object_count];
+      if (rnd % 100 < CHURN_PCT) {
+        slab_free(&slab, _objects[i]);
+      }
+    }
+    for (i=0; i<live; i++) {
+      rnd = _random[(i + r) % _object_count];
+      if (rnd % 100 < CHURN_PCT) {
+        _objects[i] = slab_alloc(&slab);
+      }
+    }
+  }
+  result->churn = _get_usec() - start;
+  result->fragmentation = slab_get_fragmentation(&slab);
+
+  printf("slab: %u pages of %"PRINTF_SIZE_T_SPECIFIER" bytes, %u objects per page,"
+      " %u objects in use\n", slab.pages, slab.page_size, slab.objects_per_page, slab.used);
+
+  live = _object_count * (100 - SHRINK_PCT) / 100;
+  for (i=0; i<live; i++) {
+    slab_free(&slab, _objects[i]);
+  }
+  slab_release_empty(&slab);
+}
+
+/**
+ * @return monotonic time in microseconds
+ */
+static uint64_t
+_get_usec(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000ull + (uint64_t)ts.tv_nsec / 1000ull;
+}
+
+int
+main(int argc, char **argv) {
+  struct bench_result mem, slab;
+  uint32_t i;
+
+  _object_count = 100000;
+  _rounds = 200;
+  _object_size = 200;
+
+  if (argc > 1) {
+    _object_count = (uint32_t)strtoul(argv[1], NULL, 10);
+  }
+  if (argc > 2) {
+    _rounds = (uint32_t)strtoul(argv[2], NULL, 10);
+  }
+  if (argc > 3) {
+    _object_size = (size_t)strtoul(argv[3], NULL, 10);
+  }
+  if (_object_count == 0 || _rounds == 0 || _object_size < sizeof(struct list_entity)) {
+    fprintf(stderr, "Usage: %s [<objects> [<rounds> [<size>]]]\n", argv[0]);
+    return 1;
+  }
+
+  _objects = calloc(_object_count, sizeof(*_objects));
+  _random = calloc(_object_count, sizeof(*_random));
+  if (!_objects || !_random) {
+    fprintf(stderr, "Out of memory\n");
+    return 1;
+  }
+
+  srand(42);
+  for (i=0; i<_object_count; i++) {
+    _random[i] = (uint32_t)rand();
+  }
+
+  _run_malloc(&mem);
+  _run_slab(&slab);
+
+  printf("%u objects of %"PRINTF_SIZE_T_SPECIFIER" bytes, %u rounds with %d%% churn\n",
+      _object_count, _object_size, _rounds, CHURN_PCT);
+  printf("%8s %12s %14s\n", "backend", "churn (us)", "unused pages (%)");
+  printf("%8s %12llu %14s\n", "malloc", (unsigned long long)mem.churn, "-");
+  printf("%8s %12llu %14u\n", "slab", (unsigned long long)slab.churn, slab.fragmentation);
+
+  free(_objects);
+  free(_random);
+  return 0;
+}
@@ -0,0 +1,299 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ *
+ * Benchmark for the timer scheduler backends, compares the AVL tree
+ * (with duplicate keys) against the timer wheel for start, stop and
+ * refresh churn of many timers, similar to NHDP and OLSRv2 validity
+ * timers in a dense mesh.
+ *
+ * Usage: benchmark_timer_wheel [<timers> [<rounds>]]
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "common/avl.h"
+#include "common/timer_wheel.h"
+
+/* one tick is one timeslice of the scheduler (100 ms) */
+#define TICKS_PER_SECOND 10
+
+/* validity times between 6 and 60 seconds */
+#define VTIME_MIN   (6 * TICKS_PER_SECOND)
+#define VTIME_RANGE (54 * TICKS_PER_SECOND)
+
+/* percentage of timers refreshed/stopped per round */
+#define REFRESH_PCT 30
+#define STOP_PCT    2
+
+/* percentage of timers which are never refreshed (lost neighbors) */
+#define LOST_PCT    10
+
+struct bench_timer {
+  uint64_t clock;
+
+  struct avl_node avl;
+  struct timer_wheel_node wheel;
+};
+
+struct bench_result {
+  uint64_t start, churn, expire;
+  uint32_t fired;
+};
+
+static struct bench_timer *_timers;
+static uint32_t *_random;
+static uint32_t _timer_count, _rounds;
+
+static int _avlcomp_clock(const void *, const void *);
+static void _run_avl(struct bench_result *);
+static void _run_wheel(struct bench_result *);
+static uint64_t _get_usec(void);
+
+/**
+ * AVL comparator for timer clock values
+ * @param k1 pointer to first clock
+ * @param k2 pointer to second clock
+ * @return -1/0/1 depending on comparision of the clocks
+ */
+static int
+_avlcomp_clock(const void *k1, const void *k2) {
+  const uint64_t *c1 = k1, *c2 = k2;
+
+  if (*c1 > *c2) {
+    return 1;
+  }
+  if (*c1 < *c2) {
+    return -1;
+  }
+  return 0;
+}
+
+/**
+ * Run benchmark with an AVL tree as timer queue
+ * @param result pointer to result
+ */
+static void
+_run_avl(struct bench_result *result) {
+  struct avl_tree tree;
+  struct bench_timer *t;
+  uint64_t now, start;
+  uint32_t i, r, rnd;
+
+  memset(result, 0, sizeof(*result));
+  avl_init(&tree, _avlcomp_clock, true);
+
+  now = 1000;
+  rnd = 0;
+
+  start = _get_usec();
+  for (i=0; i<_timer_count; i++) {
+    t = &_timers[i];
+    t->clock = now + VTIME_MIN + _random[rnd++ % _timer_count] % VTIME_RANGE;
+    t->avl.key = &t->clock;
+    avl_insert(&tree, &t->avl);
+  }
+  result->start = _get_usec() - start;
+
+  for (r=0; r<_rounds; r++) {
+    now++;
+
+    /* refresh, stop and restart a part of the timers */
+    start = _get_usec();
+    for (i=0; i<_timer_count; i++) {
+      t = &_timers[i];
+      rnd = _random[(i + r) % _timer_count];
+
+      if (rnd % 100 >= REFRESH_PCT + STOP_PCT || _random[i] % 100 < LOST_PCT) {
+        continue;
+      }
+      if (avl_is_node_added(&t->avl)) {
+        avl_remove(&tree, &t->avl);
+      }
+      if (rnd % 100 < REFRESH_PCT) {
+        t->clock = now + VTIME_MIN + rnd % VTIME_RANGE;
+        avl_insert(&tree, &t->avl);
+      }
+    }
+    result->churn += _get_usec() - start;
+
+    /* fire all expired timers */
+    start = _get_usec();
+    while (!avl_is_empty(&tree)) {
+      t = avl_first_element(&tree, t, avl);
+      if (t->clock > now) {
+        break;
+      }
+      avl_remove(&tree, &t->avl);
+      result->fired++;
+    }
+    result->expire += _get_usec() - start;
+  }
+}
+
+/**
+ * Run benchmark with a timer wheel as timer queue
+ * @param result pointer to result
+ */
+static void
+_run_wheel(struct bench_result *result) {
+  static struct timer_wheel wheel;
+  struct bench_timer *t;
+  uint64_t now, start;
+  uint32_t i, r, rnd;
+
+  memset(result, 0, sizeof(*result));
+
+  now = 1000;
+  rnd = 0;
+
+  timer_wheel_init(&wheel, now);
+
+  start = _get_usec();
+  for (i=0; i<_timer_count; i++) {
+    t = &_timers[i];
+    t->clock = now + VTIME_MIN + _random[rnd++ % _timer_count] % VTIME_RANGE;
+    timer_wheel_insert(&wheel, &t->wheel, t->clock);
+  }
+  result->start = _get_usec() - start;
+
+  for (r=0; r<_rounds; r++) {
+    now++;
+
+    /* refresh, stop and restart a part of the timers */
+    start = _get_usec();
+    for (i=0; i<_timer_count; i++) {
+      t = &_timers[i];
+      rnd = _random[(i + r) % _timer_count];
+
+      if (rnd % 100 >= REFRESH_PCT + STOP_PCT || _random[i] % 100 < LOST_PCT) {
+        continue;
+      }
+      if (timer_wheel_is_node_added(&t->wheel)) {
+        timer_wheel_remove(&wheel, &t->wheel);
+      }
+      if (rnd % 100 < REFRESH_PCT) {
+        t->clock = now + VTIME_MIN + rnd % VTIME_RANGE;
+        timer_wheel_insert(&wheel, &t->wheel, t->clock);
+      }
+    }
+    result->churn += _get_usec() - start;
+
+    /* fire all expired timers */
+    start = _get_usec();
+    while ((t = timer_wheel_get_expired_element(&wheel, now, t, wheel)) != NULL) {
+      timer_wheel_remove(&wheel, &t->wheel);
+      result->fired++;
+    }
+    result->expire += _get_usec() - start;
+  }
+}
+
+/**
+ * @return monotonic time in microseconds
+ */
+static uint64_t
+_get_usec(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000ull + (uint64_t)ts.tv_nsec / 1000ull;
+}
+
+int
+main(int argc, char **argv) {
+  struct bench_result avl, wheel;
+  uint32_t i;
+
+  _timer_count = 100000;
+  _rounds = 600;
+
+  if (argc > 1) {
+    _timer_count = (uint32_t)strtoul(argv[1], NULL, 10);
+  }
+  if (argc > 2) {
+    _rounds = (uint32_t)strtoul(argv[2], NULL, 10);
+  }
+  if (_timer_count == 0 || _rounds == 0) {
+    fprintf(stderr, "Usage: %s [<timers> [<rounds>]]\n", argv[0]);
+    return 1;
+  }
+
+  _timers = calloc(_timer_count, sizeof(*_timers));
+  _random = calloc(_timer_count, sizeof(*_random));
+  if (!_timers || !_random) {
+    fprintf(stderr, "Out of memory\n");
+    return 1;
+  }
+
+  srand(42);
+  for (i=0; i<_timer_count; i++) {
+    _random[i] = (uint32_t)rand();
+  }
+
+  _run_avl(&avl);
+
+  for (i=0; i<_timer_count; i++) {
+    list_init_node(&_timers[i].wheel._list);
+  }
+  _run_wheel(&wheel);
+
+  if (avl.fired != wheel.fired) {
+    fprintf(stderr, "Fired timer mismatch: %u != %u\n", avl.fired, wheel.fired);
+    return 1;
+  }
+
+  printf("%u timers, %u rounds, %u timers fired\n", _timer_count, _rounds, avl.fired);
+  printf("%8s %12s %12s %12s\n", "backend", "start (us)", "churn (us)", "expire (us)");
+  printf("%8s %12llu %12llu %12llu\n", "avl", (unsigned long long)avl.start,
+      (unsigned long long)avl.churn, (unsigned long long)avl.expire);
+  printf("%8s %12llu %12llu %12llu\n", "wheel", (unsigned long long)wheel.start,
+      (unsigned long long)wheel.churn, (unsigned long long)wheel.expire);
+
+  free(_timers);
+  free(_random);
+  return 0;
+}
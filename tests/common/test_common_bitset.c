@@ -0,0 +1,122 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "common/bitset.h"
+#include "cunit/cunit.h"
+
+#define TEST_BITS 200
+
+static uint64_t set1[BITSET_WORDS(TEST_BITS)];
+static uint64_t set2[BITSET_WORDS(TEST_BITS)];
+
+static void clear_elements(void) {
+  bitset_clear(set1, ARRAYSIZE(set1));
+  bitset_clear(set2, ARRAYSIZE(set2));
+}
+
+static void test_set_reset(void) {
+  uint32_t i;
+
+  START_TEST();
+
+  CHECK_TRUE(ARRAYSIZE(set1) == 4, "bitset has %"PRINTF_SIZE_T_SPECIFIER" words",
+      ARRAYSIZE(set1));
+  CHECK_TRUE(bitset_get_first(set1, ARRAYSIZE(set1)) == -1, "empty bitset has a first bit");
+
+  for (i=0; i<TEST_BITS; i+=3) {
+    bitset_set(set1, i);
+  }
+  for (i=0; i<TEST_BITS; i++) {
+    CHECK_TRUE(bitset_get(set1, i) == (i % 3 == 0), "bit %u has wrong value", i);
+  }
+  CHECK_TRUE(bitset_count(set1, ARRAYSIZE(set1)) == (TEST_BITS + 2) / 3,
+      "bitset has %u bits set", bitset_count(set1, ARRAYSIZE(set1)));
+
+  bitset_reset(set1, 0);
+  bitset_reset(set1, 63);
+  CHECK_TRUE(!bitset_get(set1, 63), "bit 63 is still set");
+  CHECK_TRUE(bitset_get(set1, 66), "bit 66 was reset");
+  CHECK_TRUE(bitset_get_first(set1, ARRAYSIZE(set1)) == 3,
+      "first bit is %d", bitset_get_first(set1, ARRAYSIZE(set1)));
+
+  END_TEST();
+}
+
+static void test_combine(void) {
+  START_TEST();
+
+  bitset_set(set1, 1);
+  bitset_set(set1, 70);
+  bitset_set(set1, 199);
+  bitset_set(set2, 70);
+  bitset_set(set2, 130);
+
+  CHECK_TRUE(bitset_count_andnot(set1, set2, ARRAYSIZE(set1)) == 2,
+      "set1 without set2 has %u bits", bitset_count_andnot(set1, set2, ARRAYSIZE(set1)));
+  CHECK_TRUE(bitset_count_andnot(set2, set1, ARRAYSIZE(set1)) == 1,
+      "set2 without set1 has %u bits", bitset_count_andnot(set2, set1, ARRAYSIZE(set1)));
+
+  bitset_or(set1, set2, ARRAYSIZE(set1));
+  CHECK_TRUE(bitset_count(set1, ARRAYSIZE(set1)) == 4,
+      "union has %u bits", bitset_count(set1, ARRAYSIZE(set1)));
+  CHECK_TRUE(bitset_get(set1, 130), "bit 130 is missing in the union");
+  CHECK_TRUE(bitset_count_andnot(set2, set1, ARRAYSIZE(set1)) == 0,
+      "set2 is not a subset of the union");
+
+  END_TEST();
+}
+
+int main(int argc __attribute__ ((unused)), char **argv __attribute__ ((unused))) {
+  BEGIN_TESTING(clear_elements);
+
+  test_set_reset();
+  test_combine();
+
+  return FINISH_TESTING();
+}
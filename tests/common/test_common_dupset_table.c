@@ -0,0 +1,229 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "common/dupset_table.h"
+#include "common/netaddr.h"
+#include "cunit/cunit.h"
+
+#define COUNT 1000
+
+static struct dupset_table table;
+static struct netaddr addrs[COUNT];
+
+static void clear_elements(void) {
+  uint8_t bin[4];
+  uint32_t i;
+
+  dupset_table_free(&table);
+  dupset_table_init(&table);
+
+  for (i=0; i<COUNT; i++) {
+    bin[0] = 10;
+    bin[1] = (uint8_t)(i >> 16);
+    bin[2] = (uint8_t)(i >> 8);
+    bin[3] = (uint8_t)i;
+    netaddr_from_binary(&addrs[i], bin, 4, AF_INET);
+  }
+}
+
+static uint32_t _count_found(uint32_t count, uint8_t msg_type) {
+  uint32_t i, found;
+
+  found = 0;
+  for (i=0; i<count; i++) {
+    if (dupset_table_get(&table, msg_type, &addrs[i]) != NULL) {
+      found++;
+    }
+  }
+  return found;
+}
+
+static void test_empty(void) {
+  START_TEST();
+
+  CHECK_TRUE(table.count == 0, "new table has %u entries", table.count);
+  CHECK_TRUE(dupset_table_get_size(&table) == 0, "new table has slots");
+  CHECK_TRUE(dupset_table_get(&table, 1, &addrs[0]) == NULL, "empty table returned entry");
+  CHECK_TRUE(dupset_table_expire(&table, 1000) == 0, "expire removed entries from empty table");
+
+  END_TEST();
+}
+
+static void test_insert_get(void) {
+  struct dupset_table_entry *entry;
+  uint32_t i;
+
+  START_TEST();
+
+  for (i=0; i<COUNT; i++) {
+    entry = dupset_table_insert(&table, 1, &addrs[i]);
+    CHECK_TRUE(entry != NULL, "insert %u failed", i);
+    if (entry) {
+      entry->window.current = i;
+    }
+  }
+
+  CHECK_TRUE(table.count == COUNT, "table has %u instead of %d entries", table.count, COUNT);
+  CHECK_TRUE(dupset_table_get_size(&table) * 3 >= (size_t)COUNT * 4,
+      "table with %d entries has only %"PRINTF_SIZE_T_SPECIFIER" slots",
+      COUNT, dupset_table_get_size(&table));
+
+  for (i=0; i<COUNT; i++) {
+    entry = dupset_table_get(&table, 1, &addrs[i]);
+    CHECK_TRUE(entry != NULL && entry->window.current == i, "entry %u not found", i);
+  }
+
+  /* message type is part of the key */
+  CHECK_TRUE(_count_found(COUNT, 2) == 0, "found entries with wrong message type");
+
+  entry = dupset_table_insert(&table, 2, &addrs[0]);
+  CHECK_TRUE(entry != NULL && entry->window.current == 0, "insert with second type failed");
+  CHECK_TRUE(_count_found(COUNT, 2) == 1, "entry with second type not found");
+
+  END_TEST();
+}
+
+static void test_remove(void) {
+  struct dupset_table_entry *entry;
+  uint32_t i, found;
+
+  START_TEST();
+
+  for (i=0; i<COUNT; i++) {
+    dupset_table_insert(&table, 1, &addrs[i]);
+  }
+
+  /* remove every third entry, backward shift must keep probe sequences intact */
+  for (i=0; i<COUNT; i+=3) {
+    entry = dupset_table_get(&table, 1, &addrs[i]);
+    CHECK_TRUE(entry != NULL, "entry %u not found", i);
+    if (entry) {
+      dupset_table_remove(&table, entry);
+    }
+  }
+
+  found = 0;
+  for (i=0; i<COUNT; i++) {
+    entry = dupset_table_get(&table, 1, &addrs[i]);
+    CHECK_TRUE((entry == NULL) == (i % 3 == 0), "entry %u %s", i,
+        entry ? "not removed" : "lost");
+    if (entry) {
+      found++;
+    }
+  }
+  CHECK_TRUE(found == table.count, "found %u entries, table has %u", found, table.count);
+
+  /* remove the rest in reverse order */
+  for (i=COUNT; i>0; i--) {
+    entry = dupset_table_get(&table, 1, &addrs[i-1]);
+    if (entry) {
+      dupset_table_remove(&table, entry);
+    }
+  }
+  CHECK_TRUE(table.count == 0, "table has %u entries left", table.count);
+  CHECK_TRUE(_count_found(COUNT, 1) == 0, "found removed entries");
+
+  END_TEST();
+}
+
+static void test_expire(void) {
+  struct dupset_table_entry *entry;
+  size_t removed, size;
+  uint32_t i;
+
+  START_TEST();
+
+  for (i=0; i<COUNT; i++) {
+    entry = dupset_table_insert(&table, 1, &addrs[i]);
+    if (entry) {
+      entry->expire = 1000 + (i % 10) * 100;
+    }
+  }
+  size = dupset_table_get_size(&table);
+
+  removed = dupset_table_expire(&table, 999);
+  CHECK_TRUE(removed == 0, "removed %"PRINTF_SIZE_T_SPECIFIER" entries too early", removed);
+
+  removed = dupset_table_expire(&table, 1400);
+  CHECK_TRUE(removed == COUNT / 2, "removed %"PRINTF_SIZE_T_SPECIFIER" instead of %d entries",
+      removed, COUNT / 2);
+  CHECK_TRUE(dupset_table_get_size(&table) == size, "table was shrunk too early");
+
+  for (i=0; i<COUNT; i++) {
+    entry = dupset_table_get(&table, 1, &addrs[i]);
+    CHECK_TRUE((entry == NULL) == (i % 10 < 5), "entry %u %s", i,
+        entry ? "not removed" : "lost");
+  }
+
+  removed = dupset_table_expire(&table, 1800);
+  CHECK_TRUE(removed == COUNT * 4 / 10, "removed %"PRINTF_SIZE_T_SPECIFIER" instead of %d entries",
+      removed, COUNT * 4 / 10);
+  CHECK_TRUE(dupset_table_get_size(&table) < size, "table was not shrunk");
+  CHECK_TRUE(_count_found(COUNT, 1) == COUNT / 10, "found %u instead of %d entries",
+      _count_found(COUNT, 1), COUNT / 10);
+
+  removed = dupset_table_expire(&table, 2000);
+  CHECK_TRUE(removed == COUNT / 10, "removed %"PRINTF_SIZE_T_SPECIFIER" instead of %d entries",
+      removed, COUNT / 10);
+  CHECK_TRUE(dupset_table_get_size(&table) == 0, "empty table was not freed");
+
+  END_TEST();
+}
+
+int main(int argc __attribute__ ((unused)), char **argv __attribute__ ((unused))) {
+  BEGIN_TESTING(clear_elements);
+
+  test_empty();
+  test_insert_get();
+  test_remove();
+  test_expire();
+
+  dupset_table_free(&table);
+  return FINISH_TESTING();
+}
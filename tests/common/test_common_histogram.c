@@ -0,0 +1,122 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "common/histogram.h"
+#include "cunit/cunit.h"
+
+static struct histogram h;
+
+static void clear_elements(void) {
+  memset(&h, 0, sizeof(h));
+}
+
+static void test_buckets(void) {
+  uint32_t i;
+
+  START_TEST();
+
+  CHECK_TRUE(histogram_get_bucket(0) == 0, "bucket of 0 is %u", histogram_get_bucket(0));
+  CHECK_TRUE(histogram_get_bucket(1) == 1, "bucket of 1 is %u", histogram_get_bucket(1));
+  CHECK_TRUE(histogram_get_bucket(2) == 2, "bucket of 2 is %u", histogram_get_bucket(2));
+  CHECK_TRUE(histogram_get_bucket(3) == 2, "bucket of 3 is %u", histogram_get_bucket(3));
+  CHECK_TRUE(histogram_get_bucket(1000) == 10, "bucket of 1000 is %u", histogram_get_bucket(1000));
+  CHECK_TRUE(histogram_get_bucket(UINT64_MAX) == HISTOGRAM_BUCKETS - 1,
+      "bucket of UINT64_MAX is %u", histogram_get_bucket(UINT64_MAX));
+
+  /* each value must be inside the limits of its bucket */
+  for (i=1; i<HISTOGRAM_BUCKETS - 1; i++) {
+    CHECK_TRUE(histogram_get_bucket(histogram_get_bucket_limit(i)) == i,
+        "limit of bucket %u is not inside the bucket", i);
+    CHECK_TRUE(histogram_get_bucket(histogram_get_bucket_limit(i) + 1) == i + 1,
+        "limit of bucket %u is too small", i);
+  }
+
+  END_TEST();
+}
+
+static void test_percentile(void) {
+  uint32_t i;
+
+  START_TEST();
+
+  CHECK_TRUE(histogram_get_percentile(&h, 50) == 0, "percentile of empty histogram");
+
+  /* 90 small values and 10 large ones */
+  for (i=0; i<90; i++) {
+    histogram_add(&h, 5);
+  }
+  for (i=0; i<10; i++) {
+    histogram_add(&h, 5000);
+  }
+
+  CHECK_TRUE(h.count == 100, "count is %"PRIu64, h.count);
+  CHECK_TRUE(h.max == 5000, "max is %"PRIu64, h.max);
+  CHECK_TRUE(histogram_get_average(&h) == (90*5 + 10*5000) / 100,
+      "average is %"PRIu64, histogram_get_average(&h));
+
+  CHECK_TRUE(histogram_get_percentile(&h, 50) == 7,
+      "median is %"PRIu64, histogram_get_percentile(&h, 50));
+  CHECK_TRUE(histogram_get_percentile(&h, 90) == 7,
+      "90th percentile is %"PRIu64, histogram_get_percentile(&h, 90));
+  CHECK_TRUE(histogram_get_percentile(&h, 99) == 5000,
+      "99th percentile is %"PRIu64, histogram_get_percentile(&h, 99));
+  CHECK_TRUE(histogram_get_percentile(&h, 100) == 5000,
+      "maximum is %"PRIu64, histogram_get_percentile(&h, 100));
+
+  END_TEST();
+}
+
+int main(int argc __attribute__ ((unused)), char **argv __attribute__ ((unused))) {
+  BEGIN_TESTING(clear_elements);
+
+  test_buckets();
+  test_percentile();
+
+  return FINISH_TESTING();
+}
@@ -0,0 +1,308 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "common/netaddr.h"
+#include "common/netaddr_acl.h"
+#include "common/string.h"
+#include "cunit/cunit.h"
+
+#define COUNT 128
+
+static struct netaddr_acl acl;
+
+static void clear_elements(void) {
+  netaddr_acl_remove(&acl);
+}
+
+static int
+parse_acl(struct netaddr_acl *target, const char *value, size_t length) {
+  struct const_strarray array = { .value = value, .length = length };
+
+  return netaddr_acl_from_strarray(target, &array);
+}
+
+static bool
+check_addr(const struct netaddr_acl *target, const char *addr) {
+  struct netaddr key;
+
+  if (netaddr_from_string(&key, addr)) {
+    return false;
+  }
+  return netaddr_acl_check_accept(target, &key);
+}
+
+/* linear reference implementation of the ACL semantics */
+static bool
+check_linear(const struct netaddr_acl *target, const struct netaddr *addr) {
+  bool accept, reject;
+  size_t i;
+
+  accept = false;
+  reject = false;
+  for (i=0; i<target->accept_count; i++) {
+    accept |= netaddr_is_in_subnet(&target->accept[i], addr);
+  }
+  for (i=0; i<target->reject_count; i++) {
+    reject |= netaddr_is_in_subnet(&target->reject[i], addr);
+  }
+
+  if (target->reject_first && reject) {
+    return false;
+  }
+  if (accept) {
+    return true;
+  }
+  if (reject) {
+    return false;
+  }
+  return target->accept_default;
+}
+
+static void test_default(void) {
+  static const char value[] = "default_accept";
+
+  START_TEST();
+
+  netaddr_acl_add(&acl);
+  CHECK_TRUE(!check_addr(&acl, "10.0.0.1"), "empty ACL accepted address");
+
+  CHECK_TRUE(parse_acl(&acl, value, sizeof(value)) == 0, "cannot parse ACL");
+  CHECK_TRUE(check_addr(&acl, "10.0.0.1"), "default_accept ACL rejected IPv4 address");
+  CHECK_TRUE(check_addr(&acl, "fe80::1"), "default_accept ACL rejected IPv6 address");
+
+  END_TEST();
+}
+
+static void test_first_accept(void) {
+  static const char value[] = "10.0.0.0/8\0-10.1.0.0/16\0-10.1.2.0/24\0+10.1.2.3";
+
+  START_TEST();
+
+  CHECK_TRUE(parse_acl(&acl, value, sizeof(value)) == 0, "cannot parse ACL");
+  CHECK_TRUE(acl.accept_count == 2, "ACL has %zu accepted prefixes", acl.accept_count);
+  CHECK_TRUE(acl.reject_count == 2, "ACL has %zu rejected prefixes", acl.reject_count);
+
+  CHECK_TRUE(check_addr(&acl, "10.2.0.1"), "accepted prefix was rejected");
+  CHECK_TRUE(check_addr(&acl, "10.1.0.1"), "accept first did not win over longer reject");
+  CHECK_TRUE(check_addr(&acl, "10.1.2.3"), "accepted host was rejected");
+  CHECK_TRUE(!check_addr(&acl, "192.168.0.1"), "unknown address was accepted");
+  CHECK_TRUE(!check_addr(&acl, "fe80::1"), "IPv6 address matched IPv4 ACL");
+
+  /* keywords can be changed after the ACL has been parsed */
+  CHECK_TRUE(netaddr_acl_handle_keywords(&acl, ACL_FIRST_REJECT) == 0, "keyword not recognized");
+  CHECK_TRUE(!check_addr(&acl, "10.1.0.1"), "reject first did not win over shorter accept");
+  CHECK_TRUE(!check_addr(&acl, "10.1.2.3"), "reject first did not win over longer accept");
+  CHECK_TRUE(check_addr(&acl, "10.2.0.1"), "accepted prefix was rejected");
+
+  END_TEST();
+}
+
+static void test_first_reject(void) {
+  static const char value[] = "first_reject\0default_accept\0-10.0.0.0/8\0+10.1.0.0/16\0-fe80::/10";
+
+  START_TEST();
+
+  CHECK_TRUE(parse_acl(&acl, value, sizeof(value)) == 0, "cannot parse ACL");
+  CHECK_TRUE(acl.reject_first, "first_reject keyword ignored");
+  CHECK_TRUE(acl.accept_default, "default_accept keyword ignored");
+
+  CHECK_TRUE(!check_addr(&acl, "10.2.0.1"), "rejected prefix was accepted");
+  CHECK_TRUE(!check_addr(&acl, "10.1.0.1"), "reject first did not win over longer accept");
+  CHECK_TRUE(check_addr(&acl, "192.168.0.1"), "default accept was ignored");
+  CHECK_TRUE(!check_addr(&acl, "fe80::1"), "rejected IPv6 prefix was accepted");
+  CHECK_TRUE(check_addr(&acl, "2001:db8::1"), "IPv6 default accept was ignored");
+
+  END_TEST();
+}
+
+static void test_same_prefix(void) {
+  static const char value[] = "10.0.0.0/8\0-10.0.0.0/8\0""10.0.0.1/8\0-0.0.0.0/0";
+
+  START_TEST();
+
+  CHECK_TRUE(parse_acl(&acl, value, sizeof(value)) == 0, "cannot parse ACL");
+  CHECK_TRUE(check_addr(&acl, "10.0.0.1"), "accept first ignored prefix in both lists");
+  CHECK_TRUE(!check_addr(&acl, "11.0.0.1"), "default route reject ignored");
+
+  acl.reject_first = true;
+  CHECK_TRUE(!check_addr(&acl, "10.0.0.1"), "reject first ignored prefix in both lists");
+
+  END_TEST();
+}
+
+static void test_copy(void) {
+  static const char value[] = "-10.1.0.0/16\0""10.0.0.0/8";
+  struct netaddr_acl copy;
+
+  START_TEST();
+
+  netaddr_acl_add(&copy);
+  CHECK_TRUE(parse_acl(&acl, value, sizeof(value)) == 0, "cannot parse ACL");
+  CHECK_TRUE(netaddr_acl_copy(&copy, &acl) == 0, "cannot copy ACL");
+
+  netaddr_acl_remove(&acl);
+  CHECK_TRUE(check_addr(&copy, "10.1.0.1"), "copy lost accept prefix");
+  CHECK_TRUE(!check_addr(&copy, "11.0.0.1"), "copy accepted unknown address");
+
+  copy.reject_first = true;
+  CHECK_TRUE(!check_addr(&copy, "10.1.0.1"), "copy lost reject prefix");
+
+  netaddr_acl_remove(&copy);
+
+  END_TEST();
+}
+
+static void test_invalid(void) {
+  static const char value[] = "10.0.0.0/8\0-no_address";
+
+  START_TEST();
+
+  CHECK_TRUE(parse_acl(&acl, value, sizeof(value)) != 0, "invalid ACL was parsed");
+  CHECK_TRUE(acl.accept_count == 0 && acl.reject_count == 0, "invalid ACL was not cleared");
+  CHECK_TRUE(!check_addr(&acl, "10.0.0.1"), "cleared ACL accepted address");
+
+  END_TEST();
+}
+
+static void test_unspec(void) {
+  static const char value[] = "10.0.0.0/8\0--\0-fe80::/10";
+  struct netaddr_acl copy;
+
+  START_TEST();
+
+  CHECK_TRUE(parse_acl(&acl, value, sizeof(value)) == 0, "cannot parse ACL with AF_UNSPEC");
+  CHECK_TRUE(acl.reject_count == 2, "ACL has %zu rejected prefixes", acl.reject_count);
+
+  CHECK_TRUE(!netaddr_acl_check_accept(&acl, &NETADDR_UNSPEC), "AF_UNSPEC was accepted");
+  CHECK_TRUE(check_addr(&acl, "10.0.0.1"), "accepted prefix was rejected");
+  CHECK_TRUE(!check_addr(&acl, "fe80::1"), "rejected prefix was accepted");
+
+  acl.accept_default = true;
+  CHECK_TRUE(!netaddr_acl_check_accept(&acl, &NETADDR_UNSPEC), "AF_UNSPEC reject ignored");
+  CHECK_TRUE(check_addr(&acl, "192.168.0.1"), "default accept was ignored");
+
+  netaddr_acl_add(&copy);
+  CHECK_TRUE(netaddr_acl_copy(&copy, &acl) == 0, "cannot copy ACL with AF_UNSPEC");
+  CHECK_TRUE(!netaddr_acl_check_accept(&copy, &NETADDR_UNSPEC), "copy lost AF_UNSPEC reject");
+  CHECK_TRUE(check_addr(&copy, "10.0.0.1"), "copy lost accept prefix");
+  netaddr_acl_remove(&copy);
+
+  END_TEST();
+}
+
+static void test_random(void) {
+  struct strarray array;
+  struct netaddr addr;
+  struct netaddr_str nbuf;
+  char buffer[64];
+  uint32_t i, j, round, errors;
+
+  START_TEST();
+
+  errors = 0;
+  strarray_init(&array);
+  for (round=0; round<8; round++) {
+    /* random prefixes from a small address range to get many overlaps */
+    for (i=0; i<COUNT; i++) {
+      memset(&addr, 0, sizeof(addr));
+      addr._type = AF_INET;
+      addr._addr[0] = 10;
+      addr._addr[1] = (uint8_t)(rand() % 4);
+      addr._addr[2] = (uint8_t)rand();
+      addr._addr[3] = (uint8_t)rand();
+      addr._prefix_len = (uint8_t)(8 + rand() % 25);
+
+      snprintf(buffer, sizeof(buffer), "%s%s",
+          (rand() % 2) ? "-" : "", netaddr_to_string(&nbuf, &addr));
+      CHECK_TRUE(strarray_append(&array, buffer) == 0, "out of memory");
+    }
+
+    CHECK_TRUE(parse_acl(&acl, array.value, array.length) == 0, "cannot parse random ACL");
+
+    for (j=0; j<2000; j++) {
+      memset(&addr, 0, sizeof(addr));
+      addr._type = AF_INET;
+      addr._prefix_len = 32;
+      addr._addr[0] = 10;
+      addr._addr[1] = (uint8_t)(rand() % 4);
+      addr._addr[2] = (uint8_t)rand();
+      addr._addr[3] = (uint8_t)rand();
+
+      acl.reject_first = (j % 2) == 0;
+      acl.accept_default = (j % 4) < 2;
+      if (netaddr_acl_check_accept(&acl, &addr) != check_linear(&acl, &addr)) {
+        errors++;
+      }
+    }
+
+    netaddr_acl_remove(&acl);
+    strarray_free(&array);
+  }
+  CHECK_TRUE(errors == 0, "%u checks differ from linear scan", errors);
+
+  END_TEST();
+}
+
+int main(int argc __attribute__ ((unused)), char **argv __attribute__ ((unused))) {
+  netaddr_acl_add(&acl);
+
+  BEGIN_TESTING(clear_elements);
+
+  test_default();
+  test_first_accept();
+  test_first_reject();
+  test_same_prefix();
+  test_copy();
+  test_invalid();
+  test_unspec();
+  test_random();
+
+  netaddr_acl_remove(&acl);
+  return FINISH_TESTING();
+}
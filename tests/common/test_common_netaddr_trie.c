@@ -0,0 +1,397 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "common/netaddr.h"
+#include "common/netaddr_trie.h"
+#include "cunit/cunit.h"
+
+struct trie_element {
+  struct netaddr prefix;
+  struct netaddr_trie_node node;
+};
+
+#define COUNT 256
+
+static struct netaddr_trie trie;
+static struct trie_element elements[COUNT];
+
+static void clear_elements(void) {
+  netaddr_trie_clear(&trie);
+  netaddr_trie_init(&trie, false);
+
+  memset(elements, 0, sizeof(elements));
+}
+
+static struct trie_element *
+add_element(size_t idx, const char *prefix) {
+  if (netaddr_from_string(&elements[idx].prefix, prefix)) {
+    return NULL;
+  }
+  elements[idx].node.key = &elements[idx].prefix;
+  if (netaddr_trie_insert(&trie, &elements[idx].node)) {
+    return NULL;
+  }
+  return &elements[idx];
+}
+
+static struct trie_element *
+lookup_lpm(const char *addr) {
+  struct trie_element *e;
+  struct netaddr key;
+
+  if (netaddr_from_string(&key, addr)) {
+    return NULL;
+  }
+  return netaddr_trie_find_lpm_element(&trie, &key, e, node);
+}
+
+static struct trie_element *
+lookup_spm(const char *addr) {
+  struct trie_element *e;
+  struct netaddr key;
+
+  if (netaddr_from_string(&key, addr)) {
+    return NULL;
+  }
+  return netaddr_trie_find_spm_element(&trie, &key, e, node);
+}
+
+static void test_empty(void) {
+  struct netaddr key;
+
+  START_TEST();
+
+  CHECK_TRUE(netaddr_trie_is_empty(&trie), "new trie is not empty");
+  CHECK_TRUE(!netaddr_trie_is_node_added(&elements[0].node), "fresh node is part of trie");
+  CHECK_TRUE(lookup_lpm("10.0.0.1") == NULL, "empty trie returned a match");
+
+  CHECK_TRUE(netaddr_from_string(&key, "0.0.0.0/0") == 0, "cannot parse 0.0.0.0/0");
+  CHECK_TRUE(netaddr_trie_first_covered(&trie, &key) == NULL, "empty trie has covered nodes");
+
+  CHECK_TRUE(add_element(0, "10.0.0.0/8") != NULL, "insert failed");
+  CHECK_TRUE(!netaddr_trie_is_empty(&trie), "trie is empty after insert");
+  CHECK_TRUE(netaddr_trie_is_node_added(&elements[0].node), "node is not part of trie");
+
+  netaddr_trie_remove(&trie, &elements[0].node);
+  CHECK_TRUE(netaddr_trie_is_empty(&trie), "trie is not empty after remove");
+  CHECK_TRUE(!netaddr_trie_is_node_added(&elements[0].node), "removed node is part of trie");
+  CHECK_TRUE(lookup_lpm("10.0.0.1") == NULL, "removed prefix still matches");
+
+  END_TEST();
+}
+
+static void test_lpm_ipv4(void) {
+  START_TEST();
+
+  CHECK_TRUE(add_element(0, "10.0.0.0/8") != NULL, "insert /8 failed");
+  CHECK_TRUE(add_element(1, "10.1.0.0/16") != NULL, "insert /16 failed");
+  CHECK_TRUE(add_element(2, "10.1.2.0/24") != NULL, "insert /24 failed");
+  CHECK_TRUE(add_element(3, "10.1.2.3") != NULL, "insert /32 failed");
+  CHECK_TRUE(add_element(4, "10.128.0.0/9") != NULL, "insert /9 failed");
+  CHECK_TRUE(add_element(5, "0.0.0.0/0") != NULL, "insert default route failed");
+
+  CHECK_TRUE(lookup_lpm("10.1.2.3") == &elements[3], "host route not matched");
+  CHECK_TRUE(lookup_lpm("10.1.2.4") == &elements[2], "/24 not matched");
+  CHECK_TRUE(lookup_lpm("10.1.3.4") == &elements[1], "/16 not matched");
+  CHECK_TRUE(lookup_lpm("10.2.3.4") == &elements[0], "/8 not matched");
+  CHECK_TRUE(lookup_lpm("10.200.3.4") == &elements[4], "/9 not matched");
+  CHECK_TRUE(lookup_lpm("192.168.0.1") == &elements[5], "default route not matched");
+  CHECK_TRUE(lookup_lpm("10.1.2.0/24") == &elements[3] || lookup_lpm("10.1.2.0/24") == &elements[2],
+      "prefix length of lookup was not ignored");
+  CHECK_TRUE(lookup_lpm("fe80::1") == NULL, "IPv6 address matched IPv4 prefix");
+
+  CHECK_TRUE(trie.count == 6, "trie has %u instead of 6 nodes", trie.count);
+
+  END_TEST();
+}
+
+static void test_spm_ipv4(void) {
+  START_TEST();
+
+  CHECK_TRUE(add_element(0, "10.1.2.3") != NULL, "insert /32 failed");
+  CHECK_TRUE(add_element(1, "10.1.2.0/24") != NULL, "insert /24 failed");
+  CHECK_TRUE(add_element(2, "10.1.0.0/16") != NULL, "insert /16 failed");
+  CHECK_TRUE(add_element(3, "10.0.0.0/8") != NULL, "insert /8 failed");
+
+  CHECK_TRUE(lookup_spm("10.1.2.3") == &elements[3], "/8 not matched for host");
+  CHECK_TRUE(lookup_spm("10.200.0.1") == &elements[3], "/8 not matched");
+  CHECK_TRUE(lookup_spm("11.0.0.1") == NULL, "address outside of prefixes matched");
+  CHECK_TRUE(lookup_spm("fe80::1") == NULL, "IPv6 address matched IPv4 prefix");
+
+  netaddr_trie_remove(&trie, &elements[3].node);
+  CHECK_TRUE(lookup_spm("10.1.2.3") == &elements[2], "/16 not matched");
+  CHECK_TRUE(lookup_spm("10.2.0.1") == NULL, "removed /8 still matches");
+
+  netaddr_trie_remove(&trie, &elements[2].node);
+  netaddr_trie_remove(&trie, &elements[1].node);
+  CHECK_TRUE(lookup_spm("10.1.2.3") == &elements[0], "host route not matched");
+  CHECK_TRUE(lookup_spm("10.1.2.4") == NULL, "removed /24 still matches");
+
+  END_TEST();
+}
+
+static void test_families(void) {
+  START_TEST();
+
+  CHECK_TRUE(add_element(0, "2001:db8::/32") != NULL, "insert IPv6 prefix failed");
+  CHECK_TRUE(add_element(1, "2001:db8:1::/48") != NULL, "insert IPv6 /48 failed");
+  CHECK_TRUE(add_element(2, "02:00:00:00:00:00/8") != NULL, "insert MAC48 prefix failed");
+  CHECK_TRUE(add_element(3, "02:00:00:00:00:01") != NULL, "insert MAC48 address failed");
+  CHECK_TRUE(add_element(4, "02:00:00:00:00:00:00:00/8") != NULL, "insert EUI64 prefix failed");
+
+  CHECK_TRUE(lookup_lpm("2001:db8:1::1") == &elements[1], "IPv6 /48 not matched");
+  CHECK_TRUE(lookup_lpm("2001:db8:2::1") == &elements[0], "IPv6 /32 not matched");
+  CHECK_TRUE(lookup_lpm("2001:db9::1") == NULL, "IPv6 outside of prefix matched");
+  CHECK_TRUE(lookup_lpm("02:00:00:00:00:01") == &elements[3], "MAC48 address not matched");
+  CHECK_TRUE(lookup_lpm("02:00:00:00:00:02") == &elements[2], "MAC48 prefix not matched");
+  CHECK_TRUE(lookup_lpm("02:00:00:00:00:00:00:01") == &elements[4], "EUI64 prefix not matched");
+  CHECK_TRUE(lookup_lpm("2.0.0.1") == NULL, "IPv4 address matched other families");
+
+  END_TEST();
+}
+
+static void test_exact_and_duplicates(void) {
+  struct trie_element *e;
+  struct netaddr key;
+
+  START_TEST();
+
+  CHECK_TRUE(add_element(0, "10.1.0.0/16") != NULL, "insert failed");
+  CHECK_TRUE(add_element(1, "10.1.0.0/16") == NULL, "duplicate prefix was accepted");
+  CHECK_TRUE(add_element(2, "10.1.255.255/16") == NULL, "duplicate prefix with host bits was accepted");
+  CHECK_TRUE(add_element(3, "10.2.0.0/16") != NULL, "insert sibling failed");
+
+  CHECK_TRUE(netaddr_from_string(&key, "10.1.0.0/16") == 0, "cannot parse 10.1.0.0/16");
+  e = netaddr_trie_find_element(&trie, &key, e, node);
+  CHECK_TRUE(e == &elements[0], "exact lookup failed");
+
+  CHECK_TRUE(netaddr_from_string(&key, "10.0.0.0/8") == 0, "cannot parse 10.0.0.0/8");
+  CHECK_TRUE(netaddr_trie_find(&trie, &key) == NULL, "exact lookup returned shorter prefix");
+
+  /* 10.1.0.0/16 and 10.2.0.0/16 branch behind a /14 glue vertex */
+  CHECK_TRUE(netaddr_from_string(&key, "10.0.0.0/14") == 0, "cannot parse 10.0.0.0/14");
+  CHECK_TRUE(netaddr_trie_find(&trie, &key) == NULL, "exact lookup returned branching vertex");
+
+  /* switch to a trie with duplicates */
+  netaddr_trie_clear(&trie);
+  CHECK_TRUE(!netaddr_trie_is_node_added(&elements[0].node), "cleared node is part of trie");
+  netaddr_trie_init(&trie, true);
+
+  CHECK_TRUE(add_element(0, "10.1.0.0/16") != NULL, "insert failed");
+  CHECK_TRUE(add_element(1, "10.1.0.0/16") != NULL, "duplicate prefix was rejected");
+  CHECK_TRUE(lookup_lpm("10.1.1.1") == &elements[0], "first duplicate not matched");
+
+  netaddr_trie_remove(&trie, &elements[0].node);
+  CHECK_TRUE(lookup_lpm("10.1.1.1") == &elements[1], "second duplicate not matched");
+
+  netaddr_trie_remove(&trie, &elements[1].node);
+  CHECK_TRUE(netaddr_trie_is_empty(&trie), "trie not empty");
+
+  END_TEST();
+}
+
+static void test_covered(void) {
+  static const char *prefixes[] = {
+      "10.1.2.3", "10.0.0.0/8", "10.1.2.0/24", "10.1.0.0/16", "11.0.0.0/8",
+      "10.128.0.0/9", "10.1.128.0/17", "9.0.0.0/8",
+  };
+  struct trie_element *e;
+  struct netaddr key;
+  uint32_t count, seen;
+  size_t i;
+
+  START_TEST();
+
+  for (i=0; i<ARRAYSIZE(prefixes); i++) {
+    CHECK_TRUE(add_element(i, prefixes[i]) != NULL, "insert of %s failed", prefixes[i]);
+  }
+
+  /* all IPv4 prefixes */
+  CHECK_TRUE(netaddr_from_string(&key, "0.0.0.0/0") == 0, "cannot parse 0.0.0.0/0");
+  count = 0;
+  netaddr_trie_for_each_covered_element(&trie, &key, e, node) {
+    count++;
+  }
+  CHECK_TRUE(count == ARRAYSIZE(prefixes), "iterated over %u instead of %u prefixes",
+      count, (unsigned)ARRAYSIZE(prefixes));
+
+  /* prefixes inside 10.1.0.0/16, shorter ones first */
+  CHECK_TRUE(netaddr_from_string(&key, "10.1.0.0/16") == 0, "cannot parse 10.1.0.0/16");
+  count = 0;
+  seen = 0;
+  netaddr_trie_for_each_covered_element(&trie, &key, e, node) {
+    CHECK_TRUE(netaddr_is_in_subnet(&key, &e->prefix), "iterated over prefix outside of subnet");
+    if (count == 0) {
+      CHECK_TRUE(e == &elements[3], "covering prefix itself was not iterated first");
+    }
+    seen |= 1u << (e - elements);
+    count++;
+  }
+  CHECK_TRUE(count == 4, "iterated over %u instead of 4 prefixes", count);
+  CHECK_TRUE(seen == 0x4d, "iterated over wrong prefixes (0x%x)", seen);
+
+  /* subnet between two vertices */
+  CHECK_TRUE(netaddr_from_string(&key, "10.1.2.0/23") == 0, "cannot parse 10.1.2.0/23");
+  count = 0;
+  netaddr_trie_for_each_covered_element(&trie, &key, e, node) {
+    count++;
+  }
+  CHECK_TRUE(count == 2, "iterated over %u instead of 2 prefixes", count);
+
+  /* subnet without prefixes */
+  CHECK_TRUE(netaddr_from_string(&key, "12.0.0.0/8") == 0, "cannot parse 12.0.0.0/8");
+  CHECK_TRUE(netaddr_trie_first_covered(&trie, &key) == NULL, "empty subnet has prefixes");
+
+  END_TEST();
+}
+
+static void test_random(void) {
+  struct trie_element *e, *best;
+  struct netaddr addr;
+  uint32_t i, j, round, errors;
+  uint8_t len;
+
+  START_TEST();
+
+  errors = 0;
+  for (round=0; round<8; round++) {
+    /* random prefixes from a small address range to get many branches */
+    for (i=0; i<COUNT; i++) {
+      memset(&elements[i].prefix, 0, sizeof(elements[i].prefix));
+      elements[i].prefix._type = AF_INET;
+      elements[i].prefix._addr[0] = 10;
+      elements[i].prefix._addr[1] = (uint8_t)(rand() % 4);
+      elements[i].prefix._addr[2] = (uint8_t)rand();
+      elements[i].prefix._addr[3] = (uint8_t)rand();
+      len = (uint8_t)(8 + rand() % 25);
+      elements[i].prefix._prefix_len = len;
+
+      elements[i].node.key = &elements[i].prefix;
+      if (netaddr_trie_find(&trie, &elements[i].prefix) == NULL) {
+        netaddr_trie_insert(&trie, &elements[i].node);
+      }
+    }
+
+    /* remove some of them again */
+    for (i=0; i<COUNT; i+=3) {
+      netaddr_trie_remove(&trie, &elements[i].node);
+    }
+
+    /* compare trie lookup with linear scan */
+    for (j=0; j<1000; j++) {
+      memset(&addr, 0, sizeof(addr));
+      addr._type = AF_INET;
+      addr._prefix_len = 32;
+      addr._addr[0] = 10;
+      addr._addr[1] = (uint8_t)(rand() % 4);
+      addr._addr[2] = (uint8_t)rand();
+      addr._addr[3] = (uint8_t)rand();
+
+      best = NULL;
+      for (i=0; i<COUNT; i++) {
+        if (netaddr_trie_is_node_added(&elements[i].node)
+            && netaddr_is_in_subnet(&elements[i].prefix, &addr)
+            && (best == NULL || best->prefix._prefix_len < elements[i].prefix._prefix_len)) {
+          best = &elements[i];
+        }
+      }
+
+      e = netaddr_trie_find_lpm_element(&trie, &addr, e, node);
+      if ((e == NULL) != (best == NULL)
+          || (e != NULL && e->prefix._prefix_len != best->prefix._prefix_len)) {
+        errors++;
+      }
+    }
+
+    netaddr_trie_clear(&trie);
+  }
+  CHECK_TRUE(errors == 0, "%u lookups differ from linear scan", errors);
+
+  END_TEST();
+}
+
+static void test_remove_all(void) {
+  char buffer[32];
+  uint32_t i;
+
+  START_TEST();
+
+  for (i=0; i<COUNT; i++) {
+    snprintf(buffer, sizeof(buffer), "10.%u.%u.0/%u", i % 7, i, 16 + i % 9);
+    elements[i].node.key = &elements[i].prefix;
+    CHECK_TRUE(netaddr_from_string(&elements[i].prefix, buffer) == 0, "cannot parse %s", buffer);
+    netaddr_trie_insert(&trie, &elements[i].node);
+  }
+
+  for (i=0; i<COUNT; i++) {
+    netaddr_trie_remove(&trie, &elements[(i * 7) % COUNT].node);
+  }
+  CHECK_TRUE(netaddr_trie_is_empty(&trie), "trie has %u nodes left", trie.count);
+  for (i=0; i<NETADDR_TRIE_FAMILIES; i++) {
+    CHECK_TRUE(trie._root[i] == NULL, "trie still has vertices for family %u", i);
+  }
+
+  END_TEST();
+}
+
+int main(int argc __attribute__ ((unused)), char **argv __attribute__ ((unused))) {
+  BEGIN_TESTING(clear_elements);
+
+  test_empty();
+  test_lpm_ipv4();
+  test_spm_ipv4();
+  test_families();
+  test_exact_and_duplicates();
+  test_covered();
+  test_random();
+  test_remove_all();
+
+  netaddr_trie_clear(&trie);
+  return FINISH_TESTING();
+}
@@ -0,0 +1,239 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "common/radix_heap.h"
+#include "cunit/cunit.h"
+
+struct heap_element {
+  uint32_t value;
+  struct radix_heap_node node;
+};
+
+#define COUNT 64
+
+static struct radix_heap heap;
+static struct heap_element elements[COUNT];
+
+static void clear_elements(void) {
+  uint32_t i;
+
+  memset(&heap, 0, sizeof(heap));
+  memset(elements, 0, sizeof(elements));
+
+  radix_heap_init(&heap);
+  for (i=0; i<COUNT; i++) {
+    elements[i].value = i;
+    list_init_node(&elements[i].node._list);
+  }
+}
+
+static void test_empty(void) {
+  START_TEST();
+
+  CHECK_TRUE(radix_heap_is_empty(&heap), "new heap is not empty");
+  CHECK_TRUE(radix_heap_extract_min(&heap) == NULL, "empty heap returned a node");
+  CHECK_TRUE(!radix_heap_is_node_added(&elements[0].node), "fresh node is part of heap");
+
+  radix_heap_insert(&heap, &elements[0].node, 42);
+  CHECK_TRUE(!radix_heap_is_empty(&heap), "heap is empty after insert");
+  CHECK_TRUE(radix_heap_is_node_added(&elements[0].node), "node is not part of heap");
+
+  radix_heap_remove(&heap, &elements[0].node);
+  CHECK_TRUE(radix_heap_is_empty(&heap), "heap is not empty after remove");
+
+  /* empty heap must accept smaller keys again */
+  radix_heap_insert(&heap, &elements[1].node, 1);
+  CHECK_TRUE(radix_heap_extract_min(&heap) == &elements[1].node, "extract after reset failed");
+
+  END_TEST();
+}
+
+static void test_extract_order(void) {
+  struct heap_element *e;
+  uint32_t i, last, count;
+
+  START_TEST();
+
+  for (i=0; i<COUNT; i++) {
+    radix_heap_insert(&heap, &elements[i].node, (uint32_t)(rand() % 100000));
+  }
+  CHECK_TRUE(heap.count == COUNT, "heap has %u instead of %d elements", heap.count, COUNT);
+
+  last = 0;
+  count = 0;
+  while ((e = radix_heap_extract_min_element(&heap, e, node)) != NULL) {
+    CHECK_TRUE(e->node.key >= last, "key %u extracted after key %u", e->node.key, last);
+    CHECK_TRUE(!radix_heap_is_node_added(&e->node), "extracted node still in heap");
+    last = e->node.key;
+    count++;
+  }
+  CHECK_TRUE(count == COUNT, "extracted %u instead of %d elements", count, COUNT);
+  CHECK_TRUE(radix_heap_is_empty(&heap), "heap not empty after extracting all nodes");
+
+  END_TEST();
+}
+
+static void test_monotone(void) {
+  struct heap_element *e;
+  uint32_t i, key;
+
+  START_TEST();
+
+  /* keep adding nodes with keys larger than the last extracted one */
+  radix_heap_insert(&heap, &elements[0].node, 10);
+  key = 10;
+  for (i=1; i<COUNT; i++) {
+    e = radix_heap_extract_min_element(&heap, e, node);
+    CHECK_TRUE(e != NULL && e->node.key == key,
+        "step %u: expected key %u, got %u", i, key, e ? e->node.key : 0);
+
+    key += i * 17;
+    radix_heap_insert(&heap, &elements[i].node, key);
+  }
+
+  e = radix_heap_extract_min_element(&heap, e, node);
+  CHECK_TRUE(e == &elements[COUNT-1], "last element not extracted");
+  CHECK_TRUE(radix_heap_is_empty(&heap), "heap not empty");
+
+  END_TEST();
+}
+
+static void test_same_key(void) {
+  struct heap_element *e;
+  uint32_t i;
+
+  START_TEST();
+
+  radix_heap_insert(&heap, &elements[COUNT-1].node, 1);
+  for (i=0; i<COUNT-1; i++) {
+    radix_heap_insert(&heap, &elements[i].node, 1000);
+  }
+
+  e = radix_heap_extract_min_element(&heap, e, node);
+  CHECK_TRUE(e == &elements[COUNT-1], "smallest key not extracted first");
+
+  for (i=0; i<COUNT-1; i++) {
+    e = radix_heap_extract_min_element(&heap, e, node);
+    CHECK_TRUE(e == &elements[i], "equal keys not extracted in insertion order (%u != %u)",
+        e ? e->value : 0, i);
+  }
+
+  END_TEST();
+}
+
+static void test_decrease_key(void) {
+  struct heap_element *e;
+
+  START_TEST();
+
+  radix_heap_insert(&heap, &elements[0].node, 100);
+  radix_heap_insert(&heap, &elements[1].node, 200);
+  radix_heap_insert(&heap, &elements[2].node, 300);
+
+  e = radix_heap_extract_min_element(&heap, e, node);
+  CHECK_TRUE(e == &elements[0], "first node not extracted");
+
+  radix_heap_decrease_key(&heap, &elements[2].node, 150);
+  CHECK_TRUE(heap.count == 2, "decrease key changed count to %u", heap.count);
+
+  e = radix_heap_extract_min_element(&heap, e, node);
+  CHECK_TRUE(e == &elements[2], "decreased node not extracted");
+  CHECK_TRUE(e->node.key == 150, "decreased node has key %u", e->node.key);
+
+  /* decrease to the current minimum */
+  radix_heap_insert(&heap, &elements[3].node, 500);
+  radix_heap_decrease_key(&heap, &elements[3].node, 150);
+
+  e = radix_heap_extract_min_element(&heap, e, node);
+  CHECK_TRUE(e == &elements[3], "node decreased to minimum not extracted");
+
+  e = radix_heap_extract_min_element(&heap, e, node);
+  CHECK_TRUE(e == &elements[1], "last node not extracted");
+  CHECK_TRUE(radix_heap_is_empty(&heap), "heap not empty");
+
+  END_TEST();
+}
+
+static void test_remove(void) {
+  struct heap_element *e;
+  uint32_t i;
+
+  START_TEST();
+
+  for (i=0; i<COUNT; i++) {
+    radix_heap_insert(&heap, &elements[i].node, i * 3);
+  }
+
+  /* remove all odd elements */
+  for (i=1; i<COUNT; i+=2) {
+    radix_heap_remove(&heap, &elements[i].node);
+  }
+  CHECK_TRUE(heap.count == COUNT/2, "heap has %u instead of %d elements", heap.count, COUNT/2);
+
+  for (i=0; i<COUNT; i+=2) {
+    e = radix_heap_extract_min_element(&heap, e, node);
+    CHECK_TRUE(e == &elements[i], "element %u not extracted (got %u)", i, e ? e->value : 0);
+  }
+  CHECK_TRUE(radix_heap_is_empty(&heap), "heap not empty");
+
+  END_TEST();
+}
+
+int main(int argc __attribute__ ((unused)), char **argv __attribute__ ((unused))) {
+  BEGIN_TESTING(clear_elements);
+
+  test_empty();
+  test_extract_order();
+  test_monotone();
+  test_same_key();
+  test_decrease_key();
+  test_remove();
+
+  return FINISH_TESTING();
+}
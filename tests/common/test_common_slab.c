@@ -0,0 +1,197 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "common/slab.h"
+#include "cunit/cunit.h"
+
+#define COUNT 1000
+
+static struct slab slab;
+static void *objects[COUNT];
+
+static void clear_elements(void) {
+  slab_release_empty(&slab);
+  memset(objects, 0, sizeof(objects));
+}
+
+static void test_page_size(void) {
+  START_TEST();
+
+  slab_init(&slab, 40);
+  CHECK_TRUE(slab.object_size == 48, "object size is %"PRINTF_SIZE_T_SPECIFIER, slab.object_size);
+  CHECK_TRUE(slab.page_size == SLAB_MIN_PAGE_SIZE, "page size is %"PRINTF_SIZE_T_SPECIFIER, slab.page_size);
+  CHECK_TRUE(slab.objects_per_page * slab.object_size <= slab.page_size - sizeof(struct slab_page),
+      "%u objects do not fit into page", slab.objects_per_page);
+
+  slab_init(&slab, 1000);
+  CHECK_TRUE(slab.objects_per_page >= SLAB_MIN_OBJECTS, "only %u objects per page", slab.objects_per_page);
+  CHECK_TRUE(slab.page_size == 8192, "page size is %"PRINTF_SIZE_T_SPECIFIER, slab.page_size);
+
+  slab_init(&slab, 100000);
+  CHECK_TRUE(slab.objects_per_page == 1, "%u objects per page", slab.objects_per_page);
+  CHECK_TRUE(slab.page_size == 131072, "page size is %"PRINTF_SIZE_T_SPECIFIER, slab.page_size);
+
+  END_TEST();
+}
+
+static void test_alloc_free(void) {
+  uint8_t *ptr;
+  uint32_t i, j;
+  bool zero;
+
+  START_TEST();
+
+  slab_init(&slab, 40);
+
+  for (i=0; i<COUNT; i++) {
+    objects[i] = slab_alloc(&slab);
+    CHECK_TRUE(objects[i] != NULL, "allocation %u failed", i);
+    if (objects[i] == NULL) {
+      continue;
+    }
+
+    ptr = objects[i];
+    zero = true;
+    for (j=0; j<slab.object_size; j++) {
+      zero &= ptr[j] == 0;
+    }
+    CHECK_TRUE(zero, "object %u is not zeroed", i);
+    memset(ptr, 0xaa, slab.object_size);
+  }
+
+  CHECK_TRUE(slab.used == COUNT, "slab has %u objects in use", slab.used);
+  CHECK_TRUE(slab.pages == (COUNT + slab.objects_per_page - 1) / slab.objects_per_page,
+      "slab has %u pages", slab.pages);
+  CHECK_TRUE(slab.allocated == COUNT, "%u objects allocated", slab.allocated);
+
+  /* free every second object, no page becomes empty */
+  for (i=0; i<COUNT; i+=2) {
+    slab_free(&slab, objects[i]);
+    objects[i] = NULL;
+  }
+  CHECK_TRUE(slab.used == COUNT/2, "slab has %u objects in use", slab.used);
+  CHECK_TRUE(slab_get_free(&slab) == slab.pages * slab.objects_per_page - COUNT/2,
+      "slab has %u free objects", slab_get_free(&slab));
+  CHECK_TRUE(slab_get_fragmentation(&slab) >= 50, "fragmentation is %u%%",
+      slab_get_fragmentation(&slab));
+
+  /* freed objects are used again before new pages are allocated */
+  for (i=0; i<COUNT; i+=2) {
+    objects[i] = slab_alloc(&slab);
+  }
+  CHECK_TRUE(slab.recycled == COUNT/2, "%u objects recycled", slab.recycled);
+  CHECK_TRUE(slab.allocated == COUNT, "%u objects allocated", slab.allocated);
+
+  /* objects must not overlap */
+  for (i=0; i<COUNT; i++) {
+    memset(objects[i], (int)(i & 0xff), slab.object_size);
+  }
+  for (i=0; i<COUNT; i++) {
+    ptr = objects[i];
+    CHECK_TRUE(ptr[0] == (i & 0xff) && ptr[slab.object_size-1] == (i & 0xff),
+        "object %u was overwritten", i);
+  }
+
+  for (i=0; i<COUNT; i++) {
+    slab_free(&slab, objects[i]);
+  }
+  CHECK_TRUE(slab.used == 0, "slab has %u objects in use", slab.used);
+  CHECK_TRUE(slab.pages == SLAB_KEEP_EMPTY_PAGES, "slab has %u pages", slab.pages);
+  CHECK_TRUE(slab.empty_pages == SLAB_KEEP_EMPTY_PAGES, "slab has %u empty pages", slab.empty_pages);
+
+  slab_release_empty(&slab);
+  CHECK_TRUE(slab.pages == 0, "slab has %u pages after release", slab.pages);
+  CHECK_TRUE(slab.empty_pages == 0, "slab has %u empty pages after release", slab.empty_pages);
+
+  END_TEST();
+}
+
+static void test_page_alignment(void) {
+  uintptr_t page;
+  uint32_t i;
+
+  START_TEST();
+
+  slab_init(&slab, 1000);
+  for (i=0; i<COUNT; i++) {
+    objects[i] = slab_alloc(&slab);
+  }
+
+  /* all objects of a page are within the page */
+  for (i=0; i<COUNT; i++) {
+    page = (uintptr_t)objects[i] & ~((uintptr_t)slab.page_size - 1);
+    CHECK_TRUE((uintptr_t)objects[i] + slab.object_size <= page + slab.page_size,
+        "object %u crosses page boundary", i);
+    CHECK_TRUE((uintptr_t)objects[i] % sizeof(struct list_entity) == 0,
+        "object %u is not aligned", i);
+  }
+
+  /* free in reverse order, pages become empty and are released */
+  for (i=COUNT; i>0; i--) {
+    slab_free(&slab, objects[i-1]);
+    CHECK_TRUE(slab.empty_pages <= SLAB_KEEP_EMPTY_PAGES, "%u empty pages after free %u",
+        slab.empty_pages, i-1);
+  }
+  CHECK_TRUE(slab.pages == SLAB_KEEP_EMPTY_PAGES, "slab has %u pages", slab.pages);
+
+  END_TEST();
+}
+
+int main(int argc __attribute__ ((unused)), char **argv __attribute__ ((unused))) {
+  slab_init(&slab, 1);
+
+  BEGIN_TESTING(clear_elements);
+
+  test_page_size();
+  test_alloc_free();
+  test_page_alignment();
+
+  slab_release_empty(&slab);
+  return FINISH_TESTING();
+}
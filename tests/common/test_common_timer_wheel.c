@@ -0,0 +1,319 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "common/timer_wheel.h"
+#include "cunit/cunit.h"
+
+struct wheel_element {
+  uint32_t value;
+  struct timer_wheel_node node;
+};
+
+#define COUNT 256
+
+static struct timer_wheel wheel;
+static struct wheel_element elements[COUNT];
+
+static void clear_elements(void) {
+  uint32_t i;
+
+  memset(&wheel, 0, sizeof(wheel));
+  memset(elements, 0, sizeof(elements));
+
+  timer_wheel_init(&wheel, 1000);
+  for (i=0; i<COUNT; i++) {
+    elements[i].value = i;
+    list_init_node(&elements[i].node._list);
+  }
+}
+
+static void test_empty(void) {
+  START_TEST();
+
+  CHECK_TRUE(timer_wheel_is_empty(&wheel), "new wheel is not empty");
+  CHECK_TRUE(timer_wheel_get_next(&wheel) == UINT64_MAX, "empty wheel has next event");
+  CHECK_TRUE(timer_wheel_get_expired(&wheel, 5000) == NULL, "empty wheel returned a node");
+
+  timer_wheel_insert(&wheel, &elements[0].node, 6000);
+  CHECK_TRUE(timer_wheel_is_node_added(&elements[0].node), "node is not part of wheel");
+  CHECK_TRUE(timer_wheel_get_next(&wheel) == 6000, "next event is %"PRIu64, timer_wheel_get_next(&wheel));
+
+  timer_wheel_remove(&wheel, &elements[0].node);
+  CHECK_TRUE(timer_wheel_is_empty(&wheel), "wheel is not empty after remove");
+  CHECK_TRUE(timer_wheel_get_next(&wheel) == UINT64_MAX, "empty wheel has next event");
+
+  END_TEST();
+}
+
+static void test_expire_order(void) {
+  struct wheel_element *e;
+  uint64_t tick, last;
+  uint32_t i, count;
+
+  START_TEST();
+
+  for (i=0; i<COUNT; i++) {
+    /* spread keys over multiple levels */
+    timer_wheel_insert(&wheel, &elements[i].node, 1001 + (uint64_t)(rand() % 200000));
+  }
+
+  last = 0;
+  count = 0;
+  for (tick = 1000; tick < 202000; tick += 37) {
+    while ((e = timer_wheel_get_expired_element(&wheel, tick, e, node)) != NULL) {
+      CHECK_TRUE(e->node.key <= tick, "key %"PRIu64" expired at tick %"PRIu64, e->node.key, tick);
+      CHECK_TRUE(e->node.key + 37 > tick, "key %"PRIu64" expired late at tick %"PRIu64, e->node.key, tick);
+      CHECK_TRUE(e->node.key >= last, "key %"PRIu64" expired after key %"PRIu64, e->node.key, last);
+      CHECK_TRUE(timer_wheel_get_next(&wheel) == e->node.key, "next event is not the expired node");
+
+      last = e->node.key;
+      timer_wheel_remove(&wheel, &e->node);
+      count++;
+    }
+  }
+
+  CHECK_TRUE(count == COUNT, "expired %u instead of %d elements", count, COUNT);
+  CHECK_TRUE(timer_wheel_is_empty(&wheel), "wheel not empty after expiring all nodes");
+
+  END_TEST();
+}
+
+static void test_same_key(void) {
+  struct wheel_element *e;
+  uint32_t i;
+
+  START_TEST();
+
+  for (i=0; i<COUNT; i++) {
+    timer_wheel_insert(&wheel, &elements[i].node, 70000);
+  }
+
+  CHECK_TRUE(timer_wheel_get_expired(&wheel, 69999) == NULL, "node expired too early");
+  for (i=0; i<COUNT; i++) {
+    e = timer_wheel_get_expired_element(&wheel, 70000, e, node);
+    CHECK_TRUE(e == &elements[i], "equal keys not expired in insertion order (%u != %u)",
+        e ? e->value : 0, i);
+    if (e) {
+      timer_wheel_remove(&wheel, &e->node);
+    }
+  }
+  CHECK_TRUE(timer_wheel_is_empty(&wheel), "wheel not empty");
+
+  END_TEST();
+}
+
+static void test_same_key_cascade(void) {
+  static const uint64_t keys[] = { 0x30080, (1ull << 33) + 7 };
+  struct wheel_element *e;
+  uint32_t i, k;
+
+  START_TEST();
+
+  for (k=0; k<ARRAYSIZE(keys); k++) {
+    /* first quarter is added far away from the key */
+    for (i=0; i<COUNT/4; i++) {
+      timer_wheel_insert(&wheel, &elements[i].node, keys[k]);
+    }
+
+    /* move the wheel into the block of the key, nodes move down */
+    CHECK_TRUE(timer_wheel_get_expired(&wheel, keys[k] & ~0xffffull) == NULL, "node expired too early");
+    for (; i<COUNT/2; i++) {
+      timer_wheel_insert(&wheel, &elements[i].node, keys[k]);
+    }
+
+    CHECK_TRUE(timer_wheel_get_expired(&wheel, keys[k] & ~0xffull) == NULL, "node expired too early");
+    for (; i<COUNT; i++) {
+      timer_wheel_insert(&wheel, &elements[i].node, keys[k]);
+    }
+
+    for (i=0; i<COUNT; i++) {
+      e = timer_wheel_get_expired_element(&wheel, keys[k], e, node);
+      CHECK_TRUE(e == &elements[i], "equal keys not expired in insertion order (%u != %u)",
+          e ? e->value : 0, i);
+      if (e) {
+        timer_wheel_remove(&wheel, &e->node);
+      }
+    }
+    CHECK_TRUE(timer_wheel_is_empty(&wheel), "wheel not empty");
+  }
+
+  END_TEST();
+}
+
+static void test_refresh(void) {
+  struct wheel_element *e;
+  uint32_t i;
+
+  START_TEST();
+
+  for (i=0; i<COUNT; i++) {
+    timer_wheel_insert(&wheel, &elements[i].node, 2000 + i);
+  }
+
+  /* move all even nodes far into the future */
+  for (i=0; i<COUNT; i+=2) {
+    timer_wheel_remove(&wheel, &elements[i].node);
+    timer_wheel_insert(&wheel, &elements[i].node, 5000000 + i);
+  }
+  CHECK_TRUE(wheel.count == COUNT, "wheel has %u instead of %d elements", wheel.count, COUNT);
+  CHECK_TRUE(timer_wheel_get_next(&wheel) == 2001, "next event is %"PRIu64, timer_wheel_get_next(&wheel));
+
+  for (i=1; i<COUNT; i+=2) {
+    e = timer_wheel_get_expired_element(&wheel, 4000000, e, node);
+    CHECK_TRUE(e == &elements[i], "element %u not expired (got %u)", i, e ? e->value : 0);
+    if (e) {
+      timer_wheel_remove(&wheel, &e->node);
+    }
+  }
+  CHECK_TRUE(timer_wheel_get_expired(&wheel, 4000000) == NULL, "refreshed node expired");
+
+  /* add a node between the current tick and the refreshed nodes */
+  timer_wheel_insert(&wheel, &elements[1].node, 4000100);
+  CHECK_TRUE(timer_wheel_get_next(&wheel) == 4000100, "next event is %"PRIu64, timer_wheel_get_next(&wheel));
+
+  e = timer_wheel_get_expired_element(&wheel, 6000000, e, node);
+  CHECK_TRUE(e == &elements[1], "new node not expired first");
+
+  END_TEST();
+}
+
+static void test_expired_insert(void) {
+  struct wheel_element *e;
+
+  START_TEST();
+
+  CHECK_TRUE(timer_wheel_get_expired(&wheel, 3000) == NULL, "empty wheel returned a node");
+
+  /* nodes before the current tick must fire immediately */
+  timer_wheel_insert(&wheel, &elements[0].node, 3001);
+  timer_wheel_insert(&wheel, &elements[1].node, 2500);
+  timer_wheel_insert(&wheel, &elements[2].node, 2000);
+  CHECK_TRUE(timer_wheel_get_next(&wheel) == 2000, "next event is %"PRIu64, timer_wheel_get_next(&wheel));
+
+  e = timer_wheel_get_expired_element(&wheel, 3000, e, node);
+  CHECK_TRUE(e == &elements[2], "oldest node not expired first");
+  timer_wheel_remove(&wheel, &e->node);
+
+  e = timer_wheel_get_expired_element(&wheel, 3000, e, node);
+  CHECK_TRUE(e == &elements[1], "second oldest node not expired");
+  timer_wheel_remove(&wheel, &e->node);
+
+  CHECK_TRUE(timer_wheel_get_expired(&wheel, 3000) == NULL, "future node expired");
+  CHECK_TRUE(timer_wheel_get_expired(&wheel, 3001) == &elements[0].node, "future node not expired");
+
+  END_TEST();
+}
+
+static void test_overflow(void) {
+  struct wheel_element *e;
+
+  START_TEST();
+
+  timer_wheel_insert(&wheel, &elements[0].node, 1ull << 40);
+  timer_wheel_insert(&wheel, &elements[1].node, (1ull << 40) - 1);
+  timer_wheel_insert(&wheel, &elements[2].node, 1ull << 33);
+
+  CHECK_TRUE(timer_wheel_get_next(&wheel) == (1ull << 33), "next event is %"PRIu64, timer_wheel_get_next(&wheel));
+  CHECK_TRUE(timer_wheel_get_expired(&wheel, (1ull << 33) - 1) == NULL, "node expired too early");
+
+  e = timer_wheel_get_expired_element(&wheel, 1ull << 41, e, node);
+  CHECK_TRUE(e == &elements[2], "first overflow node not expired");
+  timer_wheel_remove(&wheel, &e->node);
+
+  e = timer_wheel_get_expired_element(&wheel, 1ull << 41, e, node);
+  CHECK_TRUE(e == &elements[1], "second overflow node not expired");
+  timer_wheel_remove(&wheel, &e->node);
+
+  e = timer_wheel_get_expired_element(&wheel, 1ull << 41, e, node);
+  CHECK_TRUE(e == &elements[0], "third overflow node not expired");
+  timer_wheel_remove(&wheel, &e->node);
+
+  END_TEST();
+}
+
+static void _cb_count(struct timer_wheel_node *node, void *ptr) {
+  uint32_t *count = ptr;
+
+  (*count)++;
+  if (node->key & 1) {
+    timer_wheel_remove(&wheel, node);
+  }
+}
+
+static void test_for_each(void) {
+  uint32_t i, count;
+
+  START_TEST();
+
+  for (i=0; i<COUNT; i++) {
+    timer_wheel_insert(&wheel, &elements[i].node, 1000 + (uint64_t)i * 1001);
+  }
+
+  count = 0;
+  timer_wheel_for_each(&wheel, _cb_count, &count);
+  CHECK_TRUE(count == COUNT, "for_each visited %u of %d nodes", count, COUNT);
+  CHECK_TRUE(wheel.count == COUNT/2, "wheel has %u instead of %d elements", wheel.count, COUNT/2);
+
+  END_TEST();
+}
+
+int main(int argc __attribute__ ((unused)), char **argv __attribute__ ((unused))) {
+  BEGIN_TESTING(clear_elements);
+
+  test_empty();
+  test_expire_order();
+  test_same_key();
+  test_same_key_cascade();
+  test_refresh();
+  test_expired_insert();
+  test_overflow();
+  test_for_each();
+
+  return FINISH_TESTING();
+}
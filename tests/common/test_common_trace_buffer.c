@@ -0,0 +1,227 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "common/netaddr.h"
+#include "common/trace_buffer.h"
+#include "cunit/cunit.h"
+
+#define COUNT 20000
+
+static uint64_t memory[TRACE_BUFFER_MIN_SIZE / sizeof(uint64_t)];
+static struct trace_buffer tb;
+
+static void clear_elements(void) {
+  memset(memory, 0, sizeof(memory));
+  trace_buffer_init(&tb, memory, sizeof(memory));
+}
+
+static void test_format(void) {
+  struct trace_arg args[5];
+  struct netaddr addr;
+  char buf[128];
+
+  START_TEST();
+
+  CHECK_TRUE(netaddr_from_string(&addr, "10.0.0.1") == 0, "cannot parse address");
+
+  args[0].type = TRACE_ARG_NETADDR;
+  args[0].value.addr = &addr;
+  args[1].type = TRACE_ARG_STRING;
+  args[1].value.str = "eth0";
+  args[2].type = TRACE_ARG_U64;
+  args[2].value.u64 = 1ull << 40;
+  args[3].type = TRACE_ARG_S32;
+  args[3].value.s64 = -5;
+  args[4].type = TRACE_ARG_U32;
+  args[4].value.u64 = 255;
+
+  trace_format(buf, sizeof(buf), "Link %s (%s): %"PRIu64" %d %02x %%",
+      args, ARRAYSIZE(args));
+  CHECK_TRUE(strcmp(buf, "Link 10.0.0.1 (eth0): 1099511627776 -5 ff %") == 0,
+      "output was '%s'", buf);
+
+  /* missing arguments are skipped */
+  trace_format(buf, sizeof(buf), "value %u %u", args + 4, 1);
+  CHECK_TRUE(strcmp(buf, "value 255 ") == 0, "output was '%s'", buf);
+
+  /* output is truncated */
+  trace_format(buf, 8, "%s", args, 1);
+  CHECK_TRUE(strcmp(buf, "10.0.0.") == 0, "output was '%s'", buf);
+
+  END_TEST();
+}
+
+static void test_site_event(void) {
+  struct trace_buffer_iterator iterator;
+  struct trace_event event;
+  struct trace_site site;
+  struct trace_arg args[2];
+  struct timeval tv;
+  struct netaddr addr;
+  struct netaddr_str nbuf;
+  uint32_t id1, id2;
+
+  START_TEST();
+
+  CHECK_TRUE(netaddr_from_string(&addr, "fe80::1") == 0, "cannot parse address");
+  tv.tv_sec = 1000;
+  tv.tv_usec = 123456;
+
+  id1 = trace_buffer_add_site(&tb, "file.c", 12, "DEBUG", "nhdp", "neighbor %s: %u");
+  id2 = trace_buffer_add_site(&tb, "file.c", 20, "INFO", "nhdp", "text %s");
+  CHECK_TRUE(id1 == 1 && id2 == 2, "site ids are %u and %u", id1, id2);
+
+  CHECK_TRUE(trace_buffer_get_site(&tb, &site, id2), "site %u not found", id2);
+  CHECK_TRUE(site.line == 20 && strcmp(site.file, "file.c") == 0
+      && strcmp(site.severity, "INFO") == 0 && strcmp(site.source, "nhdp") == 0
+      && strcmp(site.format, "text %s") == 0, "wrong content of site %u", id2);
+  CHECK_TRUE(!trace_buffer_get_site(&tb, &site, 3), "unknown site found");
+
+  args[0].type = TRACE_ARG_NETADDR;
+  args[0].value.addr = &addr;
+  args[1].type = TRACE_ARG_U32;
+  args[1].value.u64 = 42;
+  trace_buffer_add_event(&tb, id1, &tv, args, 2);
+
+  args[0].type = TRACE_ARG_STRING;
+  args[0].value.str = "hello";
+  trace_buffer_add_event(&tb, id2, &tv, args, 1);
+
+  trace_buffer_iterator_init(&tb, &iterator);
+  CHECK_TRUE(trace_buffer_iterator_next(&tb, &iterator, &event), "first event missing");
+  CHECK_TRUE(event.site_id == id1 && event.arg_count == 2
+      && event.time.tv_sec == 1000 && event.time.tv_usec == 123456,
+      "wrong first event");
+  CHECK_TRUE(event.args[0].type == TRACE_ARG_NETADDR
+      && netaddr_cmp(event.args[0].value.addr, &addr) == 0,
+      "wrong address %s", netaddr_to_string(&nbuf, event.args[0].value.addr));
+  CHECK_TRUE(event.args[1].type == TRACE_ARG_U32 && event.args[1].value.u64 == 42,
+      "wrong integer %"PRIu64, event.args[1].value.u64);
+
+  CHECK_TRUE(trace_buffer_iterator_next(&tb, &iterator, &event), "second event missing");
+  CHECK_TRUE(event.site_id == id2 && event.arg_count == 1
+      && event.args[0].type == TRACE_ARG_STRING
+      && strcmp(event.args[0].value.str, "hello") == 0, "wrong second event");
+
+  CHECK_TRUE(!trace_buffer_iterator_next(&tb, &iterator, &event), "unexpected third event");
+
+  END_TEST();
+}
+
+static void test_ring_wrap(void) {
+  struct trace_buffer_iterator iterator;
+  struct trace_event event;
+  struct trace_arg arg;
+  struct timeval tv;
+  uint32_t i, count, expected;
+  uint32_t id;
+  bool order;
+
+  START_TEST();
+
+  id = trace_buffer_add_site(&tb, "file.c", 1, "DEBUG", "main", "%u");
+  memset(&tv, 0, sizeof(tv));
+
+  arg.type = TRACE_ARG_U32;
+  for (i=0; i<COUNT; i++) {
+    arg.value.u64 = i;
+    trace_buffer_add_event(&tb, id, &tv, &arg, 1);
+  }
+
+  CHECK_TRUE(tb.header->event_count == COUNT, "%"PRIu64" events written",
+      tb.header->event_count);
+  CHECK_TRUE(tb.header->event_overwritten > 0, "no event was overwritten");
+
+  /* the newest events must be in the buffer in order */
+  count = 0;
+  order = true;
+  expected = tb.header->event_overwritten;
+  trace_buffer_iterator_init(&tb, &iterator);
+  while (trace_buffer_iterator_next(&tb, &iterator, &event)) {
+    order &= event.args[0].value.u64 == expected;
+    expected++;
+    count++;
+  }
+
+  CHECK_TRUE(order, "events are not in order");
+  CHECK_TRUE(expected == COUNT, "last event was %u", expected - 1);
+  CHECK_TRUE(count + tb.header->event_overwritten == COUNT,
+      "%u events in buffer, %"PRIu64" overwritten", count, tb.header->event_overwritten);
+
+  END_TEST();
+}
+
+static void test_attach(void) {
+  struct trace_buffer tb2;
+
+  START_TEST();
+
+  CHECK_TRUE(trace_buffer_attach(&tb2, memory, sizeof(memory)) == 0, "cannot attach trace buffer");
+  CHECK_TRUE(trace_buffer_init(&tb2, memory, TRACE_BUFFER_MIN_SIZE / 2) != 0,
+      "too small trace buffer accepted");
+
+  tb.header->event_head = tb.header->event_size + 4;
+  CHECK_TRUE(trace_buffer_attach(&tb2, memory, sizeof(memory)) != 0, "corrupted trace buffer accepted");
+
+  memset(memory, 0, sizeof(memory));
+  CHECK_TRUE(trace_buffer_attach(&tb2, memory, sizeof(memory)) != 0, "empty memory accepted");
+
+  END_TEST();
+}
+
+int main(int argc __attribute__ ((unused)), char **argv __attribute__ ((unused))) {
+  BEGIN_TESTING(clear_elements);
+
+  test_format();
+  test_site_event();
+  test_ring_wrap();
+  test_attach();
+
+  return FINISH_TESTING();
+}
@@ -0,0 +1,309 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "common/common_types.h"
+#include "common/string.h"
+#include "core/oonf_appdata.h"
+#include "core/oonf_logging.h"
+#include "cunit/cunit.h"
+
+#define MAX_EVENTS 512
+
+struct logged_event {
+  enum oonf_log_severity severity;
+  bool no_header;
+  char text[256];
+};
+
+static void _cb_log(struct oonf_log_handler_entry *, struct oonf_log_parameters *);
+
+static struct oonf_appdata _appdata = {
+  .app_name = "test",
+};
+
+static struct oonf_log_handler_entry _handler = {
+  .handler = _cb_log,
+};
+
+static struct logged_event _events[MAX_EVENTS];
+static size_t _event_count;
+
+/* number of nested events the handler should log for the next event */
+static int _nested_logs;
+
+static void
+_cb_log(struct oonf_log_handler_entry *h __attribute__((unused)),
+    struct oonf_log_parameters *param) {
+  if (_event_count == MAX_EVENTS) {
+    return;
+  }
+
+  /* skip the walltime, it is different for synchronous and asynchronous events */
+  _events[_event_count].severity = param->severity;
+  _events[_event_count].no_header = param->no_header;
+  strscpy(_events[_event_count].text, param->buffer + param->timeLength,
+      sizeof(_events[_event_count].text));
+  _event_count++;
+
+  if (_nested_logs > 0) {
+    _nested_logs--;
+    oonf_log(LOG_SEVERITY_INFO, LOG_MAIN, true, __FILE__, __LINE__,
+        NULL, 0, "nested %d", _nested_logs);
+  }
+}
+
+static void
+_log_sequence(void) {
+  static const uint8_t hex[] = { 0x01, 0x02, 0x03, 0xfe, 0xff };
+  int i;
+
+  for (i = 0; i < 10; i++) {
+    oonf_log(LOG_SEVERITY_DEBUG, LOG_MAIN, false, __FILE__, __LINE__,
+        NULL, 0, "debug %d", i);
+    oonf_log(LOG_SEVERITY_INFO, LOG_MAIN, true, __FILE__, __LINE__,
+        NULL, 0, "info without header %d\n", i);
+    oonf_log(LOG_SEVERITY_WARN, LOG_MAIN, false, __FILE__, __LINE__,
+        hex, sizeof(hex), "warning with hexdump %d", i);
+  }
+}
+
+static void
+clear_elements(void) {
+  oonf_log_set_async(0, 0);
+  memset(_events, 0, sizeof(_events));
+  _event_count = 0;
+  _nested_logs = 0;
+}
+
+static void
+test_async_matches_sync(void) {
+  struct logged_event sync_events[MAX_EVENTS];
+  size_t sync_count, i;
+
+  START_TEST();
+
+  _log_sequence();
+  memcpy(sync_events, _events, sizeof(sync_events));
+  sync_count = _event_count;
+  CHECK_TRUE(sync_count == 30, "synchronous logging wrote %" PRINTF_SIZE_T_SPECIFIER " events", sync_count);
+
+  _event_count = 0;
+  CHECK_TRUE(oonf_log_set_async(16384, 100) == 0, "cannot allocate logging buffer");
+
+  _log_sequence();
+  CHECK_TRUE(_event_count == 0, "%" PRINTF_SIZE_T_SPECIFIER " events written before flush", _event_count);
+
+  oonf_log_flush();
+  CHECK_TRUE(_event_count == sync_count, "asynchronous logging wrote %" PRINTF_SIZE_T_SPECIFIER " events", _event_count);
+
+  for (i = 0; i < sync_count && i < _event_count; i++) {
+    CHECK_TRUE(_events[i].severity == sync_events[i].severity,
+        "event %" PRINTF_SIZE_T_SPECIFIER ": severity %d != %d",
+        i, _events[i].severity, sync_events[i].severity);
+    CHECK_TRUE(_events[i].no_header == sync_events[i].no_header,
+        "event %" PRINTF_SIZE_T_SPECIFIER ": header flag differs", i);
+    CHECK_TRUE(strcmp(_events[i].text, sync_events[i].text) == 0,
+        "event %" PRINTF_SIZE_T_SPECIFIER ": '%s' != '%s'", i, _events[i].text, sync_events[i].text);
+  }
+
+  END_TEST();
+}
+
+static void
+test_highwater_drop(void) {
+  uint32_t dropped;
+  int i, stored;
+
+  START_TEST();
+
+  dropped = oonf_log_get_dropped_count(LOG_MAIN);
+  CHECK_TRUE(oonf_log_set_async(1024, 50) == 0, "cannot allocate logging buffer");
+
+  for (i = 0; i < 100; i++) {
+    oonf_log(LOG_SEVERITY_DEBUG, LOG_MAIN, true, __FILE__, __LINE__,
+        NULL, 0, "debug %d", i);
+  }
+  CHECK_TRUE(_event_count == 0, "dropping debug events triggered a flush");
+  CHECK_TRUE(oonf_log_get_async_peak() <= 512, "buffer filled above high-water mark: %" PRINTF_SIZE_T_SPECIFIER,
+      oonf_log_get_async_peak());
+
+  /* warnings use the space above the high-water mark */
+  oonf_log(LOG_SEVERITY_WARN, LOG_MAIN, true, __FILE__, __LINE__,
+      NULL, 0, "warning");
+  CHECK_TRUE(_event_count == 0, "warning was not buffered");
+
+  oonf_log_flush();
+  stored = (int)_event_count - 1;
+  CHECK_TRUE(stored > 0 && stored < 100, "%d debug events stored", stored);
+  CHECK_TRUE(oonf_log_get_dropped_count(LOG_MAIN) - dropped == (uint32_t)(100 - stored),
+      "dropped counter %u, expected %d", oonf_log_get_dropped_count(LOG_MAIN) - dropped, 100 - stored);
+
+  /* the oldest events are kept, the newest are dropped */
+  for (i = 0; i < stored; i++) {
+    char expected[32];
+
+    snprintf(expected, sizeof(expected), "debug %d", i);
+    CHECK_TRUE(strcmp(_events[i].text, expected) == 0, "event %d: '%s'", i, _events[i].text);
+  }
+  CHECK_TRUE(strcmp(_events[stored].text, "warning") == 0,
+      "last event: '%s'", _events[stored].text);
+
+  END_TEST();
+}
+
+static void
+test_full_buffer_warning(void) {
+  char expected[32];
+  int i;
+
+  START_TEST();
+
+  CHECK_TRUE(oonf_log_set_async(1024, 100) == 0, "cannot allocate logging buffer");
+
+  /* warnings are never dropped, a full buffer is flushed instead */
+  for (i = 0; i < 100; i++) {
+    oonf_log(LOG_SEVERITY_WARN, LOG_MAIN, true, __FILE__, __LINE__,
+        NULL, 0, "warning %d", i);
+  }
+  CHECK_TRUE(_event_count > 0 && _event_count < 100,
+      "%" PRINTF_SIZE_T_SPECIFIER " events written before flush", _event_count);
+
+  oonf_log_flush();
+  CHECK_TRUE(_event_count == 100, "%" PRINTF_SIZE_T_SPECIFIER " events written", _event_count);
+  for (i = 0; i < 100 && (size_t)i < _event_count; i++) {
+    snprintf(expected, sizeof(expected), "warning %d", i);
+    CHECK_TRUE(strcmp(_events[i].text, expected) == 0, "event %d: '%s'", i, _events[i].text);
+  }
+
+  END_TEST();
+}
+
+static void
+test_reuse_after_flush(void) {
+  char expected[64];
+  size_t count;
+  int round, i;
+
+  START_TEST();
+
+  CHECK_TRUE(oonf_log_set_async(512, 100) == 0, "cannot allocate logging buffer");
+
+  /* records of different length, each round starts at the beginning of the buffer */
+  for (round = 0; round < 20; round++) {
+    _event_count = 0;
+    count = 1 + round % 5;
+    for (i = 0; (size_t)i < count; i++) {
+      oonf_log(LOG_SEVERITY_INFO, LOG_MAIN, true, __FILE__, __LINE__,
+          NULL, 0, "round %d event %d%*s", round, i, round, "");
+    }
+    CHECK_TRUE(_event_count == 0, "round %d: events written before flush", round);
+
+    oonf_log_flush();
+    CHECK_TRUE(_event_count == count, "round %d: %" PRINTF_SIZE_T_SPECIFIER " events written",
+        round, _event_count);
+
+    for (i = 0; (size_t)i < count && (size_t)i < _event_count; i++) {
+      snprintf(expected, sizeof(expected), "round %d event %d%*s", round, i, round, "");
+      CHECK_TRUE(strcmp(_events[i].text, expected) == 0,
+          "round %d event %d: '%s'", round, i, _events[i].text);
+    }
+  }
+  CHECK_TRUE(oonf_log_get_async_peak() <= 512, "peak %" PRINTF_SIZE_T_SPECIFIER " larger than buffer",
+      oonf_log_get_async_peak());
+
+  END_TEST();
+}
+
+static void
+test_log_during_flush(void) {
+  START_TEST();
+
+  CHECK_TRUE(oonf_log_set_async(4096, 100) == 0, "cannot allocate logging buffer");
+
+  oonf_log(LOG_SEVERITY_INFO, LOG_MAIN, true, __FILE__, __LINE__,
+      NULL, 0, "first");
+  oonf_log(LOG_SEVERITY_INFO, LOG_MAIN, true, __FILE__, __LINE__,
+      NULL, 0, "second");
+
+  /* events logged by a handler during the flush are written directly */
+  _nested_logs = 1;
+  oonf_log_flush();
+
+  CHECK_TRUE(_event_count == 3, "%" PRINTF_SIZE_T_SPECIFIER " events written", _event_count);
+  CHECK_TRUE(strcmp(_events[0].text, "first") == 0, "event 0: '%s'", _events[0].text);
+  CHECK_TRUE(strcmp(_events[1].text, "nested 0") == 0, "event 1: '%s'", _events[1].text);
+  CHECK_TRUE(strcmp(_events[2].text, "second") == 0, "event 2: '%s'", _events[2].text);
+
+  /* buffer is empty again */
+  _event_count = 0;
+  oonf_log_flush();
+  CHECK_TRUE(_event_count == 0, "%" PRINTF_SIZE_T_SPECIFIER " events written twice", _event_count);
+
+  END_TEST();
+}
+
+int
+main(int argc __attribute__ ((unused)), char **argv __attribute__ ((unused))) {
+  if (oonf_log_init(&_appdata, LOG_SEVERITY_WARN)) {
+    return 1;
+  }
+  _handler.user_bitmask[LOG_ALL] = LOG_SEVERITY_DEBUG;
+  oonf_log_addhandler(&_handler);
+
+  BEGIN_TESTING(clear_elements);
+
+  test_async_matches_sync();
+  test_highwater_drop();
+  test_full_buffer_warning();
+  test_reuse_after_flush();
+  test_log_during_flush();
+
+  oonf_log_cleanup();
+  return FINISH_TESTING();
+}
@@ -0,0 +1,548 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "common/autobuf.h"
+#include "core/oonf_appdata.h"
+#include "core/oonf_logging.h"
+#include "cunit/cunit.h"
+#include "subsystems/subsystem_helper.h"
+
+/* include the plugin to test the coalescing of subscription events */
+#include "generic/remotecontrol/remotecontrol.c"
+
+enum {
+  TEST_OBJECTS = 8,
+  TEST_KEYS = 12,
+  TEST_EVENTS = 2000,
+};
+
+struct _test_object {
+  int key;
+  int value;
+  bool alive;
+};
+
+struct _test_subscriber {
+  struct oonf_telnet_session telnet;
+  struct autobuf out;
+  struct _remotecontrol_subscription subscription;
+  struct _remotecontrol_subscribed_class sub_class;
+
+  /* keys the subscriber knows about according to its event stream */
+  bool known[TEST_KEYS];
+  int events;
+};
+
+static const char *_cb_to_keystring(struct oonf_objectkey_str *buf,
+    struct oonf_class *cl, void *ptr);
+static const char *_cb_to_statestring(struct oonf_objectstate_str *buf,
+    struct oonf_class *cl, void *ptr);
+
+static struct oonf_appdata _appdata = {
+  .app_name = "test",
+};
+
+static struct oonf_class _test_class = {
+  .name = "test object",
+  .size = sizeof(struct _test_object),
+  .to_keystring = _cb_to_keystring,
+  .to_statestring = _cb_to_statestring,
+};
+
+static struct _test_object _objects[TEST_OBJECTS];
+
+static const char *
+_cb_to_keystring(struct oonf_objectkey_str *buf,
+    struct oonf_class *cl __attribute__((unused)), void *ptr) {
+  struct _test_object *obj = ptr;
+
+  snprintf(buf->buf, sizeof(buf->buf), "key%d", obj->key);
+  return buf->buf;
+}
+
+static const char *
+_cb_to_statestring(struct oonf_objectstate_str *buf,
+    struct oonf_class *cl __attribute__((unused)), void *ptr) {
+  struct _test_object *obj = ptr;
+
+  buf->buf[0] = 0;
+  oonf_class_append_state(buf, "value", "%d", obj->value);
+  oonf_class_append_state(buf, "name", "obj%d", obj->key);
+  return buf->buf;
+}
+
+static void
+_fill_output(struct _test_subscriber *sub) {
+  size_t i;
+
+  /* a full output buffer keeps all events pending */
+  abuf_clear(&sub->out);
+  for (i = 0; i < REMOTECONTROL_SUBSCRIPTION_BACKLOG; i++) {
+    abuf_puts(&sub->out, " ");
+  }
+}
+
+static void
+_init_subscriber(struct _test_subscriber *sub, bool slow) {
+  memset(sub, 0, sizeof(*sub));
+  abuf_init(&sub->out);
+
+  sub->telnet.session.state = STREAM_SESSION_INACTIVE;
+  sub->telnet.data.out = &sub->out;
+  sub->telnet.data.stop_data[0] = &sub->subscription;
+
+  sub->subscription.data = &sub->telnet.data;
+  list_init_head(&sub->subscription.classes);
+  list_init_head(&sub->subscription.pending);
+  avl_init(&sub->subscription.pending_tree, _avl_comp_object, false);
+
+  sub->sub_class.class = &_test_class;
+  sub->sub_class.subscription = &sub->subscription;
+
+  if (slow) {
+    _fill_output(sub);
+  }
+}
+
+static void
+_cleanup_subscriber(struct _test_subscriber *sub) {
+  struct _remotecontrol_delta *delta, *delta_it;
+
+  list_for_each_element_safe(&sub->subscription.pending, delta, _list_node, delta_it) {
+    _remove_delta(&sub->subscription, delta);
+  }
+  abuf_free(&sub->out);
+}
+
+static void
+_event(struct _test_subscriber *sub, struct _test_object *obj, enum oonf_class_event evt) {
+  _cb_subscription_event(&sub->sub_class.ext, obj, evt);
+}
+
+static struct _remotecontrol_delta *
+_get_delta(struct _test_subscriber *sub, int idx) {
+  struct _remotecontrol_delta *delta;
+
+  list_for_each_element(&sub->subscription.pending, delta, _list_node) {
+    if (idx-- == 0) {
+      return delta;
+    }
+  }
+  return NULL;
+}
+
+static bool
+_check_delta(struct _test_subscriber *sub, int idx,
+    struct _test_object *obj, enum oonf_class_event evt, const char *key) {
+  struct _remotecontrol_delta *delta;
+
+  delta = _get_delta(sub, idx);
+  return delta != NULL && delta->object == obj && delta->event == evt
+      && strcmp(delta->key.buf, key) == 0;
+}
+
+/**
+ * Parse the JSON lines written by the subscription and apply them
+ * to the view of the subscriber.
+ * @param sub test subscriber
+ * @param offset first byte of the output that has not been parsed yet
+ */
+static void
+_consume_output(struct _test_subscriber *sub, size_t offset) {
+  char *line, *next, *event, *key;
+  int k;
+
+  for (line = abuf_getptr(&sub->out) + offset; *line; line = next) {
+    next = strchr(line, '\n');
+    CHECK_TRUE(next != NULL, "unterminated line: '%s'", line);
+    if (next == NULL) {
+      return;
+    }
+    *next++ = 0;
+
+    event = strstr(line, "\"event\"");
+    key = strstr(line, "\"key\"");
+    CHECK_TRUE(event != NULL && key != NULL, "bad line: '%s'", line);
+    if (event == NULL || key == NULL
+        || sscanf(strstr(key, "key\":") + 5, " \"key%d\"", &k) != 1) {
+      continue;
+    }
+    CHECK_TRUE(k >= 0 && k < TEST_KEYS, "bad key %d", k);
+    if (k < 0 || k >= TEST_KEYS) {
+      continue;
+    }
+
+    sub->events++;
+    if (strstr(event, "\"added\"")) {
+      CHECK_TRUE(!sub->known[k], "added known key%d", k);
+      sub->known[k] = true;
+    }
+    else if (strstr(event, "\"changed\"")) {
+      CHECK_TRUE(sub->known[k], "changed unknown key%d", k);
+    }
+    else if (strstr(event, "\"removed\"")) {
+      CHECK_TRUE(sub->known[k], "removed unknown key%d", k);
+      sub->known[k] = false;
+    }
+    else {
+      CHECK_TRUE(false, "bad event: '%s'", line);
+    }
+  }
+}
+
+/**
+ * Write all pending deltas of a slow subscriber, apply them to its view
+ * and fill up its output buffer again
+ * @param sub test subscriber
+ */
+static void
+_drain(struct _test_subscriber *sub) {
+  while (!list_is_empty(&sub->subscription.pending)) {
+    abuf_clear(&sub->out);
+    _cb_drain_subscription(&sub->telnet.data);
+    _consume_output(sub, 0);
+  }
+  _fill_output(sub);
+}
+
+static void
+clear_elements(void) {
+  memset(_objects, 0, sizeof(_objects));
+}
+
+static void
+test_added_removed(void) {
+  struct _test_subscriber sub;
+
+  START_TEST();
+
+  _init_subscriber(&sub, true);
+
+  /* subscriber never learns about a short-lived object */
+  _event(&sub, &_objects[0], OONF_OBJECT_ADDED);
+  _event(&sub, &_objects[0], OONF_OBJECT_REMOVED);
+  CHECK_TRUE(list_is_empty(&sub.subscription.pending), "added/removed object still pending");
+  CHECK_TRUE(sub.subscription.pending_tree.count == 0,
+      "%u deltas in tree", sub.subscription.pending_tree.count);
+
+  /* updates of a new object are part of the addition */
+  _event(&sub, &_objects[0], OONF_OBJECT_ADDED);
+  _event(&sub, &_objects[0], OONF_OBJECT_CHANGED);
+  CHECK_TRUE(sub.subscription.pending_tree.count == 1,
+      "%u deltas in tree", sub.subscription.pending_tree.count);
+  CHECK_TRUE(_check_delta(&sub, 0, &_objects[0], OONF_OBJECT_ADDED, "key0"),
+      "added/changed object not pending as added");
+
+  _cleanup_subscriber(&sub);
+  END_TEST();
+}
+
+static void
+test_changed_removed(void) {
+  struct _test_subscriber sub;
+
+  START_TEST();
+
+  _init_subscriber(&sub, true);
+
+  _event(&sub, &_objects[0], OONF_OBJECT_CHANGED);
+  _event(&sub, &_objects[0], OONF_OBJECT_CHANGED);
+  CHECK_TRUE(sub.subscription.pending_tree.count == 1,
+      "%u deltas in tree", sub.subscription.pending_tree.count);
+  CHECK_TRUE(_check_delta(&sub, 0, &_objects[0], OONF_OBJECT_CHANGED, "key0"),
+      "changed object not pending as changed");
+
+  _event(&sub, &_objects[0], OONF_OBJECT_REMOVED);
+  CHECK_TRUE(sub.subscription.pending_tree.count == 1,
+      "%u deltas in tree", sub.subscription.pending_tree.count);
+  CHECK_TRUE(_check_delta(&sub, 0, &_objects[0], OONF_OBJECT_REMOVED, "key0"),
+      "changed/removed object not pending as removed");
+
+  _cleanup_subscriber(&sub);
+  END_TEST();
+}
+
+static void
+test_removed_added(void) {
+  struct _test_subscriber sub;
+
+  START_TEST();
+
+  _init_subscriber(&sub, true);
+
+  /* memory reused for an object with the same key */
+  _event(&sub, &_objects[0], OONF_OBJECT_REMOVED);
+  _event(&sub, &_objects[0], OONF_OBJECT_ADDED);
+  CHECK_TRUE(sub.subscription.pending_tree.count == 1,
+      "%u deltas in tree", sub.subscription.pending_tree.count);
+  CHECK_TRUE(_check_delta(&sub, 0, &_objects[0], OONF_OBJECT_CHANGED, "key0"),
+      "removed/added object not pending as changed");
+  CHECK_TRUE(_get_delta(&sub, 1) == NULL, "more than one delta pending");
+
+  _cleanup_subscriber(&sub);
+  END_TEST();
+}
+
+static void
+test_pointer_reuse(void) {
+  struct _test_subscriber sub;
+
+  START_TEST();
+
+  _init_subscriber(&sub, true);
+
+  /* memory reused for an object with a different key */
+  _objects[0].key = 1;
+  _event(&sub, &_objects[0], OONF_OBJECT_REMOVED);
+  _event(&sub, &_objects[1], OONF_OBJECT_CHANGED);
+  _objects[0].key = 2;
+  _event(&sub, &_objects[0], OONF_OBJECT_ADDED);
+
+  CHECK_TRUE(_check_delta(&sub, 0, &_objects[0], OONF_OBJECT_REMOVED, "key1"),
+      "removal of old object not kept");
+  CHECK_TRUE(_check_delta(&sub, 1, &_objects[1], OONF_OBJECT_CHANGED, "key0"),
+      "unrelated delta not kept");
+  CHECK_TRUE(_check_delta(&sub, 2, &_objects[0], OONF_OBJECT_ADDED, "key2"),
+      "addition of new object not pending");
+  CHECK_TRUE(sub.subscription.pending_tree.count == 2,
+      "%u deltas in tree", sub.subscription.pending_tree.count);
+
+  /* further events of the new object go into the new delta */
+  _event(&sub, &_objects[0], OONF_OBJECT_REMOVED);
+  CHECK_TRUE(_check_delta(&sub, 0, &_objects[0], OONF_OBJECT_REMOVED, "key1"),
+      "removal of old object not kept");
+  CHECK_TRUE(_check_delta(&sub, 1, &_objects[1], OONF_OBJECT_CHANGED, "key0"),
+      "unrelated delta not kept");
+  CHECK_TRUE(_get_delta(&sub, 2) == NULL, "new object still pending");
+
+  _cleanup_subscriber(&sub);
+  END_TEST();
+}
+
+static void
+test_state_payload(void) {
+  struct _test_subscriber sub;
+
+  START_TEST();
+
+  _init_subscriber(&sub, false);
+
+  /* the state is part of additions and changes */
+  _objects[0].key = 3;
+  _objects[0].value = 5;
+  _event(&sub, &_objects[0], OONF_OBJECT_ADDED);
+  CHECK_TRUE(strcmp(abuf_getptr(&sub.out),
+      "{\"class\":\"test object\",\"event\":\"added\",\"key\":\"key3\","
+      "\"state\": {\"value\":5,\"name\":\"obj3\"}}\n") == 0,
+      "bad added output: '%s'", abuf_getptr(&sub.out));
+
+  /* a slow subscriber gets the state of the last event */
+  _fill_output(&sub);
+  _objects[0].value = 6;
+  _event(&sub, &_objects[0], OONF_OBJECT_CHANGED);
+  _objects[0].value = 7;
+  _event(&sub, &_objects[0], OONF_OBJECT_CHANGED);
+
+  abuf_clear(&sub.out);
+  _cb_drain_subscription(&sub.telnet.data);
+  CHECK_TRUE(strcmp(abuf_getptr(&sub.out),
+      "{\"class\":\"test object\",\"event\":\"changed\",\"key\":\"key3\","
+      "\"state\": {\"value\":7,\"name\":\"obj3\"}}\n") == 0,
+      "bad changed output: '%s'", abuf_getptr(&sub.out));
+
+  /* removals only carry the key */
+  abuf_clear(&sub.out);
+  _event(&sub, &_objects[0], OONF_OBJECT_REMOVED);
+  CHECK_TRUE(strcmp(abuf_getptr(&sub.out),
+      "{\"class\":\"test object\",\"event\":\"removed\",\"key\":\"key3\"}\n") == 0,
+      "bad removed output: '%s'", abuf_getptr(&sub.out));
+
+  _cleanup_subscriber(&sub);
+  END_TEST();
+}
+
+static void
+test_sent_output(void) {
+  struct _test_subscriber sub;
+  size_t i;
+
+  START_TEST();
+
+  _init_subscriber(&sub, false);
+
+  /* write into the output buffer of the stream session like telnet does */
+  abuf_init(&sub.telnet.session.out);
+  sub.telnet.data.out = &sub.telnet.session.out;
+
+  /* most of the buffer has already been sent to the peer */
+  for (i = 0; i < REMOTECONTROL_SUBSCRIPTION_BACKLOG; i++) {
+    abuf_puts(&sub.telnet.session.out, " ");
+  }
+  sub.telnet.session._out_offset = REMOTECONTROL_SUBSCRIPTION_BACKLOG - 16;
+
+  _event(&sub, &_objects[0], OONF_OBJECT_ADDED);
+  CHECK_TRUE(list_is_empty(&sub.subscription.pending),
+      "event kept pending because of output that was already sent");
+
+  /* unsent output still makes events coalesce */
+  sub.telnet.session._out_offset = 0;
+  _event(&sub, &_objects[1], OONF_OBJECT_ADDED);
+  CHECK_TRUE(_check_delta(&sub, 0, &_objects[1], OONF_OBJECT_ADDED, "key0"),
+      "event not pending with full unsent output");
+
+  abuf_free(&sub.telnet.session.out);
+  _cleanup_subscriber(&sub);
+  END_TEST();
+}
+
+static void
+test_random_against_uncoalesced(void) {
+  struct _test_subscriber fast, slow;
+  bool used[TEST_KEYS];
+  struct _test_object *obj;
+  size_t offset;
+  int i, k;
+
+  START_TEST();
+
+  /* the fast subscriber gets every event like before coalescing */
+  _init_subscriber(&fast, false);
+  _init_subscriber(&slow, true);
+  memset(used, 0, sizeof(used));
+  srand(42);
+
+  for (i = 0; i < TEST_EVENTS; i++) {
+    obj = &_objects[rand() % TEST_OBJECTS];
+
+    if (!obj->alive) {
+      /* reuse the memory, often with the key of a removed object */
+      do {
+        k = rand() % TEST_KEYS;
+      } while (used[k]);
+
+      obj->key = k;
+      obj->alive = true;
+      used[k] = true;
+      offset = abuf_getlen(&fast.out);
+      _event(&fast, obj, OONF_OBJECT_ADDED);
+      _consume_output(&fast, offset);
+      _event(&slow, obj, OONF_OBJECT_ADDED);
+    }
+    else if (rand() % 2) {
+      offset = abuf_getlen(&fast.out);
+      _event(&fast, obj, OONF_OBJECT_CHANGED);
+      _consume_output(&fast, offset);
+      _event(&slow, obj, OONF_OBJECT_CHANGED);
+    }
+    else {
+      offset = abuf_getlen(&fast.out);
+      _event(&fast, obj, OONF_OBJECT_REMOVED);
+      _consume_output(&fast, offset);
+      _event(&slow, obj, OONF_OBJECT_REMOVED);
+      obj->alive = false;
+      used[obj->key] = false;
+    }
+
+    CHECK_TRUE(list_is_empty(&fast.subscription.pending), "fast subscriber has pending deltas");
+    if (abuf_getlen(&fast.out) > REMOTECONTROL_SUBSCRIPTION_BACKLOG / 2) {
+      abuf_clear(&fast.out);
+    }
+
+    /* the slow subscriber never has more than one delta per object */
+    CHECK_TRUE(slow.subscription.pending_tree.count <= TEST_OBJECTS,
+        "%u deltas in tree", slow.subscription.pending_tree.count);
+
+    /* catch up from time to time */
+    if (rand() % 64 == 0) {
+      _drain(&slow);
+      CHECK_TRUE(memcmp(fast.known, slow.known, sizeof(fast.known)) == 0,
+          "slow subscriber view differs after %d events", i + 1);
+    }
+  }
+
+  _drain(&slow);
+  CHECK_TRUE(memcmp(fast.known, used, sizeof(used)) == 0, "fast subscriber view is wrong");
+  CHECK_TRUE(memcmp(slow.known, used, sizeof(used)) == 0, "slow subscriber view is wrong");
+  CHECK_TRUE(slow.events < fast.events, "no events coalesced (%d >= %d)",
+      slow.events, fast.events);
+
+  _cleanup_subscriber(&fast);
+  _cleanup_subscriber(&slow);
+  END_TEST();
+}
+
+int
+main(int argc __attribute__ ((unused)), char **argv __attribute__ ((unused))) {
+  int result;
+
+  if (oonf_log_init(&_appdata, LOG_SEVERITY_WARN)
+      || subsystem_helper_init(OONF_CLASS_SUBSYSTEM)) {
+    return 1;
+  }
+  oonf_class_add(&_test_class);
+  oonf_class_add(&_delta_class);
+
+  BEGIN_TESTING(clear_elements);
+
+  test_added_removed();
+  test_changed_removed();
+  test_removed_added();
+  test_pointer_reuse();
+  test_state_payload();
+  test_sent_output();
+  test_random_against_uncoalesced();
+
+  result = FINISH_TESTING();
+
+  oonf_class_remove(&_delta_class);
+  oonf_class_remove(&_test_class);
+  subsystem_helper_cleanup();
+  oonf_log_cleanup();
+  return result;
+}
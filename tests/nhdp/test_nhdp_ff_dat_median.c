@@ -0,0 +1,332 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "common/avl.h"
+#include "core/oonf_appdata.h"
+#include "core/oonf_logging.h"
+#include "cunit/cunit.h"
+#include "subsystems/subsystem_helper.h"
+
+/* include the metric to test its link speed history */
+#include "ff_dat_metric/ff_dat_metric.c"
+
+enum {
+  TEST_LINKS = 12,
+  TEST_UPDATES = 20000,
+  TEST_REMOVALS = 400,
+};
+
+static struct oonf_appdata _appdata = {
+  .app_name = "test",
+};
+
+static struct oonf_class *_interface_class, *_link_class;
+static struct nhdp_interface *_nhdp_if;
+static struct nhdp_link *_links[TEST_LINKS];
+
+/* link speeds of each link, indexed by link instead of history slot */
+static uint32_t _speeds[TEST_LINKS][DAT_SAMPLING_COUNT];
+
+/* Temporary buffer of the reference median calculation */
+static int _ref_sort_array[DAT_SAMPLING_COUNT];
+
+/*
+ * Reference implementation: the median calculation that copied
+ * and sorted the link speeds for every call
+ */
+
+static int
+_ref_int_comparator(const void *p1, const void *p2) {
+  const int *i1 = (int *)p1;
+  const int *i2 = (int *)p2;
+
+  if (*i1 > *i2) {
+    return 1;
+  }
+  else if (*i1 < *i2) {
+    return -1;
+  }
+  return 0;
+}
+
+static int
+_ref_get_median_rx_linkspeed(const uint32_t *speeds) {
+  int zero_count;
+  size_t window;
+  size_t i;
+
+  zero_count = 0;
+  for (i=0; i<DAT_SAMPLING_COUNT; i++) {
+    _ref_sort_array[i] = speeds[i];
+    if (_ref_sort_array[i] == 0) {
+      zero_count++;
+    }
+  }
+
+  window = DAT_SAMPLING_COUNT - zero_count;
+  if (window == 0) {
+    return 1;
+  }
+
+  qsort(_ref_sort_array, DAT_SAMPLING_COUNT, sizeof(int), _ref_int_comparator);
+
+  return _ref_sort_array[zero_count + window/2];
+}
+
+/**
+ * @return random scaled link speed with many zeros and repeated values
+ */
+static uint32_t
+_random_speed(void) {
+  switch (rand() % 8) {
+    case 0:
+    case 1:
+      return 0;
+    case 2:
+      return 1 + (uint32_t)(rand() % 100000);
+    default:
+      return 1 + (uint32_t)(rand() % 6);
+  }
+}
+
+static struct link_datff_data *
+_get_ldata(int link) {
+  return oonf_class_get_extension(&_link_extenstion, _links[link]);
+}
+
+static struct ff_dat_if_history *
+_get_history(void) {
+  struct ff_dat_if_config *ifconfig;
+
+  ifconfig = oonf_class_get_extension(&_nhdpif_extenstion, _nhdp_if);
+  return &ifconfig->history;
+}
+
+/**
+ * Allocate a history slot for a link, which starts without link speeds
+ * @param link index of link
+ */
+static void
+_add_link(int link) {
+  CHECK_TRUE(_add_history_slot(_links[link], _get_ldata(link)) == 0,
+      "link %d: cannot allocate history slot", link);
+  memset(_speeds[link], 0, sizeof(_speeds[link]));
+}
+
+/**
+ * Compare the history of all links with the reference implementation
+ * @param round number of the update round
+ */
+static void
+_check_links(int round) {
+  struct ff_dat_if_history *hist;
+  struct link_datff_data *ldata;
+  size_t zero_count, i;
+  bool sorted;
+  int link;
+
+  hist = _get_history();
+  for (link = 0; link < TEST_LINKS; link++) {
+    ldata = _get_ldata(link);
+    if (!ldata->has_slot) {
+      continue;
+    }
+
+    CHECK_TRUE(ldata->slot < hist->count && hist->links[ldata->slot] == _links[link],
+        "round %d: link %d lost its slot %u", round, link, ldata->slot);
+
+    CHECK_TRUE(memcmp(hist->scaled_speed[ldata->slot], _speeds[link], sizeof(_speeds[link])) == 0,
+        "round %d: link %d has wrong link speeds", round, link);
+
+    zero_count = 0;
+    sorted = true;
+    for (i=0; i<DAT_SAMPLING_COUNT; i++) {
+      if (_speeds[link][i] == 0) {
+        zero_count++;
+      }
+      if (i > 0 && hist->sorted_speed[ldata->slot][i-1] > hist->sorted_speed[ldata->slot][i]) {
+        sorted = false;
+      }
+    }
+    CHECK_TRUE(hist->zero_speeds[ldata->slot] == zero_count,
+        "round %d: link %d has %u zero speeds instead of %" PRINTF_SIZE_T_SPECIFIER,
+        round, link, hist->zero_speeds[ldata->slot], zero_count);
+    CHECK_TRUE(sorted, "round %d: link %d sorted speeds are not ascending", round, link);
+
+    CHECK_TRUE(_get_median_rx_linkspeed(hist, ldata->slot) == _ref_get_median_rx_linkspeed(_speeds[link]),
+        "round %d: link %d median %d instead of %d", round, link,
+        _get_median_rx_linkspeed(hist, ldata->slot), _ref_get_median_rx_linkspeed(_speeds[link]));
+  }
+}
+
+/**
+ * Store a random link speed into a random history entry of a link
+ * @param link index of link
+ */
+static void
+_update_link(int link) {
+  struct link_datff_data *ldata;
+  uint16_t idx;
+  uint32_t speed;
+
+  ldata = _get_ldata(link);
+  idx = (uint16_t)(rand() % DAT_SAMPLING_COUNT);
+  speed = _random_speed();
+
+  _set_scaled_speed(_get_history(), ldata->slot, idx, speed);
+  _speeds[link][idx] = speed;
+}
+
+static void
+clear_elements(void) {
+  int link;
+
+  srand(42);
+
+  _free_history(_nhdp_if, oonf_class_get_extension(&_nhdpif_extenstion, _nhdp_if));
+  for (link = 0; link < TEST_LINKS; link++) {
+    _add_link(link);
+  }
+}
+
+static void
+test_random_histories(void) {
+  int round;
+
+  START_TEST();
+
+  _check_links(-1);
+  for (round = 0; round < TEST_UPDATES; round++) {
+    _update_link(rand() % TEST_LINKS);
+    _check_links(round);
+  }
+
+  END_TEST();
+}
+
+static void
+test_remove_history_slot(void) {
+  int round, link, i;
+
+  START_TEST();
+
+  for (round = 0; round < TEST_REMOVALS; round++) {
+    for (i = 0; i < TEST_LINKS * 4; i++) {
+      link = rand() % TEST_LINKS;
+      if (_get_ldata(link)->has_slot) {
+        _update_link(link);
+      }
+    }
+    _check_links(round);
+
+    /* the last slot moves into the gap of the removed link */
+    link = rand() % TEST_LINKS;
+    if (_get_ldata(link)->has_slot) {
+      _remove_history_slot(_links[link], _get_ldata(link));
+    }
+    _check_links(round);
+
+    /* bring a link back into a fresh slot at the end */
+    link = rand() % TEST_LINKS;
+    if (!_get_ldata(link)->has_slot) {
+      _add_link(link);
+    }
+    _check_links(round);
+  }
+
+  END_TEST();
+}
+
+int
+main(int argc __attribute__ ((unused)), char **argv __attribute__ ((unused))) {
+  int link, result;
+
+  if (oonf_log_init(&_appdata, LOG_SEVERITY_WARN)
+      || subsystem_helper_init(OONF_FF_DAT_METRIC_SUBSYSTEM)) {
+    return 1;
+  }
+
+  _interface_class = avl_find_element(oonf_class_get_tree(), NHDP_CLASS_INTERFACE, _interface_class, _node);
+  _link_class = avl_find_element(oonf_class_get_tree(), NHDP_CLASS_LINK, _link_class, _node);
+  if (_interface_class == NULL || _link_class == NULL) {
+    return 1;
+  }
+
+  /* the links are not added to the NHDP database, only to the metric history */
+  _nhdp_if = oonf_class_malloc(_interface_class);
+  if (_nhdp_if == NULL) {
+    return 1;
+  }
+  list_init_head(&_nhdp_if->_links);
+  for (link = 0; link < TEST_LINKS; link++) {
+    _links[link] = oonf_class_malloc(_link_class);
+    if (_links[link] == NULL) {
+      return 1;
+    }
+    _links[link]->local_if = _nhdp_if;
+    list_add_tail(&_nhdp_if->_links, &_links[link]->_if_node);
+  }
+
+  BEGIN_TESTING(clear_elements);
+
+  test_random_histories();
+  test_remove_history_slot();
+
+  result = FINISH_TESTING();
+
+  _free_history(_nhdp_if, oonf_class_get_extension(&_nhdpif_extenstion, _nhdp_if));
+  for (link = 0; link < TEST_LINKS; link++) {
+    oonf_class_free(_link_class, _links[link]);
+  }
+  oonf_class_free(_interface_class, _nhdp_if);
+
+  subsystem_helper_cleanup();
+  oonf_log_cleanup();
+  return result;
+}
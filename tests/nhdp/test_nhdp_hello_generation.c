@@ -0,0 +1,396 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "common/avl.h"
+#include "common/avl_comp.h"
+#include "common/netaddr.h"
+#include "core/oonf_appdata.h"
+#include "core/oonf_logging.h"
+#include "cunit/cunit.h"
+#include "subsystems/subsystem_helper.h"
+#include "subsystems/oonf_class.h"
+#include "subsystems/oonf_rfc5444.h"
+#include "subsystems/rfc5444/rfc5444_iana.h"
+#include "subsystems/rfc5444/rfc5444_reader.h"
+
+#include "nhdp/nhdp.h"
+#include "nhdp/nhdp_db.h"
+#include "nhdp/nhdp_domain.h"
+#include "nhdp/nhdp_interfaces.h"
+
+enum {
+  TEST_VTIME = 3600000,
+  TEST_REPLAYS = 10,
+};
+
+static struct oonf_appdata _appdata = {
+  .app_name = "test",
+};
+
+/* metric that takes the link metrics from the HELLO */
+static struct nhdp_domain_metric _test_metric = {
+  .name = "test metric",
+};
+
+static struct nhdp_domain *_domain;
+
+/* local address, interface and originator of the neighbor, 2-hop neighbor */
+static struct netaddr _local_addr, _neigh_if_addr, _neigh_originator, _twohop_addr;
+static union netaddr_socket _neigh_socket;
+
+/* local NHDP interface the HELLOs are received on */
+static struct nhdp_interface *_nhdp_if;
+static struct nhdp_interface_addr _nhdp_if_addr;
+static struct os_interface _os_if;
+
+/* RFC5444 interface of the HELLOs */
+static struct oonf_rfc5444_protocol *_protocol;
+static struct oonf_rfc5444_interface _test_interface;
+static struct list_entity _active_sockets;
+
+static uint8_t _packet[1500];
+static size_t _packet_len;
+
+static void
+_put8(uint8_t value) {
+  _packet[_packet_len++] = value;
+}
+
+static void
+_put16(uint16_t value) {
+  _put8(value >> 8);
+  _put8(value & 255);
+}
+
+static void
+_set16(size_t offset, uint16_t value) {
+  _packet[offset] = value >> 8;
+  _packet[offset + 1] = value & 255;
+}
+
+static void
+_put_addr(const struct netaddr *addr) {
+  memcpy(&_packet[_packet_len], netaddr_get_binptr(addr), netaddr_get_binlength(addr));
+  _packet_len += netaddr_get_binlength(addr);
+}
+
+static void
+_put_tlv8(uint8_t type, uint8_t value) {
+  _put8(type);
+  _put8(RFC5444_TLV_FLAG_VALUE);
+  _put8(1);
+  _put8(value);
+}
+
+static void
+_put_metric_tlv(uint32_t cost, enum rfc7181_linkmetric_flags flag) {
+  struct rfc7181_metric_field metric;
+
+  memset(&metric, 0, sizeof(metric));
+  CHECK_TRUE(rfc7181_metric_encode(&metric, cost) == 0, "cannot encode metric %u", cost);
+  rfc7181_metric_set_flag(&metric, flag);
+
+  _put8(RFC7181_ADDRTLV_LINK_METRIC);
+  _put8(RFC5444_TLV_FLAG_VALUE);
+  _put8(sizeof(metric));
+  _put8(metric.b[0]);
+  _put8(metric.b[1]);
+}
+
+/**
+ * Receive a HELLO of the neighbor that reports a symmetric link
+ * to the local interface and a symmetric 2-hop neighbor, then run
+ * the batched metric recalculation like the end of the event loop
+ * iteration would do.
+ * @param link_cost outgoing link metric reported by the neighbor
+ * @param twohop_cost metric between neighbor and 2-hop neighbor
+ */
+static void
+_receive_hello(uint32_t link_cost, uint32_t twohop_cost) {
+  size_t msg_start, tlv_start;
+
+  _packet_len = 0;
+
+  /* packet header without sequence number and tlvs */
+  _put8(0);
+
+  /* message header */
+  msg_start = _packet_len;
+  _put8(RFC6130_MSGTYPE_HELLO);
+  _put8(RFC5444_MSG_FLAG_ORIGINATOR | RFC5444_MSG_FLAG_HOPLIMIT
+      | RFC5444_MSG_FLAG_HOPCOUNT | (4 - 1));
+  _put16(0);
+  _put_addr(&_neigh_originator);
+  _put8(1);
+  _put8(0);
+
+  /* message tlvs */
+  tlv_start = _packet_len;
+  _put16(0);
+  _put_tlv8(RFC5497_MSGTLV_VALIDITY_TIME, rfc5497_timetlv_encode(TEST_VTIME));
+  _set16(tlv_start, _packet_len - tlv_start - 2);
+
+  /* interface address of the neighbor */
+  _put8(1);
+  _put8(0);
+  _put_addr(&_neigh_if_addr);
+
+  tlv_start = _packet_len;
+  _put16(0);
+  _put_tlv8(RFC6130_ADDRTLV_LOCAL_IF, RFC6130_LOCALIF_THIS_IF);
+  _set16(tlv_start, _packet_len - tlv_start - 2);
+
+  /* the local interface, heard by the neighbor */
+  _put8(1);
+  _put8(0);
+  _put_addr(&_local_addr);
+
+  tlv_start = _packet_len;
+  _put16(0);
+  _put_tlv8(RFC6130_ADDRTLV_LINK_STATUS, RFC6130_LINKSTATUS_SYMMETRIC);
+  _put_metric_tlv(link_cost, RFC7181_LINKMETRIC_INCOMING_LINK);
+  _set16(tlv_start, _packet_len - tlv_start - 2);
+
+  /* symmetric 2-hop neighbor on another interface */
+  _put8(1);
+  _put8(0);
+  _put_addr(&_twohop_addr);
+
+  tlv_start = _packet_len;
+  _put16(0);
+  _put_tlv8(RFC6130_ADDRTLV_OTHER_NEIGHB, RFC6130_OTHERNEIGHB_SYMMETRIC);
+  _put_metric_tlv(twohop_cost, RFC7181_LINKMETRIC_OUTGOING_NEIGH);
+  _set16(tlv_start, _packet_len - tlv_start - 2);
+
+  _set16(msg_start + 2, _packet_len - msg_start);
+
+  CHECK_TRUE(rfc5444_reader_handle_packet(&_protocol->reader, _packet, _packet_len)
+      == RFC5444_OKAY, "HELLO was not parsed");
+
+  nhdp_domain_process_metric_changes();
+}
+
+/**
+ * @return link of the neighbor, NULL if there is none
+ */
+static struct nhdp_link *
+_get_link(void) {
+  struct nhdp_neighbor *neigh;
+
+  neigh = nhdp_db_neighbor_get_by_originator(&_neigh_originator);
+  if (neigh == NULL || list_is_empty(&neigh->_links)) {
+    return NULL;
+  }
+  return list_first_element(&neigh->_links, (struct nhdp_link *)NULL, _neigh_node);
+}
+
+static void
+clear_elements(void) {
+  struct nhdp_neighbor *neigh, *n_it;
+
+  /* start each test without neighbors */
+  list_for_each_element_safe(nhdp_db_get_neigh_list(), neigh, _global_node, n_it) {
+    nhdp_db_neighbor_remove(neigh);
+  }
+  nhdp_domain_process_metric_changes();
+}
+
+static void
+test_unchanged_hello(void) {
+  const struct nhdp_domain_metric_stats *stats;
+  struct nhdp_link *lnk;
+  uint64_t generation;
+  uint32_t batches;
+  int i;
+
+  START_TEST();
+
+  stats = nhdp_domain_get_metric_stats();
+
+  generation = nhdp_db_get_generation();
+  _receive_hello(1000, 2000);
+  CHECK_TRUE(nhdp_db_get_generation() != generation, "new neighbor did not change generation");
+
+  lnk = _get_link();
+  CHECK_TRUE(lnk != NULL, "no link to neighbor");
+  if (lnk == NULL) {
+    END_TEST();
+    return;
+  }
+  CHECK_TRUE(lnk->status == NHDP_LINK_SYMMETRIC, "link is not symmetric: %d", lnk->status);
+  CHECK_TRUE(nhdp_domain_get_linkdata(_domain, lnk)->metric.out == 1000,
+      "link metric is %u", nhdp_domain_get_linkdata(_domain, lnk)->metric.out);
+  CHECK_TRUE(lnk->_2hop.count == 1, "link has %u 2-hop neighbors", lnk->_2hop.count);
+
+  /* periodic HELLOs with the same content */
+  generation = nhdp_db_get_generation();
+  for (i = 0; i < TEST_REPLAYS; i++) {
+    batches = stats->batches;
+    _receive_hello(1000, 2000);
+
+    /* nothing changed, so nothing is recalculated */
+    CHECK_TRUE(stats->batches == batches, "replay %d: %u metric batches", i, stats->batches - batches);
+    CHECK_TRUE(nhdp_db_get_generation() == generation,
+        "replay %d: identical HELLO changed generation", i);
+  }
+
+  END_TEST();
+}
+
+static void
+test_changed_hello(void) {
+  uint64_t generation;
+
+  START_TEST();
+
+  _receive_hello(1000, 2000);
+
+  generation = nhdp_db_get_generation();
+  _receive_hello(3000, 2000);
+  CHECK_TRUE(nhdp_db_get_generation() != generation, "link metric change kept generation");
+
+  generation = nhdp_db_get_generation();
+  _receive_hello(3000, 4000);
+  CHECK_TRUE(nhdp_db_get_generation() != generation, "2-hop metric change kept generation");
+
+  /* and the new state is stable again */
+  generation = nhdp_db_get_generation();
+  _receive_hello(3000, 4000);
+  CHECK_TRUE(nhdp_db_get_generation() == generation, "replay changed generation");
+
+  /* losing the neighbor changes the neighbor set */
+  generation = nhdp_db_get_generation();
+  clear_elements();
+  CHECK_TRUE(nhdp_db_get_generation() != generation, "removed neighbor kept generation");
+
+  END_TEST();
+}
+
+int
+main(int argc __attribute__ ((unused)), char **argv __attribute__ ((unused))) {
+  struct oonf_class *interface_class;
+  int result;
+
+  if (oonf_log_init(&_appdata, LOG_SEVERITY_WARN)
+      || subsystem_helper_init(OONF_NHDP_SUBSYSTEM)) {
+    return 1;
+  }
+
+  if (netaddr_from_binary(&_local_addr, (uint8_t[]) { 10, 0, 0, 1 }, 4, AF_INET)
+      || netaddr_from_binary(&_neigh_if_addr, (uint8_t[]) { 10, 0, 0, 2 }, 4, AF_INET)
+      || netaddr_from_binary(&_neigh_originator, (uint8_t[]) { 10, 0, 1, 2 }, 4, AF_INET)
+      || netaddr_from_binary(&_twohop_addr, (uint8_t[]) { 10, 0, 0, 3 }, 4, AF_INET)
+      || netaddr_from_binary(&_os_if.mac, (uint8_t[]) { 2, 0, 0, 0, 0, 1 }, 6, AF_MAC48)
+      || netaddr_socket_init(&_neigh_socket, &_neigh_if_addr, 269, 0)) {
+    return 1;
+  }
+
+  if (nhdp_domain_metric_add(&_test_metric)) {
+    return 1;
+  }
+  _domain = nhdp_domain_configure(0, _test_metric.name,
+      CFG_DOMAIN_NO_METRIC_MPR, RFC7181_WILLINGNESS_DEFAULT);
+  if (_domain == NULL) {
+    return 1;
+  }
+
+  /* NHDP interface without operating system interface and sockets */
+  interface_class = avl_find_element(oonf_class_get_tree(), NHDP_CLASS_INTERFACE, interface_class, _node);
+  if (interface_class == NULL) {
+    return 1;
+  }
+  _nhdp_if = oonf_class_malloc(interface_class);
+  if (_nhdp_if == NULL) {
+    return 1;
+  }
+  strscpy(_test_interface.name, "test0", sizeof(_test_interface.name));
+  _nhdp_if->rfc5444_if.interface = &_test_interface;
+  _nhdp_if->os_if_listener.data = &_os_if;
+  _nhdp_if->l_hold_time = TEST_VTIME;
+  _nhdp_if->n_hold_time = TEST_VTIME;
+
+  avl_init(&_nhdp_if->_if_addresses, avl_comp_netaddr, false);
+  list_init_head(&_nhdp_if->_links);
+  avl_init(&_nhdp_if->_link_addresses, avl_comp_netaddr, false);
+  avl_init(&_nhdp_if->_link_originators, avl_comp_netaddr, true);
+  avl_init(&_nhdp_if->_if_twohops, avl_comp_netaddr, true);
+
+  _nhdp_if->_node.key = _test_interface.name;
+  avl_insert(nhdp_interface_get_tree(), &_nhdp_if->_node);
+
+  _nhdp_if_addr.if_addr = _local_addr;
+  _nhdp_if_addr.interf = _nhdp_if;
+  _nhdp_if_addr._if_node.key = &_nhdp_if_addr.if_addr;
+  avl_insert(&_nhdp_if->_if_addresses, &_nhdp_if_addr._if_node);
+
+  /* the reader only accepts HELLOs from an active IPv4 socket */
+  list_init_head(&_active_sockets);
+  list_add_tail(&_active_sockets, &_test_interface._socket.socket_v4.node);
+
+  _protocol = oonf_rfc5444_get_default_protocol();
+  _protocol->input.src_address = &_neigh_if_addr;
+  _protocol->input.src_socket = &_neigh_socket;
+  _protocol->input.interface = &_test_interface;
+
+  BEGIN_TESTING(clear_elements);
+
+  test_unchanged_hello();
+  test_changed_hello();
+
+  result = FINISH_TESTING();
+
+  clear_elements();
+  avl_remove(nhdp_interface_get_tree(), &_nhdp_if->_node);
+  oonf_class_free(interface_class, _nhdp_if);
+  nhdp_domain_metric_remove(&_test_metric);
+
+  subsystem_helper_cleanup();
+  oonf_log_cleanup();
+  return result;
+}
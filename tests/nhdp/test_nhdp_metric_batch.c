@@ -0,0 +1,397 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "common/avl.h"
+#include "common/avl_comp.h"
+#include "common/netaddr.h"
+#include "core/oonf_appdata.h"
+#include "core/oonf_logging.h"
+#include "cunit/cunit.h"
+#include "subsystems/subsystem_helper.h"
+#include "subsystems/oonf_class.h"
+
+#include "nhdp/nhdp.h"
+#include "nhdp/nhdp_db.h"
+#include "nhdp/nhdp_domain.h"
+#include "nhdp/nhdp_interfaces.h"
+
+enum {
+  TEST_NEIGHBORS = 4,
+  TEST_DOMAINS = 2,
+};
+
+static void _cb_metric_update(struct nhdp_domain *domain);
+
+static struct oonf_appdata _appdata = {
+  .app_name = "test",
+};
+
+/* one metric per domain, so link metrics can change in one domain only */
+static struct nhdp_domain_metric _test_metric[TEST_DOMAINS] = {
+  { .name = "test metric 0" },
+  { .name = "test metric 1" },
+};
+
+static struct nhdp_domain *_domain[TEST_DOMAINS];
+
+static struct nhdp_domain_listener _listener = {
+  .metric_update = _cb_metric_update,
+};
+
+/* number of metric_update callbacks per domain */
+static int _metric_updates[TEST_DOMAINS];
+
+/* local NHDP interface of all links */
+static struct nhdp_interface *_nhdp_if;
+static struct oonf_rfc5444_interface _test_interface;
+static struct os_interface _os_if;
+
+static struct nhdp_neighbor *_neigh[TEST_NEIGHBORS];
+
+static void
+_cb_metric_update(struct nhdp_domain *domain) {
+  _metric_updates[domain->index]++;
+}
+
+/**
+ * Process an outgoing link metric like the HELLO reader does
+ * @param domain NHDP domain
+ * @param lnk NHDP link
+ * @param cost outgoing link metric reported by the neighbor
+ */
+static void
+_set_link_metric(struct nhdp_domain *domain, struct nhdp_link *lnk, uint32_t cost) {
+  struct rfc7181_metric_field metric;
+
+  memset(&metric, 0, sizeof(metric));
+  CHECK_TRUE(rfc7181_metric_encode(&metric, cost) == 0, "cannot encode metric %u", cost);
+  rfc7181_metric_set_flag(&metric, RFC7181_LINKMETRIC_INCOMING_LINK);
+
+  nhdp_domain_process_metric_linktlv(domain, lnk, metric.b);
+}
+
+/**
+ * Add a symmetric link to a neighbor
+ * @param neigh NHDP neighbor
+ * @param cost0 outgoing link metric in first domain
+ * @param cost1 outgoing link metric in second domain
+ * @return new link
+ */
+static struct nhdp_link *
+_add_link(struct nhdp_neighbor *neigh, uint32_t cost0, uint32_t cost1) {
+  struct nhdp_link *lnk;
+
+  lnk = nhdp_db_link_add(neigh, _nhdp_if);
+  if (lnk == NULL) {
+    return NULL;
+  }
+  lnk->status = NHDP_LINK_SYMMETRIC;
+  nhdp_domain_delayed_metric_recalculation(NULL, neigh);
+
+  _set_link_metric(_domain[0], lnk, cost0);
+  _set_link_metric(_domain[1], lnk, cost1);
+  return lnk;
+}
+
+/**
+ * @param domain_idx index of NHDP domain
+ * @param neigh NHDP neighbor
+ * @return outgoing metric of the neighbor
+ */
+static uint32_t
+_get_neigh_metric(int domain_idx, struct nhdp_neighbor *neigh) {
+  return nhdp_domain_get_neighbordata(_domain[domain_idx], neigh)->metric.out;
+}
+
+static void
+clear_elements(void) {
+  struct nhdp_neighbor *neigh, *n_it;
+
+  list_for_each_element_safe(nhdp_db_get_neigh_list(), neigh, _global_node, n_it) {
+    nhdp_db_neighbor_remove(neigh);
+  }
+  nhdp_domain_process_metric_changes();
+  memset(_neigh, 0, sizeof(_neigh));
+  memset(_metric_updates, 0, sizeof(_metric_updates));
+}
+
+/**
+ * Create the test neighbors, each with one symmetric link
+ * @return -1 if out of memory, 0 otherwise
+ */
+static int
+_add_neighbors(void) {
+  int i;
+
+  for (i = 0; i < TEST_NEIGHBORS; i++) {
+    _neigh[i] = nhdp_db_neighbor_add();
+    if (_neigh[i] == NULL || _add_link(_neigh[i], 1000, 1000) == NULL) {
+      return -1;
+    }
+  }
+  nhdp_domain_process_metric_changes();
+  memset(_metric_updates, 0, sizeof(_metric_updates));
+  return 0;
+}
+
+static void
+test_batch_recalculation(void) {
+  const struct nhdp_domain_metric_stats *stats;
+  struct nhdp_domain_metric_stats old_stats;
+  struct nhdp_link *lnk;
+  int i;
+
+  START_TEST();
+
+  CHECK_TRUE(_add_neighbors() == 0, "cannot create neighbors");
+  stats = nhdp_domain_get_metric_stats();
+  memcpy(&old_stats, stats, sizeof(old_stats));
+
+  /* several changes of all neighbors in one event loop iteration */
+  for (i = 0; i < TEST_NEIGHBORS; i++) {
+    lnk = list_first_element(&_neigh[i]->_links, lnk, _neigh_node);
+    _set_link_metric(_domain[0], lnk, 2000);
+    _set_link_metric(_domain[0], lnk, 3000);
+    nhdp_domain_delayed_metric_recalculation(_domain[0], _neigh[i]);
+  }
+
+  /* nothing is recalculated before the end of the iteration */
+  for (i = 0; i < TEST_NEIGHBORS; i++) {
+    CHECK_TRUE(_get_neigh_metric(0, _neigh[i]) == 1000,
+        "neighbor %d metric recalculated early: %u", i, _get_neigh_metric(0, _neigh[i]));
+  }
+  CHECK_TRUE(_metric_updates[0] == 0, "%d early metric updates", _metric_updates[0]);
+
+  nhdp_domain_process_metric_changes();
+
+  /* each neighbor is recalculated once, only in the changed domain */
+  CHECK_TRUE(stats->batches == old_stats.batches + 1,
+      "%u batches", stats->batches - old_stats.batches);
+  CHECK_TRUE(stats->recalculated == old_stats.recalculated + TEST_NEIGHBORS,
+      "%u recalculated metrics", stats->recalculated - old_stats.recalculated);
+  CHECK_TRUE(stats->skipped == old_stats.skipped + TEST_NEIGHBORS * (TEST_DOMAINS - 1),
+      "%u skipped metrics", stats->skipped - old_stats.skipped);
+  for (i = 0; i < TEST_NEIGHBORS; i++) {
+    CHECK_TRUE(_get_neigh_metric(0, _neigh[i]) == 3000,
+        "neighbor %d metric is %u", i, _get_neigh_metric(0, _neigh[i]));
+    CHECK_TRUE(_get_neigh_metric(1, _neigh[i]) == 1000,
+        "neighbor %d metric in unchanged domain is %u", i, _get_neigh_metric(1, _neigh[i]));
+  }
+
+  /* listeners learn once about the changed domain and nothing about the other */
+  CHECK_TRUE(_metric_updates[0] == 1, "%d metric updates for changed domain", _metric_updates[0]);
+  CHECK_TRUE(_metric_updates[1] == 0, "%d metric updates for unchanged domain", _metric_updates[1]);
+
+  /* an empty batch does nothing */
+  nhdp_domain_process_metric_changes();
+  CHECK_TRUE(stats->batches == old_stats.batches + 1,
+      "%u batches without changes", stats->batches - old_stats.batches);
+  CHECK_TRUE(_metric_updates[0] == 1, "%d metric updates without changes", _metric_updates[0]);
+
+  END_TEST();
+}
+
+static void
+test_unchanged_metric(void) {
+  struct nhdp_link *lnk;
+  int i;
+
+  START_TEST();
+
+  CHECK_TRUE(_add_neighbors() == 0, "cannot create neighbors");
+
+  /* dirty neighbors without a different result */
+  for (i = 0; i < TEST_NEIGHBORS; i++) {
+    lnk = list_first_element(&_neigh[i]->_links, lnk, _neigh_node);
+    _set_link_metric(_domain[1], lnk, 1000);
+    nhdp_domain_delayed_metric_recalculation(NULL, _neigh[i]);
+  }
+  nhdp_domain_process_metric_changes();
+
+  CHECK_TRUE(_metric_updates[0] == 0, "%d metric updates for domain 0", _metric_updates[0]);
+  CHECK_TRUE(_metric_updates[1] == 0, "%d metric updates for domain 1", _metric_updates[1]);
+
+  END_TEST();
+}
+
+static void
+test_immediate_recalculation(void) {
+  struct nhdp_link *lnk;
+
+  START_TEST();
+
+  CHECK_TRUE(_add_neighbors() == 0, "cannot create neighbors");
+  lnk = list_first_element(&_neigh[0]->_links, lnk, _neigh_node);
+
+  /* unchanged metric */
+  CHECK_TRUE(!nhdp_domain_recalculate_metrics(NULL, _neigh[0]), "unchanged metric reported");
+
+  /* changed metric is reported for its domain */
+  _set_link_metric(_domain[1], lnk, 2000);
+  CHECK_TRUE(nhdp_domain_recalculate_metrics(_domain[1], _neigh[0]),
+      "changed metric not reported");
+  CHECK_TRUE(_get_neigh_metric(1, _neigh[0]) == 2000,
+      "neighbor metric is %u", _get_neigh_metric(1, _neigh[0]));
+  CHECK_TRUE(_metric_updates[1] == 1, "%d metric updates for domain 1", _metric_updates[1]);
+
+  /* but not for other domains */
+  _set_link_metric(_domain[1], lnk, 3000);
+  CHECK_TRUE(!nhdp_domain_recalculate_metrics(_domain[0], _neigh[0]),
+      "change in other domain reported");
+
+  /* pending delayed changes are processed too */
+  lnk = list_first_element(&_neigh[1]->_links, lnk, _neigh_node);
+  _set_link_metric(_domain[0], lnk, 3000);
+  CHECK_TRUE(nhdp_domain_recalculate_metrics(NULL, _neigh[0]),
+      "delayed change not processed");
+  CHECK_TRUE(_get_neigh_metric(0, _neigh[1]) == 3000,
+      "neighbor metric is %u", _get_neigh_metric(0, _neigh[1]));
+
+  END_TEST();
+}
+
+static void
+test_remove_best_link(void) {
+  struct nhdp_neighbor_domaindata *neighdata0, *neighdata1;
+  struct nhdp_link *best, *other;
+
+  START_TEST();
+
+  CHECK_TRUE(_add_neighbors() == 0, "cannot create neighbors");
+
+  /* a second link that is only better in the second domain */
+  best = list_first_element(&_neigh[0]->_links, best, _neigh_node);
+  other = _add_link(_neigh[0], 2000, 500);
+  CHECK_TRUE(other != NULL, "cannot create second link");
+  if (other == NULL) {
+    END_TEST();
+    return;
+  }
+  nhdp_domain_process_metric_changes();
+  memset(_metric_updates, 0, sizeof(_metric_updates));
+
+  neighdata0 = nhdp_domain_get_neighbordata(_domain[0], _neigh[0]);
+  neighdata1 = nhdp_domain_get_neighbordata(_domain[1], _neigh[0]);
+  CHECK_TRUE(neighdata0->best_out_link == best, "wrong best link in domain 0");
+  CHECK_TRUE(neighdata1->best_out_link == other, "wrong best link in domain 1");
+
+  /* the neighbor must not point to the removed link until the next batch */
+  nhdp_db_link_remove(best);
+  CHECK_TRUE(neighdata0->best_out_link == other, "best link not recalculated on removal");
+  CHECK_TRUE(neighdata0->metric.out == 2000, "neighbor metric is %u", neighdata0->metric.out);
+  CHECK_TRUE(neighdata1->best_out_link == other, "best link of other domain changed");
+
+  nhdp_domain_process_metric_changes();
+  CHECK_TRUE(_metric_updates[0] == 1, "%d metric updates for domain 0", _metric_updates[0]);
+  CHECK_TRUE(_metric_updates[1] == 0, "%d metric updates for domain 1", _metric_updates[1]);
+
+  END_TEST();
+}
+
+int
+main(int argc __attribute__ ((unused)), char **argv __attribute__ ((unused))) {
+  struct oonf_class *interface_class;
+  int i, result;
+
+  if (oonf_log_init(&_appdata, LOG_SEVERITY_WARN)
+      || subsystem_helper_init(OONF_NHDP_SUBSYSTEM)) {
+    return 1;
+  }
+
+  for (i = 0; i < TEST_DOMAINS; i++) {
+    if (nhdp_domain_metric_add(&_test_metric[i])) {
+      return 1;
+    }
+    _domain[i] = nhdp_domain_configure(i, _test_metric[i].name,
+        CFG_DOMAIN_NO_METRIC_MPR, RFC7181_WILLINGNESS_DEFAULT);
+    if (_domain[i] == NULL) {
+      return 1;
+    }
+  }
+  nhdp_domain_listener_add(&_listener);
+
+  /* NHDP interface without operating system interface and sockets */
+  interface_class = avl_find_element(oonf_class_get_tree(), NHDP_CLASS_INTERFACE, interface_class, _node);
+  if (interface_class == NULL) {
+    return 1;
+  }
+  _nhdp_if = oonf_class_malloc(interface_class);
+  if (_nhdp_if == NULL) {
+    return 1;
+  }
+  strscpy(_test_interface.name, "test0", sizeof(_test_interface.name));
+  _nhdp_if->rfc5444_if.interface = &_test_interface;
+  _nhdp_if->os_if_listener.data = &_os_if;
+
+  avl_init(&_nhdp_if->_if_addresses, avl_comp_netaddr, false);
+  list_init_head(&_nhdp_if->_links);
+  avl_init(&_nhdp_if->_link_addresses, avl_comp_netaddr, false);
+  avl_init(&_nhdp_if->_link_originators, avl_comp_netaddr, true);
+  avl_init(&_nhdp_if->_if_twohops, avl_comp_netaddr, true);
+
+  BEGIN_TESTING(clear_elements);
+
+  test_batch_recalculation();
+  test_unchanged_metric();
+  test_immediate_recalculation();
+  test_remove_best_link();
+
+  result = FINISH_TESTING();
+
+  clear_elements();
+  oonf_class_free(interface_class, _nhdp_if);
+  nhdp_domain_listener_remove(&_listener);
+  for (i = 0; i < TEST_DOMAINS; i++) {
+    nhdp_domain_metric_remove(&_test_metric[i]);
+  }
+
+  subsystem_helper_cleanup();
+  oonf_log_cleanup();
+  return result;
+}
@@ -0,0 +1,574 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "common/avl.h"
+#include "common/netaddr.h"
+#include "core/oonf_appdata.h"
+#include "core/oonf_logging.h"
+#include "cunit/cunit.h"
+
+/* some of the random graphs are too large for the MPR engine */
+#define MPR_RFC7181_ENGINE_MAX_CELLS 150
+
+/* include the MPR selection and the routing neighbor graph */
+#include "mpr/neighbor-graph.c"
+#include "mpr/neighbor-graph-routing.c"
+#include "mpr/neighbor-graph-snapshot.c"
+#include "mpr/selection-rfc7181.c"
+
+enum {
+  TEST_NEIGHBORS = 12,
+  TEST_LINKS = 2 * TEST_NEIGHBORS,
+  TEST_TWOHOPS = 24,
+  TEST_GRAPHS = 200,
+  TEST_UPDATES = 20,
+};
+
+/**
+ * Result of a MPR selection
+ */
+struct _test_result {
+  /* index of neighbors in M */
+  bool mpr[TEST_NEIGHBORS];
+
+  /* selection_is_mpr flag of neighbors */
+  bool selected[TEST_NEIGHBORS];
+
+  /* addresses of 2-hop pool that are part of N */
+  bool n[TEST_NEIGHBORS + TEST_TWOHOPS];
+};
+
+static struct oonf_appdata _appdata = {
+  .app_name = "test",
+};
+
+static struct nhdp_domain _domain;
+static struct nhdp_neighbor _neighbors[TEST_NEIGHBORS];
+
+static struct mpr_neighbor_snapshot _snapshot;
+static struct mpr_snapshot_neighbor _s_neighbors[TEST_NEIGHBORS];
+static struct mpr_snapshot_link _s_links[TEST_LINKS];
+static struct netaddr _s_twohops[TEST_LINKS * (TEST_NEIGHBORS + TEST_TWOHOPS)];
+static struct netaddr _s_addresses[TEST_NEIGHBORS];
+static uint32_t _neigh_in[TEST_NEIGHBORS];
+static uint8_t _neigh_willingness[TEST_NEIGHBORS];
+static uint32_t _twohop_in[ARRAYSIZE(_s_twohops)];
+static uint32_t _twohop_out[ARRAYSIZE(_s_twohops)];
+
+/* 2-hop addresses, the neighbor addresses followed by nodes without a link */
+static struct netaddr _pool[TEST_NEIGHBORS + TEST_TWOHOPS];
+
+/*
+ * Reference implementation: the AVL based selection that was used
+ * before the bitset engine
+ */
+
+static unsigned int
+_ref_calculate_r(const struct nhdp_domain *domain, struct neighbor_graph *graph,
+    struct n1_node *x_node) {
+  struct addr_node *y_node;
+  struct n1_node *z_node;
+  uint32_t r, d_x_y, min_d_z_y;
+  bool already_covered;
+
+  /* if x is an MPR node already, we know the result must be 0 */
+  if (x_node->neigh->selection_is_mpr) {
+    return 0;
+  }
+
+  r = 0;
+
+  avl_for_each_element(&graph->set_n, y_node, _avl_node) {
+    /* calculate the cost to reach y through x */
+    d_x_y = graph->methods->calculate_d_x_y(domain, graph, x_node, y_node);
+
+    /* calculate the minimum cost to reach y through any node from N1 */
+    min_d_z_y = mpr_calculate_minimal_d_z_y(domain, graph, y_node);
+
+    if (d_x_y > min_d_z_y) {
+      continue;
+    }
+
+    /* check if y is already covered by a minimum-cost node */
+    already_covered = false;
+
+    avl_for_each_element(&graph->set_n1, z_node, _avl_node) {
+      if (graph->methods->calculate_d_x_y(domain, graph, z_node, y_node) == min_d_z_y
+          && z_node->neigh->selection_is_mpr) {
+        already_covered = true;
+        break;
+      }
+    }
+    if (already_covered) {
+      continue;
+    }
+
+    r++;
+  }
+  return r;
+}
+
+static void
+_ref_calculate(const struct nhdp_domain *domain, struct neighbor_graph *graph) {
+  struct avl_tree candidates;
+  struct n1_node *node_n1, *possible_mpr_node;
+  struct addr_node *y_node;
+  uint32_t n1_count, d1_y, possible_mprs, prop, greatest_prop, i;
+  bool add_to_n;
+
+  n1_count = graph->set_n1.count;
+  graph->d_x_y_cache = calloc(n1_count * graph->set_n2.count + 1, sizeof(uint32_t));
+
+  i = 0;
+  avl_for_each_element(&graph->set_n1, node_n1, _avl_node) {
+    node_n1->table_offset = i++;
+  }
+  i = 0;
+  avl_for_each_element(&graph->set_n2, y_node, _avl_node) {
+    y_node->table_offset = i;
+    i += n1_count;
+  }
+
+  /* calculate N */
+  avl_for_each_element(&graph->set_n2, y_node, _avl_node) {
+    add_to_n = false;
+
+    d1_y = graph->methods->calculate_d1_x_of_n2_addr(domain, graph, y_node);
+    if (d1_y == RFC7181_METRIC_INFINITE) {
+      add_to_n = true;
+    }
+    else {
+      avl_for_each_element(&graph->set_n1, node_n1, _avl_node) {
+        if (graph->methods->calculate_d_x_y(domain, graph, node_n1, y_node) < d1_y) {
+          add_to_n = true;
+          break;
+        }
+      }
+    }
+
+    if (add_to_n) {
+      mpr_add_addr_node_to_set(&graph->set_n, y_node->addr, y_node->table_offset);
+    }
+  }
+
+  /* WILL_ALWAYS */
+  avl_for_each_element(&graph->set_n1, node_n1, _avl_node) {
+    if (graph->methods->get_willingness_n1(domain, node_n1) == RFC7181_WILLINGNESS_ALWAYS) {
+      mpr_add_n1_node_to_set(&graph->set_mpr, node_n1->neigh,
+          node_n1->link, node_n1->table_offset);
+    }
+  }
+
+  /* unique MPRs */
+  avl_for_each_element(&graph->set_n, y_node, _avl_node) {
+    possible_mprs = 0;
+    possible_mpr_node = NULL;
+
+    avl_for_each_element(&graph->set_n1, node_n1, _avl_node) {
+      if (graph->methods->calculate_d2_x_y(domain, graph, node_n1, y_node)
+          <= RFC7181_METRIC_MAX) {
+        possible_mprs++;
+        possible_mpr_node = node_n1;
+      }
+    }
+    if (possible_mprs == 1) {
+      mpr_add_n1_node_to_set(&graph->set_mpr, possible_mpr_node->neigh,
+          possible_mpr_node->link, possible_mpr_node->table_offset);
+      possible_mpr_node->neigh->selection_is_mpr = true;
+    }
+  }
+
+  /* remaining nodes, first one with the greatest R(x,M) */
+  avl_init(&candidates, avl_comp_netaddr, false);
+  while (true) {
+    greatest_prop = 0;
+    mpr_clear_n1_set(&candidates);
+
+    avl_for_each_element(&graph->set_n1, node_n1, _avl_node) {
+      prop = _ref_calculate_r(domain, graph, node_n1);
+      if (prop == 0 || prop < greatest_prop) {
+        continue;
+      }
+      if (prop > greatest_prop) {
+        greatest_prop = prop;
+        mpr_clear_n1_set(&candidates);
+      }
+      mpr_add_n1_node_to_set(&candidates, node_n1->neigh,
+          node_n1->link, node_n1->table_offset);
+    }
+
+    if (candidates.count == 0) {
+      break;
+    }
+
+    node_n1 = avl_first_element(&candidates, node_n1, _avl_node);
+    mpr_add_n1_node_to_set(&graph->set_mpr, node_n1->neigh,
+        node_n1->link, node_n1->table_offset);
+    node_n1->neigh->selection_is_mpr = true;
+  }
+  mpr_clear_n1_set(&candidates);
+}
+
+/*
+ * Random NHDP database snapshot
+ */
+
+static uint32_t
+_random_metric(void) {
+  if (rand() % 16 == 0) {
+    return RFC7181_METRIC_INFINITE;
+  }
+
+  /* few different values to create ties */
+  return RFC7181_METRIC_MIN + (uint32_t)(rand() % 8) * 0x100;
+}
+
+static uint8_t
+_random_willingness(void) {
+  switch (rand() % 8) {
+    case 0:
+      return RFC7181_WILLINGNESS_NEVER;
+    case 1:
+      return RFC7181_WILLINGNESS_ALWAYS;
+    default:
+      return RFC7181_WILLINGNESS_DEFAULT;
+  }
+}
+
+static void
+_set_willingness(uint32_t neigh, uint8_t willingness) {
+  _neigh_willingness[neigh] = willingness;
+  _neighbors[neigh]._domaindata[_domain.index].willingness = willingness;
+}
+
+/**
+ * @param twohop index of 2-hop tuple
+ * @return index of the link of the 2-hop tuple
+ */
+static uint32_t
+_find_link(uint32_t twohop) {
+  uint32_t l;
+
+  for (l = 0; l < _snapshot.link_count; l++) {
+    if (twohop < _s_links[l].twohop_start + _s_links[l].twohop_count) {
+      break;
+    }
+  }
+  return l;
+}
+
+/**
+ * Set the metric of a 2-hop neighbor on all links of a neighbor.
+ * Both implementations use the first 2-hop tuple of a neighbor,
+ * so tuples of the same address on different links must not differ.
+ * @param neigh index of neighbor
+ * @param addr 2-hop address
+ * @param metric incoming metric
+ */
+static void
+_set_twohop_metric(uint32_t neigh, const struct netaddr *addr, uint32_t metric) {
+  const struct mpr_snapshot_neighbor *s_neigh;
+  int32_t idx;
+  uint32_t l;
+
+  s_neigh = &_s_neighbors[neigh];
+  for (l = s_neigh->link_start; l < s_neigh->link_start + s_neigh->link_count; l++) {
+    idx = mpr_snapshot_find_twohop(&_snapshot, &_s_links[l], addr);
+    if (idx >= 0) {
+      _twohop_in[idx] = metric;
+      _twohop_out[idx] = metric;
+    }
+  }
+}
+
+static void
+_create_snapshot(void) {
+  uint32_t neigh_count, i, l, p, t;
+
+  memset(&_snapshot, 0, sizeof(_snapshot));
+  memset(_neighbors, 0, sizeof(_neighbors));
+
+  neigh_count = 1 + (uint32_t)(rand() % TEST_NEIGHBORS);
+
+  for (i = 0; i < neigh_count; i++) {
+    _neighbors[i].originator = _pool[i];
+    _s_neighbors[i].neigh = &_neighbors[i];
+    _s_neighbors[i].symmetric = rand() % 16 == 0 ? 0 : 1;
+    _s_neighbors[i].addr_start = i;
+    _s_neighbors[i].addr_count = 1;
+    _s_addresses[i] = _pool[i];
+
+    _neigh_in[i] = _random_metric();
+    _set_willingness(i, _random_willingness());
+
+    /* one or two links, each with a sorted list of 2-hop neighbors */
+    _s_neighbors[i].link_start = _snapshot.link_count;
+    _s_neighbors[i].link_count = 1 + (uint32_t)(rand() % 2);
+
+    for (l = 0; l < _s_neighbors[i].link_count; l++) {
+      _s_links[_snapshot.link_count].neigh_idx = i;
+      _s_links[_snapshot.link_count].twohop_start = _snapshot.twohop_count;
+      _s_links[_snapshot.link_count].twohop_count = 0;
+
+      for (p = 0; p < ARRAYSIZE(_pool); p++) {
+        if (p == i || rand() % 4 != 0) {
+          continue;
+        }
+        _s_twohops[_snapshot.twohop_count] = _pool[p];
+        _snapshot.twohop_count++;
+        _s_links[_snapshot.link_count].twohop_count++;
+      }
+      _snapshot.link_count++;
+    }
+  }
+
+  _snapshot.valid = true;
+  _snapshot.neighbors = _s_neighbors;
+  _snapshot.links = _s_links;
+  _snapshot.twohops = _s_twohops;
+  _snapshot.addresses = _s_addresses;
+  _snapshot.neighbor_count = neigh_count;
+  _snapshot.addr_count = neigh_count;
+  _snapshot.neigh_in[_domain.index] = _neigh_in;
+  _snapshot.neigh_willingness[_domain.index] = _neigh_willingness;
+  _snapshot.twohop_in[_domain.index] = _twohop_in;
+  _snapshot.twohop_out[_domain.index] = _twohop_out;
+
+  for (t = 0; t < _snapshot.twohop_count; t++) {
+    _set_twohop_metric(_s_links[_find_link(t)].neigh_idx, &_s_twohops[t], _random_metric());
+  }
+}
+
+/**
+ * Change a single link, 2-hop tuple or neighbor of the snapshot
+ */
+static void
+_modify_snapshot(void) {
+  uint32_t idx;
+
+  switch (rand() % 4) {
+    case 0:
+      /* 2-hop metric */
+      if (_snapshot.twohop_count > 0) {
+        idx = (uint32_t)rand() % _snapshot.twohop_count;
+        _set_twohop_metric(_s_links[_find_link(idx)].neigh_idx, &_s_twohops[idx],
+            _random_metric());
+      }
+      break;
+    case 1:
+      /* a 2-hop metric that does not change N2 */
+      if (_snapshot.twohop_count > 0) {
+        idx = (uint32_t)rand() % _snapshot.twohop_count;
+        if (_twohop_in[idx] <= RFC7181_METRIC_MAX) {
+          _set_twohop_metric(_s_links[_find_link(idx)].neigh_idx, &_s_twohops[idx],
+              RFC7181_METRIC_MIN + (uint32_t)(rand() % 8) * 0x100);
+        }
+      }
+      break;
+    case 2:
+      /* neighbor metric */
+      idx = (uint32_t)rand() % _snapshot.neighbor_count;
+      _neigh_in[idx] = _random_metric();
+      break;
+    default:
+      /* willingness */
+      idx = (uint32_t)rand() % _snapshot.neighbor_count;
+      _set_willingness(idx, _random_willingness());
+      break;
+  }
+}
+
+static void
+_get_result(struct _test_result *result, struct neighbor_graph *graph) {
+  struct n1_node *n1;
+  struct addr_node *y;
+  uint32_t i;
+
+  memset(result, 0, sizeof(*result));
+
+  avl_for_each_element(&graph->set_mpr, n1, _avl_node) {
+    result->mpr[n1->neigh - _neighbors] = true;
+  }
+  for (i = 0; i < _snapshot.neighbor_count; i++) {
+    result->selected[i] = _neighbors[i].selection_is_mpr;
+  }
+  avl_for_each_element(&graph->set_n, y, _avl_node) {
+    for (i = 0; i < ARRAYSIZE(_pool); i++) {
+      if (netaddr_cmp(&_pool[i], &y->addr) == 0) {
+        result->n[i] = true;
+      }
+    }
+  }
+}
+
+static void
+_run_reference(struct _test_result *result) {
+  struct neighbor_graph graph;
+
+  memset(&graph, 0, sizeof(graph));
+  mpr_calculate_neighbor_graph_routing(&_domain, &graph, &_snapshot);
+  _ref_calculate(&_domain, &graph);
+  _get_result(result, &graph);
+  mpr_clear_neighbor_graph(&graph);
+}
+
+static void
+_run_engine(struct _test_result *result, struct mpr_rfc7181_engine *engine) {
+  struct neighbor_graph graph;
+
+  memset(&graph, 0, sizeof(graph));
+  mpr_calculate_neighbor_graph_routing(&_domain, &graph, &_snapshot);
+  mpr_calculate_mpr_rfc7181(&_domain, &graph, engine);
+  _get_result(result, &graph);
+  mpr_clear_neighbor_graph(&graph);
+}
+
+static bool
+_compare(struct _test_result *ref, struct _test_result *result) {
+  return memcmp(ref->mpr, result->mpr, sizeof(ref->mpr)) == 0
+      && memcmp(ref->selected, result->selected, sizeof(ref->selected)) == 0
+      && memcmp(ref->n, result->n, sizeof(ref->n)) == 0;
+}
+
+static void
+clear_elements(void) {
+  srand(42);
+}
+
+static void
+test_random_graphs(void) {
+  struct mpr_rfc7181_engine engine;
+  struct _test_result ref, result;
+  int i;
+
+  START_TEST();
+
+  for (i = 0; i < TEST_GRAPHS; i++) {
+    _create_snapshot();
+
+    _run_reference(&ref);
+
+    /* selection without engine */
+    _run_engine(&result, NULL);
+    CHECK_TRUE(_compare(&ref, &result), "graph %d: AVL MPR selection differs", i);
+
+    /* new engine for each graph */
+    memset(&engine, 0, sizeof(engine));
+    _run_engine(&result, &engine);
+    CHECK_TRUE(_compare(&ref, &result), "graph %d: MPR selection differs", i);
+    mpr_rfc7181_engine_clear(&engine);
+  }
+
+  END_TEST();
+}
+
+static void
+test_incremental_updates(void) {
+  struct mpr_rfc7181_engine engine;
+  struct _test_result ref, result;
+  int i, j;
+
+  START_TEST();
+
+  memset(&engine, 0, sizeof(engine));
+
+  for (i = 0; i < TEST_GRAPHS; i++) {
+    _create_snapshot();
+
+    for (j = 0; j < TEST_UPDATES; j++) {
+      _run_reference(&ref);
+      _run_engine(&result, &engine);
+      CHECK_TRUE(_compare(&ref, &result), "graph %d, update %d: MPR selection differs", i, j);
+
+      /* an unchanged snapshot keeps the result */
+      if (j == 0) {
+        _run_engine(&result, &engine);
+        CHECK_TRUE(_compare(&ref, &result), "graph %d: unchanged MPR selection differs", i);
+      }
+
+      _modify_snapshot();
+    }
+  }
+
+  /* all paths of the engine must have been used */
+  CHECK_TRUE(engine.stat_full > 0, "no full calculation");
+  CHECK_TRUE(engine.stat_incremental > 0, "no incremental calculation");
+  CHECK_TRUE(engine.stat_unchanged > 0, "no unchanged calculation");
+  CHECK_TRUE(engine.stat_too_large > 0, "no graph too large for the engine");
+
+  mpr_rfc7181_engine_clear(&engine);
+  END_TEST();
+}
+
+int
+main(int argc __attribute__ ((unused)), char **argv __attribute__ ((unused))) {
+  uint32_t i;
+  int result;
+
+  if (oonf_log_init(&_appdata, LOG_SEVERITY_WARN)) {
+    return 1;
+  }
+
+  for (i = 0; i < ARRAYSIZE(_pool); i++) {
+    if (netaddr_from_binary(&_pool[i], (uint8_t[]) { 10, i < TEST_NEIGHBORS ? 0 : 1, 0, (uint8_t)i },
+        4, AF_INET)) {
+      return 1;
+    }
+  }
+
+  BEGIN_TESTING(clear_elements);
+
+  test_random_graphs();
+  test_incremental_updates();
+
+  result = FINISH_TESTING();
+
+  oonf_log_cleanup();
+  return result;
+}
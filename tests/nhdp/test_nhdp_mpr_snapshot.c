@@ -0,0 +1,822 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "common/avl.h"
+#include "common/avl_comp.h"
+#include "common/netaddr.h"
+#include "core/oonf_appdata.h"
+#include "core/oonf_logging.h"
+#include "cunit/cunit.h"
+#include "subsystems/subsystem_helper.h"
+#include "subsystems/oonf_class.h"
+
+/* include the MPR selection and both snapshot based neighbor graphs */
+#include "mpr/neighbor-graph.c"
+#include "mpr/neighbor-graph-routing.c"
+#include "mpr/neighbor-graph-snapshot.c"
+#include "mpr/selection-rfc7181.c"
+
+/* the flooding graph uses the same names for its static functions */
+#define _calculate_d1_x            _flooding_calculate_d1_x
+#define _calculate_d1_x_of_n2_addr _flooding_calculate_d1_x_of_n2_addr
+#define _calculate_d2_x_y          _flooding_calculate_d2_x_y
+#define _calculate_d_x_y           _flooding_calculate_d_x_y
+#define _calculate_n1              _flooding_calculate_n1
+#define _calculate_n2              _flooding_calculate_n2
+#define _get_willingness_n1        _flooding_get_willingness_n1
+#define _is_allowed_2hop_tuple     _flooding_is_allowed_2hop_tuple
+#define _is_allowed_link_tuple     _flooding_is_allowed_link_tuple
+#include "mpr/neighbor-graph-flooding.c"
+#undef _calculate_d1_x
+#undef _calculate_d1_x_of_n2_addr
+#undef _calculate_d2_x_y
+#undef _calculate_d_x_y
+#undef _calculate_n1
+#undef _calculate_n2
+#undef _get_willingness_n1
+#undef _is_allowed_2hop_tuple
+#undef _is_allowed_link_tuple
+
+enum {
+  TEST_NEIGHBORS = 8,
+  TEST_TWOHOPS = 8,
+  TEST_POOL = TEST_NEIGHBORS + TEST_TWOHOPS,
+  TEST_INTERFACES = 2,
+  TEST_DOMAINS = 2,
+  TEST_GRAPHS = 100,
+};
+
+/**
+ * Neighbor graph and MPR set of one routing domain or flooding interface
+ */
+struct _test_result {
+  /* neighbors in N1 */
+  bool n1[TEST_NEIGHBORS];
+
+  /* link of the neighbors in N1 */
+  struct nhdp_link *n1_link[TEST_NEIGHBORS];
+
+  /* addresses of the pool in N2 and N */
+  bool n2[TEST_POOL];
+  bool n[TEST_POOL];
+
+  /* neighbors in the MPR set */
+  bool mpr[TEST_NEIGHBORS];
+};
+
+static struct oonf_appdata _appdata = {
+  .app_name = "test",
+};
+
+/* one metric per domain */
+static struct nhdp_domain_metric _test_metric[TEST_DOMAINS] = {
+  { .name = "test metric 0" },
+  { .name = "test metric 1" },
+};
+
+static struct nhdp_domain *_domain[TEST_DOMAINS];
+
+/* local NHDP interfaces of the links */
+static struct nhdp_interface *_nhdp_if[TEST_INTERFACES];
+static struct oonf_rfc5444_interface _test_interface[TEST_INTERFACES];
+static struct os_interface _os_if[TEST_INTERFACES];
+
+/* neighbor addresses followed by nodes that are only 2-hop neighbors */
+static struct netaddr _pool[TEST_POOL];
+
+static struct nhdp_neighbor *_neighbors[TEST_NEIGHBORS];
+
+static struct mpr_neighbor_snapshot _snapshot;
+
+/*
+ * Reference implementation: the neighbor graphs that were calculated
+ * by walking the NHDP database for each domain and interface
+ */
+
+static uint32_t
+_ref_routing_d1_x(const struct nhdp_domain *domain,
+    struct neighbor_graph *graph __attribute__((unused)), struct n1_node *x) {
+  return nhdp_domain_get_neighbordata(domain, x->neigh)->metric.in;
+}
+
+static uint32_t
+_ref_routing_d2_x_y(const struct nhdp_domain *domain,
+    struct neighbor_graph *graph __attribute__((unused)),
+    struct n1_node *x, struct addr_node *y) {
+  struct nhdp_l2hop *l2hop;
+  struct nhdp_link *lnk;
+
+  list_for_each_element(&x->neigh->_links, lnk, _neigh_node) {
+    l2hop = avl_find_element(&lnk->_2hop, &y->addr, l2hop, _link_node);
+    if (l2hop) {
+      return nhdp_domain_get_l2hopdata(domain, l2hop)->metric.in;
+    }
+  }
+  return RFC7181_METRIC_INFINITE;
+}
+
+static uint32_t
+_ref_routing_d_x_y(const struct nhdp_domain *domain,
+    struct neighbor_graph *graph, struct n1_node *x, struct addr_node *y) {
+  uint32_t cost1, cost2;
+
+  cost1 = _ref_routing_d1_x(domain, graph, x);
+  cost2 = _ref_routing_d2_x_y(domain, graph, x, y);
+  if (cost1 > RFC7181_METRIC_MAX || cost2 > RFC7181_METRIC_MAX) {
+    return RFC7181_METRIC_INFINITE_PATH;
+  }
+  return cost1 + cost2;
+}
+
+static uint32_t
+_ref_routing_d1_of_y(const struct nhdp_domain *domain,
+    struct neighbor_graph *graph, struct addr_node *y) {
+  struct n1_node *node_n1;
+  struct nhdp_naddr *naddr;
+
+  avl_for_each_element(&graph->set_n1, node_n1, _avl_node) {
+    naddr = avl_find_element(&node_n1->neigh->_neigh_addresses, &y->addr, naddr, _neigh_node);
+    if (naddr != NULL) {
+      return nhdp_domain_get_neighbordata(domain, node_n1->neigh)->metric.in;
+    }
+  }
+  return RFC7181_METRIC_INFINITE;
+}
+
+static uint32_t
+_ref_routing_willingness(const struct nhdp_domain *domain, struct n1_node *node) {
+  return nhdp_domain_get_neighbordata(domain, node->neigh)->willingness;
+}
+
+static struct neighbor_graph_interface _ref_routing_methods = {
+  .calculate_d1_x_of_n2_addr = _ref_routing_d1_of_y,
+  .calculate_d_x_y           = _ref_routing_d_x_y,
+  .calculate_d2_x_y          = _ref_routing_d2_x_y,
+  .get_willingness_n1        = _ref_routing_willingness,
+};
+
+static void
+_ref_routing_graph(const struct nhdp_domain *domain, struct neighbor_graph *graph) {
+  struct nhdp_neighbor_domaindata *neighdata;
+  struct nhdp_neighbor *neigh;
+  struct n1_node *n1;
+  struct nhdp_link *lnk;
+  struct nhdp_l2hop *l2hop;
+
+  mpr_init_neighbor_graph(graph, &_ref_routing_methods, NULL);
+
+  list_for_each_element(nhdp_db_get_neigh_list(), neigh, _global_node) {
+    neigh->selection_is_mpr = false;
+
+    neighdata = nhdp_domain_get_neighbordata(domain, neigh);
+    if (neighdata->metric.in <= RFC7181_METRIC_MAX && neigh->symmetric > 0
+        && neighdata->willingness > RFC7181_WILLINGNESS_NEVER) {
+      mpr_add_n1_node_to_set(&graph->set_n1, neigh, NULL, 0);
+    }
+  }
+
+  avl_for_each_element(&graph->set_n1, n1, _avl_node) {
+    list_for_each_element(&n1->neigh->_links, lnk, _neigh_node) {
+      avl_for_each_element(&lnk->_2hop, l2hop, _link_node) {
+        if (nhdp_domain_get_l2hopdata(domain, l2hop)->metric.in <= RFC7181_METRIC_MAX) {
+          mpr_add_addr_node_to_set(&graph->set_n2, l2hop->twohop_addr, 0);
+        }
+      }
+    }
+  }
+}
+
+static uint32_t
+_ref_flooding_d1_x(const struct nhdp_domain *domain,
+    struct neighbor_graph *graph __attribute__((unused)), struct n1_node *x) {
+  return nhdp_domain_get_linkdata(domain, x->link)->metric.out;
+}
+
+static uint32_t
+_ref_flooding_d2_x_y(const struct nhdp_domain *domain,
+    struct neighbor_graph *graph __attribute__((unused)),
+    struct n1_node *x, struct addr_node *y) {
+  struct nhdp_l2hop *l2hop;
+
+  l2hop = avl_find_element(&x->link->_2hop, &y->addr, l2hop, _link_node);
+  if (l2hop) {
+    return nhdp_domain_get_l2hopdata(domain, l2hop)->metric.out;
+  }
+  return RFC7181_METRIC_INFINITE;
+}
+
+static uint32_t
+_ref_flooding_d_x_y(const struct nhdp_domain *domain,
+    struct neighbor_graph *graph, struct n1_node *x, struct addr_node *y) {
+  uint32_t cost1, cost2;
+
+  cost1 = _ref_flooding_d1_x(domain, graph, x);
+  cost2 = _ref_flooding_d2_x_y(domain, graph, x, y);
+  if (cost1 > RFC7181_METRIC_MAX || cost2 > RFC7181_METRIC_MAX) {
+    return RFC7181_METRIC_INFINITE_PATH;
+  }
+  return cost1 + cost2;
+}
+
+static uint32_t
+_ref_flooding_d1_of_y(const struct nhdp_domain *domain,
+    struct neighbor_graph *graph, struct addr_node *y) {
+  struct n1_node *node_n1;
+  struct nhdp_naddr *naddr;
+
+  avl_for_each_element(&graph->set_n1, node_n1, _avl_node) {
+    naddr = avl_find_element(&node_n1->neigh->_neigh_addresses, &y->addr, naddr, _neigh_node);
+    if (naddr != NULL) {
+      return nhdp_domain_get_linkdata(domain, node_n1->link)->metric.out;
+    }
+  }
+  return RFC7181_METRIC_INFINITE;
+}
+
+static uint32_t
+_ref_flooding_willingness(const struct nhdp_domain *domain __attribute__((unused)),
+    struct n1_node *node) {
+  return node->link->flooding_willingness;
+}
+
+static struct neighbor_graph_interface _ref_flooding_methods = {
+  .calculate_d1_x_of_n2_addr = _ref_flooding_d1_of_y,
+  .calculate_d_x_y           = _ref_flooding_d_x_y,
+  .calculate_d2_x_y          = _ref_flooding_d2_x_y,
+  .get_willingness_n1        = _ref_flooding_willingness,
+};
+
+static void
+_ref_flooding_graph(const struct nhdp_domain *domain,
+    struct nhdp_interface *current_interface, struct neighbor_graph *graph) {
+  struct n1_node *n1;
+  struct nhdp_link *lnk;
+  struct nhdp_l2hop *l2hop;
+
+  mpr_init_neighbor_graph(graph, &_ref_flooding_methods, NULL);
+
+  list_for_each_element(nhdp_db_get_link_list(), lnk, _global_node) {
+    lnk->neigh->selection_is_mpr = false;
+
+    if (lnk->local_if == current_interface
+        && nhdp_domain_get_linkdata(domain, lnk)->metric.out <= RFC7181_METRIC_MAX
+        && lnk->status == NHDP_LINK_SYMMETRIC
+        && lnk->flooding_willingness > RFC7181_WILLINGNESS_NEVER) {
+      mpr_add_n1_node_to_set(&graph->set_n1, lnk->neigh, lnk, 0);
+    }
+  }
+
+  avl_for_each_element(&graph->set_n1, n1, _avl_node) {
+    avl_for_each_element(&n1->link->_2hop, l2hop, _link_node) {
+      if (l2hop->link->local_if == current_interface
+          && nhdp_domain_get_l2hopdata(domain, l2hop)->metric.out <= RFC7181_METRIC_MAX) {
+        mpr_add_addr_node_to_set(&graph->set_n2, l2hop->twohop_addr, 0);
+      }
+    }
+  }
+}
+
+/*
+ * Reference MPR selection of RFC 7181 on the AVL sets of the graph
+ */
+
+static unsigned int
+_ref_calculate_r(const struct nhdp_domain *domain, struct neighbor_graph *graph,
+    struct n1_node *x_node) {
+  struct addr_node *y_node;
+  struct n1_node *z_node;
+  uint32_t r, d_x_y, min_d_z_y;
+  bool already_covered;
+
+  if (x_node->neigh->selection_is_mpr) {
+    return 0;
+  }
+
+  r = 0;
+
+  avl_for_each_element(&graph->set_n, y_node, _avl_node) {
+    d_x_y = graph->methods->calculate_d_x_y(domain, graph, x_node, y_node);
+    min_d_z_y = mpr_calculate_minimal_d_z_y(domain, graph, y_node);
+    if (d_x_y > min_d_z_y) {
+      continue;
+    }
+
+    already_covered = false;
+    avl_for_each_element(&graph->set_n1, z_node, _avl_node) {
+      if (graph->methods->calculate_d_x_y(domain, graph, z_node, y_node) == min_d_z_y
+          && z_node->neigh->selection_is_mpr) {
+        already_covered = true;
+        break;
+      }
+    }
+    if (!already_covered) {
+      r++;
+    }
+  }
+  return r;
+}
+
+static void
+_ref_calculate(const struct nhdp_domain *domain, struct neighbor_graph *graph) {
+  struct avl_tree candidates;
+  struct n1_node *node_n1, *possible_mpr_node;
+  struct addr_node *y_node;
+  uint32_t d1_y, possible_mprs, prop, greatest_prop;
+  bool add_to_n;
+
+  /* calculate N */
+  avl_for_each_element(&graph->set_n2, y_node, _avl_node) {
+    add_to_n = false;
+
+    d1_y = graph->methods->calculate_d1_x_of_n2_addr(domain, graph, y_node);
+    if (d1_y == RFC7181_METRIC_INFINITE) {
+      add_to_n = true;
+    }
+    else {
+      avl_for_each_element(&graph->set_n1, node_n1, _avl_node) {
+        if (graph->methods->calculate_d_x_y(domain, graph, node_n1, y_node) < d1_y) {
+          add_to_n = true;
+          break;
+        }
+      }
+    }
+
+    if (add_to_n) {
+      mpr_add_addr_node_to_set(&graph->set_n, y_node->addr, 0);
+    }
+  }
+
+  /* WILL_ALWAYS */
+  avl_for_each_element(&graph->set_n1, node_n1, _avl_node) {
+    if (graph->methods->get_willingness_n1(domain, node_n1) == RFC7181_WILLINGNESS_ALWAYS) {
+      mpr_add_n1_node_to_set(&graph->set_mpr, node_n1->neigh, node_n1->link, 0);
+    }
+  }
+
+  /* unique MPRs */
+  avl_for_each_element(&graph->set_n, y_node, _avl_node) {
+    possible_mprs = 0;
+    possible_mpr_node = NULL;
+
+    avl_for_each_element(&graph->set_n1, node_n1, _avl_node) {
+      if (graph->methods->calculate_d2_x_y(domain, graph, node_n1, y_node)
+          <= RFC7181_METRIC_MAX) {
+        possible_mprs++;
+        possible_mpr_node = node_n1;
+      }
+    }
+    if (possible_mprs == 1) {
+      mpr_add_n1_node_to_set(&graph->set_mpr, possible_mpr_node->neigh,
+          possible_mpr_node->link, 0);
+      possible_mpr_node->neigh->selection_is_mpr = true;
+    }
+  }
+
+  /* remaining nodes, first one with the greatest R(x,M) */
+  avl_init(&candidates, avl_comp_netaddr, false);
+  while (true) {
+    greatest_prop = 0;
+    mpr_clear_n1_set(&candidates);
+
+    avl_for_each_element(&graph->set_n1, node_n1, _avl_node) {
+      prop = _ref_calculate_r(domain, graph, node_n1);
+      if (prop == 0 || prop < greatest_prop) {
+        continue;
+      }
+      if (prop > greatest_prop) {
+        greatest_prop = prop;
+        mpr_clear_n1_set(&candidates);
+      }
+      mpr_add_n1_node_to_set(&candidates, node_n1->neigh, node_n1->link, 0);
+    }
+
+    if (candidates.count == 0) {
+      break;
+    }
+
+    node_n1 = avl_first_element(&candidates, node_n1, _avl_node);
+    mpr_add_n1_node_to_set(&graph->set_mpr, node_n1->neigh, node_n1->link, 0);
+    node_n1->neigh->selection_is_mpr = true;
+  }
+  mpr_clear_n1_set(&candidates);
+}
+
+/*
+ * Random NHDP database
+ */
+
+static uint32_t
+_random_metric(void) {
+  if (rand() % 16 == 0) {
+    return RFC7181_METRIC_INFINITE;
+  }
+
+  /* few different values to create ties */
+  return RFC7181_METRIC_MIN + (uint32_t)(rand() % 8) * 0x100;
+}
+
+static uint8_t
+_random_willingness(void) {
+  switch (rand() % 8) {
+    case 0:
+      return RFC7181_WILLINGNESS_NEVER;
+    case 1:
+      return RFC7181_WILLINGNESS_ALWAYS;
+    default:
+      return RFC7181_WILLINGNESS_DEFAULT;
+  }
+}
+
+/**
+ * Fill the NHDP database with random neighbors. Each neighbor has
+ * one or more links on random interfaces, the same 2-hop address
+ * has the same metric on all links of a neighbor.
+ * @return -1 if out of memory, 0 otherwise
+ */
+static int
+_create_database(void) {
+  uint32_t twohop_in[TEST_DOMAINS][TEST_POOL], twohop_out[TEST_DOMAINS][TEST_POOL];
+  struct nhdp_neighbor_domaindata *neighdata;
+  struct nhdp_link_domaindata *linkdata;
+  struct nhdp_l2hop_domaindata *l2hopdata;
+  struct nhdp_l2hop *l2hop;
+  struct nhdp_link *lnk;
+  uint32_t i, l, link_count, d, p;
+
+  for (i = 0; i < TEST_NEIGHBORS; i++) {
+    _neighbors[i] = nhdp_db_neighbor_add();
+    if (_neighbors[i] == NULL
+        || nhdp_db_neighbor_addr_add(_neighbors[i], &_pool[i]) == NULL) {
+      return -1;
+    }
+    nhdp_db_neighbor_set_originator(_neighbors[i], &_pool[i]);
+
+    for (d = 0; d < TEST_DOMAINS; d++) {
+      neighdata = nhdp_domain_get_neighbordata(_domain[d], _neighbors[i]);
+      neighdata->metric.in = _random_metric();
+      neighdata->willingness = _random_willingness();
+
+      for (p = 0; p < TEST_POOL; p++) {
+        twohop_in[d][p] = _random_metric();
+        twohop_out[d][p] = _random_metric();
+      }
+    }
+
+    link_count = 1 + (uint32_t)rand() % 3;
+    for (l = 0; l < link_count; l++) {
+      lnk = nhdp_db_link_add(_neighbors[i], _nhdp_if[rand() % TEST_INTERFACES]);
+      if (lnk == NULL) {
+        return -1;
+      }
+
+      if (rand() % 4) {
+        lnk->status = NHDP_LINK_SYMMETRIC;
+        _neighbors[i]->symmetric++;
+      }
+      else {
+        lnk->status = NHDP_LINK_HEARD;
+      }
+      lnk->flooding_willingness = _random_willingness();
+
+      for (d = 0; d < TEST_DOMAINS; d++) {
+        linkdata = nhdp_domain_get_linkdata(_domain[d], lnk);
+        linkdata->metric.out = _random_metric();
+      }
+
+      for (p = 0; p < TEST_POOL; p++) {
+        if (p == i || rand() % 3) {
+          continue;
+        }
+
+        l2hop = nhdp_db_link_2hop_add(lnk, &_pool[p]);
+        if (l2hop == NULL) {
+          return -1;
+        }
+        for (d = 0; d < TEST_DOMAINS; d++) {
+          l2hopdata = nhdp_domain_get_l2hopdata(_domain[d], l2hop);
+          l2hopdata->metric.in = twohop_in[d][p];
+          l2hopdata->metric.out = twohop_out[d][p];
+        }
+      }
+    }
+  }
+
+  /* the database changed, the next MPR run needs a new snapshot */
+  nhdp_domain_delayed_mpr_recalculation(NULL, NULL);
+  return 0;
+}
+
+static int
+_get_neighbor_index(struct nhdp_neighbor *neigh) {
+  int i;
+
+  for (i = 0; i < TEST_NEIGHBORS; i++) {
+    if (_neighbors[i] == neigh) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+static int
+_get_pool_index(const struct netaddr *addr) {
+  int i;
+
+  for (i = 0; i < TEST_POOL; i++) {
+    if (netaddr_cmp(&_pool[i], addr) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+static void
+_get_result(struct _test_result *result, struct neighbor_graph *graph) {
+  struct n1_node *n1;
+  struct addr_node *y;
+  int idx;
+
+  memset(result, 0, sizeof(*result));
+
+  avl_for_each_element(&graph->set_n1, n1, _avl_node) {
+    idx = _get_neighbor_index(n1->neigh);
+    CHECK_TRUE(idx >= 0, "unknown neighbor in N1");
+    if (idx >= 0) {
+      result->n1[idx] = true;
+      result->n1_link[idx] = n1->link;
+    }
+  }
+  avl_for_each_element(&graph->set_mpr, n1, _avl_node) {
+    idx = _get_neighbor_index(n1->neigh);
+    CHECK_TRUE(idx >= 0, "unknown neighbor in MPR set");
+    if (idx >= 0) {
+      result->mpr[idx] = true;
+    }
+  }
+  avl_for_each_element(&graph->set_n2, y, _avl_node) {
+    idx = _get_pool_index(&y->addr);
+    CHECK_TRUE(idx >= 0, "unknown address in N2");
+    if (idx >= 0) {
+      result->n2[idx] = true;
+    }
+  }
+  avl_for_each_element(&graph->set_n, y, _avl_node) {
+    idx = _get_pool_index(&y->addr);
+    CHECK_TRUE(idx >= 0, "unknown address in N");
+    if (idx >= 0) {
+      result->n[idx] = true;
+    }
+  }
+}
+
+static bool
+_compare(struct _test_result *ref, struct _test_result *result) {
+  return memcmp(ref, result, sizeof(*ref)) == 0;
+}
+
+static void
+_run_routing(struct nhdp_domain *domain,
+    struct _test_result *ref, struct _test_result *result) {
+  struct neighbor_graph graph;
+
+  memset(&graph, 0, sizeof(graph));
+  _ref_routing_graph(domain, &graph);
+  _ref_calculate(domain, &graph);
+  _get_result(ref, &graph);
+  mpr_clear_neighbor_graph(&graph);
+
+  /* like the MPR plugin does for each routing domain */
+  CHECK_TRUE(mpr_snapshot_update(&_snapshot) == 0, "cannot build snapshot");
+
+  memset(&graph, 0, sizeof(graph));
+  mpr_calculate_neighbor_graph_routing(domain, &graph, &_snapshot);
+  mpr_calculate_mpr_rfc7181(domain, &graph, NULL);
+  _get_result(result, &graph);
+  mpr_clear_neighbor_graph(&graph);
+}
+
+static void
+_run_flooding(struct nhdp_interface *nhdp_if,
+    struct _test_result *ref, struct _test_result *result) {
+  struct mpr_flooding_data flooding_data;
+  const struct nhdp_domain *domain;
+  struct neighbor_graph graph;
+
+  domain = nhdp_domain_get_flooding_domain();
+
+  memset(&graph, 0, sizeof(graph));
+  _ref_flooding_graph(domain, nhdp_if, &graph);
+  _ref_calculate(domain, &graph);
+  _get_result(ref, &graph);
+  mpr_clear_neighbor_graph(&graph);
+
+  /* like the MPR plugin does for each interface */
+  CHECK_TRUE(mpr_snapshot_update(&_snapshot) == 0, "cannot build snapshot");
+
+  memset(&flooding_data, 0, sizeof(flooding_data));
+  flooding_data.current_interface = nhdp_if;
+  mpr_calculate_neighbor_graph_flooding(domain, &flooding_data, &_snapshot);
+  mpr_calculate_mpr_rfc7181(domain, &flooding_data.neigh_graph, NULL);
+  _get_result(result, &flooding_data.neigh_graph);
+  mpr_clear_neighbor_graph(&flooding_data.neigh_graph);
+}
+
+static void
+clear_elements(void) {
+  struct nhdp_neighbor *neigh, *n_it;
+
+  list_for_each_element_safe(nhdp_db_get_neigh_list(), neigh, _global_node, n_it) {
+    nhdp_db_neighbor_remove(neigh);
+  }
+  memset(_neighbors, 0, sizeof(_neighbors));
+  srand(42);
+}
+
+static void
+test_routing_mprs(void) {
+  struct _test_result ref, result;
+  int i, d;
+
+  START_TEST();
+
+  for (i = 0; i < TEST_GRAPHS; i++) {
+    clear_elements();
+    srand(i);
+    CHECK_TRUE(_create_database() == 0, "graph %d: cannot create database", i);
+
+    for (d = 0; d < TEST_DOMAINS; d++) {
+      _run_routing(_domain[d], &ref, &result);
+      CHECK_TRUE(_compare(&ref, &result), "graph %d, domain %d: routing MPRs differ", i, d);
+    }
+  }
+
+  END_TEST();
+}
+
+static void
+test_flooding_mprs(void) {
+  struct _test_result ref, result;
+  int i, f;
+
+  START_TEST();
+
+  for (i = 0; i < TEST_GRAPHS; i++) {
+    clear_elements();
+    srand(i);
+    CHECK_TRUE(_create_database() == 0, "graph %d: cannot create database", i);
+
+    for (f = 0; f < TEST_INTERFACES; f++) {
+      _run_flooding(_nhdp_if[f], &ref, &result);
+      CHECK_TRUE(_compare(&ref, &result), "graph %d, interface %d: flooding MPRs differ", i, f);
+    }
+  }
+
+  END_TEST();
+}
+
+static void
+test_shared_snapshot(void) {
+  struct _test_result ref, result;
+  uint32_t built;
+  int d, f;
+
+  START_TEST();
+
+  CHECK_TRUE(_create_database() == 0, "cannot create database");
+
+  /* one recalculation run of all domains and interfaces walks the database once */
+  built = _snapshot.stat_built;
+  for (d = 0; d < TEST_DOMAINS; d++) {
+    _run_routing(_domain[d], &ref, &result);
+  }
+  for (f = 0; f < TEST_INTERFACES; f++) {
+    _run_flooding(_nhdp_if[f], &ref, &result);
+  }
+  CHECK_TRUE(_snapshot.stat_built == built + 1,
+      "snapshot built %u times", _snapshot.stat_built - built);
+
+  /* a database change invalidates the snapshot */
+  nhdp_domain_delayed_mpr_recalculation(NULL, NULL);
+  _run_routing(_domain[0], &ref, &result);
+  CHECK_TRUE(_snapshot.stat_built == built + 2, "snapshot not rebuilt");
+
+  END_TEST();
+}
+
+int
+main(int argc __attribute__ ((unused)), char **argv __attribute__ ((unused))) {
+  struct oonf_class *interface_class;
+  int i, result;
+
+  if (oonf_log_init(&_appdata, LOG_SEVERITY_WARN)
+      || subsystem_helper_init(OONF_NHDP_SUBSYSTEM)) {
+    return 1;
+  }
+
+  for (i = 0; i < TEST_POOL; i++) {
+    if (netaddr_from_binary(&_pool[i], (uint8_t[]) { 10, i < TEST_NEIGHBORS ? 0 : 1, 0, (uint8_t)i },
+        4, AF_INET)) {
+      return 1;
+    }
+  }
+
+  for (i = 0; i < TEST_DOMAINS; i++) {
+    if (nhdp_domain_metric_add(&_test_metric[i])) {
+      return 1;
+    }
+    _domain[i] = nhdp_domain_configure(i, _test_metric[i].name,
+        CFG_DOMAIN_NO_METRIC_MPR, RFC7181_WILLINGNESS_DEFAULT);
+    if (_domain[i] == NULL) {
+      return 1;
+    }
+  }
+
+  /* NHDP interfaces without operating system interface and sockets */
+  interface_class = avl_find_element(oonf_class_get_tree(), NHDP_CLASS_INTERFACE, interface_class, _node);
+  if (interface_class == NULL) {
+    return 1;
+  }
+  for (i = 0; i < TEST_INTERFACES; i++) {
+    _nhdp_if[i] = oonf_class_malloc(interface_class);
+    if (_nhdp_if[i] == NULL) {
+      return 1;
+    }
+    snprintf(_test_interface[i].name, sizeof(_test_interface[i].name), "test%d", i);
+    _os_if[i].index = i + 1;
+    _nhdp_if[i]->rfc5444_if.interface = &_test_interface[i];
+    _nhdp_if[i]->os_if_listener.data = &_os_if[i];
+
+    avl_init(&_nhdp_if[i]->_if_addresses, avl_comp_netaddr, false);
+    list_init_head(&_nhdp_if[i]->_links);
+    avl_init(&_nhdp_if[i]->_link_addresses, avl_comp_netaddr, false);
+    avl_init(&_nhdp_if[i]->_link_originators, avl_comp_netaddr, true);
+    avl_init(&_nhdp_if[i]->_if_twohops, avl_comp_netaddr, true);
+  }
+
+  BEGIN_TESTING(clear_elements);
+
+  test_routing_mprs();
+  test_flooding_mprs();
+  test_shared_snapshot();
+
+  result = FINISH_TESTING();
+
+  clear_elements();
+  mpr_snapshot_clear(&_snapshot);
+  for (i = 0; i < TEST_INTERFACES; i++) {
+    oonf_class_free(interface_class, _nhdp_if[i]);
+  }
+  for (i = 0; i < TEST_DOMAINS; i++) {
+    nhdp_domain_metric_remove(&_test_metric[i]);
+  }
+
+  subsystem_helper_cleanup();
+  oonf_log_cleanup();
+  return result;
+}
@@ -0,0 +1,87 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#include "common/common_types.h"
+#include "common/netaddr.h"
+
+/*
+ * include the databases of the OLSRv2 plugin the routing code needs
+ * and the TC reader that fills them, the routing code itself is
+ * included by the test
+ */
+#include "olsrv2/olsrv2_lan.c"
+#include "olsrv2/olsrv2_originator.c"
+#include "olsrv2/olsrv2_reader.c"
+#include "olsrv2/olsrv2_tc.c"
+
+/* the rest of the OLSRv2 plugin is not part of the test */
+
+uint64_t
+olsrv2_get_tc_validity(void) {
+  return 300000;
+}
+
+bool
+olsrv2_is_nhdp_routable(struct netaddr *addr __attribute__((unused))) {
+  return true;
+}
+
+bool
+olsrv2_is_routable(struct netaddr *addr __attribute__((unused))) {
+  return true;
+}
+
+bool
+olsrv2_mpr_shall_process(struct rfc5444_reader_tlvblock_context *context __attribute__((unused)),
+    uint64_t vtime __attribute__((unused))) {
+  return true;
+}
+
+bool
+olsrv2_mpr_shall_forwarding(struct rfc5444_reader_tlvblock_context *context __attribute__((unused)),
+    struct netaddr *source_address __attribute__((unused)),
+    uint64_t vtime __attribute__((unused))) {
+  return false;
+}
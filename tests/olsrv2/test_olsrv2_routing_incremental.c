@@ -0,0 +1,460 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "common/avl.h"
+#include "common/netaddr.h"
+#include "core/oonf_appdata.h"
+#include "core/oonf_logging.h"
+#include "cunit/cunit.h"
+#include "subsystems/subsystem_helper.h"
+
+/* include the routing code to run full and incremental dijkstra directly */
+#include "olsrv2/olsrv2_routing.c"
+
+enum {
+  TEST_NODES = 40,
+  TEST_NEIGHBORS = 5,
+  TEST_EDGES = 3,
+  TEST_ATTACHED = 8,
+  TEST_STEPS = 1000,
+  TEST_VTIME = 3600000,
+};
+
+/**
+ * Routing entry as calculated by a dijkstra run
+ */
+struct _test_route {
+  struct os_route_key key;
+  struct netaddr gw;
+  struct netaddr originator;
+  struct netaddr next_originator;
+  struct netaddr last_originator;
+  uint32_t path_cost;
+  uint32_t path_hops;
+  uint32_t distance;
+  uint32_t if_index;
+};
+
+static struct oonf_appdata _appdata = {
+  .app_name = "test",
+};
+
+static struct nhdp_domain *_domain;
+
+/* node 0 is the local router, the next ones are the NHDP neighbors */
+static struct netaddr _addr[TEST_NODES];
+static struct nhdp_neighbor *_neighbors[TEST_NEIGHBORS];
+static struct nhdp_link _links[TEST_NEIGHBORS];
+
+static struct _test_route _full[TEST_NODES * 2 + TEST_ATTACHED];
+static struct _test_route _incremental[TEST_NODES * 2 + TEST_ATTACHED];
+
+/* number of different link costs used by the topology */
+static uint32_t _cost_range;
+
+static uint32_t
+_random_cost(void) {
+  return RFC7181_METRIC_MIN + (uint32_t)rand() % _cost_range;
+}
+
+static struct olsrv2_tc_node *
+_get_random_node(void) {
+  return olsrv2_tc_node_add(&_addr[1 + rand() % (TEST_NODES - 1)], TEST_VTIME, 0);
+}
+
+static void
+_set_edge(struct olsrv2_tc_node *node, struct netaddr *dst, uint32_t cost) {
+  struct olsrv2_tc_edge *edge;
+  uint32_t old_cost;
+
+  if (node == NULL || netaddr_cmp(&node->target.prefix.dst, dst) == 0) {
+    return;
+  }
+
+  edge = avl_find_element(&node->_edges, dst, edge, _node);
+  old_cost = edge == NULL ? RFC7181_METRIC_INFINITE : edge->cost[_domain->index];
+
+  /* like a received TC, this resets the cost of an existing edge */
+  edge = olsrv2_tc_edge_add(node, dst);
+  CHECK_TRUE(edge != NULL, "could not add edge");
+  if (edge != NULL) {
+    edge->cost[_domain->index] = cost;
+
+    /* the TC reader only reports edges with a changed cost */
+    if (old_cost != cost) {
+      olsrv2_routing_dijkstra_node_changed(node);
+      olsrv2_routing_dijkstra_node_changed(edge->dst);
+    }
+  }
+}
+
+static struct olsrv2_tc_edge *
+_get_random_edge(struct olsrv2_tc_node *node) {
+  struct olsrv2_tc_edge *edge;
+  uint32_t idx;
+
+  if (node == NULL || node->_edges.count == 0) {
+    return NULL;
+  }
+
+  idx = (uint32_t)rand() % node->_edges.count;
+  avl_for_each_element(&node->_edges, edge, _node) {
+    if (idx-- == 0) {
+      return edge->virtual ? NULL : edge;
+    }
+  }
+  return NULL;
+}
+
+static void
+_set_attachment(struct olsrv2_tc_node *node, uint8_t net) {
+  struct olsrv2_tc_attachment *attached;
+  struct os_route_key key;
+  struct netaddr prefix;
+
+  if (node == NULL) {
+    return;
+  }
+
+  CHECK_TRUE(netaddr_from_binary_prefix(&prefix,
+      (uint8_t[]) { 10, 1, net, 0 }, 4, AF_INET, 24) == 0, "bad prefix");
+  os_routing_init_sourcespec_prefix(&key, &prefix);
+
+  attached = olsrv2_tc_endpoint_add(node, &key, true);
+  CHECK_TRUE(attached != NULL, "could not attach network %u", net);
+  if (attached != NULL) {
+    attached->cost[_domain->index] = _random_cost();
+    attached->distance[_domain->index] = 1 + (uint8_t)(rand() % 4);
+  }
+}
+
+static void
+_set_neighbor_metric(struct nhdp_neighbor *neigh, uint32_t cost) {
+  struct nhdp_neighbor_domaindata *data;
+
+  data = nhdp_domain_get_neighbordata(_domain, neigh);
+  data->metric.in = cost;
+  data->metric.out = cost;
+}
+
+static void
+_create_topology(void) {
+  struct nhdp_neighbor_domaindata *data;
+  struct olsrv2_tc_node *node;
+  uint32_t i, j;
+
+  for (i = 0; i < TEST_NEIGHBORS; i++) {
+    _neighbors[i] = nhdp_db_neighbor_add();
+    CHECK_TRUE(_neighbors[i] != NULL, "could not add neighbor %u", i);
+    if (_neighbors[i] == NULL) {
+      continue;
+    }
+
+    nhdp_db_neighbor_set_originator(_neighbors[i], &_addr[i + 1]);
+    nhdp_db_neighbor_addr_add(_neighbors[i], &_addr[i + 1]);
+    _neighbors[i]->symmetric = 1;
+
+    /* the routing code only needs the address of the best link */
+    _links[i].if_addr = _addr[i + 1];
+
+    data = nhdp_domain_get_neighbordata(_domain, _neighbors[i]);
+    data->best_out_link = &_links[i];
+    data->best_link_ifindex = 1 + i;
+    _set_neighbor_metric(_neighbors[i], _random_cost());
+  }
+
+  for (i = 1; i < TEST_NODES; i++) {
+    node = olsrv2_tc_node_add(&_addr[i], TEST_VTIME, 0);
+    for (j = 0; j < TEST_EDGES; j++) {
+      _set_edge(node, &_addr[rand() % TEST_NODES], _random_cost());
+    }
+  }
+  for (i = 0; i < TEST_ATTACHED; i++) {
+    _set_attachment(_get_random_node(), (uint8_t)i);
+  }
+}
+
+static void
+_remove_topology(void) {
+  struct olsrv2_tc_node *node, *n_it;
+  uint32_t i;
+
+  for (i = 0; i < TEST_NEIGHBORS; i++) {
+    if (_neighbors[i] != NULL) {
+      nhdp_db_neighbor_remove(_neighbors[i]);
+      _neighbors[i] = NULL;
+    }
+  }
+  avl_for_each_element_safe(olsrv2_tc_get_tree(), node, _originator_node, n_it) {
+    olsrv2_tc_node_remove(node);
+  }
+}
+
+/**
+ * Apply a random change to the topology like a received TC
+ * or a changed NHDP link would do
+ */
+static void
+_modify_topology(void) {
+  struct olsrv2_tc_node *node;
+  struct olsrv2_tc_edge *edge;
+
+  switch (rand() % 10) {
+    case 0:
+    case 1:
+    case 2:
+      /* change cost of an edge */
+      node = _get_random_node();
+      edge = _get_random_edge(node);
+      if (edge != NULL) {
+        _set_edge(node, &edge->dst->target.prefix.dst, _random_cost());
+      }
+      break;
+    case 3:
+      /* new edge */
+      _set_edge(_get_random_node(), &_addr[rand() % TEST_NODES], _random_cost());
+      break;
+    case 4:
+      /* lost edge */
+      edge = _get_random_edge(_get_random_node());
+      if (edge != NULL) {
+        olsrv2_tc_edge_remove(edge);
+      }
+      break;
+    case 5:
+      /* edge with infinite cost */
+      node = _get_random_node();
+      edge = _get_random_edge(node);
+      if (edge != NULL) {
+        _set_edge(node, &edge->dst->target.prefix.dst, RFC7181_METRIC_INFINITE);
+      }
+      break;
+    case 6:
+    case 7:
+      /* changed link metric of a neighbor */
+      _set_neighbor_metric(_neighbors[rand() % TEST_NEIGHBORS],
+          rand() % 8 == 0 ? RFC7181_METRIC_INFINITE : _random_cost());
+      break;
+    case 8:
+      /* changed attached network */
+      _set_attachment(_get_random_node(), (uint8_t)(rand() % TEST_ATTACHED));
+      break;
+    default:
+      /* node lost all edges, this forces a full run */
+      if (rand() % 8 == 0) {
+        node = _get_random_node();
+        if (!node->direct_neighbor) {
+          olsrv2_tc_node_remove(node);
+        }
+      }
+      break;
+  }
+}
+
+/**
+ * Copy the active routing entries of the test domain
+ * @param routes array for routing entries
+ * @return number of routing entries
+ */
+static size_t
+_get_routes(struct _test_route *routes) {
+  struct olsrv2_routing_entry *rtentry;
+  size_t count;
+
+  count = 0;
+  avl_for_each_element(&_routing_tree[_domain->index], rtentry, _node) {
+    if (!rtentry->set) {
+      continue;
+    }
+
+    memset(&routes[count], 0, sizeof(routes[count]));
+    memcpy(&routes[count].key, &rtentry->route.p.key, sizeof(routes[count].key));
+    memcpy(&routes[count].gw, &rtentry->route.p.gw, sizeof(routes[count].gw));
+    memcpy(&routes[count].originator, &rtentry->originator,
+        sizeof(routes[count].originator));
+    memcpy(&routes[count].next_originator, &rtentry->next_originator,
+        sizeof(routes[count].next_originator));
+    memcpy(&routes[count].last_originator, &rtentry->last_originator,
+        sizeof(routes[count].last_originator));
+    routes[count].path_cost = rtentry->path_cost;
+    routes[count].path_hops = rtentry->path_hops;
+    routes[count].distance = rtentry->route.p.metric;
+    routes[count].if_index = rtentry->route.p.if_index;
+    count++;
+  }
+  return count;
+}
+
+static void
+clear_elements(void) {
+  srand(42);
+}
+
+static void
+_compare_incremental_to_full(void) {
+  const struct olsrv2_routing_statistics *stats;
+  uint32_t incremental_runs;
+  struct netaddr_str nbuf;
+  size_t full_count, incremental_count, i;
+  int step;
+
+  stats = olsrv2_routing_get_statistics(_domain);
+  incremental_runs = stats->incremental_runs;
+
+  olsrv2_routing_set_incremental(true, 100);
+  _create_topology();
+
+  for (step = 0; step < TEST_STEPS; step++) {
+    /* full dijkstra without touching the stored shortest path tree */
+    _incremental_spf = false;
+    _calculate_domain(_domain);
+    full_count = _get_routes(_full);
+
+    /* repair the shortest path tree of the last incremental run */
+    _incremental_spf = true;
+    _calculate_domain(_domain);
+    incremental_count = _get_routes(_incremental);
+
+    CHECK_TRUE(full_count == incremental_count,
+        "step %d: %" PRINTF_SIZE_T_SPECIFIER " full routes, %" PRINTF_SIZE_T_SPECIFIER
+        " incremental routes", step, full_count, incremental_count);
+    for (i = 0; i < full_count && i < incremental_count; i++) {
+      CHECK_TRUE(memcmp(&_full[i], &_incremental[i], sizeof(_full[i])) == 0,
+          "step %d: route %s differs (cost %u/%u, hops %u/%u)", step,
+          netaddr_to_string(&nbuf, &_full[i].key.dst),
+          _full[i].path_cost, _incremental[i].path_cost,
+          _full[i].path_hops, _incremental[i].path_hops);
+    }
+
+    _modify_topology();
+  }
+
+  /* most runs must have been incremental */
+  incremental_runs = stats->incremental_runs - incremental_runs;
+  CHECK_TRUE(incremental_runs > TEST_STEPS / 2, "only %u incremental runs of %u",
+      incremental_runs, TEST_STEPS);
+
+  _remove_topology();
+  olsrv2_routing_set_incremental(false, 0);
+}
+
+static void
+test_incremental_wide_costs(void) {
+  START_TEST();
+
+  /* wide range of costs makes equal cost paths unlikely */
+  _cost_range = 0x10000;
+  _compare_incremental_to_full();
+
+  END_TEST();
+}
+
+static void
+test_incremental_small_costs(void) {
+  START_TEST();
+
+  /* small integer costs create many equal cost paths */
+  _cost_range = 4;
+  _compare_incremental_to_full();
+
+  END_TEST();
+}
+
+static void
+test_incremental_equal_costs(void) {
+  START_TEST();
+
+  /* all paths with the same number of hops have the same cost */
+  _cost_range = 1;
+  _compare_incremental_to_full();
+
+  END_TEST();
+}
+
+int
+main(int argc __attribute__ ((unused)), char **argv __attribute__ ((unused))) {
+  uint8_t i;
+  int result;
+
+  if (oonf_log_init(&_appdata, LOG_SEVERITY_WARN)
+      || subsystem_helper_init(OONF_NHDP_SUBSYSTEM)) {
+    return 1;
+  }
+
+  for (i = 0; i < TEST_NODES; i++) {
+    if (netaddr_from_binary(&_addr[i], (uint8_t[]) { 10, 0, 0, 1 + i }, 4, AF_INET)) {
+      return 1;
+    }
+  }
+
+  _domain = nhdp_domain_add(0);
+  if (_domain == NULL || olsrv2_routing_init()) {
+    return 1;
+  }
+  olsrv2_lan_init();
+  olsrv2_originator_init();
+  olsrv2_tc_init();
+  olsrv2_originator_set(&_addr[0]);
+
+  BEGIN_TESTING(clear_elements);
+
+  test_incremental_wide_costs();
+  test_incremental_small_costs();
+  test_incremental_equal_costs();
+
+  result = FINISH_TESTING();
+
+  olsrv2_tc_cleanup();
+  olsrv2_originator_cleanup();
+  olsrv2_lan_cleanup();
+  olsrv2_routing_cleanup();
+  subsystem_helper_cleanup();
+  oonf_log_cleanup();
+  return result;
+}
@@ -0,0 +1,396 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "common/avl.h"
+#include "common/netaddr.h"
+#include "core/oonf_appdata.h"
+#include "core/oonf_logging.h"
+#include "cunit/cunit.h"
+#include "subsystems/subsystem_helper.h"
+#include "subsystems/rfc5444/rfc5444_context.h"
+
+#include "olsrv2/olsrv2_reader.h"
+
+/* include the routing code to run dijkstra without the kernel */
+#include "olsrv2/olsrv2_routing.c"
+
+enum {
+  TEST_TC_NEIGHBORS = 3,
+  TEST_VTIME = 3600000,
+  TEST_REPLAYS = 10,
+};
+
+static struct oonf_appdata _appdata = {
+  .app_name = "test",
+};
+
+static struct nhdp_domain *_domain;
+
+/* local router, the NHDP neighbor sending the TC and its neighbors */
+static struct netaddr _addr[2 + TEST_TC_NEIGHBORS];
+static struct netaddr _gateway;
+
+static struct nhdp_neighbor *_neighbor;
+static struct nhdp_link _link;
+
+/* RFC5444 protocol and interface the TCs are received on */
+static struct oonf_rfc5444_protocol _test_protocol;
+static struct oonf_rfc5444_interface _test_interface;
+static struct list_entity _active_sockets;
+
+static uint8_t _packet[1500];
+static size_t _packet_len;
+static uint16_t _seqno;
+
+static void
+_put8(uint8_t value) {
+  _packet[_packet_len++] = value;
+}
+
+static void
+_put16(uint16_t value) {
+  _put8(value >> 8);
+  _put8(value & 255);
+}
+
+static void
+_set16(size_t offset, uint16_t value) {
+  _packet[offset] = value >> 8;
+  _packet[offset + 1] = value & 255;
+}
+
+static void
+_put_addr(const struct netaddr *addr) {
+  memcpy(&_packet[_packet_len], netaddr_get_binptr(addr), netaddr_get_binlength(addr));
+  _packet_len += netaddr_get_binlength(addr);
+}
+
+static void
+_put_metric_tlv(uint32_t cost) {
+  struct rfc7181_metric_field metric;
+
+  memset(&metric, 0, sizeof(metric));
+  CHECK_TRUE(rfc7181_metric_encode(&metric, cost) == 0, "cannot encode metric %u", cost);
+  rfc7181_metric_set_flag(&metric, RFC7181_LINKMETRIC_OUTGOING_NEIGH);
+
+  _put8(RFC7181_ADDRTLV_LINK_METRIC);
+  _put8(RFC5444_TLV_FLAG_VALUE);
+  _put8(sizeof(metric));
+  _put8(metric.b[0]);
+  _put8(metric.b[1]);
+}
+
+/**
+ * Receive a complete TC of the neighbor
+ * @param ansn answer set number of TC
+ * @param count number of advertised neighbors
+ * @param costs outgoing metric of each advertised neighbor
+ * @param gw_distance distance of the attached network
+ */
+static void
+_receive_tc(uint16_t ansn, size_t count, const uint32_t *costs, uint8_t gw_distance) {
+  size_t msg_start, tlv_start, i;
+
+  _packet_len = 0;
+
+  /* packet header without sequence number and tlvs */
+  _put8(0);
+
+  /* message header */
+  msg_start = _packet_len;
+  _put8(RFC7181_MSGTYPE_TC);
+  _put8(RFC5444_MSG_FLAG_ORIGINATOR | RFC5444_MSG_FLAG_HOPLIMIT
+      | RFC5444_MSG_FLAG_HOPCOUNT | RFC5444_MSG_FLAG_SEQNO | (4 - 1));
+  _put16(0);
+  _put_addr(&_addr[1]);
+  _put8(255);
+  _put8(0);
+  _put16(++_seqno);
+
+  /* message tlvs */
+  tlv_start = _packet_len;
+  _put16(0);
+  _put8(RFC5497_MSGTLV_VALIDITY_TIME);
+  _put8(RFC5444_TLV_FLAG_VALUE);
+  _put8(1);
+  _put8(rfc5497_timetlv_encode(TEST_VTIME));
+  _put8(RFC7181_MSGTLV_CONT_SEQ_NUM);
+  _put8(RFC5444_TLV_FLAG_TYPEEXT | RFC5444_TLV_FLAG_VALUE);
+  _put8(RFC7181_CONT_SEQ_NUM_COMPLETE);
+  _put8(2);
+  _put16(ansn);
+  _set16(tlv_start, _packet_len - tlv_start - 2);
+
+  /* one address block for each advertised neighbor */
+  for (i = 0; i < count; i++) {
+    _put8(1);
+    _put8(0);
+    _put_addr(&_addr[2 + i]);
+
+    tlv_start = _packet_len;
+    _put16(0);
+    _put8(RFC7181_ADDRTLV_NBR_ADDR_TYPE);
+    _put8(RFC5444_TLV_FLAG_VALUE);
+    _put8(1);
+    _put8(RFC7181_NBR_ADDR_TYPE_ORIGINATOR);
+    _put_metric_tlv(costs[i]);
+    _set16(tlv_start, _packet_len - tlv_start - 2);
+  }
+
+  /* attached network */
+  _put8(1);
+  _put8(RFC5444_ADDR_FLAG_SINGLEPLEN);
+  _put_addr(&_gateway);
+  _put8(netaddr_get_prefix_length(&_gateway));
+
+  tlv_start = _packet_len;
+  _put16(0);
+  _put8(RFC7181_ADDRTLV_GATEWAY);
+  _put8(RFC5444_TLV_FLAG_VALUE);
+  _put8(1);
+  _put8(gw_distance);
+  _put_metric_tlv(1000);
+  _set16(tlv_start, _packet_len - tlv_start - 2);
+
+  _set16(msg_start + 2, _packet_len - msg_start);
+
+  CHECK_TRUE(rfc5444_reader_handle_packet(&_test_protocol.reader, _packet, _packet_len)
+      == RFC5444_OKAY, "TC was not parsed");
+}
+
+/**
+ * Run dijkstra and act like a kernel that accepts all route changes
+ * @return number of route changes sent to the kernel
+ */
+static size_t
+_update_routes(void) {
+  struct olsrv2_routing_entry *rtentry, *rt_it;
+  size_t count;
+
+  _calculate_domain(_domain);
+  _process_dijkstra_result(_domain);
+
+  count = 0;
+  list_for_each_element_safe(&_kernel_queue, rtentry, _working_node, rt_it) {
+    list_remove(&rtentry->_working_node);
+    if (!rtentry->set) {
+      _remove_entry(rtentry);
+    }
+    count++;
+  }
+  return count;
+}
+
+static void
+clear_elements(void) {
+  struct olsrv2_tc_node *node, *n_it;
+
+  /* start each test with an empty topology */
+  avl_for_each_element_safe(olsrv2_tc_get_tree(), node, _originator_node, n_it) {
+    if (!node->direct_neighbor) {
+      olsrv2_tc_node_remove(node);
+    }
+  }
+  _update_routes();
+}
+
+static void
+test_replay_identical_tc(void) {
+  static const uint32_t costs[TEST_TC_NEIGHBORS] = { 1000, 2000, 3000 };
+  uint64_t generation;
+  size_t changes;
+  int i;
+
+  START_TEST();
+
+  generation = olsrv2_routing_get_generation();
+  _receive_tc(1, TEST_TC_NEIGHBORS, costs, 2);
+  CHECK_TRUE(olsrv2_routing_get_generation() != generation, "new TC did not change generation");
+
+  generation = olsrv2_routing_get_generation();
+  changes = _update_routes();
+  /* the route to the neighbor itself was already set */
+  CHECK_TRUE(changes == TEST_TC_NEIGHBORS + 1, "%" PRINTF_SIZE_T_SPECIFIER " route changes", changes);
+  CHECK_TRUE(olsrv2_routing_get_generation() != generation, "new routes did not change generation");
+
+  /* periodic refresh with the same ANSN and content */
+  generation = olsrv2_routing_get_generation();
+  for (i = 0; i < TEST_REPLAYS; i++) {
+    _receive_tc(1, TEST_TC_NEIGHBORS, costs, 2);
+    CHECK_TRUE(olsrv2_routing_get_generation() == generation,
+        "replay %d: identical TC changed generation", i);
+
+    changes = _update_routes();
+    CHECK_TRUE(changes == 0, "replay %d: %" PRINTF_SIZE_T_SPECIFIER " route changes", i, changes);
+    CHECK_TRUE(olsrv2_routing_get_generation() == generation,
+        "replay %d: dijkstra without changes changed generation", i);
+  }
+
+  END_TEST();
+}
+
+static void
+test_changed_tc(void) {
+  uint32_t costs[TEST_TC_NEIGHBORS] = { 1000, 2000, 3000 };
+  uint64_t generation;
+  size_t changes;
+
+  START_TEST();
+
+  _receive_tc(1, TEST_TC_NEIGHBORS, costs, 2);
+  _update_routes();
+
+  /* changed edge cost, kernel routes stay the same but their path cost does not */
+  generation = olsrv2_routing_get_generation();
+  costs[1] = 5000;
+  _receive_tc(1, TEST_TC_NEIGHBORS, costs, 2);
+  CHECK_TRUE(olsrv2_routing_get_generation() != generation, "edge cost change kept generation");
+
+  generation = olsrv2_routing_get_generation();
+  changes = _update_routes();
+  CHECK_TRUE(changes == 0, "%" PRINTF_SIZE_T_SPECIFIER " route changes", changes);
+  CHECK_TRUE(olsrv2_routing_get_generation() != generation, "path cost change kept generation");
+
+  /* changed distance of attached network */
+  generation = olsrv2_routing_get_generation();
+  _receive_tc(1, TEST_TC_NEIGHBORS, costs, 3);
+  CHECK_TRUE(olsrv2_routing_get_generation() != generation, "attached network change kept generation");
+  _update_routes();
+
+  /* new ANSN without the last neighbor */
+  generation = olsrv2_routing_get_generation();
+  _receive_tc(2, TEST_TC_NEIGHBORS - 1, costs, 3);
+  CHECK_TRUE(olsrv2_routing_get_generation() != generation, "lost edge kept generation");
+
+  generation = olsrv2_routing_get_generation();
+  changes = _update_routes();
+  CHECK_TRUE(changes == 1, "%" PRINTF_SIZE_T_SPECIFIER " route changes", changes);
+  CHECK_TRUE(olsrv2_routing_get_generation() != generation, "lost route kept generation");
+
+  /* and the new state is stable again */
+  generation = olsrv2_routing_get_generation();
+  _receive_tc(2, TEST_TC_NEIGHBORS - 1, costs, 3);
+  CHECK_TRUE(_update_routes() == 0, "replay changed routes");
+  CHECK_TRUE(olsrv2_routing_get_generation() == generation, "replay changed generation");
+
+  END_TEST();
+}
+
+int
+main(int argc __attribute__ ((unused)), char **argv __attribute__ ((unused))) {
+  struct nhdp_neighbor_domaindata *data;
+  uint8_t i;
+  int result;
+
+  if (oonf_log_init(&_appdata, LOG_SEVERITY_WARN)
+      || subsystem_helper_init(OONF_NHDP_SUBSYSTEM)) {
+    return 1;
+  }
+
+  for (i = 0; i < ARRAYSIZE(_addr); i++) {
+    if (netaddr_from_binary(&_addr[i], (uint8_t[]) { 10, 0, 0, 1 + i }, 4, AF_INET)) {
+      return 1;
+    }
+  }
+  if (netaddr_from_binary_prefix(&_gateway, (uint8_t[]) { 10, 99, 0, 0 }, 4, AF_INET, 24)) {
+    return 1;
+  }
+
+  _domain = nhdp_domain_add(0);
+  if (_domain == NULL || olsrv2_routing_init()) {
+    return 1;
+  }
+  olsrv2_lan_init();
+  olsrv2_originator_init();
+  olsrv2_tc_init();
+  olsrv2_originator_set(&_addr[0]);
+
+  /* the TC originator is a symmetric NHDP neighbor */
+  _neighbor = nhdp_db_neighbor_add();
+  if (_neighbor == NULL) {
+    return 1;
+  }
+  nhdp_db_neighbor_set_originator(_neighbor, &_addr[1]);
+  nhdp_db_neighbor_addr_add(_neighbor, &_addr[1]);
+  _neighbor->symmetric = 1;
+  _link.if_addr = _addr[1];
+
+  data = nhdp_domain_get_neighbordata(_domain, _neighbor);
+  data->best_out_link = &_link;
+  data->best_link_ifindex = 1;
+  data->metric.in = 1000;
+  data->metric.out = 1000;
+
+  /* the reader only accepts TCs from an active IPv4 socket */
+  list_init_head(&_active_sockets);
+  list_add_tail(&_active_sockets, &_test_interface._socket.socket_v4.node);
+  _test_protocol.input.src_address = &_addr[1];
+  _test_protocol.input.interface = &_test_interface;
+  rfc5444_reader_init(&_test_protocol.reader);
+  olsrv2_reader_init(&_test_protocol);
+
+  BEGIN_TESTING(clear_elements);
+
+  test_replay_identical_tc();
+  test_changed_tc();
+
+  result = FINISH_TESTING();
+
+  olsrv2_reader_cleanup();
+  rfc5444_reader_cleanup(&_test_protocol.reader);
+  nhdp_db_neighbor_remove(_neighbor);
+
+  olsrv2_tc_cleanup();
+  olsrv2_originator_cleanup();
+  olsrv2_lan_cleanup();
+  olsrv2_routing_cleanup();
+  subsystem_helper_cleanup();
+  oonf_log_cleanup();
+  return result;
+}
@@ -0,0 +1,345 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ *
+ * Size and speed comparison of the default RFC5444 address compression
+ * and the sorted address compression of the writer. Generates messages
+ * with a set of random IPv4 and IPv6 addresses with two address tlvs
+ * each and checks that the generated messages can be parsed again.
+ *
+ * Usage: benchmark_rfc5444_addrcompression [<rounds>]
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "common/common_types.h"
+#include "common/netaddr.h"
+#include "rfc5444/rfc5444_reader.h"
+#include "rfc5444/rfc5444_writer.h"
+
+#define MSG_TYPE 1
+
+enum {
+  MAX_ADDRESSES = 1000,
+};
+
+/**
+ * Definition of an address set for the benchmark
+ */
+struct bench_scenario {
+  /*! name of scenario */
+  const char *name;
+
+  /*! address family */
+  int af_type;
+
+  /*! number of addresses */
+  size_t count;
+
+  /*! number of different prefixes the addresses are taken from */
+  size_t prefixes;
+};
+
+static void _cb_addAddresses(struct rfc5444_writer *wr);
+static void _cb_send_packet(struct rfc5444_writer *,
+    struct rfc5444_writer_target *, void *, size_t);
+static enum rfc5444_result _cb_addr(struct rfc5444_reader_tlvblock_context *context);
+static void _generate_addresses(struct bench_scenario *scenario);
+static uint64_t _run(bool sorted, uint32_t rounds, size_t *bytes, uint32_t *parsed);
+static uint64_t _get_usec(void);
+
+static uint8_t _msg_buffer[1500];
+static uint8_t _msg_addrtlvs[16384];
+static uint8_t _packet_buffer[1500];
+
+static struct rfc5444_writer _writer = {
+  .msg_buffer = _msg_buffer,
+  .msg_size = sizeof(_msg_buffer),
+  .addrtlv_buffer = _msg_addrtlvs,
+  .addrtlv_size = sizeof(_msg_addrtlvs),
+};
+
+static struct rfc5444_writer_target _target = {
+  .packet_buffer = _packet_buffer,
+  .packet_size = sizeof(_packet_buffer),
+  .sendPacket = _cb_send_packet,
+};
+
+static struct rfc5444_writer_content_provider _provider = {
+  .msg_type = MSG_TYPE,
+  .addAddresses = _cb_addAddresses,
+};
+
+static struct rfc5444_writer_tlvtype _addrtlvs[] = {
+  { .type = 1 },
+  { .type = 2, .exttype = 1 },
+};
+
+static struct rfc5444_reader _reader;
+
+static struct rfc5444_reader_tlvblock_consumer _addr_consumer = {
+  .msg_id = MSG_TYPE,
+  .addrblock_consumer = true,
+  .start_callback = _cb_addr,
+};
+
+static struct bench_scenario _scenarios[] = {
+  { .name = "IPv4 30/3",    .af_type = AF_INET,  .count = 30,  .prefixes = 3 },
+  { .name = "IPv4 300/8",   .af_type = AF_INET,  .count = 300, .prefixes = 8 },
+  { .name = "IPv6 30/3",    .af_type = AF_INET6, .count = 30,  .prefixes = 3 },
+  { .name = "IPv6 300/8",   .af_type = AF_INET6, .count = 300, .prefixes = 8 },
+  { .name = "IPv6 1000/16", .af_type = AF_INET6, .count = 1000, .prefixes = 16 },
+};
+
+static struct netaddr _addresses[MAX_ADDRESSES];
+static size_t _address_count;
+
+static size_t _bytes;
+static uint32_t _parsed;
+
+/**
+ * Add all addresses of the current scenario to the message
+ * @param wr rfc5444 writer
+ */
+static void
+_cb_addAddresses(struct rfc5444_writer *wr) {
+  struct rfc5444_writer_address *addr;
+  uint8_t type, metric[2];
+  size_t i;
+
+  for (i=0; i<_address_count; i++) {
+    addr = rfc5444_writer_add_address(wr, _provider.creator, &_addresses[i], false);
+    if (addr == NULL) {
+      return;
+    }
+
+    type = i % 3 == 0 ? 1 : 2;
+    metric[0] = 0x10;
+    metric[1] = (i * 7) & 255;
+
+    rfc5444_writer_add_addrtlv(wr, addr, &_addrtlvs[0], &type, sizeof(type), false);
+    rfc5444_writer_add_addrtlv(wr, addr, &_addrtlvs[1], metric, sizeof(metric), false);
+  }
+}
+
+/**
+ * Count and parse generated packets
+ * @param wr rfc5444 writer
+ * @param target rfc5444 target
+ * @param buffer pointer to packet
+ * @param length length of packet
+ */
+static void
+_cb_send_packet(struct rfc5444_writer *wr __attribute__((unused)),
+    struct rfc5444_writer_target *target __attribute__((unused)),
+    void *buffer, size_t length) {
+  _bytes += length;
+  if (_parsed != UINT32_MAX) {
+    { int r = rfc5444_reader_handle_packet(&_reader, buffer, length); if (r) fprintf(stderr, "parse error %d len %zu\n", r, length);}
+  }
+}
+
+/**
+ * Count parsed addresses
+ * @param context rfc5444 context
+ * @return always RFC5444_OKAY
+ */
+static enum rfc5444_result
+_cb_addr(struct rfc5444_reader_tlvblock_context *context __attribute__((unused))) {
+  _parsed++;
+  return RFC5444_OKAY;
+}
+
+/**
+ * Generate a random set of addresses for a scenario
+ * @param scenario benchmark scenario
+ */
+static void
+_generate_addresses(struct bench_scenario *scenario) {
+  struct netaddr tmp;
+  uint8_t bin[16];
+  size_t i, j, len, prefix;
+
+  len = scenario->af_type == AF_INET ? 4 : 16;
+
+  for (i=0; i<scenario->count; i++) {
+    prefix = (size_t)rand() % scenario->prefixes;
+
+    memset(bin, 0, sizeof(bin));
+    if (len == 4) {
+      bin[0] = 10;
+      bin[1] = 1;
+      bin[2] = (uint8_t)(prefix * 8 + i / 254);
+      bin[3] = (uint8_t)(1 + i % 254);
+    }
+    else {
+      bin[0] = 0x20;
+      bin[1] = 0x01;
+      bin[2] = 0x0d;
+      bin[3] = 0xb8;
+      bin[7] = (uint8_t)prefix;
+      for (j=8; j<16; j++) {
+        bin[j] = rand() & 255;
+      }
+    }
+    netaddr_from_binary(&_addresses[i], bin, len, scenario->af_type);
+  }
+
+  /* shuffle addresses */
+  for (i=scenario->count-1; i>0; i--) {
+    j = (size_t)rand() % (i+1);
+    memcpy(&tmp, &_addresses[i], sizeof(tmp));
+    memcpy(&_addresses[i], &_addresses[j], sizeof(tmp));
+    memcpy(&_addresses[j], &tmp, sizeof(tmp));
+  }
+  _address_count = scenario->count;
+}
+
+/**
+ * Generate the messages of the current scenario multiple times
+ * @param sorted true to use sorted address compression
+ * @param rounds number of generated messages
+ * @param bytes pointer to store number of generated bytes per message
+ * @param parsed pointer to store number of parsed addresses per message
+ * @return runtime in microseconds
+ */
+static uint64_t
+_run(bool sorted, uint32_t rounds, size_t *bytes, uint32_t *parsed) {
+  uint64_t start, end;
+  uint8_t addr_len;
+  uint32_t r;
+
+  addr_len = netaddr_get_binlength(&_addresses[0]);
+  _writer.sorted_addr_compression = sorted;
+
+  /* generate one message to check size and content */
+  _bytes = 0;
+  _parsed = 0;
+  rfc5444_writer_create_message_alltarget(&_writer, MSG_TYPE, addr_len);
+  rfc5444_writer_flush(&_writer, &_target, false);
+  *bytes = _bytes;
+  *parsed = _parsed;
+
+  /* do not parse during time measurement */
+  _parsed = UINT32_MAX;
+
+  start = _get_usec();
+  for (r=0; r<rounds; r++) {
+    rfc5444_writer_create_message_alltarget(&_writer, MSG_TYPE, addr_len);
+    rfc5444_writer_flush(&_writer, &_target, false);
+  }
+  end = _get_usec();
+  return end - start;
+}
+
+/**
+ * @return monotonic time in microseconds
+ */
+static uint64_t
+_get_usec(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000ull + (uint64_t)ts.tv_nsec / 1000ull;
+}
+
+int
+main(int argc, char **argv) {
+  struct rfc5444_writer_message *msg;
+  uint32_t rounds = 2000;
+  uint64_t default_time, sorted_time;
+  size_t default_bytes, sorted_bytes;
+  uint32_t default_parsed, sorted_parsed;
+  size_t i;
+  int result = 0;
+
+  if (argc > 1) {
+    rounds = (uint32_t)strtoul(argv[1], NULL, 10);
+  }
+  if (rounds == 0) {
+    fprintf(stderr, "Usage: %s [<rounds>]\n", argv[0]);
+    return 1;
+  }
+
+  srand(42);
+
+  rfc5444_reader_init(&_reader);
+  rfc5444_reader_add_message_consumer(&_reader, &_addr_consumer, NULL, 0);
+
+  rfc5444_writer_init(&_writer);
+  rfc5444_writer_register_target(&_writer, &_target);
+  msg = rfc5444_writer_register_message(&_writer, MSG_TYPE, false);
+  rfc5444_writer_register_msgcontentprovider(&_writer, &_provider, _addrtlvs, ARRAYSIZE(_addrtlvs));
+
+  printf("%u messages per scenario\n", rounds);
+  printf("%-14s %10s %10s %12s %12s %8s\n", "scenario", "bytes", "sorted",
+      "time (us)", "sorted (us)", "speedup");
+
+  for (i=0; i<ARRAYSIZE(_scenarios); i++) {
+    _generate_addresses(&_scenarios[i]);
+
+    default_time = _run(false, rounds, &default_bytes, &default_parsed);
+    sorted_time = _run(true, rounds, &sorted_bytes, &sorted_parsed);
+
+    printf("%-14s %10zu %10zu %12"PRIu64" %12"PRIu64" %8.2f\n", _scenarios[i].name,
+        default_bytes, sorted_bytes, default_time, sorted_time,
+        (double)default_time / sorted_time);
+
+    if (default_parsed != (uint32_t)_address_count || sorted_parsed != (uint32_t)_address_count) {
+      fprintf(stderr, "Parsed %u/%u addresses, expected %zu\n",
+          default_parsed, sorted_parsed, _address_count);
+      result = 1;
+    }
+  }
+
+  rfc5444_writer_unregister_content_provider(&_writer, &_provider, _addrtlvs, ARRAYSIZE(_addrtlvs));
+  rfc5444_writer_unregister_message(&_writer, msg);
+  rfc5444_writer_cleanup(&_writer);
+
+  rfc5444_reader_remove_message_consumer(&_reader, &_addr_consumer);
+  rfc5444_reader_cleanup(&_reader);
+  return result;
+}
@@ -0,0 +1,223 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ *
+ * Parse throughput benchmark for the RFC5444 reader, compares the
+ * malloc based reader with the arena reader on the packets of the
+ * interop2010 test corpus.
+ *
+ * Usage: benchmark_rfc5444_reader [<rounds>]
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "common/common_types.h"
+#include "common/avl.h"
+#include "common/avl_comp.h"
+#include "rfc5444/rfc5444_reader.h"
+#include "test_rfc5444_interop.h"
+
+static enum rfc5444_result _cb_tlv(struct rfc5444_reader_tlvblock_entry *,
+    struct rfc5444_reader_tlvblock_context *context);
+static enum rfc5444_result _cb_addr_start(
+    struct rfc5444_reader_tlvblock_context *context);
+static uint64_t _run(bool use_arena, uint32_t rounds,
+    size_t *bytes, size_t *high_water);
+static uint64_t _get_usec(void);
+
+static struct rfc5444_reader_tlvblock_consumer _packet_consumer = {
+  .tlv_callback = _cb_tlv,
+};
+static struct rfc5444_reader_tlvblock_consumer _msg_consumer = {
+  .default_msg_consumer = true,
+  .tlv_callback = _cb_tlv,
+};
+static struct rfc5444_reader_tlvblock_consumer _addr_consumer = {
+  .default_msg_consumer = true,
+  .addrblock_consumer = true,
+  .start_callback = _cb_addr_start,
+  .tlv_callback = _cb_tlv,
+};
+
+/* corpus of test packets */
+static struct avl_tree _test_tree;
+
+/* counters to make sure both readers see the same content */
+static uint64_t _tlv_count, _addr_count;
+
+/**
+ * Callback for all TLVs
+ * @param entry tlv entry
+ * @param context tlv context
+ * @return always RFC5444_OKAY
+ */
+static enum rfc5444_result
+_cb_tlv(struct rfc5444_reader_tlvblock_entry *entry __attribute__((unused)),
+    struct rfc5444_reader_tlvblock_context *context __attribute__((unused))) {
+  _tlv_count++;
+  return RFC5444_OKAY;
+}
+
+/**
+ * Callback for all addresses
+ * @param context address context
+ * @return always RFC5444_OKAY
+ */
+static enum rfc5444_result
+_cb_addr_start(struct rfc5444_reader_tlvblock_context *context __attribute__((unused))) {
+  _addr_count++;
+  return RFC5444_OKAY;
+}
+
+/**
+ * Parse the whole corpus multiple times
+ * @param use_arena true to use arena reader, false for malloc reader
+ * @param rounds number of iterations over the corpus
+ * @param bytes pointer to counter for parsed bytes
+ * @param high_water pointer to store arena high water mark
+ * @return runtime in microseconds
+ */
+static uint64_t
+_run(bool use_arena, uint32_t rounds, size_t *bytes, size_t *high_water) {
+  struct rfc5444_reader reader;
+  struct test_packet *packet;
+  uint64_t start, end;
+  uint32_t r;
+
+  memset(&reader, 0, sizeof(reader));
+  reader.use_arena = use_arena;
+
+  rfc5444_reader_init(&reader);
+  rfc5444_reader_add_packet_consumer(&reader, &_packet_consumer, NULL, 0);
+  rfc5444_reader_add_message_consumer(&reader, &_msg_consumer, NULL, 0);
+  rfc5444_reader_add_message_consumer(&reader, &_addr_consumer, NULL, 0);
+
+  *bytes = 0;
+  start = _get_usec();
+  for (r=0; r<rounds; r++) {
+    avl_for_each_element(&_test_tree, packet, _node) {
+      rfc5444_reader_handle_packet(&reader, packet->binary, packet->binlen);
+      *bytes += packet->binlen;
+    }
+  }
+  end = _get_usec();
+
+  *high_water = reader.arena.high_water;
+
+  rfc5444_reader_remove_message_consumer(&reader, &_addr_consumer);
+  rfc5444_reader_remove_message_consumer(&reader, &_msg_consumer);
+  rfc5444_reader_remove_packet_consumer(&reader, &_packet_consumer);
+  rfc5444_reader_cleanup(&reader);
+  return end - start;
+}
+
+/**
+ * @return monotonic time in microseconds
+ */
+static uint64_t
+_get_usec(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000ull + (uint64_t)ts.tv_nsec / 1000ull;
+}
+
+/**
+ * Collect test packets of the interop2010 corpus
+ * @param p test packet
+ */
+void
+add_test(struct test_packet *p) {
+  if (_test_tree.comp == NULL) {
+    avl_init(&_test_tree, avl_comp_strcasecmp, false);
+  }
+
+  p->_node.key = p->test;
+  avl_insert(&_test_tree, &p->_node);
+}
+
+int
+main(int argc, char **argv) {
+  uint32_t rounds = 20000;
+  uint64_t malloc_time, arena_time;
+  uint64_t malloc_tlvs, malloc_addrs;
+  size_t bytes, high_water;
+
+  if (argc > 1) {
+    rounds = (uint32_t)strtoul(argv[1], NULL, 10);
+  }
+  if (rounds == 0 || _test_tree.comp == NULL) {
+    fprintf(stderr, "Usage: %s [<rounds>]\n", argv[0]);
+    return 1;
+  }
+
+  printf("%u packets in corpus, %u rounds\n", _test_tree.count, rounds);
+
+  _tlv_count = _addr_count = 0;
+  malloc_time = _run(false, rounds, &bytes, &high_water);
+  malloc_tlvs = _tlv_count;
+  malloc_addrs = _addr_count;
+
+  _tlv_count = _addr_count = 0;
+  arena_time = _run(true, rounds, &bytes, &high_water);
+
+  if (malloc_tlvs != _tlv_count || malloc_addrs != _addr_count) {
+    fprintf(stderr, "Readers disagree: %"PRIu64"/%"PRIu64" tlvs, %"PRIu64"/%"PRIu64" addresses\n",
+        malloc_tlvs, _tlv_count, malloc_addrs, _addr_count);
+    return 1;
+  }
+
+  printf("%8s %12s %12s %12s\n", "reader", "time (us)", "packets/s", "MByte/s");
+  printf("%8s %12"PRIu64" %12.0f %12.1f\n", "malloc", malloc_time,
+      (double)_test_tree.count * rounds * 1e6 / malloc_time,
+      (double)bytes / malloc_time);
+  printf("%8s %12"PRIu64" %12.0f %12.1f\n", "arena", arena_time,
+      (double)_test_tree.count * rounds * 1e6 / arena_time,
+      (double)bytes / arena_time);
+  printf("speedup %.2f, arena high water %zu bytes\n",
+      (double)malloc_time / arena_time, high_water);
+  return 0;
+}
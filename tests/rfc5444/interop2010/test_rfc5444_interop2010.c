@@ -393,12 +393,44 @@ _addr_tlv_callback(struct rfc5444_reader_tlvblock_entry *entry,
   return RFC5444_OKAY;
 }
 
+/**
+ * Clear the okay flags of a test packet so it can be parsed again
+ * @param p test packet
+ */
+static void
+_reset_packet(struct test_packet *p) {
+  struct test_message *msg;
+  struct test_address *addr;
+  size_t i,j,k;
+
+  for (i=0; i<p->tlv_count; i++) {
+    p->tlvs[i].okay = false;
+  }
+  for (i=0; i<p->msg_count; i++) {
+    msg = &p->msgs[i];
+    msg->okay = false;
+
+    for (j=0; j<msg->tlv_count; j++) {
+      msg->tlvs[j].okay = false;
+    }
+    for (j=0; j<msg->address_count; j++) {
+      addr = &msg->addrs[j];
+      addr->okay = false;
+
+      for (k=0; k<addr->tlv_count; k++) {
+        addr->tlvs[k].okay = false;
+      }
+    }
+  }
+}
+
 static void
 test_interop2010(struct test_packet *p) {
   enum rfc5444_result result;
 
   cunit_start_test(p->test);
   _packet = p;
+  _reset_packet(p);
 
   result = rfc5444_reader_handle_packet(&reader, _packet->binary, _packet->binlen);
   CHECK_TRUE(result == RFC5444_OKAY, "Reader error: %s (%d)",
@@ -420,18 +452,30 @@ add_test(struct test_packet *p) {
 int
 main(int argc __attribute__((unused)), char **argv __attribute__((unused))) {
   struct test_packet *packet;
+  int mode;
+
   BEGIN_TESTING(NULL);
 
-  rfc5444_reader_init(&reader);
-  rfc5444_reader_add_packet_consumer(&reader, &_packet_consumer, NULL, 0);
-  rfc5444_reader_add_message_consumer(&reader, &_msg_consumer, NULL, 0);
-  rfc5444_reader_add_message_consumer(&reader, &_addr_consumer, NULL, 0);
+  /*
+   * run all tests with malloc reader, with arena reader and with
+   * tiny arena chunks to force moving TLV arrays between chunks
+   */
+  for (mode=0; mode<3; mode++) {
+    memset(&reader, 0, sizeof(reader));
+    reader.use_arena = mode > 0;
+    reader.arena.chunk_size = mode == 2 ? 256 : 0;
+
+    rfc5444_reader_init(&reader);
+    rfc5444_reader_add_packet_consumer(&reader, &_packet_consumer, NULL, 0);
+    rfc5444_reader_add_message_consumer(&reader, &_msg_consumer, NULL, 0);
+    rfc5444_reader_add_message_consumer(&reader, &_addr_consumer, NULL, 0);
+
+    avl_for_each_element(&_test_tree, packet, _node) {
+      test_interop2010(packet);
+    }
 
-  avl_for_each_element(&_test_tree, packet, _node) {
-    test_interop2010(packet);
+    rfc5444_reader_cleanup(&reader);
   }
 
-  rfc5444_reader_cleanup(&reader);
-
   return FINISH_TESTING();
 }
@@ -0,0 +1,286 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+#include <assert.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "common/common_types.h"
+#include "common/bitmap256.h"
+#include "rfc5444/rfc5444_reader.h"
+#include "cunit/cunit.h"
+
+/*
+ * consumer 0: message type 1, TLV type 1
+ * consumer 1: message type 1, TLV types 1 and 2 (overlaps consumer 0)
+ * consumer 2: message type 2, TLV type 3
+ * consumer 3: all message types, TLV type 4, sees every TLV
+ */
+static struct rfc5444_reader_tlvblock_consumer_entry consumer_entries0[] = {
+  { .type = 1 },
+};
+static struct rfc5444_reader_tlvblock_consumer_entry consumer_entries1[] = {
+  { .type = 1 },
+  { .type = 2 },
+};
+static struct rfc5444_reader_tlvblock_consumer_entry consumer_entries2[] = {
+  { .type = 3 },
+};
+static struct rfc5444_reader_tlvblock_consumer_entry consumer_entries3[] = {
+  { .type = 4 },
+};
+
+/* rfc5444 test messages */
+static uint8_t testpacket_msg1[] = {
+/* packet without tlvblock and sequence number */
+    0x00,
+/* message type 1, address length 4, size 10 */
+    1, 0x03, 0, 10,
+/* tlvblock, tlv type 1, tlv type 3 */
+    0, 4, 1, 0, 3, 0
+};
+static uint8_t testpacket_msg2[] = {
+/* packet without tlvblock and sequence number */
+    0x00,
+/* message type 2, address length 4, size 8 */
+    2, 0x03, 0, 8,
+/* tlvblock, tlv type 3 */
+    0, 2, 3, 0
+};
+
+static struct rfc5444_reader reader;
+static struct rfc5444_reader_tlvblock_consumer consumer[4];
+
+static int called[4];
+static bool got_tlv1[2];
+static bool got_tlv2;
+static bool got_tlv3;
+static bool got_tlv4;
+static int tlv_count;
+
+static enum rfc5444_result
+cb_block0(struct rfc5444_reader_tlvblock_context *cont __attribute__ ((unused))) {
+  called[0]++;
+  got_tlv1[0] = consumer_entries0[0].tlv != NULL;
+  return RFC5444_OKAY;
+}
+
+static enum rfc5444_result
+cb_block1(struct rfc5444_reader_tlvblock_context *cont __attribute__ ((unused))) {
+  called[1]++;
+  got_tlv1[1] = consumer_entries1[0].tlv != NULL;
+  got_tlv2 = consumer_entries1[1].tlv != NULL;
+  return RFC5444_OKAY;
+}
+
+static enum rfc5444_result
+cb_block2(struct rfc5444_reader_tlvblock_context *cont __attribute__ ((unused))) {
+  called[2]++;
+  got_tlv3 = consumer_entries2[0].tlv != NULL;
+  return RFC5444_OKAY;
+}
+
+static enum rfc5444_result
+cb_block3(struct rfc5444_reader_tlvblock_context *cont __attribute__ ((unused))) {
+  called[3]++;
+  got_tlv4 = consumer_entries3[0].tlv != NULL;
+  return RFC5444_OKAY;
+}
+
+static enum rfc5444_result
+cb_tlv3(struct rfc5444_reader_tlvblock_entry *entry __attribute__ ((unused)),
+    struct rfc5444_reader_tlvblock_context *cont __attribute__ ((unused))) {
+  tlv_count++;
+  return RFC5444_OKAY;
+}
+
+static void clear_elements(void) {
+  memset(called, 0, sizeof(called));
+  memset(got_tlv1, 0, sizeof(got_tlv1));
+  got_tlv2 = false;
+  got_tlv3 = false;
+  got_tlv4 = false;
+  tlv_count = 0;
+}
+
+static void
+add_consumers(void) {
+  memset(consumer, 0, sizeof(consumer));
+
+  consumer[0].order = 1;
+  consumer[0].msg_id = 1;
+  consumer[0].block_callback = cb_block0;
+  rfc5444_reader_add_message_consumer(&reader, &consumer[0],
+      consumer_entries0, ARRAYSIZE(consumer_entries0));
+
+  consumer[1].order = 2;
+  consumer[1].msg_id = 1;
+  consumer[1].block_callback = cb_block1;
+  rfc5444_reader_add_message_consumer(&reader, &consumer[1],
+      consumer_entries1, ARRAYSIZE(consumer_entries1));
+
+  consumer[2].order = 3;
+  consumer[2].msg_id = 2;
+  consumer[2].block_callback = cb_block2;
+  rfc5444_reader_add_message_consumer(&reader, &consumer[2],
+      consumer_entries2, ARRAYSIZE(consumer_entries2));
+
+  consumer[3].order = 4;
+  consumer[3].default_msg_consumer = true;
+  consumer[3].block_callback = cb_block3;
+  consumer[3].tlv_callback = cb_tlv3;
+  rfc5444_reader_add_message_consumer(&reader, &consumer[3],
+      consumer_entries3, ARRAYSIZE(consumer_entries3));
+}
+
+static void
+remove_consumers(void) {
+  int i;
+
+  for (i = 0; i < 4; i++) {
+    rfc5444_reader_remove_message_consumer(&reader, &consumer[i]);
+  }
+}
+
+static void test_tlv_bitmap(void) {
+  START_TEST();
+
+  CHECK_TRUE(bitmap256_get(&consumer[0]._tlv_types, 1), "consumer 0 TLV 1");
+  CHECK_TRUE(!bitmap256_get(&consumer[0]._tlv_types, 2), "consumer 0 TLV 2");
+  CHECK_TRUE(bitmap256_get(&consumer[1]._tlv_types, 1), "consumer 1 TLV 1");
+  CHECK_TRUE(bitmap256_get(&consumer[1]._tlv_types, 2), "consumer 1 TLV 2");
+  CHECK_TRUE(!bitmap256_get(&consumer[1]._tlv_types, 3), "consumer 1 TLV 3");
+  CHECK_TRUE(bitmap256_get(&consumer[2]._tlv_types, 3), "consumer 2 TLV 3");
+  CHECK_TRUE(!bitmap256_get(&consumer[2]._tlv_types, 1), "consumer 2 TLV 1");
+  CHECK_TRUE(bitmap256_get(&consumer[3]._tlv_types, 4), "consumer 3 TLV 4");
+  CHECK_TRUE(!bitmap256_get(&consumer[3]._tlv_types, 1), "consumer 3 TLV 1");
+
+  END_TEST();
+}
+
+static void test_dispatch_msg1(void) {
+  START_TEST();
+
+  rfc5444_reader_handle_packet(&reader, testpacket_msg1, sizeof(testpacket_msg1));
+
+  CHECK_TRUE(!reader._dispatch_dirty, "dispatch table rebuilt");
+  CHECK_TRUE(reader._dispatch_start[2] - reader._dispatch_start[1] == 3,
+      "msg type 1 consumers: %u", reader._dispatch_start[2] - reader._dispatch_start[1]);
+  CHECK_TRUE(reader._dispatch_start[3] - reader._dispatch_start[2] == 2,
+      "msg type 2 consumers: %u", reader._dispatch_start[3] - reader._dispatch_start[2]);
+  CHECK_TRUE(reader._dispatch_start[1] - reader._dispatch_start[0] == 1,
+      "msg type 0 consumers: %u", reader._dispatch_start[1] - reader._dispatch_start[0]);
+
+  CHECK_TRUE(called[0] == 1, "consumer 0 called %d times", called[0]);
+  CHECK_TRUE(called[1] == 1, "consumer 1 called %d times", called[1]);
+  CHECK_TRUE(called[2] == 0, "consumer 2 called %d times", called[2]);
+  CHECK_TRUE(called[3] == 1, "consumer 3 called %d times", called[3]);
+
+  CHECK_TRUE(got_tlv1[0], "consumer 0 TLV 1");
+  CHECK_TRUE(got_tlv1[1], "consumer 1 TLV 1");
+  CHECK_TRUE(!got_tlv2, "consumer 1 TLV 2");
+  CHECK_TRUE(!got_tlv4, "consumer 3 TLV 4");
+  CHECK_TRUE(tlv_count == 2, "consumer 3 saw %d TLVs", tlv_count);
+
+  END_TEST();
+}
+
+static void test_dispatch_msg2(void) {
+  START_TEST();
+
+  rfc5444_reader_handle_packet(&reader, testpacket_msg2, sizeof(testpacket_msg2));
+
+  CHECK_TRUE(called[0] == 0, "consumer 0 called %d times", called[0]);
+  CHECK_TRUE(called[1] == 0, "consumer 1 called %d times", called[1]);
+  CHECK_TRUE(called[2] == 1, "consumer 2 called %d times", called[2]);
+  CHECK_TRUE(called[3] == 1, "consumer 3 called %d times", called[3]);
+
+  CHECK_TRUE(got_tlv3, "consumer 2 TLV 3");
+  CHECK_TRUE(tlv_count == 1, "consumer 3 saw %d TLVs", tlv_count);
+
+  END_TEST();
+}
+
+static void test_remove_consumer(void) {
+  START_TEST();
+
+  rfc5444_reader_remove_message_consumer(&reader, &consumer[1]);
+
+  CHECK_TRUE(reader._dispatch_dirty, "dispatch table dirty");
+  CHECK_TRUE(!bitmap256_get(&consumer[1]._tlv_types, 1), "removed consumer TLV 1");
+  CHECK_TRUE(!bitmap256_get(&consumer[1]._tlv_types, 2), "removed consumer TLV 2");
+
+  rfc5444_reader_handle_packet(&reader, testpacket_msg1, sizeof(testpacket_msg1));
+
+  CHECK_TRUE(reader._dispatch_start[2] - reader._dispatch_start[1] == 2,
+      "msg type 1 consumers: %u", reader._dispatch_start[2] - reader._dispatch_start[1]);
+
+  CHECK_TRUE(called[0] == 1, "consumer 0 called %d times", called[0]);
+  CHECK_TRUE(called[1] == 0, "consumer 1 called %d times", called[1]);
+  CHECK_TRUE(called[3] == 1, "consumer 3 called %d times", called[3]);
+  CHECK_TRUE(got_tlv1[0], "consumer 0 TLV 1");
+
+  /* the remaining consumers keep their bitmaps */
+  CHECK_TRUE(bitmap256_get(&consumer[0]._tlv_types, 1), "consumer 0 TLV 1");
+  CHECK_TRUE(bitmap256_get(&consumer[2]._tlv_types, 3), "consumer 2 TLV 3");
+
+  END_TEST();
+}
+
+int main(int argc __attribute__ ((unused)), char **argv __attribute__ ((unused))) {
+  rfc5444_reader_init(&reader);
+  add_consumers();
+
+  BEGIN_TESTING(clear_elements);
+
+  test_tlv_bitmap();
+  test_dispatch_msg1();
+  test_dispatch_msg2();
+  test_remove_consumer();
+
+  remove_consumers();
+  rfc5444_reader_cleanup(&reader);
+
+  return FINISH_TESTING();
+}
@@ -0,0 +1,275 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "rfc5444/rfc5444_context.h"
+#include "rfc5444/rfc5444_writer.h"
+#include "cunit/cunit.h"
+
+#define MSG_TYPE 1
+
+static void write_packet(struct rfc5444_writer *,
+    struct rfc5444_writer_target *, void *, size_t);
+static void addMessageTLVs(struct rfc5444_writer *wr);
+static void addAddresses(struct rfc5444_writer *wr);
+
+static uint8_t msg_buffer[128];
+static uint8_t msg_addrtlvs[1000];
+
+static struct rfc5444_writer writer = {
+  .msg_buffer = msg_buffer,
+  .msg_size = sizeof(msg_buffer),
+  .addrtlv_buffer = msg_addrtlvs,
+  .addrtlv_size = sizeof(msg_addrtlvs),
+};
+
+static struct rfc5444_writer_content_provider cpr = {
+  .msg_type = MSG_TYPE,
+  .addMessageTLVs = addMessageTLVs,
+  .addAddresses = addAddresses,
+};
+
+static struct rfc5444_writer_tlvtype addrtlvs[] = {
+  { .type = 3 },
+};
+
+static uint8_t packet_buffer_if[256];
+static struct rfc5444_writer_target out_if = {
+  .packet_buffer = packet_buffer_if,
+  .packet_size = sizeof(packet_buffer_if),
+  .sendPacket = write_packet,
+};
+
+static struct rfc5444_writer_message *message;
+
+static int addrcount, address_calls, fragments;
+static uint8_t tlv_value_size, msgtlv_value;
+
+static uint8_t last_packet[256];
+static size_t last_packet_size;
+
+static int addMessageHeader(struct rfc5444_writer *wr, struct rfc5444_writer_message *msg) {
+  rfc5444_writer_set_msg_header(wr, msg, false, false, false, false);
+  return RFC5444_OKAY;
+}
+
+static void finishMessageHeader(struct rfc5444_writer *wr  __attribute__ ((unused)),
+    struct rfc5444_writer_message *msg __attribute__ ((unused)),
+    struct rfc5444_writer_address *first_addr __attribute__ ((unused)),
+    struct rfc5444_writer_address *last_addr __attribute__ ((unused)),
+    bool not_fragmented __attribute__ ((unused))) {
+  fragments++;
+}
+
+static void addMessageTLVs(struct rfc5444_writer *wr) {
+  rfc5444_writer_add_messagetlv(wr, 1, 0, &msgtlv_value, sizeof(msgtlv_value));
+}
+
+static void addAddresses(struct rfc5444_writer *wr) {
+  struct netaddr ip = { { 10,0,0,0}, AF_INET, 32 };
+  struct rfc5444_writer_address *addr;
+  uint8_t value[64];
+  int i;
+
+  address_calls++;
+
+  memset(value, 0, sizeof(value));
+  for (i=0; i<addrcount; i++) {
+    ip._addr[3] = i+1;
+    value[0] = i;
+
+    addr = rfc5444_writer_add_address(wr, cpr.creator, &ip, false);
+    rfc5444_writer_add_addrtlv(wr, addr, &addrtlvs[0], value, tlv_value_size, false);
+  }
+}
+
+static void write_packet(struct rfc5444_writer *w __attribute__ ((unused)),
+    struct rfc5444_writer_target *iface __attribute__ ((unused)),
+    void *buffer, size_t length) {
+  memcpy(last_packet, buffer, length);
+  last_packet_size = length;
+}
+
+static void clear_elements(void) {
+  address_calls = 0;
+  fragments = 0;
+  msgtlv_value = 0;
+  last_packet_size = 0;
+
+  rfc5444_writer_invalidate_addrcache(message, 0);
+}
+
+static void send_message(void) {
+  enum rfc5444_result result;
+
+  result = rfc5444_writer_create_message_alltarget(&writer, MSG_TYPE, 4);
+  CHECK_TRUE(result == RFC5444_OKAY, "create_message should return 0: %s (%d)",
+      rfc5444_strerror(result), result);
+  rfc5444_writer_flush(&writer, &out_if, false);
+}
+
+static void test_cache_reuse(void) {
+  uint8_t packet[256];
+  size_t packet_size;
+  uint32_t hits;
+  START_TEST();
+
+  addrcount = 5;
+  tlv_value_size = 2;
+
+  send_message();
+  memcpy(packet, last_packet, last_packet_size);
+  packet_size = last_packet_size;
+  hits = message->addr_cache_hits;
+
+  send_message();
+
+  CHECK_TRUE(address_calls == 1, "addAddresses was called %d times", address_calls);
+  CHECK_TRUE(message->addr_cache_hits == hits + 1, "cache was not used");
+  CHECK_TRUE(packet_size == last_packet_size,
+      "packet size changed: %zu != %zu", packet_size, last_packet_size);
+  CHECK_TRUE(memcmp(packet, last_packet, packet_size) == 0,
+      "cached packet is different from generated one");
+
+  END_TEST();
+}
+
+static void test_cache_msgtlv_change(void) {
+  uint8_t packet[256];
+  size_t packet_size;
+  START_TEST();
+
+  addrcount = 5;
+  tlv_value_size = 2;
+
+  send_message();
+
+  /* message TLVs are still generated for every message */
+  msgtlv_value = 42;
+  send_message();
+  memcpy(packet, last_packet, last_packet_size);
+  packet_size = last_packet_size;
+
+  CHECK_TRUE(address_calls == 1, "addAddresses was called %d times", address_calls);
+
+  /* compare with a freshly generated message */
+  rfc5444_writer_invalidate_addrcache(message, 4);
+  send_message();
+
+  CHECK_TRUE(address_calls == 2, "addAddresses was called %d times", address_calls);
+  CHECK_TRUE(packet_size == last_packet_size,
+      "packet size changed: %zu != %zu", packet_size, last_packet_size);
+  CHECK_TRUE(memcmp(packet, last_packet, packet_size) == 0,
+      "cached packet is different from generated one");
+
+  END_TEST();
+}
+
+static void test_cache_invalidate(void) {
+  size_t packet_size;
+  START_TEST();
+
+  addrcount = 5;
+  tlv_value_size = 2;
+
+  send_message();
+  packet_size = last_packet_size;
+
+  addrcount = 6;
+  rfc5444_writer_invalidate_addrcache(message, 4);
+  send_message();
+
+  CHECK_TRUE(address_calls == 2, "addAddresses was called %d times", address_calls);
+  CHECK_TRUE(packet_size < last_packet_size, "new address is missing");
+
+  /* other address length must not drop the cache */
+  rfc5444_writer_invalidate_addrcache(message, 16);
+  send_message();
+  CHECK_TRUE(address_calls == 2, "addAddresses was called %d times", address_calls);
+
+  END_TEST();
+}
+
+static void test_cache_fragmented(void) {
+  START_TEST();
+
+  addrcount = 4;
+  tlv_value_size = 40;
+
+  send_message();
+  send_message();
+
+  CHECK_TRUE(fragments > 2, "message was not fragmented");
+  CHECK_TRUE(address_calls == 2, "addAddresses was called %d times", address_calls);
+
+  END_TEST();
+}
+
+int main(int argc __attribute__ ((unused)), char **argv __attribute__ ((unused))) {
+  rfc5444_writer_init(&writer);
+
+  rfc5444_writer_register_target(&writer, &out_if);
+
+  message = rfc5444_writer_register_message(&writer, MSG_TYPE, false);
+  message->addMessageHeader = addMessageHeader;
+  message->finishMessageHeader = finishMessageHeader;
+  message->use_addr_cache = true;
+
+  rfc5444_writer_register_msgcontentprovider(&writer, &cpr, addrtlvs, ARRAYSIZE(addrtlvs));
+
+  BEGIN_TESTING(clear_elements);
+
+  test_cache_reuse();
+  test_cache_msgtlv_change();
+  test_cache_invalidate();
+  test_cache_fragmented();
+
+  rfc5444_writer_cleanup(&writer);
+
+  return FINISH_TESTING();
+}
@@ -0,0 +1,272 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "common/netaddr.h"
+#include "rfc5444/rfc5444_context.h"
+#include "rfc5444/rfc5444_reader.h"
+#include "rfc5444/rfc5444_writer.h"
+#include "cunit/cunit.h"
+
+#define MSG_TYPE 1
+
+enum {
+  MAX_ADDRESSES = 400,
+};
+
+static void write_packet(struct rfc5444_writer *,
+    struct rfc5444_writer_target *, void *, size_t);
+static void addAddresses(struct rfc5444_writer *wr);
+static enum rfc5444_result cb_addr(struct rfc5444_reader_tlvblock_context *context);
+
+static uint8_t msg_buffer[1000];
+static uint8_t msg_addrtlvs[8192];
+
+static struct rfc5444_writer writer = {
+  .msg_buffer = msg_buffer,
+  .msg_size = sizeof(msg_buffer),
+  .addrtlv_buffer = msg_addrtlvs,
+  .addrtlv_size = sizeof(msg_addrtlvs),
+};
+
+static struct rfc5444_writer_content_provider cpr = {
+  .msg_type = MSG_TYPE,
+  .addAddresses = addAddresses,
+};
+
+static struct rfc5444_writer_tlvtype addrtlvs[] = {
+  { .type = 1 },
+  { .type = 2, .exttype = 1 },
+};
+
+static uint8_t packet_buffer_if[1000];
+static struct rfc5444_writer_target out_if = {
+  .packet_buffer = packet_buffer_if,
+  .packet_size = sizeof(packet_buffer_if),
+  .sendPacket = write_packet,
+};
+
+static struct rfc5444_reader reader;
+
+static struct rfc5444_reader_tlvblock_consumer addr_consumer = {
+  .msg_id = MSG_TYPE,
+  .addrblock_consumer = true,
+  .start_callback = cb_addr,
+};
+
+static struct netaddr addresses[MAX_ADDRESSES];
+static int address_count;
+
+static uint8_t output[16384];
+static size_t output_size;
+static int parsed, parse_errors;
+
+static void addAddresses(struct rfc5444_writer *wr) {
+  struct rfc5444_writer_address *addr;
+  const uint8_t *bin;
+  uint8_t type, metric[2];
+  int i;
+
+  for (i=0; i<address_count; i++) {
+    addr = rfc5444_writer_add_address(wr, cpr.creator, &addresses[i], false);
+
+    bin = netaddr_get_binptr(&addresses[i]);
+    type = bin[1] & 1;
+    metric[0] = 0x10;
+    metric[1] = bin[netaddr_get_binlength(&addresses[i]) - 1] & 7;
+
+    rfc5444_writer_add_addrtlv(wr, addr, &addrtlvs[0], &type, sizeof(type), false);
+    rfc5444_writer_add_addrtlv(wr, addr, &addrtlvs[1], metric, sizeof(metric), false);
+  }
+}
+
+static void write_packet(struct rfc5444_writer *w __attribute__ ((unused)),
+    struct rfc5444_writer_target *iface __attribute__ ((unused)),
+    void *buffer, size_t length) {
+  if (output_size + length <= sizeof(output)) {
+    memcpy(&output[output_size], buffer, length);
+  }
+  output_size += length;
+
+  if (rfc5444_reader_handle_packet(&reader, buffer, length)) {
+    parse_errors++;
+  }
+}
+
+static enum rfc5444_result cb_addr(struct rfc5444_reader_tlvblock_context *context __attribute__ ((unused))) {
+  parsed++;
+  return RFC5444_OKAY;
+}
+
+static void clear_elements(void) {
+  output_size = 0;
+  parsed = 0;
+  parse_errors = 0;
+}
+
+static int compare_addresses(const void *p1, const void *p2) {
+  return memcmp(p1, p2, sizeof(struct netaddr));
+}
+
+static void generate_addresses(int count, int af_type, bool sorted) {
+  uint8_t bin[16];
+  int i, j, len;
+
+  len = af_type == AF_INET ? 4 : 16;
+  for (i=0; i<count; i++) {
+    /* use a permutation of the index to get unsorted addresses */
+    j = (i * 37) % count;
+
+    memset(bin, 0, sizeof(bin));
+    bin[0] = 10;
+    bin[1] = j % 5;
+    bin[len-2] = j / 200;
+    bin[len-1] = j % 200;
+
+    netaddr_from_binary(&addresses[i], bin, len, af_type);
+  }
+  address_count = count;
+
+  if (sorted) {
+    qsort(addresses, count, sizeof(struct netaddr), compare_addresses);
+  }
+}
+
+static void generate_message(int af_type, bool sorted_compression) {
+  enum rfc5444_result result;
+
+  writer.sorted_addr_compression = sorted_compression;
+  result = rfc5444_writer_create_message_alltarget(&writer, MSG_TYPE,
+      af_type == AF_INET ? 4 : 16);
+  CHECK_TRUE(result == RFC5444_OKAY, "create_message should return 0: %s (%d)",
+      rfc5444_strerror(result), result);
+  rfc5444_writer_flush(&writer, &out_if, false);
+}
+
+static void test_sorted_identical(int count, int af_type) {
+  uint8_t presorted[sizeof(output)];
+  size_t presorted_size;
+  START_TEST();
+
+  /* default compression with sorted input */
+  generate_addresses(count, af_type, true);
+  generate_message(af_type, false);
+
+  CHECK_TRUE(output_size <= sizeof(output), "output too large: %zu", output_size);
+  memcpy(presorted, output, output_size);
+  presorted_size = output_size;
+
+  /* sorted compression with unsorted input */
+  clear_elements();
+  generate_addresses(count, af_type, false);
+  generate_message(af_type, true);
+
+  CHECK_TRUE(presorted_size == output_size,
+      "different output size: %zu != %zu", presorted_size, output_size);
+  CHECK_TRUE(memcmp(presorted, output, presorted_size) == 0,
+      "output of sorted compression is different");
+  CHECK_TRUE(parse_errors == 0, "%d parser errors", parse_errors);
+  CHECK_TRUE(parsed == count, "parsed %d of %d addresses", parsed, count);
+
+  END_TEST();
+}
+
+static void test_sorted_smaller(int count, int af_type) {
+  size_t unsorted_size;
+  START_TEST();
+
+  generate_addresses(count, af_type, false);
+  generate_message(af_type, false);
+  unsorted_size = output_size;
+
+  CHECK_TRUE(parse_errors == 0, "%d parser errors", parse_errors);
+  CHECK_TRUE(parsed == count, "parsed %d of %d addresses", parsed, count);
+
+  clear_elements();
+  generate_message(af_type, true);
+
+  CHECK_TRUE(output_size <= unsorted_size,
+      "sorted output is larger: %zu > %zu", output_size, unsorted_size);
+  CHECK_TRUE(parse_errors == 0, "%d parser errors", parse_errors);
+  CHECK_TRUE(parsed == count, "parsed %d of %d addresses", parsed, count);
+
+  END_TEST();
+}
+
+int main(int argc __attribute__ ((unused)), char **argv __attribute__ ((unused))) {
+  struct rfc5444_writer_message *msg;
+
+  rfc5444_reader_init(&reader);
+  rfc5444_reader_add_message_consumer(&reader, &addr_consumer, NULL, 0);
+
+  rfc5444_writer_init(&writer);
+  rfc5444_writer_register_target(&writer, &out_if);
+  msg = rfc5444_writer_register_message(&writer, MSG_TYPE, false);
+  rfc5444_writer_register_msgcontentprovider(&writer, &cpr, addrtlvs, ARRAYSIZE(addrtlvs));
+
+  BEGIN_TESTING(clear_elements);
+
+  test_sorted_identical(20, AF_INET);
+  test_sorted_identical(300, AF_INET);
+  test_sorted_identical(20, AF_INET6);
+  test_sorted_identical(300, AF_INET6);
+
+  test_sorted_smaller(20, AF_INET);
+  test_sorted_smaller(300, AF_INET);
+  test_sorted_smaller(100, AF_INET6);
+  test_sorted_smaller(300, AF_INET6);
+
+  rfc5444_writer_unregister_content_provider(&writer, &cpr, addrtlvs, ARRAYSIZE(addrtlvs));
+  rfc5444_writer_unregister_message(&writer, msg);
+  rfc5444_writer_cleanup(&writer);
+
+  rfc5444_reader_remove_message_consumer(&reader, &addr_consumer);
+  rfc5444_reader_cleanup(&reader);
+
+  return FINISH_TESTING();
+}
@@ -0,0 +1,115 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#include <stdio.h>
+
+#include "common/avl.h"
+#include "common/common_types.h"
+#include "core/oonf_subsystem.h"
+
+#include "subsystem_helper.h"
+
+/*! maximum number of subsystems a test can initialize */
+#define MAX_SUBSYSTEMS 32
+
+static struct oonf_subsystem *_initialized[MAX_SUBSYSTEMS];
+static size_t _initialized_count;
+
+/**
+ * Initialize a subsystem and all its dependencies without
+ * loading a configuration. The subsystem must be linked into
+ * the test or included into its source.
+ * @param name name of subsystem
+ * @return -1 if an error happened, 0 otherwise
+ */
+int
+subsystem_helper_init(const char *name) {
+  struct oonf_subsystem *subsystem;
+  size_t i;
+
+  subsystem = avl_find_element(&oonf_plugin_tree, name, subsystem, _node);
+  if (subsystem == NULL) {
+    printf("Subsystem '%s' is not linked into the test\n", name);
+    return -1;
+  }
+  if (subsystem->_initialized) {
+    return 0;
+  }
+
+  for (i = 0; i < subsystem->dependencies_count; i++) {
+    if (subsystem_helper_init(subsystem->dependencies[i])) {
+      return -1;
+    }
+  }
+
+  if (_initialized_count == MAX_SUBSYSTEMS) {
+    printf("Too many subsystems\n");
+    return -1;
+  }
+  if (subsystem->init != NULL && subsystem->init()) {
+    printf("Could not initialize subsystem '%s'\n", name);
+    return -1;
+  }
+
+  subsystem->_initialized = true;
+  _initialized[_initialized_count++] = subsystem;
+  return 0;
+}
+
+/**
+ * Cleanup all subsystems initialized by the helper in reverse order
+ */
+void
+subsystem_helper_cleanup(void) {
+  struct oonf_subsystem *subsystem;
+
+  while (_initialized_count > 0) {
+    subsystem = _initialized[--_initialized_count];
+    if (subsystem->cleanup != NULL) {
+      subsystem->cleanup();
+    }
+    subsystem->_initialized = false;
+  }
+}
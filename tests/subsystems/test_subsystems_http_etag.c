@@ -0,0 +1,275 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "common/autobuf.h"
+#include "common/netaddr.h"
+#include "core/oonf_appdata.h"
+#include "core/oonf_logging.h"
+#include "cunit/cunit.h"
+#include "subsystems/subsystem_helper.h"
+
+/* include the subsystem to test the http to telnet bridge */
+#include "subsystems/oonf_http.c"
+
+static enum oonf_telnet_result _cb_handle_gen(struct oonf_telnet_data *data);
+static uint64_t _cb_get_generation(struct oonf_telnet_data *data);
+static enum oonf_telnet_result _cb_handle_nocache(struct oonf_telnet_data *data);
+
+static struct oonf_appdata _appdata = {
+  .app_name = "test",
+};
+
+static struct oonf_telnet_command _test_cmds[] = {
+  TELNET_CMD("gen", _cb_handle_gen, "", .cb_get_generation = _cb_get_generation),
+  TELNET_CMD("gen2", _cb_handle_gen, "", .cb_get_generation = _cb_get_generation),
+  TELNET_CMD("nocache", _cb_handle_nocache, ""),
+};
+
+static struct oonf_stream_session _session;
+static uint64_t _generation;
+static int _handler_calls;
+
+static enum oonf_telnet_result
+_cb_handle_gen(struct oonf_telnet_data *data) {
+  _handler_calls++;
+  abuf_appendf(data->out, "%s %" PRIu64 "\n", data->command, _generation);
+  return TELNET_RESULT_ACTIVE;
+}
+
+static uint64_t
+_cb_get_generation(struct oonf_telnet_data *data __attribute__((unused))) {
+  return _generation;
+}
+
+static enum oonf_telnet_result
+_cb_handle_nocache(struct oonf_telnet_data *data) {
+  _handler_calls++;
+  abuf_puts(data->out, "nocache\n");
+  return TELNET_RESULT_ACTIVE;
+}
+
+/**
+ * Send a http request through the http subsystem
+ * @param uri request uri
+ * @param if_none_match value of If-None-Match header, NULL if not set
+ * @return http status code of the response
+ */
+static int
+_request(const char *uri, const char *if_none_match) {
+  abuf_clear(&_session.in);
+  abuf_clear(&_session.out);
+
+  abuf_appendf(&_session.in, "GET %s HTTP/1.1\r\n", uri);
+  if (if_none_match) {
+    abuf_appendf(&_session.in, "%s: %s\r\n", HTTP_IF_NONE_MATCH, if_none_match);
+  }
+  abuf_puts(&_session.in, "\r\n");
+
+  _cb_receive_data(&_session);
+  return atoi(abuf_getptr(&_session.out) + sizeof(HTTP_VERSION_1_0));
+}
+
+/**
+ * @param etag buffer for the entity tag of the last response
+ * @param size size of buffer
+ * @return true if the last response contains an entity tag
+ */
+static bool
+_get_etag(char *etag, size_t size) {
+  const char *ptr, *end;
+
+  ptr = strstr(abuf_getptr(&_session.out), "ETag: ");
+  if (ptr == NULL) {
+    etag[0] = 0;
+    return false;
+  }
+  ptr += 6;
+  end = strstr(ptr, "\r\n");
+  if (end == NULL || (size_t)(end - ptr) >= size) {
+    etag[0] = 0;
+    return false;
+  }
+  memcpy(etag, ptr, end - ptr);
+  etag[end - ptr] = 0;
+  return true;
+}
+
+/**
+ * @return body of the last response
+ */
+static const char *
+_get_body(void) {
+  const char *ptr;
+
+  ptr = strstr(abuf_getptr(&_session.out), "\r\n\r\n");
+  return ptr == NULL ? "" : ptr + 4;
+}
+
+static void
+clear_elements(void) {
+  _generation = 1;
+  _handler_calls = 0;
+}
+
+static void
+test_etag_not_modified(void) {
+  char etag[64], etag2[64], list[128];
+  int code;
+
+  START_TEST();
+
+  code = _request("/telnet/gen", NULL);
+  CHECK_TRUE(code == 200, "first request returned %d", code);
+  CHECK_TRUE(strcmp(_get_body(), "gen 1\n") == 0, "wrong body: '%s'", _get_body());
+  CHECK_TRUE(_get_etag(etag, sizeof(etag)), "no entity tag in response");
+
+  /* client has current content */
+  code = _request("/telnet/gen", etag);
+  CHECK_TRUE(code == 304, "request with current entity tag returned %d", code);
+  CHECK_TRUE(*_get_body() == 0, "304 response has body: '%s'", _get_body());
+  CHECK_TRUE(_get_etag(etag2, sizeof(etag2)) && strcmp(etag, etag2) == 0,
+      "304 response has entity tag '%s' instead of '%s'", etag2, etag);
+  CHECK_TRUE(strstr(abuf_getptr(&_session.out), "Content-length") == NULL,
+      "304 response has content length");
+
+  /* list of entity tags and wildcard */
+  snprintf(list, sizeof(list), "\"other\", %s", etag);
+  code = _request("/telnet/gen", list);
+  CHECK_TRUE(code == 304, "request with list of entity tags returned %d", code);
+  code = _request("/telnet/gen", "*");
+  CHECK_TRUE(code == 304, "request with wildcard returned %d", code);
+
+  /* unknown entity tag */
+  code = _request("/telnet/gen", "\"other\"");
+  CHECK_TRUE(code == 200, "request with unknown entity tag returned %d", code);
+
+  /* data has changed */
+  _generation++;
+  code = _request("/telnet/gen", etag);
+  CHECK_TRUE(code == 200, "request with outdated entity tag returned %d", code);
+  CHECK_TRUE(strcmp(_get_body(), "gen 2\n") == 0, "wrong body: '%s'", _get_body());
+  CHECK_TRUE(_get_etag(etag2, sizeof(etag2)) && strcmp(etag, etag2) != 0,
+      "entity tag did not change: '%s'", etag2);
+
+  code = _request("/telnet/gen", etag2);
+  CHECK_TRUE(code == 304, "request with new entity tag returned %d", code);
+
+  END_TEST();
+}
+
+static void
+test_etag_matches_telnet(void) {
+  struct autobuf out;
+  char etag[64];
+  int code;
+
+  START_TEST();
+
+  abuf_init(&out);
+
+  /* body of the bridge is the output of the telnet commands */
+  code = _request("/telnet/gen/gen2", NULL);
+  CHECK_TRUE(code == 200, "request returned %d", code);
+  oonf_telnet_execute("gen", "", &out, NULL);
+  oonf_telnet_execute("gen2", "", &out, NULL);
+  CHECK_TRUE(strcmp(_get_body(), abuf_getptr(&out)) == 0,
+      "body '%s' differs from telnet output '%s'", _get_body(), abuf_getptr(&out));
+
+  CHECK_TRUE(_get_etag(etag, sizeof(etag)), "no entity tag for two cacheable commands");
+  code = _request("/telnet/gen/gen2", etag);
+  CHECK_TRUE(code == 304, "request with current entity tag returned %d", code);
+
+  /* one command without generation, no entity tag */
+  code = _request("/telnet/gen/nocache", NULL);
+  CHECK_TRUE(code == 200, "request returned %d", code);
+  CHECK_TRUE(!_get_etag(etag, sizeof(etag)), "entity tag for uncacheable command");
+
+  code = _request("/telnet/gen/nocache", "*");
+  CHECK_TRUE(code == 200, "uncacheable request with wildcard returned %d", code);
+  CHECK_TRUE(strcmp(_get_body(), "gen 1\nnocache\n") == 0, "wrong body: '%s'", _get_body());
+
+  abuf_free(&out);
+  END_TEST();
+}
+
+int
+main(int argc __attribute__ ((unused)), char **argv __attribute__ ((unused))) {
+  size_t i;
+  int result;
+
+  if (oonf_log_init(&_appdata, LOG_SEVERITY_WARN)
+      || subsystem_helper_init(OONF_HTTP_SUBSYSTEM)) {
+    return 1;
+  }
+  for (i = 0; i < ARRAYSIZE(_test_cmds); i++) {
+    oonf_telnet_add(&_test_cmds[i]);
+  }
+
+  if (abuf_init(&_session.in) || abuf_init(&_session.out)
+      || netaddr_from_string(&_session.remote_address, "127.0.0.1")) {
+    return 1;
+  }
+
+  BEGIN_TESTING(clear_elements);
+
+  test_etag_not_modified();
+  test_etag_matches_telnet();
+
+  result = FINISH_TESTING();
+
+  abuf_free(&_session.in);
+  abuf_free(&_session.out);
+
+  for (i = 0; i < ARRAYSIZE(_test_cmds); i++) {
+    oonf_telnet_remove(&_test_cmds[i]);
+  }
+  subsystem_helper_cleanup();
+  oonf_log_cleanup();
+  return result;
+}
@@ -0,0 +1,384 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <net/if.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+
+#include "core/oonf_appdata.h"
+#include "core/oonf_logging.h"
+#include "cunit/cunit.h"
+#include "subsystems/subsystem_helper.h"
+
+/* include the subsystem to feed netlink messages into its parsers */
+#include "subsystems/os_linux/os_interface_linux.c"
+
+#define TEST_IF_COUNT 2
+
+/* interface listener that records its callbacks */
+struct _listener {
+  struct os_interface_listener l;
+
+  int calls;
+  uint32_t changes;
+  uint32_t folded_events;
+};
+
+static int _cb_if_changed(struct os_interface_listener *);
+
+static struct oonf_appdata _appdata = {
+  .app_name = "test",
+};
+
+/* the interfaces are not known to the kernel, the messages are parsed directly */
+static struct _listener _listeners[TEST_IF_COUNT] = {
+  { .l = { .name = "oonftest0", .if_changed = _cb_if_changed } },
+  { .l = { .name = "oonftest1", .if_changed = _cb_if_changed } },
+};
+static struct _listener _any = {
+  .l = { .if_changed = _cb_if_changed },
+};
+
+/* netlink message buffer, larger than any message to keep the parser in bounds */
+static uint8_t _buffer[256];
+
+static int
+_cb_if_changed(struct os_interface_listener *l) {
+  struct _listener *listener;
+
+  listener = container_of(l, struct _listener, l);
+  listener->calls++;
+  listener->changes = l->changes;
+  listener->folded_events = l->folded_events;
+  return 0;
+}
+
+/**
+ * Append a netlink attribute to a message
+ * @param msg netlink message
+ * @param type attribute type
+ * @param data attribute data
+ * @param len length of attribute data
+ */
+static void
+_add_attribute(struct nlmsghdr *msg, unsigned short type, const void *data, size_t len) {
+  struct rtattr *rta;
+
+  rta = (struct rtattr *)(((uint8_t *)msg) + NLMSG_ALIGN(msg->nlmsg_len));
+  rta->rta_type = type;
+  rta->rta_len = RTA_LENGTH(len);
+  memcpy(RTA_DATA(rta), data, len);
+  msg->nlmsg_len = NLMSG_ALIGN(msg->nlmsg_len) + RTA_ALIGN(rta->rta_len);
+}
+
+/**
+ * Feed a RTM_NEWLINK message into the link parser
+ * @param idx index of test interface
+ * @param if_index kernel interface index
+ * @param flags interface flags
+ * @param mac last byte of the MAC address
+ */
+static void
+_send_link(int idx, int if_index, unsigned flags, uint8_t mac) {
+  const uint8_t mac_addr[6] = { 0x02, 0, 0, 0, (uint8_t)idx, mac };
+  struct nlmsghdr *msg;
+  struct ifinfomsg *ifi;
+
+  memset(_buffer, 0, sizeof(_buffer));
+  msg = (struct nlmsghdr *)_buffer;
+  msg->nlmsg_len = NLMSG_LENGTH(sizeof(*ifi));
+  msg->nlmsg_type = RTM_NEWLINK;
+
+  ifi = NLMSG_DATA(msg);
+  ifi->ifi_family = AF_UNSPEC;
+  ifi->ifi_index = if_index;
+  ifi->ifi_flags = flags;
+
+  _add_attribute(msg, IFLA_ADDRESS, mac_addr, sizeof(mac_addr));
+  _add_attribute(msg, IFLA_IFNAME, _listeners[idx].l.name, strlen(_listeners[idx].l.name) + 1);
+
+  _link_parse_nlmsg(_listeners[idx].l.name, msg);
+}
+
+/**
+ * Feed a RTM_NEWADDR or RTM_DELADDR message into the address parser
+ * @param idx index of test interface
+ * @param type netlink message type
+ * @param host last byte of the IPv4 address
+ */
+static void
+_send_address(int idx, uint16_t type, uint8_t host) {
+  const uint8_t addr[4] = { 10, 0, (uint8_t)idx, host };
+  struct nlmsghdr *msg;
+  struct ifaddrmsg *ifa;
+
+  memset(_buffer, 0, sizeof(_buffer));
+  msg = (struct nlmsghdr *)_buffer;
+  msg->nlmsg_len = NLMSG_LENGTH(sizeof(*ifa));
+  msg->nlmsg_type = type;
+
+  ifa = NLMSG_DATA(msg);
+  ifa->ifa_family = AF_INET;
+  ifa->ifa_prefixlen = 24;
+  ifa->ifa_index = idx + 100;
+
+  /* attribute order of the kernel, the label is the last one */
+  _add_attribute(msg, IFA_ADDRESS, addr, sizeof(addr));
+  _add_attribute(msg, IFA_LOCAL, addr, sizeof(addr));
+  _add_attribute(msg, IFA_LABEL, _listeners[idx].l.name, strlen(_listeners[idx].l.name) + 1);
+
+  _address_parse_nlmsg(_listeners[idx].l.name, msg);
+}
+
+/**
+ * Fire the change timer of an interface if it is running
+ * @param os_if network interface
+ */
+static void
+_fire_change_timer(struct os_interface *os_if) {
+  if (oonf_timer_is_active(&os_if->_change_timer)) {
+    oonf_timer_stop(&os_if->_change_timer);
+    _cb_delayed_interface_changed(&os_if->_change_timer);
+  }
+}
+
+/**
+ * Fire the change timers of all interfaces, the test interfaces first
+ */
+static void
+_fire_change_timers(void) {
+  int i;
+
+  for (i = 0; i < TEST_IF_COUNT; i++) {
+    _fire_change_timer(_listeners[i].l.data);
+  }
+  _fire_change_timer(_any.l.data);
+}
+
+static void
+_reset_listener(struct _listener *listener) {
+  listener->calls = 0;
+  listener->changes = 0;
+  listener->folded_events = 0;
+}
+
+static void
+clear_elements(void) {
+  int i;
+
+  for (i = 0; i < TEST_IF_COUNT; i++) {
+    _reset_listener(&_listeners[i]);
+  }
+  _reset_listener(&_any);
+}
+
+/**
+ * Check that a listener was called once with the expected changes
+ */
+static void
+_check_listener(struct _listener *listener, const char *name,
+    uint32_t changes, uint32_t folded_events) {
+  CHECK_TRUE(listener->calls == 1, "%s: %d callbacks", name, listener->calls);
+  CHECK_TRUE(listener->changes == changes, "%s: changes 0x%x instead of 0x%x",
+      name, listener->changes, changes);
+  CHECK_TRUE(listener->folded_events == folded_events, "%s: %u folded events instead of %u",
+      name, listener->folded_events, folded_events);
+
+  /* the state is reset after the callback */
+  CHECK_TRUE(!listener->l._dirty && listener->l.changes == 0 && listener->l.folded_events == 0,
+      "%s: listener not reset (dirty=%d changes=0x%x folded=%u)", name,
+      listener->l._dirty, listener->l.changes, listener->l.folded_events);
+}
+
+static void
+test_initial_burst(void) {
+  int i;
+
+  START_TEST();
+
+  for (i = 0; i < TEST_IF_COUNT; i++) {
+    _send_link(i, i + 100, IFF_UP | IFF_MULTICAST, 1);
+    _send_link(i, i + 100, IFF_UP | IFF_MULTICAST, 1);
+    _send_address(i, RTM_NEWADDR, 1);
+    _send_address(i, RTM_NEWADDR, 1);
+  }
+
+  /* the first link and address message initialize the interface */
+  for (i = 0; i < TEST_IF_COUNT; i++) {
+    CHECK_TRUE(_listeners[i].l.data->_folded_events == 2,
+        "%s: interface folded %u events", _listeners[i].l.name,
+        _listeners[i].l.data->_folded_events);
+  }
+  CHECK_TRUE(_any.l.data->_folded_events == 2 * TEST_IF_COUNT,
+      "any: interface folded %u events", _any.l.data->_folded_events);
+
+  _fire_change_timers();
+
+  /* os_interface_add() marks all data as changed */
+  for (i = 0; i < TEST_IF_COUNT; i++) {
+    _check_listener(&_listeners[i], _listeners[i].l.name, OS_INTERFACE_CHANGE_ALL, 2);
+  }
+  _check_listener(&_any, "any", OS_INTERFACE_CHANGE_ALL, 2 * TEST_IF_COUNT);
+
+  END_TEST();
+}
+
+static void
+test_change_burst(void) {
+  START_TEST();
+
+  /* interface 0: flags, MAC and a new address, mixed with messages without changes */
+  _send_link(0, 100, IFF_UP | IFF_MULTICAST, 1);
+  _send_link(0, 100, IFF_UP | IFF_MULTICAST | IFF_PROMISC, 1);
+  _send_link(0, 100, IFF_UP | IFF_MULTICAST | IFF_PROMISC, 1);
+  _send_address(0, RTM_NEWADDR, 1);
+  _send_link(0, 100, IFF_UP | IFF_MULTICAST | IFF_PROMISC, 2);
+  _send_address(0, RTM_NEWADDR, 2);
+  _send_address(0, RTM_NEWADDR, 2);
+  _send_link(0, 100, IFF_UP | IFF_MULTICAST | IFF_PROMISC, 2);
+
+  /* interface 1: new index and a removed address, plus an unknown address */
+  _send_link(1, 111, IFF_UP | IFF_MULTICAST, 1);
+  _send_address(1, RTM_DELADDR, 7);
+  _send_address(1, RTM_DELADDR, 1);
+  _send_link(1, 111, IFF_UP | IFF_MULTICAST, 1);
+
+  CHECK_TRUE(_listeners[0].l.data->_folded_events == 3,
+      "%s: interface folded %u events", _listeners[0].l.name,
+      _listeners[0].l.data->_folded_events);
+  CHECK_TRUE(_listeners[1].l.data->_folded_events == 2,
+      "%s: interface folded %u events", _listeners[1].l.name,
+      _listeners[1].l.data->_folded_events);
+  CHECK_TRUE(_any.l.data->_folded_events == 5,
+      "any: interface folded %u events", _any.l.data->_folded_events);
+
+  _fire_change_timers();
+
+  _check_listener(&_listeners[0], _listeners[0].l.name,
+      OS_INTERFACE_CHANGE_FLAGS | OS_INTERFACE_CHANGE_MAC | OS_INTERFACE_CHANGE_ADDRESS, 3);
+  _check_listener(&_listeners[1], _listeners[1].l.name,
+      OS_INTERFACE_CHANGE_INDEX | OS_INTERFACE_CHANGE_ADDRESS, 2);
+  _check_listener(&_any, "any",
+      OS_INTERFACE_CHANGE_ALL, 5);
+
+  CHECK_TRUE(_listeners[0].l.data->_folded_events == 0,
+      "%s: interface folded events not reset", _listeners[0].l.name);
+
+  END_TEST();
+}
+
+static void
+test_burst_without_changes(void) {
+  int i;
+
+  START_TEST();
+
+  for (i = 0; i < 10; i++) {
+    _send_link(0, 100, IFF_UP | IFF_MULTICAST | IFF_PROMISC, 2);
+    _send_address(0, RTM_NEWADDR, 2);
+    _send_link(1, 111, IFF_UP | IFF_MULTICAST, 1);
+    _send_address(1, RTM_DELADDR, 1);
+  }
+
+  /* no event reaches the listeners or starts a change timer */
+  for (i = 0; i < TEST_IF_COUNT; i++) {
+    CHECK_TRUE(!oonf_timer_is_active(&_listeners[i].l.data->_change_timer),
+        "%s: change timer started", _listeners[i].l.name);
+    CHECK_TRUE(!_listeners[i].l._dirty, "%s: listener is dirty", _listeners[i].l.name);
+    CHECK_TRUE(_listeners[i].l.data->_folded_events == 0,
+        "%s: interface folded %u events", _listeners[i].l.name,
+        _listeners[i].l.data->_folded_events);
+  }
+  CHECK_TRUE(!oonf_timer_is_active(&_any.l.data->_change_timer), "any: change timer started");
+
+  _fire_change_timers();
+
+  for (i = 0; i < TEST_IF_COUNT; i++) {
+    CHECK_TRUE(_listeners[i].calls == 0, "%s: %d callbacks",
+        _listeners[i].l.name, _listeners[i].calls);
+  }
+  CHECK_TRUE(_any.calls == 0, "any: %d callbacks", _any.calls);
+
+  END_TEST();
+}
+
+int
+main(int argc __attribute__ ((unused)), char **argv __attribute__ ((unused))) {
+  int i, result;
+
+  if (oonf_log_init(&_appdata, LOG_SEVERITY_WARN)
+      || subsystem_helper_init(OONF_OS_INTERFACE_SUBSYSTEM)) {
+    return 1;
+  }
+
+  for (i = 0; i < TEST_IF_COUNT; i++) {
+    if (!os_interface_add(&_listeners[i].l)) {
+      return 1;
+    }
+  }
+  if (!os_interface_add(&_any.l)) {
+    return 1;
+  }
+
+  BEGIN_TESTING(clear_elements);
+
+  test_initial_burst();
+  test_change_burst();
+  test_burst_without_changes();
+
+  result = FINISH_TESTING();
+
+  for (i = 0; i < TEST_IF_COUNT; i++) {
+    os_interface_remove(&_listeners[i].l);
+  }
+  os_interface_remove(&_any.l);
+
+  subsystem_helper_cleanup();
+  oonf_log_cleanup();
+  return result;
+}
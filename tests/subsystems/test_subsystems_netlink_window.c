@@ -0,0 +1,547 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <sys/socket.h>
+
+#include "core/oonf_appdata.h"
+#include "core/oonf_logging.h"
+#include "cunit/cunit.h"
+#include "subsystems/subsystem_helper.h"
+
+/* include the subsystem to test its netlink transmission window */
+#include "subsystems/os_linux/os_system_linux.c"
+
+#define MESSAGE_COUNT 3000
+#define MAX_ROUNDS    100000
+
+/*! error the simulated kernel reports for some of the messages */
+#define TEST_ERROR    EEXIST
+
+/*! send buffer size for the tests with a small send buffer */
+#define TEST_SEND_BUFFER 8192
+
+/* result of one run of all messages through the netlink handler */
+struct _run_result {
+  /* message indices in the order the kernel received them */
+  int received[MESSAGE_COUNT];
+  uint32_t received_count;
+
+  /* message indices and errors in the order of the callbacks */
+  int feedback[MESSAGE_COUNT];
+  int feedback_error[MESSAGE_COUNT];
+  uint32_t feedback_count;
+
+  /* number of calls of the socket handler */
+  uint32_t rounds;
+
+  /* largest datagram received by the kernel */
+  size_t max_received;
+
+  /* datagram size limit of the handler at the end of the run */
+  size_t max_datagram;
+
+  struct os_system_netlink_statistics stats;
+};
+
+static void _cb_done(uint32_t seq);
+static void _cb_error(uint32_t seq, int error);
+
+static struct oonf_appdata _appdata = {
+  .app_name = "test",
+};
+
+static struct os_system_netlink _netlink;
+static int _kernel_fd;
+static uint32_t _first_seq;
+
+static struct _run_result _single, _pipelined;
+static struct _run_result *_current;
+
+/* send buffer size of the netlink socket, 0 for the default */
+static int _send_buffer;
+
+/* true if the handler reads back the send buffer size */
+static bool _read_send_buffer;
+
+/**
+ * @param index message index
+ * @return true if the simulated kernel rejects the message
+ */
+static bool
+_is_rejected(int index) {
+  return index % 11 == 5;
+}
+
+/**
+ * @param seq netlink sequence number
+ * @return message index of sequence number
+ */
+static int
+_get_index(uint32_t seq) {
+  int index;
+
+  index = (int)(seq - _first_seq);
+  CHECK_TRUE(index >= 0 && index < MESSAGE_COUNT, "unknown sequence number %u", seq);
+  return index;
+}
+
+static void
+_add_feedback(uint32_t seq, int error) {
+  int index;
+
+  index = _get_index(seq);
+  if (_current->feedback_count == MESSAGE_COUNT) {
+    CHECK_TRUE(false, "too many callbacks, seq %u", seq);
+    return;
+  }
+  _current->feedback[_current->feedback_count] = index;
+  _current->feedback_error[_current->feedback_count] = error;
+  _current->feedback_count++;
+}
+
+static void
+_cb_done(uint32_t seq) {
+  _add_feedback(seq, 0);
+}
+
+static void
+_cb_error(uint32_t seq, int error) {
+  _add_feedback(seq, error);
+}
+
+/**
+ * Open a netlink handler that is connected to a local datagram
+ * socket simulating the kernel instead of the real netlink socket
+ * @param window maximum number of buffers in transit
+ */
+static void
+_add_netlink(uint32_t window) {
+  int fds[2];
+
+  memset(&_netlink, 0, sizeof(_netlink));
+  _netlink.name = "test";
+  _netlink.used_by = &_oonf_os_system_subsystem;
+  _netlink.cb_done = _cb_done;
+  _netlink.cb_error = _cb_error;
+
+  if (socketpair(AF_UNIX, SOCK_DGRAM, 0, fds)) {
+    printf("Cannot open socketpair: %s (%d)\n", strerror(errno), errno);
+    exit(1);
+  }
+  _kernel_fd = fds[1];
+
+  if (os_fd_init(&_netlink.socket.fd, fds[0])
+      || abuf_init(&_netlink.out)) {
+    printf("Cannot initialize netlink handler\n");
+    exit(1);
+  }
+
+  if (_send_buffer > 0) {
+    if (setsockopt(fds[0], SOL_SOCKET, SO_SNDBUF, &_send_buffer, sizeof(_send_buffer))) {
+      printf("Cannot set send buffer: %s (%d)\n", strerror(errno), errno);
+      exit(1);
+    }
+    if (_read_send_buffer) {
+      _update_max_datagram(&_netlink);
+    }
+  }
+  abuf_memcpy(&_netlink.out, &_dummy_buffer, sizeof(_dummy_buffer));
+
+  _netlink.in = calloc(1, getpagesize());
+  if (_netlink.in == NULL) {
+    printf("Not enough memory for netlink input buffer\n");
+    exit(1);
+  }
+  _netlink.in_len = getpagesize();
+
+  _netlink.socket.name = "test_netlink";
+  _netlink.socket.process = _netlink_handler;
+  _netlink.socket.drain = true;
+  oonf_socket_add(&_netlink.socket);
+  oonf_socket_set_read(&_netlink.socket, true);
+
+  _netlink.timeout.class = &_netlink_timer;
+
+  list_init_head(&_netlink.buffered);
+  list_init_head(&_netlink.in_transit);
+
+  os_system_linux_netlink_set_window(&_netlink, window);
+}
+
+static void
+_remove_netlink(void) {
+  os_system_linux_netlink_remove(&_netlink);
+  close(_kernel_fd);
+}
+
+/**
+ * Queue a netlink message with a payload size depending on its index
+ * @param index message index
+ */
+static void
+_send_message(uint32_t index) {
+  uint32_t buffer[256];
+  struct nlmsghdr *hdr;
+  uint32_t seq;
+
+  memset(buffer, 0, sizeof(buffer));
+  hdr = (struct nlmsghdr *)buffer;
+  hdr->nlmsg_type = RTM_NEWROUTE;
+  hdr->nlmsg_flags = NLM_F_REQUEST;
+  hdr->nlmsg_len = NLMSG_LENGTH(NLMSG_ALIGN(sizeof(uint32_t) + (index * 97) % 600));
+  *(uint32_t *)NLMSG_DATA(hdr) = index;
+
+  seq = os_system_linux_netlink_send(&_netlink, hdr);
+  if (index == 0) {
+    _first_seq = seq;
+  }
+}
+
+/**
+ * Simulated kernel, acknowledge all messages waiting in the socket
+ * with one answer datagram per received datagram
+ * @return true if the kernel sent an answer
+ */
+static bool
+_kernel_process(void) {
+  static uint8_t in[OS_SYSTEM_NETLINK_MAX_WINDOW * 4096 * 2];
+  static uint8_t out[sizeof(in)];
+  struct nlmsghdr *nh, *ack;
+  struct nlmsgerr *err;
+  size_t out_len;
+  ssize_t len;
+  size_t ulen;
+  bool answered = false;
+  int index;
+
+  while ((len = recv(_kernel_fd, in, sizeof(in), MSG_DONTWAIT)) > 0) {
+    out_len = 0;
+    ulen = (size_t)len;
+    if (ulen > _current->max_received) {
+      _current->max_received = ulen;
+    }
+
+    for (nh = (struct nlmsghdr *)in; NLMSG_OK(nh, ulen); nh = NLMSG_NEXT(nh, ulen)) {
+      if (nh->nlmsg_type == NLMSG_DONE) {
+        /* end of batch, the kernel does not answer it */
+        continue;
+      }
+      CHECK_TRUE((nh->nlmsg_flags & NLM_F_ACK) != 0, "message %u without ack flag", nh->nlmsg_seq);
+
+      index = *(uint32_t *)NLMSG_DATA(nh);
+      if (_current->received_count < MESSAGE_COUNT) {
+        _current->received[_current->received_count++] = index;
+      }
+
+      ack = (struct nlmsghdr *)&out[out_len];
+      memset(ack, 0, NLMSG_SPACE(sizeof(*err)));
+      ack->nlmsg_len = NLMSG_LENGTH(sizeof(*err));
+      ack->nlmsg_type = NLMSG_ERROR;
+      ack->nlmsg_seq = nh->nlmsg_seq;
+
+      err = NLMSG_DATA(ack);
+      err->error = _is_rejected(index) ? -TEST_ERROR : 0;
+      memcpy(&err->msg, nh, sizeof(err->msg));
+
+      out_len += NLMSG_SPACE(sizeof(*err));
+    }
+
+    if (out_len > 0) {
+      CHECK_TRUE(send(_kernel_fd, out, out_len, 0) == (ssize_t)out_len,
+          "Cannot send kernel answer: %s (%d)", strerror(errno), errno);
+      answered = true;
+    }
+  }
+  return answered;
+}
+
+/**
+ * Push all messages through the netlink handler, feeding new messages
+ * while the earlier ones are still in transit
+ * @param result storage for the result of the run
+ * @param window maximum number of buffers in transit
+ */
+static void
+_run(struct _run_result *result, uint32_t window) {
+  uint32_t sent, count;
+  bool answered;
+
+  memset(result, 0, sizeof(*result));
+  _current = result;
+  _add_netlink(window);
+
+  srand(42);
+  sent = 0;
+  answered = false;
+  while (result->rounds < MAX_ROUNDS) {
+    /* add new messages, on average faster than a single buffer drains */
+    if (sent < MESSAGE_COUNT) {
+      count = 1 + (uint32_t)rand() % 60;
+
+      while (count > 0 && sent < MESSAGE_COUNT) {
+        _send_message(sent++);
+        count--;
+      }
+    }
+
+    _netlink.socket.fd.received_events = 0;
+    if (_netlink.socket.fd.wanted_events & EPOLLOUT) {
+      _netlink.socket.fd.received_events |= EPOLLOUT;
+    }
+    if (answered) {
+      _netlink.socket.fd.received_events |= EPOLLIN;
+    }
+    if (_netlink.socket.fd.received_events == 0 && sent == MESSAGE_COUNT) {
+      break;
+    }
+
+    _netlink_handler(&_netlink.socket);
+    answered = _kernel_process();
+    result->rounds++;
+  }
+
+  CHECK_TRUE(list_is_empty(&_netlink.buffered), "buffers left in queue");
+  CHECK_TRUE(list_is_empty(&_netlink.in_transit), "buffers left in transit");
+  CHECK_TRUE(_netlink.buffers_in_transit == 0, "%u buffers in transit", _netlink.buffers_in_transit);
+  CHECK_TRUE(_netlink.msg_in_transit == 0, "%d messages in transit", _netlink.msg_in_transit);
+  CHECK_TRUE(!oonf_timer_is_active(&_netlink.timeout), "feedback timer still active");
+
+  memcpy(&result->stats, &_netlink.stats, sizeof(result->stats));
+  result->max_datagram = _netlink.max_datagram;
+  _remove_netlink();
+}
+
+/**
+ * Check that every message reached the kernel in order and
+ * got exactly one callback with the right result
+ * @param result result of run
+ * @param window maximum number of buffers in transit
+ */
+static void
+_check_run(struct _run_result *result, uint32_t window) {
+  bool seen[MESSAGE_COUNT];
+  uint32_t i;
+  int index;
+
+  CHECK_TRUE(result->rounds < MAX_ROUNDS, "window %u did not finish", window);
+  CHECK_TRUE(result->received_count == MESSAGE_COUNT,
+      "window %u: kernel received %u messages", window, result->received_count);
+  for (i = 0; i < result->received_count; i++) {
+    if (result->received[i] != (int)i) {
+      CHECK_TRUE(false, "window %u: kernel received message %d at position %u",
+          window, result->received[i], i);
+      break;
+    }
+  }
+
+  memset(seen, 0, sizeof(seen));
+  CHECK_TRUE(result->feedback_count == MESSAGE_COUNT,
+      "window %u: %u callbacks", window, result->feedback_count);
+  for (i = 0; i < result->feedback_count; i++) {
+    index = result->feedback[i];
+    CHECK_TRUE(!seen[index], "window %u: message %d reported twice", window, index);
+    seen[index] = true;
+
+    CHECK_TRUE(result->feedback_error[i] == (_is_rejected(index) ? TEST_ERROR : 0),
+        "window %u: message %d reported with error %d", window, index, result->feedback_error[i]);
+  }
+
+  CHECK_TRUE(result->stats.messages_sent == MESSAGE_COUNT,
+      "window %u: %u messages sent", window, result->stats.messages_sent);
+  CHECK_TRUE(result->stats.messages_finished == MESSAGE_COUNT,
+      "window %u: %u messages finished", window, result->stats.messages_finished);
+  CHECK_TRUE(result->stats.send_errors == 0 && result->stats.timeouts == 0,
+      "window %u: %u send errors, %u timeouts", window,
+      result->stats.send_errors, result->stats.timeouts);
+  CHECK_TRUE(result->stats.max_in_transit <= window,
+      "window %u: %u buffers in transit", window, result->stats.max_in_transit);
+}
+
+/**
+ * Check that a run reached the kernel and reported
+ * the same results as the single buffer run
+ * @param result result of run
+ * @param window maximum number of buffers in transit
+ */
+static void
+_compare_to_single(struct _run_result *result, uint32_t window) {
+  size_t i;
+
+  CHECK_TRUE(memcmp(result->received, _single.received, sizeof(_single.received)) == 0,
+      "window %u: kernel received different message order", window);
+  for (i = 0; i < MESSAGE_COUNT; i++) {
+    if (result->feedback[i] != _single.feedback[i]
+        || result->feedback_error[i] != _single.feedback_error[i]) {
+      CHECK_TRUE(false, "window %u: callback %" PRINTF_SIZE_T_SPECIFIER
+          " differs (message %d/%d, error %d/%d)",
+          window, i, result->feedback[i], _single.feedback[i],
+          result->feedback_error[i], _single.feedback_error[i]);
+      break;
+    }
+  }
+}
+
+static void
+clear_elements(void) {
+  _current = NULL;
+  _send_buffer = 0;
+  _read_send_buffer = false;
+}
+
+static void
+test_single_buffer(void) {
+  START_TEST();
+
+  /* previous behavior, only one buffer in transit to the kernel */
+  _run(&_single, 1);
+  _check_run(&_single, 1);
+
+  CHECK_TRUE(_single.stats.max_in_transit == 1,
+      "%u buffers in transit", _single.stats.max_in_transit);
+  CHECK_TRUE(_single.stats.buffers_sent == _single.stats.sendmsg_calls,
+      "%u buffers with %u sendmsg calls", _single.stats.buffers_sent, _single.stats.sendmsg_calls);
+
+  END_TEST();
+}
+
+static void
+test_window_vs_single_buffer(uint32_t window) {
+  START_TEST();
+
+  _run(&_pipelined, window);
+  _check_run(&_pipelined, window);
+
+  /* kernel must see the same messages and handler report the same results */
+  _compare_to_single(&_pipelined, window);
+
+  /* but needs fewer round trips to the kernel */
+  CHECK_TRUE(_pipelined.stats.max_in_transit > 1,
+      "window %u: %u buffers in transit", window, _pipelined.stats.max_in_transit);
+  CHECK_TRUE(_pipelined.rounds < _single.rounds,
+      "window %u: %u rounds, %u with single buffer", window,
+      _pipelined.rounds, _single.rounds);
+
+  END_TEST();
+}
+
+static void
+test_small_send_buffer(void) {
+  START_TEST();
+
+  /* a send buffer much smaller than a full window of buffers */
+  _send_buffer = TEST_SEND_BUFFER;
+  _read_send_buffer = true;
+
+  _run(&_pipelined, OS_SYSTEM_NETLINK_MAX_WINDOW);
+  _check_run(&_pipelined, OS_SYSTEM_NETLINK_MAX_WINDOW);
+  _compare_to_single(&_pipelined, OS_SYSTEM_NETLINK_MAX_WINDOW);
+
+  /* datagrams are capped at the effective send buffer */
+  CHECK_TRUE(_pipelined.max_datagram > 0 && _pipelined.max_datagram < TEST_SEND_BUFFER * 2,
+      "datagram limit is %" PRINTF_SIZE_T_SPECIFIER, _pipelined.max_datagram);
+  CHECK_TRUE(_pipelined.max_received <= _pipelined.max_datagram,
+      "kernel received %" PRINTF_SIZE_T_SPECIFIER " bytes", _pipelined.max_received);
+  CHECK_TRUE(_pipelined.stats.split_batches == 0,
+      "%u split batches", _pipelined.stats.split_batches);
+
+  END_TEST();
+}
+
+static void
+test_oversized_batch(void) {
+  START_TEST();
+
+  /* the handler does not know about the small send buffer */
+  _send_buffer = TEST_SEND_BUFFER;
+  _read_send_buffer = false;
+
+  _run(&_pipelined, OS_SYSTEM_NETLINK_MAX_WINDOW);
+  _check_run(&_pipelined, OS_SYSTEM_NETLINK_MAX_WINDOW);
+  _compare_to_single(&_pipelined, OS_SYSTEM_NETLINK_MAX_WINDOW);
+
+  /* rejected datagrams are split and the limit is remembered */
+  CHECK_TRUE(_pipelined.stats.split_batches > 0, "no split batches");
+  CHECK_TRUE(_pipelined.max_datagram > 0 && _pipelined.max_datagram < TEST_SEND_BUFFER * 2,
+      "datagram limit is %" PRINTF_SIZE_T_SPECIFIER, _pipelined.max_datagram);
+  CHECK_TRUE(_pipelined.stats.split_batches < _pipelined.stats.sendmsg_calls / 2,
+      "%u split batches of %u sendmsg calls",
+      _pipelined.stats.split_batches, _pipelined.stats.sendmsg_calls);
+
+  END_TEST();
+}
+
+int
+main(int argc __attribute__ ((unused)), char **argv __attribute__ ((unused))) {
+  int result;
+
+  if (oonf_log_init(&_appdata, LOG_SEVERITY_WARN)
+      || subsystem_helper_init(OONF_OS_SYSTEM_SUBSYSTEM)) {
+    return 1;
+  }
+
+  /* the simulated kernel is a connected unix socket, not a netlink address */
+  _netlink_send_msg.msg_name = NULL;
+  _netlink_send_msg.msg_namelen = 0;
+  _netlink_rcv_msg.msg_name = NULL;
+  _netlink_rcv_msg.msg_namelen = 0;
+
+  BEGIN_TESTING(clear_elements);
+
+  test_single_buffer();
+  test_window_vs_single_buffer(2);
+  test_window_vs_single_buffer(OS_SYSTEM_NETLINK_WINDOW);
+  test_window_vs_single_buffer(OS_SYSTEM_NETLINK_MAX_WINDOW);
+  test_small_send_buffer();
+  test_oversized_batch();
+
+  result = FINISH_TESTING();
+
+  subsystem_helper_cleanup();
+  oonf_log_cleanup();
+  return result;
+}
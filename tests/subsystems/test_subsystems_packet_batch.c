@@ -0,0 +1,352 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <sys/socket.h>
+
+#include "common/netaddr.h"
+#include "core/oonf_appdata.h"
+#include "core/oonf_logging.h"
+#include "cunit/cunit.h"
+#include "subsystems/subsystem_helper.h"
+
+/* include the subsystem to test its batch receive path */
+#include "subsystems/oonf_packet_socket.c"
+
+#define PACKET_COUNT 2000
+#define MAX_PACKET   1400
+#define BATCH_SIZE   8
+
+/* packets delivered by one packet socket */
+struct _receiver {
+  struct oonf_packet_socket socket;
+
+  /* packet indices in the order of the receive callback */
+  uint32_t packets[PACKET_COUNT];
+  uint32_t count;
+
+  /* remove the socket in the callback after this number of packets, 0 for never */
+  uint32_t remove_after;
+};
+
+static void _cb_receive(struct oonf_packet_socket *psock,
+    union netaddr_socket *from, void *ptr, size_t length);
+
+static struct oonf_appdata _appdata = {
+  .app_name = "test",
+};
+
+static struct _receiver _single, _batched;
+static int _sender = -1;
+static union netaddr_socket _sender_socket;
+
+/**
+ * @param index packet index
+ * @return length of the packet with this index
+ */
+static size_t
+_get_length(uint32_t index) {
+  return sizeof(uint32_t) + (index * 131) % (MAX_PACKET - sizeof(uint32_t));
+}
+
+/**
+ * Check that a received datagram has the expected content and source
+ * and remember its index
+ */
+static void
+_cb_receive(struct oonf_packet_socket *psock,
+    union netaddr_socket *from, void *ptr, size_t length) {
+  struct _receiver *receiver;
+  struct netaddr_str nbuf1, nbuf2;
+  const uint8_t *data = ptr;
+  uint32_t index;
+  size_t i;
+
+  receiver = container_of(psock, struct _receiver, socket);
+
+  CHECK_TRUE(length >= sizeof(index), "packet with %" PRINTF_SIZE_T_SPECIFIER " bytes", length);
+  if (length < sizeof(index)) {
+    return;
+  }
+  memcpy(&index, data, sizeof(index));
+
+  CHECK_TRUE(index < PACKET_COUNT, "unknown packet %u", index);
+  if (index >= PACKET_COUNT) {
+    return;
+  }
+  CHECK_TRUE(length == _get_length(index),
+      "packet %u has %" PRINTF_SIZE_T_SPECIFIER " bytes", index, length);
+  for (i = sizeof(index); i < length; i++) {
+    if (data[i] != (uint8_t)(index + i)) {
+      CHECK_TRUE(false, "packet %u has wrong content at byte %" PRINTF_SIZE_T_SPECIFIER, index, i);
+      break;
+    }
+  }
+  CHECK_TRUE(data[length] == 0, "packet %u not null terminated", index);
+  CHECK_TRUE(memcmp(from, &_sender_socket, sizeof(*from)) == 0,
+      "packet %u from %s instead of %s", index,
+      netaddr_socket_to_string(&nbuf1, from),
+      netaddr_socket_to_string(&nbuf2, &_sender_socket));
+
+  if (receiver->count < PACKET_COUNT) {
+    receiver->packets[receiver->count++] = index;
+  }
+
+  if (receiver->remove_after > 0 && receiver->count == receiver->remove_after) {
+    oonf_packet_remove(psock, true);
+  }
+}
+
+/**
+ * Open a packet socket on a random loopback port
+ * @param receiver receiver to initialize
+ * @param batch_size number of datagrams to read per event
+ */
+static void
+_add_receiver(struct _receiver *receiver, uint32_t batch_size) {
+  union netaddr_socket local;
+  socklen_t len;
+
+  memset(receiver, 0, sizeof(*receiver));
+  receiver->socket.config.receive_data = _cb_receive;
+  receiver->socket.config.batch_size = batch_size;
+
+  netaddr_socket_init(&local, &NETADDR_IPV4_LOOPBACK_NET, 0, 0);
+
+  if (oonf_packet_add(&receiver->socket, &local, NULL)) {
+    printf("Cannot open packet socket\n");
+    exit(1);
+  }
+
+  /* get the random port of the socket */
+  len = sizeof(receiver->socket.local_socket);
+  getsockname(os_fd_get_fd(&receiver->socket.scheduler_entry.fd),
+      &receiver->socket.local_socket.std, &len);
+}
+
+/**
+ * Open the socket sending the test datagrams
+ */
+static void
+_add_sender(void) {
+  socklen_t len;
+  int recvbuf;
+
+  _sender = socket(AF_INET, SOCK_DGRAM, 0);
+  if (_sender == -1) {
+    printf("Cannot open sender socket: %s (%d)\n", strerror(errno), errno);
+    exit(1);
+  }
+
+  netaddr_socket_init(&_sender_socket, &NETADDR_IPV4_LOOPBACK_NET, 0, 0);
+  if (bind(_sender, &_sender_socket.std, sizeof(_sender_socket.v4))) {
+    printf("Cannot bind sender socket: %s (%d)\n", strerror(errno), errno);
+    exit(1);
+  }
+  len = sizeof(_sender_socket);
+  getsockname(_sender, &_sender_socket.std, &len);
+
+  /* keep the receive buffers from dropping packets between two events */
+  recvbuf = 1024*1024;
+  setsockopt(os_fd_get_fd(&_single.socket.scheduler_entry.fd),
+      SOL_SOCKET, SO_RCVBUF, &recvbuf, sizeof(recvbuf));
+  setsockopt(os_fd_get_fd(&_batched.socket.scheduler_entry.fd),
+      SOL_SOCKET, SO_RCVBUF, &recvbuf, sizeof(recvbuf));
+}
+
+/**
+ * Send a test datagram to a receiver
+ * @param receiver target of datagram
+ * @param index packet index
+ */
+static void
+_send_packet(struct _receiver *receiver, uint32_t index) {
+  uint8_t buffer[MAX_PACKET];
+  uint32_t idx = index;
+  size_t i, length;
+
+  length = _get_length(index);
+  memcpy(buffer, &idx, sizeof(idx));
+  for (i = sizeof(idx); i < length; i++) {
+    buffer[i] = (uint8_t)(index + i);
+  }
+
+  CHECK_TRUE(sendto(_sender, buffer, length, 0, &receiver->socket.local_socket.std,
+      sizeof(receiver->socket.local_socket.v4)) == (ssize_t)length,
+      "Cannot send packet %u: %s (%d)", index, strerror(errno), errno);
+}
+
+/**
+ * Trigger a read event of a receiver like the socket scheduler does
+ * @param receiver receiver with waiting data
+ */
+static void
+_read_event(struct _receiver *receiver) {
+  if (!list_is_node_added(&receiver->socket.node)) {
+    return;
+  }
+  receiver->socket.scheduler_entry.fd.received_events = EPOLLIN;
+  receiver->socket.scheduler_entry.process(&receiver->socket.scheduler_entry);
+}
+
+static void
+clear_elements(void) {
+  oonf_packet_remove(&_single.socket, true);
+  oonf_packet_remove(&_batched.socket, true);
+  if (_sender != -1) {
+    close(_sender);
+    _sender = -1;
+  }
+}
+
+static void
+test_batch_vs_single(void) {
+  uint32_t sent, count, i, events;
+
+  START_TEST();
+
+  /* previous behavior with a single recvfrom per event */
+  _add_receiver(&_single, 1);
+  _add_receiver(&_batched, BATCH_SIZE);
+  _add_sender();
+
+  srand(5);
+  sent = 0;
+  events = 0;
+  while (sent < PACKET_COUNT) {
+    /* send a burst of packets to both sockets */
+    count = 1 + (uint32_t)rand() % 20;
+    for (i = 0; i < count && sent < PACKET_COUNT; i++, sent++) {
+      _send_packet(&_single, sent);
+      _send_packet(&_batched, sent);
+    }
+
+    /* handle socket events until the burst has been received */
+    for (events = 0; _single.count < sent && events <= count; events++) {
+      _read_event(&_single);
+    }
+    for (events = 0; _batched.count < sent && events <= count; events++) {
+      _read_event(&_batched);
+    }
+    if (_single.count < sent || _batched.count < sent) {
+      CHECK_TRUE(false, "packets lost (single %u, batched %u, sent %u)",
+          _single.count, _batched.count, sent);
+      break;
+    }
+  }
+
+  CHECK_TRUE(_single.count == PACKET_COUNT, "single socket received %u packets", _single.count);
+  CHECK_TRUE(_batched.count == PACKET_COUNT, "batched socket received %u packets", _batched.count);
+  CHECK_TRUE(memcmp(_single.packets, _batched.packets, sizeof(_single.packets)) == 0,
+      "batched socket received packets in different order");
+  for (i = 0; i < _single.count; i++) {
+    if (_single.packets[i] != i) {
+      CHECK_TRUE(false, "packet %u received at position %u", _single.packets[i], i);
+      break;
+    }
+  }
+
+  /* same packets with fewer socket events */
+  CHECK_TRUE(_single.socket.stats.packets == PACKET_COUNT
+      && _batched.socket.stats.packets == PACKET_COUNT,
+      "statistics show %" PRIu64 "/%" PRIu64 " packets",
+      _single.socket.stats.packets, _batched.socket.stats.packets);
+  CHECK_TRUE(_single.socket.stats.max_batch == 1,
+      "single socket read %u packets per event", _single.socket.stats.max_batch);
+  CHECK_TRUE(_batched.socket.stats.max_batch == BATCH_SIZE,
+      "batched socket read %u packets per event", _batched.socket.stats.max_batch);
+  CHECK_TRUE(_batched.socket.stats.full_batches > 0, "no full batch");
+  CHECK_TRUE(_batched.socket.stats.events < _single.socket.stats.events,
+      "batched socket needed %" PRIu64 " events, single socket %" PRIu64,
+      _batched.socket.stats.events, _single.socket.stats.events);
+
+  END_TEST();
+}
+
+static void
+test_remove_in_callback(void) {
+  uint32_t i;
+
+  START_TEST();
+
+  _add_receiver(&_batched, BATCH_SIZE);
+  _add_sender();
+
+  _batched.remove_after = 3;
+  for (i = 0; i < BATCH_SIZE; i++) {
+    _send_packet(&_batched, i);
+  }
+  _read_event(&_batched);
+
+  /* rest of the batch must not be delivered after the socket is gone */
+  CHECK_TRUE(_batched.count == 3, "%u packets delivered", _batched.count);
+  CHECK_TRUE(!list_is_node_added(&_batched.socket.node), "socket still active");
+  CHECK_TRUE(_batched.socket._batch_buffer == NULL, "batch buffers not freed");
+
+  END_TEST();
+}
+
+int
+main(int argc __attribute__ ((unused)), char **argv __attribute__ ((unused))) {
+  int result;
+
+  if (oonf_log_init(&_appdata, LOG_SEVERITY_WARN)
+      || subsystem_helper_init(OONF_PACKET_SUBSYSTEM)) {
+    return 1;
+  }
+
+  BEGIN_TESTING(clear_elements);
+
+  test_batch_vs_single();
+  test_remove_in_callback();
+
+  result = FINISH_TESTING();
+
+  subsystem_helper_cleanup();
+  oonf_log_cleanup();
+  return result;
+}
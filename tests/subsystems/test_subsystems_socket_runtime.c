@@ -0,0 +1,291 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include "core/oonf_appdata.h"
+#include "core/oonf_logging.h"
+#include "cunit/cunit.h"
+#include "subsystems/subsystem_helper.h"
+
+/* include the subsystem to drive its scheduler directly */
+#include "subsystems/oonf_socket.c"
+
+/* runtime of the scheduler for one test */
+#define SCHEDULER_RUNTIME (OONF_TIMER_SLICE * 2)
+
+/* socket handler with the other end of its socketpair */
+struct _handler {
+  struct oonf_socket_entry socket;
+  int peer;
+
+  /* remove the socket in its callback */
+  bool remove;
+
+  int calls;
+};
+
+static void _cb_process(struct oonf_socket_entry *entry);
+
+static struct oonf_appdata _appdata = {
+  .app_name = "test",
+};
+
+static struct _handler _first = {
+  .socket = {
+    .name = "first",
+    .process = _cb_process,
+  },
+};
+
+static struct _handler _second = {
+  .socket = {
+    .name = "second",
+    .process = _cb_process,
+  },
+};
+
+/**
+ * Consume the pending datagram
+ * @param entry socket entry
+ */
+static void
+_cb_process(struct oonf_socket_entry *entry) {
+  struct _handler *handler;
+  char buffer[16];
+
+  handler = container_of(entry, struct _handler, socket);
+  handler->calls++;
+
+  CHECK_TRUE(recv(os_fd_get_fd(&entry->fd), buffer, sizeof(buffer), 0) == 1,
+      "%s: recv failed: %s (%d)", entry->name, strerror(errno), errno);
+
+  if (handler->remove) {
+    oonf_socket_remove(entry);
+  }
+}
+
+/**
+ * Open a socketpair for a handler and add it to the scheduler
+ * @param handler socket handler
+ */
+static void
+_add_handler(struct _handler *handler) {
+  int fds[2];
+
+  if (socketpair(AF_UNIX, SOCK_DGRAM, 0, fds)) {
+    printf("Cannot open socketpair: %s (%d)\n", strerror(errno), errno);
+    exit(1);
+  }
+
+  os_fd_init(&handler->socket.fd, fds[0]);
+  handler->peer = fds[1];
+  handler->calls = 0;
+
+  memset(&handler->socket._stat_runtime, 0, sizeof(handler->socket._stat_runtime));
+  handler->socket._stat_long = 0;
+
+  oonf_socket_add(&handler->socket);
+  oonf_socket_set_read(&handler->socket, true);
+}
+
+/**
+ * Remove a handler from the scheduler and close its socketpair
+ * @param handler socket handler
+ */
+static void
+_remove_handler(struct _handler *handler) {
+  oonf_socket_remove(&handler->socket);
+  os_fd_close(&handler->socket.fd);
+  close(handler->peer);
+}
+
+/**
+ * Make both sockets readable before the scheduler waits, so both
+ * callbacks are processed in the same event batch, and run the
+ * scheduler until its time limit is reached
+ */
+static void
+_run_batch(void) {
+  CHECK_TRUE(send(_first.peer, "1", 1, 0) == 1, "send to first socket failed");
+  CHECK_TRUE(send(_second.peer, "2", 1, 0) == 1, "send to second socket failed");
+
+  _scheduler_time_limit = oonf_clock_get_absolute(SCHEDULER_RUNTIME);
+  _handle_scheduling();
+  _scheduler_time_limit = ~0ull;
+}
+
+static void
+clear_elements(void) {
+  _first.remove = false;
+}
+
+static void
+test_runtime_per_batch(void) {
+  START_TEST();
+
+  _add_handler(&_first);
+  _add_handler(&_second);
+
+  _run_batch();
+
+  CHECK_TRUE(_first.calls == 1, "first socket called %d times", _first.calls);
+  CHECK_TRUE(_second.calls == 1, "second socket called %d times", _second.calls);
+
+  CHECK_TRUE(_first.socket._stat_runtime.count == 1,
+      "first socket has %" PRIu64 " runtime samples", _first.socket._stat_runtime.count);
+  CHECK_TRUE(_second.socket._stat_runtime.count == 1,
+      "second socket has %" PRIu64 " runtime samples", _second.socket._stat_runtime.count);
+
+  /* both sockets are charged the same batch runtime */
+  CHECK_TRUE(_first.socket._stat_runtime.sum == _second.socket._stat_runtime.sum,
+      "runtime %" PRIu64 " us != %" PRIu64 " us",
+      _first.socket._stat_runtime.sum, _second.socket._stat_runtime.sum);
+  CHECK_TRUE(list_is_empty(&_batch_head), "batch list not empty");
+
+  _remove_handler(&_first);
+  _remove_handler(&_second);
+
+  END_TEST();
+}
+
+static void
+test_remove_in_callback(void) {
+  START_TEST();
+
+  _first.remove = true;
+  _add_handler(&_first);
+  _add_handler(&_second);
+
+  _run_batch();
+
+  CHECK_TRUE(_first.calls == 1, "first socket called %d times", _first.calls);
+  CHECK_TRUE(_second.calls == 1, "second socket called %d times", _second.calls);
+
+  /* the removed socket is not charged */
+  CHECK_TRUE(_first.socket._stat_runtime.count == 0,
+      "removed socket has %" PRIu64 " runtime samples", _first.socket._stat_runtime.count);
+  CHECK_TRUE(_second.socket._stat_runtime.count == 1,
+      "second socket has %" PRIu64 " runtime samples", _second.socket._stat_runtime.count);
+  CHECK_TRUE(list_is_empty(&_batch_head), "batch list not empty");
+
+  _remove_handler(&_first);
+  _remove_handler(&_second);
+
+  END_TEST();
+}
+
+static void
+test_charge_batch(void) {
+  static const uint64_t runtimes[] = {
+    0, 1, 100, OONF_TIMER_SLICE * USEC_PER_MSEC, OONF_TIMER_SLICE * USEC_PER_MSEC + 1,
+  };
+  struct histogram *h;
+  size_t i;
+
+  START_TEST();
+
+  _add_handler(&_first);
+  _add_handler(&_second);
+
+  for (i=0; i<ARRAYSIZE(runtimes); i++) {
+    list_add_tail(&_batch_head, &_first.socket._batch_node);
+    if (i & 1) {
+      list_add_tail(&_batch_head, &_second.socket._batch_node);
+    }
+    _charge_batch(runtimes[i]);
+    CHECK_TRUE(list_is_empty(&_batch_head), "batch list not empty");
+  }
+
+  h = &_first.socket._stat_runtime;
+  CHECK_TRUE(h->count == ARRAYSIZE(runtimes), "%" PRIu64 " runtime samples", h->count);
+  CHECK_TRUE(h->max == OONF_TIMER_SLICE * USEC_PER_MSEC + 1, "maximum runtime %" PRIu64 " us", h->max);
+  CHECK_TRUE(h->sum == 2 * OONF_TIMER_SLICE * USEC_PER_MSEC + 102, "runtime sum %" PRIu64 " us", h->sum);
+  CHECK_TRUE(h->buckets[0] == 1, "%u samples in bucket 0", h->buckets[0]);
+  CHECK_TRUE(h->buckets[1] == 1, "%u samples in bucket 1", h->buckets[1]);
+  CHECK_TRUE(h->buckets[histogram_get_bucket(100)] == 1, "%u samples for 100 us",
+      h->buckets[histogram_get_bucket(100)]);
+
+  /* only the batch longer than a timer slice is a long event */
+  CHECK_TRUE(_first.socket._stat_long == 1, "first socket has %u long events", _first.socket._stat_long);
+
+  /* the second socket was only part of the odd batches */
+  h = &_second.socket._stat_runtime;
+  CHECK_TRUE(h->count == 2, "%" PRIu64 " runtime samples", h->count);
+  CHECK_TRUE(h->sum == OONF_TIMER_SLICE * USEC_PER_MSEC + 1, "runtime sum %" PRIu64 " us", h->sum);
+  CHECK_TRUE(_second.socket._stat_long == 0, "second socket has %u long events", _second.socket._stat_long);
+
+  _remove_handler(&_first);
+  _remove_handler(&_second);
+
+  END_TEST();
+}
+
+int
+main(int argc __attribute__ ((unused)), char **argv __attribute__ ((unused))) {
+  int result;
+
+  if (oonf_log_init(&_appdata, LOG_SEVERITY_WARN)
+      || subsystem_helper_init(OONF_SOCKET_SUBSYSTEM)) {
+    return 1;
+  }
+
+  BEGIN_TESTING(clear_elements);
+
+  test_runtime_per_batch();
+  test_remove_in_callback();
+  test_charge_batch();
+
+  result = FINISH_TESTING();
+
+  subsystem_helper_cleanup();
+  oonf_log_cleanup();
+  return result;
+}
@@ -0,0 +1,219 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "common/autobuf.h"
+#include "cunit/cunit.h"
+
+/* include the subsystem to test its output buffer handling */
+#include "subsystems/oonf_stream_socket.c"
+
+#define DATA_SIZE 100000
+
+static struct oonf_stream_session _session;
+static uint8_t _data[DATA_SIZE];
+static uint8_t _sent[DATA_SIZE];
+static size_t _sent_len;
+
+static void
+clear_elements(void) {
+  abuf_free(&_session.out);
+  memset(&_session, 0, sizeof(_session));
+  if (abuf_init(&_session.out)) {
+    printf("Not enough memory for output buffer\n");
+    exit(1);
+  }
+  _sent_len = 0;
+}
+
+/**
+ * Simulate a partial write of the output buffer to the socket
+ * @param max maximum number of bytes the socket accepts
+ */
+static void
+_send(size_t max) {
+  size_t len;
+
+  len = abuf_getlen(&_session.out) - _session._out_offset;
+  if (len > max) {
+    len = max;
+  }
+  memcpy(&_sent[_sent_len], abuf_getptr(&_session.out) + _session._out_offset, len);
+  _sent_len += len;
+
+  _consume_output(&_session, len);
+}
+
+static void
+test_consume_offset(void) {
+  START_TEST();
+
+  abuf_memcpy(&_session.out, _data, 1000);
+
+  /* small writes only move the offset */
+  _send(300);
+  CHECK_TRUE(_session._out_offset == 300, "offset is %" PRINTF_SIZE_T_SPECIFIER, _session._out_offset);
+  CHECK_TRUE(abuf_getlen(&_session.out) == 1000, "buffer was compacted early");
+
+  /* sent part larger than the rest, buffer is compacted */
+  _send(300);
+  CHECK_TRUE(_session._out_offset == 0, "offset is %" PRINTF_SIZE_T_SPECIFIER, _session._out_offset);
+  CHECK_TRUE(abuf_getlen(&_session.out) == 400, "buffer has %" PRINTF_SIZE_T_SPECIFIER " bytes",
+      abuf_getlen(&_session.out));
+  CHECK_TRUE(memcmp(abuf_getptr(&_session.out), &_data[600], 400) == 0, "wrong data after compaction");
+
+  /* everything sent, buffer is cleared */
+  _send(1000);
+  CHECK_TRUE(_session._out_offset == 0, "offset is %" PRINTF_SIZE_T_SPECIFIER, _session._out_offset);
+  CHECK_TRUE(abuf_getlen(&_session.out) == 0, "buffer not cleared");
+  CHECK_TRUE(_sent_len == 1000 && memcmp(_sent, _data, 1000) == 0, "wrong data sent");
+
+  END_TEST();
+}
+
+static void
+test_compact_before_callback(void) {
+  START_TEST();
+
+  abuf_memcpy(&_session.out, _data, 1000);
+  _send(100);
+
+  /* callbacks see the unsent data at the start of the buffer */
+  _compact_output(&_session);
+  CHECK_TRUE(_session._out_offset == 0, "offset is %" PRINTF_SIZE_T_SPECIFIER, _session._out_offset);
+  CHECK_TRUE(abuf_getlen(&_session.out) == 900, "buffer has %" PRINTF_SIZE_T_SPECIFIER " bytes",
+      abuf_getlen(&_session.out));
+  CHECK_TRUE(memcmp(abuf_getptr(&_session.out), &_data[100], 900) == 0, "wrong data after compaction");
+
+  /* a callback replacing the output (e.g. with an error) must not underflow the send length */
+  _send(100);
+  _compact_output(&_session);
+  abuf_clear(&_session.out);
+  abuf_memcpy(&_session.out, &_data[5000], 10);
+  CHECK_TRUE(abuf_getlen(&_session.out) - _session._out_offset == 10, "wrong send length");
+
+  _send(1000);
+  CHECK_TRUE(_sent_len == 210, "%" PRINTF_SIZE_T_SPECIFIER " bytes sent", _sent_len);
+  CHECK_TRUE(memcmp(&_sent[200], &_data[5000], 10) == 0, "replaced output not sent");
+
+  END_TEST();
+}
+
+static void
+test_partial_writes_vs_pull(void) {
+  struct autobuf old_out;
+  uint8_t old_sent[DATA_SIZE];
+  size_t old_len, appended, len, max;
+
+  START_TEST();
+
+  if (abuf_init(&old_out)) {
+    printf("Not enough memory for output buffer\n");
+    exit(1);
+  }
+  old_len = 0;
+
+  /* interleave appends with partial writes of random size */
+  srand(7);
+  appended = 0;
+  while (appended < DATA_SIZE || abuf_getlen(&old_out) > 0) {
+    if (appended < DATA_SIZE && rand() % 2 == 0) {
+      len = 1 + rand() % 3000;
+      if (len > DATA_SIZE - appended) {
+        len = DATA_SIZE - appended;
+      }
+      abuf_memcpy(&_session.out, &_data[appended], len);
+      abuf_memcpy(&old_out, &_data[appended], len);
+      appended += len;
+    }
+
+    max = 1 + rand() % 2000;
+    _send(max);
+
+    /* previous implementation, pull the sent bytes after each write */
+    len = abuf_getlen(&old_out);
+    if (len > max) {
+      len = max;
+    }
+    memcpy(&old_sent[old_len], abuf_getptr(&old_out), len);
+    old_len += len;
+    abuf_pull(&old_out, len);
+
+    CHECK_TRUE(abuf_getlen(&_session.out) - _session._out_offset == abuf_getlen(&old_out),
+        "pending output differs");
+    CHECK_TRUE(_session._out_offset <= abuf_getlen(&_session.out) / 2 || _session._out_offset == 0,
+        "buffer not compacted (offset %" PRINTF_SIZE_T_SPECIFIER ", length %" PRINTF_SIZE_T_SPECIFIER ")",
+        _session._out_offset, abuf_getlen(&_session.out));
+  }
+
+  CHECK_TRUE(_sent_len == DATA_SIZE, "%" PRINTF_SIZE_T_SPECIFIER " bytes sent", _sent_len);
+  CHECK_TRUE(old_len == DATA_SIZE, "%" PRINTF_SIZE_T_SPECIFIER " bytes sent by old path", old_len);
+  CHECK_TRUE(memcmp(_sent, old_sent, DATA_SIZE) == 0, "sent data differs from old path");
+  CHECK_TRUE(memcmp(_sent, _data, DATA_SIZE) == 0, "sent data differs from input");
+
+  abuf_free(&old_out);
+  END_TEST();
+}
+
+int
+main(int argc __attribute__ ((unused)), char **argv __attribute__ ((unused))) {
+  size_t i;
+
+  for (i = 0; i < DATA_SIZE; i++) {
+    _data[i] = (uint8_t)(i * 7 + i / 251);
+  }
+
+  BEGIN_TESTING(clear_elements);
+
+  test_consume_offset();
+  test_compact_before_callback();
+  test_partial_writes_vs_pull();
+
+  abuf_free(&_session.out);
+  return FINISH_TESTING();
+}
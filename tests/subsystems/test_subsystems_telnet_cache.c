@@ -0,0 +1,356 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "common/autobuf.h"
+#include "core/oonf_appdata.h"
+#include "core/oonf_logging.h"
+#include "cunit/cunit.h"
+#include "subsystems/subsystem_helper.h"
+
+/* include the subsystem to test its output cache */
+#include "subsystems/oonf_telnet.c"
+
+static enum oonf_telnet_result _cb_handle_test(struct oonf_telnet_data *data);
+static enum oonf_telnet_result _cb_handle_chunk(struct oonf_telnet_data *data);
+static uint64_t _cb_get_generation(struct oonf_telnet_data *data);
+
+static struct oonf_appdata _appdata = {
+  .app_name = "test",
+};
+
+static struct oonf_telnet_command _test_cmd =
+    TELNET_CMD("test", _cb_handle_test, "", .cb_get_generation = _cb_get_generation);
+
+static uint64_t _generation;
+static int _handler_calls;
+static int _chunks;
+static size_t _output_size;
+
+static enum oonf_telnet_result
+_cb_handle_test(struct oonf_telnet_data *data) {
+  size_t i;
+
+  _handler_calls++;
+
+  abuf_appendf(data->out, "%s %d %" PRIu64 "\n",
+      data->parameter, _handler_calls, _generation);
+  for (i = 0; i < _output_size; i++) {
+    abuf_puts(data->out, "x");
+  }
+
+  if (_chunks > 0) {
+    data->chunk_handler = _cb_handle_chunk;
+  }
+  return TELNET_RESULT_ACTIVE;
+}
+
+static enum oonf_telnet_result
+_cb_handle_chunk(struct oonf_telnet_data *data) {
+  abuf_appendf(data->out, "chunk %d\n", _chunks);
+  _chunks--;
+  return _chunks == 0 ? TELNET_RESULT_ACTIVE : TELNET_RESULT_CONTINOUS;
+}
+
+static uint64_t
+_cb_get_generation(struct oonf_telnet_data *data __attribute__((unused))) {
+  return _generation;
+}
+
+static void
+_execute(struct autobuf *out, const char *param) {
+  abuf_clear(out);
+  CHECK_TRUE(oonf_telnet_execute("test", param, out, NULL) == TELNET_RESULT_ACTIVE,
+      "command '%s' failed", param);
+}
+
+static void
+clear_elements(void) {
+  _cache_shrink(0);
+  _telnet_cache_size = 16*1024*1024;
+  _generation = 1;
+  _handler_calls = 0;
+  _chunks = 0;
+  _output_size = 0;
+}
+
+static void
+test_cache_hit(void) {
+  struct autobuf out1, out2;
+
+  START_TEST();
+
+  abuf_init(&out1);
+  abuf_init(&out2);
+
+  _execute(&out1, "a");
+  _execute(&out2, "a");
+  CHECK_TRUE(_handler_calls == 1, "handler called %d times", _handler_calls);
+  CHECK_TRUE(strcmp(abuf_getptr(&out1), abuf_getptr(&out2)) == 0,
+      "cached output '%s' differs from '%s'", abuf_getptr(&out2), abuf_getptr(&out1));
+
+  /* different parameter, different output */
+  _execute(&out2, "b");
+  CHECK_TRUE(_handler_calls == 2, "handler called %d times", _handler_calls);
+  CHECK_TRUE(strcmp(abuf_getptr(&out2), "b 2 1\n") == 0, "wrong output: '%s'", abuf_getptr(&out2));
+
+  /* generation 0 is never cached */
+  _generation = 0;
+  _execute(&out1, "a");
+  _execute(&out1, "a");
+  CHECK_TRUE(_handler_calls == 4, "handler called %d times", _handler_calls);
+
+  abuf_free(&out1);
+  abuf_free(&out2);
+  END_TEST();
+}
+
+static void
+test_cache_generation(void) {
+  struct autobuf out;
+
+  START_TEST();
+
+  abuf_init(&out);
+
+  _execute(&out, "a");
+  CHECK_TRUE(strcmp(abuf_getptr(&out), "a 1 1\n") == 0, "wrong output: '%s'", abuf_getptr(&out));
+
+  /* new generation, output is generated again */
+  _generation++;
+  _execute(&out, "a");
+  CHECK_TRUE(_handler_calls == 2, "handler called %d times", _handler_calls);
+  CHECK_TRUE(strcmp(abuf_getptr(&out), "a 2 2\n") == 0, "wrong output: '%s'", abuf_getptr(&out));
+
+  /* outdated output has been replaced */
+  _execute(&out, "a");
+  CHECK_TRUE(_handler_calls == 2, "handler called %d times", _handler_calls);
+  CHECK_TRUE(strcmp(abuf_getptr(&out), "a 2 2\n") == 0, "wrong output: '%s'", abuf_getptr(&out));
+  CHECK_TRUE(_telnet_cache_tree.count == 1, "%u cache entries", _telnet_cache_tree.count);
+
+  abuf_free(&out);
+  END_TEST();
+}
+
+static void
+test_cache_chunked(void) {
+  struct autobuf out1, out2;
+
+  START_TEST();
+
+  abuf_init(&out1);
+  abuf_init(&out2);
+
+  /* all chunks are recorded */
+  _chunks = 3;
+  _execute(&out1, "a");
+  _execute(&out2, "a");
+  CHECK_TRUE(_handler_calls == 1, "handler called %d times", _handler_calls);
+  CHECK_TRUE(strcmp(abuf_getptr(&out1), "a 1 1\nchunk 3\nchunk 2\nchunk 1\n") == 0,
+      "wrong output: '%s'", abuf_getptr(&out1));
+  CHECK_TRUE(strcmp(abuf_getptr(&out1), abuf_getptr(&out2)) == 0,
+      "cached output '%s' differs from '%s'", abuf_getptr(&out2), abuf_getptr(&out1));
+
+  abuf_free(&out1);
+  abuf_free(&out2);
+  END_TEST();
+}
+
+static void
+test_cache_eviction(void) {
+  struct autobuf out;
+  char param[8];
+  int i;
+
+  START_TEST();
+
+  abuf_init(&out);
+
+  /* room for three outputs */
+  _output_size = 100;
+  _telnet_cache_size = 350;
+
+  for (i = 0; i < 3; i++) {
+    snprintf(param, sizeof(param), "%d", i);
+    _execute(&out, param);
+  }
+  CHECK_TRUE(_telnet_cache_tree.count == 3, "%u cache entries", _telnet_cache_tree.count);
+
+  /* use the oldest entry, so the second one is evicted next */
+  _execute(&out, "0");
+  CHECK_TRUE(_handler_calls == 3, "handler called %d times", _handler_calls);
+
+  _execute(&out, "3");
+  CHECK_TRUE(_telnet_cache_tree.count == 3, "%u cache entries", _telnet_cache_tree.count);
+  CHECK_TRUE(_telnet_cache_used <= _telnet_cache_size, "cache uses %" PRINTF_SIZE_T_SPECIFIER " bytes",
+      _telnet_cache_used);
+  CHECK_TRUE(avl_find(&_telnet_cache_tree, "test 1") == NULL, "least recently used entry not evicted");
+  CHECK_TRUE(avl_find(&_telnet_cache_tree, "test 0") != NULL, "recently used entry evicted");
+
+  _execute(&out, "1");
+  CHECK_TRUE(_handler_calls == 5, "handler called %d times", _handler_calls);
+
+  /* output larger than the cache is not stored */
+  _output_size = 400;
+  _execute(&out, "4");
+  _execute(&out, "4");
+  CHECK_TRUE(_handler_calls == 7, "handler called %d times", _handler_calls);
+  CHECK_TRUE(avl_find(&_telnet_cache_tree, "test 4") == NULL, "too large output cached");
+
+  /* removing the command drops its cached output */
+  oonf_telnet_remove(&_test_cmd);
+  CHECK_TRUE(avl_is_empty(&_telnet_cache_tree), "cache not empty after removing command");
+  CHECK_TRUE(_telnet_cache_used == 0, "cache uses %" PRINTF_SIZE_T_SPECIFIER " bytes",
+      _telnet_cache_used);
+  oonf_telnet_add(&_test_cmd);
+
+  abuf_free(&out);
+  END_TEST();
+}
+
+static void
+test_cache_large_output(void) {
+  struct autobuf out1, out2;
+
+  START_TEST();
+
+  abuf_init(&out1);
+  abuf_init(&out2);
+
+  /* a dump of a few megabytes fits into the default cache */
+  _output_size = 4*1024*1024;
+  _execute(&out1, "a");
+  _execute(&out2, "a");
+  CHECK_TRUE(_handler_calls == 1, "handler called %d times", _handler_calls);
+  CHECK_TRUE(abuf_getlen(&out1) == abuf_getlen(&out2)
+      && memcmp(abuf_getptr(&out1), abuf_getptr(&out2), abuf_getlen(&out1)) == 0,
+      "cached output differs");
+
+  abuf_free(&out1);
+  abuf_free(&out2);
+  END_TEST();
+}
+
+static void
+test_cache_hit_chunked(void) {
+  struct oonf_telnet_data data;
+  struct autobuf out1, out2;
+  enum oonf_telnet_result result;
+  size_t chunks;
+
+  START_TEST();
+
+  abuf_init(&out1);
+  abuf_init(&out2);
+
+  _output_size = 10 * TELNET_CACHE_CHUNK_SIZE;
+  _execute(&out1, "a");
+
+  /* a cache hit is sent in chunks like the original output */
+  memset(&data, 0, sizeof(data));
+  data.command = "test";
+  data.parameter = "a";
+  data.out = &out2;
+
+  result = _telnet_handle_command(&data);
+  CHECK_TRUE(result == TELNET_RESULT_ACTIVE, "command failed: %d", result);
+  CHECK_TRUE(_handler_calls == 1, "handler called %d times", _handler_calls);
+  CHECK_TRUE(data.chunk_handler != NULL, "large cached output not chunked");
+  CHECK_TRUE(abuf_getlen(&out2) <= TELNET_CACHE_CHUNK_SIZE,
+      "first chunk has %" PRINTF_SIZE_T_SPECIFIER " bytes", abuf_getlen(&out2));
+
+  /* the output survives when the entry is replaced in the meantime */
+  _generation++;
+  _execute(&out1, "a");
+  CHECK_TRUE(_handler_calls == 2, "handler called %d times", _handler_calls);
+
+  chunks = 1;
+  do {
+    result = _call_chunk_handler(&data);
+    chunks++;
+  } while (result == TELNET_RESULT_CONTINOUS);
+  _call_chunk_cleanup(&data);
+
+  CHECK_TRUE(result == TELNET_RESULT_ACTIVE, "chunk failed: %d", result);
+  CHECK_TRUE(chunks == 11, "output sent in %" PRINTF_SIZE_T_SPECIFIER " chunks", chunks);
+  CHECK_TRUE(abuf_getlen(&out2) == 10 * TELNET_CACHE_CHUNK_SIZE + 6,
+      "cached output has %" PRINTF_SIZE_T_SPECIFIER " bytes", abuf_getlen(&out2));
+  CHECK_TRUE(strncmp(abuf_getptr(&out2), "a 1 1\n", 6) == 0, "wrong output: '%.6s'", abuf_getptr(&out2));
+  CHECK_TRUE(_telnet_cache_reader_class._current_usage == 0, "cache reader not freed");
+
+  abuf_free(&out1);
+  abuf_free(&out2);
+  END_TEST();
+}
+
+int
+main(int argc __attribute__ ((unused)), char **argv __attribute__ ((unused))) {
+  int result;
+
+  if (oonf_log_init(&_appdata, LOG_SEVERITY_WARN)
+      || subsystem_helper_init(OONF_TELNET_SUBSYSTEM)) {
+    return 1;
+  }
+  oonf_telnet_add(&_test_cmd);
+
+  BEGIN_TESTING(clear_elements);
+
+  test_cache_hit();
+  test_cache_generation();
+  test_cache_chunked();
+  test_cache_eviction();
+  test_cache_large_output();
+  test_cache_hit_chunked();
+
+  result = FINISH_TESTING();
+
+  oonf_telnet_remove(&_test_cmd);
+  subsystem_helper_cleanup();
+  oonf_log_cleanup();
+  return result;
+}
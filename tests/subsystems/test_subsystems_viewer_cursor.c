@@ -0,0 +1,300 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "common/avl.h"
+#include "common/avl_comp.h"
+#include "subsystems/oonf_viewer.h"
+#include "cunit/cunit.h"
+
+#define OUTER_COUNT 20
+#define INNER_COUNT 10
+
+struct tree_element {
+  int32_t key;
+  struct avl_node node;
+
+  struct avl_tree inner;
+};
+
+static struct tree_element _outer[OUTER_COUNT];
+static struct tree_element _inner[OUTER_COUNT][INNER_COUNT];
+static struct avl_tree _tree;
+static struct oonf_viewer_cursor _cursor;
+
+static void
+clear_elements(void) {
+  int i, j;
+
+  memset(&_cursor, 0, sizeof(_cursor));
+  avl_init(&_tree, avl_comp_int32, false);
+
+  for (i = 0; i < OUTER_COUNT; i++) {
+    _outer[i].key = i * 10;
+    _outer[i].node.key = &_outer[i].key;
+    avl_insert(&_tree, &_outer[i].node);
+
+    avl_init(&_outer[i].inner, avl_comp_int32, false);
+    for (j = 0; j < INNER_COUNT; j++) {
+      _inner[i][j].key = j * 10;
+      _inner[i][j].node.key = &_inner[i][j].key;
+      avl_insert(&_outer[i].inner, &_inner[i][j].node);
+    }
+  }
+}
+
+static int32_t
+_resume_key(unsigned level, struct avl_tree *tree) {
+  struct avl_node *node;
+
+  node = oonf_viewer_cursor_resume(&_cursor, level, tree);
+  return node == NULL ? -1 : *((const int32_t *)node->key);
+}
+
+static void
+test_resume_start(void) {
+  START_TEST();
+
+  CHECK_TRUE(!oonf_viewer_cursor_is_started(&_cursor, 0), "new cursor is started");
+  CHECK_TRUE(_resume_key(0, &_tree) == 0, "new cursor does not start with first element");
+
+  avl_init(&_tree, avl_comp_int32, false);
+  CHECK_TRUE(_resume_key(0, &_tree) == -1, "empty tree returned an element");
+
+  END_TEST();
+}
+
+static void
+test_resume_current_done(void) {
+  START_TEST();
+
+  /* element is still being printed, resume with the same one */
+  oonf_viewer_cursor_enter(&_cursor, 0, &_outer[3].key, sizeof(_outer[3].key));
+  CHECK_TRUE(oonf_viewer_cursor_is_started(&_cursor, 0), "cursor is not started");
+  CHECK_TRUE(_resume_key(0, &_tree) == 30, "current element not resumed: %d", _resume_key(0, &_tree));
+
+  /* element has been printed, resume with the next one */
+  oonf_viewer_cursor_leave(&_cursor, 0);
+  CHECK_TRUE(_resume_key(0, &_tree) == 40, "done element not skipped: %d", _resume_key(0, &_tree));
+
+  /* last element has been printed */
+  oonf_viewer_cursor_enter(&_cursor, 0, &_outer[OUTER_COUNT-1].key, sizeof(_outer[0].key));
+  oonf_viewer_cursor_leave(&_cursor, 0);
+  CHECK_TRUE(_resume_key(0, &_tree) == -1, "resumed after last element: %d", _resume_key(0, &_tree));
+
+  END_TEST();
+}
+
+static void
+test_resume_removed(void) {
+  START_TEST();
+
+  /* current element removed, continue with the next larger key */
+  oonf_viewer_cursor_enter(&_cursor, 0, &_outer[3].key, sizeof(_outer[3].key));
+  avl_remove(&_tree, &_outer[3].node);
+  CHECK_TRUE(_resume_key(0, &_tree) == 40, "removed current element: %d", _resume_key(0, &_tree));
+
+  /* printed element removed, the next larger key must not be skipped */
+  oonf_viewer_cursor_enter(&_cursor, 0, &_outer[5].key, sizeof(_outer[5].key));
+  oonf_viewer_cursor_leave(&_cursor, 0);
+  avl_remove(&_tree, &_outer[5].node);
+  CHECK_TRUE(_resume_key(0, &_tree) == 60, "removed done element: %d", _resume_key(0, &_tree));
+
+  /* removed element was the last one */
+  oonf_viewer_cursor_enter(&_cursor, 0, &_outer[OUTER_COUNT-1].key, sizeof(_outer[0].key));
+  avl_remove(&_tree, &_outer[OUTER_COUNT-1].node);
+  CHECK_TRUE(_resume_key(0, &_tree) == -1, "resumed after removed last element: %d", _resume_key(0, &_tree));
+
+  END_TEST();
+}
+
+static void
+test_resume_nested(void) {
+  struct avl_tree *inner;
+
+  START_TEST();
+
+  inner = &_outer[2].inner;
+
+  /* print inner element 40 of outer element 20 */
+  oonf_viewer_cursor_enter(&_cursor, 0, &_outer[2].key, sizeof(_outer[2].key));
+  oonf_viewer_cursor_enter(&_cursor, 1, &_inner[2][4].key, sizeof(_inner[2][4].key));
+  oonf_viewer_cursor_leave(&_cursor, 1);
+
+  /* resuming the outer element keeps the inner position */
+  CHECK_TRUE(_resume_key(0, &_tree) == 20, "outer element not resumed");
+  oonf_viewer_cursor_enter(&_cursor, 0, &_outer[2].key, sizeof(_outer[2].key));
+  CHECK_TRUE(_resume_key(1, inner) == 50, "inner element not resumed: %d", _resume_key(1, inner));
+
+  /* leaving the outer element resets the inner level */
+  oonf_viewer_cursor_leave(&_cursor, 0);
+  CHECK_TRUE(!oonf_viewer_cursor_is_started(&_cursor, 1), "inner level not reset by leave");
+
+  /* removing the outer element resets the inner level */
+  oonf_viewer_cursor_enter(&_cursor, 0, &_outer[4].key, sizeof(_outer[4].key));
+  oonf_viewer_cursor_enter(&_cursor, 1, &_inner[4][6].key, sizeof(_inner[4][6].key));
+  avl_remove(&_tree, &_outer[4].node);
+  CHECK_TRUE(_resume_key(0, &_tree) == 50, "removed outer element: %d", _resume_key(0, &_tree));
+  CHECK_TRUE(!oonf_viewer_cursor_is_started(&_cursor, 1), "inner level not reset by removal");
+  CHECK_TRUE(_resume_key(1, &_outer[5].inner) == 0, "inner level does not start at first element");
+
+  /* entering a different outer element resets the inner level */
+  oonf_viewer_cursor_enter(&_cursor, 1, &_inner[5][6].key, sizeof(_inner[5][6].key));
+  oonf_viewer_cursor_enter(&_cursor, 0, &_outer[6].key, sizeof(_outer[6].key));
+  CHECK_TRUE(!oonf_viewer_cursor_is_started(&_cursor, 1), "inner level not reset by new outer element");
+
+  /* next phase resets all levels */
+  oonf_viewer_cursor_enter(&_cursor, 1, &_inner[6][6].key, sizeof(_inner[6][6].key));
+  oonf_viewer_cursor_next_phase(&_cursor);
+  CHECK_TRUE(_cursor.phase == 1, "phase not incremented");
+  CHECK_TRUE(!oonf_viewer_cursor_is_started(&_cursor, 0), "outer level not reset by next phase");
+  CHECK_TRUE(!oonf_viewer_cursor_is_started(&_cursor, 1), "inner level not reset by next phase");
+
+  END_TEST();
+}
+
+/**
+ * Print one chunk of at most limit inner elements
+ * @param visited array of visit counters for the inner elements
+ * @param last combined key of the last printed element
+ * @param limit maximum number of elements per chunk
+ * @return true if the output is complete
+ */
+static bool
+_print_chunk(int visited[OUTER_COUNT][INNER_COUNT], int *last, int limit) {
+  struct tree_element *outer, *inner;
+  int count = 0;
+
+  oonf_viewer_for_each_element(&_cursor, 0, &_tree, outer, node) {
+    oonf_viewer_cursor_enter(&_cursor, 0, &outer->key, sizeof(outer->key));
+
+    oonf_viewer_for_each_element(&_cursor, 1, &outer->inner, inner, node) {
+      if (count == limit) {
+        return false;
+      }
+      oonf_viewer_cursor_enter(&_cursor, 1, &inner->key, sizeof(inner->key));
+
+      /* output must be sorted */
+      CHECK_TRUE(outer->key * 1000 + inner->key > *last,
+          "element %d/%d printed out of order", outer->key, inner->key);
+      *last = outer->key * 1000 + inner->key;
+
+      visited[outer->key / 10][inner->key / 10]++;
+      count++;
+
+      oonf_viewer_cursor_leave(&_cursor, 1);
+    }
+    oonf_viewer_cursor_leave(&_cursor, 0);
+  }
+  return true;
+}
+
+static void
+test_chunked_walk_vs_single(void) {
+  int visited[OUTER_COUNT][INNER_COUNT];
+  bool removed[OUTER_COUNT][INNER_COUNT];
+  bool outer_removed[OUTER_COUNT];
+  int i, j, limit, chunks, last;
+
+  START_TEST();
+
+  srand(42);
+  for (limit = 1; limit < 25; limit++) {
+    clear_elements();
+    memset(visited, 0, sizeof(visited));
+    memset(removed, 0, sizeof(removed));
+    memset(outer_removed, 0, sizeof(outer_removed));
+    last = -1;
+
+    /* remove random elements between the chunks */
+    for (chunks = 0; !_print_chunk(visited, &last, limit); chunks++) {
+      i = rand() % OUTER_COUNT;
+      j = rand() % INNER_COUNT;
+
+      if (rand() % 4 == 0) {
+        if (!outer_removed[i]) {
+          avl_remove(&_tree, &_outer[i].node);
+          outer_removed[i] = true;
+        }
+      }
+      else if (!removed[i][j]) {
+        avl_remove(&_outer[i].inner, &_inner[i][j].node);
+        removed[i][j] = true;
+      }
+    }
+
+    /* all elements that have not been removed are printed exactly once */
+    for (i = 0; i < OUTER_COUNT; i++) {
+      for (j = 0; j < INNER_COUNT; j++) {
+        if (outer_removed[i] || removed[i][j]) {
+          CHECK_TRUE(visited[i][j] <= 1, "limit %d: removed element %d/%d printed %d times",
+              limit, i, j, visited[i][j]);
+        }
+        else {
+          CHECK_TRUE(visited[i][j] == 1, "limit %d: element %d/%d printed %d times",
+              limit, i, j, visited[i][j]);
+        }
+      }
+    }
+  }
+
+  END_TEST();
+}
+
+int
+main(int argc __attribute__ ((unused)), char **argv __attribute__ ((unused))) {
+  BEGIN_TESTING(clear_elements);
+
+  test_resume_start();
+  test_resume_current_done();
+  test_resume_removed();
+  test_resume_nested();
+  test_chunked_walk_vs_single();
+
+  return FINISH_TESTING();
+}